@@ -37,6 +37,29 @@ if(NOT FFTW_INCLUDE_DIR OR NOT FFTW_LIBRARIES)
         message(STATUS "Single-precision FFTW library is not found. Install FFTW both with and without --enable-float.")
     endif(NOT FFTWF_LIB)
 
+    #find threads libs
+    if(USE_FFTW_THREADS)
+        find_library(
+            FFTW_THREADS_LIB
+            NAMES fftw3_threads
+            HINTS 
+            ${FFTW_ROOT}
+            $ENV{FFTW_ROOT}
+            PATH_SUFFIXES lib
+        )
+        find_library(
+            FFTWF_THREADS_LIB
+            NAMES fftw3f_threads
+            HINTS 
+            ${FFTW_ROOT}
+            $ENV{FFTW_ROOT}
+            PATH_SUFFIXES lib
+        )
+        if(NOT FFTW_THREADS_LIB OR NOT FFTWF_THREADS_LIB)
+            message(STATUS "FFTW threads libraries are not found. Install FFTW with --enable-threads.")
+        endif()
+    endif(USE_FFTW_THREADS)
+
     #find includes
     find_path(
         FFTW_INCLUDE_DIR
@@ -49,11 +72,11 @@ if(NOT FFTW_INCLUDE_DIR OR NOT FFTW_LIBRARIES)
     
 endif()
 
-set(FFTW_LIBRARIES ${FFTW_LIB} ${FFTWF_LIB})
+set(FFTW_LIBRARIES ${FFTW_THREADS_LIB} ${FFTWF_THREADS_LIB} ${FFTW_LIB} ${FFTWF_LIB})
 
 include(FindPackageHandleStandardArgs)
 find_package_handle_standard_args(FFTW DEFAULT_MSG
 FFTW_INCLUDE_DIR FFTW_LIBRARIES)
 
-mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARIES FFTW_LIB FFTWF_LIB)
+mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARIES FFTW_LIB FFTWF_LIB FFTW_THREADS_LIB FFTWF_THREADS_LIB)
 
@@ -0,0 +1,34 @@
+# - Try to find ParMETIS
+# Once done this will define
+#
+#  PARMETIS_FOUND        - system has ParMETIS
+#  PARMETIS_INCLUDE_DIR  - include directories for ParMETIS
+#  PARMETIS_LIBRARIES    - libraries for ParMETIS
+
+# lib
+if (NOT PARMETIS_LIBRARIES)
+    find_library(PARMETIS_LIBRARIES
+        NAMES parmetis
+        HINTS 
+        ${PARMETIS_ROOT}
+        $ENV{PARMETIS_ROOT}
+        PATH_SUFFIXES lib
+    )
+endif()    
+
+# include
+if (NOT PARMETIS_INCLUDE_DIR)
+    find_path(PARMETIS_INCLUDE_DIR 
+        NAMES parmetis.h
+        HINTS
+        ${PARMETIS_ROOT}
+        $ENV{PARMETIS_ROOT}
+        PATH_SUFFIXES include)
+endif()
+
+# Standard package handling
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(PARMETIS DEFAULT_MSG
+PARMETIS_INCLUDE_DIR PARMETIS_LIBRARIES)
+
+mark_as_advanced(PARMETIS_INCLUDE_DIR PARMETIS_LIBRARIES)
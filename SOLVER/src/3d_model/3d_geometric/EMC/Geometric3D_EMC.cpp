@@ -53,6 +53,8 @@ void Geometric3D_EMC::initialize() {
     mGridLat = flat.cast<double>();
     mGridLon = flon.cast<double>();
     mGridData = fdata.cast<double>();
+    mLookupLat = XMath::Grid1D(mGridLat);
+    mLookupLon = XMath::Grid1D(mGridLon);
     
     // to SI
     mGridData *= 1e3;
@@ -133,8 +135,8 @@ double Geometric3D_EMC::getDeltaR(double r, double theta, double phi, double rEl
     // interpolation on sphere
     int llat0, llon0, llat1, llon1;
     double wlat0, wlon0, wlat1, wlon1;
-    XMath::interpLinear(lat, mGridLat, llat0, wlat0);
-    XMath::interpLinear(lon, mGridLon, llon0, wlon0);    
+    mLookupLat.interpLinear(lat, llat0, wlat0);
+    mLookupLon.interpLinear(lon, llon0, wlon0);
     if (llat0 < 0 || llon0 < 0) {
         return 0.;
     }
@@ -158,6 +160,14 @@ double Geometric3D_EMC::getDeltaR(double r, double theta, double phi, double rEl
     }
 }
 
+void Geometric3D_EMC::getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const {
+    // columns away from the layer
+    if (rtp.rows() == 0 || rtp.col(0).maxCoeff() < mRLower || rtp.col(0).minCoeff() > mRUpper) {
+        return;
+    }
+    Geometric3D::getDeltaRBatch(rtp, rElemCenter, deltaR);
+}
+
 std::string Geometric3D_EMC::verbose() const {
     std::stringstream ss;
     ss << "\n======================= 3D Geometric =======================" << std::endl;
@@ -6,6 +6,7 @@
 
 #include "Geometric3D.h"
 #include "eigenp.h"
+#include "XMath.h"
 
 class Geometric3D_EMC: public Geometric3D {
 public:
@@ -13,6 +14,7 @@ public:
     void initialize();
     void initialize(const std::vector<std::string> &params);
     double getDeltaR(double r, double theta, double phi, double rElemCenter) const;
+    void getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const;
     std::string verbose() const;
     
 private:
@@ -36,5 +38,7 @@ private:
     RDMatXX mGridData;
     RDColX mGridLat;
     RDColX mGridLon;
+    XMath::Grid1D mLookupLat;
+    XMath::Grid1D mLookupLon;
 };
 
@@ -80,3 +80,9 @@ void Geometric3D::buildInparam(std::vector<Geometric3D *> &models,
     }
 }
 
+void Geometric3D::getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const {
+    for (int ipnt = 0; ipnt < rtp.rows(); ipnt++) {
+        deltaR(ipnt) += getDeltaR(rtp(ipnt, 0), rtp(ipnt, 1), rtp(ipnt, 2), rElemCenter);
+    }
+}
+
@@ -6,6 +6,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "eigenp.h"
 
 class Parameters;
 
@@ -28,8 +29,17 @@ public:
     //    For models given in geographic coordinates, geocentric-to-geographic  
     //    conversions from (theta, phi) to (lat, lon) has to be performed internally.
     // b) All models should be defined independently with respect to the perfect sphere.
+    // c) This function must be thread-safe: quads are built concurrently, so it
+    //    may only read the model data set up in initialize().
     virtual double getDeltaR(double r, double theta, double phi, double rElemCenter) const = 0;
     
+    // get undulation at a column of points, accumulated to deltaR
+    // rtp: (r, theta, phi) of each point, in the same sense as getDeltaR
+    // deltaR: sized as rtp.rows() by the caller
+    // The default implementation loops over getDeltaR; models with a 
+    // restricted scope should override it so that columns outside are skipped.
+    virtual void getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const;
+    
     // verbose 
     virtual std::string verbose() const = 0;
     
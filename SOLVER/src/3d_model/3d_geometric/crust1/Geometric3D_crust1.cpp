@@ -110,6 +110,8 @@ void Geometric3D_crust1::initialize() {
     for (int i = 0; i < sNLon + 1; i++) {
         mGridLon[i] = i * 1. - 179.5;
     }
+    mLookupLat = XMath::Grid1D(mGridLat);
+    mLookupLon = XMath::Grid1D(mGridLon);
     
     //////////// plot raw data ////////////  
     // std::fstream fs;
@@ -200,8 +202,8 @@ double Geometric3D_crust1::getDeltaR(double r, double theta, double phi, double
     // interpolation on sphere
     int llat0, llon0, llat1, llon1;
     double wlat0, wlon0, wlat1, wlon1;
-    XMath::interpLinear(lat, mGridLat, llat0, wlat0);
-    XMath::interpLinear(lon, mGridLon, llon0, wlon0);    
+    mLookupLat.interpLinear(lat, llat0, wlat0);
+    mLookupLon.interpLinear(lon, llon0, wlon0);
     llat1 = llat0 + 1;
     llon1 = llon0 + 1;
     wlat1 = 1. - wlat0;
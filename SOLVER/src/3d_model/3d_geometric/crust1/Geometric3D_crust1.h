@@ -8,6 +8,7 @@
 
 #include "Geometric3D.h"
 #include "eigenp.h"
+#include "XMath.h"
 
 class Geometric3D_crust1: public Geometric3D {
 public:
@@ -48,6 +49,7 @@ private:
     RDMatXX mDeltaRSurf;
     RDMatXX mDeltaRMoho;
     RDColX mGridLat, mGridLon;
+    XMath::Grid1D mLookupLat, mLookupLon;
     
 };
 
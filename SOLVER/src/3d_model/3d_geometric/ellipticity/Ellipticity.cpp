@@ -6,15 +6,44 @@
 #include <sstream>
 #include "Geodesy.h"
 
+// with b = (1 - f)^(2/3) r and a = b / (1 - f), the surface 
+// a b / sqrt(a^2 cos^2 + b^2 sin^2) is closed-form in theta:
+// r [(1 - f)^(-1/3) / sqrt(1 + k cos^2 theta)], k = (1 - f)^(-2) - 1
+namespace EllipticityRadial {
+    void factors(double r, double &scale, double &k) {
+        double f = Geodesy::getFlattening(r);
+        scale = pow(1. - f, -1. / 3.);
+        k = 1. / ((1. - f) * (1. - f)) - 1.;
+    }
+}
+
 double Ellipticity::getDeltaR(double r, double theta, double phi, double rElemCenter) const {
     if (r < tinyDouble) {
         return 0.;
     }
-    double f = Geodesy::getFlattening(r);
-    double b = pow(1. - f, 2. / 3.) * r;
-    double a = b / (1. - f);
-    double tmp = pow(a * cos(theta), 2.) + pow(b * sin(theta), 2.);
-    return a * b / sqrt(tmp) - r;
+    double scale, k;
+    EllipticityRadial::factors(r, scale, k);
+    double c = cos(theta);
+    return r * (scale / sqrt(1. + k * c * c) - 1.);
+}
+
+void Ellipticity::getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const {
+    // the points of a column share the radius, so the flattening 
+    // profile is looked up only when r changes
+    double rLast = -1.;
+    double scale = 1., k = 0.;
+    for (int ipnt = 0; ipnt < rtp.rows(); ipnt++) {
+        double r = rtp(ipnt, 0);
+        if (r < tinyDouble) {
+            continue;
+        }
+        if (r != rLast) {
+            EllipticityRadial::factors(r, scale, k);
+            rLast = r;
+        }
+        double c = cos(rtp(ipnt, 1));
+        deltaR(ipnt) += r * (scale / sqrt(1. + k * c * c) - 1.);
+    }
 }
 
 std::string Ellipticity::verbose() const {
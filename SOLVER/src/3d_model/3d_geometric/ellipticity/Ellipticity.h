@@ -9,6 +9,7 @@
 class Ellipticity: public Geometric3D {
 public:
     double getDeltaR(double r, double theta, double phi, double rElemCenter) const;
+    void getDeltaRBatch(const RDMatX3 &rtp, double rElemCenter, RDColX &deltaR) const;
     std::string verbose() const;
 };
 
@@ -5,12 +5,13 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "eigenp.h"
 
 class Parameters;
 
 class OceanLoad3D {
 public:
-
+    
     virtual ~OceanLoad3D() {finalize();};
     
     // initialize internal variables if needed
@@ -21,14 +22,24 @@ public:
     virtual void finalize() {};
     
     // get water depth at location theta/phi 
+    // thread-safe: quads are built concurrently
     virtual double getOceanDepth(double theta, double phi) const = 0;
     
+    // get water depth at the rows (r, theta, phi) of rtp 
+    // overridden by models with a cheaper lookup for many samples
+    virtual void getOceanDepths(const RDMatX3 &rtp, RDColX &depth) const {
+        depth.resize(rtp.rows());
+        for (int i = 0; i < rtp.rows(); i++) {
+            depth(i) = getOceanDepth(rtp(i, 1), rtp(i, 2));
+        }
+    };
+    
     // verbose 
     virtual std::string verbose() const = 0;
     
     // build from input parameters
     static void buildInparam(OceanLoad3D *&model, 
         const Parameters &par, int verbose);
-
+    
     static const double mWaterDensity;
 };
@@ -71,26 +71,21 @@ void OceanLoad3D_crust1::initialize() {
     XMath::gaussianSmoothing(depth, orderRow, devRow, true, orderCol, devCol, false);
     
     // cast to integer theta with unique polar values
-    mDepth = RDMatXX::Zero(sNLat + 1, sNLon);
+    RDMatXX depthGrid = RDMatXX::Zero(sNLat + 1, sNLon);
     // fill north and south pole
-    mDepth.row(0).fill(depth.row(0).sum() / sNLon);
-    mDepth.row(sNLat).fill(depth.row(sNLat - 1).sum() / sNLon);
+    depthGrid.row(0).fill(depth.row(0).sum() / sNLon);
+    depthGrid.row(sNLat).fill(depth.row(sNLat - 1).sum() / sNLon);
     // interp at integer theta
     for (int i = 1; i < sNLat; i++) {
-        mDepth.row(i) = (depth.row(i - 1) + depth.row(i)) * .5;
+        depthGrid.row(i) = (depth.row(i - 1) + depth.row(i)) * .5;
     }
     // reverse south to north
-    mDepth = mDepth.colwise().reverse().eval();
+    depthGrid = depthGrid.colwise().reverse().eval();
+    // held once per node
+    mDepth.share(depthGrid, false);
     
-    // grid lat and lon
-    mGridLat = RDColX(sNLat + 1);
-    mGridLon = RDColX(sNLon + 1); // one bigger than data
-    for (int i = 0; i < sNLat + 1; i++) {
-        mGridLat[i] = i * 1. - 90.;
-    }
-    for (int i = 0; i < sNLon + 1; i++) {
-        mGridLon[i] = i * 1. - 179.5;
-    }
+    // the grid is regular at one degree, from lat = -90 and lon = -179.5,
+    // so that a sample is located by its cell index without a search
     
     //////////// plot raw data ////////////  
     // std::fstream fs;
@@ -117,6 +112,19 @@ void OceanLoad3D_crust1::initialize(const std::vector<std::string> &params) {
 }
 
 double OceanLoad3D_crust1::getOceanDepth(double theta, double phi) const {
+    return lookup(theta, phi, mDepth.matrix());
+}
+
+void OceanLoad3D_crust1::getOceanDepths(const RDMatX3 &rtp, RDColX &depth) const {
+    const Eigen::Map<const RDMatXX> &depthGrid = mDepth.matrix();
+    depth.resize(rtp.rows());
+    for (int i = 0; i < rtp.rows(); i++) {
+        depth(i) = lookup(rtp(i, 1), rtp(i, 2), depthGrid);
+    }
+}
+
+double OceanLoad3D_crust1::lookup(double theta, double phi, 
+    const Eigen::Map<const RDMatXX> &depthGrid) const {
     // convert theta to co-latitude  
     if (mGeographic) {
         theta = pi / 2. - Geodesy::theta2Lat_d(theta, 0.) * degree;
@@ -135,23 +143,25 @@ double OceanLoad3D_crust1::getOceanDepth(double theta, double phi) const {
     }
     
     // interpolation on sphere
-    int llat0, llon0, llat1, llon1;
-    double wlat0, wlon0, wlat1, wlon1;
-    XMath::interpLinear(lat, mGridLat, llat0, wlat0);
-    XMath::interpLinear(lon, mGridLon, llon0, wlon0);    
-    llat1 = llat0 + 1;
-    llon1 = llon0 + 1;
-    wlat1 = 1. - wlat0;
-    wlon1 = 1. - wlon0;
+    double xlat = lat + 90.;
+    double xlon = lon + 179.5;
+    int llat0 = std::min((int)xlat, sNLat - 1);
+    int llon0 = std::min((int)xlon, sNLon - 1);
+    int llat1 = llat0 + 1;
+    int llon1 = llon0 + 1;
+    double wlat0 = llat1 - xlat;
+    double wlon0 = llon1 - xlon;
+    double wlat1 = 1. - wlat0;
+    double wlon1 = 1. - wlon0;
     if (llon1 == sNLon) {
         llon1 = 0;
     }
     
     double depth = 0.;
-    depth += mDepth(llat0, llon0) * wlat0 * wlon0;
-    depth += mDepth(llat1, llon0) * wlat1 * wlon0;
-    depth += mDepth(llat0, llon1) * wlat0 * wlon1;
-    depth += mDepth(llat1, llon1) * wlat1 * wlon1;
+    depth += depthGrid(llat0, llon0) * wlat0 * wlon0;
+    depth += depthGrid(llat1, llon0) * wlat1 * wlon0;
+    depth += depthGrid(llat0, llon1) * wlat0 * wlon1;
+    depth += depthGrid(llat1, llon1) * wlat1 * wlon1;
     
     if (mBenchmarkSPECFEM) {
         double elevation = depth;
@@ -7,19 +7,25 @@
 
 #include "OceanLoad3D.h"
 #include "eigenp.h"
+#include "NodeSharedArray.h"
 
 class OceanLoad3D_crust1: public OceanLoad3D {
 public:
-
+    
     void initialize();
     void initialize(const std::vector<std::string> &params);
     
     double getOceanDepth(double theta, double phi) const;
+    void getOceanDepths(const RDMatX3 &rtp, RDColX &depth) const;
     
     std::string verbose() const;
     
 private:
     
+    // bilinear lookup on the one-degree grid
+    double lookup(double theta, double phi, 
+        const Eigen::Map<const RDMatXX> &depthGrid) const;
+    
     // model constants
     static const int sNLayer;
     static const int sNLat;
@@ -38,8 +44,7 @@ private:
     // flag to benchmark with specfem
     bool mBenchmarkSPECFEM = false; 
     
-    // depth at grid points 
-    RDMatXX mDepth;
-    RDColX mGridLat, mGridLon;
+    // depth at grid points, shared by the ranks on a node
+    NodeSharedArray mDepth;
 };
 
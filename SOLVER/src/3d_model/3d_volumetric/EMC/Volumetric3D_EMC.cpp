@@ -110,6 +110,19 @@ void Volumetric3D_EMC::initialize() {
             
             // perturbations are given in percentage
             fdata *= .01f;
+        } else if (mRegional) {
+            // grid data is read by each rank in setLocalRange
+            if (NetCDF_Reader::checkNetCDF_isAscii(fname)) {
+                throw std::runtime_error("Volumetric3D_EMC::initialize || "
+                    "Regional loading requires a binary NetCDF file. || File = " + fname);
+            }
+            NetCDF_Reader reader;
+            reader.open(fname);
+            reader.read1D("depth", fdep);
+            reader.read1D("latitude", flat);
+            reader.read1D("longitude", flon);
+            reader.readDims(mVarName, dims);
+            reader.close();
         } else {
             if (NetCDF_Reader::checkNetCDF_isAscii(fname)) {
                 NetCDF_ReaderAscii reader;
@@ -147,15 +160,50 @@ void Volumetric3D_EMC::initialize() {
     XMPI::bcastEigen(fdep);
     XMPI::bcastEigen(flat);
     XMPI::bcastEigen(flon);
-    XMPI::bcastEigen(fdata);
     
     mGridDep = fdep.cast<double>();
     mGridLat = flat.cast<double>();
     mGridLon = flon.cast<double>();
-    RDColX data = fdata.cast<double>();
     
     // SI
     mGridDep *= 1e3;
+    mLookupDep = XMath::Grid1D(mGridDep);
+    mLookupLat = XMath::Grid1D(mGridLat);
+    mLookupLon = XMath::Grid1D(mGridLon);
+    
+    // special flag
+    if (!boost::iequals(mModelFlag, "none") && !boost::iequals(mModelFlag, "abs") 
+        && !boost::iequals(mModelFlag, "pow")) {
+        throw std::runtime_error("Volumetric3D_EMC::initialize || "
+            "Unknown special model flag, flag = " + mModelFlag);
+    }
+    
+    // full grid covered
+    mLocalStart = {0, 0, 0};
+    mLocalCount = {(int)mGridDep.size(), (int)mGridLat.size(), (int)mGridLon.size()};
+    if (mRegional) {
+        // nothing loaded before setLocalRange
+        mLocalCount = {0, 0, 0};
+        // the "pow" flag needs the global maximum
+        if (boost::iequals(mModelFlag, "pow")) {
+            throw std::runtime_error("Volumetric3D_EMC::initialize || "
+                "Special model flag pow is not supported with regional loading.");
+        }
+        return;
+    }
+    
+    // the grid data is processed on root and held once per node,
+    // ordered by depth, latitude and longitude with longitude fastest
+    RDColX data;
+    if (XMPI::root()) {
+        data = fdata.cast<double>();
+        fdata.resize(0);
+        processData(data);
+    }
+    mGridData.share(data, true);
+}
+
+void Volumetric3D_EMC::processData(RDColX &data) const {
     if (mReferenceType == Volumetric3D::MaterialRefType::Absolute) {
         // convert to SI
         data *= MaterialPropertyAbsSI[mMaterialProp];
@@ -165,31 +213,92 @@ void Volumetric3D_EMC::initialize() {
     data *= mFactor;
     
     // special flag
-    if (!boost::iequals(mModelFlag, "none")) {
-        if (boost::iequals(mModelFlag, "abs")) {
-            data.array() = data.array().abs();
-            data *= mModelFlagFactor;
-        } else if (boost::iequals(mModelFlag, "pow")) {
-            double absmax = data.array().abs().maxCoeff();
-            double scalefact = std::abs(absmax / std::pow(absmax, mModelFlagFactor));
-            data.array() = data.array().sign() * (data.array().abs().pow(mModelFlagFactor) * scalefact);
-        } else {
-            throw std::runtime_error("Volumetric3D_EMC::initialize || "
-                "Unknown special model flag, flag = " + mModelFlag);
-        }
+    if (boost::iequals(mModelFlag, "abs")) {
+        data.array() = data.array().abs();
+        data *= mModelFlagFactor;
+    } else if (boost::iequals(mModelFlag, "pow")) {
+        double absmax = data.array().abs().maxCoeff();
+        double scalefact = std::abs(absmax / std::pow(absmax, mModelFlagFactor));
+        data.array() = data.array().sign() * (data.array().abs().pow(mModelFlagFactor) * scalefact);
+    }
+}
+
+// lower index of the grid interval containing x, clamped to the grid
+int gridInterval(double x, const RDColX &grid) {
+    int loc = 0;
+    while (loc < grid.size() - 2 && x > grid(loc + 1)) {
+        loc++;
+    }
+    return loc;
+}
+
+void Volumetric3D_EMC::setLocalRange(double rMin, double rMax, double distMin, double distMax,
+    double srcLat, double srcLon, double srcDep) {
+    if (!mRegional) {
+        return;
     }
     
-    // reshape data
-    int pos = 0;
-    for (int i = 0; i < mGridDep.size(); i++) {
-        RDMatXX mat(mGridLat.size(), mGridLon.size());
-        for (int j = 0; j < mGridLat.size(); j++) {
-            for (int k = 0; k < mGridLon.size(); k++) {
-                mat(j, k) = data(pos++);
-            }
+    // depth range
+    double router = Geodesy::getROuter();
+    int dep0 = gridInterval(router - rMax, mGridDep);
+    int dep1 = gridInterval(router - rMin, mGridDep) + 1;
+    
+    // lat-lon box of the two circles bounding the range of epicentral distance
+    int lat0 = mGridLat.size(), lat1 = -1;
+    int lon0 = mGridLon.size(), lon1 = -1;
+    const int nazi = 3600;
+    const SourceRotation rotation(srcLat, srcLon, srcDep);
+    for (double dist: {distMin, distMax}) {
+        RDMatX3 rtpG(nazi, 3);
+        for (int iazi = 0; iazi < nazi; iazi++) {
+            rtpG.row(iazi) << rMax, dist, 2. * pi * iazi / nazi;
+        }
+        rotation.src2Glob(rtpG);
+        for (int iazi = 0; iazi < nazi; iazi++) {
+            double dep, lat, lon;
+            toGrid(rtpG(iazi, 0), rtpG(iazi, 1), rtpG(iazi, 2), dep, lat, lon);
+            int ilat = gridInterval(lat, mGridLat);
+            int ilon = gridInterval(lon, mGridLon);
+            lat0 = std::min(lat0, ilat);
+            lat1 = std::max(lat1, ilat + 1);
+            lon0 = std::min(lon0, ilon);
+            lon1 = std::max(lon1, ilon + 1);
         }
-        mGridData.push_back(mat);
     }
+    
+    // a pole within the range covers all longitudes
+    double srcTheta = Geodesy::lat2Theta_d(srcLat, srcDep);
+    if (srcTheta >= distMin && srcTheta <= distMax) {
+        lat1 = mGridLat.size() - 1;
+        lon0 = 0;
+        lon1 = mGridLon.size() - 1;
+    }
+    if (pi - srcTheta >= distMin && pi - srcTheta <= distMax) {
+        lat0 = 0;
+        lon0 = 0;
+        lon1 = mGridLon.size() - 1;
+    }
+    
+    // one interval of margin for the sampling of the circles
+    dep0 = std::max(dep0 - 1, 0);
+    lat0 = std::max(lat0 - 1, 0);
+    lon0 = std::max(lon0 - 1, 0);
+    dep1 = std::min(dep1 + 1, (int)mGridDep.size() - 1);
+    lat1 = std::min(lat1 + 1, (int)mGridLat.size() - 1);
+    lon1 = std::min(lon1 + 1, (int)mGridLon.size() - 1);
+    mLocalStart = {dep0, lat0, lon0};
+    mLocalCount = {dep1 - dep0 + 1, lat1 - lat0 + 1, lon1 - lon0 + 1};
+    
+    // read the hyperslab on this rank
+    std::vector<size_t> starts(mLocalStart.begin(), mLocalStart.end());
+    std::vector<size_t> counts(mLocalCount.begin(), mLocalCount.end());
+    Eigen::Matrix<float, Eigen::Dynamic, 1> fdata;
+    NetCDF_Reader reader;
+    reader.open(Parameters::sInputDirectory + "/" + mFileName);
+    reader.readHyperslab(mVarName, fdata, starts, counts);
+    reader.close();
+    mLocalData = fdata.cast<double>();
+    processData(mLocalData);
 }
 
 void Volumetric3D_EMC::initialize(const std::vector<std::string> &params) {
@@ -239,6 +348,7 @@ void Volumetric3D_EMC::initialize(const std::vector<std::string> &params) {
         Parameters::castValue(mVerticalDiscontinuities, params.at(ipar++), source);
         Parameters::castValue(mModelFlag, params.at(ipar++), source);
         Parameters::castValue(mModelFlagFactor, params.at(ipar++), source);
+        Parameters::castValue(mRegional, params.at(ipar++), source);
     } catch (std::out_of_range) {
         // nothing
     }
@@ -261,7 +371,44 @@ bool Volumetric3D_EMC::get3dProperties(double r, double theta, double phi, doubl
     properties = std::vector<MaterialProperty>(1, mMaterialProp);
     refTypes = std::vector<MaterialRefType>(1, mReferenceType);
     values = std::vector<double>(1, 0.);
-        
+    std::array<int, 3> hints = {-1, -1, -1};
+    return interpolate(r, theta, phi, rElemCenter, values[0], hints);
+}
+
+bool Volumetric3D_EMC::get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+    std::vector<MaterialProperty> &properties, 
+    std::vector<MaterialRefType> &refTypes,
+    RDMatXX &values, IColX &inRange) const {
+    
+    // header
+    properties.assign(1, mMaterialProp);
+    refTypes.assign(1, mReferenceType);
+    int npnt = rtp.rows();
+    values.resize(npnt, 1);
+    inRange.resize(npnt);
+    
+    // check center once for the quad
+    double dcenter = Geodesy::getROuter() - rElemCenter;
+    if (dcenter < mGridDep[0] || dcenter > mGridDep[mGridDep.size() - 1]) {
+        inRange.setZero();
+        return false;
+    }
+    
+    // consecutive points are close, so the cells are mostly reused
+    std::array<int, 3> hints = {-1, -1, -1};
+    bool anyInRange = false;
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        values(ipnt, 0) = 0.;
+        inRange(ipnt) = interpolate(rtp(ipnt, 0), rtp(ipnt, 1), rtp(ipnt, 2), 
+            rElemCenter, values(ipnt, 0), hints);
+        anyInRange = anyInRange || inRange(ipnt);
+    }
+    return anyInRange;
+}
+
+void Volumetric3D_EMC::toGrid(double r, double theta, double phi, 
+    double &dep, double &lat, double &lon) const {
+    
     // to geocentric
     if (mGeographic) {
         // which radius to use?
@@ -269,9 +416,9 @@ bool Volumetric3D_EMC::get3dProperties(double r, double theta, double phi, doubl
     }
     
     // regularise
-    double dep = Geodesy::getROuter() - r;
-    double lat = 90. - theta / degree;
-    double lon = phi / degree;
+    dep = Geodesy::getROuter() - r;
+    lat = 90. - theta / degree;
+    lon = phi / degree;
     XMath::checkLimits(dep, 0., Geodesy::getROuter());
     XMath::checkLimits(lat, -90., 90.);
     if (mGridLon[0] < 0.) {
@@ -284,6 +431,12 @@ bool Volumetric3D_EMC::get3dProperties(double r, double theta, double phi, doubl
         // lon starts from 0.
         XMath::checkLimits(lon, 0., 360.);
     }
+}
+
+bool Volumetric3D_EMC::interpolate(double r, double theta, double phi, 
+    double rElemCenter, double &value, std::array<int, 3> &hints) const {
+    double dep, lat, lon;
+    toGrid(r, theta, phi, dep, lat, lon);
     
     // check center
     double dmin = mGridDep[0];
@@ -300,40 +453,34 @@ bool Volumetric3D_EMC::get3dProperties(double r, double theta, double phi, doubl
     }
     
     // interpolation
-    int ldep0, llat0, llon0, ldep1, llat1, llon1;
-    double wdep0, wlat0, wlon0, wdep1, wlat1, wlon1;
+    int ldep0, llat0, llon0;
+    double wdep0, wlat0, wlon0;
     if (mVerticalDiscontinuities) {
         // use element center depth to locate layer
-        XMath::interpLinear(dcenter, mGridDep, ldep0, wdep0);
+        mLookupDep.interpLinear(dcenter, ldep0, wdep0, hints[0]);
         if (ldep0 < 0) {
             return false;
         }
         // use point depth to determine value
         wdep0 = 1. - 1. / (mGridDep(ldep0 + 1) - mGridDep(ldep0)) * (dep - mGridDep(ldep0));
     } else {
-        XMath::interpLinear(dep, mGridDep, ldep0, wdep0);
+        mLookupDep.interpLinear(dep, ldep0, wdep0, hints[0]);
     }
-    XMath::interpLinear(lat, mGridLat, llat0, wlat0);
-    XMath::interpLinear(lon, mGridLon, llon0, wlon0);    
+    mLookupLat.interpLinear(lat, llat0, wlat0, hints[1]);
+    mLookupLon.interpLinear(lon, llon0, wlon0, hints[2]);
     if (ldep0 < 0 || llat0 < 0 || llon0 < 0) {
         return false;
     }
     
-    ldep1 = ldep0 + 1;
-    llat1 = llat0 + 1;
-    llon1 = llon0 + 1;
-    wdep1 = 1. - wdep0;
-    wlat1 = 1. - wlat0;
-    wlon1 = 1. - wlon0;
-    
-    values[0] += mGridData[ldep0](llat0, llon0) * wdep0 * wlat0 * wlon0;
-    values[0] += mGridData[ldep0](llat1, llon0) * wdep0 * wlat1 * wlon0;
-    values[0] += mGridData[ldep0](llat0, llon1) * wdep0 * wlat0 * wlon1;
-    values[0] += mGridData[ldep0](llat1, llon1) * wdep0 * wlat1 * wlon1;
-    values[0] += mGridData[ldep1](llat0, llon0) * wdep1 * wlat0 * wlon0;
-    values[0] += mGridData[ldep1](llat1, llon0) * wdep1 * wlat1 * wlon0;
-    values[0] += mGridData[ldep1](llat0, llon1) * wdep1 * wlat0 * wlon1;
-    values[0] += mGridData[ldep1](llat1, llon1) * wdep1 * wlat1 * wlon1;
+    int ldep1 = ldep0 + 1;
+    int llat1 = llat0 + 1;
+    int llon1 = llon0 + 1;
+    double corners[8] = {
+        gridData(ldep0, llat0, llon0), gridData(ldep0, llat0, llon1),
+        gridData(ldep0, llat1, llon0), gridData(ldep0, llat1, llon1),
+        gridData(ldep1, llat0, llon0), gridData(ldep1, llat0, llon1),
+        gridData(ldep1, llat1, llon0), gridData(ldep1, llat1, llon1)};
+    value += XMath::blendTrilinear(corners, wdep0, wlat0, wlon0);
     return true;
 }
 
@@ -354,6 +501,7 @@ std::string Volumetric3D_EMC::verbose() const {
     ss << "  Factor               =   " << mFactor << std::endl;
     ss << "  Use Geographic       =   " << (mGeographic ? "YES" : "NO") << std::endl;
     ss << "  One File per Depth   =   " << (mOneFilePerDepth ? "YES" : "NO") << std::endl;
+    ss << "  Regional Loading     =   " << (mRegional ? "YES" : "NO") << std::endl;
     if (!boost::iequals(mModelFlag, "none")) {
         ss << "  Special Model Flag   =   " << mModelFlag << std::endl;
         ss << "  Model Flag Factor    =   " << mModelFlagFactor << std::endl;
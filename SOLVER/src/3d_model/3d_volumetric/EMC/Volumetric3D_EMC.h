@@ -6,6 +6,10 @@
 
 #include "Volumetric3D.h"
 #include "eigenp.h"
+#include "NodeSharedArray.h"
+#include "XMath.h"
+#include <array>
+#include <stdexcept>
 
 class Volumetric3D_EMC: public Volumetric3D {
 public:
@@ -16,9 +20,43 @@ public:
         std::vector<MaterialProperty> &properties, 
         std::vector<MaterialRefType> &refTypes,
         std::vector<double> &values) const;
+    bool get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+        std::vector<MaterialProperty> &properties, 
+        std::vector<MaterialRefType> &refTypes,
+        RDMatXX &values, IColX &inRange) const;
     std::string verbose() const;
     
+    void setLocalRange(double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep);
+    
 private:
+    // SI, factor and special flag
+    void processData(RDColX &data) const;
+    
+    // depth, lat and lon on the data grid
+    void toGrid(double r, double theta, double phi, 
+        double &dep, double &lat, double &lon) const;
+    
+    // trilinear interpolation at one point, value accumulated;
+    // hints are the cells of the previous point in depth, lat and lon
+    bool interpolate(double r, double theta, double phi, 
+        double rElemCenter, double &value, std::array<int, 3> &hints) const;
+    
+    double gridData(int idep, int ilat, int ilon) const {
+        if (mRegional) {
+            idep -= mLocalStart[0];
+            ilat -= mLocalStart[1];
+            ilon -= mLocalStart[2];
+            if (idep < 0 || idep >= mLocalCount[0] || ilat < 0 || ilat >= mLocalCount[1] 
+                || ilon < 0 || ilon >= mLocalCount[2]) {
+                throw std::runtime_error("Volumetric3D_EMC::gridData || "
+                    "Location out of the sub-grid loaded on this rank.");
+            }
+            return mLocalData(((size_t)idep * mLocalCount[1] + ilat) * mLocalCount[2] + ilon);
+        }
+        return mGridData.data()[((size_t)idep * mGridLat.size() + ilat) * mGridLon.size() + ilon];
+    };
+    
     
     // file
     std::string mFileName;
@@ -40,11 +78,21 @@ private:
     // consider vertical disc or not
     bool mVerticalDiscontinuities = true;
     
-    // data
-    std::vector<RDMatXX> mGridData;
+    // data, shared by the ranks on a node
+    NodeSharedArray mGridData;
+    
+    // regional loading: each rank reads only the sub-grid covering its 
+    // part of the mesh, indexed from mLocalStart (depth, lat, lon)
+    bool mRegional = false;
+    RDColX mLocalData;
+    std::array<int, 3> mLocalStart;
+    std::array<int, 3> mLocalCount;
     RDColX mGridDep;
     RDColX mGridLat;
     RDColX mGridLon;
+    XMath::Grid1D mLookupDep;
+    XMath::Grid1D mLookupLat;
+    XMath::Grid1D mLookupLon;
     
     // special model flag
     // abs -- use absolute value of the perturbations
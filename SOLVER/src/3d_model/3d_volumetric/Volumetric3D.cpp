@@ -9,6 +9,7 @@
 #include "Parameters.h"
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
+#include "Geodesy.h"
 
 /////////////////////////////// user-defined models here
 #include "Volumetric3D_s20rts.h"
@@ -86,3 +87,52 @@ void Volumetric3D::buildInparam(std::vector<Volumetric3D *> &models,
         }
     }
 }
+
+bool Volumetric3D::get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+    std::vector<MaterialProperty> &properties, 
+    std::vector<MaterialRefType> &refTypes,
+    RDMatXX &values, IColX &inRange) const {
+    int npnt = rtp.rows();
+    inRange.resize(npnt);
+    std::vector<double> valuesPnt;
+    bool anyInRange = false;
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        // the header is rebuilt by every call
+        properties.clear();
+        refTypes.clear();
+        inRange(ipnt) = get3dProperties(rtp(ipnt, 0), rtp(ipnt, 1), rtp(ipnt, 2), 
+            rElemCenter, properties, refTypes, valuesPnt);
+        if (ipnt == 0) {
+            values.resize(npnt, properties.size());
+        }
+        if (inRange(ipnt)) {
+            for (int iprop = 0; iprop < properties.size(); iprop++) {
+                values(ipnt, iprop) = valuesPnt[iprop];
+            }
+            anyInRange = true;
+        }
+    }
+    return anyInRange;
+}
+
+bool Volumetric3D::sphereInRegion(const RDCol3 &xyz, double radius, 
+    double rMin, double rMax, double distMin, double distMax,
+    double srcLat, double srcLon, double srcDep) {
+    // centre in the source-centred frame
+    bool defined;
+    const RDCol3 &rtp = Geodesy::rotateGlob2Src(Geodesy::toSpherical(xyz, defined), 
+        srcLat, srcLon, srcDep);
+    double r = rtp(0);
+    double dist = rtp(1);
+    // radial
+    if (r + radius < rMin || r - radius > rMax) {
+        return false;
+    }
+    // the sphere spans at most asin(radius / r) in distance about its centre
+    if (radius >= r) {
+        return true;
+    }
+    double halfAngle = asin(radius / r);
+    return dist + halfAngle >= distMin && dist - halfAngle <= distMax;
+}
+
@@ -6,6 +6,7 @@
 #pragma once
 #include <string>
 #include <vector>
+#include "eigenp.h"
 
 class Parameters;
 class ExodusModel;
@@ -56,7 +57,7 @@ public:
     
     // finalize internal variables if needed
     virtual void finalize() {};
-
+    
     // get perturbations or absolute values at location r/theta/phi 
     // IMPORTANT NOTES: 
     // a) This function should be realized such that r/theta/phi are the geocentric 
@@ -69,10 +70,28 @@ public:
     // c) output: properties, refTypes, values
     // d) return: a "false" return means the outputs are all ignored, 
     //    e.g., the input location is out of the model range
+    // e) This function must be thread-safe: quads are built concurrently, so it
+    //    may only read the model data set up in initialize().
     virtual bool get3dProperties(double r, double theta, double phi, double rElemCenter,
         std::vector<MaterialProperty> &properties, 
         std::vector<MaterialRefType> &refTypes,
         std::vector<double> &values) const = 0;
+    
+    // batched get3dProperties over the points of a quad, GLL point by GLL
+    // point and slice by slice, so that consecutive points are close
+    // a) rtp: geocentric r/theta/phi of the points, one point per row
+    // b) properties and refTypes are the same for all points
+    // c) values: one row per point and one column per property; 
+    //    inRange: whether each point is within the model range;
+    //    both are resized only when the sizes change, so that the caller 
+    //    can reuse them across models and quads without reallocation
+    // d) return: false if no point is within the model range
+    // The default implementation loops over get3dProperties; models with 
+    // location-independent headers should override it.
+    virtual bool get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+        std::vector<MaterialProperty> &properties, 
+        std::vector<MaterialRefType> &refTypes,
+        RDMatXX &values, IColX &inRange) const;
         
     // verbose 
     virtual std::string verbose() const = 0;
@@ -83,6 +102,20 @@ public:
     // obtain additional mesh information from ExodusModel, if needed
     virtual void setupExodusModel(const ExodusModel *exModel) {};
     
+    // restrict model data to the mesh on this rank, if needed; called after 
+    // domain decomposition and before any query 
+    // rMin, rMax: radial range of the local mesh
+    // distMin, distMax: range of epicentral distance, at all azimuths
+    virtual void setLocalRange(double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep) {};
+    
+    // whether the model may be in range anywhere in the ring about the source
+    // of radius [rMin, rMax] and epicentral distance [distMin, distMax],
+    // at all azimuths; a "false" return lets a quad skip all its queries,
+    // so it must be conservative. Localized models should override it.
+    virtual bool inRegion(double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep) const {return true;};
+    
     // build from input parameters
     static void buildInparam(std::vector<Volumetric3D *> &models, 
         const Parameters &par, const ExodusModel *exModel, 
@@ -92,4 +125,10 @@ public:
     // but may not create 3D fluid actually
     virtual bool makeFluid3D() const {return false;};    
 
+protected:
+    // whether a sphere, centred at xyz in the geocentric frame, may 
+    // intersect the ring of inRegion; a test for localized models
+    static bool sphereInRegion(const RDCol3 &xyz, double radius, 
+        double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep);
 };
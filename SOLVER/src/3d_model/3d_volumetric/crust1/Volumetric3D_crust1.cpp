@@ -54,40 +54,41 @@ void Volumetric3D_crust1::initialize() {
     XMPI::bcastEigen(rho);
     
     // cast to integer theta
-    mRl = mVp = mVs = mRh = RDMatXX::Zero(nrow + sNLon, sNLayer);
+    RDMatXX physRl, physVp, physVs, physRh;
+    physRl = physVp = physVs = physRh = RDMatXX::Zero(nrow + sNLon, sNLayer);
     for (int col = 0; col < sNLayer; col++) {
-        mRl.block(0, col, sNLon, 1).fill(bnd.block(0, col, sNLon, 1).sum() / sNLon);
-        mVp.block(0, col, sNLon, 1).fill(v_p.block(0, col, sNLon, 1).sum() / sNLon);
-        mVs.block(0, col, sNLon, 1).fill(v_s.block(0, col, sNLon, 1).sum() / sNLon);
-        mRh.block(0, col, sNLon, 1).fill(rho.block(0, col, sNLon, 1).sum() / sNLon);
-        mRl.block(nrow, col, sNLon, 1).fill(bnd.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
-        mVp.block(nrow, col, sNLon, 1).fill(v_p.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
-        mVs.block(nrow, col, sNLon, 1).fill(v_s.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
-        mRh.block(nrow, col, sNLon, 1).fill(rho.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
+        physRl.block(0, col, sNLon, 1).fill(bnd.block(0, col, sNLon, 1).sum() / sNLon);
+        physVp.block(0, col, sNLon, 1).fill(v_p.block(0, col, sNLon, 1).sum() / sNLon);
+        physVs.block(0, col, sNLon, 1).fill(v_s.block(0, col, sNLon, 1).sum() / sNLon);
+        physRh.block(0, col, sNLon, 1).fill(rho.block(0, col, sNLon, 1).sum() / sNLon);
+        physRl.block(nrow, col, sNLon, 1).fill(bnd.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
+        physVp.block(nrow, col, sNLon, 1).fill(v_p.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
+        physVs.block(nrow, col, sNLon, 1).fill(v_s.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
+        physRh.block(nrow, col, sNLon, 1).fill(rho.block(nrow - sNLon, col, sNLon, 1).sum() / sNLon);
     }
     for (int i = 1; i < sNLat; i++) {
-        mRl.block(i * sNLon, 0, sNLon, sNLayer) = (bnd.block(i * sNLon, 0, sNLon, sNLayer) + bnd.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
-        mVp.block(i * sNLon, 0, sNLon, sNLayer) = (v_p.block(i * sNLon, 0, sNLon, sNLayer) + v_p.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
-        mVs.block(i * sNLon, 0, sNLon, sNLayer) = (v_s.block(i * sNLon, 0, sNLon, sNLayer) + v_s.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
-        mRh.block(i * sNLon, 0, sNLon, sNLayer) = (rho.block(i * sNLon, 0, sNLon, sNLayer) + rho.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
+        physRl.block(i * sNLon, 0, sNLon, sNLayer) = (bnd.block(i * sNLon, 0, sNLon, sNLayer) + bnd.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
+        physVp.block(i * sNLon, 0, sNLon, sNLayer) = (v_p.block(i * sNLon, 0, sNLon, sNLayer) + v_p.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
+        physVs.block(i * sNLon, 0, sNLon, sNLayer) = (v_s.block(i * sNLon, 0, sNLon, sNLayer) + v_s.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
+        physRh.block(i * sNLon, 0, sNLon, sNLayer) = (rho.block(i * sNLon, 0, sNLon, sNLayer) + rho.block((i - 1) * sNLon, 0, sNLon, sNLayer)) * .5;
     } 
     // reverse south to north
-    mRl = mRl.colwise().reverse().eval();
-    mVp = mVp.colwise().reverse().eval();
-    mVs = mVs.colwise().reverse().eval();
-    mRh = mRh.colwise().reverse().eval();
+    physRl = physRl.colwise().reverse().eval();
+    physVp = physVp.colwise().reverse().eval();
+    physVs = physVs.colwise().reverse().eval();
+    physRh = physRh.colwise().reverse().eval();
     for (int i = 0; i <= sNLat; i++) {
-        mRl.block(i * sNLon, 0, sNLon, sNLayer) = mRl.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
-        mVp.block(i * sNLon, 0, sNLon, sNLayer) = mVp.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
-        mVs.block(i * sNLon, 0, sNLon, sNLayer) = mVs.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
-        mRh.block(i * sNLon, 0, sNLon, sNLayer) = mRh.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
+        physRl.block(i * sNLon, 0, sNLon, sNLayer) = physRl.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
+        physVp.block(i * sNLon, 0, sNLon, sNLayer) = physVp.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
+        physVs.block(i * sNLon, 0, sNLon, sNLayer) = physVs.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
+        physRh.block(i * sNLon, 0, sNLon, sNLayer) = physRh.block(i * sNLon, 0, sNLon, sNLayer).colwise().reverse().eval();
     }
     
     // convert to SI
-    mVp *= 1e3;
-    mVs *= 1e3;
-    mRh *= 1e3;
-    mRl *= 1e3;
+    physVp *= 1e3;
+    physVs *= 1e3;
+    physRh *= 1e3;
+    physRl *= 1e3;
     
     // layers
     if (mIncludeIce) {
@@ -99,10 +100,10 @@ void Volumetric3D_crust1::initialize() {
     // linear mapping to sphere
     const RDColX &rmoho = RDColX::Constant(nrow + sNLon, mRMoho);
     const RDColX &rdiff = (RDColX::Constant(nrow + sNLon, mRSurf - mRMoho).array() 
-        / (mRl.col(colSurf) - mRl.col(colMoho)).array()).matrix();
-    RDMatXX copyRl = mRl;    
+        / (physRl.col(colSurf) - physRl.col(colMoho)).array()).matrix();
+    RDMatXX copyRl = physRl;    
     for (int i = 0; i < sNLayer; i++) {
-        mRl.col(i).array() = rdiff.array() * (copyRl.col(i) - copyRl.col(colMoho)).array() + rmoho.array();
+        physRl.col(i).array() = rdiff.array() * (copyRl.col(i) - copyRl.col(colMoho)).array() + rmoho.array();
     }
     
     // above: physical layers
@@ -127,7 +128,8 @@ void Volumetric3D_crust1::initialize() {
     }
     
     // zero properties
-    mVpGLL = mVsGLL = mRhGLL = RDMatXX::Zero(nrow + sNLon, numGll);
+    RDMatXX vpGLL, vsGLL, rhGLL;
+    vpGLL = vsGLL = rhGLL = RDMatXX::Zero(nrow + sNLon, numGll);
     
     // form values at GLL boundaries
     for (int igll = 0; igll < numGll; igll++) {
@@ -141,11 +143,11 @@ void Volumetric3D_crust1::initialize() {
         double gll_mid = mRlGLL(imid);
         double gll_bot = mRlGLL(ibot);
         double gll_mid_value = 2. / (gll_top - gll_bot);
-        for (int row = 0; row < mRl.rows(); row++) {
+        for (int row = 0; row < physRl.rows(); row++) {
             // integrate
             for (int ilayer = colSurf; ilayer < colMoho; ilayer++) {
-                double phy_top = mRl(row, ilayer);
-                double phy_bot = mRl(row, ilayer + 1);
+                double phy_top = physRl(row, ilayer);
+                double phy_bot = physRl(row, ilayer + 1);
                 // top to mid
                 double top = std::min(phy_top, gll_top);
                 double bot = std::max(phy_bot, gll_mid);
@@ -153,9 +155,9 @@ void Volumetric3D_crust1::initialize() {
                     double gllt = gll_mid_value / (gll_top - gll_mid) * (gll_top - top);
                     double gllb = gll_mid_value / (gll_top - gll_mid) * (gll_top - bot);
                     double area = .5 * (gllt + gllb) * (top - bot);
-                    mVpGLL(row, igll) += mVp(row, ilayer) * area;
-                    mVsGLL(row, igll) += mVs(row, ilayer) * area;
-                    mRhGLL(row, igll) += mRh(row, ilayer) * area; 
+                    vpGLL(row, igll) += physVp(row, ilayer) * area;
+                    vsGLL(row, igll) += physVs(row, ilayer) * area;
+                    rhGLL(row, igll) += physRh(row, ilayer) * area; 
                 }
                 // mid to bot
                 top = std::min(phy_top, gll_mid);
@@ -164,14 +166,19 @@ void Volumetric3D_crust1::initialize() {
                     double gllt = gll_mid_value / (gll_mid - gll_bot) * (top - gll_bot);
                     double gllb = gll_mid_value / (gll_mid - gll_bot) * (bot - gll_bot);
                     double area = .5 * (gllt + gllb) * (top - bot);
-                    mVpGLL(row, igll) += mVp(row, ilayer) * area;
-                    mVsGLL(row, igll) += mVs(row, ilayer) * area;
-                    mRhGLL(row, igll) += mRh(row, ilayer) * area; 
+                    vpGLL(row, igll) += physVp(row, ilayer) * area;
+                    vsGLL(row, igll) += physVs(row, ilayer) * area;
+                    rhGLL(row, igll) += physRh(row, ilayer) * area; 
                 } 
             }
         }
     }
     
+    // held once per node
+    mVpGLL.share(vpGLL, false);
+    mVsGLL.share(vsGLL, false);
+    mRhGLL.share(rhGLL, false);
+    
     // grid lat and lon
     mGridLat = RDColX(sNLat + 1);
     mGridLon = RDColX(sNLon + 1); // one bigger than data
@@ -181,6 +188,8 @@ void Volumetric3D_crust1::initialize() {
     for (int i = 0; i < sNLon + 1; i++) {
         mGridLon[i] = i * 1. - 179.5;
     }
+    mLookupLat = XMath::Grid1D(mGridLat);
+    mLookupLon = XMath::Grid1D(mGridLon);
     
     // std::fstream fsdr;
     // fsdr.open("/Users/kuangdai/Desktop/crust1/vp1.txt", std::fstream::out);
@@ -265,6 +274,41 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
     if (rElemCenter > mRSurf || rElemCenter < mRMoho) {
         return false;
     } 
+    interpolate(r, theta, phi, values[0], values[1], values[2]);
+    return true;
+}
+
+bool Volumetric3D_crust1::get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+    std::vector<MaterialProperty> &properties, 
+    std::vector<MaterialRefType> &refTypes,
+    RDMatXX &values, IColX &inRange) const {
+    
+    // header
+    properties.clear();
+    properties.push_back(Volumetric3D::MaterialProperty::VP);
+    properties.push_back(Volumetric3D::MaterialProperty::VS);
+    properties.push_back(Volumetric3D::MaterialProperty::RHO);
+    refTypes.assign(3, Volumetric3D::MaterialRefType::Absolute);
+    int npnt = rtp.rows();
+    values.resize(npnt, 3);
+    inRange.resize(npnt);
+    
+    // not in crust 
+    if (rElemCenter > mRSurf || rElemCenter < mRMoho) {
+        inRange.setZero();
+        return false;
+    }
+    
+    inRange.setOnes();
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        interpolate(rtp(ipnt, 0), rtp(ipnt, 1), rtp(ipnt, 2), 
+            values(ipnt, 0), values(ipnt, 1), values(ipnt, 2));
+    }
+    return npnt > 0;
+}
+
+void Volumetric3D_crust1::interpolate(double r, double theta, double phi, 
+    double &vpOut, double &vsOut, double &rhoOut) const {
     
     // convert theta to co-latitude 
     if (mGeographic) {
@@ -286,8 +330,8 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
     // interpolation on sphere
     int llat[2], llon[2];
     double wlat[2], wlon[2];
-    XMath::interpLinear(lat, mGridLat, llat[0], wlat[0]);
-    XMath::interpLinear(lon, mGridLon, llon[0], wlon[0]);    
+    mLookupLat.interpLinear(lat, llat[0], wlat[0]);
+    mLookupLon.interpLinear(lon, llon[0], wlon[0]);
     llat[1] = llat[0] + 1;
     llon[1] = llon[0] + 1;
     wlat[1] = 1. - wlat[0];
@@ -300,6 +344,9 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
     if (r >= mRSurf * 0.999999) r = mRSurf * 0.999999;
     if (r <= mRMoho * 1.000001) r = mRMoho * 1.000001;
     
+    const Eigen::Map<const RDMatXX> &vpGLL = mVpGLL.matrix();
+    const Eigen::Map<const RDMatXX> &vsGLL = mVsGLL.matrix();
+    const Eigen::Map<const RDMatXX> &rhGLL = mRhGLL.matrix();
     double v_p = 0.;
     double v_s = 0.;
     double rho = 0.;
@@ -310,12 +357,12 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
             bool found = false;
             for (int iLayer = 1; iLayer < mRlGLL.rows(); iLayer++) {
                 if (r > mRlGLL(iLayer)) {
-                    double v_ptop = mVpGLL(rowdata, iLayer - 1);
-                    double v_stop = mVsGLL(rowdata, iLayer - 1);
-                    double rhotop = mRhGLL(rowdata, iLayer - 1);
-                    double v_pbot = mVpGLL(rowdata, iLayer);
-                    double v_sbot = mVsGLL(rowdata, iLayer);
-                    double rhobot = mRhGLL(rowdata, iLayer);
+                    double v_ptop = vpGLL(rowdata, iLayer - 1);
+                    double v_stop = vsGLL(rowdata, iLayer - 1);
+                    double rhotop = rhGLL(rowdata, iLayer - 1);
+                    double v_pbot = vpGLL(rowdata, iLayer);
+                    double v_sbot = vsGLL(rowdata, iLayer);
+                    double rhobot = rhGLL(rowdata, iLayer);
                     double top = mRlGLL(iLayer - 1);
                     double bot = mRlGLL(iLayer);
                     double vp = (v_ptop - v_pbot) / (top - bot) * (r - bot) + v_pbot;
@@ -329,7 +376,7 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
                 }
             } 
             if (!found) {
-                throw std::runtime_error("Volumetric3D_crust1::get3dProperties || Please report this bug.");
+                throw std::runtime_error("Volumetric3D_crust1::interpolate || Please report this bug.");
             }
         }
     }
@@ -338,10 +385,9 @@ bool Volumetric3D_crust1::get3dProperties(double r, double theta, double phi, do
     v_s = std::max(v_s, 500.);
     v_p = std::max(v_p, sqrt(2) * v_s);
     
-    values[0] = v_p;
-    values[1] = v_s;
-    values[2] = rho;
-    return true;
+    vpOut = v_p;
+    vsOut = v_s;
+    rhoOut = rho;
 }
 
 std::string Volumetric3D_crust1::verbose() const {
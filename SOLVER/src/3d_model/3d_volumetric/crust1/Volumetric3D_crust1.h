@@ -6,6 +6,8 @@
 #pragma once
 #include "Volumetric3D.h"
 #include "eigenp.h"
+#include "XMath.h"
+#include "NodeSharedArray.h"
 
 class Volumetric3D_crust1: public Volumetric3D {
     
@@ -18,12 +20,21 @@ public:
         std::vector<MaterialRefType> &refTypes,
         std::vector<double> &values) const;
     
+    bool get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+        std::vector<MaterialProperty> &properties, 
+        std::vector<MaterialRefType> &refTypes,
+        RDMatXX &values, IColX &inRange) const;
+    
     std::string verbose() const;
     
     void setupExodusModel(const ExodusModel *exModel);
     
 private:
     
+    // bilinear on sphere and linear in radius, at a point within the crust
+    void interpolate(double r, double theta, double phi, 
+        double &vpOut, double &vsOut, double &rhoOut) const;
+    
     int columnSurf() const {
         int colSurf = 5; // no ice, no sediment
         if (mIncludeIce) {
@@ -55,18 +66,14 @@ private:
     // element boundaries in mesh
     std::vector<double> mElementBoundaries;
     
-    // original data mapped onto reference sphere
-    RDMatXX mRl;
-    RDMatXX mVp;
-    RDMatXX mVs;
-    RDMatXX mRh;
-    
-    // thickness weighted data mapped onto reference sphere
+    // thickness weighted data mapped onto reference sphere,
+    // shared by the ranks on a node
     RDColX mRlGLL;
-    RDMatXX mVpGLL;
-    RDMatXX mVsGLL;
-    RDMatXX mRhGLL;
+    NodeSharedArray mVpGLL;
+    NodeSharedArray mVsGLL;
+    NodeSharedArray mRhGLL;
     
     // lat and lon grid
     RDColX mGridLat, mGridLon;
+    XMath::Grid1D mLookupLat, mLookupLon;
 };
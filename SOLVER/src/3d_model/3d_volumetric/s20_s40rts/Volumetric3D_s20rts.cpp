@@ -16,6 +16,8 @@ extern "C" {
     void __s20rts_MOD_finalize_s20rts();
     bool __s20rts_MOD_perturb_s20rts(double *r, double *theta, double *phi, double *r_center,
         double *vp, double *vs);
+    bool __s20rts_MOD_perturb_ring_s20rts(int *npnt, const double r[], const double theta[], 
+        const double phi[], double *r_center, double vp[], double vs[]);
 };
 
 
@@ -90,6 +92,29 @@ bool Volumetric3D_s20rts::get3dProperties(double r, double theta, double phi, do
     return result;
 }
 
+bool Volumetric3D_s20rts::get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+    std::vector<MaterialProperty> &properties, 
+    std::vector<MaterialRefType> &refTypes,
+    RDMatXX &values, IColX &inRange) const {
+    
+    // header
+    properties.clear();
+    properties.push_back(Volumetric3D::MaterialProperty::VP);
+    properties.push_back(Volumetric3D::MaterialProperty::VS);
+    properties.push_back(Volumetric3D::MaterialProperty::RHO);
+    refTypes.assign(3, Volumetric3D::MaterialRefType::Reference1D);
+    int npnt = rtp.rows();
+    values.resize(npnt, 3);
+    inRange.resize(npnt);
+    
+    // ring-wise evaluation, radial and Legendre terms shared by the points
+    bool result = __s20rts_MOD_perturb_ring_s20rts(&npnt, rtp.col(0).data(), rtp.col(1).data(), 
+        rtp.col(2).data(), &rElemCenter, values.col(0).data(), values.col(1).data());
+    values.col(2) = mScaleRho * values.col(1);
+    inRange.setConstant(result ? 1 : 0);
+    return result && npnt > 0;
+}
+
 std::string Volumetric3D_s20rts::verbose() const {
     std::stringstream ss;
     ss << "\n======================= 3D Volumetric ======================" << std::endl;
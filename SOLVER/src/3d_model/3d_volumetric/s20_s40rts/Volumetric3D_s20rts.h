@@ -19,6 +19,11 @@ public:
         std::vector<MaterialRefType> &refTypes,
         std::vector<double> &values) const;
     
+    bool get3dPropertiesBatch(const RDMatX3 &rtp, double rElemCenter,
+        std::vector<MaterialProperty> &properties, 
+        std::vector<MaterialRefType> &refTypes,
+        RDMatXX &values, IColX &inRange) const;
+    
     std::string verbose() const;
     
 private:
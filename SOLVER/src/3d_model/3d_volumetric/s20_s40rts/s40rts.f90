@@ -70,7 +70,7 @@ module s40rts
     double precision, dimension(:, :), allocatable :: S40RTS_V_qq0
     double precision, dimension(:, :, :), allocatable :: S40RTS_V_qq
     
-    public :: initialize_s40rts, finalize_s40rts, perturb_s40rts 
+    public :: initialize_s40rts, finalize_s40rts, perturb_s40rts, perturb_ring_s40rts
     private
     
 contains
@@ -237,6 +237,110 @@ contains
     !--------------------------------------------------------------------------------------------------
     !
     
+    ! ring-wise version of perturb_s40rts at npnt points sharing r_center
+    ! the radial contraction of the coefficients is redone only when the radius 
+    ! changes and the Legendre functions only when theta changes; cos(m phi) and 
+    ! sin(m phi) are formed by the Chebyshev recurrence
+    ! all points of a GLL ring share the radius, and also theta if the source 
+    ! lies on the pole
+    function perturb_ring_s40rts(npnt, r_abs, theta, phi, r_center_abs, dvp, dvs) &
+        bind(C, name="__s40rts_MOD_perturb_ring_s40rts")
+        
+        implicit none
+        
+        integer, intent(in) :: npnt
+        double precision, intent(in) :: r_abs(npnt), theta(npnt), phi(npnt), r_center_abs
+        double precision, intent(out) :: dvs(npnt), dvp(npnt)
+        logical :: perturb_ring_s40rts
+        
+        ! local parameters
+        double precision, parameter :: ZERO_ = 0.d0
+        
+        integer :: ipnt, l, m, k
+        double precision :: r_moho, r_cmb, xr, radius, r_center, radius_last, theta_last
+        double precision :: radial_basis(0:NK_20)
+        double precision :: dvs_alm(0:NS_40, 0:NS_40), dvs_blm(0:NS_40, 0:NS_40)
+        double precision :: dvp_alm(0:NS_40, 0:NS_40), dvp_blm(0:NS_40, 0:NS_40)
+        double precision :: sint, cost, x(2 * NS_40 + 1, 0:NS_40), dx(2 * NS_40 + 1)
+        double precision :: cosm(0:NS_40), sinm(0:NS_40)
+        
+        dvs = ZERO_
+        dvp = ZERO_
+        r_moho = RMOHO_Par / REARTH_Par
+        r_cmb = RCMB_Par / REARTH_Par
+        r_center = r_center_abs / REARTH_Par
+        if (r_center >= r_moho .or. r_center <= r_cmb) then 
+            perturb_ring_s40rts = .false.
+            return
+        endif
+        
+        radius_last = -1.d0
+        theta_last = -1.d0
+        do ipnt = 1, npnt
+            radius = r_abs(ipnt) / REARTH_Par
+            ! element inside mantle but point outside
+            if (radius >= r_moho * 0.999999d0) radius = r_moho * 0.999999d0 
+            if (radius <= r_cmb * 1.000001d0) radius = r_cmb * 1.000001d0
+            
+            ! coefficients contracted with the radial basis
+            if (radius /= radius_last) then
+                radius_last = radius
+                xr = -1.0d0 + 2.0d0 * (radius - r_cmb) / (r_moho - r_cmb)
+                do k = 0, NK_20
+                    radial_basis(k) = s40rts_rsple(1, NK_20 + 1, S40RTS_V_spknt(1), &
+                    S40RTS_V_qq0(1, NK_20 + 1 - k), S40RTS_V_qq(1, 1, NK_20 + 1 - k), xr)
+                enddo
+                do l = 0, NS_40
+                    dvs_alm(l, 0) = dot_product(radial_basis, S40RTS_V_dvs_a(:, l, 0))
+                    dvp_alm(l, 0) = dot_product(radial_basis, S40RTS_V_dvp_a(:, l, 0))
+                    do m = 1, l
+                        dvs_alm(l, m) = dot_product(radial_basis, S40RTS_V_dvs_a(:, l, m))
+                        dvp_alm(l, m) = dot_product(radial_basis, S40RTS_V_dvp_a(:, l, m))
+                        dvs_blm(l, m) = dot_product(radial_basis, S40RTS_V_dvs_b(:, l, m))
+                        dvp_blm(l, m) = dot_product(radial_basis, S40RTS_V_dvp_b(:, l, m))
+                    enddo
+                enddo
+            endif
+            
+            ! Legendre functions of all degrees
+            if (theta(ipnt) /= theta_last) then
+                theta_last = theta(ipnt)
+                do l = 0, NS_40
+                    ! lgndr may clip sint
+                    sint = dsin(theta(ipnt))
+                    cost = dcos(theta(ipnt))
+                    call lgndr(l, cost, sint, x(1, l), dx)
+                enddo
+            endif
+            
+            ! cos(m phi) and sin(m phi)
+            cosm(0) = 1.d0
+            sinm(0) = 0.d0
+            cosm(1) = dcos(phi(ipnt))
+            sinm(1) = dsin(phi(ipnt))
+            do m = 2, NS_40
+                cosm(m) = 2.d0 * cosm(1) * cosm(m - 1) - cosm(m - 2)
+                sinm(m) = 2.d0 * cosm(1) * sinm(m - 1) - sinm(m - 2)
+            enddo
+            
+            do l = 0, NS_40
+                dvs(ipnt) = dvs(ipnt) + dvs_alm(l, 0) * x(1, l)
+                dvp(ipnt) = dvp(ipnt) + dvp_alm(l, 0) * x(1, l)
+                do m = 1, l
+                    dvs(ipnt) = dvs(ipnt) + (dvs_alm(l, m) * cosm(m) + dvs_blm(l, m) * sinm(m)) * x(m + 1, l)
+                    dvp(ipnt) = dvp(ipnt) + (dvp_alm(l, m) * cosm(m) + dvp_blm(l, m) * sinm(m)) * x(m + 1, l)
+                enddo
+            enddo
+        enddo
+        
+        perturb_ring_s40rts = .true.
+        
+    end function perturb_ring_s40rts
+    
+    !
+    !--------------------------------------------------------------------------------------------------
+    !
+    
     subroutine s40rts_splhsetup
         
         implicit none
@@ -18,6 +18,12 @@ public:
     
     std::string verbose() const;
     
+    bool inRegion(double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep) const {
+        return sphereInRegion(mXyzBubble, mRadius + 4. * mHWHM, 
+            rMin, rMax, distMin, distMax, srcLat, srcLon, srcDep);
+    };
+    
     void setSourceLocation(double srcLat, double srcLon, double srcDep) {
         mSrcLat = srcLat;
         mSrcLon = srcLon;
@@ -32,13 +38,13 @@ private:
     
     // value inside the bubble
     double mValueInside; 
-
+    
     // reference type
     MaterialRefType mReferenceType;
     
     // radius of the bubble
     double mRadius;
-
+    
     // center of the bubble
     double mDepth;
     double mLat, mLon;
@@ -18,6 +18,16 @@ public:
     
     std::string verbose() const;
     
+    bool inRegion(double rMin, double rMax, double distMin, double distMax,
+        double srcLat, double srcLon, double srcDep) const {
+        // sphere about the middle of the axis bounding the decay 
+        double halfLength = mLength / 2. + 4. * mHWHM_top_bot;
+        double halfWidth = mRadius + 4. * mHWHM_lateral;
+        return sphereInRegion((mXyzPoint1 + mXyzPoint2) / 2., 
+            sqrt(halfLength * halfLength + halfWidth * halfWidth),
+            rMin, rMax, distMin, distMax, srcLat, srcLon, srcDep);
+    };
+    
     void setSourceLocation(double srcLat, double srcLon, double srcDep) {
         mSrcLat = srcLat;
         mSrcLon = srcLon;
@@ -32,13 +42,13 @@ private:
     
     // value inside the cylinder
     double mValueInside; 
-
+    
     // reference type
     MaterialRefType mReferenceType;
     
     // radius of the cylinder
     double mRadius;
-
+    
     // anchor points of the cylinder
     double mD1, mD2;
     double mLat1, mLat2;
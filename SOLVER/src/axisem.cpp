@@ -4,192 +4,371 @@
 
 #include "axisem.h"
 #include "MultilevelTimer.h"
+#include "Timeline.h"
 
 #include "XMPI.h"
 #include "eigenc.h"
 #include "eigenp.h"
 
-int axisem_main(int argc, char *argv[]) {
+void axisem_case() {
     
-    try {
-        
-        // variable sets
-        PreloopVariables pl;
-        SolverVariables sv;
-        
-        // initialize mpi
-        XMPI::initialize(argc, argv);
-        
-        //////// spectral-element constants
-        SpectralConstants::initialize(nPol);  
-        
-        //////// input parameters 
-        int verbose;
-        Parameters::buildInparam(pl.mParameters, verbose);
-        
-        //////// preloop timer
-        MultilevelTimer::initialize(Parameters::sOutputDirectory + "/develop/preloop_timer.txt", 4);
-        if (pl.mParameters->getValue<bool>("DEVELOP_DIAGNOSE_PRELOOP")) {
-            MultilevelTimer::enable();
+    // variable sets
+    PreloopVariables pl;
+    SolverVariables sv;
+    
+    //////// small input files, broadcast in one message
+    InputBundle::initialize();
+    
+    //////// spectral-element constants
+    SpectralConstants::initialize(nPol);  
+    
+    //////// input parameters 
+    int verbose;
+    Parameters::buildInparam(pl.mParameters, verbose);
+    int npol = pl.mParameters->getValue<int>("OPTION_NPOL");
+    if (npol > 0 && npol != nPol) {
+        throw std::runtime_error("axisem_main || OPTION_NPOL differs from "
+            "nPol of the solver, which main has not handed over to.");
+    }
+    
+    //////// threads and pages, before anything large is touched
+    Affinity::setHugePages(pl.mParameters->getValue<bool>("OMP_HUGE_PAGES"));
+    Affinity::bindThreads(pl.mParameters->getValue<std::string>("OMP_THREAD_AFFINITY"));
+    if (verbose) {
+        XMPI::cout << Affinity::verbose();
+    }
+    
+    //////// preloop timer
+    MultilevelTimer::initialize(Parameters::sOutputDirectory + "/develop/preloop_timer.txt", 4);
+    if (pl.mParameters->getValue<bool>("DEVELOP_DIAGNOSE_PRELOOP")) {
+        MultilevelTimer::enable();
+    }
+    Timeline::initialize(Parameters::sOutputDirectory + "/develop/timeline.json", 
+        pl.mParameters->getValue<int>("OPTION_TIMELINE_INTERVAL"));
+    
+    //////// exodus model and attenuation parameters 
+    MultilevelTimer::begin("Build Exodus", 0);
+    ExodusModel::buildInparam(pl.mExodusModel, *(pl.mParameters), pl.mAttParameters, verbose);
+    MultilevelTimer::end("Build Exodus", 0);
+    
+    //////// source
+    MultilevelTimer::begin("Build Source", 0);
+    Source::buildInparam(pl.mSource, *(pl.mParameters), verbose);
+    double srcLat = pl.mSource->getLatitude();
+    double srcLon = pl.mSource->getLongitude();
+    double srcDep = pl.mSource->getDepth();
+    MultilevelTimer::end("Build Source", 0);
+    
+    //////// fourier field, wisdoms re-projected onto the source
+    MultilevelTimer::begin("Build NrField", 0);
+    NrField::buildInparam(pl.mNrField, *(pl.mParameters), srcLat, srcLon, srcDep, verbose);
+    MultilevelTimer::end("Build NrField", 0);
+    
+    //////// 3D models 
+    MultilevelTimer::begin("Build 3D Models", 0);
+    Volumetric3D::buildInparam(pl.mVolumetric3D, *(pl.mParameters), pl.mExodusModel, 
+        srcLat, srcLon, srcDep, verbose);
+    Geometric3D::buildInparam(pl.mGeometric3D, *(pl.mParameters), verbose);
+    OceanLoad3D::buildInparam(pl.mOceanLoad3D, *(pl.mParameters), verbose);
+    MultilevelTimer::end("Build 3D Models", 0);
+    
+    //////// mesh, phase 1
+    // define mesh
+    MultilevelTimer::begin("Mesh Definition", 0);
+    pl.mMesh = new Mesh(pl.mExodusModel, pl.mNrField, 
+        srcLat, srcLon, srcDep, *(pl.mParameters), verbose);
+    pl.mMesh->setVolumetric3D(pl.mVolumetric3D);
+    pl.mMesh->setGeometric3D(pl.mGeometric3D);
+    pl.mMesh->setOceanLoad3D(pl.mOceanLoad3D);
+    MultilevelTimer::end("Mesh Definition", 0);
+    
+    // build unweighted local mesh 
+    MultilevelTimer::begin("Build Unweighted Mesh", 0);
+    pl.mMesh->buildUnweighted();
+    MultilevelTimer::end("Build Unweighted Mesh", 0);
+    
+    //////// static variables in solver, mainly FFTW
+    bool disableWisdomFFTW = pl.mParameters->getValue<bool>("FFTW_DISABLE_WISDOM");
+    bool sharedWisdomFFTW = pl.mParameters->getValue<bool>("FFTW_SHARED_WISDOM");
+    int nThreadsFFTW = pl.mParameters->getValue<int>("FFTW_NUM_THREADS");
+    int nrThreadsFFTW = pl.mParameters->getValue<int>("FFTW_THREADS_NR_THRESHOLD");
+    double adaptiveNuTol = pl.mParameters->getValue<double>("NU_ADAPTIVE_TOLERANCE");
+    MultilevelTimer::begin("Initialize FFTW", 0);
+    initializeSolverStatic(pl.mMesh->getMaxNr(), pl.mMesh->getNrSet(), 
+        disableWisdomFFTW, sharedWisdomFFTW, nThreadsFFTW, nrThreadsFFTW, adaptiveNuTol); 
+    MultilevelTimer::end("Initialize FFTW", 0);
+    
+    //////// dt
+    MultilevelTimer::begin("Compute DT", 0);
+    double dt = pl.mParameters->getValue<double>("TIME_DELTA_T");
+    if (dt < tinyDouble) {
+        dt = pl.mMesh->getDeltaT();
+    }
+    double dt_fact = pl.mParameters->getValue<double>("TIME_DELTA_T_FACTOR");
+    if (dt_fact < tinyDouble) {
+        dt_fact = 1.0;
+    }
+    dt *= dt_fact;
+    std::string timeScheme = pl.mParameters->getValue<std::string>("TIME_SCHEME");
+    if (pl.mParameters->getValue<double>("TIME_DELTA_T") < tinyDouble) {
+        dt *= Newmark::schemeStability(timeScheme);
+    }
+    if (!boost::iequals(pl.mParameters->getValue<std::string>("BOX_INJECTION_MODE"), "none") &&
+        Newmark::schemeStages(timeScheme).size() > 1) {
+        // the boundary stiffness is recorded once per step
+        throw std::runtime_error("axisem_main || "
+            "Multi-stage time schemes cannot be used with box injection.");
+    }
+    MultilevelTimer::end("Compute DT", 0);
+    
+    //////// attenuation
+    MultilevelTimer::begin("Build Attenuation", 0);
+    AttBuilder::buildInparam(pl.mAttBuilder, *(pl.mParameters), pl.mAttParameters, dt, verbose);
+    if (pl.mAttBuilder && Newmark::schemeStages(timeScheme).size() > 1) {
+        // memory variables are advanced by dt on every stiffness evaluation
+        throw std::runtime_error("axisem_main || "
+            "Multi-stage time schemes cannot be used with attenuation.");
+    }
+    MultilevelTimer::end("Build Attenuation", 0);
+    
+    //////// mesh, phase 2
+    MultilevelTimer::begin("Build Weighted Mesh", 0);
+    pl.mMesh->setAttBuilder(pl.mAttBuilder);
+    pl.mMesh->buildWeighted();
+    pl.finalizeVolumetric3D();
+    MultilevelTimer::end("Build Weighted Mesh", 0);
+    
+    //////// memory budget, before the domain is allocated
+    double budgetMB = pl.mParameters->getValue<double>("OPTION_MEMORY_BUDGET_MB");
+    bool dryRun = pl.mParameters->getValue<bool>("OPTION_MEMORY_DRY_RUN");
+    if (budgetMB > 0. || dryRun) {
+        MultilevelTimer::begin("Predict Memory", 0);
+        std::map<std::string, double> bytes;
+        pl.mMesh->predictMemory(bytes);
+        double maxMB = 0.;
+        std::string report = Domain::reportMemory(bytes, 
+            "----------------------------- PREDICTED MEMORY FOOTPRINT BY SUBSYSTEM -----------------------------", 
+            maxMB);
+        if (verbose || dryRun) {
+            XMPI::cout << report;
         }
-        
-        //////// exodus model and attenuation parameters 
-        MultilevelTimer::begin("Build Exodus", 0);
-        ExodusModel::buildInparam(pl.mExodusModel, *(pl.mParameters), pl.mAttParameters, verbose);
-        MultilevelTimer::end("Build Exodus", 0);
-        
-        //////// fourier field 
-        MultilevelTimer::begin("Build NrField", 0);
-        NrField::buildInparam(pl.mNrField, *(pl.mParameters), verbose);
-        MultilevelTimer::end("Build NrField", 0);
-        
-        //////// source
-        MultilevelTimer::begin("Build Source", 0);
-        Source::buildInparam(pl.mSource, *(pl.mParameters), verbose);
-        double srcLat = pl.mSource->getLatitude();
-        double srcLon = pl.mSource->getLongitude();
-        double srcDep = pl.mSource->getDepth();
-        MultilevelTimer::end("Build Source", 0);
-        
-        //////// 3D models 
-        MultilevelTimer::begin("Build 3D Models", 0);
-        Volumetric3D::buildInparam(pl.mVolumetric3D, *(pl.mParameters), pl.mExodusModel, 
-            srcLat, srcLon, srcDep, verbose);
-        Geometric3D::buildInparam(pl.mGeometric3D, *(pl.mParameters), verbose);
-        OceanLoad3D::buildInparam(pl.mOceanLoad3D, *(pl.mParameters), verbose);
-        MultilevelTimer::end("Build 3D Models", 0);
-        
-        //////// mesh, phase 1
-        // define mesh
-        MultilevelTimer::begin("Mesh Definition", 0);
-        pl.mMesh = new Mesh(pl.mExodusModel, pl.mNrField, 
-            srcLat, srcLon, srcDep, *(pl.mParameters), verbose);
-        pl.mMesh->setVolumetric3D(pl.mVolumetric3D);
-        pl.mMesh->setGeometric3D(pl.mGeometric3D);
-        pl.mMesh->setOceanLoad3D(pl.mOceanLoad3D);
-        MultilevelTimer::end("Mesh Definition", 0);
-        
-        // build unweighted local mesh 
-        MultilevelTimer::begin("Build Unweighted Mesh", 0);
-        pl.mMesh->buildUnweighted();
-        MultilevelTimer::end("Build Unweighted Mesh", 0);
-        
-        //////// static variables in solver, mainly FFTW
-        bool disableWisdomFFTW = pl.mParameters->getValue<bool>("FFTW_DISABLE_WISDOM");
-        MultilevelTimer::begin("Initialize FFTW", 0);
-        initializeSolverStatic(pl.mMesh->getMaxNr(), disableWisdomFFTW); 
-        MultilevelTimer::end("Initialize FFTW", 0);
-        
-        //////// dt
-        MultilevelTimer::begin("Compute DT", 0);
-        double dt = pl.mParameters->getValue<double>("TIME_DELTA_T");
-        if (dt < tinyDouble) {
-            dt = pl.mMesh->getDeltaT();
+        if (budgetMB > 0. && maxMB > budgetMB) {
+            throw std::runtime_error("axisem_main || "
+                "Predicted memory footprint exceeds OPTION_MEMORY_BUDGET_MB. || "
+                "Predicted = " + std::to_string(maxMB) + " MB on the largest processor, "
+                "Budget = " + std::to_string(budgetMB) + " MB.");
         }
-        double dt_fact = pl.mParameters->getValue<double>("TIME_DELTA_T_FACTOR");
-        if (dt_fact < tinyDouble) {
-            dt_fact = 1.0;
+        MultilevelTimer::end("Predict Memory", 0);
+    }
+    if (dryRun) {
+        XMPI::cout << "Dry run of OPTION_MEMORY_DRY_RUN finished." << XMPI::endl;
+        MultilevelTimer::finalize();
+        pl.finalize();
+        finalizeSolverStatic();
+        Timeline::finalize();
+        return;
+    }
+    
+    //////// mesh test 
+    // test positive-definiteness and self-adjointness of stiffness and mass matrices
+    // better to turn with USE_DOUBLE 
+    // pl.mMesh->test();
+    // XMPI::barrier();
+    // exit(0);
+    
+    //////// source time function 
+    MultilevelTimer::begin("Build Source Time Function", 0);
+    STF::buildInparam(pl.mSTF, *(pl.mParameters), dt, verbose);
+    MultilevelTimer::end("Build Source Time Function", 0);
+    
+    //////// run plan, by the weights of the weighted mesh
+    if (pl.mParameters->getValue<bool>("OPTION_PLAN_RUN")) {
+        MultilevelTimer::begin("Run Plan", 0);
+        XMPI::cout << pl.mMesh->reportPlan(pl.mSTF->getSize(), 
+            Newmark::schemeStages(timeScheme).size(), budgetMB);
+        MultilevelTimer::end("Run Plan", 0);
+        XMPI::cout << "Run plan of OPTION_PLAN_RUN finished." << XMPI::endl;
+        MultilevelTimer::finalize();
+        pl.finalize();
+        finalizeSolverStatic();
+        Timeline::finalize();
+        return;
+    }
+    
+    //////// receivers
+    MultilevelTimer::begin("Build Receivers", 0);
+    ReceiverCollection::buildInparam(pl.mReceivers, *(pl.mParameters), 
+        srcLat, srcLon, srcDep, pl.mSTF->getSize(), pl.mSTF->getShift(), dt, verbose);
+    MultilevelTimer::end("Build Receivers", 0);    
+    
+    // all input files read
+    InputBundle::finalize();
+    
+    //////// computational domain
+    MultilevelTimer::begin("Computational Domain", 0);
+    sv.mDomain = new Domain();
+    
+    // release mesh
+    MultilevelTimer::begin("Release Mesh", 1);
+    pl.mMesh->release(*(sv.mDomain), true);
+    if (pl.mAttBuilder) {
+        pl.mAttBuilder->writeCache();
+    }
+    MultilevelTimer::end("Release Mesh", 1);
+    
+    // release stf, before source for the time step of a finite fault
+    MultilevelTimer::begin("Release STF", 1);
+    pl.mSTF->release(*(sv.mDomain));
+    MultilevelTimer::end("Release STF", 1);
+    
+    // release source 
+    MultilevelTimer::begin("Release Source", 1);
+    pl.mSource->release(*(sv.mDomain), *(pl.mMesh));
+    MultilevelTimer::end("Release Source", 1);
+    
+    // release receivers
+    MultilevelTimer::begin("Release Receivers", 1);
+    pl.mReceivers->release(*(sv.mDomain), *(pl.mMesh), 
+        pl.mParameters->getValue<bool>("OUT_STATIONS_DEPTH_REF"));
+    MultilevelTimer::begin("Initialize Recorders", 2);
+    sv.mCheckpoint = new Checkpoint(
+        pl.mParameters->getValue<int>("OPTION_CHECKPOINT_INTERVAL"),
+        pl.mParameters->getValue<bool>("OPTION_CHECKPOINT_RESTART"));
+    sv.mDomain->initializeRecorders(sv.mCheckpoint->getRestartStep());
+    MultilevelTimer::end("Initialize Recorders", 2);
+    MultilevelTimer::end("Release Receivers", 1);
+    
+    // sensitivity kernels, the adjoint source released around the forward one
+    std::string adjointFile = pl.mParameters->getValue<std::string>("KERNEL_ADJOINT_SOURCE_FILE");
+    if (!boost::iequals(adjointFile, "none")) {
+        MultilevelTimer::begin("Sensitivity Kernels", 1);
+        if (boost::iequals(pl.mParameters->getValue<std::string>("SOURCE_TYPE"), "adjoint") ||
+            sv.mCheckpoint->restart() || sv.mDomain->hasBoxInjection() || 
+            sv.mDomain->getNumNuWindows() > 0) {
+            throw std::runtime_error("axisem_main || Sensitivity kernels cannot be "
+                "computed with an adjoint source type, checkpoint restart, "
+                "box injection or Nu time windows.");
         }
-        dt *= dt_fact;
-        MultilevelTimer::end("Compute DT", 0);
-        
-        //////// attenuation
-        MultilevelTimer::begin("Build Attenuation", 0);
-        AttBuilder::buildInparam(pl.mAttBuilder, *(pl.mParameters), pl.mAttParameters, dt, verbose);
-        MultilevelTimer::end("Build Attenuation", 0);
-        
-        //////// mesh, phase 2
-        MultilevelTimer::begin("Build Weighted Mesh", 0);
-        pl.mMesh->setAttBuilder(pl.mAttBuilder);
-        pl.mMesh->buildWeighted();
-        MultilevelTimer::end("Build Weighted Mesh", 0);
-        
-        //////// mesh test 
-        // test positive-definiteness and self-adjointness of stiffness and mass matrices
-        // better to turn with USE_DOUBLE 
-        // pl.mMesh->test();
-        // XMPI::barrier();
-        // exit(0);
-        
-        //////// source time function 
-        MultilevelTimer::begin("Build Source Time Function", 0);
-        STF::buildInparam(pl.mSTF, *(pl.mParameters), dt, verbose);
-        MultilevelTimer::end("Build Source Time Function", 0);
-        
-        //////// receivers
-        MultilevelTimer::begin("Build Receivers", 0);
-        ReceiverCollection::buildInparam(pl.mReceivers, *(pl.mParameters), 
-            srcLat, srcLon, srcDep, pl.mSTF->getSize(), verbose);
-        MultilevelTimer::end("Build Receivers", 0);    
-        
-        //////// computational domain
-        MultilevelTimer::begin("Computational Domain", 0);
-        sv.mDomain = new Domain();
-        
-        // release mesh
-        MultilevelTimer::begin("Release Mesh", 1);
-        pl.mMesh->release(*(sv.mDomain));
-        MultilevelTimer::end("Release Mesh", 1);
-        
-        // release source 
-        MultilevelTimer::begin("Release Source", 1);
-        pl.mSource->release(*(sv.mDomain), *(pl.mMesh));
-        MultilevelTimer::end("Release Source", 1);
-        
-        // release stf 
-        MultilevelTimer::begin("Release STF", 1);
-        pl.mSTF->release(*(sv.mDomain));
-        MultilevelTimer::end("Release STF", 1);
-        
-        // release receivers
-        MultilevelTimer::begin("Release Receivers", 1);
-        pl.mReceivers->release(*(sv.mDomain), *(pl.mMesh), 
-            pl.mParameters->getValue<bool>("OUT_STATIONS_DEPTH_REF"));
-        MultilevelTimer::begin("Initialize Recorders", 2);
-        sv.mDomain->initializeRecorders();
-        MultilevelTimer::end("Initialize Recorders", 2);
-        MultilevelTimer::end("Release Receivers", 1);
-        
-        // verbose domain 
-        MultilevelTimer::begin("Verbose", 1);
+        AdjointSource *adjoint = AdjointSource::buildKernel(
+            Parameters::sInputDirectory + "/" + adjointFile, srcDep, srcLat, srcLon);
         if (verbose) {
-            XMPI::cout << sv.mDomain->verbose();
+            XMPI::cout << adjoint->verbose();
         }
-        MultilevelTimer::end("Verbose", 1);
-        MultilevelTimer::end("Computational Domain", 0);
-        
-        MultilevelTimer::finalize();
-        
-        //////////////////////// PREPROCESS DONE ////////////////////////
-        
-        //////// Newmark
-        int infoInt = pl.mParameters->getValue<int>("OPTION_LOOP_INFO_INTERVAL");
-        int stabInt = pl.mParameters->getValue<int>("OPTION_STABILITY_INTERVAL");
-        bool randomDispl = pl.mParameters->getValue<bool>("DEVELOP_RANDOMIZE_DISP0");
-        sv.mNewmark = new Newmark(sv.mDomain, infoInt, stabInt, randomDispl);
+        adjoint->release(*(sv.mDomain), *(pl.mMesh));
+        delete adjoint;
+        SensitivityKernel *kernel = new SensitivityKernel(
+            pl.mParameters->getValue<int>("KERNEL_SEGMENT_STEPS"),
+            pl.mParameters->getValue<int>("KERNEL_SAMPLE_INTERVAL"), 
+            dt, srcLat, srcLon, srcDep);
+        kernel->initialize(*(sv.mDomain), *(sv.mCheckpoint), pl.mSTF->getSize());
+        sv.mDomain->setSensitivityKernel(kernel);
+        MultilevelTimer::end("Sensitivity Kernels", 1);
+    }
+    
+    // free the mesh and the models before the solver allocates more
+    pl.finalizeModels();
+    
+    // memory footprint of the domain
+    MultilevelTimer::begin("Memory Report", 1);
+    std::map<std::string, double> domainBytes;
+    sv.mDomain->memoryBytes(domainBytes);
+    double domainMB = 0.;
+    std::string memoryReport = Domain::reportMemory(domainBytes, 
+        "---------------------------------- MEMORY FOOTPRINT BY SUBSYSTEM ----------------------------------", 
+        domainMB);
+    if (verbose) {
+        XMPI::cout << memoryReport;
+    }
+    if (budgetMB > 0. && domainMB > budgetMB) {
+        XMPI::cout << "WARNING: memory footprint of " << domainMB << " MB exceeds "
+            "OPTION_MEMORY_BUDGET_MB = " << budgetMB << " MB.\n" << XMPI::endl;
+    }
+    MultilevelTimer::end("Memory Report", 1);
+    
+    // verbose domain 
+    MultilevelTimer::begin("Verbose", 1);
+    if (verbose) {
+        XMPI::cout << sv.mDomain->verbose();
+    }
+    MultilevelTimer::end("Verbose", 1);
+    MultilevelTimer::end("Computational Domain", 0);
+    
+    MultilevelTimer::finalize();
+    
+    //////////////////////// PREPROCESS DONE ////////////////////////
+    
+    //////// Newmark
+    int infoInt = pl.mParameters->getValue<int>("OPTION_LOOP_INFO_INTERVAL");
+    int stabInt = pl.mParameters->getValue<int>("OPTION_STABILITY_INTERVAL");
+    bool randomDispl = pl.mParameters->getValue<bool>("DEVELOP_RANDOMIZE_DISP0");
+    LoopTimer::enable(pl.mParameters->getValue<bool>("OPTION_LOOP_TIMERS"));
+    PerfCounters::enable(pl.mParameters->getValue<bool>("OPTION_PERF_COUNTERS"));
+    sv.mTelemetry = new Telemetry(
+        pl.mParameters->getValue<int>("OPTION_TELEMETRY_INTERVAL"), 
+        sv.mCheckpoint->restart());
+    sv.mNewmark = new Newmark(sv.mDomain, infoInt, stabInt, randomDispl, timeScheme, 
+        sv.mCheckpoint, sv.mTelemetry);
+    
+    //////// final preparations
+    // finalize the remaining preloop variables before time loop starts
+    pl.finalize();
+    // forbid matrix allocation in time loop
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+        
+    //////// GoGoGo
+    XMPI::barrier();
+    sv.mNewmark->solve(verbose);
+    
+    //////// finalize solver
+    // solver 
+    sv.mDomain->finalizeRecorders();
+    sv.finalize();
+    // static variables in solver
+    finalizeSolverStatic();
+    // timeline of all ranks
+    Timeline::finalize();
+}
+
+int axisem_main(int argc, char *argv[]) {
+    
+    try {
         
-        //////// final preparations
-        // finalize preloop variables before time loop starts
-        pl.finalize();
-        // forbid matrix allocation in time loop
-        #ifndef NDEBUG
-            Eigen::internal::set_is_malloc_allowed(false);
-        #endif
-            
-        //////// GoGoGo
-        XMPI::barrier();
-        sv.mNewmark->solve(verbose);
+        // initialize mpi
+        XMPI::initialize(argc, argv);
         
-        //////// finalize solver
-        // solver 
-        sv.mDomain->finalizeRecorders();
-        sv.finalize();
-        // static variables in solver
-        finalizeSolverStatic();
+        // the cases of this ensemble group in turn, 
+        // or the run in the directory of the executable
+        for (const std::string &runDirectory: XMPI::runDirectories()) {
+            XMPI::setRunDirectory(runDirectory);
+            try {
+                axisem_case();
+            } catch (const CollectiveError &e) {
+                // a failed case stops its group only, which goes on
+                // with its next case
+                if (XMPI::numEnsembleGroups() == 1) {
+                    throw;
+                }
+                if (e.report()) {
+                    XMPI::cout.setp(XMPI::rank());
+                    XMPI::printException(e);
+                    XMPI::cout.resetp();
+                }
+            }
+        }
         
         // finalize mpi 
         XMPI::finalize();
         
+    } catch (const CollectiveError &e) {
+        // raised by all processors together, so MPI can be finalized
+        if (e.report()) {
+            XMPI::cout.setp(XMPI::rank());
+            XMPI::printException(e);
+        }
+        XMPI::finalize();
+        return 1;
     } catch (const std::exception &e) {
         // print exception
         XMPI::cout.setp(XMPI::rank());
@@ -213,22 +392,42 @@ int axisem_main(int argc, char *argv[]) {
 #include "SolverFFTW_N6.h"
 #include "SolverFFTW_N9.h"
 #include "PreloopFFTW.h"
+#include "NrCostTable.h"
 #include "SolidElement.h"
 #include "FluidElement.h"
 
-extern void initializeSolverStatic(int maxNr, bool disableWisdomFFTW) {
+extern void initializeSolverFFTW(int maxNr, const std::vector<int> &nrSet) {
+    SolverFFTW_1::initialize(maxNr, nrSet);
+    SolverFFTW_3::initialize(maxNr, nrSet); 
+    SolverFFTW_N3::initialize(maxNr, nrSet);
+    SolverFFTW_N6::initialize(maxNr, nrSet);
+    SolverFFTW_N9::initialize(maxNr, nrSet);
+}
+
+extern void initializeSolverStatic(int maxNr, const std::vector<int> &nrSet, 
+    bool disableWisdomFFTW, bool sharedWisdomFFTW, int nThreadsFFTW, int nrThreadsFFTW, 
+    double adaptiveNuTol) {
     // fftw
+    SolverFFTW::initThreads(nThreadsFFTW, nrThreadsFFTW);
     SolverFFTW::importWisdom(disableWisdomFFTW);
-    SolverFFTW_1::initialize(maxNr);
-    SolverFFTW_3::initialize(maxNr); 
-    SolverFFTW_N3::initialize(maxNr);
-    SolverFFTW_N6::initialize(maxNr);
-    SolverFFTW_N9::initialize(maxNr);
+    if (sharedWisdomFFTW && !disableWisdomFFTW) {
+        // root plans first, the others plan from its wisdom
+        if (XMPI::root()) {
+            initializeSolverFFTW(maxNr, nrSet);
+        }
+        SolverFFTW::shareWisdom();
+        if (!XMPI::root()) {
+            initializeSolverFFTW(maxNr, nrSet);
+        }
+    } else {
+        initializeSolverFFTW(maxNr, nrSet);
+    }
     SolverFFTW::exportWisdom();
     // PreloopFFTW::initialize(maxNr);
     // element
     SolidElement::initWorkspace(maxNr / 2);
     FluidElement::initWorkspace(maxNr / 2);
+    Element::setAdaptiveNu(adaptiveNuTol);
 };
 
 extern void finalizeSolverStatic() {
@@ -238,5 +437,7 @@ extern void finalizeSolverStatic() {
     SolverFFTW_N3::finalize();
     SolverFFTW_N6::finalize();
     SolverFFTW_N9::finalize();
+    SolverFFTW::finalizeThreads();
     PreloopFFTW::finalize();
+    NrCostTable::finalize();
 };
@@ -10,6 +10,8 @@
 // preloop 
 #include "SpectralConstants.h"
 #include "Parameters.h"
+#include "InputBundle.h"
+#include "Affinity.h"
 #include "ExodusModel.h"
 #include "NrField.h"
 #include "Volumetric3D.h"
@@ -20,10 +22,14 @@
 #include "AttBuilder.h"
 #include "STF.h"
 #include "ReceiverCollection.h"
+#include "AdjointSource.h"
 
 // solver
 #include "Domain.h"
 #include "Newmark.h"
+#include "Checkpoint.h"
+#include "Telemetry.h"
+#include "SensitivityKernel.h"
 
 struct PreloopVariables {
     Parameters *mParameters = 0;
@@ -39,39 +45,63 @@ struct PreloopVariables {
     STF *mSTF = 0;
     ReceiverCollection *mReceivers = 0;
     
-    // finalizer 
-    void finalize() {
-        if (mParameters) {delete mParameters; mParameters = 0;}
-        if (mAttParameters) {delete mAttParameters; mAttParameters = 0;}
-        if (mExodusModel) {delete mExodusModel; mExodusModel = 0;}
-        if (mNrField) {delete mNrField; mNrField = 0;}
+    // volumetric and ocean-load models, used up by the weighted build
+    void finalizeVolumetric3D() {
         for (const auto &m: mVolumetric3D) delete m;
         mVolumetric3D.clear();
+        if (mOceanLoad3D) {delete mOceanLoad3D; mOceanLoad3D = 0;}
+        if (mMesh) {
+            mMesh->setVolumetric3D(mVolumetric3D);
+            mMesh->setOceanLoad3D(0);
+        }
+    };
+    
+    // everything but the parameters, used up once released to the domain
+    void finalizeModels() {
+        if (mAttParameters) {delete mAttParameters; mAttParameters = 0;}
+        finalizeVolumetric3D();
         for (const auto &m: mGeometric3D) delete m;
         mGeometric3D.clear();
-        if (mOceanLoad3D) {delete mOceanLoad3D; mOceanLoad3D = 0;}
         if (mSource) {delete mSource; mSource = 0;}
         if (mMesh) {delete mMesh; mMesh = 0;}
         if (mAttBuilder) {delete mAttBuilder; mAttBuilder = 0;}
         if (mSTF) {delete mSTF; mSTF = 0;}
         if (mReceivers) {delete mReceivers; mReceivers = 0;}
+        // the mesh refers to these
+        if (mExodusModel) {delete mExodusModel; mExodusModel = 0;}
+        if (mNrField) {delete mNrField; mNrField = 0;}
+    };
+    
+    // finalizer 
+    void finalize() {
+        if (mParameters) {delete mParameters; mParameters = 0;}
+        finalizeModels();
     };
 };
 
 struct SolverVariables {
     Domain *mDomain = 0;
     Newmark *mNewmark = 0;
+    Checkpoint *mCheckpoint = 0;
+    Telemetry *mTelemetry = 0;
     
     // finalizer
     void finalize() {
         if (mDomain) {delete mDomain; mDomain = 0;}
         if (mNewmark) {delete mNewmark; mNewmark = 0;}
+        if (mCheckpoint) {delete mCheckpoint; mCheckpoint = 0;}
+        if (mTelemetry) {delete mTelemetry; mTelemetry = 0;}
     };
 };
 
 //////////////////////////////// functons ////////////////////////////////
 int axisem_main(int argc, char *argv[]);
-void initializeSolverStatic(int maxNr, bool disableWisdomFFTW);
+// a simulation in the input and output directories of Parameters
+void axisem_case();
+void initializeSolverFFTW(int maxNr, const std::vector<int> &nrSet);
+void initializeSolverStatic(int maxNr, const std::vector<int> &nrSet, 
+    bool disableWisdomFFTW, bool sharedWisdomFFTW, int nThreadsFFTW, int nrThreadsFFTW, 
+    double adaptiveNuTol);
 void finalizeSolverStatic();
 
 
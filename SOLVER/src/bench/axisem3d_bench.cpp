@@ -0,0 +1,388 @@
+// axisem3d_bench.cpp
+// created by Kuangdai on 14-Oct-2026
+// micro-benchmark of element and point kernels on synthetic elements
+// usage: axisem3d_bench [steps] [Nr_1 Nr_2 ...], best run on a single process
+
+#include "axisem.h"
+#include "SpectralConstants.h"
+#include "XMPI.h"
+#include "XOMP.h"
+
+#include "SolidPoint.h"
+#include "FluidPoint.h"
+#include "Mass1D.h"
+
+#include "SolidElement.h"
+#include "FluidElement.h"
+#include "Gradient.h"
+#include "PRT_1D.h"
+#include "PRT_3D.h"
+
+#include "Isotropic1D.h"
+#include "TransverselyIsotropic1D.h"
+#include "Anisotropic1D.h"
+#include "Isotropic3D.h"
+#include "TransverselyIsotropic3D.h"
+#include "Anisotropic3D.h"
+#include "Hexagonal3D.h"
+#include "Acoustic1D.h"
+#include "Acoustic3D.h"
+
+#include "Attenuation1D_Full.h"
+#include "Attenuation1D_CG4.h"
+#include "Attenuation3D_Full.h"
+#include "Attenuation3D_CG4.h"
+
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+extern "C" void set_ftz();
+
+namespace {
+
+    // material classes
+    enum BenchMaterial {Iso, TIso, Aniso, Hexa, Fluid};
+    const std::string sMaterialNames[] = {"Isotropic", "TransverselyIsotropic",
+        "Anisotropic", "Hexagonal", "Acoustic"};
+    // attenuation
+    enum BenchAttenuation {AttNone, AttFull, AttCG4};
+    const std::string sAttenuationNames[] = {"none", "Full", "CG4"};
+    // standard linear solids
+    const int sNSLS = 5;
+
+    // a kernel to benchmark
+    struct BenchCase {
+        BenchMaterial mMaterial;
+        bool m3D;
+        BenchAttenuation mAttenuation;
+        bool mPRT;
+        std::string name() const {
+            std::stringstream ss;
+            ss << sMaterialNames[mMaterial] << (m3D ? "3D" : "1D");
+            if (mMaterial != Fluid) {
+                ss << "/Att:" << sAttenuationNames[mAttenuation];
+            }
+            ss << (mPRT ? "/PRT" : "");
+            return ss.str();
+        };
+    };
+
+    // all kernels in the order of the report
+    std::vector<BenchCase> allCases() {
+        std::vector<BenchCase> cases;
+        for (bool prt: {false, true}) {
+            for (bool d3: {false, true}) {
+                for (BenchMaterial mat: {Iso, TIso, Aniso, Hexa}) {
+                    // hexagonal is 3D only
+                    if (mat == Hexa && !d3) {
+                        continue;
+                    }
+                    for (BenchAttenuation att: {AttNone, AttFull, AttCG4}) {
+                        cases.push_back({mat, d3, att, prt});
+                    }
+                }
+                cases.push_back({Fluid, d3, AttNone, prt});
+            }
+        }
+        return cases;
+    }
+
+    // nominal floating-point operations per element step, counting
+    // the gradient and quadrature products, the FFTs and the pointwise
+    // material, attenuation and relabelling arithmetic; meant for
+    // comparing builds and machines, not an exact count
+    double nominalFlops(const BenchCase &bc, int nr) {
+        int nu = nr / 2;
+        double nModes = nu + 1.;
+        // real matrix times complex matrix, nPntEdge ^ 3 multiply-adds
+        double matPP = 4. * nPntEdge * nPntEdge * nPntEdge;
+        // real-to-complex or complex-to-real FFT of length nr
+        double fft = nr > 1 ? 2.5 * nr * std::log2((double)nr) : 0.;
+        bool fluid = bc.mMaterial == Fluid;
+        bool fft3D = bc.m3D;
+
+        // gradient and quadrature, with the geometric factors
+        int nGrad = fluid ? 4 : 12;
+        double flops = nModes * (nGrad * matPP + nGrad * 4. * nPntElem);
+
+        // FFTs of strain and stress
+        int nComp = fluid ? 3 : (bc.mPRT ? 9 : 6);
+        if (fft3D) {
+            flops += 2. * nComp * nPntElem * fft;
+        }
+
+        // pointwise operations on complex modes in 1D and real slices in 3D
+        double nPointwise = fft3D ? nr * nPntElem : 2. * nModes * nPntElem;
+        const double matFlops[] = {12., 24., 72., 60., 3.};
+        flops += nPointwise * matFlops[bc.mMaterial];
+        if (bc.mPRT) {
+            flops += nPointwise * (fluid ? 16. : 48.);
+        }
+        if (bc.mAttenuation != AttNone) {
+            double nAtt = nPointwise / nPntElem * (bc.mAttenuation == AttCG4 ? nCG : nPntElem);
+            flops += nAtt * sNSLS * 6. * 8.;
+        }
+        return flops;
+    }
+
+    // a straight square element away from the axis
+    const double sHalfSize = 5e3;
+    const double sCenterS = 3e6;
+    const double sCenterZ = 4e6;
+
+    Gradient *createGradient() {
+        RDMatPP dsdxii, dsdeta, dzdxii, dzdeta, inv_s;
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, false);
+                dsdxii(ipol, jpol) = 1. / sHalfSize;
+                dsdeta(ipol, jpol) = 0.;
+                dzdxii(ipol, jpol) = 0.;
+                dzdeta(ipol, jpol) = 1. / sHalfSize;
+                inv_s(ipol, jpol) = 1. / (sCenterS + sHalfSize * xieta(0));
+            }
+        }
+        return new Gradient(dsdxii, dsdeta, dzdxii, dzdeta, inv_s, false);
+    }
+
+    std::array<Point *, nPntElem> createPoints(int nr, bool fluid) {
+        std::array<Point *, nPntElem> points;
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, false);
+                RDCol2 crds;
+                crds << sCenterS + sHalfSize * xieta(0), sCenterZ + sHalfSize * xieta(1);
+                Mass1D *mass = new Mass1D((Real)1e-10);
+                if (fluid) {
+                    points[ipol * nPntEdge + jpol] = new FluidPoint(nr, false, crds, mass, false);
+                } else {
+                    points[ipol * nPntEdge + jpol] = new SolidPoint(nr, false, crds, mass);
+                }
+            }
+        }
+        return points;
+    }
+
+    // moduli perturbed around a value
+    RMatPP modulusPP(double value) {
+        return (RMatPP::Constant((Real)value) + RMatPP::Random() * (Real)(value * .01)).eval();
+    }
+
+    RMatXN modulusXN(int nr, double value) {
+        return (RMatXN::Constant(nr, nPntElem, (Real)value) +
+            RMatXN::Random(nr, nPntElem) * (Real)(value * .01)).eval();
+    }
+
+    Attenuation1D *createAttenuation1D(BenchAttenuation att, int nr) {
+        RColX alpha = RColX::Constant(sNSLS, (Real).9);
+        RColX beta = RColX::Constant(sNSLS, (Real).05);
+        RColX gamma = RColX::Constant(sNSLS, (Real).05);
+        if (att == AttFull) {
+            return new Attenuation1D_Full(sNSLS, alpha, beta, gamma, nr / 2,
+                modulusPP(1e8), modulusPP(1e8), true);
+        } else if (att == AttCG4) {
+            return new Attenuation1D_CG4(sNSLS, alpha, beta, gamma, nr / 2,
+                RRow4::Constant((Real)1e8), RRow4::Constant((Real)1e8), true);
+        }
+        return 0;
+    }
+
+    Attenuation3D *createAttenuation3D(BenchAttenuation att, int nr) {
+        RColX alpha = RColX::Constant(sNSLS, (Real).9);
+        RColX beta = RColX::Constant(sNSLS, (Real).05);
+        RColX gamma = RColX::Constant(sNSLS, (Real).05);
+        if (att == AttFull) {
+            return new Attenuation3D_Full(sNSLS, alpha, beta, gamma,
+                modulusXN(nr, 1e8), modulusXN(nr, 1e8), true);
+        } else if (att == AttCG4) {
+            return new Attenuation3D_CG4(sNSLS, alpha, beta, gamma,
+                RMatX4::Constant(nr, nCG, (Real)1e8), RMatX4::Constant(nr, nCG, (Real)1e8), true);
+        }
+        return 0;
+    }
+
+    Elastic *createElastic(const BenchCase &bc, int nr) {
+        if (!bc.m3D) {
+            Attenuation1D *att = createAttenuation1D(bc.mAttenuation, nr);
+            if (bc.mMaterial == Iso) {
+                return new Isotropic1D(modulusPP(5e10), modulusPP(3e10), att);
+            } else if (bc.mMaterial == TIso) {
+                return new TransverselyIsotropic1D(modulusPP(1.1e11), modulusPP(1e11),
+                    modulusPP(5e10), modulusPP(3e10), modulusPP(3.2e10), att);
+            }
+            RMatPP d = modulusPP(1.1e11), o = modulusPP(5e10), s = modulusPP(3e10), z = modulusPP(1e8);
+            return new Anisotropic1D(d, o, o, z, z, z, d, o, z, z, z, d, z, z, z,
+                s, z, z, s, z, s, att);
+        }
+        Attenuation3D *att = createAttenuation3D(bc.mAttenuation, nr);
+        if (bc.mMaterial == Iso) {
+            return new Isotropic3D(modulusXN(nr, 5e10), modulusXN(nr, 3e10), att);
+        } else if (bc.mMaterial == TIso) {
+            return new TransverselyIsotropic3D(modulusXN(nr, 1.1e11), modulusXN(nr, 1e11),
+                modulusXN(nr, 5e10), modulusXN(nr, 3e10), modulusXN(nr, 3.2e10), att);
+        } else if (bc.mMaterial == Hexa) {
+            RMatXN n1 = RMatXN::Constant(nr, nPntElem, (Real).6);
+            RMatXN n2 = RMatXN::Zero(nr, nPntElem);
+            RMatXN n3 = RMatXN::Constant(nr, nPntElem, (Real).8);
+            return new Hexagonal3D(modulusXN(nr, 5e10), modulusXN(nr, 3e10),
+                modulusXN(nr, 1e9), modulusXN(nr, 1e9), modulusXN(nr, 1e9), n1, n2, n3, att);
+        }
+        RMatXN d = modulusXN(nr, 1.1e11), o = modulusXN(nr, 5e10);
+        RMatXN s = modulusXN(nr, 3e10), z = modulusXN(nr, 1e8);
+        return new Anisotropic3D(d, o, o, z, z, z, d, o, z, z, z, d, z, z, z,
+            s, z, z, s, z, s, att);
+    }
+
+    // relabelling factors close to identity
+    PRT *createPRT(const BenchCase &bc, int nr) {
+        if (!bc.mPRT) {
+            return 0;
+        }
+        if (!bc.m3D) {
+            std::array<RMatPP, 4> xstruct;
+            for (int idim = 0; idim < 4; idim++) {
+                xstruct[idim] = RMatPP::Random() * (Real).01;
+            }
+            xstruct[3].array() += (Real)1.;
+            return new PRT_1D(xstruct);
+        }
+        RMatXN4 X = RMatXN4::Random(nr, nPntElem * 4) * (Real).01;
+        X.rightCols(nPntElem).array() += (Real)1.;
+        return new PRT_3D(X);
+    }
+
+    // seconds per element step
+    double measureElement(const BenchCase &bc, int nr, int steps) {
+        bool fluid = bc.mMaterial == Fluid;
+        std::array<Point *, nPntElem> points = createPoints(nr, fluid);
+        Element *elem = 0;
+        if (fluid) {
+            Acoustic *acous = 0;
+            if (bc.m3D) {
+                acous = new Acoustic3D(modulusXN(nr, 1e-11));
+            } else {
+                acous = new Acoustic1D(modulusPP(1e-11));
+            }
+            elem = new FluidElement(createGradient(), createPRT(bc, nr), points, acous);
+        } else {
+            elem = new SolidElement(createGradient(), createPRT(bc, nr), points,
+                createElastic(bc, nr));
+        }
+        // warm-up
+        elem->measure(std::max(steps / 10, 1));
+        double cost = elem->measure(steps);
+        delete elem;
+        for (Point *point: points) {
+            delete point;
+        }
+        return cost;
+    }
+
+    // seconds per point step
+    double measurePoint(bool fluid, int nr, int steps) {
+        RDCol2 crds;
+        crds << sCenterS, sCenterZ;
+        Point *point = 0;
+        if (fluid) {
+            point = new FluidPoint(nr, false, crds, new Mass1D((Real)1e-10), false);
+        } else {
+            point = new SolidPoint(nr, false, crds, new Mass1D((Real)1e-10));
+        }
+        point->measure(std::max(steps / 10, 1));
+        double cost = point->measure(steps);
+        delete point;
+        return cost;
+    }
+
+    std::string buildOptions() {
+        std::stringstream ss;
+        ss << "nPol = " << nPol;
+        #ifdef _USE_DOUBLE
+            ss << ", double";
+        #else
+            ss << ", float";
+        #endif
+        #ifdef _USE_SIMD_KERNELS
+            ss << ", SIMD kernels";
+        #endif
+        #ifdef _USE_OPENMP
+            ss << ", OpenMP";
+        #endif
+        return ss.str();
+    }
+
+    void printRow(std::stringstream &ss, const std::string &name, int nr,
+        double seconds, double flops) {
+        ss << "  " << std::setw(48) << std::left << name;
+        ss << std::setw(6) << std::right << nr;
+        ss << std::setw(14) << std::fixed << std::setprecision(1) << seconds * 1e9;
+        if (flops > 0.) {
+            ss << std::setw(10) << std::setprecision(3) << flops / seconds * 1e-9;
+        } else {
+            ss << std::setw(10) << "-";
+        }
+        ss << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+    // denormal float handling
+    set_ftz();
+
+    try {
+        XMPI::initialize(argc, argv);
+
+        // arguments
+        int steps = 100;
+        std::vector<int> nrSet = {4, 16, 64, 256};
+        if (argc > 1) {
+            steps = std::max(std::stoi(argv[1]), 1);
+        }
+        if (argc > 2) {
+            nrSet.clear();
+            for (int iarg = 2; iarg < argc; iarg++) {
+                nrSet.push_back(std::max(std::stoi(argv[iarg]), 1));
+            }
+        }
+        int maxNr = *std::max_element(nrSet.begin(), nrSet.end());
+
+        // static solver components as in a run, with full Nu everywhere
+        SpectralConstants::initialize(nPol);
+        initializeSolverStatic(maxNr, nrSet, false, false, 1, 0, 0.);
+
+        std::stringstream ss;
+        ss << "\n=================== Kernel Benchmark ===================" << std::endl;
+        ss << "  build: " << buildOptions() << std::endl;
+        ss << "  steps per kernel: " << steps << std::endl;
+        ss << "  " << std::setw(48) << std::left << "kernel";
+        ss << std::setw(6) << std::right << "Nr";
+        ss << std::setw(14) << "ns/step" << std::setw(10) << "GFLOP/s" << std::endl;
+        XMPI::cout << ss.str();
+
+        for (int nr: nrSet) {
+            ss.str("");
+            for (const BenchCase &bc: allCases()) {
+                double cost = measureElement(bc, nr, steps);
+                printRow(ss, bc.name(), nr, cost, nominalFlops(bc, nr));
+            }
+            printRow(ss, "SolidPoint/Mass1D", nr, measurePoint(false, nr, steps), 0.);
+            printRow(ss, "FluidPoint/Mass1D", nr, measurePoint(true, nr, steps), 0.);
+            XMPI::cout << ss.str();
+        }
+        XMPI::cout << "=================== Kernel Benchmark ===================\n\n";
+
+        finalizeSolverStatic();
+        XMPI::finalize();
+        
+    } catch (const std::exception &e) {
+        XMPI::cout.setp(XMPI::rank());
+        XMPI::printException(e);
+        XMPI::abort();
+    }
+    
+    return 0;
+}
+
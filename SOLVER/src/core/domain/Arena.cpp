@@ -0,0 +1,128 @@
+// Arena.cpp
+// created by Kuangdai on 14-Oct-2026
+// bump allocator of the solver objects owned by a domain
+
+#include "Arena.h"
+#include "XOMP.h"
+#include "Affinity.h"
+#include <cstdlib>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+
+Arena *Arena::sOpen = 0;
+bool Arena::sThreaded = false;
+std::vector<std::pair<char *, char *>> Arena::sRanges;
+
+Arena::~Arena() {
+    if (sOpen == this) {
+        close();
+    }
+    for (const auto &chunk: mChunks) {
+        auto it = std::lower_bound(sRanges.begin(), sRanges.end(), 
+            std::make_pair(chunk.first, chunk.first + chunk.second));
+        if (it != sRanges.end() && it->first == chunk.first) {
+            sRanges.erase(it);
+        }
+        std::free(chunk.first);
+    }
+    for (const auto &child: mThreadArenas) {
+        delete child;
+    }
+}
+
+void Arena::open(Arena *arena, bool threaded) {
+    sOpen = arena;
+    sThreaded = false;
+    #ifdef _USE_OPENMP
+        if (arena && threaded) {
+            int nthreads = XOMP::nThreads();
+            for (int ithread = arena->mThreadArenas.size(); ithread < nthreads; ithread++) {
+                arena->mThreadArenas.push_back(new Arena(arena->mChunkBytes));
+            }
+            sThreaded = true;
+        }
+    #endif
+}
+
+void *Arena::create(size_t bytes) {
+    bool parallel = false;
+    #ifdef _USE_OPENMP
+        parallel = omp_in_parallel();
+    #endif
+    if (sOpen && !parallel) {
+        return sOpen->allocate(bytes);
+    }
+    if (sOpen && sThreaded) {
+        return sOpen->mThreadArenas[XOMP::threadID()]->allocate(bytes);
+    }
+    return ::operator new(bytes);
+}
+
+void Arena::destroy(void *ptr) {
+    if (ptr == 0) {
+        return;
+    }
+    // released with the arena
+    char *p = static_cast<char *>(ptr);
+    auto it = std::upper_bound(sRanges.begin(), sRanges.end(), 
+        std::make_pair(p, (char *)0), 
+        [](const std::pair<char *, char *> &a, const std::pair<char *, char *> &b) 
+        {return a.first < b.first;});
+    if (it != sRanges.begin() && p < (--it)->second) {
+        return;
+    }
+    ::operator delete(ptr);
+}
+
+size_t Arena::bytesReserved() const {
+    size_t bytes = 0;
+    for (const auto &chunk: mChunks) {
+        bytes += chunk.second;
+    }
+    for (const auto &child: mThreadArenas) {
+        bytes += child->bytesReserved();
+    }
+    return bytes;
+}
+
+size_t Arena::bytesUsed() const {
+    size_t bytes = mUsed;
+    for (const auto &child: mThreadArenas) {
+        bytes += child->bytesUsed();
+    }
+    return bytes;
+}
+
+void *Arena::allocate(size_t bytes) {
+    bytes = (bytes + sAlignBytes - 1) / sAlignBytes * sAlignBytes;
+    mUsed += bytes;
+    if (bytes <= mLeft) {
+        void *ptr = mTop;
+        mTop += bytes;
+        mLeft -= bytes;
+        return ptr;
+    }
+    // a large object takes a chunk of its own, leaving the current one open
+    bool large = bytes > mChunkBytes / 4;
+    size_t chunkBytes = large ? bytes : mChunkBytes;
+    // aligned to huge pages if they are advised
+    size_t alignBytes = Affinity::hugePages() ? Affinity::sHugePageBytes : sAlignBytes;
+    void *chunk = 0;
+    if (posix_memalign(&chunk, alignBytes, chunkBytes) != 0) {
+        throw std::bad_alloc();
+    }
+    Affinity::adviseHugePages(chunk, chunkBytes);
+    char *begin = static_cast<char *>(chunk);
+    mChunks.push_back(std::make_pair(begin, chunkBytes));
+    std::pair<char *, char *> range(begin, begin + chunkBytes);
+    #ifdef _USE_OPENMP
+        #pragma omp critical(Arena_ranges)
+    #endif
+    sRanges.insert(std::upper_bound(sRanges.begin(), sRanges.end(), range), range);
+    if (!large) {
+        mTop = begin + bytes;
+        mLeft = chunkBytes - bytes;
+    }
+    return begin;
+}
@@ -0,0 +1,63 @@
+// Arena.h
+// created by Kuangdai on 14-Oct-2026
+// bump allocator of the solver objects owned by a domain
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+class Arena {
+public:
+    Arena(size_t chunkBytes = sChunkBytes): mChunkBytes(chunkBytes) {};
+    ~Arena();
+    
+    // objects of ArenaObject created between open and close are placed 
+    // contiguously in arena, in the order of creation; elsewhere, and 
+    // inside parallel regions, they are created on the heap, unless
+    // threaded, with which every thread has a child arena of its own,
+    // first touched by the thread that later computes the objects
+    static void open(Arena *arena, bool threaded = false);
+    static void close() {sOpen = 0; sThreaded = false;};
+    
+    // called by ArenaObject
+    static void *create(size_t bytes);
+    static void destroy(void *ptr);
+    
+    // bytes reserved and used
+    size_t bytesReserved() const;
+    size_t bytesUsed() const;
+    
+    // alignment of every object, a cache line
+    static const size_t sAlignBytes = 64;
+    
+private:
+    void *allocate(size_t bytes);
+    
+    // chunks of this arena
+    size_t mChunkBytes;
+    std::vector<std::pair<char *, size_t>> mChunks;
+    char *mTop = 0;
+    size_t mLeft = 0;
+    size_t mUsed = 0;
+    
+    // children of the threads
+    std::vector<Arena *> mThreadArenas;
+    
+    // the open arena
+    static Arena *sOpen;
+    static bool sThreaded;
+    // chunks of all arenas as sorted ranges, to tell arena objects on delete
+    static std::vector<std::pair<char *, char *>> sRanges;
+    static const size_t sChunkBytes = 16 * 1024 * 1024;
+};
+
+// base of the classes placed in an arena, 
+// whose destructors then leave the memory to the arena
+class ArenaObject {
+public:
+    static void *operator new(size_t bytes) {return Arena::create(bytes);};
+    static void operator delete(void *ptr) {Arena::destroy(ptr);};
+};
+
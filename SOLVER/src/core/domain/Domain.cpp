@@ -4,43 +4,82 @@
 
 #include "Domain.h"
 #include "Point.h"
+#include "PointBatch.h"
 #include "Element.h"
 #include "SolidFluidPoint.h"
+#include "SFBatch.h"
+#include "SFCoupling.h"
+#include "XOMP.h"
 #include "SourceTerm.h"
 #include "SourceTimeFunction.h"
+#include "FiniteFaultTerm.h"
+#include "AdjointSourceTerm.h"
+#include "SensitivityKernel.h"
+#include "BoxInjection.h"
 #include "PointwiseRecorder.h"
 #include "SurfaceRecorder.h"
+#include "VolumetricRecorder.h"
 #include "XMPI.h"
+#include "SharedHalo.h"
+#include "HaloAggregator.h"
 #include "NuWisdom.h"
 #include "MultilevelTimer.h"
+#include "Checkpoint.h"
+#include "SolidElement.h"
+#include "FluidElement.h"
+#include "SolverFFTW_1.h"
+#include "SolverFFTW_3.h"
+#include "SolverFFTW_N3.h"
+#include "SolverFFTW_N6.h"
+#include "SolverFFTW_N9.h"
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
 
 Domain::Domain() {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerElemts = new MyBoostTimer();
-        mTimerPoints = new MyBoostTimer();
-        mTimerAssemb = new MyBoostTimer();
-        mTimerAsWait = new MyBoostTimer();
-        mTimerOthers = new MyBoostTimer();
-    #endif
+    mTimerElemts = new LoopTimer();
+    mTimerPoints = new LoopTimer();
+    mTimerAssemb = new LoopTimer();
+    mTimerAsWait = new LoopTimer();
+    mTimerOthers = new LoopTimer();
+    mArena = new Arena();
 }
 
 Domain::~Domain() {
     for (const auto &e: mPoints) {delete e;}
+    for (const auto &e: mPointBatches) {delete e;}
+    for (const auto &e: mSFBatchesBoundary) {delete e;}
+    for (const auto &e: mSFBatchesInterior) {delete e;}
     for (const auto &e: mElements) {delete e;}
     for (const auto &e: mSourceTerms) {delete e;}
+    if (mFiniteFault) {delete mFiniteFault;}
+    if (mAdjointSource) {delete mAdjointSource;}
+    if (mSensitivityKernel) {delete mSensitivityKernel;}
     if (mPointwiseRecorder) {delete mPointwiseRecorder;};
     if (mSurfaceRecorder) {delete mSurfaceRecorder;};
+    if (mVolumetricRecorder) {delete mVolumetricRecorder;};
+    if (mBoxInjection) {delete mBoxInjection;};
     if (mSTF) {delete mSTF;}
-    if (mMsgInfo) {delete mMsgInfo;}
-    if (mMsgBuffer) {delete mMsgBuffer;}
+    if (mMsgInfo) {
+        XMPI::free_all(mMsgInfo->mReqSend.size(), mMsgInfo->mReqSend.data());
+        XMPI::free_all(mMsgInfo->mReqRecv.size(), mMsgInfo->mReqRecv.data());
+        delete mMsgInfo;
+    }
+    if (mMsgBuffer) {
+        if (mMsgBuffer->mSharedHalo) {delete mMsgBuffer->mSharedHalo;}
+        if (mMsgBuffer->mAggregator) {delete mMsgBuffer->mAggregator;}
+        delete mMsgBuffer;
+    }
     if (mLearnPar) {delete mLearnPar;}
-    #ifdef _MEASURE_TIMELOOP
-        delete mTimerElemts;
-        delete mTimerPoints;
-        delete mTimerAssemb;
-        delete mTimerAsWait;
-        delete mTimerOthers;
-    #endif
+    if (mBalancePar) {delete mBalancePar;}
+    delete mTimerElemts;
+    delete mTimerPoints;
+    delete mTimerAssemb;
+    delete mTimerAsWait;
+    delete mTimerOthers;
+    // after everything in it
+    delete mArena;
 }
 
 int Domain::addPoint(Point *point) {
@@ -55,6 +94,223 @@ int Domain::addElement(Element *elem) {
     return elem->getDomainTag();
 }
 
+void Domain::formPointBatches(const std::vector<int> &rank) {
+    // group by (nr, columns per point, ocean load)
+    std::map<std::tuple<int, int, bool>, std::vector<Point *>> groups;
+    mPointsUnbatched.clear();
+    for (const auto &point: mPoints) {
+        int ncols = point->batchCols();
+        if (ncols > 0) {
+            groups[std::make_tuple(point->getNr(), ncols, point->batchOcean())].push_back(point);
+        } else {
+            mPointsUnbatched.push_back(point);
+        }
+    }
+    
+    // order within a batch
+    if (rank.size() == mPoints.size()) {
+        for (auto &it: groups) {
+            std::stable_sort(it.second.begin(), it.second.end(), 
+                [&rank](const Point *a, const Point *b) 
+                {return rank[a->getDomainTag()] < rank[b->getDomainTag()];});
+        }
+    }
+    
+    // form batches
+    for (const auto &e: mPointBatches) {delete e;}
+    mPointBatches.clear();
+    for (auto it = groups.begin(); it != groups.end(); it++) {
+        int ncols = std::get<1>(it->first);
+        PointBatch *batch = new PointBatch(std::get<0>(it->first), 
+            ncols * it->second.size(), std::get<2>(it->first));
+        for (int ipnt = 0; ipnt < it->second.size(); ipnt++) {
+            it->second[ipnt]->moveToBatch(*batch, ncols * ipnt);
+        }
+        mPointBatches.push_back(batch);
+    }
+    mBatchCounters.assign(mPointBatches.size(), PerfCounters::Sample());
+    mPointCounters.assign(mPointsUnbatched.size(), PerfCounters::Sample());
+}
+
+std::map<std::string, int> Domain::formLumpedStiffness(const std::map<std::string, double> &budgetMB) {
+    // candidates by class, larger Nu first as they gain the most
+    std::map<std::string, std::vector<Element *>> candidates;
+    for (const auto &elem: mElements) {
+        const std::string &eclass = elem->lumpedStiffnessClass();
+        if (budgetMB.find(eclass) != budgetMB.end()) {
+            candidates[eclass].push_back(elem);
+        }
+    }
+    // the operators of an element, 3 x (3 nPntElem)^2 reals
+    const double bytesElem = 3. * (3 * nPntElem) * (3 * nPntElem) * sizeof(Real);
+    std::vector<Element *> selected;
+    for (auto &it: candidates) {
+        std::stable_sort(it.second.begin(), it.second.end(), 
+            [](const Element *a, const Element *b) {return a->getMaxNu() > b->getMaxNu();});
+        int nfit = (int)(budgetMB.at(it.first) * 1e6 / bytesElem);
+        nfit = std::min(nfit, (int)it.second.size());
+        selected.insert(selected.end(), it.second.begin(), it.second.begin() + nfit);
+    }
+    
+    // formation
+    std::vector<int> formed(selected.size(), 0);
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int ielem = 0; ielem < selected.size(); ielem++) {
+        formed[ielem] = selected[ielem]->formLumpedStiffness() > 0 ? 1 : 0;
+    }
+    std::map<std::string, int> nformed;
+    for (const auto &it: budgetMB) {
+        nformed[it.first] = 0;
+    }
+    for (int ielem = 0; ielem < selected.size(); ielem++) {
+        nformed[selected[ielem]->lumpedStiffnessClass()] += formed[ielem];
+    }
+    return nformed;
+}
+
+void Domain::formElementGroups() {
+    // points on the mpi boundary
+    std::vector<bool> pointOnBoundary(mPoints.size(), false);
+    if (mMsgInfo) {
+        for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+            for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
+                pointOnBoundary[mMsgInfo->mILocalPoints[i][j]] = true;
+            }
+        }
+    }
+    
+    // elements
+    std::vector<Element *> elemsBoundary, elemsInterior;
+    for (const auto &elem: mElements) {
+        // elements outside the box of an injection are not computed
+        if (mBoxInjection && mBoxInjection->dormant(elem->getDomainTag())) {
+            continue;
+        }
+        bool onBoundary = false;
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            if (pointOnBoundary[elem->getPoint(ipnt)->getDomainTag()]) {
+                onBoundary = true;
+                break;
+            }
+        }
+        if (onBoundary) {
+            elemsBoundary.push_back(elem);
+        } else {
+            elemsInterior.push_back(elem);
+        }
+    }
+    sortElementsBySignature(elemsBoundary);
+    sortElementsBySignature(elemsInterior);
+    formElementColors(elemsBoundary, mElementColorsBoundary);
+    formElementColors(elemsInterior, mElementColorsInterior);
+    mElementTicks.assign(mElements.size(), 0);
+    mElementCounters.assign(mElements.size(), PerfCounters::Sample());
+    
+    // halo receive requests, in the order of Mesh::release
+    mHaloDirect.clear();
+    mHaloWaitTicks.clear();
+    if (mMsgInfo && mMsgBuffer) {
+        SharedHalo *shm = mMsgBuffer->mSharedHalo;
+        HaloAggregator *agg = mMsgBuffer->mAggregator;
+        for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+            if (!(shm && shm->shared(i)) && !(agg && agg->aggregated(i))) {
+                mHaloDirect.push_back(i);
+            }
+        }
+        mHaloWaitTicks.assign(mMsgInfo->mNProcComm + 2, 0);
+    }
+    
+    // solid-fluid points
+    mSFPointsBoundary.clear();
+    mSFPointsInterior.clear();
+    std::map<int, std::vector<SolidFluidPoint *>> sf3DBoundary, sf3DInterior;
+    for (const auto &point: mSFPoints) {
+        bool onBoundary = pointOnBoundary[point->getDomainTag()];
+        if (point->getSFCoupling()->is3D()) {
+            (onBoundary ? sf3DBoundary : sf3DInterior)[point->getNr()].push_back(point);
+        } else if (onBoundary) {
+            mSFPointsBoundary.push_back(point);
+        } else {
+            mSFPointsInterior.push_back(point);
+        }
+    }
+    formSFBatches(sf3DBoundary, mSFBatchesBoundary);
+    formSFBatches(sf3DInterior, mSFBatchesInterior);
+}
+
+void Domain::formSFBatches(const std::map<int, std::vector<SolidFluidPoint *>> &groups, 
+    std::vector<SFBatch *> &batches) const {
+    for (const auto &e: batches) {delete e;}
+    batches.clear();
+    // one batch per thread and nr, so that the threads share the work
+    int nthreads = XOMP::nThreads();
+    for (auto it = groups.begin(); it != groups.end(); it++) {
+        int npoint = it->second.size();
+        int size = (npoint + nthreads - 1) / nthreads;
+        for (int start = 0; start < npoint; start += size) {
+            std::vector<SolidFluidPoint *> points(it->second.begin() + start, 
+                it->second.begin() + std::min(start + size, npoint));
+            batches.push_back(new SFBatch(it->first, points));
+        }
+    }
+}
+
+void Domain::sortElementsBySignature(std::vector<Element *> &elems) const {
+    // elements of the same type and nr are computed consecutively,
+    // sharing fftw plans and material kernels while they are hot in cache
+    std::vector<std::pair<std::string, Element *>> sigElems;
+    for (const auto &elem: elems) {
+        sigElems.push_back(std::pair<std::string, Element *>(elem->costSignature(), elem));
+    }
+    std::stable_sort(sigElems.begin(), sigElems.end(), 
+        [](const std::pair<std::string, Element *> &a, 
+           const std::pair<std::string, Element *> &b) {return a.first < b.first;});
+    for (int ielem = 0; ielem < sigElems.size(); ielem++) {
+        elems[ielem] = sigElems[ielem].second;
+    }
+}
+
+void Domain::formElementColors(const std::vector<Element *> &elems, 
+    std::vector<std::vector<Element *>> &colors) const {
+    // greedy colouring such that no two elements of the same colour 
+    // scatter stiffness to the same point
+    colors.clear();
+    std::vector<std::vector<bool>> pointInColor;
+    for (const auto &elem: elems) {
+        int icolor = 0;
+        for (; icolor < colors.size(); icolor++) {
+            bool shared = false;
+            for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                if (pointInColor[icolor][elem->getPoint(ipnt)->getDomainTag()]) {
+                    shared = true;
+                    break;
+                }
+            }
+            if (!shared) {
+                break;
+            }
+        }
+        if (icolor == colors.size()) {
+            colors.push_back(std::vector<Element *>());
+            pointInColor.push_back(std::vector<bool>(mPoints.size(), false));
+        }
+        colors[icolor].push_back(elem);
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            pointInColor[icolor][elem->getPoint(ipnt)->getDomainTag()] = true;
+        }
+    }
+    // contiguous range of each thread in a colour
+    if (mElementHomes.size() > 0) {
+        for (auto &color: colors) {
+            std::stable_sort(color.begin(), color.end(), 
+                [this](const Element *a, const Element *b) 
+                {return mElementHomes[a->getDomainTag()] < mElementHomes[b->getDomainTag()];});
+        }
+    }
+}
+
 void Domain::test() const {
     for (const auto &point: mPoints) {
         point->test();
@@ -73,127 +329,414 @@ void Domain::resetZero() const {
     }
 }
 
+void Domain::syncState(Checkpoint &cp) const {
+    for (const auto &point: mPoints) {
+        point->syncState(cp);
+    }
+    for (const auto &elem: mElements) {
+        elem->syncState(cp);
+    }
+    mPointwiseRecorder->syncState(cp);
+    if (mNuWindows.size() > 0) {
+        cp.syncEigen(mNuWindows);
+        cp.syncValue(mLearnWindow);
+    }
+}
+
 void Domain::initDisplTinyRandom() const {
     for (const auto &point: mPoints) {
         point->randomDispl((Real)1e-30, point->getDomainTag(), 2);
     }
 }
 
-void Domain::computeStiff() const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerElemts->resume();
-    #endif
+void Domain::computeStiff(int part) const {
+    mTimerElemts->resume();
     
-    for (const auto &elem: mElements) {
-        elem->computeStiff();
+    if (part <= 0) {
+        computeStiffColors(mElementColorsBoundary);
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerElemts->stop();
-    #endif
+    if (part >= 0) {
+        computeStiffColors(mElementColorsInterior);
+    }
+    
+    mTimerElemts->stop();
 }
 
-void Domain::applySource(int tstep) const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerElemts->resume();
+void Domain::computeStiffColors(const std::vector<std::vector<Element *>> &colors) const {
+    #ifdef _USE_OPENMP
+        if (mElementHomes.size() > 0) {
+            // each thread computes the elements it has first touched,
+            // the last one also those of threads beyond the team
+            #pragma omp parallel
+            {
+                int home = omp_get_thread_num();
+                bool last = home == omp_get_num_threads() - 1;
+                for (const auto &color: colors) {
+                    auto begin = std::lower_bound(color.begin(), color.end(), home, 
+                        [this](const Element *elem, int h) 
+                        {return mElementHomes[elem->getDomainTag()] < h;});
+                    auto end = last ? color.end() : std::upper_bound(begin, color.end(), home, 
+                        [this](int h, const Element *elem) 
+                        {return h < mElementHomes[elem->getDomainTag()];});
+                    for (auto it = begin; it != end; it++) {
+                        computeStiffTimed(*it);
+                    }
+                    #pragma omp barrier
+                }
+            }
+            return;
+        }
+        // elements of the same colour can be computed concurrently
+        for (const auto &color: colors) {
+            int nelem = color.size();
+            #pragma omp parallel for schedule(dynamic)
+            for (int ielem = 0; ielem < nelem; ielem++) {
+                computeStiffTimed(color[ielem]);
+            }
+        }
+    #else
+        for (const auto &color: colors) {
+            for (const auto &elem: color) {
+                computeStiffTimed(elem);
+            }
+        }
     #endif
-    
-    Real stf = mSTF->getFactor(tstep);
-    for (const auto &source: mSourceTerms) {
-        source->apply(stf);
+}
+
+void Domain::computeStiffTimed(const Element *elem) const {
+    bool counted = PerfCounters::enabled();
+    if (!LoopTimer::enabled() && !counted) {
+        elem->computeStiff();
+        return;
     }
+    // an element is computed by one thread at a time
+    PerfCounters::Sample counts;
+    if (counted) {
+        PerfCounters::read(counts);
+    }
+    uint64_t start = LoopTimer::ticks();
+    elem->computeStiff();
+    mElementTicks[elem->getDomainTag()] += LoopTimer::ticks() - start;
+    if (counted) {
+        PerfCounters::accumulate(counts, mElementCounters[elem->getDomainTag()]);
+    }
+}
+
+void Domain::applySource(int tstep, double frac) const {
+    mTimerElemts->resume();
     
-    #ifdef _MEASURE_TIMELOOP
+    // the recorded wavefield replaces the source
+    if (mBoxInjection && !mBoxInjection->recording()) {
+        mBoxInjection->apply(tstep);
         mTimerElemts->stop();
-    #endif
+        return;
+    }
+    
+    // time after origin
+    double t = -mSTF->getShift() + (tstep + frac) * mSTF->getDeltaT();
+    if (mForwardSourcesOn) {
+        Real stf = mSTF->getFactor(tstep, frac);
+        for (const auto &source: mSourceTerms) {
+            source->apply(stf);
+        }
+        if (mFiniteFault) {
+            mFiniteFault->apply(t);
+        }
+    }
+    if (mAdjointSource && mAdjointSourceOn) {
+        mAdjointSource->apply(t);
+    }
+    
+    mTimerElemts->stop();
 }
 
 void Domain::assembleStiff(int phase) const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerAssemb->resume();
-    #endif
+    mTimerAssemb->resume();
     
+    SharedHalo *shm = mMsgBuffer->mSharedHalo;
+    HaloAggregator *agg = mMsgBuffer->mAggregator;
+    bool trim = mMsgBuffer->mTrimModes;
     if (phase <= 0) {
-        // feed buffer
+        // recv, using persistent requests set up in Mesh::release
+        XMPI::start_all(mMsgInfo->mReqRecv.size(), mMsgInfo->mReqRecv.data());
+        
+        // feed buffer, the shared region read by a node-local neighbour,
+        // or the node buffer sent by the leader
+        int idirect = 0;
         for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+            Complex *send = mMsgBuffer->mBufferSend[i].data();
+            bool direct = true;
+            if (shm && shm->shared(i)) {
+                send = shm->send(i);
+                direct = false;
+            } else if (agg && agg->aggregated(i)) {
+                send = agg->send(i);
+                direct = false;
+            }
+            if (trim) {
+                // trimmed length only over the network
+                int count = packTrimmed(i, send, direct);
+                if (direct) {
+                    XMPI::isendComplex(mMsgInfo->mIProcComm[i], 
+                        mMsgBuffer->mBufferSend[i].head(count), 
+                        mMsgInfo->mReqSend[idirect++], mMsgInfo->mTag, mMsgInfo->mComm);
+                }
+                continue;
+            }
             int row = 0;
-            for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
-                int pTag = mMsgInfo->mILocalPoints[i][j];
-                mPoints[pTag]->feedBuffer(mMsgBuffer->mBufferSend[i], row);
+            for (const auto &block: mMsgBuffer->mStiffBlocks[i]) {
+                Eigen::Map<CColX>(send + row, block.second) = 
+                    Eigen::Map<const CColX>(block.first, block.second);
+                row += block.second;
             }
         }
         
-        // send and recv
-        for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
-            XMPI::isendComplex(mMsgInfo->mIProcComm[i], mMsgBuffer->mBufferSend[i], mMsgInfo->mReqSend[i]);
-            XMPI::irecvComplex(mMsgInfo->mIProcComm[i], mMsgBuffer->mBufferRecv[i], mMsgInfo->mReqRecv[i]);
+        // send, using persistent requests set up in Mesh::release
+        if (!trim) {
+            XMPI::start_all(mMsgInfo->mReqSend.size(), mMsgInfo->mReqSend.data());
+        }
+        if (shm) {
+            shm->post();
+        }
+        if (agg) {
+            agg->post();
         }
     }
     
     if (phase >= 0) {
         // extract buffer 
-        #ifdef _MEASURE_TIMELOOP
-            mTimerAsWait->resume();
-        #endif
-        XMPI::wait_all(mMsgInfo->mReqRecv.size(), mMsgInfo->mReqRecv.data());
-        #ifdef _MEASURE_TIMELOOP
-            mTimerAsWait->stop();
-        #endif
+        mTimerAsWait->resume();
+        if (LoopTimer::enabled()) {
+            waitHaloTimed();
+        } else {
+            XMPI::wait_all(mMsgInfo->mReqRecv.size(), mMsgInfo->mReqRecv.data());
+            if (shm) {
+                shm->wait();
+            }
+            if (agg) {
+                agg->wait();
+            }
+        }
+        mTimerAsWait->stop();
         
         for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+            const Complex *recv = mMsgBuffer->mBufferRecv[i].data();
+            bool direct = true;
+            if (shm && shm->shared(i)) {
+                recv = shm->recv(i);
+                direct = false;
+            } else if (agg && agg->aggregated(i)) {
+                recv = agg->recv(i);
+                direct = false;
+            }
+            if (trim && direct) {
+                unpackTrimmed(i, recv);
+                continue;
+            }
             int row = 0;
-            for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
-                int pTag = mMsgInfo->mILocalPoints[i][j];
-                mPoints[pTag]->extractBuffer(mMsgBuffer->mBufferRecv[i], row);
+            for (const auto &block: mMsgBuffer->mStiffBlocks[i]) {
+                Eigen::Map<CColX>(block.first, block.second) += 
+                    Eigen::Map<const CColX>(recv + row, block.second);
+                row += block.second;
             }
         }
+        if (shm) {
+            shm->finish();
+        }
         
-        #ifdef _MEASURE_TIMELOOP
-            mTimerAsWait->resume();
-        #endif
+        mTimerAsWait->resume();
         XMPI::wait_all(mMsgInfo->mReqSend.size(), mMsgInfo->mReqSend.data());
-        #ifdef _MEASURE_TIMELOOP
-            mTimerAsWait->stop();
-        #endif
+        mTimerAsWait->stop();
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerAssemb->stop();
-    #endif
+    mTimerAssemb->stop();
 }
 
-void Domain::updateNewmark(double dt) const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerPoints->resume();
-    #endif
+void Domain::waitHaloTimed() const {
+    // each span between two arrivals is charged to the later neighbour
+    int nreq = mMsgInfo->mReqRecv.size();
+    uint64_t last = LoopTimer::ticks();
+    for (int n = 0; n < nreq; n++) {
+        int ireq = XMPI::wait_any(nreq, mMsgInfo->mReqRecv.data());
+        if (ireq < 0 || ireq >= nreq) {
+            break;
+        }
+        uint64_t now = LoopTimer::ticks();
+        mHaloWaitTicks[mHaloDirect[ireq]] += now - last;
+        last = now;
+    }
+    int nproc = mMsgInfo->mNProcComm;
+    if (mMsgBuffer->mSharedHalo) {
+        mMsgBuffer->mSharedHalo->wait();
+        uint64_t now = LoopTimer::ticks();
+        mHaloWaitTicks[nproc] += now - last;
+        last = now;
+    }
+    if (mMsgBuffer->mAggregator) {
+        mMsgBuffer->mAggregator->wait();
+        mHaloWaitTicks[nproc + 1] += LoopTimer::ticks() - last;
+    }
+}
+
+int Domain::packTrimmed(int iproc, Complex *send, bool header) const {
+    const auto &blocks = mMsgBuffer->mStiffBlocks[iproc];
+    Real tol = mMsgBuffer->mTrimTolerance;
+    int row = 0;
+    int iblock = 0;
+    for (const auto &shape: mMsgBuffer->mPointShapes[iproc]) {
+        // a point is stored as blocks of columns of its nu + 1 modes
+        int nmodes = shape[0];
+        Real vmax = 0.;
+        for (int b = iblock; b < iblock + shape[2]; b++) {
+            const Complex *data = blocks[b].first;
+            for (int k = 0; k < blocks[b].second; k++) {
+                vmax = std::max(vmax, std::abs(data[k]));
+            }
+        }
+        
+        // highest mode above the tolerance
+        int nactive = 0;
+        for (int b = iblock; b < iblock + shape[2]; b++) {
+            int ncol = blocks[b].second / nmodes;
+            Eigen::Map<CMatXX> stiff(blocks[b].first, nmodes, ncol);
+            for (int r = nmodes - 1; r >= nactive; r--) {
+                if ((stiff.row(r).cwiseAbs().array() > tol * vmax).any()) {
+                    nactive = r + 1;
+                    break;
+                }
+            }
+        }
+        
+        // modes below the tolerance are also discarded locally, so that 
+        // all ranks sum the same contributions; trimming a point again 
+        // for another neighbour leaves it unchanged
+        for (int b = iblock; b < iblock + shape[2]; b++) {
+            int ncol = blocks[b].second / nmodes;
+            Eigen::Map<CMatXX> stiff(blocks[b].first, nmodes, ncol);
+            if (tol > 0.) {
+                stiff.bottomRows(nmodes - nactive).setZero();
+            }
+            if (!header) {
+                // full length for shared and aggregated neighbours
+                Eigen::Map<CMatXX>(send + row, nmodes, ncol) = stiff;
+                row += nmodes * ncol;
+            }
+        }
+        if (header) {
+            send[row++] = Complex((Real)nactive, 0.);
+            for (int b = iblock; b < iblock + shape[2]; b++) {
+                int ncol = blocks[b].second / nmodes;
+                Eigen::Map<CMatXX> stiff(blocks[b].first, nmodes, ncol);
+                Eigen::Map<CMatXX>(send + row, nactive, ncol) = stiff.topRows(nactive);
+                row += nactive * ncol;
+            }
+        }
+        iblock += shape[2];
+    }
+    return row;
+}
+
+void Domain::unpackTrimmed(int iproc, const Complex *recv) const {
+    const auto &blocks = mMsgBuffer->mStiffBlocks[iproc];
+    int row = 0;
+    int iblock = 0;
+    for (const auto &shape: mMsgBuffer->mPointShapes[iproc]) {
+        int nmodes = shape[0];
+        int nactive = (int)round(recv[row++].real());
+        for (int b = iblock; b < iblock + shape[2]; b++) {
+            int ncol = blocks[b].second / nmodes;
+            Eigen::Map<CMatXX>(blocks[b].first, nmodes, ncol).topRows(nactive) += 
+                Eigen::Map<const CMatXX>(recv + row, nactive, ncol);
+            row += nactive * ncol;
+        }
+        iblock += shape[2];
+    }
+}
+
+void Domain::updateNewmark(double dt, double dtLast) const {
+    mTimerPoints->resume();
     
-    for (const auto &point: mPoints) {
-        point->updateNewmark(dt);
+    // stability probe, on the first stage after a request
+    bool probe = mStabilityProbe;
+    mStabilityProbe = false;
+    double norm2 = 0.;
+    bool counted = PerfCounters::enabled();
+    PerfCounters::Sample counts;
+    for (int ib = 0; ib < mPointBatches.size(); ib++) {
+        if (counted) {
+            PerfCounters::read(counts);
+        }
+        norm2 += mPointBatches[ib]->updateNewmark(dt, dtLast, probe);
+        if (counted) {
+            PerfCounters::accumulate(counts, mBatchCounters[ib]);
+        }
+    }
+    bool stable = std::isfinite(norm2);
+    for (int ip = 0; ip < mPointsUnbatched.size(); ip++) {
+        if (counted) {
+            PerfCounters::read(counts);
+        }
+        mPointsUnbatched[ip]->updateNewmark(dt, dtLast);
+        if (probe && stable) {
+            stable = mPointsUnbatched[ip]->stable();
+        }
+        if (counted) {
+            PerfCounters::accumulate(counts, mPointCounters[ip]);
+        }
+    }
+    if (probe) {
+        mStabilityProbed = true;
+        mStabilityLocal = stable;
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerPoints->stop();
-    #endif
+    mTimerPoints->stop();
 }
 
-void Domain::coupleSolidFluid() const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerPoints->resume();
-    #endif
+void Domain::coupleSolidFluid(int part) const {
+    mTimerPoints->resume();
     
-    for (const auto &point: mSFPoints) {
-        point->coupleSolidFluid();
+    // points and batches share no field, so can be coupled concurrently 
+    if (part <= 0) {
+        coupleSolidFluid(mSFPointsBoundary, mSFBatchesBoundary);
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerPoints->stop();
+    if (part >= 0) {
+        coupleSolidFluid(mSFPointsInterior, mSFBatchesInterior);
+    }
+    
+    mTimerPoints->stop();
+}
+
+void Domain::coupleSolidFluid(const std::vector<SolidFluidPoint *> &points, 
+    const std::vector<SFBatch *> &batches) const {
+    int npoint = points.size();
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(static)
     #endif
+    for (int ip = 0; ip < npoint; ip++) {
+        points[ip]->coupleSolidFluid();
+    }
+    int nbatch = batches.size();
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int ib = 0; ib < nbatch; ib++) {
+        batches[ib]->coupleSolidFluid();
+    }
 }
 
-void Domain::initializeRecorders() const {
-    mPointwiseRecorder->initialize();
+void Domain::initializeRecorders(int restartStep) const {
+    mPointwiseRecorder->initialize(restartStep);
     if (mSurfaceRecorder) {
-        mSurfaceRecorder->initialize();
+        mSurfaceRecorder->initialize(restartStep);
+    }
+    if (mVolumetricRecorder) {
+        mVolumetricRecorder->initialize(restartStep);
+    }
+    if (mBoxInjection) {
+        mBoxInjection->initialize(mSTF->getSize(), mSTF->getDeltaT(), 
+            -mSTF->getShift(), restartStep);
     }
 }
 
@@ -202,79 +745,119 @@ void Domain::finalizeRecorders() const {
     if (mSurfaceRecorder) {
         mSurfaceRecorder->finalize();
     }
+    if (mVolumetricRecorder) {
+        mVolumetricRecorder->finalize();
+    }
+    if (mBoxInjection) {
+        mBoxInjection->finalize();
+    }
 }
 
 void Domain::record(int tstep, double t) const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->resume();
-    #endif
+    mTimerOthers->resume();
     
     mPointwiseRecorder->record(tstep, t);
     if (mSurfaceRecorder) {
         mSurfaceRecorder->record(tstep, t);
     }
+    if (mVolumetricRecorder) {
+        mVolumetricRecorder->record(tstep, t);
+    }
+    if (mBoxInjection && mBoxInjection->recording()) {
+        mBoxInjection->record(tstep);
+    }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->stop();
-    #endif
+    mTimerOthers->stop();
 }
 
 void Domain::dumpLeft() const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->resume();
-    #endif
+    mTimerOthers->resume();
     
     mPointwiseRecorder->dumpToFile();
+    mPointwiseRecorder->flush();
     if (mSurfaceRecorder) {
         mSurfaceRecorder->dumpToFile();
+        mSurfaceRecorder->flush();
+    }
+    if (mVolumetricRecorder) {
+        mVolumetricRecorder->dumpToFile();
+        mVolumetricRecorder->flush();
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->stop();
-    #endif
+    mTimerOthers->stop();
 }
 
-void Domain::checkStability(double dt, int tstep, double t) const {
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->resume();
-    #endif
-    
-    bool unstable = false;
-    Point *unstable_point = 0;
+void Domain::checkStability(double dt, int tstep, double t, bool probe) const {
+    mTimerOthers->resume();
+    // the reduction of an earlier probe
+    if (mStabilityPending && tstep >= mStabilityStep + sStabilityLag) {
+        waitStability(dt);
+    }
+    // the probe taken in this step
+    if (mStabilityProbed) {
+        mStabilityProbed = false;
+        if (mStabilityPending) {
+            waitStability(dt);
+        }
+        mStabilityUnstable = mStabilityLocal ? 0 : 1;
+        mStabilityStep = tstep;
+        mStabilityTime = t;
+        XMPI::imax(mStabilityUnstable, mStabilityUnstableAll, mStabilityRequest);
+        mStabilityPending = true;
+    }
+    // probe in the next updateNewmark
+    if (probe) {
+        mStabilityProbe = true;
+    }
+    mTimerOthers->stop();
+}
+
+void Domain::finishStability(double dt) const {
+    if (mStabilityPending) {
+        waitStability(dt);
+    }
+}
+
+void Domain::waitStability(double dt) const {
+    XMPI::wait_all(1, &mStabilityRequest);
+    mStabilityPending = false;
+    if (mStabilityUnstableAll == 0) {
+        return;
+    }
+    // other processors stop without a report
+    if (mStabilityUnstable == 0) {
+        throw CollectiveError("Domain::checkStability || "
+            "Simulation blew up on another processor.", false);
+    }
     
+    // locate the instability
+    Point *unstable_point = mPoints[0];
     for (const auto &point: mPoints) {
         if (!point->stable()) {
-            unstable = true;
             unstable_point = point;
             break;
         }
     }
-    
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->stop();
-    #endif
-    
-    if (unstable) {
-        const RDCol2 &sz = unstable_point->getCoords() / 1e3;
-        double r = sz.norm();
-        double theta = (r < tinyDouble) ? 0. : acos(sz(1) / r);
-        XMPI::cout.setp(XMPI::rank());
-        XMPI::cout << "\n*****************************************" << XMPI::endl;
-        XMPI::cout << "  SIMULATION BLEW UP! AXISEM3D ABORTED!" << XMPI::endl << XMPI::endl;
-        XMPI::cout << "  Where instability occured " << XMPI::endl;
-        XMPI::cout << "    (s, z) / km    =   (" << sz(0) << ", " << sz(1) << ")" << XMPI::endl;
-        XMPI::cout << "    Radius / km    =   " << r << XMPI::endl;
-        XMPI::cout << "    Dist / degr    =   " << theta / degree << XMPI::endl;
-        XMPI::cout << "  When instability occured " << XMPI::endl;
-        XMPI::cout << "    Current time   =   " << t << XMPI::endl;
-        XMPI::cout << "    Current step   =   " << tstep << XMPI::endl;
-        XMPI::cout << "  DT = " << dt << " s. Try smaller ones." << XMPI::endl;
-        XMPI::cout << "*****************************************\n" << XMPI::endl;
-        throw std::runtime_error("Domain::checkStability || Simulation blew up.");
-    }
+    const RDCol2 &sz = unstable_point->getCoords() / 1e3;
+    double r = sz.norm();
+    double theta = (r < tinyDouble) ? 0. : acos(sz(1) / r);
+    XMPI::cout.setp(XMPI::rank());
+    XMPI::cout << "\n*****************************************" << XMPI::endl;
+    XMPI::cout << "  SIMULATION BLEW UP! AXISEM3D ABORTED!" << XMPI::endl << XMPI::endl;
+    XMPI::cout << "  Where instability occured " << XMPI::endl;
+    XMPI::cout << "    (s, z) / km    =   (" << sz(0) << ", " << sz(1) << ")" << XMPI::endl;
+    XMPI::cout << "    Radius / km    =   " << r << XMPI::endl;
+    XMPI::cout << "    Dist / degr    =   " << theta / degree << XMPI::endl;
+    XMPI::cout << "  When instability occured " << XMPI::endl;
+    XMPI::cout << "    Current time   =   " << mStabilityTime << XMPI::endl;
+    XMPI::cout << "    Current step   =   " << mStabilityStep << XMPI::endl;
+    XMPI::cout << "  DT = " << dt << " s. Try smaller ones." << XMPI::endl;
+    XMPI::cout << "*****************************************\n" << XMPI::endl;
+    throw CollectiveError("Domain::checkStability || Simulation blew up.", true);
 }
 
 #include <sstream>
+#include <fstream>
 #include <map>
 #include <iomanip>
 std::string Domain::verbose() const {
@@ -331,7 +914,7 @@ std::string Domain::verbose() const {
     for (auto it = eles.begin(); it != eles.end(); it++) {
         ss << "    " << std::setw(width) << std::left << it->first << "   =   " << it->second << std::endl;
     }
-
+    
     ss << "  GLL Points________________________________________________" << std::endl;
     width = 12;
     for (auto it = points.begin(); it != points.end(); it++) {
@@ -347,38 +930,353 @@ std::string Domain::verbose() const {
 }
 
 std::string Domain::reportCost() const {
-    #ifdef _MEASURE_TIMELOOP
-        std::stringstream ss;
-        double costE = mTimerElemts->elapsed();
-        double costP = mTimerPoints->elapsed();
-        double costA = mTimerAssemb->elapsed();
-        double costW = mTimerAsWait->elapsed();
-        double costO = mTimerOthers->elapsed();
-        double costT = costE + costP + costA + costO;
-        ss.precision(4);
-        ss << std::setw(10) << std::left << XMPI::rank() << "   ";
-        ss << std::setw(10) << std::left << costT << "  ";
-        ss << std::setw(10) << std::left << costE << "      ";
-        ss << std::setw(10) << std::left << costP << "    ";
-        ss << std::setw(10) << std::left << costA - costW << "      ";
-        ss << std::setw(10) << std::left << costW << "  ";
-        ss << std::setw(10) << std::left << costO << std::endl;
-        std::vector<std::string> all_s;
-        XMPI::gather(ss.str(), all_s, false);
+    if (!LoopTimer::enabled()) {
+        return "";
+    }
+    std::stringstream ss;
+    double costE = mTimerElemts->elapsed();
+    double costP = mTimerPoints->elapsed();
+    double costA = mTimerAssemb->elapsed();
+    double costW = mTimerAsWait->elapsed();
+    double costO = mTimerOthers->elapsed();
+    double costT = costE + costP + costA + costO;
+    ss.precision(4);
+    ss << std::setw(10) << std::left << XMPI::rank() << "   ";
+    ss << std::setw(10) << std::left << costT << "  ";
+    ss << std::setw(10) << std::left << costE << "      ";
+    ss << std::setw(10) << std::left << costP << "    ";
+    ss << std::setw(10) << std::left << costA - costW << "      ";
+    ss << std::setw(10) << std::left << costW << "  ";
+    ss << std::setw(10) << std::left << costO << std::endl;
+    std::vector<std::string> all_s;
+    XMPI::gather(ss.str(), all_s, false);
+    
+    // element stiffness by cost signature
+    double secPerTick = LoopTimer::secondsPerTick();
+    std::map<std::string, double> secType, numType;
+    for (const auto &elem: mElements) {
+        const std::string &sig = elem->costSignature();
+        secType[sig] += mElementTicks[elem->getDomainTag()] * secPerTick;
+        numType[sig] += 1.;
+    }
+    std::vector<std::map<std::string, double>> all_sec, all_num;
+    XMPI::gather(secType, all_sec, MPI_DOUBLE, false);
+    XMPI::gather(numType, all_num, MPI_DOUBLE, false);
+    
+    std::string s = "";
+    if (XMPI::root()) {
+        s += "\n-------------------------------------- MPI COST MEASUREMENTS --------------------------------------\n";
+        s += "PROCESSOR    WALLTIME    ELEMENT-WISE    POINT_WISE    MPI_ASSEMBLE    MPI_WAIT    MISCELLANEOUS\n";
+        for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+            s += all_s[iproc]; 
+        }
+        s += "---------------------------------------------------------------------------------------------------\n\n";
+        
+        // sum over ranks, most expensive first
+        std::map<std::string, std::pair<double, double>> total;
+        double totalSec = 0.;
+        for (int iproc = 0; iproc < all_sec.size(); iproc++) {
+            for (auto it = all_sec[iproc].begin(); it != all_sec[iproc].end(); it++) {
+                total[it->first].first += it->second;
+                total[it->first].second += all_num[iproc].at(it->first);
+                totalSec += it->second;
+            }
+        }
+        std::vector<std::pair<double, std::string>> order;
+        for (auto it = total.begin(); it != total.end(); it++) {
+            order.push_back(std::make_pair(it->second.first, it->first));
+        }
+        std::sort(order.rbegin(), order.rend());
+        std::stringstream st;
+        st.precision(4);
+        st << "------------------------------------ ELEMENT COST BY SIGNATURE -----------------------------------\n";
+        st << "SECONDS      SHARE(%)    ELEMENTS    SECONDS/ELEMENT    SIGNATURE\n";
+        for (const auto &entry: order) {
+            double num = total[entry.second].second;
+            st << std::setw(10) << std::left << entry.first << "   ";
+            st << std::setw(10) << std::left << 100. * entry.first / std::max(totalSec, 1e-30) << "  ";
+            st << std::setw(10) << std::left << (int)num << "  ";
+            st << std::setw(15) << std::left << entry.first / num << "    ";
+            st << entry.second << std::endl;
+        }
+        st << "---------------------------------------------------------------------------------------------------\n\n\n";
+        s += st.str();
+    }
+    
+    // imbalance over the whole run
+    if (XMPI::nproc() > 1) {
+        std::vector<double> cost;
+        getCost(cost);
+        s += imbalanceTables(cost, mHaloWaitTicks, 
+            "--------------------------------- LOAD IMBALANCE OVER THE RUN ---------------------------------");
+    }
+    return s;
+}
+
+namespace DomainCounters {
+    typedef std::array<std::map<std::string, double>, 4> ClassSums;
+    
+    // per-class sums over ranks, one table row per class, most cycles first
+    std::string table(const std::string &title, const ClassSums &sums, 
+        const std::map<std::string, double> &nums) {
+        std::array<std::vector<std::map<std::string, double>>, 4> all;
+        for (int i = 0; i < 4; i++) {
+            XMPI::gather(sums[i], all[i], MPI_DOUBLE, false);
+        }
+        std::vector<std::map<std::string, double>> all_num;
+        XMPI::gather(nums, all_num, MPI_DOUBLE, false);
+        if (!XMPI::root()) {
+            return "";
+        }
         
-        std::string s = "";
-        if (XMPI::root()) {
-            s += "\n-------------------------------------- MPI COST MEASUREMENTS --------------------------------------\n";
-            s += "PROCESSOR    WALLTIME    ELEMENT-WISE    POINT_WISE    MPI_ASSEMBLE    MPI_WAIT    MISCELLANEOUS\n";
-            for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
-                s += all_s[iproc]; 
+        std::map<std::string, std::array<double, 5>> total;
+        double totalCycles = 0.;
+        for (int iproc = 0; iproc < all_num.size(); iproc++) {
+            for (auto it = all_num[iproc].begin(); it != all_num[iproc].end(); it++) {
+                std::array<double, 5> &t = total[it->first];
+                for (int i = 0; i < 4; i++) {
+                    t[i] += all[i][iproc].at(it->first);
+                }
+                t[4] += it->second;
+                totalCycles += all[0][iproc].at(it->first);
             }
-            s += "---------------------------------------------------------------------------------------------------\n\n\n";
         }
-        return s;
-    #else 
+        std::vector<std::pair<double, std::string>> order;
+        for (auto it = total.begin(); it != total.end(); it++) {
+            order.push_back(std::make_pair(it->second[0], it->first));
+        }
+        std::sort(order.rbegin(), order.rend());
+        
+        // flops per cycle and per byte from the last-level cache misses 
+        bool flops = PerfCounters::countFlops();
+        double line = PerfCounters::sLineBytes;
+        std::stringstream st;
+        st.precision(4);
+        st << title << "\n";
+        st << "G-CYCLES     SHARE(%)    COUNT       GFLOP        FLOP/CYCLE   L1D-FILL(GB)  DRAM(GB)     FLOP/BYTE    SIGNATURE\n";
+        for (const auto &entry: order) {
+            const std::array<double, 5> &t = total[entry.second];
+            st << std::setw(10) << std::left << t[0] * 1e-9 << "   ";
+            st << std::setw(10) << std::left << 100. * t[0] / std::max(totalCycles, 1e-30) << "  ";
+            st << std::setw(10) << std::left << (int)t[4] << "  ";
+            if (flops) {
+                st << std::setw(10) << std::left << t[1] * 1e-9 << "   ";
+                st << std::setw(10) << std::left << t[1] / std::max(t[0], 1.) << "   ";
+            } else {
+                st << std::setw(10) << std::left << "-" << "   ";
+                st << std::setw(10) << std::left << "-" << "   ";
+            }
+            st << std::setw(12) << std::left << t[2] * line * 1e-9 << "  ";
+            st << std::setw(10) << std::left << t[3] * line * 1e-9 << "   ";
+            if (flops) {
+                st << std::setw(10) << std::left << t[1] / std::max(t[3] * line, 1.) << "   ";
+            } else {
+                st << std::setw(10) << std::left << "-" << "   ";
+            }
+            st << entry.second << std::endl;
+        }
+        st << "---------------------------------------------------------------------------------------------------\n\n";
+        return st.str();
+    }
+    
+    void add(ClassSums &sums, std::map<std::string, double> &nums, 
+        const std::string &sig, const PerfCounters::Sample &sample) {
+        for (int i = 0; i < 4; i++) {
+            sums[i][sig] += sample[i];
+        }
+        nums[sig] += 1.;
+    }
+}
+
+std::string Domain::reportCounters() const {
+    if (!PerfCounters::enabled()) {
         return "";
-    #endif
+    }
+    DomainCounters::ClassSums elemSums, pointSums;
+    std::map<std::string, double> elemNums, pointNums;
+    for (const auto &elem: mElements) {
+        DomainCounters::add(elemSums, elemNums, elem->costSignature(), 
+            mElementCounters[elem->getDomainTag()]);
+    }
+    for (int ib = 0; ib < mPointBatches.size(); ib++) {
+        DomainCounters::add(pointSums, pointNums, mPointBatches[ib]->costSignature(), 
+            mBatchCounters[ib]);
+    }
+    for (int ip = 0; ip < mPointsUnbatched.size(); ip++) {
+        DomainCounters::add(pointSums, pointNums, mPointsUnbatched[ip]->costSignature(), 
+            mPointCounters[ip]);
+    }
+    std::string s = DomainCounters::table(
+        "-------------------------------- ELEMENT HARDWARE COUNTERS BY SIGNATURE ------------------------------", 
+        elemSums, elemNums);
+    s += DomainCounters::table(
+        "--------------------------------- POINT HARDWARE COUNTERS BY SIGNATURE -------------------------------", 
+        pointSums, pointNums);
+    if (XMPI::root()) {
+        s += "FLOP counts are available on Intel processors only; L1D-FILL and DRAM are cache misses times ";
+        s += std::to_string(PerfCounters::sLineBytes) + " bytes.\n\n\n";
+    }
+    return s;
+}
+
+void Domain::memoryBytes(std::map<std::string, double> &bytes) const {
+    // points, with the fields moved into batches
+    double &bytesPoints = bytes["Points"];
+    for (const auto &point: mPoints) {
+        bytesPoints += point->memoryBytes();
+    }
+    for (const auto &batch: mPointBatches) {
+        bytesPoints += batch->memoryBytes();
+    }
+    for (const auto &batch: mSFBatchesBoundary) {
+        bytesPoints += batch->memoryBytes();
+    }
+    for (const auto &batch: mSFBatchesInterior) {
+        bytesPoints += batch->memoryBytes();
+    }
+    
+    // elements, by component
+    for (const auto &elem: mElements) {
+        elem->memoryBytes(bytes);
+    }
+    
+    // static buffers
+    memoryBytesStatic(bytes);
+    
+    // messaging
+    if (mMsgBuffer) {
+        double &bytesMsg = bytes["Messaging"];
+        bytesMsg += heapBytes(mMsgBuffer->mBufferSend) + heapBytes(mMsgBuffer->mBufferRecv);
+        for (int i = 0; i < mMsgBuffer->mBufferSend.size(); i++) {
+            bytesMsg += heapBytes(mMsgBuffer->mBufferSend[i]) + heapBytes(mMsgBuffer->mBufferRecv[i]);
+        }
+        for (const auto &blocks: mMsgBuffer->mStiffBlocks) {
+            bytesMsg += heapBytes(blocks);
+        }
+        for (const auto &shapes: mMsgBuffer->mPointShapes) {
+            bytesMsg += heapBytes(shapes);
+        }
+        if (mMsgBuffer->mSharedHalo) {
+            bytesMsg += mMsgBuffer->mSharedHalo->memoryBytes();
+        }
+        if (mMsgBuffer->mAggregator) {
+            bytesMsg += mMsgBuffer->mAggregator->memoryBytes();
+        }
+    }
+    
+    // recorders
+    double &bytesRec = bytes["Recorders"];
+    if (mPointwiseRecorder) {
+        bytesRec += mPointwiseRecorder->memoryBytes();
+    }
+    if (mSurfaceRecorder) {
+        bytesRec += mSurfaceRecorder->memoryBytes();
+    }
+    if (mVolumetricRecorder) {
+        bytesRec += mVolumetricRecorder->memoryBytes();
+    }
+    
+    // sensitivity kernels
+    if (mSensitivityKernel) {
+        bytes["Kernels"] += mSensitivityKernel->memoryBytes();
+    }
+    
+    // box injection
+    if (mBoxInjection) {
+        bytes["Box Injection"] += mBoxInjection->memoryBytes();
+    }
+}
+
+void Domain::memoryBytesStatic(std::map<std::string, double> &bytes) {
+    bytes["FFT Buffers"] += SolverFFTW::memoryBytes() + 
+        SolverFFTW_1::memoryBytes() + SolverFFTW_3::memoryBytes() + 
+        SolverFFTW_N3::memoryBytes() + SolverFFTW_N6::memoryBytes() + 
+        SolverFFTW_N9::memoryBytes();
+    bytes["Workspaces"] += SolidElement::workspaceBytes() + FluidElement::workspaceBytes();
+}
+
+std::string Domain::reportMemory(const std::map<std::string, double> &bytes, 
+    const std::string &title, double &maxTotalMB) {
+    // total of this rank, in MB
+    double MB = 1024. * 1024.;
+    std::map<std::string, double> mb;
+    double total = 0.;
+    for (auto it = bytes.begin(); it != bytes.end(); it++) {
+        mb[it->first] = it->second / MB;
+        total += it->second / MB;
+    }
+    std::vector<std::map<std::string, double>> all_mb;
+    XMPI::gather(mb, all_mb, MPI_DOUBLE, true);
+    std::vector<double> all_total;
+    XMPI::gather(total, all_total, true);
+    maxTotalMB = *std::max_element(all_total.begin(), all_total.end());
+    if (!XMPI::root()) {
+        return "";
+    }
+    
+    // subsystems of all ranks, zero where absent
+    std::map<std::string, std::vector<double>> table;
+    for (int iproc = 0; iproc < all_mb.size(); iproc++) {
+        for (auto it = all_mb[iproc].begin(); it != all_mb[iproc].end(); it++) {
+            table[it->first].resize(all_mb.size(), 0.);
+            table[it->first][iproc] = it->second;
+        }
+    }
+    std::stringstream ss;
+    ss.precision(4);
+    auto row = [&ss](const std::string &name, const std::vector<double> &v) {
+        auto itMax = std::max_element(v.begin(), v.end());
+        double sum = 0.;
+        for (double x: v) {
+            sum += x;
+        }
+        ss << std::setw(16) << std::left << name;
+        ss << std::setw(10) << std::left << *std::min_element(v.begin(), v.end()) << "   ";
+        ss << std::setw(10) << std::left << *itMax << "   ";
+        ss << std::setw(10) << std::left << sum / v.size() << "   ";
+        ss << itMax - v.begin() << std::endl;
+    };
+    ss << "\n" << title << std::endl;
+    ss << "SUBSYSTEM       MIN(MB)      MAX(MB)      MEAN(MB)     RANK-OF-MAX" << std::endl;
+    for (auto it = table.begin(); it != table.end(); it++) {
+        row(it->first, it->second);
+    }
+    row("TOTAL", all_total);
+    ss << "---------------------------------------------------------------------------------------------------\n" << std::endl;
+    return ss.str();
+}
+
+void Domain::getCost(std::vector<double> &cost) const {
+    cost.clear();
+    if (!LoopTimer::enabled()) {
+        return;
+    }
+    double costW = mTimerAsWait->elapsed();
+    cost.push_back(mTimerElemts->elapsed());
+    cost.push_back(mTimerPoints->elapsed());
+    cost.push_back(mTimerAssemb->elapsed() - costW);
+    cost.push_back(costW);
+    cost.push_back(mTimerOthers->elapsed());
+}
+
+std::vector<std::string> Domain::costNames() {
+    return {"element_wise", "point_wise", "mpi_assemble", "mpi_wait", "miscellaneous"};
+}
+
+namespace DomainWindow {
+    // time window of tstep, of equal length over the record
+    int index(int tstep, int maxStep, int nwin) {
+        int iwin = (int)((long)tstep * nwin / std::max(maxStep, 1));
+        return std::max(0, std::min(iwin, nwin - 1));
+    }
+}
+
+void Domain::setLearnParameters(LearnParameters *lpar) {
+    mLearnPar = lpar;
+    mNuWindows.resize(0, 0);
+    if (mLearnPar->mInvoked && mLearnPar->mNumWindows > 1) {
+        mNuWindows = IMatXX::Zero(mPoints.size(), mLearnPar->mNumWindows);
+    }
 }
 
 void Domain::learnWisdom(int tstep) const {
@@ -386,19 +1284,50 @@ void Domain::learnWisdom(int tstep) const {
         return;
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->resume();
-    #endif
+    mTimerOthers->resume();
     
     if (tstep % mLearnPar->mInterval == 0) {
-        for (const auto &point: mPoints) {
-            point->learnWisdom(mLearnPar->mCutoff);
+        // a new time window learns over from its own amplitude
+        int nwin = mNuWindows.cols();
+        int iwin = DomainWindow::index(tstep, getSTF().getSize(), std::max(nwin, 1));
+        if (nwin > 0 && iwin != mLearnWindow) {
+            if (mLearnWindow >= 0) {
+                for (const auto &point: mPoints) {
+                    point->resetWisdom();
+                }
+            }
+            mLearnWindow = iwin;
+        }
+        // the points of this turn
+        int nturn = mLearnPar->mSampling;
+        int iturn = (tstep / mLearnPar->mInterval) % nturn;
+        int npoint = mPoints.size();
+        #ifdef _USE_OPENMP
+            #pragma omp parallel for schedule(static)
+        #endif
+        for (int ip = iturn; ip < npoint; ip += nturn) {
+            mPoints[ip]->learnWisdom(mLearnPar->mCutoff);
+            if (nwin > 0) {
+                mNuWindows(ip, iwin) = std::max(mNuWindows(ip, iwin), mPoints[ip]->getNuWisdom());
+            }
         }
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->stop();
-    #endif
+    // second phase: elements continue from the learned Nu, growing again 
+    // by the learning threshold if adaptive Nu is off; also reached by 
+    // the first step after a restart beyond the switch
+    int switchStep = (int)round(mLearnPar->mSwitch * getSTF().getSize());
+    if (mLearnPar->mSwitch > 0. && !mWisdomApplied && tstep >= switchStep) {
+        if (Element::getAdaptiveNu() <= 0.) {
+            Element::setAdaptiveNu(mLearnPar->mCutoff);
+        }
+        for (const auto &elem: mElements) {
+            elem->applyWisdom();
+        }
+        mWisdomApplied = true;
+    }
+    
+    mTimerOthers->stop();
 }
 
 void Domain::dumpWisdom() const {
@@ -406,17 +1335,22 @@ void Domain::dumpWisdom() const {
         return;
     }
     
-    #ifdef _MEASURE_TIMELOOP
-        mTimerOthers->resume();
-    #endif
+    mTimerOthers->resume();
     
+    // s, z, learned, starting, windows
+    int nwin = mNuWindows.cols();
+    int stride = 4 + nwin;
     std::vector<double> buffer;
-    for (const auto &point: mPoints) {
+    for (int ip = 0; ip < mPoints.size(); ip++) {
+        const Point *point = mPoints[ip];
         if (!pointInPreviousRank(point->getDomainTag())) {
             buffer.push_back(point->getCoords()(0));
             buffer.push_back(point->getCoords()(1));
-            buffer.push_back(point->getNuWisdom());
+            buffer.push_back(nwin > 0 ? mNuWindows.row(ip).maxCoeff() : point->getNuWisdom());
             buffer.push_back(point->getNu());
+            for (int iwin = 0; iwin < nwin; iwin++) {
+                buffer.push_back(mNuWindows(ip, iwin));
+            }
         }
     }
     
@@ -427,16 +1361,308 @@ void Domain::dumpWisdom() const {
             buffer.insert(buffer.end(), all_buffer[iproc].begin(), all_buffer[iproc].end());
         }
         NuWisdom wis;
-        for (int i = 0; i < buffer.size() / 4; i++) {
-            wis.insert(buffer[i * 4], buffer[i * 4 + 1], 
-                round(buffer[i * 4 + 2]), round(buffer[i * 4 + 3]));
+        wis.setSource(mLearnPar->mSrcLat, mLearnPar->mSrcLon, mLearnPar->mSrcDep);
+        std::vector<int> nuWindows(nwin);
+        for (int i = 0; i < buffer.size() / stride; i++) {
+            for (int iwin = 0; iwin < nwin; iwin++) {
+                nuWindows[iwin] = round(buffer[i * stride + 4 + iwin]);
+            }
+            wis.insert(buffer[i * stride], buffer[i * stride + 1], 
+                round(buffer[i * stride + 2]), round(buffer[i * stride + 3]), nuWindows);
         }
         wis.writeToFile(mLearnPar->mFileName);
     }
     
-    #ifdef _MEASURE_TIMELOOP
+    mTimerOthers->stop();
+}
+
+void Domain::applyNuSchedule(int tstep) const {
+    if (mNumNuWindows <= 0) {
+        return;
+    }
+    int iwin = DomainWindow::index(tstep, getSTF().getSize(), mNumNuWindows);
+    if (iwin == mNuScheduleWindow) {
+        return;
+    }
+    for (const auto &elem: mElements) {
+        elem->applyNuSchedule(iwin);
+    }
+    mNuScheduleWindow = iwin;
+}
+
+void Domain::setBalanceParameters(BalanceParameters *bpar) {
+    mBalancePar = bpar;
+    // allocated here, as it is reduced in the time loop
+    if (mBalancePar->mInterval > 0) {
+        mBalanceWeights = RDColX::Zero(mBalancePar->mNumQuads);
+    }
+}
+
+void Domain::checkBalance(int tstep) const {
+    if (!mBalancePar || mBalancePar->mInterval <= 0 || 
+        tstep % mBalancePar->mInterval != 0 || !LoopTimer::enabled()) {
+        return;
+    }
+    
+    mTimerOthers->resume();
+    
+    // elements and points are the balanced parts; waiting is the symptom
+    double costElem = mTimerElemts->elapsed();
+    double costRank = costElem + mTimerPoints->elapsed();
+    double costMax = XMPI::max(costRank);
+    double costMean = XMPI::sum(costRank) / XMPI::nproc();
+    double imbalance = costMean > 0. ? costMax / costMean - 1. : 0.;
+    if (imbalance <= mBalancePar->mThreshold) {
         mTimerOthers->stop();
-    #endif
+        return;
+    }
+    
+    // measured element time, with the point time of the rank 
+    // distributed over its elements in proportion
+    double secPerTick = LoopTimer::secondsPerTick();
+    double pointScale = costElem > 0. ? costRank / costElem : 1.;
+    mBalanceWeights.setZero();
+    for (const auto &elem: mElements) {
+        int tag = elem->getDomainTag();
+        mBalanceWeights(mBalancePar->mQuadTags[tag]) = 
+            mElementTicks[tag] * secPerTick * pointScale;
+    }
+    XMPI::reduceSumEigenDouble(mBalanceWeights, 0);
+    
+    if (XMPI::root()) {
+        std::stringstream ss;
+        ss << "  LOAD IMBALANCE AT STEP " << tstep << "   =   " 
+            << imbalance * 100. << "%" << XMPI::endl;
+        if (mBalancePar->mFileName != "") {
+            // same layout as Mesh::writeWeights
+            std::ofstream fs(mBalancePar->mFileName, std::ios::binary);
+            int size = mBalanceWeights.size();
+            fs.write(reinterpret_cast<const char *>(&size), sizeof(int));
+            fs.write(reinterpret_cast<const char *>(mBalanceWeights.data()), 
+                size * sizeof(double));
+            fs.close();
+            ss << "  MEASURED WEIGHTS FOR NEXT RUN  =   " << mBalancePar->mFileName << XMPI::endl;
+        }
+        XMPI::cout << ss.str();
+    }
+    
+    mTimerOthers->stop();
+}
+
+namespace DomainImbalance {
+    // ranks listed in each table and bins of the histograms
+    const int nTop = 5;
+    const int nBins = 10;
+    
+    // critical neighbour codes besides ranks
+    const double sharedWindow = -1.;
+    const double nodeLeaders = -2.;
+    const double none = -3.;
+    
+    std::string neighbour(double code) {
+        if (code == sharedWindow) {
+            return "shared window";
+        }
+        if (code == nodeLeaders) {
+            return "node leaders";
+        }
+        if (code == none) {
+            return "-";
+        }
+        return std::to_string((int)code);
+    }
+    
+    // histogram of a value over the ranks, with a bar per bin
+    std::string histogram(const std::string &name, const std::vector<double> &v) {
+        double vmin = *std::min_element(v.begin(), v.end());
+        double vmax = *std::max_element(v.begin(), v.end());
+        double vmean = 0.;
+        for (double x: v) {
+            vmean += x;
+        }
+        vmean /= v.size();
+        std::vector<int> counts(nBins, 0);
+        double width = (vmax - vmin) / nBins;
+        for (double x: v) {
+            int ibin = width > 0. ? (int)((x - vmin) / width) : 0;
+            counts[std::min(ibin, nBins - 1)]++;
+        }
+        int cmax = *std::max_element(counts.begin(), counts.end());
+        std::stringstream ss;
+        ss.precision(4);
+        ss << name << ": MIN = " << vmin << ", MAX = " << vmax << ", MEAN = " << vmean 
+            << ", MAX / MEAN = " << (vmean > 0. ? vmax / vmean : 1.) << std::endl;
+        for (int ibin = 0; ibin < nBins; ibin++) {
+            ss << "  " << std::setw(10) << std::left << vmin + ibin * width << " - ";
+            ss << std::setw(10) << std::left << vmin + (ibin + 1) * width << "  ";
+            ss << std::setw(8) << std::left << counts[ibin] << " ";
+            ss << std::string(cmax > 0 ? 40 * counts[ibin] / cmax : 0, '#') << std::endl;
+        }
+        return ss.str();
+    }
+    
+    // the top ranks by a value
+    std::vector<int> top(const std::vector<double> &v) {
+        std::vector<int> ranks(v.size());
+        for (int i = 0; i < ranks.size(); i++) {
+            ranks[i] = i;
+        }
+        int ntop = std::min((int)ranks.size(), nTop);
+        std::partial_sort(ranks.begin(), ranks.begin() + ntop, ranks.end(), 
+            [&v](int a, int b) {return v[a] > v[b];});
+        ranks.resize(ntop);
+        return ranks;
+    }
+}
+
+std::string Domain::imbalanceTables(const std::vector<double> &cost, 
+    const std::vector<uint64_t> &haloTicks, const std::string &title) const {
+    // the neighbour that ended most of the waits of this rank
+    double critical = DomainImbalance::none;
+    double criticalShare = 0.;
+    uint64_t totalTicks = 0, maxTicks = 0;
+    for (int i = 0; i < haloTicks.size(); i++) {
+        totalTicks += haloTicks[i];
+        if (haloTicks[i] > maxTicks) {
+            maxTicks = haloTicks[i];
+            int nproc = mMsgInfo->mNProcComm;
+            critical = i < nproc ? mMsgInfo->mIProcComm[i] : 
+                (i == nproc ? DomainImbalance::sharedWindow : DomainImbalance::nodeLeaders);
+        }
+    }
+    if (totalTicks > 0) {
+        criticalShare = (double)maxTicks / totalTicks;
+    }
+    std::vector<double> local = {cost[0], cost[1], cost[3], critical, criticalShare};
+    std::vector<double> all;
+    XMPI::gatherEqual(local, all);
+    
+    // the slowest ranks tell their element classes
+    int nval = local.size();
+    int nproc = XMPI::nproc();
+    std::vector<double> elem(nproc), point(nproc), wait(nproc), busy(nproc);
+    std::vector<int> slowest;
+    if (XMPI::root()) {
+        for (int iproc = 0; iproc < nproc; iproc++) {
+            elem[iproc] = all[iproc * nval];
+            point[iproc] = all[iproc * nval + 1];
+            wait[iproc] = all[iproc * nval + 2];
+            busy[iproc] = elem[iproc] + point[iproc];
+        }
+        slowest = DomainImbalance::top(busy);
+    }
+    XMPI::bcast(slowest);
+    std::string classes = "";
+    if (std::find(slowest.begin(), slowest.end(), XMPI::rank()) != slowest.end()) {
+        std::map<std::string, std::pair<double, int>> byClass;
+        double ticksTotal = 0.;
+        for (const auto &elem: mElements) {
+            double ticks = mElementTicks[elem->getDomainTag()];
+            byClass[elem->verbose()].first += ticks;
+            byClass[elem->verbose()].second++;
+            ticksTotal += ticks;
+        }
+        std::vector<std::pair<double, std::string>> order;
+        for (auto it = byClass.begin(); it != byClass.end(); it++) {
+            order.push_back(std::make_pair(it->second.first, it->first));
+        }
+        std::sort(order.rbegin(), order.rend());
+        std::stringstream sc;
+        sc.precision(3);
+        for (int i = 0; i < std::min((int)order.size(), 3); i++) {
+            sc << (i > 0 ? ", " : "") << order[i].second << " x" 
+                << byClass[order[i].second].second << " (" 
+                << 100. * order[i].first / std::max(ticksTotal, 1.) << "%)";
+        }
+        classes = sc.str();
+    }
+    std::vector<std::string> all_classes;
+    XMPI::gather(classes, all_classes, false);
+    if (!XMPI::root()) {
+        return "";
+    }
+    
+    std::stringstream ss;
+    ss.precision(4);
+    ss << "\n" << title << std::endl;
+    ss << DomainImbalance::histogram("ELEMENT-WISE (s)", elem);
+    ss << DomainImbalance::histogram("MPI_WAIT (s)", wait);
+    ss << "\nSLOWEST PROCESSORS BY ELEMENT- AND POINT-WISE TIME" << std::endl;
+    ss << "PROCESSOR   ELEMENT-WISE   POINT-WISE   MPI_WAIT     ELEMENT CLASSES (SHARE OF ELEMENT TIME)" << std::endl;
+    for (int iproc: slowest) {
+        ss << std::setw(12) << std::left << iproc;
+        ss << std::setw(15) << std::left << elem[iproc];
+        ss << std::setw(13) << std::left << point[iproc];
+        ss << std::setw(13) << std::left << wait[iproc];
+        ss << all_classes[iproc] << std::endl;
+    }
+    ss << "\nLONGEST WAITS AND THEIR CRITICAL NEIGHBOURS" << std::endl;
+    ss << "PROCESSOR   MPI_WAIT     CRITICAL NEIGHBOUR   SHARE OF WAIT(%)" << std::endl;
+    std::map<int, int> blamed;
+    for (int iproc = 0; iproc < nproc; iproc++) {
+        double code = all[iproc * nval + 3];
+        if (code >= 0.) {
+            blamed[(int)code]++;
+        }
+    }
+    for (int iproc: DomainImbalance::top(wait)) {
+        ss << std::setw(12) << std::left << iproc;
+        ss << std::setw(13) << std::left << wait[iproc];
+        ss << std::setw(21) << std::left << DomainImbalance::neighbour(all[iproc * nval + 3]);
+        ss << 100. * all[iproc * nval + 4] << std::endl;
+    }
+    if (blamed.size() > 0) {
+        std::vector<double> counts(nproc, 0.);
+        for (auto it = blamed.begin(); it != blamed.end(); it++) {
+            counts[it->first] = it->second;
+        }
+        ss << "\nPROCESSORS MOST WAITED FOR (NUMBER OF RANKS WAITING MOST FOR THEM)" << std::endl;
+        for (int iproc: DomainImbalance::top(counts)) {
+            if (counts[iproc] > 0.) {
+                ss << "  " << std::setw(10) << std::left << iproc << (int)counts[iproc] << std::endl;
+            }
+        }
+    }
+    ss << "---------------------------------------------------------------------------------------------------\n" << std::endl;
+    return ss.str();
+}
+
+void Domain::reportImbalance(int tstep) const {
+    if (!mBalancePar || mBalancePar->mReportInterval <= 0 || 
+        tstep % mBalancePar->mReportInterval != 0 || !LoopTimer::enabled()) {
+        return;
+    }
+    
+    mTimerOthers->resume();
+    
+    // since the last report
+    std::vector<double> cost;
+    getCost(cost);
+    std::vector<double> costInterval = cost;
+    std::vector<uint64_t> ticksInterval = mHaloWaitTicks;
+    if (mImbalanceCost.size() == cost.size()) {
+        for (int i = 0; i < cost.size(); i++) {
+            costInterval[i] -= mImbalanceCost[i];
+        }
+        for (int i = 0; i < ticksInterval.size(); i++) {
+            ticksInterval[i] -= mImbalanceTicks[i];
+        }
+    }
+    bool first = mImbalanceCost.size() == 0;
+    mImbalanceCost = cost;
+    mImbalanceTicks = mHaloWaitTicks;
+    
+    std::stringstream title;
+    title << "------------------------- LOAD IMBALANCE OF THE " << mBalancePar->mReportInterval 
+        << " STEPS BEFORE STEP " << tstep << " -------------------------";
+    std::string report = imbalanceTables(costInterval, ticksInterval, title.str());
+    if (XMPI::root()) {
+        std::ofstream fs(mBalancePar->mReportFile, first ? std::ofstream::out : std::ofstream::app);
+        fs << report;
+        fs.close();
+    }
+    
+    mTimerOthers->stop();
 }
 
 bool Domain::pointInPreviousRank(int myPointTag) const {
@@ -4,22 +4,52 @@
 
 #pragma once
 #include <vector>
+#include <string>
+#include <map>
 #include "global.h"
+#include "eigenp.h"
 
-#ifdef _MEASURE_TIMELOOP
-    #include "MultilevelTimer.h"
-#endif
+#include "LoopTimer.h"
+#include "PerfCounters.h"
+#include "Arena.h"
+#include "XMPI.h"
 
 class Point;
 class Element;
 class SolidFluidPoint;
+class PointBatch;
+class SFBatch;
 class SourceTerm;
 class SourceTimeFunction;
+class FiniteFaultTerm;
+class AdjointSourceTerm;
+class SensitivityKernel;
 class PointwiseRecorder;
 class SurfaceRecorder;
+class VolumetricRecorder;
+class BoxInjection;
 struct MessagingInfo;
 struct MessagingBuffer;
 struct LearnParameters;
+class Checkpoint;
+
+// rebalancing from the costs measured in the time loop
+struct BalanceParameters {
+    // check every so many steps, 0 for off
+    int mInterval = 0;
+    // relative excess of the slowest rank over the mean
+    double mThreshold = 0.;
+    // element weights read by the decomposition of the next run, 
+    // empty to report the imbalance only
+    std::string mFileName = "";
+    // global element tags, in domain order
+    std::vector<int> mQuadTags;
+    int mNumQuads = 0;
+    // imbalance diagnostics every so many steps, 0 for off, appended to 
+    // mReportFile by root
+    int mReportInterval = 0;
+    std::string mReportFile = "";
+};
 
 class Domain {
 public:
@@ -32,21 +62,52 @@ public:
     int addElement(Element *elem);
     void addSourceTerm(SourceTerm *source) {mSourceTerms.push_back(source);};
     void setSTF(SourceTimeFunction *stf) {mSTF = stf;};
+    void setFiniteFault(FiniteFaultTerm *fault) {mFiniteFault = fault;};
+    void setAdjointSource(AdjointSourceTerm *adjoint) {mAdjointSource = adjoint;};
+    void setSensitivityKernel(SensitivityKernel *kernel) {mSensitivityKernel = kernel;};
     void setPointwiseRecorder(PointwiseRecorder *recorderPW) {mPointwiseRecorder = recorderPW;};
     void setSurfaceRecorder(SurfaceRecorder *recorderSF) {mSurfaceRecorder = recorderSF;};
+    void setVolumetricRecorder(VolumetricRecorder *recorderVL) {mVolumetricRecorder = recorderVL;};
+    void setBoxInjection(BoxInjection *box) {mBoxInjection = box;};
     void setMessaging(MessagingInfo *msgInfo, MessagingBuffer *msgBuffer) 
         {mMsgInfo = msgInfo; mMsgBuffer = msgBuffer;};
     void addSFPoint(SolidFluidPoint *SFPoint) {mSFPoints.push_back(SFPoint);};
-    void setLearnParameters(LearnParameters *lpar) {mLearnPar = lpar;};
+    void setLearnParameters(LearnParameters *lpar);
+    void setNumNuWindows(int nwin) {mNumNuWindows = nwin;};
+    void setBalanceParameters(BalanceParameters *bpar);
+    // thread that has created each element, by domain tag, 
+    // which then computes the element in the time loop
+    void setElementHomes(const std::vector<int> &homes) {mElementHomes = homes;};
+    
+    // points and elements created between Arena::open and Arena::close
+    // on this arena are contiguous and freed with the domain
+    Arena *getArena() const {return mArena;};
+    
+    // group points with equal nr and scalar mass into batches;
+    // points are placed in a batch by ascending rank, or by domain tag 
+    // if rank is empty, so that halo points can be made contiguous
+    void formPointBatches(const std::vector<int> &rank = std::vector<int>());
+    
+    // split elements into boundary and interior sets and 
+    // colour each set for threaded stiffness computation
+    void formElementGroups();
+    
+    // precompute the stiffness operators of the elements of each class 
+    // within its budget in MB, larger Nu first; returns the number of 
+    // elements formed by class
+    std::map<std::string, int> formLumpedStiffness(const std::map<std::string, double> &budgetMB);
         
     // get const components
     const SourceTimeFunction &getSTF() const {return *mSTF;};
+    bool hasBoxInjection() const {return mBoxInjection != 0;};
+    int getNumNuWindows() const {return mNumNuWindows;};
     int getNumPoints() const {return mPoints.size();};
     int getNumElements() const {return mElements.size();};
     
     // get pointer components
     Point *getPoint(int index) const {return mPoints[index];};
     Element *getElement(int index) const {return mElements[index];};
+    SensitivityKernel *getSensitivityKernel() const {return mSensitivityKernel;};
     // SourceTerm *getSourceTerm(int index) {return mSourceTerms[index];};
     
     // test domain 
@@ -55,70 +116,195 @@ public:
     // reset all field variables to zero
     void resetZero() const;
     
+    // save or load the time-loop state of points and elements
+    void syncState(Checkpoint &cp) const;
+    
     // initialize displacement with tiny random numbers  
     void initDisplTinyRandom() const;
     
     ////////////// methods during time loop //////////////
     // element operations
-    void computeStiff() const;
-    void applySource(int tstep) const;
+    // part < 0: boundary elements; part > 0: interior elements; part = 0: all
+    void computeStiff(int part = 0) const;
+    void applySource(int tstep, double frac = 0.) const;
+    // sources of the forward and the adjoint wavefields, switched by kernel runs
+    void setSourcesActive(bool forward, bool adjoint) const {
+        mForwardSourcesOn = forward;
+        mAdjointSourceOn = adjoint;
+    };
     
     // point operations
     void assembleStiff(int phase = 0) const; 
-    void updateNewmark(double dt) const;
-    void coupleSolidFluid() const;
+    void updateNewmark(double dt, double dtLast) const;
+    void coupleSolidFluid(int part = 0) const;
     
     // point-wise stations
-    void initializeRecorders() const;
+    // restartStep: time steps done by the run being restarted, 0 for a new run
+    void initializeRecorders(int restartStep = 0) const;
     void finalizeRecorders() const;
     void record(int tstep, double t) const;
     void dumpLeft() const;
     
-    // stability
-    void checkStability(double dt, int tstep, double t) const;
+    // stability, probed in the next updateNewmark if probe and reduced over 
+    // the processors in the background, to be checked sStabilityLag steps 
+    // later; finishStability completes the last reduction after the loop
+    void checkStability(double dt, int tstep, double t, bool probe) const;
+    void finishStability(double dt) const;
     
     // statistics of element and point types
     std::string verbose() const;
     
     // cost measurement
     std::string reportCost() const;
+    // hardware counters by element and point class, empty if the counters are off
+    std::string reportCounters() const;
+    
+    // memory footprint
+    // add the bytes of this rank by subsystem
+    void memoryBytes(std::map<std::string, double> &bytes) const;
+    // add the bytes of the static FFT buffers and element workspaces
+    static void memoryBytesStatic(std::map<std::string, double> &bytes);
+    // min, max and mean over the ranks of each subsystem, collective;
+    // maxTotalMB: the largest total of a rank, on all ranks
+    static std::string reportMemory(const std::map<std::string, double> &bytes, 
+        const std::string &title, double &maxTotalMB);
+    // accumulated seconds of each part, empty if the timers are off
+    void getCost(std::vector<double> &cost) const;
+    static std::vector<std::string> costNames();
     
     // wisdom
     void learnWisdom(int tstep) const;
     void dumpWisdom() const;
     
+    // Nu of the elements by the time window of tstep
+    void applyNuSchedule(int tstep) const;
+    
+    // load imbalance, collective; the measured element weights are 
+    // written for the next run when the imbalance exceeds the threshold
+    void checkBalance(int tstep) const;
+    
+    // histograms of element and wait time over the ranks, the slowest ranks 
+    // with their element classes and the neighbour each rank waits for most, 
+    // of the steps since the last report; collective
+    void reportImbalance(int tstep) const;
+    
 private:
     bool pointInPreviousRank(int myPointTag) const;
+    void sortElementsBySignature(std::vector<Element *> &elems) const;
+    void formElementColors(const std::vector<Element *> &elems, 
+        std::vector<std::vector<Element *>> &colors) const;
+    void computeStiffColors(const std::vector<std::vector<Element *>> &colors) const;
+    void computeStiffTimed(const Element *elem) const;
+    // halo receive, charging each wait to the neighbour that ends it
+    void waitHaloTimed() const;
+    // imbalance tables of costs in the order of costNames() and halo waits
+    std::string imbalanceTables(const std::vector<double> &cost, 
+        const std::vector<uint64_t> &haloTicks, const std::string &title) const;
+    void formSFBatches(const std::map<int, std::vector<SolidFluidPoint *>> &groups, 
+        std::vector<SFBatch *> &batches) const;
+    void coupleSolidFluid(const std::vector<SolidFluidPoint *> &points, 
+        const std::vector<SFBatch *> &batches) const;
+    // halo messages with trailing modes trimmed, returning the length
+    int packTrimmed(int iproc, Complex *send, bool header) const;
+    void unpackTrimmed(int iproc, const Complex *recv) const;
     
     // points
     std::vector<Point *> mPoints;
+    // point batches and points not in any batch
+    std::vector<PointBatch *> mPointBatches;
+    std::vector<Point *> mPointsUnbatched;
     // elements
     std::vector<Element *> mElements;
+    // element colours, elements of the same colour share no point
+    // boundary elements have at least one point on the mpi boundary
+    std::vector<std::vector<Element *>> mElementColorsBoundary;
+    std::vector<std::vector<Element *>> mElementColorsInterior;
+    // thread of first touch by element, empty for dynamic scheduling;
+    // the elements of a colour are then sorted by thread
+    std::vector<int> mElementHomes;
     // solid-fluid boundary
     std::vector<SolidFluidPoint *> mSFPoints;
+    // points with 1D coupling and batches of those with 3D coupling
+    std::vector<SolidFluidPoint *> mSFPointsBoundary;
+    std::vector<SolidFluidPoint *> mSFPointsInterior;
+    std::vector<SFBatch *> mSFBatchesBoundary;
+    std::vector<SFBatch *> mSFBatchesInterior;
     // source 
     std::vector<SourceTerm *> mSourceTerms;
+    // finite fault, with source time functions of its own
+    FiniteFaultTerm *mFiniteFault = 0;
+    // adjoint sources at stations
+    AdjointSourceTerm *mAdjointSource = 0;
+    mutable bool mForwardSourcesOn = true;
+    mutable bool mAdjointSourceOn = true;
+    // sensitivity kernels
+    SensitivityKernel *mSensitivityKernel = 0;
     // source time function
     SourceTimeFunction *mSTF = 0;
     // point-wise stations
     PointwiseRecorder *mPointwiseRecorder = 0;
     // surface wavefield
     SurfaceRecorder *mSurfaceRecorder = 0;
+    // volumetric wavefield
+    VolumetricRecorder *mVolumetricRecorder = 0;
+    // box injection, recorded or injected
+    BoxInjection *mBoxInjection = 0;
     // massaging 
     MessagingInfo *mMsgInfo = 0;
     MessagingBuffer *mMsgBuffer = 0;
+    // storage of the points and elements, released after them
+    Arena *mArena;
     
-    // timers 
-    #ifdef _MEASURE_TIMELOOP
-        MyBoostTimer *mTimerElemts;
-        MyBoostTimer *mTimerPoints;
-        MyBoostTimer *mTimerAssemb;
-        MyBoostTimer *mTimerAsWait;
-        MyBoostTimer *mTimerOthers;
-    #endif
+    // timers, switched by LoopTimer::enable()
+    LoopTimer *mTimerElemts;
+    LoopTimer *mTimerPoints;
+    LoopTimer *mTimerAssemb;
+    LoopTimer *mTimerAsWait;
+    LoopTimer *mTimerOthers;
+    // element stiffness by domain tag
+    mutable std::vector<uint64_t> mElementTicks;
+    // hardware counters, switched by PerfCounters::enable(), of the 
+    // elements by domain tag, the point batches and the unbatched points
+    mutable std::vector<PerfCounters::Sample> mElementCounters;
+    mutable std::vector<PerfCounters::Sample> mBatchCounters;
+    mutable std::vector<PerfCounters::Sample> mPointCounters;
+    // halo wait by neighbour, then the shared window and the node leaders,
+    // and the neighbour of each direct receive request
+    mutable std::vector<uint64_t> mHaloWaitTicks;
+    std::vector<int> mHaloDirect;
     
     // wisdom
     LearnParameters *mLearnPar;
+    // learned Nu applied to the elements in the time loop
+    mutable bool mWisdomApplied = false;
+    // Nu learned in each time window, points by windows
+    mutable IMatXX mNuWindows;
+    mutable int mLearnWindow = -1;
+    
+    // Nu schedule of the elements
+    int mNumNuWindows = 0;
+    mutable int mNuScheduleWindow = -1;
+    
+    // rebalancing
+    BalanceParameters *mBalancePar = 0;
+    mutable RDColX mBalanceWeights;
+    // costs and halo waits at the last imbalance report
+    mutable std::vector<double> mImbalanceCost;
+    mutable std::vector<uint64_t> mImbalanceTicks;
+    
+    // stability probe, taken by updateNewmark
+    mutable bool mStabilityProbe = false;
+    mutable bool mStabilityProbed = false;
+    mutable bool mStabilityLocal = true;
+    // reduction in flight, with the step and time of its probe
+    mutable bool mStabilityPending = false;
+    mutable int mStabilityUnstable = 0;
+    mutable int mStabilityUnstableAll = 0;
+    mutable MPI_Request mStabilityRequest = MPI_REQUEST_NULL;
+    mutable int mStabilityStep = 0;
+    mutable double mStabilityTime = 0.;
+    static const int sStabilityLag = 4;
+    void waitStability(double dt) const;
 };
 
 
@@ -0,0 +1,27 @@
+// LoopTimer.cpp
+// created by Kuangdai on 14-Oct-2026
+// accumulating timer on the cycle counter, cheap enough for the time loop
+
+#include "LoopTimer.h"
+
+bool LoopTimer::sEnabled = true;
+uint64_t LoopTimer::sAnchorTicks = LoopTimer::ticks();
+std::chrono::steady_clock::time_point LoopTimer::sAnchorClock = std::chrono::steady_clock::now();
+
+void LoopTimer::enable(bool enabled) {
+    sEnabled = enabled;
+    sAnchorTicks = ticks();
+    sAnchorClock = std::chrono::steady_clock::now();
+}
+
+double LoopTimer::secondsPerTick() {
+    // assumes a constant-rate counter, as on all recent x86 processors
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - sAnchorClock).count();
+    uint64_t ticksNow = ticks();
+    if (ticksNow <= sAnchorTicks || seconds <= 0.) {
+        return 0.;
+    }
+    return seconds / (ticksNow - sAnchorTicks);
+}
+
@@ -0,0 +1,54 @@
+// LoopTimer.h
+// created by Kuangdai on 14-Oct-2026
+// accumulating timer on the cycle counter, cheap enough for the time loop
+
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+class LoopTimer {
+public:
+    void resume() {
+        if (sEnabled) {
+            mStart = ticks();
+        }
+    };
+    
+    void stop() {
+        if (sEnabled) {
+            mTicks += ticks() - mStart;
+        }
+    };
+    
+    // in seconds
+    double elapsed() const {return mTicks * secondsPerTick();};
+    
+    // switch on or off at runtime, before the time loop
+    static void enable(bool enabled);
+    static bool enabled() {return sEnabled;};
+    
+    // ticks of the cycle counter, or of the steady clock on other architectures
+    static uint64_t ticks() {
+        #if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+        #else
+            return std::chrono::steady_clock::now().time_since_epoch().count();
+        #endif
+    };
+    
+    // calibrated against the steady clock since enable()
+    static double secondsPerTick();
+    
+private:
+    uint64_t mStart = 0;
+    uint64_t mTicks = 0;
+    
+    static bool sEnabled;
+    static uint64_t sAnchorTicks;
+    static std::chrono::steady_clock::time_point sAnchorClock;
+};
+
@@ -0,0 +1,202 @@
+// PerfCounters.cpp
+// created by Kuangdai on 14-Oct-2026
+// hardware counters of the time-loop kernels by Linux perf_event
+
+#include "PerfCounters.h"
+#include "XOMP.h"
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _USE_PERF_COUNTERS
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <cpuid.h>
+    #endif
+#endif
+
+bool PerfCounters::sEnabled = false;
+std::vector<PerfCounters::Group> PerfCounters::sGroups;
+
+#ifdef _USE_PERF_COUNTERS
+namespace PerfEvents {
+    // FP_ARITH_INST_RETIRED of Intel cores since Skylake, umask and flops
+    // per instruction: scalar, 128-, 256- and 512-bit packed; FMA counts twice
+    const int nFlopEvents = 4;
+    #ifdef _USE_DOUBLE
+        const uint64_t flopUmasks[nFlopEvents] = {0x01, 0x04, 0x10, 0x40};
+        const double flopWeights[nFlopEvents] = {1., 2., 4., 8.};
+    #else
+        const uint64_t flopUmasks[nFlopEvents] = {0x02, 0x08, 0x20, 0x80};
+        const double flopWeights[nFlopEvents] = {1., 4., 8., 16.};
+    #endif
+    const uint64_t flopEvent = 0xC7;
+
+    bool intel() {
+        #if defined(__x86_64__) || defined(__i386__)
+            unsigned int eax, ebx, ecx, edx;
+            if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0) {
+                return false;
+            }
+            char vendor[13];
+            std::memcpy(vendor, &ebx, 4);
+            std::memcpy(vendor + 4, &edx, 4);
+            std::memcpy(vendor + 8, &ecx, 4);
+            vendor[12] = '\0';
+            return std::strcmp(vendor, "GenuineIntel") == 0;
+        #else
+            return false;
+        #endif
+    }
+
+    // user-space counts of the calling thread
+    int open(uint32_t type, uint64_t config, int leader) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = leader < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP |
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+    }
+
+    // values of a group scaled to the time enabled, when multiplexed
+    void read(int leader, int nevents, double *values) {
+        // nr, time enabled, time running, values
+        uint64_t buffer[3 + nFlopEvents];
+        if (leader < 0 || ::read(leader, buffer, sizeof(uint64_t) * (3 + nevents)) <= 0) {
+            for (int i = 0; i < nevents; i++) {
+                values[i] = 0.;
+            }
+            return;
+        }
+        double scale = buffer[2] > 0 ? (double)buffer[1] / buffer[2] : 0.;
+        for (int i = 0; i < nevents; i++) {
+            values[i] = buffer[3 + i] * scale;
+        }
+    }
+
+    bool sCountFlops = false;
+}
+#endif
+
+void PerfCounters::enable(bool enabled) {
+    for (Group &group: sGroups) {
+        close(group);
+    }
+    sGroups.clear();
+    sEnabled = false;
+    #ifdef _USE_PERF_COUNTERS
+        if (!enabled) {
+            return;
+        }
+        // each thread opens the counters of its own
+        PerfEvents::sCountFlops = PerfEvents::intel();
+        sGroups = std::vector<Group>(XOMP::nThreads());
+        int nfailed = 0, nflops = 0;
+        #ifdef _USE_OPENMP
+            #pragma omp parallel reduction(+:nfailed, nflops)
+        #endif
+        {
+            Group &group = sGroups[XOMP::threadID()];
+            nfailed += open(group) ? 0 : 1;
+            nflops += group.mFlop >= 0 ? 1 : 0;
+        }
+        if (nfailed > 0) {
+            throw std::runtime_error("PerfCounters::enable || "
+                "Error opening hardware counters by perf_event_open. || "
+                "Check /proc/sys/kernel/perf_event_paranoid (at most 2 required), || "
+                "or set OPTION_PERF_COUNTERS = false.");
+        }
+        PerfEvents::sCountFlops = nflops == sGroups.size();
+        sEnabled = true;
+    #endif
+}
+
+bool PerfCounters::countFlops() {
+    #ifdef _USE_PERF_COUNTERS
+        return PerfEvents::sCountFlops;
+    #else
+        return false;
+    #endif
+}
+
+void PerfCounters::read(Sample &sample) {
+    sample.fill(0.);
+    #ifdef _USE_PERF_COUNTERS
+        const Group &group = sGroups[XOMP::threadID()];
+        // cycles, L1D misses, LLC misses
+        double cache[3];
+        PerfEvents::read(group.mCache, 3, cache);
+        sample[0] = cache[0];
+        sample[2] = cache[1];
+        sample[3] = cache[2];
+        // flops
+        if (group.mFlop >= 0) {
+            double flop[PerfEvents::nFlopEvents];
+            PerfEvents::read(group.mFlop, PerfEvents::nFlopEvents, flop);
+            for (int i = 0; i < PerfEvents::nFlopEvents; i++) {
+                sample[1] += flop[i] * PerfEvents::flopWeights[i];
+            }
+        }
+    #endif
+}
+
+bool PerfCounters::open(Group &group) {
+    #ifdef _USE_PERF_COUNTERS
+        uint64_t l1dMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        group.mCache = PerfEvents::open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+        if (group.mCache < 0) {
+            return false;
+        }
+        group.mFds.push_back(group.mCache);
+        int fdL1D = PerfEvents::open(PERF_TYPE_HW_CACHE, l1dMiss, group.mCache);
+        int fdLLC = PerfEvents::open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, group.mCache);
+        if (fdL1D < 0 || fdLLC < 0) {
+            return false;
+        }
+        group.mFds.push_back(fdL1D);
+        group.mFds.push_back(fdLLC);
+        ioctl(group.mCache, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.mCache, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        
+        // flops, left out where unavailable
+        if (!PerfEvents::sCountFlops) {
+            return true;
+        }
+        std::vector<int> fdFlop;
+        for (int i = 0; i < PerfEvents::nFlopEvents; i++) {
+            uint64_t config = (PerfEvents::flopUmasks[i] << 8) | PerfEvents::flopEvent;
+            int fd = PerfEvents::open(PERF_TYPE_RAW, config, fdFlop.size() > 0 ? fdFlop[0] : -1);
+            if (fd < 0) {
+                for (int fdi: fdFlop) {
+                    ::close(fdi);
+                }
+                return true;
+            }
+            fdFlop.push_back(fd);
+        }
+        group.mFlop = fdFlop[0];
+        group.mFds.insert(group.mFds.end(), fdFlop.begin(), fdFlop.end());
+        ioctl(group.mFlop, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.mFlop, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    #endif
+    return true;
+}
+
+void PerfCounters::close(Group &group) {
+    #ifdef _USE_PERF_COUNTERS
+        for (int fd: group.mFds) {
+            ::close(fd);
+        }
+    #endif
+    group = Group();
+}
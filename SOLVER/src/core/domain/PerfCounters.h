@@ -0,0 +1,55 @@
+// PerfCounters.h
+// created by Kuangdai on 14-Oct-2026
+// hardware counters of the time-loop kernels by Linux perf_event
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+
+class PerfCounters {
+public:
+    // cycles, floating-point operations, L1D misses and last-level cache misses;
+    // flops stay zero where the processor has no known flop events (non-Intel)
+    typedef std::array<double, 4> Sample;
+
+    // switch on or off at runtime, before the time loop, opening the 
+    // counters of every thread; always off without _USE_PERF_COUNTERS
+    static void enable(bool enabled);
+    static bool enabled() {return sEnabled;};
+
+    // counts of the calling thread so far
+    static void read(Sample &sample);
+
+    // add the counts since start to total
+    static void accumulate(const Sample &start, Sample &total) {
+        Sample now;
+        read(now);
+        for (int i = 0; i < now.size(); i++) {
+            total[i] += now[i] - start[i];
+        }
+    };
+
+    // whether flops are counted
+    static bool countFlops();
+
+    // bytes moved per cache miss
+    static const int sLineBytes = 64;
+
+private:
+    static bool sEnabled;
+
+    // event groups of each thread, one for cycles and cache misses and 
+    // one for flops, each small enough to fit the counters of a core
+    struct Group {
+        int mCache = -1;
+        int mFlop = -1;
+        // all descriptors, leaders included
+        std::vector<int> mFds;
+    };
+    static std::vector<Group> sGroups;
+    static bool open(Group &group);
+    static void close(Group &group);
+};
+
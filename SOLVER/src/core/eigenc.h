@@ -14,6 +14,12 @@ typedef Eigen::Matrix<Real, Eigen::Dynamic, 1> RColX;
 typedef Eigen::Matrix<Real, Eigen::Dynamic, 3> RMatX3;
 typedef Eigen::Matrix<Complex, Eigen::Dynamic, 1> CColX;
 typedef Eigen::Matrix<Complex, Eigen::Dynamic, 3> CMatX3;
+typedef Eigen::Map<CColX> CColXMap;   // pointwise fields, mapped to point storage
+typedef Eigen::Map<CMatX3> CMatX3Map; // pointwise fields, mapped to point storage
+typedef Eigen::Matrix<Real, 1, Eigen::Dynamic> RRowX;
+typedef Eigen::Matrix<ComplexN, Eigen::Dynamic, Eigen::Dynamic> CNMatXX; // Newmark state
+typedef Eigen::Map<Eigen::Matrix<ComplexN, Eigen::Dynamic, 1>> CNColXMap;
+typedef Eigen::Map<Eigen::Matrix<ComplexN, Eigen::Dynamic, 3>> CNMatX3Map;
 typedef std::array<CMatX3, nPntElem> arPP_CMatX3; // source 
 typedef std::vector<arPP_CMatX3> vec_arPP_CMatX3; // off-axis source 
 typedef Eigen::Matrix<Real, 1, 3> RRow3;         // receiver
@@ -51,5 +57,35 @@ const ar6_CMatPP zero_ar6_CMatPP = {CMatPP::Zero(), CMatPP::Zero(), CMatPP::Zero
 const ar9_CMatPP zero_ar9_CMatPP = {CMatPP::Zero(), CMatPP::Zero(), CMatPP::Zero(), 
                                     CMatPP::Zero(), CMatPP::Zero(), CMatPP::Zero(), 
                                     CMatPP::Zero(), CMatPP::Zero(), CMatPP::Zero()};
-                                    
+// structured fields viewed flat, as modes by (component, point), which is 
+// their memory layout with row-major CMatPP packed in std::array
+static_assert(sizeof(ar9_CMatPP) == sizeof(Complex) * nPntElem * 9, 
+    "Structured elemental fields must be contiguous.");
+typedef Eigen::Map<Eigen::Matrix<Complex, Eigen::Dynamic, nPntElem * 3, Eigen::RowMajor>> CMatXN3Map;
+typedef Eigen::Map<Eigen::Matrix<Complex, Eigen::Dynamic, nPntElem * 6, Eigen::RowMajor>> CMatXN6Map;
+typedef Eigen::Map<Eigen::Matrix<Complex, Eigen::Dynamic, nPntElem * 9, Eigen::RowMajor>> CMatXN9Map;
 
+// heap bytes of a dynamic Eigen matrix and of the elements of a vector, 
+// excluding those owned by the elements, for memory reports
+template<typename TMat>
+inline size_t heapBytes(const TMat &mat) {
+    return mat.size() * sizeof(typename TMat::Scalar);
+}
+template<typename T>
+inline size_t heapBytes(const std::vector<T> &vec) {
+    return vec.capacity() * sizeof(T);
+}
+
+// rows of a column-major buffer padded so that every column starts on 
+// the boundary to which Eigen aligns dynamic storage, for aligned vector loads 
+// of each physical-space or Fourier-space column
+#if defined(EIGEN_MAX_ALIGN_BYTES) && EIGEN_MAX_ALIGN_BYTES > 0
+    const int alignedBytes = EIGEN_MAX_ALIGN_BYTES;
+#else
+    const int alignedBytes = 16;
+#endif
+template<typename Scalar>
+inline int paddedRows(int rows) {
+    const int n = alignedBytes > (int)sizeof(Scalar) ? alignedBytes / (int)sizeof(Scalar) : 1;
+    return (rows + n - 1) / n * n;
+}
@@ -7,6 +7,7 @@
 
 #include "Gradient.h"
 #include "PRT.h"
+#include "Checkpoint.h"
 
 Element::Element(Gradient *grad, PRT *prt, const std::array<Point *, nPntElem> &points):
 mGradient(grad), mPRT(prt), mHasPRT(prt != 0) {
@@ -19,6 +20,10 @@ mGradient(grad), mPRT(prt), mHasPRT(prt != 0) {
     if (mHasPRT) {
         mPRT->checkCompatibility(mMaxNr);
     }
+    mActiveNu = mMaxNu;
+    mAdaptiveNu = false;
+    mElemNu3D = false;
+    mAwake = false;
 }
 
 Element::~Element() {
@@ -28,12 +33,158 @@ Element::~Element() {
     }
 }
 
+void Element::memoryBytes(std::map<std::string, double> &bytes) const {
+    bytes["Elements"] += heapBytes(mNuSchedule);
+    bytes["Gradient"] += mGradient->memoryBytes();
+    if (mHasPRT) {
+        bytes["Relabelling"] += mPRT->memoryBytes();
+    }
+}
+
 void Element::addSourceTerm(const arPP_CMatX3 &source) const {
     for (int i = 0; i < nPntElem; i++) {
         mPoints[i]->addToStiff(source[i]);
     }
 }
 
+void Element::addSourceTerm(const arPP_CMatX3 &source, Real factor) const {
+    for (int i = 0; i < nPntElem; i++) {
+        mPoints[i]->addToStiff(source[i], factor);
+    }
+}
+
+void Element::setStiffTap(const std::vector<int> &ipnts) {
+    throw std::runtime_error("Element::setStiffTap || "
+        "Box injection requires solid elements on the boundary.");
+}
+
+const CMatXX &Element::getStiffTap() const {
+    throw std::runtime_error("Element::getStiffTap || "
+        "Box injection requires solid elements on the boundary.");
+}
+
+void Element::resetZero() {
+    if (mAdaptiveNu) {
+        mActiveNu = 0;
+    }
+    mAwake = false;
+}
+
+void Element::syncState(Checkpoint &cp) {
+    cp.syncValue(mActiveNu);
+    cp.syncValue(mAwake);
+}
+
+bool Element::atRest(const vec_CMatPP &displ) const {
+    if (!mAwake) {
+        for (int alpha = 0; alpha <= mMaxNu; alpha++) {
+            if ((displ[alpha].array() != czero).any()) {
+                mAwake = true;
+                break;
+            }
+        }
+    }
+    return !mAwake;
+}
+
+bool Element::atRest(const vec_ar3_CMatPP &displ) const {
+    if (!mAwake) {
+        for (int alpha = 0; alpha <= mMaxNu; alpha++) {
+            if ((displ[alpha][0].array() != czero).any() || 
+                (displ[alpha][1].array() != czero).any() || 
+                (displ[alpha][2].array() != czero).any()) {
+                mAwake = true;
+                break;
+            }
+        }
+    }
+    return !mAwake;
+}
+
+void Element::initActiveNu(bool elem3D) {
+    // orders are coupled in 3D elements
+    mAdaptiveNu = sAdaptiveNuTol > 0. && !elem3D && mMaxNu > 0;
+    mActiveNu = mAdaptiveNu ? 0 : mMaxNu;
+    mElemNu3D = elem3D;
+}
+
+void Element::applyWisdom() {
+    // 3D elements are expanded at their full Nr; 
+    // elements at rest have learned nothing yet
+    if (mElemNu3D || !mAwake || mMaxNu == 0) {
+        return;
+    }
+    int nuLearned = 0;
+    for (int i = 0; i < nPntElem; i++) {
+        nuLearned = std::max(nuLearned, mPoints[i]->getNuWisdom());
+    }
+    mActiveNu = std::min(mActiveNu, nuLearned);
+    mAdaptiveNu = true;
+}
+
+void Element::applyNuSchedule(int window) {
+    if (mElemNu3D || window < 0 || window >= mNuSchedule.size()) {
+        return;
+    }
+    mActiveNu = std::min(mMaxNu, mNuSchedule[window]);
+}
+
+namespace ActiveNu {
+    Real energy(const CMatPP &displ) {
+        return displ.squaredNorm();
+    }
+    
+    Real energy(const ar3_CMatPP &displ) {
+        return displ[0].squaredNorm() + displ[1].squaredNorm() + displ[2].squaredNorm();
+    }
+    
+    // learnWisdom-style check of the orders above the active Nu, 
+    // returning the new active Nu
+    template<class TVec>
+    int grow(const TVec &displ, int activeNu, int maxNu, int maxNr, Real tol) {
+        int topNu = maxNu - (int)(maxNr % 2 == 0);
+        Real residual = (Real)0.;
+        for (int alpha = activeNu + 1; alpha <= topNu; alpha++) {
+            residual += energy(displ[alpha]);
+        }
+        if (residual <= (Real)0.) {
+            return activeNu;
+        }
+        // Hilbert norm
+        Real h2norm = residual - (Real).5 * energy(displ[0]);
+        for (int alpha = 0; alpha <= activeNu; alpha++) {
+            h2norm += energy(displ[alpha]);
+        }
+        Real cutoff = h2norm * tol * tol;
+        if (residual <= cutoff) {
+            return activeNu;
+        }
+        // smallest order that leaves the residual under the cutoff
+        residual = (Real)0.;
+        for (int alpha = topNu; alpha > activeNu; alpha--) {
+            residual += energy(displ[alpha]);
+            if (residual > cutoff) {
+                return alpha >= topNu ? maxNu : alpha;
+            }
+        }
+        return activeNu;
+    }
+}
+
+void Element::updateActiveNu(const vec_CMatPP &displ) const {
+    if (mActiveNu < mMaxNu) {
+        mActiveNu = ActiveNu::grow(displ, mActiveNu, mMaxNu, mMaxNr, (Real)sAdaptiveNuTol);
+    }
+}
+
+void Element::updateActiveNu(const vec_ar3_CMatPP &displ) const {
+    if (mActiveNu < mMaxNu) {
+        mActiveNu = ActiveNu::grow(displ, mActiveNu, mMaxNu, mMaxNr, (Real)sAdaptiveNuTol);
+    }
+}
+
+double Element::sAdaptiveNuTol = 0.;
+
 bool Element::axial() const {
     return mPoints[0]->axial();
 }
@@ -57,8 +208,17 @@ RDMatPP Element::formThetaMat() const {
     return theta;
 }
 
-RDMatXX Element::getCoordsOnSide(int side) const {
-    int ipol0 = 0, ipol1 = 0, jpol0 = 0, jpol1 = 0;
+CColX Element::formPhaseTable(double phi) const {
+    int maxAlpha = mMaxNu - (int)(mMaxNr % 2 == 0);
+    CColX expPhi(maxAlpha + 1);
+    expPhi(0) = one;
+    for (int alpha = 1; alpha <= maxAlpha; alpha++) {
+        expPhi(alpha) = two * exp((Real)alpha * (Real)phi * ii);
+    }
+    return expPhi;
+}
+
+void Element::getSideRange(int side, int &ipol0, int &ipol1, int &jpol0, int &jpol1) {
     if (side == 0) {
         ipol0 = 0;
         ipol1 = nPol;
@@ -76,6 +236,11 @@ RDMatXX Element::getCoordsOnSide(int side) const {
         jpol0 = 0;
         jpol1 = nPol;
     }
+}
+
+RDMatXX Element::getCoordsOnSide(int side) const {
+    int ipol0 = 0, ipol1 = 0, jpol0 = 0, jpol1 = 0;
+    getSideRange(side, ipol0, ipol1, jpol0, jpol1);
     RDMatXX sz = RDMatXX::Zero(2, nPntEdge);
     int ipntedge = 0;
     for (int ipol = ipol0; ipol <= ipol1; ipol++) {
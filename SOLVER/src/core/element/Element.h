@@ -7,11 +7,14 @@
 class Point;
 class Gradient;
 class PRT;
+class Checkpoint;
 
 #include "eigenc.h"
 #include "eigenp.h"
+#include <map>
+#include "Arena.h"
 
-class Element {
+class Element: public ArenaObject {
 public:    
     Element(Gradient *grad, PRT *prt, const std::array<Point *, nPntElem> &points);
     virtual ~Element();
@@ -26,28 +29,58 @@ public:
     virtual void test() const = 0;
     
     // compute Real displacement, used by receiver
-    virtual void computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u_spz) const = 0; 
-    virtual void computeStrain(Real phi, const RMatPP &weights, RRow6 &strain) const = 0; 
-    virtual void computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) const = 0; 
+    // expPhi: azimuthal factors from formPhaseTable 
+    virtual void computeGroundMotion(const CColX &expPhi, const RMatPP &weights, RRow3 &u_spz) const = 0; 
+    virtual void computeStrain(const CColX &expPhi, const RMatPP &weights, RRow6 &strain) const = 0; 
+    virtual void computeCurl(const CColX &expPhi, const RMatPP &weights, RRow3 &curl) const = 0; 
+    // Fourier coefficients of displacement in SPZ, nPntElem x 3 * (maxNu + 1),
+    // shared by all receivers in the element
+    virtual void feedDisplFourier(CMatXX &displ) const = 0; 
+    // Fourier coefficients of strain in RTZ, nPntElem x 6 * (maxNu + 1)
+    virtual void feedStrainFourier(CMatXX &strain) const = 0; 
+    // displacement as feedDisplFourier at the points ipnts only, npnt rows, 
+    // read directly from the points; false where the displacement is not 
+    // a point value, as in fluids
+    virtual bool feedDisplFourier(const std::vector<int> &ipnts, CMatXX &displ) const {return false;}; 
     virtual void forceTIso() = 0; 
     
+    // stiffness of the points ipnts kept by each computeStiff, for box 
+    // injection, (maxNu + 1) x 3 * npnt; solid elements only
+    virtual void setStiffTap(const std::vector<int> &ipnts);
+    virtual const CMatXX &getStiffTap() const;
+    
     // side-wise
     virtual void feedDispOnSide(int side, CMatXX_RM &buffer, int row) const = 0; 
+    virtual void feedStrainOnSide(int side, CMatXX_RM &buffer, int row) const = 0; 
     RDMatXX getCoordsOnSide(int side) const; 
     
     // verbose
     virtual std::string verbose() const = 0;
     
+    // add the bytes of this element by subsystem, for memory reports
+    virtual void memoryBytes(std::map<std::string, double> &bytes) const;
+    
+    // stiffness precomputed as dense operators over the modes; the class 
+    // of the memory budget, empty where not applicable, and the formation,
+    // returning the bytes of the operators or 0 on failure
+    virtual std::string lumpedStiffnessClass() const {return "";};
+    virtual size_t formLumpedStiffness() {return 0;};
+    
     // get point ptr
     const Point *getPoint(int index) const {return mPoints[index];};
     
     // source 
     void addSourceTerm(const arPP_CMatX3 &source) const;
+    void addSourceTerm(const arPP_CMatX3 &source, Real factor) const;
     
     // get nr 
     int getMaxNr() const {return mMaxNr;};
     int getMaxNu() const {return mMaxNu;};
     
+    // factors of the Fourier series at phi, 1 and 2 * exp(i * alpha * phi), 
+    // excluding the Nyquist order
+    CColX formPhaseTable(double phi) const;
+    
     // signature for cost measurement
     std::string costSignature() const;
     
@@ -58,9 +91,36 @@ public:
     RDMatPP formThetaMat() const;
     
     // reset
-    virtual void resetZero() {};
+    virtual void resetZero();
+    
+    // save or load time-loop state
+    virtual void syncState(Checkpoint &cp);
+    
+    // adaptive Nu in time loop
+    static void setAdaptiveNu(double tol) {sAdaptiveNuTol = tol;};
+    static double getAdaptiveNu() {return sAdaptiveNuTol;};
+    
+    // restart from the Nu learned by the points, growing as adaptive Nu
+    void applyWisdom();
+    
+    // Nu of each time window from a windowed wisdom, 1D elements only
+    void setNuSchedule(const std::vector<int> &nus) {mNuSchedule = nus;};
+    void applyNuSchedule(int window);
     
 protected:
+    // GLL range of a side
+    static void getSideRange(int side, int &ipol0, int &ipol1, int &jpol0, int &jpol1);
+    
+    // adaptive Nu
+    void initActiveNu(bool elem3D);
+    void updateActiveNu(const vec_CMatPP &displ) const;
+    void updateActiveNu(const vec_ar3_CMatPP &displ) const;
+    int getActiveNr() const {return mActiveNu == mMaxNu ? mMaxNr : 2 * mActiveNu + 1;};
+    
+    // elements at rest before the wavefront arrives
+    bool atRest(const vec_CMatPP &displ) const;
+    bool atRest(const vec_ar3_CMatPP &displ) const;
+    
     int mMaxNu;
     int mMaxNr;
     std::array<Point *, nPntElem> mPoints;
@@ -70,6 +130,16 @@ protected:
     // flags
     bool mHasPRT;
     
+    // the highest order computed in the time loop
+    mutable int mActiveNu;
+    bool mAdaptiveNu;
+    bool mElemNu3D;
+    std::vector<int> mNuSchedule;
+    
+    // set at the first nonzero displacement, after which the element
+    // may carry memory variables and is always computed
+    mutable bool mAwake;
+    
 public:
     // domain tag, mainly for debug
     void setDomainTag(int tag) {mDomainTag = tag;};
@@ -77,5 +147,8 @@ public:
     
 private:
     int mDomainTag;
+    
+    // threshold of adaptive Nu, 0 for off
+    static double sAdaptiveNuTol;
 };
 
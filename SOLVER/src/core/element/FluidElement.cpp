@@ -7,8 +7,11 @@
 #include "Gradient.h"
 #include "PRT.h"
 #include "Acoustic.h"
+#include "FluidPoint.h"
 #include "CrdTransTIsoFluid.h"
 #include "FieldFFT.h"
+#include "SolverFFTW_N3.h"
+#include "XOMP.h"
 
 #include "MultilevelTimer.h"
 
@@ -31,6 +34,16 @@ Element(grad, prt, points), mAcoustic(acous), mCrdTransTIso(0) {
         }
     } 
     mElem3D = !acous1D;
+    initActiveNu(mElem3D);
+    // with particle relabelling, strain and stress are rotated and relabelled
+    mFusedK = mHasPRT ? 0 : mAcoustic->fusedModulus();
+    for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+        mFluidPoints[ipnt] = mPoints[ipnt]->fluidPoint();
+        if (mFluidPoints[ipnt] == 0) {
+            throw std::runtime_error("FluidElement::FluidElement || "
+                "A fluid element must be on fluid or solid-fluid points.");
+        }
+    }
 }
 
 FluidElement::~FluidElement() {
@@ -41,25 +54,42 @@ FluidElement::~FluidElement() {
 }
     
 void FluidElement::computeStiff() const {
-    // setup static
-    sResponse.setNr(mMaxNr);
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
     
     // get displ from points
     int ipnt = 0;
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
-            mPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
+            mFluidPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
         }
     }
+    
+    // zero displacement and zero history give zero stiffness
+    if (atRest(sResponse.mDispl)) {
+        return;
+    }
+    
+    // setup static
+    if (mAdaptiveNu) {
+        updateActiveNu(sResponse.mDispl);
+    }
+    sResponse.setNr(getActiveNr());
         
     // compute stiff
     displToStiff();
     
+    // orders above the active Nu do not contribute
+    if (mActiveNu < mMaxNu) {
+        for (int alpha = mActiveNu + 1; alpha <= mMaxNu; alpha++) {
+            sResponse.mStiff[alpha].setZero();
+        }
+    }
+    
     // set stiff to points
     ipnt = 0;
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
-            mPoints[ipnt++]->gatherStiffFromElement(sResponse.mStiff, ipol, jpol);
+            mFluidPoints[ipnt++]->gatherStiffFromElement(sResponse.mStiff, ipol, jpol);
         }
     }
 }
@@ -92,6 +122,7 @@ double FluidElement::measure(int count) const {
 }
 
 void FluidElement::test() const {
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
     // zero disp
     sResponse.setNr(mMaxNr);
     for (int alpha = 0; alpha <= mMaxNu; alpha++) {
@@ -160,7 +191,8 @@ void FluidElement::test() const {
     }
 }
 
-void FluidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u_spz) const {
+FluidResponse &FluidElement::displToGroundMotion() const {
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
     // setup static
     sResponse.setNr(mMaxNr);
     
@@ -172,7 +204,7 @@ void FluidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u
         }
     }
     
-    mGradient->computeGrad(sResponse.mDispl, sResponse.mStrain, sResponse.mNu, sResponse.mNyquist);
+    mGradient->computeGrad(sResponse.mDispl, sResponse.mStrain, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
     if (mInTIso) {
         mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain, sResponse.mNu);
     }
@@ -192,6 +224,11 @@ void FluidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u
     if (mInTIso) {
         mCrdTransTIso->transformRTZ_SPZ(sResponse.mStress, sResponse.mNu);
     }
+    return sResponse;
+}
+
+void FluidElement::computeGroundMotion(const CColX &expPhi, const RMatPP &weights, RRow3 &u_spz) const {
+    const FluidResponse &sResponse = displToGroundMotion();
     
     // compute ground motion pointwise
     u_spz.setZero();
@@ -201,8 +238,8 @@ void FluidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u
             Real up0 = sResponse.mStress[0][0](ipol, jpol).real();
             Real up1 = sResponse.mStress[0][1](ipol, jpol).real();
             Real up2 = sResponse.mStress[0][2](ipol, jpol).real();
-            for (int alpha = 1; alpha <= mMaxNu - (int)(mMaxNr % 2 == 0); alpha++) {
-                Complex expval = two * exp((Real)alpha * phi * ii);
+            for (int alpha = 1; alpha < expPhi.size(); alpha++) {
+                const Complex &expval = expPhi(alpha);
                 up0 += (expval * sResponse.mStress[alpha][0](ipol, jpol)).real();
                 up1 += (expval * sResponse.mStress[alpha][1](ipol, jpol)).real();
                 up2 += (expval * sResponse.mStress[alpha][2](ipol, jpol)).real();
@@ -214,12 +251,28 @@ void FluidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u
     }
 }
 
+void FluidElement::feedDisplFourier(CMatXX &displ) const {
+    const FluidResponse &sResponse = displToGroundMotion();
+    displ.setZero();
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            int ipnt = ipol * nPntEdge + jpol;
+            for (int idim = 0; idim < 3; idim++) {
+                for (int alpha = 0; alpha <= sResponse.mNu; alpha++) {
+                    displ(ipnt, idim * (mMaxNu + 1) + alpha) = sResponse.mStress[alpha][idim](ipol, jpol);
+                }
+            }
+        }
+    }
+}
+
 #include "SolidElement.h"
-#include "SolverFFTW_N6.h"
-void FluidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain) const {
+void FluidElement::computeStrain(const CColX &expPhi, const RMatPP &weights, RRow6 &strain) const {
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
+    SolidResponse &sResponseSolid = SolidElement::sResponses[XOMP::threadID()];
     // setup static
     sResponse.setNr(mMaxNr);
-    SolidElement::sResponse.setNr(mMaxNr);
+    sResponseSolid.setNr(mMaxNr);
     
     // get displ from points
     int ipnt = 0;
@@ -229,7 +282,7 @@ void FluidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
         }
     }
     
-    mGradient->computeGrad(sResponse.mDispl, sResponse.mStrain, sResponse.mNu, sResponse.mNyquist);
+    mGradient->computeGrad(sResponse.mDispl, sResponse.mStrain, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
     if (mInTIso) {
         mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain, sResponse.mNu);
     }
@@ -252,27 +305,24 @@ void FluidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
     
     //////////////////////
     if (mHasPRT) {
-        mGradient->computeGrad9(sResponse.mStress, SolidElement::sResponse.mStrain9, 
-            SolidElement::sResponse.mNu, SolidElement::sResponse.mNyquist);
-        mCrdTransTIso->transformSPZ_RTZ(SolidElement::sResponse.mStrain9, 
-            SolidElement::sResponse.mNu);
+        mGradient->computeGrad9(sResponse.mStress, sResponseSolid.mStrain9, 
+            sResponseSolid.mNu, sResponseSolid.mNyquist, sResponseSolid.mGradWS);
+        mCrdTransTIso->transformSPZ_RTZ(sResponseSolid.mStrain9, 
+            sResponseSolid.mNu);
         if (mElem3D) {
-            FieldFFT::transformF2P(SolidElement::sResponse.mStrain9, SolidElement::sResponse.mNr);
+            FieldFFT::transformF2P(sResponseSolid.mStrain9, sResponseSolid.mNr);
             // OUT: SolverFFTW_N9::getC2R_RMat
-            mPRT->sphericalToUndulated(SolidElement::sResponse);
+            mPRT->sphericalToUndulated(sResponseSolid);
             // OUT: SolverFFTW_N6::getC2R_RMat
-            SolverFFTW_N6::getR2C_RMat().topRows(SolidElement::sResponse.mNr) = 
-            SolverFFTW_N6::getC2R_RMat().topRows(SolidElement::sResponse.mNr);
-            // OUT: SolverFFTW_N6::getR2C_RMat
-            FieldFFT::transformP2F(SolidElement::sResponse.mStrain6, SolidElement::sResponse.mNr);
+            FieldFFT::transformP2F(sResponseSolid.mStrain6, sResponseSolid.mNr, true);
         } else {
-            mPRT->sphericalToUndulated(SolidElement::sResponse);
+            mPRT->sphericalToUndulated(sResponseSolid);
         }
     } else {
-        mGradient->computeGrad6(sResponse.mStress, SolidElement::sResponse.mStrain6, 
-            SolidElement::sResponse.mNu, SolidElement::sResponse.mNyquist);
-        mCrdTransTIso->transformSPZ_RTZ(SolidElement::sResponse.mStrain6, 
-            SolidElement::sResponse.mNu);
+        mGradient->computeGrad6(sResponse.mStress, sResponseSolid.mStrain6, 
+            sResponseSolid.mNu, sResponseSolid.mNyquist, sResponseSolid.mGradWS);
+        mCrdTransTIso->transformSPZ_RTZ(sResponseSolid.mStrain6, 
+            sResponseSolid.mNu);
     }
     
     //////////////
@@ -280,20 +330,20 @@ void FluidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             if (std::abs(weights(ipol, jpol)) < tinyDouble) continue;
-            Real s0 = SolidElement::sResponse.mStrain6[0][0](ipol, jpol).real();
-            Real s1 = SolidElement::sResponse.mStrain6[0][1](ipol, jpol).real();
-            Real s2 = SolidElement::sResponse.mStrain6[0][2](ipol, jpol).real();
-            Real s3 = SolidElement::sResponse.mStrain6[0][3](ipol, jpol).real();
-            Real s4 = SolidElement::sResponse.mStrain6[0][4](ipol, jpol).real();
-            Real s5 = SolidElement::sResponse.mStrain6[0][5](ipol, jpol).real();
-            for (int alpha = 1; alpha <= mMaxNu - (int)(mMaxNr % 2 == 0); alpha++) {
-                Complex expval = two * exp((Real)alpha * phi * ii);
-                s0 += (expval * SolidElement::sResponse.mStrain6[alpha][0](ipol, jpol)).real();
-                s1 += (expval * SolidElement::sResponse.mStrain6[alpha][1](ipol, jpol)).real();
-                s2 += (expval * SolidElement::sResponse.mStrain6[alpha][2](ipol, jpol)).real();
-                s3 += (expval * SolidElement::sResponse.mStrain6[alpha][3](ipol, jpol)).real();
-                s4 += (expval * SolidElement::sResponse.mStrain6[alpha][4](ipol, jpol)).real();
-                s5 += (expval * SolidElement::sResponse.mStrain6[alpha][5](ipol, jpol)).real();
+            Real s0 = sResponseSolid.mStrain6[0][0](ipol, jpol).real();
+            Real s1 = sResponseSolid.mStrain6[0][1](ipol, jpol).real();
+            Real s2 = sResponseSolid.mStrain6[0][2](ipol, jpol).real();
+            Real s3 = sResponseSolid.mStrain6[0][3](ipol, jpol).real();
+            Real s4 = sResponseSolid.mStrain6[0][4](ipol, jpol).real();
+            Real s5 = sResponseSolid.mStrain6[0][5](ipol, jpol).real();
+            for (int alpha = 1; alpha < expPhi.size(); alpha++) {
+                const Complex &expval = expPhi(alpha);
+                s0 += (expval * sResponseSolid.mStrain6[alpha][0](ipol, jpol)).real();
+                s1 += (expval * sResponseSolid.mStrain6[alpha][1](ipol, jpol)).real();
+                s2 += (expval * sResponseSolid.mStrain6[alpha][2](ipol, jpol)).real();
+                s3 += (expval * sResponseSolid.mStrain6[alpha][3](ipol, jpol)).real();
+                s4 += (expval * sResponseSolid.mStrain6[alpha][4](ipol, jpol)).real();
+                s5 += (expval * sResponseSolid.mStrain6[alpha][5](ipol, jpol)).real();
             }
             strain(0) += weights(ipol, jpol) * s0;
             strain(1) += weights(ipol, jpol) * s1;
@@ -305,7 +355,7 @@ void FluidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
     }
 }
 
-void FluidElement::computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) const {
+void FluidElement::computeCurl(const CColX &expPhi, const RMatPP &weights, RRow3 &curl) const {
     // no curl in fluid
     curl.setZero();
 }
@@ -322,6 +372,16 @@ void FluidElement::feedDispOnSide(int side, CMatXX_RM &buffer, int row) const {
         "Not implemented."); 
 }
 
+void FluidElement::feedStrainFourier(CMatXX &strain) const {
+    throw std::runtime_error("FluidElement::feedStrainFourier || "
+        "Not implemented."); 
+}
+
+void FluidElement::feedStrainOnSide(int side, CMatXX_RM &buffer, int row) const {
+    throw std::runtime_error("FluidElement::feedStrainOnSide || "
+        "Not implemented."); 
+}
+
 std::string FluidElement::verbose() const {
     if (mHasPRT) {
         return "FluidElement$" + mPRT->verbose() + "$" + mAcoustic->verbose();
@@ -330,13 +390,28 @@ std::string FluidElement::verbose() const {
     }
 }
 
+void FluidElement::memoryBytes(std::map<std::string, double> &bytes) const {
+    Element::memoryBytes(bytes);
+    bytes["Elements"] += sizeof(*this) + (mCrdTransTIso ? sizeof(CrdTransTIsoFluid) : 0);
+    bytes["Acoustic"] += mAcoustic->memoryBytes();
+}
+
 void FluidElement::displToStiff() const {
-    mGradient->computeGrad(sResponse.mDispl, sResponse.mStrain, sResponse.mNu, sResponse.mNyquist);
+    if (mFusedK) {
+        displToStiffFused();
+        return;
+    }
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
+    // 3D elements hold strain and stress in the Fourier-space FFT buffers, 
+    // which Gradient writes and reads in place
+    vec_ar3_CMatPP &strain = mElem3D ? SolverFFTW_N3::getC2R_CMat() : sResponse.mStrain;
+    vec_ar3_CMatPP &stress = mElem3D ? SolverFFTW_N3::getR2C_CMat() : sResponse.mStress;
+    mGradient->computeGrad(sResponse.mDispl, strain, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
     if (mInTIso) {
-        mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain, sResponse.mNu);
+        mCrdTransTIso->transformSPZ_RTZ(strain, sResponse.mNu);
     }
     if (mElem3D) {
-        FieldFFT::transformF2P(sResponse.mStrain, sResponse.mNr);
+        FieldFFT::transformF2P(strain, sResponse.mNr);
     }
     if (mHasPRT) {
         mPRT->sphericalToUndulated(sResponse);
@@ -346,20 +421,43 @@ void FluidElement::displToStiff() const {
         mPRT->undulatedToSpherical(sResponse);
     }
     if (mElem3D) {
-        FieldFFT::transformP2F(sResponse.mStress, sResponse.mNr);
+        FieldFFT::transformP2F(stress, sResponse.mNr);
     }
     if (mInTIso) {
-        mCrdTransTIso->transformRTZ_SPZ(sResponse.mStress, sResponse.mNu);
+        mCrdTransTIso->transformRTZ_SPZ(stress, sResponse.mNu);
+    }
+    mGradient->computeQuad(sResponse.mStiff, stress, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
+}
+
+void FluidElement::displToStiffFused() const {
+    FluidResponse &sResponse = sResponses[XOMP::threadID()];
+    for (int alpha = 0; alpha <= sResponse.mNu - sResponse.mNyquist; alpha++) {
+        mGradient->computeStiffFluid(sResponse.mDispl[alpha], sResponse.mStiff[alpha], 
+            *mFusedK, alpha, sResponse.mGradWS);
+    }
+    // mask Nyquist
+    if (sResponse.mNyquist) {
+        sResponse.mStiff[sResponse.mNu].setZero();
     }
-    mGradient->computeQuad(sResponse.mStiff, sResponse.mStress, sResponse.mNu, sResponse.mNyquist);
 }
 
 //-------------------------- static --------------------------//
-FluidResponse FluidElement::sResponse;
+std::vector<FluidResponse> FluidElement::sResponses;
 void FluidElement::initWorkspace(int maxMaxNu) {
-    sResponse.mDispl = vec_CMatPP(maxMaxNu + 1, CMatPP::Zero());
-    sResponse.mStiff = vec_CMatPP(maxMaxNu + 1, CMatPP::Zero());
-    sResponse.mStrain = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
-    sResponse.mStress = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
+    // one workspace per thread
+    sResponses = std::vector<FluidResponse>(XOMP::nThreads());
+    for (auto &sResponse: sResponses) {
+        sResponse.mDispl = vec_CMatPP(maxMaxNu + 1, CMatPP::Zero());
+        sResponse.mStiff = vec_CMatPP(maxMaxNu + 1, CMatPP::Zero());
+        sResponse.mStrain = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
+        sResponse.mStress = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
+    }
 }
 
+size_t FluidElement::workspaceBytes() {
+    size_t bytes = heapBytes(sResponses);
+    for (const FluidResponse &sResponse: sResponses) {
+        bytes += sResponse.memoryBytes() - sizeof(FluidResponse);
+    }
+    return bytes;
+}
@@ -5,11 +5,13 @@
 #pragma once
 
 #include "Element.h"
+#include "Gradient.h"
 
 class Acoustic;
+class FluidPoint;
 class CrdTransTIsoFluid;
 
-// static workspaces
+// static workspaces, one per thread
 struct FluidResponse {
     // disp
     vec_CMatPP mDispl;
@@ -19,6 +21,8 @@ struct FluidResponse {
     vec_ar3_CMatPP mStress;
     // stiff
     vec_CMatPP mStiff;
+    // gradient kernels
+    GradientWorkspace mGradWS;
     // size
     int mNu = 0;
     int mNr = 1;
@@ -28,6 +32,11 @@ struct FluidResponse {
         mNu = nr / 2;
         mNyquist = (int)(mNr % 2 == 0);
     };
+    // bytes, for memory reports
+    size_t memoryBytes() const {
+        return sizeof(*this) - sizeof(mGradWS) + mGradWS.memoryBytes() + 
+            heapBytes(mDispl) + heapBytes(mStrain) + heapBytes(mStress) + heapBytes(mStiff);
+    };
 };
 
 
@@ -48,21 +57,33 @@ public:
     void test() const;
     
     // compute Real displacement, used by receiver
-    void computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u_spz) const; 
-    void computeStrain(Real phi, const RMatPP &weights, RRow6 &strain) const; 
-    void computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) const; 
+    void computeGroundMotion(const CColX &expPhi, const RMatPP &weights, RRow3 &u_spz) const; 
+    void computeStrain(const CColX &expPhi, const RMatPP &weights, RRow6 &strain) const; 
+    void computeCurl(const CColX &expPhi, const RMatPP &weights, RRow3 &curl) const; 
+    void feedDisplFourier(CMatXX &displ) const; 
+    void feedStrainFourier(CMatXX &strain) const; 
     void forceTIso();
     
     // side-wise
     void feedDispOnSide(int side, CMatXX_RM &buffer, int row) const; 
+    void feedStrainOnSide(int side, CMatXX_RM &buffer, int row) const; 
     
     // verbose
     std::string verbose() const;
     
+    // add the bytes of this element by subsystem
+    void memoryBytes(std::map<std::string, double> &bytes) const;
+    
 private:
     
     // displ ==> stiff
     void displToStiff() const;
+    // displ ==> stiff of 1D elements by the fused scalar kernel, one 
+    // pass per mode
+    void displToStiffFused() const;
+    
+    // displ ==> ground motion in SPZ, Fourier coefficients in the workspace
+    FluidResponse &displToGroundMotion() const;
     
     // material
     Acoustic *mAcoustic;
@@ -72,12 +93,20 @@ private:
     bool mInTIso;
     bool mElem3D;
     
+    // modulus of the fused scalar kernel, 0 if not fused
+    const RMatPP *mFusedK;
+    // the fluid points, or the fluid parts of solid-fluid points, 
+    // for direct calls in the time loop
+    std::array<FluidPoint *, nPntElem> mFluidPoints;
+    
 //-------------------------- static --------------------------//    
 public:
     // initialize static workspace
     static void initWorkspace(int maxMaxNu);
+    // bytes of the static workspaces
+    static size_t workspaceBytes();
     
 private:
-    // static workspaces
-    static FluidResponse sResponse;
+    // static workspaces, one per thread
+    static std::vector<FluidResponse> sResponses;
 };
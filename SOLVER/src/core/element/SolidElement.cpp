@@ -7,8 +7,14 @@
 #include "Gradient.h"
 #include "PRT.h"
 #include "Elastic.h"
+#include "Isotropic1D.h"
+#include "TransverselyIsotropic1D.h"
+#include "SolidPoint.h"
 #include "CrdTransTIsoSolid.h"
 #include "FieldFFT.h"
+#include "SolverFFTW_N6.h"
+#include "SolverFFTW_N9.h"
+#include "XOMP.h"
 
 #include "MultilevelTimer.h"
 
@@ -19,9 +25,12 @@ Element(grad, prt, points), mElastic(elas), mCrdTransTIso(0) {
     mElastic->checkCompatibility(mMaxNr);
     // TISO
     mInTIso = mHasPRT || mElastic->needTIso();
-    if (mInTIso) {
+    if (mHasPRT) {
         mCrdTransTIso = new CrdTransTIsoSolid(formThetaMat());
-    } 
+    } else if (mInTIso) {
+        // folded into the gradient operators of the 6-component path
+        mGradient->setTIso(formThetaMat());
+    }
     // 3D
     bool elas1D = mElastic->is1D();
     if (mHasPRT) {
@@ -31,39 +40,96 @@ Element(grad, prt, points), mElastic(elas), mCrdTransTIso(0) {
         }
     } 
     mElem3D = !elas1D;
+    initActiveNu(mElem3D);
+    // with particle relabelling, the modes are coupled in relabelling
+    mFusedModes = !mHasPRT && mElastic->fusedModes();
+    if (mFusedModes) {
+        if (dynamic_cast<Isotropic1D *>(mElastic)) {
+            mFusedKernel = &SolidElement::displToStiffFused<Isotropic1D>;
+        } else if (dynamic_cast<TransverselyIsotropic1D *>(mElastic)) {
+            mFusedKernel = &SolidElement::displToStiffFused<TransverselyIsotropic1D>;
+        } else {
+            mFusedKernel = &SolidElement::displToStiffFused<Elastic>;
+        }
+    }
+    for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+        mSolidPoints[ipnt] = mPoints[ipnt]->solidPoint();
+        if (mSolidPoints[ipnt] == 0) {
+            throw std::runtime_error("SolidElement::SolidElement || "
+                "A solid element must be on solid or solid-fluid points.");
+        }
+    }
 }
 
 SolidElement::~SolidElement() {
     delete mElastic;
-    if (mInTIso) {
+    if (mCrdTransTIso) {
         delete mCrdTransTIso;
     }
 }
 
 void SolidElement::computeStiff() const {
-    // setup static
-    sResponse.setNr(mMaxNr);
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
     
     // get displ from points
     int ipnt = 0;
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
-            mPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
+            mSolidPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
+        }
+    }
+    
+    // zero displacement and zero history give zero stiffness
+    if (atRest(sResponse.mDispl)) {
+        if (mTapPoints.size() > 0) {
+            mTapStiff.setZero();
         }
+        return;
+    }
+    
+    // setup static
+    if (mAdaptiveNu) {
+        updateActiveNu(sResponse.mDispl);
     }
+    sResponse.setNr(getActiveNr());
         
     // compute stiff
     displToStiff();
     
+    // orders above the active Nu do not contribute
+    if (mActiveNu < mMaxNu) {
+        for (int alpha = mActiveNu + 1; alpha <= mMaxNu; alpha++) {
+            sResponse.mStiff[alpha][0].setZero();
+            sResponse.mStiff[alpha][1].setZero();
+            sResponse.mStiff[alpha][2].setZero();
+        }
+    }
+    
+    // kept for box injection
+    for (int itap = 0; itap < mTapPoints.size(); itap++) {
+        int ipol = mTapPoints[itap] / nPntEdge;
+        int jpol = mTapPoints[itap] % nPntEdge;
+        for (int alpha = 0; alpha <= mMaxNu; alpha++) {
+            for (int idim = 0; idim < 3; idim++) {
+                mTapStiff(alpha, itap * 3 + idim) = sResponse.mStiff[alpha][idim](ipol, jpol);
+            }
+        }
+    }
+    
     // set stiff to points
     ipnt = 0;
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
-            mPoints[ipnt++]->gatherStiffFromElement(sResponse.mStiff, ipol, jpol);
+            mSolidPoints[ipnt++]->gatherStiffFromElement(sResponse.mStiff, ipol, jpol);
         }
     }
 }
 
+void SolidElement::setStiffTap(const std::vector<int> &ipnts) {
+    mTapPoints = ipnts;
+    mTapStiff = CMatXX::Zero(mMaxNu + 1, 3 * ipnts.size());
+}
+
 double SolidElement::measure(int count) const {
     // random disp
     int ipnt = 0;
@@ -94,6 +160,7 @@ double SolidElement::measure(int count) const {
 }
 
 void SolidElement::test() const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
     // zero disp
     for (int alpha = 0; alpha <= mMaxNu; alpha++) {
         sResponse.mDispl[alpha][0].setZero();
@@ -186,27 +253,24 @@ void SolidElement::test() const {
     }
 }
 
-void SolidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u_spz) const {
-    // get displ from points
-    int ipnt = 0;
-    for (int ipol = 0; ipol <= nPol; ipol++) {
-        for (int jpol = 0; jpol <= nPol; jpol++) {
-            mPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
-        }
-    }
-    // compute ground motion pointwise
+void SolidElement::computeGroundMotion(const CColX &expPhi, const RMatPP &weights, RRow3 &u_spz) const {
+    // read displ directly from the points with nonzero weights
     u_spz.setZero();
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             if (std::abs(weights(ipol, jpol)) < tinyDouble) continue;
-            Real up0 = sResponse.mDispl[0][0](ipol, jpol).real();
-            Real up1 = sResponse.mDispl[0][1](ipol, jpol).real();
-            Real up2 = sResponse.mDispl[0][2](ipol, jpol).real();
-            for (int alpha = 1; alpha <= mMaxNu - (int)(mMaxNr % 2 == 0); alpha++) {
-                Complex expval = two * exp((Real)alpha * phi * ii);
-                up0 += (expval * sResponse.mDispl[alpha][0](ipol, jpol)).real();
-                up1 += (expval * sResponse.mDispl[alpha][1](ipol, jpol)).real();
-                up2 += (expval * sResponse.mDispl[alpha][2](ipol, jpol)).real();
+            const Point *point = mPoints[ipol * nPntEdge + jpol];
+            const CMatX3Map &displ = point->getDispFourierSolid();
+            // orders of the point, Nyquist masked
+            int nu = std::min(point->getNu() - (int)(point->getNr() % 2 == 0), (int)expPhi.size() - 1);
+            Real up0 = displ(0, 0).real();
+            Real up1 = displ(0, 1).real();
+            Real up2 = displ(0, 2).real();
+            for (int alpha = 1; alpha <= nu; alpha++) {
+                const Complex &expval = expPhi(alpha);
+                up0 += (expval * displ(alpha, 0)).real();
+                up1 += (expval * displ(alpha, 1)).real();
+                up2 += (expval * displ(alpha, 2)).real();
             }
             u_spz(0) += weights(ipol, jpol) * up0;
             u_spz(1) += weights(ipol, jpol) * up1;
@@ -215,8 +279,8 @@ void SolidElement::computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u
     }
 }
 
-#include "SolverFFTW_N6.h"
-void SolidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain) const {
+SolidResponse &SolidElement::displToStrain() const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
     // setup static
     sResponse.setNr(mMaxNr);
     
@@ -229,26 +293,79 @@ void SolidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
     }
     
     if (mHasPRT) {
-        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist);
+        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
         mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain9, sResponse.mNu);
         if (mElem3D) {
             FieldFFT::transformF2P(sResponse.mStrain9, sResponse.mNr);
             // OUT: SolverFFTW_N9::getC2R_RMat
             mPRT->sphericalToUndulated(sResponse);
             // OUT: SolverFFTW_N6::getC2R_RMat
-            SolverFFTW_N6::getR2C_RMat().topRows(sResponse.mNr) = 
-            SolverFFTW_N6::getC2R_RMat().topRows(sResponse.mNr);
-            // OUT: SolverFFTW_N6::getR2C_RMat
-            FieldFFT::transformP2F(sResponse.mStrain6, sResponse.mNr);
+            FieldFFT::transformP2F(sResponse.mStrain6, sResponse.mNr, true);
         } else {
             mPRT->sphericalToUndulated(sResponse);
         }
     } else {
-        mGradient->computeGrad6(sResponse.mDispl, sResponse.mStrain6, sResponse.mNu, sResponse.mNyquist);
-        mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain6, sResponse.mNu);
+        mGradient->computeGrad6(sResponse.mDispl, sResponse.mStrain6, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
+        if (!mGradient->isTIso()) {
+            mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain6, sResponse.mNu);
+        }
     }
-    
-    //////////////
+    return sResponse;
+}
+
+void SolidElement::feedDisplFourier(CMatXX &displ) const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
+    int ipnt = 0;
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            mPoints[ipnt++]->scatterDisplToElement(sResponse.mDispl, ipol, jpol, mMaxNu);
+        }
+    }
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            int ipnt = ipol * nPntEdge + jpol;
+            for (int idim = 0; idim < 3; idim++) {
+                for (int alpha = 0; alpha <= mMaxNu; alpha++) {
+                    displ(ipnt, idim * (mMaxNu + 1) + alpha) = sResponse.mDispl[alpha][idim](ipol, jpol);
+                }
+            }
+        }
+    }
+}
+
+bool SolidElement::feedDisplFourier(const std::vector<int> &ipnts, CMatXX &displ) const {
+    for (int k = 0; k < ipnts.size(); k++) {
+        const Point *point = mPoints[ipnts[k]];
+        const CMatX3Map &pdispl = point->getDispFourierSolid();
+        // orders of the point, Nyquist and higher orders masked
+        int nu = std::min(point->getNu() - (int)(point->getNr() % 2 == 0), mMaxNu);
+        displ.row(k).setZero();
+        for (int idim = 0; idim < 3; idim++) {
+            for (int alpha = 0; alpha <= nu; alpha++) {
+                displ(k, idim * (mMaxNu + 1) + alpha) = pdispl(alpha, idim);
+            }
+        }
+    }
+    return true;
+}
+
+void SolidElement::feedStrainFourier(CMatXX &strain) const {
+    const SolidResponse &sResponse = displToStrain();
+    strain.leftCols(6 * (mMaxNu + 1)).setZero();
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            int ipnt = ipol * nPntEdge + jpol;
+            for (int idim = 0; idim < 6; idim++) {
+                for (int alpha = 0; alpha <= sResponse.mNu; alpha++) {
+                    strain(ipnt, idim * (mMaxNu + 1) + alpha) = sResponse.mStrain6[alpha][idim](ipol, jpol);
+                }
+            }
+        }
+    }
+}
+
+void SolidElement::computeStrain(const CColX &expPhi, const RMatPP &weights, RRow6 &strain) const {
+    const SolidResponse &sResponse = displToStrain();
     strain.setZero();
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
@@ -259,8 +376,8 @@ void SolidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
             Real s3 = sResponse.mStrain6[0][3](ipol, jpol).real();
             Real s4 = sResponse.mStrain6[0][4](ipol, jpol).real();
             Real s5 = sResponse.mStrain6[0][5](ipol, jpol).real();
-            for (int alpha = 1; alpha <= mMaxNu - (int)(mMaxNr % 2 == 0); alpha++) {
-                Complex expval = two * exp((Real)alpha * phi * ii);
+            for (int alpha = 1; alpha < expPhi.size(); alpha++) {
+                const Complex &expval = expPhi(alpha);
                 s0 += (expval * sResponse.mStrain6[alpha][0](ipol, jpol)).real();
                 s1 += (expval * sResponse.mStrain6[alpha][1](ipol, jpol)).real();
                 s2 += (expval * sResponse.mStrain6[alpha][2](ipol, jpol)).real();
@@ -278,8 +395,8 @@ void SolidElement::computeStrain(Real phi, const RMatPP &weights, RRow6 &strain)
     }
 }
 
-#include "SolverFFTW_N9.h"
-void SolidElement::computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) const {
+void SolidElement::computeCurl(const CColX &expPhi, const RMatPP &weights, RRow3 &curl) const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
     // setup static
     sResponse.setNr(mMaxNr);
     
@@ -292,22 +409,19 @@ void SolidElement::computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) con
     }
     
     if (mHasPRT) {
-        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist);
+        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
         mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain9, sResponse.mNu);
         if (mElem3D) {
             FieldFFT::transformF2P(sResponse.mStrain9, sResponse.mNr);
             // OUT: SolverFFTW_N9::getC2R_RMat
             mPRT->sphericalToUndulated9(sResponse);
-            // OUT: SolverFFTW_N9::getC2R_RMat
-            SolverFFTW_N9::getR2C_RMat().topRows(sResponse.mNr) = 
-            SolverFFTW_N9::getC2R_RMat().topRows(sResponse.mNr);
             // OUT: SolverFFTW_N9::getR2C_RMat
             FieldFFT::transformP2F(sResponse.mStrain9, sResponse.mNr);
         } else {
             mPRT->sphericalToUndulated9(sResponse);
         }
     } else {
-        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist);
+        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
         mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain9, sResponse.mNu);
     }
     
@@ -325,8 +439,8 @@ void SolidElement::computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) con
             Real dUZdR = sResponse.mStrain9[0][6](ipol, jpol).real();
             Real dUZdT = sResponse.mStrain9[0][7](ipol, jpol).real();
             // Real dUZdZ = sResponse.mStrain9[0][8](ipol, jpol).real();
-            for (int alpha = 1; alpha <= mMaxNu - (int)(mMaxNr % 2 == 0); alpha++) {
-                Complex expval = two * exp((Real)alpha * phi * ii);
+            for (int alpha = 1; alpha < expPhi.size(); alpha++) {
+                const Complex &expval = expPhi(alpha);
                 // dURdR += (expval * sResponse.mStrain9[alpha][0](ipol, jpol)).real();
                 dURdT += (expval * sResponse.mStrain9[alpha][1](ipol, jpol)).real();
                 dURdZ += (expval * sResponse.mStrain9[alpha][2](ipol, jpol)).real();
@@ -353,29 +467,13 @@ void SolidElement::forceTIso() {
 
 void SolidElement::feedDispOnSide(int side, CMatXX_RM &buffer, int row) const {
     int ipol0 = 0, ipol1 = 0, jpol0 = 0, jpol1 = 0;
-    if (side == 0) {
-        ipol0 = 0;
-        ipol1 = nPol;
-        jpol0 = jpol1 = 0;
-    } else if (side == 1) {
-        ipol0 = ipol1 = nPol;
-        jpol0 = 0;
-        jpol1 = nPol;
-    } else if (side == 2) {
-        ipol0 = 0;
-        ipol1 = nPol;
-        jpol0 = jpol1 = nPol;
-    } else {
-        ipol0 = ipol1 = 0;
-        jpol0 = 0;
-        jpol1 = nPol;
-    }
+    getSideRange(side, ipol0, ipol1, jpol0, jpol1);
     buffer.row(row).setZero();
     int ipntedge = 0;
     for (int ipol = ipol0; ipol <= ipol1; ipol++) {
         for (int jpol = jpol0; jpol <= jpol1; jpol++) {
             int ipnt = ipol * nPntEdge + jpol;
-            const CMatX3 &disp = mPoints[ipnt]->getDispFourierSolid();
+            const CMatX3Map &disp = mPoints[ipnt]->getDispFourierSolid();
             for (int idim = 0; idim < 3; idim++) {
                 // // fast dim: seismogram components
                 // buffer.block(row, ipntedge * 3 * (mMaxNu + 1) + idim * (mMaxNu + 1), 
@@ -389,6 +487,26 @@ void SolidElement::feedDispOnSide(int side, CMatXX_RM &buffer, int row) const {
     }
 }
 
+void SolidElement::feedStrainOnSide(int side, CMatXX_RM &buffer, int row) const {
+    const SolidResponse &sResponse = displToStrain();
+    int ipol0 = 0, ipol1 = 0, jpol0 = 0, jpol1 = 0;
+    getSideRange(side, ipol0, ipol1, jpol0, jpol1);
+    buffer.row(row).setZero();
+    int ipntedge = 0;
+    for (int ipol = ipol0; ipol <= ipol1; ipol++) {
+        for (int jpol = jpol0; jpol <= jpol1; jpol++) {
+            for (int idim = 0; idim < 6; idim++) {
+                // fast dim: points, as in feedDispOnSide
+                int col = idim * nPntEdge * (mMaxNu + 1) + ipntedge * (mMaxNu + 1);
+                for (int alpha = 0; alpha <= sResponse.mNu; alpha++) {
+                    buffer(row, col + alpha) = sResponse.mStrain6[alpha][idim](ipol, jpol);
+                }
+            }
+            ipntedge++;
+        }
+    }
+}
+
 std::string SolidElement::verbose() const {
     if (mHasPRT) {
         return "SolidElement$" + mPRT->verbose() + "$" + mElastic->verbose();
@@ -397,61 +515,202 @@ std::string SolidElement::verbose() const {
     }
 }
 
+void SolidElement::memoryBytes(std::map<std::string, double> &bytes) const {
+    Element::memoryBytes(bytes);
+    bytes["Elements"] += sizeof(*this) + (mCrdTransTIso ? sizeof(CrdTransTIsoSolid) : 0);
+    bytes["Elastic"] += mElastic->memoryBytes();
+    bytes["Attenuation"] += mElastic->attenuationBytes();
+    if (mLumpedK.size() > 0) {
+        bytes["Lumped Stiffness"] += heapBytes(mLumpedK);
+    }
+}
+
+std::string SolidElement::lumpedStiffnessClass() const {
+    // the axial kernels treat alpha = 1 apart, and particle relabelling 
+    // couples the modes
+    if (mElem3D || mHasPRT || axial() || !mElastic->linearModes()) {
+        return "";
+    }
+    return mElastic->verbose();
+}
+
+size_t SolidElement::formLumpedStiffness() {
+    if (lumpedStiffnessClass() == "") {
+        return 0;
+    }
+    // response to a unit displacement at each dof, at alpha = 0, 1 and 2
+    const int ndof = 3 * nPntElem;
+    GradientWorkspace ws;
+    ar3_CMatPP u, f;
+    ar6_CMatPP strain, stress;
+    Eigen::Map<CColX> uflat(u[0].data(), ndof);
+    Eigen::Map<const CColX> fflat(f[0].data(), ndof);
+    RMatXX K(3 * ndof, ndof);
+    CMatXX f2(ndof, ndof);
+    for (int jdof = 0; jdof < ndof; jdof++) {
+        for (int alpha = 0; alpha <= 2; alpha++) {
+            u = zero_ar3_CMatPP;
+            uflat(jdof) = one;
+            strain = zero_ar6_CMatPP;
+            f = zero_ar3_CMatPP;
+            mGradient->computeGrad6(u, strain, alpha, ws);
+            mElastic->strainToStressMode(strain, stress, alpha);
+            mGradient->computeQuad6(f, stress, alpha, ws);
+            if (alpha == 0) {
+                // A
+                K.block(0, jdof, ndof, 1) = fflat.real();
+            } else if (alpha == 1) {
+                // A + i B + C
+                K.block(ndof, jdof, ndof, 1) = fflat.imag();
+                K.block(2 * ndof, jdof, ndof, 1) = fflat.real() - K.block(0, jdof, ndof, 1);
+            } else {
+                f2.col(jdof) = fflat;
+            }
+        }
+    }
+    // alpha = 2 must be reproduced, or the operator is not quadratic in alpha
+    CMatXX pred = (K.topRows(ndof) + (Real)4. * K.bottomRows(ndof)).cast<Complex>() 
+        + (two * ii) * K.middleRows(ndof, ndof).cast<Complex>();
+    if ((pred - f2).norm() > (Real)1e-4 * f2.norm()) {
+        return 0;
+    }
+    mLumpedK = K;
+    return heapBytes(mLumpedK);
+}
+
 void SolidElement::resetZero() {
+    Element::resetZero();
     mElastic->resetZero();
 }
 
+void SolidElement::syncState(Checkpoint &cp) {
+    Element::syncState(cp);
+    mElastic->syncState(cp);
+}
+
 void SolidElement::displToStiff() const {
+    // precomputed operators, for any Nr
+    if (mLumpedK.size() > 0) {
+        displToStiffLumped();
+        return;
+    }
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
+    // attenuation runs over all orders up to mMaxNu
+    if (mFusedModes && sResponse.mNr == mMaxNr) {
+        (this->*mFusedKernel)();
+        return;
+    }
+    // 3D elements hold strain and stress in the Fourier-space FFT buffers, 
+    // which Gradient writes and reads in place
     if (mHasPRT) {
-        mGradient->computeGrad9(sResponse.mDispl, sResponse.mStrain9, sResponse.mNu, sResponse.mNyquist);
+        vec_ar9_CMatPP &strain9 = mElem3D ? SolverFFTW_N9::getC2R_CMat() : sResponse.mStrain9;
+        mGradient->computeGrad9(sResponse.mDispl, strain9, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
         if (mInTIso) {
-            mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain9, sResponse.mNu);
+            mCrdTransTIso->transformSPZ_RTZ(strain9, sResponse.mNu);
         }    
         if (mElem3D) {
-            FieldFFT::transformF2P(sResponse.mStrain9, sResponse.mNr);
+            FieldFFT::transformF2P(strain9, sResponse.mNr);
         }
-        mPRT->sphericalToUndulated(sResponse);
+        // relabelling on both sides of strainToStress in one pass
+        mElastic->strainToStress(sResponse, *mPRT);
     } else {
-        mGradient->computeGrad6(sResponse.mDispl, sResponse.mStrain6, sResponse.mNu, sResponse.mNyquist);
-        if (mInTIso) {
-            mCrdTransTIso->transformSPZ_RTZ(sResponse.mStrain6, sResponse.mNu);
+        vec_ar6_CMatPP &strain6 = mElem3D ? SolverFFTW_N6::getC2R_CMat() : sResponse.mStrain6;
+        mGradient->computeGrad6(sResponse.mDispl, strain6, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
+        if (mInTIso && !mGradient->isTIso()) {
+            mCrdTransTIso->transformSPZ_RTZ(strain6, sResponse.mNu);
         }    
         if (mElem3D) {
-            FieldFFT::transformF2P(sResponse.mStrain6, sResponse.mNr);
+            FieldFFT::transformF2P(strain6, sResponse.mNr);
         }
+        mElastic->strainToStress(sResponse);
     }
-    mElastic->strainToStress(sResponse);
     if (mHasPRT) {
-        mPRT->undulatedToSpherical(sResponse);
+        vec_ar9_CMatPP &stress9 = mElem3D ? SolverFFTW_N9::getR2C_CMat() : sResponse.mStress9;
         if (mElem3D) {
-            FieldFFT::transformP2F(sResponse.mStress9, sResponse.mNr);
+            FieldFFT::transformP2F(stress9, sResponse.mNr);
         }
         if (mInTIso) {
-            mCrdTransTIso->transformRTZ_SPZ(sResponse.mStress9, sResponse.mNu);
+            mCrdTransTIso->transformRTZ_SPZ(stress9, sResponse.mNu);
         }
-        mGradient->computeQuad9(sResponse.mStiff, sResponse.mStress9, sResponse.mNu, sResponse.mNyquist);
+        mGradient->computeQuad9(sResponse.mStiff, stress9, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
     } else {
+        vec_ar6_CMatPP &stress6 = mElem3D ? SolverFFTW_N6::getR2C_CMat() : sResponse.mStress6;
         if (mElem3D) {
-            FieldFFT::transformP2F(sResponse.mStress6, sResponse.mNr);
+            FieldFFT::transformP2F(stress6, sResponse.mNr);
         }
-        if (mInTIso) {
-            mCrdTransTIso->transformRTZ_SPZ(sResponse.mStress6, sResponse.mNu);
+        if (mInTIso && !mGradient->isTIso()) {
+            mCrdTransTIso->transformRTZ_SPZ(stress6, sResponse.mNu);
         }
-        mGradient->computeQuad6(sResponse.mStiff, sResponse.mStress6, sResponse.mNu, sResponse.mNyquist);
+        mGradient->computeQuad6(sResponse.mStiff, stress6, sResponse.mNu, sResponse.mNyquist, sResponse.mGradWS);
     }
     
 }
 
+template <class ElasticType>
+void SolidElement::displToStiffFused() const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
+    const ElasticType &elastic = static_cast<const ElasticType &>(*mElastic);
+    ar6_CMatPP &strain = sResponse.mStrainMode;
+    ar6_CMatPP &stress = sResponse.mStressMode;
+    // the imaginary part of mode 0 is not formed by the gradient
+    strain = zero_ar6_CMatPP;
+    for (int alpha = 0; alpha <= sResponse.mNu - sResponse.mNyquist; alpha++) {
+        mGradient->computeGrad6(sResponse.mDispl[alpha], strain, alpha, sResponse.mGradWS);
+        elastic.strainToStressMode(strain, stress, alpha);
+        mGradient->computeQuad6(sResponse.mStiff[alpha], stress, alpha, sResponse.mGradWS);
+    }
+    // mask Nyquist, whose zero strain still updates the memory variables
+    if (sResponse.mNyquist) {
+        strain = zero_ar6_CMatPP;
+        elastic.strainToStressMode(strain, stress, sResponse.mNu);
+        sResponse.mStiff[sResponse.mNu] = zero_ar3_CMatPP;
+    }
+}
+
+void SolidElement::displToStiffLumped() const {
+    SolidResponse &sResponse = sResponses[XOMP::threadID()];
+    const int ndof = 3 * nPntElem;
+    int nmode = sResponse.mNu + 1 - sResponse.mNyquist;
+    // the modes of the structured fields as columns; mStrain9, unused here,
+    // holds the three products of each mode
+    Eigen::Map<const CMatXX> displ(sResponse.mDispl[0][0].data(), ndof, nmode);
+    Eigen::Map<CMatXX> stiff(sResponse.mStiff[0][0].data(), ndof, sResponse.mNu + 1);
+    Eigen::Map<CMatXX> work(sResponse.mStrain9[0][0].data(), 3 * ndof, nmode);
+    work.noalias() = mLumpedK * displ;
+    // the imaginary part of mode 0 is not formed, as by computeQuad6
+    stiff.col(0).real() = work.col(0).head(ndof).real();
+    for (int alpha = 1; alpha < nmode; alpha++) {
+        stiff.col(alpha) = work.col(alpha).head(ndof) 
+            + ((Real)alpha * ii) * work.col(alpha).segment(ndof, ndof)
+            + (Real)(alpha * alpha) * work.col(alpha).tail(ndof);
+    }
+    // mask Nyquist
+    if (sResponse.mNyquist) {
+        stiff.col(sResponse.mNu).setZero();
+    }
+}
+
 //-------------------------- static --------------------------//
-SolidResponse SolidElement::sResponse;
+std::vector<SolidResponse> SolidElement::sResponses;
 void SolidElement::initWorkspace(int maxMaxNu) {
-    sResponse.mDispl = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
-    sResponse.mStiff = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
-    
-    sResponse.mStrain6 = vec_ar6_CMatPP(maxMaxNu + 1, zero_ar6_CMatPP);
-    sResponse.mStress6 = vec_ar6_CMatPP(maxMaxNu + 1, zero_ar6_CMatPP);
-    
-    sResponse.mStrain9 = vec_ar9_CMatPP(maxMaxNu + 1, zero_ar9_CMatPP);
-    sResponse.mStress9 = vec_ar9_CMatPP(maxMaxNu + 1, zero_ar9_CMatPP);
+    // one workspace per thread
+    sResponses = std::vector<SolidResponse>(XOMP::nThreads());
+    for (auto &sResponse: sResponses) {
+        sResponse.mDispl = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
+        sResponse.mStiff = vec_ar3_CMatPP(maxMaxNu + 1, zero_ar3_CMatPP);
+        
+        sResponse.mStrain6 = vec_ar6_CMatPP(maxMaxNu + 1, zero_ar6_CMatPP);
+        sResponse.mStress6 = vec_ar6_CMatPP(maxMaxNu + 1, zero_ar6_CMatPP);
+        
+        sResponse.mStrain9 = vec_ar9_CMatPP(maxMaxNu + 1, zero_ar9_CMatPP);
+        sResponse.mStress9 = vec_ar9_CMatPP(maxMaxNu + 1, zero_ar9_CMatPP);
+    }
 }
 
+size_t SolidElement::workspaceBytes() {
+    size_t bytes = heapBytes(sResponses);
+    for (const SolidResponse &sResponse: sResponses) {
+        bytes += sResponse.memoryBytes() - sizeof(SolidResponse);
+    }
+    return bytes;
+}
@@ -5,11 +5,13 @@
 #pragma once
 
 #include "Element.h"
+#include "Gradient.h"
 
 class Elastic;
+class SolidPoint;
 class CrdTransTIsoSolid;
 
-// static workspaces
+// static workspaces, one per thread
 struct SolidResponse {
     // disp
     vec_ar3_CMatPP mDispl;
@@ -21,6 +23,11 @@ struct SolidResponse {
     vec_ar9_CMatPP mStress9;
     // stiff
     vec_ar3_CMatPP mStiff;
+    // strain and stress of one mode, for displToStiffFused
+    ar6_CMatPP mStrainMode;
+    ar6_CMatPP mStressMode;
+    // gradient kernels
+    GradientWorkspace mGradWS;
     // size
     int mNu = 0;
     int mNr = 1;
@@ -30,6 +37,12 @@ struct SolidResponse {
         mNu = nr / 2;
         mNyquist = (int)(mNr % 2 == 0);
     };
+    // bytes, for memory reports
+    size_t memoryBytes() const {
+        return sizeof(*this) - sizeof(mGradWS) + mGradWS.memoryBytes() + 
+            heapBytes(mDispl) + heapBytes(mStrain6) + heapBytes(mStrain9) + 
+            heapBytes(mStress6) + heapBytes(mStress9) + heapBytes(mStiff);
+    };
 };
 
 class SolidElement : public Element {
@@ -51,39 +64,87 @@ public:
     void test() const;
     
     // compute Real displacement, used by receiver
-    void computeGroundMotion(Real phi, const RMatPP &weights, RRow3 &u_spz) const; 
-    void computeStrain(Real phi, const RMatPP &weights, RRow6 &strain) const; 
-    void computeCurl(Real phi, const RMatPP &weights, RRow3 &curl) const; 
+    void computeGroundMotion(const CColX &expPhi, const RMatPP &weights, RRow3 &u_spz) const; 
+    void computeStrain(const CColX &expPhi, const RMatPP &weights, RRow6 &strain) const; 
+    void computeCurl(const CColX &expPhi, const RMatPP &weights, RRow3 &curl) const; 
+    void feedDisplFourier(CMatXX &displ) const; 
+    bool feedDisplFourier(const std::vector<int> &ipnts, CMatXX &displ) const; 
+    void feedStrainFourier(CMatXX &strain) const; 
     void forceTIso();
     
+    // stiffness of some points kept for box injection
+    void setStiffTap(const std::vector<int> &ipnts);
+    const CMatXX &getStiffTap() const {return mTapStiff;};
+    
     // side-wise
     void feedDispOnSide(int side, CMatXX_RM &buffer, int row) const; 
+    void feedStrainOnSide(int side, CMatXX_RM &buffer, int row) const; 
     
     // verbose
     std::string verbose() const;
     
+    // add the bytes of this element by subsystem
+    void memoryBytes(std::map<std::string, double> &bytes) const;
+    
+    // stiffness precomputed as dense operators over the modes
+    std::string lumpedStiffnessClass() const;
+    size_t formLumpedStiffness();
+    
     // reset
     void resetZero();
     
+    // save or load time-loop state
+    void syncState(Checkpoint &cp);
+    
 private:
     
     // displ ==> stiff
     void displToStiff() const;
+    // displ ==> stiff one mode at a time, from gradient through stress to 
+    // quadrature, for 1D elements without particle relabelling;
+    // instantiated for each final class of the fused-mode materials, 
+    // whose kernel is then inlined, and for Elastic
+    template <class ElasticType>
+    void displToStiffFused() const;
+    // displ ==> stiff as one product with the precomputed operators
+    void displToStiffLumped() const;
+    
+    // displ ==> strain in RTZ, Fourier coefficients in the workspace
+    SolidResponse &displToStrain() const;
     
     // material
     Elastic *mElastic;
+    // 0 if the rotation is folded into the gradient, unless forced
     CrdTransTIsoSolid *mCrdTransTIso;
     // flags
     bool mInTIso;
     bool mElem3D;
+    bool mFusedModes;
+    // displToStiffFused bound to the class of mElastic
+    void (SolidElement::*mFusedKernel)() const = 0;
+    // the solid points, or the solid parts of solid-fluid points, 
+    // for direct calls in the time loop
+    std::array<SolidPoint *, nPntElem> mSolidPoints;
+    
+    // precomputed stiffness of a non-axial 1D element with a linear material,
+    // f_alpha = (A + i alpha B + alpha^2 C) u_alpha, with A, B and C stacked 
+    // in rows, each 3 * nPntElem square; empty if not formed
+    RMatXX mLumpedK;
+    
+    // points whose stiffness is kept, and the stiffness of the last step
+    std::vector<int> mTapPoints;
+    mutable CMatXX mTapStiff;
     
 //-------------------------- static --------------------------//    
 public:
     // initialize static workspace
     static void initWorkspace(int maxMaxNu);
+    // bytes of the static workspaces
+    static size_t workspaceBytes();
     
 private:
-    static SolidResponse sResponse;
+    // static workspaces, one per thread
+    static std::vector<SolidResponse> sResponses;
 };
 
 
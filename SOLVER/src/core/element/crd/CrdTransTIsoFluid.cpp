@@ -12,7 +12,7 @@ CrdTransTIsoFluid::CrdTransTIsoFluid(const RDMatPP &theta) {
 }
 
 void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar3_CMatPP &u, int Nu) const {
-    static CMatPP ua_0_;
+    static thread_local CMatPP ua_0_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar3_CMatPP &ua = u[alpha];
         ua_0_ = ua[0];
@@ -22,7 +22,7 @@ void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar3_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoFluid::transformRTZ_SPZ(vec_ar3_CMatPP &u, int Nu) const {
-    static CMatPP ua_0_;
+    static thread_local CMatPP ua_0_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar3_CMatPP &ua = u[alpha];
         ua_0_ = ua[0];
@@ -32,7 +32,7 @@ void CrdTransTIsoFluid::transformRTZ_SPZ(vec_ar3_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar6_CMatPP &u, int Nu) const {
-    static CMatPP sum02, dif02, ua_3_;
+    static thread_local CMatPP sum02, dif02, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar6_CMatPP &ua = u[alpha];
         sum02 = ua[0] + ua[2];
@@ -47,7 +47,7 @@ void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar6_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoFluid::transformRTZ_SPZ(vec_ar6_CMatPP &u, int Nu) const {
-    static CMatPP sum02, dif02, ua_3_;
+    static thread_local CMatPP sum02, dif02, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar6_CMatPP &ua = u[alpha];
         sum02 = ua[0] + ua[2];
@@ -62,7 +62,7 @@ void CrdTransTIsoFluid::transformRTZ_SPZ(vec_ar6_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar9_CMatPP &u, int Nu) const {
-    static CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
+    static thread_local CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar9_CMatPP &ua = u[alpha];
         sum08 = ua[0] + ua[8];
@@ -83,7 +83,7 @@ void CrdTransTIsoFluid::transformSPZ_RTZ(vec_ar9_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoFluid::transformRTZ_SPZ(vec_ar9_CMatPP &u, int Nu) const {
-    static CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
+    static thread_local CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar9_CMatPP &ua = u[alpha];
         sum08 = ua[0] + ua[8];
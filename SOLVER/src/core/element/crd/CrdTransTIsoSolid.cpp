@@ -12,7 +12,7 @@ CrdTransTIsoSolid::CrdTransTIsoSolid(const RDMatPP &theta) {
 }
 
 void CrdTransTIsoSolid::transformSPZ_RTZ(vec_ar6_CMatPP &u, int Nu) const {
-    static CMatPP sum02, dif02, ua_3_;
+    static thread_local CMatPP sum02, dif02, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar6_CMatPP &ua = u[alpha];
         sum02 = ua[0] + ua[2];
@@ -27,7 +27,7 @@ void CrdTransTIsoSolid::transformSPZ_RTZ(vec_ar6_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoSolid::transformRTZ_SPZ(vec_ar6_CMatPP &u, int Nu) const {
-    static CMatPP sum02, dif02, ua_3_;
+    static thread_local CMatPP sum02, dif02, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar6_CMatPP &ua = u[alpha];
         sum02 = ua[0] + ua[2];
@@ -42,7 +42,7 @@ void CrdTransTIsoSolid::transformRTZ_SPZ(vec_ar6_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoSolid::transformSPZ_RTZ(vec_ar9_CMatPP &u, int Nu) const {
-    static CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
+    static thread_local CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar9_CMatPP &ua = u[alpha];
         sum08 = ua[0] + ua[8];
@@ -63,7 +63,7 @@ void CrdTransTIsoSolid::transformSPZ_RTZ(vec_ar9_CMatPP &u, int Nu) const {
 }
 
 void CrdTransTIsoSolid::transformRTZ_SPZ(vec_ar9_CMatPP &u, int Nu) const {
-    static CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
+    static thread_local CMatPP sum08, dif08, sum26, dif26, ua_1_, ua_3_;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         ar9_CMatPP &ua = u[alpha];
         sum08 = ua[0] + ua[8];
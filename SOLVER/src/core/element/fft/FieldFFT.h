@@ -5,6 +5,7 @@
 #pragma once
 
 #include "eigenc.h"
+#include <algorithm>
 
 class FieldFFT {
 public:
@@ -13,32 +14,18 @@ public:
     static void transformF2P(const vec_ar6_CMatPP &uc, int Nr);
     static void transformF2P(const vec_ar9_CMatPP &uc, int Nr);
     
-    static void transformP2F(vec_ar3_CMatPP &uc, int Nr);
-    static void transformP2F(vec_ar6_CMatPP &uc, int Nr);
-    static void transformP2F(vec_ar9_CMatPP &uc, int Nr);
+    // with inputC2R, the physical-space input is the output of transformF2P
+    static void transformP2F(vec_ar3_CMatPP &uc, int Nr, bool inputC2R = false);
+    static void transformP2F(vec_ar6_CMatPP &uc, int Nr, bool inputC2R = false);
+    static void transformP2F(vec_ar9_CMatPP &uc, int Nr, bool inputC2R = false);
     
-    template<class vec_arY_CMatPP, class CMatXNY>
-    static void makeFlat(const vec_arY_CMatPP &ucStruct, CMatXNY &ucFlat, int Nu) {
-        for (int alpha = 0; alpha <= Nu; alpha++) {
-            for (int i = 0; i < ucStruct[0].size(); i++) {
-                for (int j = 0; j < nPntEdge; j++) {
-                    ucFlat.block(alpha, nPE * i + nPntEdge * j, 1, nPntEdge) 
-                        = ucStruct[alpha][i].block(j, 0, 1, nPntEdge);
-                }
-            } 
-        } 
-    };
-    
-    template<class vec_arY_CMatPP, class CMatXNY>
-    static void makeStruct(vec_arY_CMatPP &ucStruct, const CMatXNY &ucFlat, int Nu) {
-        for (int alpha = 0; alpha <= Nu; alpha++) {
-            for (int i = 0; i < ucStruct[0].size(); i++) {
-                for (int j = 0; j < nPntEdge; j++) {
-                    ucStruct[alpha][i].block(j, 0, 1, nPntEdge)
-                        = ucFlat.block(alpha, nPE * i + nPntEdge * j, 1, nPntEdge);
-                }
-            } 
-        } 
+    // the Fourier-space FFT buffers are structured as uc, so that modes are 
+    // copied as a whole, or not at all when uc is the buffer itself
+    template<class vec_arY_CMatPP>
+    static void copyModes(const vec_arY_CMatPP &src, vec_arY_CMatPP &dest, int Nu) {
+        if (&src != &dest) {
+            std::copy(src.begin(), src.begin() + Nu + 1, dest.begin());
+        }
     };
 };
 
@@ -5,6 +5,65 @@
 #include "Gradient.h"
 #include "FluidElement.h"
 #include "SolidElement.h"
+#include "SpectralTables.h"
+
+#ifdef _USE_SIMD_KERNELS
+    #include <algorithm>
+    // one clone per instruction set, selected at load time by cpu features
+    #if defined(__GNUC__) && defined(__x86_64__)
+        #define _SIMD_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+    #else
+        #define _SIMD_TARGET_CLONES
+    #endif
+    
+    // A = L * X and B = Y * R for nmode split-complex matrices, Fourier modes 
+    // innermost so that the inner loop vectorizes over several modes at once
+    _SIMD_TARGET_CLONES
+    static void splitProducts(const Real *__restrict L, const Real *__restrict R, 
+        const Real *__restrict xr, const Real *__restrict xi, 
+        const Real *__restrict yr, const Real *__restrict yi, 
+        Real *__restrict ar, Real *__restrict ai, 
+        Real *__restrict br, Real *__restrict bi, int nmode) {
+        std::fill(ar, ar + nPntElem * nmode, (Real)0.);
+        std::fill(ai, ai + nPntElem * nmode, (Real)0.);
+        std::fill(br, br + nPntElem * nmode, (Real)0.);
+        std::fill(bi, bi + nPntElem * nmode, (Real)0.);
+        for (int ipol = 0; ipol < nPntEdge; ipol++) {
+            for (int jpol = 0; jpol < nPntEdge; jpol++) {
+                int ij = (ipol * nPntEdge + jpol) * nmode;
+                for (int k = 0; k < nPntEdge; k++) {
+                    Real l = L[ipol * nPntEdge + k];
+                    Real r = R[k * nPntEdge + jpol];
+                    int kj = (k * nPntEdge + jpol) * nmode;
+                    int ik = (ipol * nPntEdge + k) * nmode;
+                    for (int a = 0; a < nmode; a++) {
+                        ar[ij + a] += l * xr[kj + a];
+                        ai[ij + a] += l * xi[kj + a];
+                        br[ij + a] += yr[ik + a] * r;
+                        bi[ij + a] += yi[ik + a] * r;
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+// geometry factor times a field, a scalar product in affine elements
+template<bool affine>
+struct GeomOp {
+    template<class TMat>
+    static auto mul(const RMatPP &g, Real, const TMat &x) -> decltype(g.schur(x)) {
+        return g.schur(x);
+    };
+};
+
+template<>
+struct GeomOp<true> {
+    template<class TMat>
+    static auto mul(const RMatPP &, Real g, const TMat &x) -> decltype(g * x) {
+        return g * x;
+    };
+};
 
 Gradient::Gradient(const RDMatPP &dsdxii, const RDMatPP &dsdeta, 
                    const RDMatPP &dzdxii, const RDMatPP &dzdeta, 
@@ -12,40 +71,162 @@ Gradient::Gradient(const RDMatPP &dsdxii, const RDMatPP &dsdeta,
 mDsDxii(dsdxii.cast<Real>()), mDsDeta(dsdeta.cast<Real>()), 
 mDzDxii(dzdxii.cast<Real>()), mDzDeta(dzdeta.cast<Real>()), 
 mInv_s(inv_s.cast<Real>()), mAxial(axial) {
+    // the mapping derivatives are constant in affine elements
+    mAffine = true;
+    for (const RDMatPP *d: {&dsdxii, &dsdeta, &dzdxii, &dzdeta}) {
+        double scale = d->cwiseAbs().maxCoeff();
+        double dev = (d->array() - (*d)(0, 0)).abs().maxCoeff();
+        mAffine = mAffine && dev <= 1e-12 * scale;
+    }
+    mAffineDsDxii = mDsDxii(0, 0);
+    mAffineDsDeta = mDsDeta(0, 0);
+    mAffineDzDxii = mDzDxii(0, 0);
+    mAffineDzDeta = mDzDeta(0, 0);
+    
+    #ifdef _USE_SIMD_KERNELS
+        // one interleaved stream of geometry factors for the split kernels
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            mGeomSplit[ipnt * 5 + 0] = mDzDeta.data()[ipnt];
+            mGeomSplit[ipnt * 5 + 1] = mDzDxii.data()[ipnt];
+            mGeomSplit[ipnt * 5 + 2] = mDsDeta.data()[ipnt];
+            mGeomSplit[ipnt * 5 + 3] = mDsDxii.data()[ipnt];
+            mGeomSplit[ipnt * 5 + 4] = mInv_s.data()[ipnt];
+        }
+    #endif
+}
+
+GradientTIso::GradientTIso(const RDMatPP &theta, 
+    const RMatPP &dsdxii, const RMatPP &dsdeta, 
+    const RMatPP &dzdxii, const RMatPP &dzdeta, const RMatPP &inv_s) {
+    mCos1t = (theta.array().cos().matrix()).cast<Real>();
+    mSin1t = (theta.array().sin().matrix()).cast<Real>();
+    mCos1tInv_s = mCos1t.schur(inv_s);
+    mSin1tInv_s = mSin1t.schur(inv_s);
+    // d/ds = dzdeta * GU + dzdxii * UG, d/dz = dsdeta * GU + dsdxii * UG
+    // d/dR = cos(t) d/ds - sin(t) d/dz, d/dZ = sin(t) d/ds + cos(t) d/dz
+    mRGU = mCos1t.schur(dzdeta) - mSin1t.schur(dsdeta);
+    mRUG = mCos1t.schur(dzdxii) - mSin1t.schur(dsdxii);
+    mZGU = mSin1t.schur(dzdeta) + mCos1t.schur(dsdeta);
+    mZUG = mSin1t.schur(dzdxii) + mCos1t.schur(dsdxii);
+    // e_RR = cos(t) du_s/dR - sin(t) du_z/dR
+    // e_ZZ = sin(t) du_s/dZ + cos(t) du_z/dZ
+    // 2 e_RZ = cos(t) du_s/dZ - sin(t) du_z/dZ + sin(t) du_s/dR + cos(t) du_z/dR
+    const RMatPP *RZ[2][2] = {{&mRGU, &mRUG}, {&mZGU, &mZUG}};
+    for (int op = 0; op < 2; op++) {
+        const RMatPP &R = *RZ[0][op];
+        const RMatPP &Z = *RZ[1][op];
+        mK[0 + 0 + op] = mCos1t.schur(R);
+        mK[0 + 2 + op] = -mSin1t.schur(R);
+        mK[4 + 0 + op] = mSin1t.schur(Z);
+        mK[4 + 2 + op] = mCos1t.schur(Z);
+        mK[8 + 0 + op] = mCos1t.schur(Z) + mSin1t.schur(R);
+        mK[8 + 2 + op] = mCos1t.schur(R) - mSin1t.schur(Z);
+    }
+}
+
+void Gradient::setTIso(const RDMatPP &theta) {
+    delete mTIso;
+    mTIso = new GradientTIso(theta, mDsDxii, mDsDeta, mDzDxii, mDzDeta, mInv_s);
+}
+
+void Gradient::computeGrad(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
     if (mAxial) {
-        sG_xii = &sG_GLJ;
-        sGT_xii = &sGT_GLJ;
+        if (mAffine) {
+            computeGradKernel<true, true>(u, u_i, Nu, nyquist, ws);
+        } else {
+            computeGradKernel<true, false>(u, u_i, Nu, nyquist, ws);
+        }
     } else {
-        sG_xii = &sG_GLL;
-        sGT_xii = &sGT_GLL;
+        if (mAffine) {
+            computeGradKernel<false, true>(u, u_i, Nu, nyquist, ws);
+        } else {
+            computeGradKernel<false, false>(u, u_i, Nu, nyquist, ws);
+        }
     }
-    sG_eta = &sG_GLL;
-    sGT_eta = &sGT_GLL;
 }
 
-void Gradient::computeGrad(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist) const {
+template<bool axial, bool affine>
+void Gradient::computeGradKernel(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &GT_xii = axial ? sGT_GLJ : sGT_GLL;
+    
     // hardcode for alpha = 0
-    static RMatPP GUR, UGR;
-    GUR = (*sGT_xii) * u[0].real();  
-    UGR = u[0].real() * (*sG_eta);
-    u_i[0][0].real() = mDzDeta.schur(GUR) + mDzDxii.schur(UGR);
+    RMatPP &GUR = ws.mGR[0];
+    RMatPP &UGR = ws.mRG[0];
+    GUR.noalias() = GT_xii * u[0].real();  
+    UGR.noalias() = u[0].real() * sG_GLL;
+    u_i[0][0].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GUR) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UGR);
     u_i[0][1].real().setZero();
-    u_i[0][2].real() = mDsDeta.schur(GUR) + mDsDxii.schur(UGR);
+    u_i[0][2].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GUR) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UGR);
     
     // alpha > 0
-    static CMatPP v, GU, UG;
-    for (int alpha = 1; alpha <= Nu - nyquist; alpha++) {        
-        Complex iialpha = (Real)alpha * ii;
-        v = iialpha * u[alpha];
-        GU = (*sGT_xii) * u[alpha];  
-        UG = u[alpha] * (*sG_eta);
-        u_i[alpha][0] = mDzDeta.schur(GU) + mDzDxii.schur(UG);
-        u_i[alpha][1] = mInv_s.schur(v); 
-        u_i[alpha][2] = mDsDeta.schur(GU) + mDsDxii.schur(UG);
-        if (mAxial) {
-            u_i[alpha][1].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v);
+    #ifdef _USE_SIMD_KERNELS
+        int nmode = Nu - nyquist;
+        if (nmode > 0) {
+            ws.resizeSplit(nmode);
+            Real *ur = ws.mSplit[0].data();
+            Real *ui = ws.mSplit[1].data();
+            Real *gur = ws.mSplit[2].data();
+            Real *gui = ws.mSplit[3].data();
+            Real *ugr = ws.mSplit[4].data();
+            Real *ugi = ws.mSplit[5].data();
+            // pack
+            for (int alpha = 1; alpha <= nmode; alpha++) {
+                for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                    ur[ipnt * nmode + alpha - 1] = u[alpha].data()[ipnt].real();
+                    ui[ipnt * nmode + alpha - 1] = u[alpha].data()[ipnt].imag();
+                }
+            }
+            // GU = GT * u and UG = u * G for all modes
+            splitProducts(GT_xii.data(), sG_GLL.data(), ur, ui, ur, ui, 
+                gur, gui, ugr, ugi, nmode);
+            // unpack
+            for (int alpha = 1; alpha <= nmode; alpha++) {
+                Real ralpha = (Real)alpha;
+                for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                    int i = ipnt * nmode + alpha - 1;
+                    const Real *geom = &mGeomSplit[ipnt * 5];
+                    Real dzdeta = geom[0];
+                    Real dzdxii = geom[1];
+                    Real dsdeta = geom[2];
+                    Real dsdxii = geom[3];
+                    Real inv_s = geom[4];
+                    u_i[alpha][0].data()[ipnt] = Complex(dzdeta * gur[i] + dzdxii * ugr[i], 
+                                                         dzdeta * gui[i] + dzdxii * ugi[i]);
+                    u_i[alpha][1].data()[ipnt] = Complex(-ralpha * inv_s * ui[i], 
+                                                          ralpha * inv_s * ur[i]);
+                    u_i[alpha][2].data()[ipnt] = Complex(dsdeta * gur[i] + dsdxii * ugr[i], 
+                                                         dsdeta * gui[i] + dsdxii * ugi[i]);
+                }
+                // on the axis, GT_xii.row(0) * v is already in the first row of GU
+                if (axial) {
+                    for (int jpol = 0; jpol < nPntEdge; jpol++) {
+                        int i = jpol * nmode + alpha - 1;
+                        u_i[alpha][1].data()[jpol] += mDzDeta(0, jpol) * 
+                            Complex(-ralpha * gui[i], ralpha * gur[i]);
+                    }
+                }
+            }
         }
-    }    
+    #else
+        CMatPP &v = ws.mV[0];
+        CMatPP &GU = ws.mGU[0];
+        CMatPP &UG = ws.mUG[0];
+        for (int alpha = 1; alpha <= Nu - nyquist; alpha++) {        
+            Complex iialpha = (Real)alpha * ii;
+            v = iialpha * u[alpha];
+            GU.noalias() = GT_xii * u[alpha];  
+            UG.noalias() = u[alpha] * sG_GLL;
+            u_i[alpha][0] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG);
+            u_i[alpha][1] = mInv_s.schur(v); 
+            u_i[alpha][2] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG);
+            if (axial) {
+                u_i[alpha][1].row(0) += mDzDeta.row(0).schur(iialpha * GU.row(0));
+            }
+        }    
+    #endif
     
     // mask Nyquist
     if (nyquist) {
@@ -55,25 +236,109 @@ void Gradient::computeGrad(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int
     }
 }
 
-void Gradient::computeQuad(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist) const {
+void Gradient::computeQuad(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    if (mAxial) {
+        if (mAffine) {
+            computeQuadKernel<true, true>(f, f_i, Nu, nyquist, ws);
+        } else {
+            computeQuadKernel<true, false>(f, f_i, Nu, nyquist, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeQuadKernel<false, true>(f, f_i, Nu, nyquist, ws);
+        } else {
+            computeQuadKernel<false, false>(f, f_i, Nu, nyquist, ws);
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeQuadKernel(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &G_xii = axial ? sG_GLJ : sG_GLL;
+    
     // hardcode for mbeta = 0
-    static RMatPP XR, YR;
-    XR = mDzDeta.schur(f_i[0][0].real()) + mDsDeta.schur(f_i[0][2].real());
-    YR = mDzDxii.schur(f_i[0][0].real()) + mDsDxii.schur(f_i[0][2].real());
-    f[0].real() = (*sG_xii) * XR + YR * (*sGT_eta); 
+    RMatPP &XR = ws.mGR[0];
+    RMatPP &YR = ws.mRG[0];
+    XR = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, f_i[0][0].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, f_i[0][2].real());
+    YR = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, f_i[0][0].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, f_i[0][2].real());
+    f[0].real() = G_xii * XR + YR * sGT_GLL; 
     
     // mbeta > 0
-    static CMatPP g, X, Y;
-    for (int mbeta = 1; mbeta <= Nu - nyquist; mbeta++) {
-        Complex iibeta = - (Real)mbeta * ii; 
-        g = iibeta * f_i[mbeta][1];
-        X = mDzDeta.schur(f_i[mbeta][0]) + mDsDeta.schur(f_i[mbeta][2]);
-        Y = mDzDxii.schur(f_i[mbeta][0]) + mDsDxii.schur(f_i[mbeta][2]);
-        f[mbeta] = (*sG_xii) * X + Y * (*sGT_eta) + mInv_s.schur(g);
-        if (mAxial) {
-            f[mbeta] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g.row(0));
+    #ifdef _USE_SIMD_KERNELS
+        int nmode = Nu - nyquist;
+        if (nmode > 0) {
+            ws.resizeSplit(nmode);
+            Real *xr = ws.mSplit[0].data();
+            Real *xi = ws.mSplit[1].data();
+            Real *yr = ws.mSplit[2].data();
+            Real *yi = ws.mSplit[3].data();
+            Real *ar = ws.mSplit[4].data();
+            Real *ai = ws.mSplit[5].data();
+            Real *br = ws.mSplit[6].data();
+            Real *bi = ws.mSplit[7].data();
+            // pack X and Y
+            for (int mbeta = 1; mbeta <= nmode; mbeta++) {
+                for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                    int i = ipnt * nmode + mbeta - 1;
+                    const Complex &f0 = f_i[mbeta][0].data()[ipnt];
+                    const Complex &f2 = f_i[mbeta][2].data()[ipnt];
+                    const Real *geom = &mGeomSplit[ipnt * 5];
+                    Real dzdeta = geom[0];
+                    Real dzdxii = geom[1];
+                    Real dsdeta = geom[2];
+                    Real dsdxii = geom[3];
+                    xr[i] = dzdeta * f0.real() + dsdeta * f2.real();
+                    xi[i] = dzdeta * f0.imag() + dsdeta * f2.imag();
+                    yr[i] = dzdxii * f0.real() + dsdxii * f2.real();
+                    yi[i] = dzdxii * f0.imag() + dsdxii * f2.imag();
+                }
+            }
+            // on the axis, G_xii.col(0) * r equals G_xii * X with r added to 
+            // the first row of X, so fold it in before the products
+            if (axial) {
+                for (int mbeta = 1; mbeta <= nmode; mbeta++) {
+                    Real rbeta = (Real)mbeta;
+                    for (int jpol = 0; jpol < nPntEdge; jpol++) {
+                        int i = jpol * nmode + mbeta - 1;
+                        const Complex &f1 = f_i[mbeta][1].data()[jpol];
+                        xr[i] += mDzDeta(0, jpol) * rbeta * f1.imag();
+                        xi[i] -= mDzDeta(0, jpol) * rbeta * f1.real();
+                    }
+                }
+            }
+            // G * X and Y * GT for all modes
+            splitProducts(G_xii.data(), sGT_GLL.data(), xr, xi, yr, yi, 
+                ar, ai, br, bi, nmode);
+            // unpack
+            for (int mbeta = 1; mbeta <= nmode; mbeta++) {
+                Real rbeta = (Real)mbeta;
+                for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                    int i = ipnt * nmode + mbeta - 1;
+                    const Complex &f1 = f_i[mbeta][1].data()[ipnt];
+                    Real inv_s = mGeomSplit[ipnt * 5 + 4];
+                    f[mbeta].data()[ipnt] = Complex(ar[i] + br[i] + rbeta * inv_s * f1.imag(), 
+                                                    ai[i] + bi[i] - rbeta * inv_s * f1.real());
+                }
+            }
         }
-    }
+    #else
+        CMatPP &g = ws.mV[0];
+        CMatPP &X = ws.mGU[0];
+        CMatPP &Y = ws.mUG[0];
+        for (int mbeta = 1; mbeta <= Nu - nyquist; mbeta++) {
+            Complex iibeta = - (Real)mbeta * ii; 
+            g = iibeta * f_i[mbeta][1];
+            X = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, f_i[mbeta][0]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, f_i[mbeta][2]);
+            Y = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, f_i[mbeta][0]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, f_i[mbeta][2]);
+            if (axial) {
+                X.row(0) += mDzDeta.row(0).schur(g.row(0));
+            }
+            f[mbeta] = G_xii * X + Y * sGT_GLL + mInv_s.schur(g);
+        }
+    #endif
     
     // mask Nyquist
     if (nyquist) {
@@ -81,58 +346,160 @@ void Gradient::computeQuad(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int
     }
 }    
 
-void Gradient::computeGrad9(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist) const {
+void Gradient::computeStiffFluid(const CMatPP &u, CMatPP &f, const RMatPP &K, int alpha, 
+    GradientWorkspace &ws) const {
+    if (mAxial) {
+        if (mAffine) {
+            computeStiffFluidMode<true, true>(u, f, K, alpha, ws);
+        } else {
+            computeStiffFluidMode<true, false>(u, f, K, alpha, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeStiffFluidMode<false, true>(u, f, K, alpha, ws);
+        } else {
+            computeStiffFluidMode<false, false>(u, f, K, alpha, ws);
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeStiffFluidMode(const CMatPP &u, CMatPP &f, const RMatPP &K, int alpha, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &GT_xii = axial ? sGT_GLJ : sGT_GLL;
+    const RMatPP &G_xii = axial ? sG_GLJ : sG_GLL;
+    
+    // hardcode for alpha = 0, without the phi-component
+    if (alpha == 0) {
+        RMatPP &GUR = ws.mGR[0];
+        RMatPP &UGR = ws.mRG[0];
+        RMatPP &S0R = ws.mGR[1];
+        RMatPP &S2R = ws.mGR[2];
+        GUR.noalias() = GT_xii * u.real();  
+        UGR.noalias() = u.real() * sG_GLL;
+        S0R = K.schur(GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GUR) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UGR));
+        S2R = K.schur(GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GUR) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UGR));
+        // GUR and UGR reused as X and Y of the quadrature
+        GUR = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, S0R) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, S2R);
+        UGR = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, S0R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, S2R);
+        f.real() = G_xii * GUR + UGR * sGT_GLL; 
+        return;
+    }
+    
+    // alpha > 0
+    CMatPP &S0 = ws.mV[0];
+    CMatPP &S1 = ws.mV[1];
+    CMatPP &S2 = ws.mV[2];
+    CMatPP &GU = ws.mGU[0];
+    CMatPP &UG = ws.mUG[0];
+    Complex iialpha = (Real)alpha * ii;
+    GU.noalias() = GT_xii * u;  
+    UG.noalias() = u * sG_GLL;
+    S1 = mInv_s.schur(iialpha * u);
+    if (axial) {
+        S1.row(0) += mDzDeta.row(0).schur(iialpha * GU.row(0));
+    }
+    S0 = K.schur(GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG));
+    S2 = K.schur(GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG));
+    // g of computeQuad, with mbeta = -alpha
+    S1 = (-iialpha) * K.schur(S1);
+    // GU and UG reused as X and Y of the quadrature
+    GU = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, S0) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, S2);
+    UG = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, S0) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, S2);
+    if (axial) {
+        GU.row(0) += mDzDeta.row(0).schur(S1.row(0));
+    }
+    f = G_xii * GU + UG * sGT_GLL + mInv_s.schur(S1);
+}
+
+void Gradient::computeGrad9(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    if (mAxial) {
+        if (mAffine) {
+            computeGrad9Kernel<true, true>(ui, ui_j, Nu, nyquist, ws);
+        } else {
+            computeGrad9Kernel<true, false>(ui, ui_j, Nu, nyquist, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeGrad9Kernel<false, true>(ui, ui_j, Nu, nyquist, ws);
+        } else {
+            computeGrad9Kernel<false, false>(ui, ui_j, Nu, nyquist, ws);
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeGrad9Kernel(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &GT_xii = axial ? sGT_GLJ : sGT_GLL;
+    
     // hardcode for alpha = 0
-    static RMatPP GU0R, GU1R, GU2R, UG0R, UG1R, UG2R;
-    GU0R = (*sGT_xii) * ui[0][0].real();  
-    GU1R = (*sGT_xii) * ui[0][1].real();  
-    GU2R = (*sGT_xii) * ui[0][2].real();  
-    UG0R = ui[0][0].real() * (*sG_eta);
-    UG1R = ui[0][1].real() * (*sG_eta);
-    UG2R = ui[0][2].real() * (*sG_eta);
-    ui_j[0][0].real() = mDzDeta.schur(GU0R) + mDzDxii.schur(UG0R);
+    RMatPP &GU0R = ws.mGR[0];
+    RMatPP &GU1R = ws.mGR[1];
+    RMatPP &GU2R = ws.mGR[2];
+    RMatPP &UG0R = ws.mRG[0];
+    RMatPP &UG1R = ws.mRG[1];
+    RMatPP &UG2R = ws.mRG[2];
+    GU0R.noalias() = GT_xii * ui[0][0].real();  
+    GU1R.noalias() = GT_xii * ui[0][1].real();  
+    GU2R.noalias() = GT_xii * ui[0][2].real();  
+    UG0R.noalias() = ui[0][0].real() * sG_GLL;
+    UG1R.noalias() = ui[0][1].real() * sG_GLL;
+    UG2R.noalias() = ui[0][2].real() * sG_GLL;
+    ui_j[0][0].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU0R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG0R);
     ui_j[0][1].real() = -mInv_s.schur(ui[0][1].real());
-    ui_j[0][2].real() = mDsDeta.schur(GU0R) + mDsDxii.schur(UG0R);
-    ui_j[0][3].real() = mDzDeta.schur(GU1R) + mDzDxii.schur(UG1R);
+    ui_j[0][2].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU0R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG0R);
+    ui_j[0][3].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU1R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG1R);
     ui_j[0][4].real() = mInv_s.schur(ui[0][0].real()); 
-    ui_j[0][5].real() = mDsDeta.schur(GU1R) + mDsDxii.schur(UG1R);
-    ui_j[0][6].real() = mDzDeta.schur(GU2R) + mDzDxii.schur(UG2R);
+    ui_j[0][5].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU1R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG1R);
+    ui_j[0][6].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU2R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG2R);
     ui_j[0][7].real().setZero();
-    ui_j[0][8].real() = mDsDeta.schur(GU2R) + mDsDxii.schur(UG2R);
-    if (mAxial) {
-        ui_j[0][4].row(0).real() += mDzDeta.row(0).schur((*sGT_xii).row(0) * ui[0][0].real());
-        ui_j[0][1].row(0).real() -= mDzDeta.row(0).schur((*sGT_xii).row(0) * ui[0][1].real());
+    ui_j[0][8].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU2R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG2R);
+    if (axial) {
+        ui_j[0][4].row(0).real() += mDzDeta.row(0).schur(GU0R.row(0));
+        ui_j[0][1].row(0).real() -= mDzDeta.row(0).schur(GU1R.row(0));
     }
     
     // alpha > 0
-    static CMatPP v0, v1, v2, GU0, GU1, GU2, UG0, UG1, UG2;
+    CMatPP &v0 = ws.mV[0];
+    CMatPP &v1 = ws.mV[1];
+    CMatPP &v2 = ws.mV[2];
+    CMatPP &GU0 = ws.mGU[0];
+    CMatPP &GU1 = ws.mGU[1];
+    CMatPP &GU2 = ws.mGU[2];
+    CMatPP &UG0 = ws.mUG[0];
+    CMatPP &UG1 = ws.mUG[1];
+    CMatPP &UG2 = ws.mUG[2];
     for (int alpha = 1; alpha <= Nu - nyquist; alpha++) {        
         Complex iialpha = (Real)alpha * ii;
         v0 = ui[alpha][0] + iialpha * ui[alpha][1];
         v1 = iialpha * ui[alpha][0] - ui[alpha][1];
         v2 = iialpha * ui[alpha][2];
-        GU0 = (*sGT_xii) * ui[alpha][0];  
-        GU1 = (*sGT_xii) * ui[alpha][1];  
-        GU2 = (*sGT_xii) * ui[alpha][2];  
-        UG0 = ui[alpha][0] * (*sG_eta);
-        UG1 = ui[alpha][1] * (*sG_eta);
-        UG2 = ui[alpha][2] * (*sG_eta);
-        ui_j[alpha][0] = mDzDeta.schur(GU0) + mDzDxii.schur(UG0);
+        GU0.noalias() = GT_xii * ui[alpha][0];  
+        GU1.noalias() = GT_xii * ui[alpha][1];  
+        GU2.noalias() = GT_xii * ui[alpha][2];  
+        UG0.noalias() = ui[alpha][0] * sG_GLL;
+        UG1.noalias() = ui[alpha][1] * sG_GLL;
+        UG2.noalias() = ui[alpha][2] * sG_GLL;
+        ui_j[alpha][0] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU0) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG0);
         ui_j[alpha][1] = mInv_s.schur(v1);
-        ui_j[alpha][2] = mDsDeta.schur(GU0) + mDsDxii.schur(UG0);
-        ui_j[alpha][3] = mDzDeta.schur(GU1) + mDzDxii.schur(UG1);
+        ui_j[alpha][2] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU0) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG0);
+        ui_j[alpha][3] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU1) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG1);
         ui_j[alpha][4] = mInv_s.schur(v0); 
-        ui_j[alpha][5] = mDsDeta.schur(GU1) + mDsDxii.schur(UG1);
-        ui_j[alpha][6] = mDzDeta.schur(GU2) + mDzDxii.schur(UG2);
+        ui_j[alpha][5] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU1) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG1);
+        ui_j[alpha][6] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU2) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG2);
         ui_j[alpha][7] = mInv_s.schur(v2);
-        ui_j[alpha][8] = mDsDeta.schur(GU2) + mDsDxii.schur(UG2);
-        if (mAxial) {
-            ui_j[alpha][4].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v0);
-            ui_j[alpha][1].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v1);
-            ui_j[alpha][7].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v2);
+        ui_j[alpha][8] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU2) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG2);
+        if (axial) {
+            ui_j[alpha][4].row(0) += mDzDeta.row(0).schur(GU0.row(0) + iialpha * GU1.row(0));
+            ui_j[alpha][1].row(0) += mDzDeta.row(0).schur(iialpha * GU0.row(0) - GU1.row(0));
+            ui_j[alpha][7].row(0) += mDzDeta.row(0).schur(iialpha * GU2.row(0));
             if (alpha == 1) {
-                ui_j[alpha][4].row(0) += mDzDxii.row(0).schur(v0.row(0) * (*sG_eta));
-                ui_j[alpha][1].row(0) += mDzDxii.row(0).schur(v1.row(0) * (*sG_eta));
+                ui_j[alpha][4].row(0) += mDzDxii.row(0).schur(UG0.row(0) + iialpha * UG1.row(0));
+                ui_j[alpha][1].row(0) += mDzDxii.row(0).schur(iialpha * UG0.row(0) - UG1.row(0));
             }
         }
     } 
@@ -151,48 +518,83 @@ void Gradient::computeGrad9(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int
     }
 }
 
-void Gradient::computeQuad9(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist) const {
-    // hardcode for mbeta = 0
-    static RMatPP X0R, X1R, X2R, Y0R, Y1R, Y2R; 
-    X0R = mDzDeta.schur(fi_j[0][0].real()) + mDsDeta.schur(fi_j[0][2].real());
-    X1R = mDzDeta.schur(fi_j[0][3].real()) + mDsDeta.schur(fi_j[0][5].real());
-    X2R = mDzDeta.schur(fi_j[0][6].real()) + mDsDeta.schur(fi_j[0][8].real());
-    Y0R = mDzDxii.schur(fi_j[0][0].real()) + mDsDxii.schur(fi_j[0][2].real());
-    Y1R = mDzDxii.schur(fi_j[0][3].real()) + mDsDxii.schur(fi_j[0][5].real());
-    Y2R = mDzDxii.schur(fi_j[0][6].real()) + mDsDxii.schur(fi_j[0][8].real());
-    fi[0][0].real() = (*sG_xii) * X0R + Y0R * (*sGT_eta) + mInv_s.schur(fi_j[0][4].real());
-    fi[0][1].real() = (*sG_xii) * X1R + Y1R * (*sGT_eta) - mInv_s.schur(fi_j[0][1].real());
-    fi[0][2].real() = (*sG_xii) * X2R + Y2R * (*sGT_eta);
+void Gradient::computeQuad9(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
     if (mAxial) {
-        fi[0][0].real() += (*sG_xii).col(0) * mDzDeta.row(0).schur(fi_j[0][4].real().row(0));
-        fi[0][1].real() -= (*sG_xii).col(0) * mDzDeta.row(0).schur(fi_j[0][1].real().row(0));
+        if (mAffine) {
+            computeQuad9Kernel<true, true>(fi, fi_j, Nu, nyquist, ws);
+        } else {
+            computeQuad9Kernel<true, false>(fi, fi_j, Nu, nyquist, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeQuad9Kernel<false, true>(fi, fi_j, Nu, nyquist, ws);
+        } else {
+            computeQuad9Kernel<false, false>(fi, fi_j, Nu, nyquist, ws);
+        }
     }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeQuad9Kernel(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &G_xii = axial ? sG_GLJ : sG_GLL;
+    
+    // hardcode for mbeta = 0
+    RMatPP &X0R = ws.mGR[0];
+    RMatPP &X1R = ws.mGR[1];
+    RMatPP &X2R = ws.mGR[2];
+    RMatPP &Y0R = ws.mRG[0];
+    RMatPP &Y1R = ws.mRG[1];
+    RMatPP &Y2R = ws.mRG[2];
+    X0R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[0][0].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[0][2].real());
+    X1R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[0][3].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[0][5].real());
+    X2R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[0][6].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[0][8].real());
+    Y0R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[0][0].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[0][2].real());
+    Y1R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[0][3].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[0][5].real());
+    Y2R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[0][6].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[0][8].real());
+    if (axial) {
+        X0R.row(0) += mDzDeta.row(0).schur(fi_j[0][4].real().row(0));
+        X1R.row(0) -= mDzDeta.row(0).schur(fi_j[0][1].real().row(0));
+    }
+    fi[0][0].real() = G_xii * X0R + Y0R * sGT_GLL + mInv_s.schur(fi_j[0][4].real());
+    fi[0][1].real() = G_xii * X1R + Y1R * sGT_GLL - mInv_s.schur(fi_j[0][1].real());
+    fi[0][2].real() = G_xii * X2R + Y2R * sGT_GLL;
     
     // mbeta > 0
-    static CMatPP g0, g1, g2, X0, X1, X2, Y0, Y1, Y2;
+    CMatPP &g0 = ws.mV[0];
+    CMatPP &g1 = ws.mV[1];
+    CMatPP &g2 = ws.mV[2];
+    CMatPP &X0 = ws.mGU[0];
+    CMatPP &X1 = ws.mGU[1];
+    CMatPP &X2 = ws.mGU[2];
+    CMatPP &Y0 = ws.mUG[0];
+    CMatPP &Y1 = ws.mUG[1];
+    CMatPP &Y2 = ws.mUG[2];
     for (int mbeta = 1; mbeta <= Nu - nyquist; mbeta++) {
         Complex iibeta = - (Real)mbeta * ii; 
         g0 = fi_j[mbeta][4] + iibeta * fi_j[mbeta][1];
         g1 = iibeta * fi_j[mbeta][4] - fi_j[mbeta][1];
         g2 = iibeta * fi_j[mbeta][7];    
-        X0 = mDzDeta.schur(fi_j[mbeta][0]) + mDsDeta.schur(fi_j[mbeta][2]);
-        X1 = mDzDeta.schur(fi_j[mbeta][3]) + mDsDeta.schur(fi_j[mbeta][5]);
-        X2 = mDzDeta.schur(fi_j[mbeta][6]) + mDsDeta.schur(fi_j[mbeta][8]);
-        Y0 = mDzDxii.schur(fi_j[mbeta][0]) + mDsDxii.schur(fi_j[mbeta][2]);
-        Y1 = mDzDxii.schur(fi_j[mbeta][3]) + mDsDxii.schur(fi_j[mbeta][5]);
-        Y2 = mDzDxii.schur(fi_j[mbeta][6]) + mDsDxii.schur(fi_j[mbeta][8]);
-        fi[mbeta][0] = (*sG_xii) * X0 + Y0 * (*sGT_eta) + mInv_s.schur(g0);
-        fi[mbeta][1] = (*sG_xii) * X1 + Y1 * (*sGT_eta) + mInv_s.schur(g1);
-        fi[mbeta][2] = (*sG_xii) * X2 + Y2 * (*sGT_eta) + mInv_s.schur(g2);
-        if (mAxial) {
-            fi[mbeta][0] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g0.row(0));
-            fi[mbeta][1] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g1.row(0));
-            fi[mbeta][2] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g2.row(0));
+        X0 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[mbeta][0]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[mbeta][2]);
+        X1 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[mbeta][3]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[mbeta][5]);
+        X2 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, fi_j[mbeta][6]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, fi_j[mbeta][8]);
+        Y0 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[mbeta][0]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[mbeta][2]);
+        Y1 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[mbeta][3]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[mbeta][5]);
+        Y2 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, fi_j[mbeta][6]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, fi_j[mbeta][8]);
+        if (axial) {
+            X0.row(0) += mDzDeta.row(0).schur(g0.row(0));
+            X1.row(0) += mDzDeta.row(0).schur(g1.row(0));
+            X2.row(0) += mDzDeta.row(0).schur(g2.row(0));
             if (mbeta == 1) {
-                fi[mbeta][0].row(0) += mDzDxii.row(0).schur(g0.row(0)) * (*sGT_eta);
-                fi[mbeta][1].row(0) += mDzDxii.row(0).schur(g1.row(0)) * (*sGT_eta);
+                Y0.row(0) += mDzDxii.row(0).schur(g0.row(0));
+                Y1.row(0) += mDzDxii.row(0).schur(g1.row(0));
             }
         }
+        fi[mbeta][0] = G_xii * X0 + Y0 * sGT_GLL + mInv_s.schur(g0);
+        fi[mbeta][1] = G_xii * X1 + Y1 * sGT_GLL + mInv_s.schur(g1);
+        fi[mbeta][2] = G_xii * X2 + Y2 * sGT_GLL + mInv_s.schur(g2);
     }
     
     // mask Nyquist
@@ -203,55 +605,347 @@ void Gradient::computeQuad9(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int
     }
 }
 
-void Gradient::computeGrad6(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist) const {
+void Gradient::computeGrad6(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    if (mTIso) {
+        if (mAxial) {
+            computeGrad6TIsoKernel<true>(ui, eij, Nu, nyquist, ws);
+        } else {
+            computeGrad6TIsoKernel<false>(ui, eij, Nu, nyquist, ws);
+        }
+    } else if (mAxial) {
+        if (mAffine) {
+            computeGrad6Kernel<true, true>(ui, eij, Nu, nyquist, ws);
+        } else {
+            computeGrad6Kernel<true, false>(ui, eij, Nu, nyquist, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeGrad6Kernel<false, true>(ui, eij, Nu, nyquist, ws);
+        } else {
+            computeGrad6Kernel<false, false>(ui, eij, Nu, nyquist, ws);
+        }
+    }
+}
+
+void Gradient::computeGrad6(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+    GradientWorkspace &ws) const {
+    if (mTIso) {
+        if (mAxial) {
+            computeGrad6TIsoMode<true>(ui, eij, alpha, ws);
+        } else {
+            computeGrad6TIsoMode<false>(ui, eij, alpha, ws);
+        }
+    } else if (mAxial) {
+        if (mAffine) {
+            computeGrad6Mode<true, true>(ui, eij, alpha, ws);
+        } else {
+            computeGrad6Mode<true, false>(ui, eij, alpha, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeGrad6Mode<false, true>(ui, eij, alpha, ws);
+        } else {
+            computeGrad6Mode<false, false>(ui, eij, alpha, ws);
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeGrad6Mode(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &GT_xii = axial ? sGT_GLJ : sGT_GLL;
+    
     // hardcode for alpha = 0
-    static RMatPP GU0R, GU1R, GU2R, UG0R, UG1R, UG2R;
-    GU0R = (*sGT_xii) * ui[0][0].real();  
-    GU1R = (*sGT_xii) * ui[0][1].real();  
-    GU2R = (*sGT_xii) * ui[0][2].real();  
-    UG0R = ui[0][0].real() * (*sG_eta);
-    UG1R = ui[0][1].real() * (*sG_eta);
-    UG2R = ui[0][2].real() * (*sG_eta);
-    eij[0][0].real() = mDzDeta.schur(GU0R) + mDzDxii.schur(UG0R);
-    eij[0][1].real() = mInv_s.schur(ui[0][0].real()); 
-    eij[0][2].real() = mDsDeta.schur(GU2R) + mDsDxii.schur(UG2R);
-    eij[0][3].real() = mDsDeta.schur(GU1R) + mDsDxii.schur(UG1R);
-    eij[0][4].real() = mDsDeta.schur(GU0R) + mDsDxii.schur(UG0R) + mDzDeta.schur(GU2R) + mDzDxii.schur(UG2R);
-    eij[0][5].real() = mDzDeta.schur(GU1R) + mDzDxii.schur(UG1R) - mInv_s.schur(ui[0][1].real());
-    if (mAxial) {
-        eij[0][1].row(0).real() += mDzDeta.row(0).schur((*sGT_xii).row(0) * ui[0][0].real());
-        eij[0][5].row(0).real() -= mDzDeta.row(0).schur((*sGT_xii).row(0) * ui[0][1].real());
+    if (alpha == 0) {
+        RMatPP &GU0R = ws.mGR[0];
+        RMatPP &GU1R = ws.mGR[1];
+        RMatPP &GU2R = ws.mGR[2];
+        RMatPP &UG0R = ws.mRG[0];
+        RMatPP &UG1R = ws.mRG[1];
+        RMatPP &UG2R = ws.mRG[2];
+        GU0R.noalias() = GT_xii * ui[0].real();  
+        GU1R.noalias() = GT_xii * ui[1].real();  
+        GU2R.noalias() = GT_xii * ui[2].real();  
+        UG0R.noalias() = ui[0].real() * sG_GLL;
+        UG1R.noalias() = ui[1].real() * sG_GLL;
+        UG2R.noalias() = ui[2].real() * sG_GLL;
+        eij[0].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU0R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG0R);
+        eij[1].real() = mInv_s.schur(ui[0].real()); 
+        eij[2].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU2R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG2R);
+        eij[3].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU1R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG1R);
+        eij[4].real() = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU0R) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG0R) + GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU2R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG2R);
+        eij[5].real() = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU1R) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG1R) - mInv_s.schur(ui[1].real());
+        if (axial) {
+            eij[1].row(0).real() += mDzDeta.row(0).schur(GU0R.row(0));
+            eij[5].row(0).real() -= mDzDeta.row(0).schur(GU1R.row(0));
+        }
+        return;
     }
     
     // alpha > 0
-    static CMatPP v0, v1, v2, GU0, GU1, GU2, UG0, UG1, UG2;
-    for (int alpha = 1; alpha <= Nu - nyquist; alpha++) {        
-        Complex iialpha = (Real)alpha * ii;
-        v0 = ui[alpha][0] + iialpha * ui[alpha][1];
-        v1 = iialpha * ui[alpha][0] - ui[alpha][1];
-        v2 = iialpha * ui[alpha][2];
-        GU0 = (*sGT_xii) * ui[alpha][0];  
-        GU1 = (*sGT_xii) * ui[alpha][1];  
-        GU2 = (*sGT_xii) * ui[alpha][2];  
-        UG0 = ui[alpha][0] * (*sG_eta);
-        UG1 = ui[alpha][1] * (*sG_eta);
-        UG2 = ui[alpha][2] * (*sG_eta);
-        eij[alpha][0] = mDzDeta.schur(GU0) + mDzDxii.schur(UG0);
-        eij[alpha][1] = mInv_s.schur(v0); 
-        eij[alpha][2] = mDsDeta.schur(GU2) + mDsDxii.schur(UG2);
-        eij[alpha][3] = mDsDeta.schur(GU1) + mDsDxii.schur(UG1) + mInv_s.schur(v2);
-        eij[alpha][4] = mDsDeta.schur(GU0) + mDsDxii.schur(UG0) + mDzDeta.schur(GU2) + mDzDxii.schur(UG2);
-        eij[alpha][5] = mDzDeta.schur(GU1) + mDzDxii.schur(UG1) + mInv_s.schur(v1);
+    CMatPP &v0 = ws.mV[0];
+    CMatPP &v1 = ws.mV[1];
+    CMatPP &v2 = ws.mV[2];
+    CMatPP &GU0 = ws.mGU[0];
+    CMatPP &GU1 = ws.mGU[1];
+    CMatPP &GU2 = ws.mGU[2];
+    CMatPP &UG0 = ws.mUG[0];
+    CMatPP &UG1 = ws.mUG[1];
+    CMatPP &UG2 = ws.mUG[2];
+    Complex iialpha = (Real)alpha * ii;
+    v0 = ui[0] + iialpha * ui[1];
+    v1 = iialpha * ui[0] - ui[1];
+    v2 = iialpha * ui[2];
+    GU0.noalias() = GT_xii * ui[0];  
+    GU1.noalias() = GT_xii * ui[1];  
+    GU2.noalias() = GT_xii * ui[2];  
+    UG0.noalias() = ui[0] * sG_GLL;
+    UG1.noalias() = ui[1] * sG_GLL;
+    UG2.noalias() = ui[2] * sG_GLL;
+    eij[0] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU0) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG0);
+    eij[1] = mInv_s.schur(v0); 
+    eij[2] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU2) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG2);
+    eij[3] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU1) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG1) + mInv_s.schur(v2);
+    eij[4] = GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, GU0) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, UG0) + GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU2) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG2);
+    eij[5] = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, GU1) + GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, UG1) + mInv_s.schur(v1);
+    if (axial) {
+        eij[1].row(0) += mDzDeta.row(0).schur(GU0.row(0) + iialpha * GU1.row(0));
+        eij[5].row(0) += mDzDeta.row(0).schur(iialpha * GU0.row(0) - GU1.row(0));
+        eij[3].row(0) += mDzDeta.row(0).schur(iialpha * GU2.row(0));
+        if (alpha == 1) {
+            eij[1].row(0) += mDzDxii.row(0).schur(UG0.row(0) + iialpha * UG1.row(0));
+            eij[5].row(0) += mDzDxii.row(0).schur(iialpha * UG0.row(0) - UG1.row(0));
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeGrad6Kernel(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    for (int alpha = 0; alpha <= Nu - nyquist; alpha++) {
+        computeGrad6Mode<axial, affine>(ui[alpha], eij[alpha], alpha, ws);
+    }
+    
+    // mask Nyquist
+    if (nyquist) {
+        eij[Nu][0].setZero();
+        eij[Nu][1].setZero();
+        eij[Nu][2].setZero();
+        eij[Nu][3].setZero();
+        eij[Nu][4].setZero();
+        eij[Nu][5].setZero();
+    }   
+}
+
+void Gradient::computeQuad6(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    if (mTIso) {
         if (mAxial) {
-            eij[alpha][1].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v0);
-            eij[alpha][5].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v1);
-            eij[alpha][3].row(0) += mDzDeta.row(0).schur((*sGT_xii).row(0) * v2);
-            if (alpha == 1) {
-                eij[alpha][1].row(0) += mDzDxii.row(0).schur(v0.row(0) * (*sG_eta));
-                eij[alpha][5].row(0) += mDzDxii.row(0).schur(v1.row(0) * (*sG_eta));
-            }
+            computeQuad6TIsoKernel<true>(fi, sij, Nu, nyquist, ws);
+        } else {
+            computeQuad6TIsoKernel<false>(fi, sij, Nu, nyquist, ws);
+        }
+    } else if (mAxial) {
+        if (mAffine) {
+            computeQuad6Kernel<true, true>(fi, sij, Nu, nyquist, ws);
+        } else {
+            computeQuad6Kernel<true, false>(fi, sij, Nu, nyquist, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeQuad6Kernel<false, true>(fi, sij, Nu, nyquist, ws);
+        } else {
+            computeQuad6Kernel<false, false>(fi, sij, Nu, nyquist, ws);
+        }
+    }
+}
+
+void Gradient::computeQuad6(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+    GradientWorkspace &ws) const {
+    if (mTIso) {
+        if (mAxial) {
+            computeQuad6TIsoMode<true>(fi, sij, mbeta, ws);
+        } else {
+            computeQuad6TIsoMode<false>(fi, sij, mbeta, ws);
         }
-    }    
+    } else if (mAxial) {
+        if (mAffine) {
+            computeQuad6Mode<true, true>(fi, sij, mbeta, ws);
+        } else {
+            computeQuad6Mode<true, false>(fi, sij, mbeta, ws);
+        }
+    } else {
+        if (mAffine) {
+            computeQuad6Mode<false, true>(fi, sij, mbeta, ws);
+        } else {
+            computeQuad6Mode<false, false>(fi, sij, mbeta, ws);
+        }
+    }
+}
+
+template<bool axial, bool affine>
+void Gradient::computeQuad6Mode(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &G_xii = axial ? sG_GLJ : sG_GLL;
+    
+    // hardcode for mbeta = 0
+    if (mbeta == 0) {
+        RMatPP &X0R = ws.mGR[0];
+        RMatPP &X1R = ws.mGR[1];
+        RMatPP &X2R = ws.mGR[2];
+        RMatPP &Y0R = ws.mRG[0];
+        RMatPP &Y1R = ws.mRG[1];
+        RMatPP &Y2R = ws.mRG[2];
+        X0R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[0].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[4].real());
+        X1R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[5].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[3].real());
+        X2R = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[4].real()) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[2].real());
+        Y0R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[0].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[4].real());
+        Y1R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[5].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[3].real());
+        Y2R = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[4].real()) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[2].real());
+        if (axial) {
+            X0R.row(0) += mDzDeta.row(0).schur(sij[1].real().row(0));
+            X1R.row(0) -= mDzDeta.row(0).schur(sij[5].real().row(0));
+        }
+        fi[0].real() = G_xii * X0R + Y0R * sGT_GLL + mInv_s.schur(sij[1].real());
+        fi[1].real() = G_xii * X1R + Y1R * sGT_GLL - mInv_s.schur(sij[5].real());
+        fi[2].real() = G_xii * X2R + Y2R * sGT_GLL;
+        return;
+    }
+    
+    // mbeta > 0
+    CMatPP &g0 = ws.mV[0];
+    CMatPP &g1 = ws.mV[1];
+    CMatPP &g2 = ws.mV[2];
+    CMatPP &X0 = ws.mGU[0];
+    CMatPP &X1 = ws.mGU[1];
+    CMatPP &X2 = ws.mGU[2];
+    CMatPP &Y0 = ws.mUG[0];
+    CMatPP &Y1 = ws.mUG[1];
+    CMatPP &Y2 = ws.mUG[2];
+    Complex iibeta = - (Real)mbeta * ii; 
+    g0 = sij[1] + iibeta * sij[5];
+    g1 = iibeta * sij[1] - sij[5];
+    g2 = iibeta * sij[3];    
+    X0 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[0]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[4]);
+    X1 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[5]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[3]);
+    X2 = GeomOp<affine>::mul(mDzDeta, mAffineDzDeta, sij[4]) + GeomOp<affine>::mul(mDsDeta, mAffineDsDeta, sij[2]);
+    Y0 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[0]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[4]);
+    Y1 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[5]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[3]);
+    Y2 = GeomOp<affine>::mul(mDzDxii, mAffineDzDxii, sij[4]) + GeomOp<affine>::mul(mDsDxii, mAffineDsDxii, sij[2]);
+    if (axial) {
+        X0.row(0) += mDzDeta.row(0).schur(g0.row(0));
+        X1.row(0) += mDzDeta.row(0).schur(g1.row(0));
+        X2.row(0) += mDzDeta.row(0).schur(g2.row(0));
+        if (mbeta == 1) {
+            Y0.row(0) += mDzDxii.row(0).schur(g0.row(0));
+            Y1.row(0) += mDzDxii.row(0).schur(g1.row(0));
+        }
+    }
+    fi[0] = G_xii * X0 + Y0 * sGT_GLL + mInv_s.schur(g0);
+    fi[1] = G_xii * X1 + Y1 * sGT_GLL + mInv_s.schur(g1);
+    fi[2] = G_xii * X2 + Y2 * sGT_GLL + mInv_s.schur(g2);
+}
+
+template<bool axial, bool affine>
+void Gradient::computeQuad6Kernel(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    for (int mbeta = 0; mbeta <= Nu - nyquist; mbeta++) {
+        computeQuad6Mode<axial, affine>(fi[mbeta], sij[mbeta], mbeta, ws);
+    }
+    
+    // mask Nyquist
+    if (nyquist) {
+        fi[Nu][0].setZero();
+        fi[Nu][1].setZero();
+        fi[Nu][2].setZero();
+    }
+}
+
+template<bool axial>
+void Gradient::computeGrad6TIsoMode(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &GT_xii = axial ? sGT_GLJ : sGT_GLL;
+    const std::array<RMatPP, 12> &K = mTIso->mK;
+    const GradientTIso &T = *mTIso;
+    
+    // hardcode for alpha = 0
+    if (alpha == 0) {
+        RMatPP &GU0R = ws.mGR[0];
+        RMatPP &GU1R = ws.mGR[1];
+        RMatPP &GU2R = ws.mGR[2];
+        RMatPP &UG0R = ws.mRG[0];
+        RMatPP &UG1R = ws.mRG[1];
+        RMatPP &UG2R = ws.mRG[2];
+        GU0R.noalias() = GT_xii * ui[0].real();  
+        GU1R.noalias() = GT_xii * ui[1].real();  
+        GU2R.noalias() = GT_xii * ui[2].real();  
+        UG0R.noalias() = ui[0].real() * sG_GLL;
+        UG1R.noalias() = ui[1].real() * sG_GLL;
+        UG2R.noalias() = ui[2].real() * sG_GLL;
+        eij[0].real() = K[0].schur(GU0R) + K[1].schur(UG0R) + K[2].schur(GU2R) + K[3].schur(UG2R);
+        eij[1].real() = mInv_s.schur(ui[0].real()); 
+        eij[2].real() = K[4].schur(GU0R) + K[5].schur(UG0R) + K[6].schur(GU2R) + K[7].schur(UG2R);
+        eij[3].real() = T.mZGU.schur(GU1R) + T.mZUG.schur(UG1R) - T.mSin1tInv_s.schur(ui[1].real());
+        eij[4].real() = K[8].schur(GU0R) + K[9].schur(UG0R) + K[10].schur(GU2R) + K[11].schur(UG2R);
+        eij[5].real() = T.mRGU.schur(GU1R) + T.mRUG.schur(UG1R) - T.mCos1tInv_s.schur(ui[1].real());
+        if (axial) {
+            eij[1].row(0).real() += mDzDeta.row(0).schur(GU0R.row(0));
+            eij[3].row(0).real() -= T.mSin1t.row(0).schur(mDzDeta.row(0).schur(GU1R.row(0)));
+            eij[5].row(0).real() -= T.mCos1t.row(0).schur(mDzDeta.row(0).schur(GU1R.row(0)));
+        }
+        return;
+    }
+    
+    // alpha > 0
+    CMatPP &v0 = ws.mV[0];
+    CMatPP &v1 = ws.mV[1];
+    CMatPP &v2 = ws.mV[2];
+    CMatPP &GU0 = ws.mGU[0];
+    CMatPP &GU1 = ws.mGU[1];
+    CMatPP &GU2 = ws.mGU[2];
+    CMatPP &UG0 = ws.mUG[0];
+    CMatPP &UG1 = ws.mUG[1];
+    CMatPP &UG2 = ws.mUG[2];
+    Complex iialpha = (Real)alpha * ii;
+    v0 = ui[0] + iialpha * ui[1];
+    v1 = iialpha * ui[0] - ui[1];
+    v2 = iialpha * ui[2];
+    GU0.noalias() = GT_xii * ui[0];  
+    GU1.noalias() = GT_xii * ui[1];  
+    GU2.noalias() = GT_xii * ui[2];  
+    UG0.noalias() = ui[0] * sG_GLL;
+    UG1.noalias() = ui[1] * sG_GLL;
+    UG2.noalias() = ui[2] * sG_GLL;
+    eij[0] = K[0].schur(GU0) + K[1].schur(UG0) + K[2].schur(GU2) + K[3].schur(UG2);
+    eij[1] = mInv_s.schur(v0); 
+    eij[2] = K[4].schur(GU0) + K[5].schur(UG0) + K[6].schur(GU2) + K[7].schur(UG2);
+    eij[3] = T.mZGU.schur(GU1) + T.mZUG.schur(UG1) + T.mCos1tInv_s.schur(v2) + T.mSin1tInv_s.schur(v1);
+    eij[4] = K[8].schur(GU0) + K[9].schur(UG0) + K[10].schur(GU2) + K[11].schur(UG2);
+    eij[5] = T.mRGU.schur(GU1) + T.mRUG.schur(UG1) + T.mCos1tInv_s.schur(v1) - T.mSin1tInv_s.schur(v2);
+    if (axial) {
+        eij[1].row(0) += mDzDeta.row(0).schur(GU0.row(0) + iialpha * GU1.row(0));
+        // limits of e_phiz and e_sphi on the axis, in v0 and v1, then rotated
+        v0.row(0) = mDzDeta.row(0).schur(iialpha * GU2.row(0));
+        v1.row(0) = mDzDeta.row(0).schur(iialpha * GU0.row(0) - GU1.row(0));
+        if (alpha == 1) {
+            eij[1].row(0) += mDzDxii.row(0).schur(UG0.row(0) + iialpha * UG1.row(0));
+            v1.row(0) += mDzDxii.row(0).schur(iialpha * UG0.row(0) - UG1.row(0));
+        }
+        eij[3].row(0) += T.mCos1t.row(0).schur(v0.row(0)) + T.mSin1t.row(0).schur(v1.row(0));
+        eij[5].row(0) += T.mCos1t.row(0).schur(v1.row(0)) - T.mSin1t.row(0).schur(v0.row(0));
+    }
+}
+
+template<bool axial>
+void Gradient::computeGrad6TIsoKernel(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    for (int alpha = 0; alpha <= Nu - nyquist; alpha++) {
+        computeGrad6TIsoMode<axial>(ui[alpha], eij[alpha], alpha, ws);
+    }
     
     // mask Nyquist
     if (nyquist) {
@@ -264,49 +958,83 @@ void Gradient::computeGrad6(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int N
     }   
 }
 
-void Gradient::computeQuad6(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist) const {
+template<bool axial>
+void Gradient::computeQuad6TIsoMode(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+    GradientWorkspace &ws) const {
+    // GLJ along xii on the axis
+    const RMatPP &G_xii = axial ? sG_GLJ : sG_GLL;
+    const std::array<RMatPP, 12> &K = mTIso->mK;
+    const GradientTIso &T = *mTIso;
+    
     // hardcode for mbeta = 0
-    static RMatPP X0R, X1R, X2R, Y0R, Y1R, Y2R; 
-    X0R = mDzDeta.schur(sij[0][0].real()) + mDsDeta.schur(sij[0][4].real());
-    X1R = mDzDeta.schur(sij[0][5].real()) + mDsDeta.schur(sij[0][3].real());
-    X2R = mDzDeta.schur(sij[0][4].real()) + mDsDeta.schur(sij[0][2].real());
-    Y0R = mDzDxii.schur(sij[0][0].real()) + mDsDxii.schur(sij[0][4].real());
-    Y1R = mDzDxii.schur(sij[0][5].real()) + mDsDxii.schur(sij[0][3].real());
-    Y2R = mDzDxii.schur(sij[0][4].real()) + mDsDxii.schur(sij[0][2].real());
-    fi[0][0].real() = (*sG_xii) * X0R + Y0R * (*sGT_eta) + mInv_s.schur(sij[0][1].real());
-    fi[0][1].real() = (*sG_xii) * X1R + Y1R * (*sGT_eta) - mInv_s.schur(sij[0][5].real());
-    fi[0][2].real() = (*sG_xii) * X2R + Y2R * (*sGT_eta); 
-    if (mAxial) {
-        fi[0][0].real() += (*sG_xii).col(0) * mDzDeta.row(0).schur(sij[0][1].real().row(0));
-        fi[0][1].real() -= (*sG_xii).col(0) * mDzDeta.row(0).schur(sij[0][5].real().row(0));
+    if (mbeta == 0) {
+        RMatPP &X0R = ws.mGR[0];
+        RMatPP &X1R = ws.mGR[1];
+        RMatPP &X2R = ws.mGR[2];
+        RMatPP &Y0R = ws.mRG[0];
+        RMatPP &Y1R = ws.mRG[1];
+        RMatPP &Y2R = ws.mRG[2];
+        X0R = K[0].schur(sij[0].real()) + K[4].schur(sij[2].real()) + K[8].schur(sij[4].real());
+        X1R = T.mZGU.schur(sij[3].real()) + T.mRGU.schur(sij[5].real());
+        X2R = K[2].schur(sij[0].real()) + K[6].schur(sij[2].real()) + K[10].schur(sij[4].real());
+        Y0R = K[1].schur(sij[0].real()) + K[5].schur(sij[2].real()) + K[9].schur(sij[4].real());
+        Y1R = T.mZUG.schur(sij[3].real()) + T.mRUG.schur(sij[5].real());
+        Y2R = K[3].schur(sij[0].real()) + K[7].schur(sij[2].real()) + K[11].schur(sij[4].real());
+        if (axial) {
+            X0R.row(0) += mDzDeta.row(0).schur(sij[1].real().row(0));
+            X1R.row(0) -= mDzDeta.row(0).schur(T.mCos1t.row(0).schur(sij[5].real().row(0)) 
+                                             + T.mSin1t.row(0).schur(sij[3].real().row(0)));
+        }
+        fi[0].real() = G_xii * X0R + Y0R * sGT_GLL + mInv_s.schur(sij[1].real());
+        fi[1].real() = G_xii * X1R + Y1R * sGT_GLL - T.mCos1tInv_s.schur(sij[5].real()) 
+                                                      - T.mSin1tInv_s.schur(sij[3].real());
+        fi[2].real() = G_xii * X2R + Y2R * sGT_GLL;
+        return;
     }
     
     // mbeta > 0
-    static CMatPP g0, g1, g2, X0, X1, X2, Y0, Y1, Y2;
-    for (int mbeta = 1; mbeta <= Nu - nyquist; mbeta++) {
-        Complex iibeta = - (Real)mbeta * ii; 
-        g0 = sij[mbeta][1] + iibeta * sij[mbeta][5];
-        g1 = iibeta * sij[mbeta][1] - sij[mbeta][5];
-        g2 = iibeta * sij[mbeta][3];    
-        X0 = mDzDeta.schur(sij[mbeta][0]) + mDsDeta.schur(sij[mbeta][4]);
-        X1 = mDzDeta.schur(sij[mbeta][5]) + mDsDeta.schur(sij[mbeta][3]);
-        X2 = mDzDeta.schur(sij[mbeta][4]) + mDsDeta.schur(sij[mbeta][2]);
-        Y0 = mDzDxii.schur(sij[mbeta][0]) + mDsDxii.schur(sij[mbeta][4]);
-        Y1 = mDzDxii.schur(sij[mbeta][5]) + mDsDxii.schur(sij[mbeta][3]);
-        Y2 = mDzDxii.schur(sij[mbeta][4]) + mDsDxii.schur(sij[mbeta][2]);
-        fi[mbeta][0] = (*sG_xii) * X0 + Y0 * (*sGT_eta) + mInv_s.schur(g0);
-        fi[mbeta][1] = (*sG_xii) * X1 + Y1 * (*sGT_eta) + mInv_s.schur(g1);
-        fi[mbeta][2] = (*sG_xii) * X2 + Y2 * (*sGT_eta) + mInv_s.schur(g2);
-        if (mAxial) {
-            fi[mbeta][0] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g0.row(0));
-            fi[mbeta][1] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g1.row(0));
-            fi[mbeta][2] += (*sG_xii).col(0) * mDzDeta.row(0).schur(g2.row(0));
-            if (mbeta == 1) {
-                fi[mbeta][0].row(0) += mDzDxii.row(0).schur(g0.row(0)) * (*sGT_eta);
-                fi[mbeta][1].row(0) += mDzDxii.row(0).schur(g1.row(0)) * (*sGT_eta);
-            }
+    CMatPP &g0 = ws.mV[0];
+    CMatPP &g1 = ws.mV[1];
+    CMatPP &g2 = ws.mV[2];
+    CMatPP &X0 = ws.mGU[0];
+    CMatPP &X1 = ws.mGU[1];
+    CMatPP &X2 = ws.mGU[2];
+    CMatPP &Y0 = ws.mUG[0];
+    CMatPP &Y1 = ws.mUG[1];
+    CMatPP &Y2 = ws.mUG[2];
+    Complex iibeta = - (Real)mbeta * ii; 
+    // s_sphi and s_phiz in (s, phi, z), in g1 and g2
+    g1 = T.mCos1t.schur(sij[5]) + T.mSin1t.schur(sij[3]);
+    g2 = T.mCos1t.schur(sij[3]) - T.mSin1t.schur(sij[5]);
+    g0 = sij[1] + iibeta * g1;
+    g1 = iibeta * sij[1] - g1;
+    g2 = iibeta * g2;    
+    X0 = K[0].schur(sij[0]) + K[4].schur(sij[2]) + K[8].schur(sij[4]);
+    X1 = T.mZGU.schur(sij[3]) + T.mRGU.schur(sij[5]);
+    X2 = K[2].schur(sij[0]) + K[6].schur(sij[2]) + K[10].schur(sij[4]);
+    Y0 = K[1].schur(sij[0]) + K[5].schur(sij[2]) + K[9].schur(sij[4]);
+    Y1 = T.mZUG.schur(sij[3]) + T.mRUG.schur(sij[5]);
+    Y2 = K[3].schur(sij[0]) + K[7].schur(sij[2]) + K[11].schur(sij[4]);
+    if (axial) {
+        X0.row(0) += mDzDeta.row(0).schur(g0.row(0));
+        X1.row(0) += mDzDeta.row(0).schur(g1.row(0));
+        X2.row(0) += mDzDeta.row(0).schur(g2.row(0));
+        if (mbeta == 1) {
+            Y0.row(0) += mDzDxii.row(0).schur(g0.row(0));
+            Y1.row(0) += mDzDxii.row(0).schur(g1.row(0));
         }
     }
+    fi[0] = G_xii * X0 + Y0 * sGT_GLL + mInv_s.schur(g0);
+    fi[1] = G_xii * X1 + Y1 * sGT_GLL + mInv_s.schur(g1);
+    fi[2] = G_xii * X2 + Y2 * sGT_GLL + mInv_s.schur(g2);
+}
+
+template<bool axial>
+void Gradient::computeQuad6TIsoKernel(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+    GradientWorkspace &ws) const {
+    for (int mbeta = 0; mbeta <= Nu - nyquist; mbeta++) {
+        computeQuad6TIsoMode<axial>(fi[mbeta], sij[mbeta], mbeta, ws);
+    }
     
     // mask Nyquist
     if (nyquist) {
@@ -317,13 +1045,9 @@ void Gradient::computeQuad6(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int N
 }
 
 //-------------------------- static --------------------------//
-RMatPP Gradient::sG_GLL;
-RMatPP Gradient::sG_GLJ;
-RMatPP Gradient::sGT_GLL;
-RMatPP Gradient::sGT_GLJ;
-void Gradient::setGMat(const RDMatPP &G_GLL, const RDMatPP &G_GLJ) {
-    sG_GLL = G_GLL.cast<Real>();
-    sG_GLJ = G_GLJ.cast<Real>();
-    sGT_GLL = sG_GLL.transpose();
-    sGT_GLJ = sG_GLJ.transpose();
-}
+const RMatPP Gradient::sG_GLL = 
+    Eigen::Map<const RDMatPP>(SpectralTables::sG_GLL).cast<Real>();
+const RMatPP Gradient::sG_GLJ = 
+    Eigen::Map<const RDMatPP>(SpectralTables::sG_GLJ).cast<Real>();
+const RMatPP Gradient::sGT_GLL = Gradient::sG_GLL.transpose();
+const RMatPP Gradient::sGT_GLJ = Gradient::sG_GLJ.transpose();
@@ -6,24 +6,151 @@
 
 #include "eigenc.h"
 #include "eigenp.h"
+#include "Arena.h"
 
-class Gradient {
+// workspace of the gradient kernels
+// The kernels are reentrant as long as each thread owns an instance.
+struct GradientWorkspace {
+    // real temporaries for alpha = 0
+    std::array<RMatPP, 3> mGR;
+    std::array<RMatPP, 3> mRG;
+    // complex temporaries for alpha > 0
+    std::array<CMatPP, 3> mV;
+    std::array<CMatPP, 3> mGU;
+    std::array<CMatPP, 3> mUG;
+    
+    #ifdef _USE_SIMD_KERNELS
+        // split real and imaginary parts for alpha > 0, 
+        // stored as ipnt * nmode + (alpha - 1) so that modes are contiguous
+        std::array<std::vector<Real>, 8> mSplit;
+        void resizeSplit(int nmode) {
+            if (mSplit[0].size() < nPntElem * nmode) {
+                for (auto &buf: mSplit) {
+                    buf.resize(nPntElem * nmode);
+                }
+            }
+        };
+    #endif
+    
+    // bytes, for memory reports
+    size_t memoryBytes() const {
+        size_t bytes = sizeof(*this);
+        #ifdef _USE_SIMD_KERNELS
+            for (const auto &buf: mSplit) {
+                bytes += heapBytes(buf);
+            }
+        #endif
+        return bytes;
+    };
+};
+
+// coordinate transformation from (s, phi, z) to (theta, phi, r)
+// folded into the geometry factors of computeGrad6 and computeQuad6
+struct GradientTIso: public ArenaObject {
+    GradientTIso(const RDMatPP &theta, 
+        const RMatPP &dsdxii, const RMatPP &dsdeta, 
+        const RMatPP &dzdxii, const RMatPP &dzdeta, const RMatPP &inv_s);
+    
+    // factors of GU and UG of u_s and u_z in e_RR, e_ZZ and 2 e_RZ, 
+    // indexed by 4 * strain + 2 * displ + (0 for GU or 1 for UG)
+    std::array<RMatPP, 12> mK;
+    // factors of GU and UG in the derivatives along R and Z
+    RMatPP mRGU;
+    RMatPP mRUG;
+    RMatPP mZGU;
+    RMatPP mZUG;
+    // t: theta of GLL-points
+    RMatPP mCos1t;
+    RMatPP mSin1t;
+    RMatPP mCos1tInv_s;
+    RMatPP mSin1tInv_s;
+};
+
+class Gradient: public ArenaObject {
 public:
     Gradient(const RDMatPP &dsdxii, const RDMatPP &dsdeta,  
              const RDMatPP &dzdxii, const RDMatPP &dzdeta, 
              const RDMatPP &inv_s, bool axial);
-    ~Gradient() {};
+    ~Gradient() {delete mTIso;};
+    
+    // strain of computeGrad6 and stress of computeQuad6 in (theta, phi, r) 
+    void setTIso(const RDMatPP &theta);
+    bool isTIso() const {return mTIso != 0;};
+    
+    // bytes of the geometry factors, for memory reports
+    size_t memoryBytes() const {return sizeof(*this) + (mTIso ? sizeof(GradientTIso) : 0);};
     
-    void computeGrad(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist) const;
-    void computeQuad(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist) const;
+    void computeGrad(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    void computeQuad(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
     
-    void computeGrad9(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist) const;
-    void computeQuad9(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist) const;
+    // a single Fourier mode of computeGrad, the 1D acoustic stress K * u_i 
+    // and computeQuad in one pass, without the vector field in memory;
+    // the imaginary part of mode 0 is left untouched
+    void computeStiffFluid(const CMatPP &u, CMatPP &f, const RMatPP &K, int alpha, 
+        GradientWorkspace &ws) const;
     
-    void computeGrad6(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist) const;
-    void computeQuad6(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist) const;
+    void computeGrad9(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    void computeQuad9(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    
+    void computeGrad6(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    void computeQuad6(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    
+    // a single Fourier mode of computeGrad6 and computeQuad6, for loops fused 
+    // over the modes; the imaginary part of mode 0 is left untouched and 
+    // the Nyquist mode is not masked
+    void computeGrad6(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+        GradientWorkspace &ws) const;
+    void computeQuad6(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+        GradientWorkspace &ws) const;
 
-private:    
+private:
+    // kernels specialized for axial and non-axial elements
+    template<bool axial, bool affine>
+    void computeGradKernel(const vec_CMatPP &u, vec_ar3_CMatPP &u_i, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeQuadKernel(vec_CMatPP &f, const vec_ar3_CMatPP &f_i, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeStiffFluidMode(const CMatPP &u, CMatPP &f, const RMatPP &K, int alpha, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeGrad9Kernel(const vec_ar3_CMatPP &ui, vec_ar9_CMatPP &ui_j, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeQuad9Kernel(vec_ar3_CMatPP &fi, const vec_ar9_CMatPP &fi_j, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeGrad6Kernel(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeQuad6Kernel(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeGrad6Mode(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+        GradientWorkspace &ws) const;
+    template<bool axial, bool affine>
+    void computeQuad6Mode(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+        GradientWorkspace &ws) const;
+    template<bool axial>
+    void computeGrad6TIsoMode(const ar3_CMatPP &ui, ar6_CMatPP &eij, int alpha, 
+        GradientWorkspace &ws) const;
+    template<bool axial>
+    void computeQuad6TIsoMode(ar3_CMatPP &fi, const ar6_CMatPP &sij, int mbeta, 
+        GradientWorkspace &ws) const;
+    template<bool axial>
+    void computeGrad6TIsoKernel(const vec_ar3_CMatPP &ui, vec_ar6_CMatPP &eij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    template<bool axial>
+    void computeQuad6TIsoKernel(vec_ar3_CMatPP &fi, const vec_ar6_CMatPP &sij, int Nu, int nyquist, 
+        GradientWorkspace &ws) const;
+    
     // operators
     RMatPP mDsDxii;
     RMatPP mDsDeta;
@@ -33,20 +160,29 @@ private:
     
     // axis
     bool mAxial;
-    RMatPP *sG_xii;
-    RMatPP *sGT_xii;
-    RMatPP *sG_eta;
-    RMatPP *sGT_eta;
     
-//-------------------------- static --------------------------//
-public: 
-    // set G Mat, shared by all elements
-    static void setGMat(const RDMatPP &G_GLL, const RDMatPP &G_GLJ);
+    // affine mapping, with the derivatives constant over the element
+    bool mAffine;
+    Real mAffineDsDxii;
+    Real mAffineDsDeta;
+    Real mAffineDzDxii;
+    Real mAffineDzDeta;
     
+    // rotation to (theta, phi, r), 0 if not needed
+    GradientTIso *mTIso = 0;
+    
+    #ifdef _USE_SIMD_KERNELS
+        // geometry factors interleaved per point: 
+        // dzdeta, dzdxii, dsdeta, dsdxii, inv_s
+        alignas(64) std::array<Real, nPntElem * 5> mGeomSplit;
+    #endif
+    
+//-------------------------- static --------------------------//
 private: 
-    // G Mat storage
-    static RMatPP sG_GLL;
-    static RMatPP sG_GLJ;
-    static RMatPP sGT_GLL;
-    static RMatPP sGT_GLJ;
+    // G Mat storage, shared by all elements, 
+    // formed from the compile-time spectral tables
+    static const RMatPP sG_GLL;
+    static const RMatPP sG_GLJ;
+    static const RMatPP sGT_GLL;
+    static const RMatPP sGT_GLJ;
 };
\ No newline at end of file
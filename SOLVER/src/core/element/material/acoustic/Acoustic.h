@@ -7,19 +7,28 @@
 class FluidResponse;
 #include <string>
 #include "eigenp.h"
+#include "eigenc.h"
+#include "Arena.h"
 
-class Acoustic {
+class Acoustic: public ArenaObject {
 public:
     virtual ~Acoustic() {};
     
     // STEP 2: strain ==> stress
     virtual void strainToStress(FluidResponse &response) const = 0;
     
+    // modulus of the scalar kernel fused over gradient, stress and 
+    // quadrature, 0 where the stress is not a 1D scaling of the strain
+    virtual const RMatPP *fusedModulus() const {return 0;};
+    
     // verbose
     virtual std::string verbose() const = 0;
     
     // 1D or Fourier space
     virtual bool is1D() const = 0;
+    
+    // bytes of the moduli, for memory reports
+    virtual size_t memoryBytes() const = 0;
 
     // check compatibility
     virtual void checkCompatibility(int Nr) const {}; 
@@ -15,9 +15,15 @@ public:
     // STEP 2: strain ==> stress
     void strainToStress(FluidResponse &response) const;
     
+    // modulus of the fused scalar kernel
+    const RMatPP *fusedModulus() const {return &mKStruct;};
+    
     // verbose
     std::string verbose() const {return "Acoustic1D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this);};
+    
     // 1D or Fourier space
     bool is1D() const {return true;};
     
@@ -18,6 +18,9 @@ public:
     // verbose
     std::string verbose() const {return "Acoustic3D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mKFlat);};
+    
     // 1D or Fourier space
     bool is1D() const {return false;};
 
@@ -19,4 +19,8 @@ public:
 
     // STEP 2.3: strain ==> R
     virtual void updateMemoryVariables(const vec_ar6_CMatPP &strain) = 0;
+    
+    // STEP 2.1 and 2.3 of the single mode alpha, for loops fused over the modes
+    virtual void applyToStress(ar6_CMatPP &stress, int alpha) const = 0;
+    virtual void updateMemoryVariables(const ar6_CMatPP &strain, int alpha) = 0;
 };
@@ -4,6 +4,7 @@
 
 
 #include "Attenuation1D_CG4.h"
+#include "Checkpoint.h"
 
 Attenuation1D_CG4::Attenuation1D_CG4(int nsls, const RColX &alpha, 
     const RColX &beta, const RColX &gamma, int Nu, 
@@ -16,78 +17,67 @@ mDKappa3(three * dkappa), mDMu(dmu), mDMu2(two * dmu), mDoKappa(doKappa) {
 
 void Attenuation1D_CG4::applyToStress(vec_ar6_CMatPP &stress) const {
     int Nu = mStressR.size() - 1;
-    for (int isls = 0; isls < mNSLS; isls++) {
-        for (int alpha = 0; alpha <= Nu; alpha++) {
-            for (int i = 0; i < 6; i++) {
-                stress[alpha][i](1, 1) -= mMemVar[isls][alpha][i](0);
-                stress[alpha][i](1, 3) -= mMemVar[isls][alpha][i](1);
-                stress[alpha][i](3, 1) -= mMemVar[isls][alpha][i](2);
-                stress[alpha][i](3, 3) -= mMemVar[isls][alpha][i](3);
-            }
-        }
+    for (int alpha = 0; alpha <= Nu; alpha++) {
+        Attenuation1D_CG4::applyToStress(stress[alpha], alpha);
     }
 }
 
 void Attenuation1D_CG4::updateMemoryVariables(const vec_ar6_CMatPP &strain) {
     int Nu = mStressR.size() - 1;
-    for (int isls = 0; isls < mNSLS; isls++) {
-        Real a = mAlpha[isls];
-        Real b = mBeta[isls];
-        for (int alpha = 0; alpha <= Nu; alpha++) {
-            mMemVar[isls][alpha][0] = a * mMemVar[isls][alpha][0] + b * mStressR[alpha][0];
-            mMemVar[isls][alpha][1] = a * mMemVar[isls][alpha][1] + b * mStressR[alpha][1];
-            mMemVar[isls][alpha][2] = a * mMemVar[isls][alpha][2] + b * mStressR[alpha][2];
-            mMemVar[isls][alpha][3] = a * mMemVar[isls][alpha][3] + b * mStressR[alpha][3];
-            mMemVar[isls][alpha][4] = a * mMemVar[isls][alpha][4] + b * mStressR[alpha][4];
-            mMemVar[isls][alpha][5] = a * mMemVar[isls][alpha][5] + b * mStressR[alpha][5];
-        }
-    }
-    
-    static ar6_CRow4 strain4;
-    static CRow4 eii_over_3, sii_over_3;
     for (int alpha = 0; alpha <= Nu; alpha++) {
-        for (int i = 0; i < 6; i++) {
-            strain4[i](0) = strain[alpha][i](1, 1);
-            strain4[i](1) = strain[alpha][i](1, 3);
-            strain4[i](2) = strain[alpha][i](3, 1);
-            strain4[i](3) = strain[alpha][i](3, 3);
+        Attenuation1D_CG4::updateMemoryVariables(strain[alpha], alpha);
+    }
+}
+
+void Attenuation1D_CG4::applyToStress(ar6_CMatPP &stress, int alpha) const {
+    for (int i = 0; i < 6; i++) {
+        for (int icg = 0; icg < nCG; icg++) {
+            Complex &s = stress[i](ipolCG[icg], jpolCG[icg]);
+            for (int isls = 0; isls < mNSLS; isls++) {
+                s -= mMemVar[isls][alpha][i](icg);
+            }
         }
-        eii_over_3 = (strain4[0] + strain4[1] + strain4[2]) * third;
-        if (mDoKappa) {
-            sii_over_3 = mDKappa3.schur(eii_over_3);
-            mStressR[alpha][0] = sii_over_3 + mDMu2.schur(strain4[0] - eii_over_3);
-            mStressR[alpha][1] = sii_over_3 + mDMu2.schur(strain4[1] - eii_over_3);
-            mStressR[alpha][2] = sii_over_3 + mDMu2.schur(strain4[2] - eii_over_3);
-        } else {
-            mStressR[alpha][0] = mDMu2.schur(strain4[0] - eii_over_3);
-            mStressR[alpha][1] = mDMu2.schur(strain4[1] - eii_over_3);
-            mStressR[alpha][2] = -(mStressR[alpha][0] + mStressR[alpha][1]);
+    }
+}
+
+void Attenuation1D_CG4::updateMemoryVariables(const ar6_CMatPP &strain, int alpha) {
+    static thread_local ar6_CRow4 strain4, stressNew;
+    static thread_local CRow4 eii_over_3, sii_over_3;
+    for (int i = 0; i < 6; i++) {
+        for (int icg = 0; icg < nCG; icg++) {
+            strain4[i](icg) = strain[i](ipolCG[icg], jpolCG[icg]);
         }
-        mStressR[alpha][3] = mDMu.schur(strain4[3]);
-        mStressR[alpha][4] = mDMu.schur(strain4[4]);
-        mStressR[alpha][5] = mDMu.schur(strain4[5]);
     }
+    eii_over_3 = (strain4[0] + strain4[1] + strain4[2]) * third;
+    if (mDoKappa) {
+        sii_over_3 = mDKappa3.schur(eii_over_3);
+        stressNew[0] = sii_over_3 + mDMu2.schur(strain4[0] - eii_over_3);
+        stressNew[1] = sii_over_3 + mDMu2.schur(strain4[1] - eii_over_3);
+        stressNew[2] = sii_over_3 + mDMu2.schur(strain4[2] - eii_over_3);
+    } else {
+        stressNew[0] = mDMu2.schur(strain4[0] - eii_over_3);
+        stressNew[1] = mDMu2.schur(strain4[1] - eii_over_3);
+        stressNew[2] = -(stressNew[0] + stressNew[1]);
+    }
+    stressNew[3] = mDMu.schur(strain4[3]);
+    stressNew[4] = mDMu.schur(strain4[4]);
+    stressNew[5] = mDMu.schur(strain4[5]);
     
+    // single pass over the memory variables with both the previous and the new stress
     for (int isls = 0; isls < mNSLS; isls++) {
-        Real r = mGamma[isls];
-        for (int alpha = 0; alpha <= Nu; alpha++) {
-            mMemVar[isls][alpha][0] += r * mStressR[alpha][0];
-            mMemVar[isls][alpha][1] += r * mStressR[alpha][1];
-            mMemVar[isls][alpha][2] += r * mStressR[alpha][2];
-            mMemVar[isls][alpha][3] += r * mStressR[alpha][3];
-            mMemVar[isls][alpha][4] += r * mStressR[alpha][4];
-            mMemVar[isls][alpha][5] += r * mStressR[alpha][5];
+        Real a = mAlpha(isls);
+        Real b = mBeta(isls);
+        Real g = mGamma(isls);
+        for (int i = 0; i < 6; i++) {
+            mMemVar[isls][alpha][i] = a * mMemVar[isls][alpha][i] 
+                + b * mStressR[alpha][i] + g * stressNew[i];
         }
     }
+    mStressR[alpha] = stressNew;
 }
 
 void Attenuation1D_CG4::checkCompatibility(int Nr) const
 {
-    if (nPol != 4) {
-        throw std::runtime_error("Attenuation1D_CG4::checkCompatibility "
-            " || Coarse grid attenuation is available only when nPol = 4.");
-    }
-            
     if (Nr / 2 + 1 != mStressR.size()) {
         throw std::runtime_error("Attenuation1D_CG4::checkCompatibility || Incompatible size.");
     }
@@ -98,4 +88,23 @@ void Attenuation1D_CG4::resetZero() {
     mMemVar = std::vector<vec_ar6_CRow4>(mNSLS, mStressR);
 }
 
+void Attenuation1D_CG4::syncState(Checkpoint &cp) {
+    for (int alpha = 0; alpha < mStressR.size(); alpha++) {
+        for (int i = 0; i < 6; i++) {
+            cp.syncEigen(mStressR[alpha][i]);
+            for (int isls = 0; isls < mNSLS; isls++) {
+                cp.syncEigen(mMemVar[isls][alpha][i]);
+            }
+        }
+    }
+}
+
 
+
+size_t Attenuation1D_CG4::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytesSLS() + heapBytes(mStressR) + heapBytes(mMemVar);
+    for (const vec_ar6_CRow4 &memVar: mMemVar) {
+        bytes += heapBytes(memVar);
+    }
+    return bytes;
+}
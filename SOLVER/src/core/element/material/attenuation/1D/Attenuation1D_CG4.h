@@ -21,12 +21,22 @@ public:
     // STEP 2.3: strain ==> R
     void updateMemoryVariables(const vec_ar6_CMatPP &strain);
     
+    // STEP 2.1 and 2.3 of the single mode alpha
+    void applyToStress(ar6_CMatPP &stress, int alpha) const;
+    void updateMemoryVariables(const ar6_CMatPP &strain, int alpha);
+    
     // check memory variable size
     void checkCompatibility(int Nr) const;
     
     // reset to zero 
     void resetZero(); 
     
+    // save or load memory variables 
+    void syncState(Checkpoint &cp);
+    
+    // bytes owned, memory variables included
+    size_t memoryBytes() const;
+    
 private:
     
     // memory variables
@@ -3,6 +3,7 @@
 // 1D attenuation on full grid
 
 #include "Attenuation1D_Full.h"
+#include "Checkpoint.h"
 
 Attenuation1D_Full::Attenuation1D_Full(int nsls, const RColX &alpha, 
     const RColX &beta, const RColX &gamma, int Nu, 
@@ -42,7 +43,7 @@ void Attenuation1D_Full::updateMemoryVariables(const vec_ar6_CMatPP &strain) {
         }
     }
     
-    static CMatPP eii_over_3, sii_over_3;
+    static thread_local CMatPP eii_over_3, sii_over_3;
     for (int alpha = 0; alpha <= Nu; alpha++) {
         eii_over_3 = (strain[alpha][0] + strain[alpha][1] + strain[alpha][2]) * third;
         if (mDoKappa) {
@@ -73,6 +74,43 @@ void Attenuation1D_Full::updateMemoryVariables(const vec_ar6_CMatPP &strain) {
     }
 }
 
+void Attenuation1D_Full::applyToStress(ar6_CMatPP &stress, int alpha) const {
+    for (int isls = 0; isls < mNSLS; isls++) {
+        for (int i = 0; i < 6; i++) {
+            stress[i] -= mMemVar[isls][alpha][i];
+        }
+    }
+}
+
+void Attenuation1D_Full::updateMemoryVariables(const ar6_CMatPP &strain, int alpha) {
+    static thread_local CMatPP eii_over_3, sii_over_3;
+    ar6_CMatPP &stressR = mStressR[alpha];
+    for (int isls = 0; isls < mNSLS; isls++) {
+        for (int i = 0; i < 6; i++) {
+            mMemVar[isls][alpha][i] = mAlpha[isls] * mMemVar[isls][alpha][i] + mBeta[isls] * stressR[i];
+        }
+    }
+    eii_over_3 = (strain[0] + strain[1] + strain[2]) * third;
+    if (mDoKappa) {
+        sii_over_3 = mDKappa3.schur(eii_over_3);
+        stressR[0] = sii_over_3 + mDMu2.schur(strain[0] - eii_over_3);
+        stressR[1] = sii_over_3 + mDMu2.schur(strain[1] - eii_over_3);
+        stressR[2] = sii_over_3 + mDMu2.schur(strain[2] - eii_over_3);
+    } else {
+        stressR[0] = mDMu2.schur(strain[0] - eii_over_3);
+        stressR[1] = mDMu2.schur(strain[1] - eii_over_3);
+        stressR[2] = -(stressR[0] + stressR[1]);
+    }
+    stressR[3] = mDMu.schur(strain[3]);
+    stressR[4] = mDMu.schur(strain[4]);
+    stressR[5] = mDMu.schur(strain[5]);
+    for (int isls = 0; isls < mNSLS; isls++) {
+        for (int i = 0; i < 6; i++) {
+            mMemVar[isls][alpha][i] += mGamma[isls] * stressR[i];
+        }
+    }
+}
+
 void Attenuation1D_Full::checkCompatibility(int Nr) const
 {
     if (Nr / 2 + 1 != mStressR.size()) {
@@ -84,3 +122,22 @@ void Attenuation1D_Full::resetZero() {
     mStressR = vec_ar6_CMatPP(mStressR.size(), zero_ar6_CMatPP);
     mMemVar = std::vector<vec_ar6_CMatPP>(mNSLS, mStressR);
 }
+
+void Attenuation1D_Full::syncState(Checkpoint &cp) {
+    for (int alpha = 0; alpha < mStressR.size(); alpha++) {
+        for (int i = 0; i < 6; i++) {
+            cp.syncEigen(mStressR[alpha][i]);
+            for (int isls = 0; isls < mNSLS; isls++) {
+                cp.syncEigen(mMemVar[isls][alpha][i]);
+            }
+        }
+    }
+}
+
+size_t Attenuation1D_Full::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytesSLS() + heapBytes(mStressR) + heapBytes(mMemVar);
+    for (const vec_ar6_CMatPP &memVar: mMemVar) {
+        bytes += heapBytes(memVar);
+    }
+    return bytes;
+}
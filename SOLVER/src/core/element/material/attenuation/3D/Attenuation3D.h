@@ -19,4 +19,10 @@ public:
 
     // STEP 2.3: strain ==> R
     virtual void updateMemoryVariables(const RMatXN6 &strain) = 0;
+    
+    // STEP 2.1 + 2.3 in one sweep, override when memory traffic can be saved
+    virtual void applyAndUpdate(RMatXN6 &stress, const RMatXN6 &strain) {
+        applyToStress(stress);
+        updateMemoryVariables(strain);
+    };
 };
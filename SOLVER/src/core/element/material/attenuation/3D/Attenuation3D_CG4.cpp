@@ -3,71 +3,77 @@
 // 3D attenuation on coarse grid 
 
 #include "Attenuation3D_CG4.h"
+#include "Checkpoint.h"
 
 Attenuation3D_CG4::Attenuation3D_CG4(int nsls, 
     const RColX &alpha, const RColX &beta, const RColX &gamma, 
     const RMatX4 &dkappa, const RMatX4 &dmu, bool doKappa):
 Attenuation3D(nsls, alpha, beta, gamma), 
 mDKappa3(three * dkappa), mDMu(dmu), mDMu2(two * dmu), mDoKappa(doKappa) {
-    mStressR = mStrain4 = RMatX46::Zero(mDMu.rows(), nCG * 6);
-    mMemVar = std::vector<RMatX46>(mNSLS, mStressR);    
+    mStressR = mStressRNew = mStrain4 = RMatX46::Zero(mDMu.rows(), nCG * 6);
+    mMemVar.assign(mNSLS, MemVarMatX46::Zero(mStressR.rows(), nCG * 6));
 }
 
 void Attenuation3D_CG4::applyToStress(RMatXN6 &stress) const {
     int n = mStressR.rows();
-    for (int isls = 0; isls < mNSLS; isls++) {
-        for (int i = 0; i < 6; i++) {
-            stress.block(0, nPE * i + nPntEdge * 1 + 1, n, 1) -= mMemVar[isls].col(nCG * i + 0);
-            stress.block(0, nPE * i + nPntEdge * 1 + 3, n, 1) -= mMemVar[isls].col(nCG * i + 1);
-            stress.block(0, nPE * i + nPntEdge * 3 + 1, n, 1) -= mMemVar[isls].col(nCG * i + 2);
-            stress.block(0, nPE * i + nPntEdge * 3 + 3, n, 1) -= mMemVar[isls].col(nCG * i + 3);
+    for (int i = 0; i < 6; i++) {
+        for (int icg = 0; icg < nCG; icg++) {
+            int ipnt = nPE * i + nPntEdge * ipolCG[icg] + jpolCG[icg];
+            Real *s = stress.data() + ipnt * stress.rows();
+            for (int isls = 0; isls < mNSLS; isls++) {
+                const MemVar *memVar = mMemVar[isls].data() + (nCG * i + icg) * n;
+                for (int row = 0; row < n; row++) {
+                    s[row] -= fromMemVar(memVar[row]);
+                }
+            }
         }
     }
 }
 
 void Attenuation3D_CG4::updateMemoryVariables(const RMatXN6 &strain) {
-    for (int isls = 0; isls < mNSLS; isls++) {
-        mMemVar[isls] = mAlpha(isls) * mMemVar[isls] + mBeta(isls) * mStressR;
-    }
-    
     int n = mStressR.rows();
     for (int i = 0; i < 6; i++) {
-        mStrain4.col(nCG * i + 0) = strain.block(0, nPE * i + nPntEdge * 1 + 1, n, 1);
-        mStrain4.col(nCG * i + 1) = strain.block(0, nPE * i + nPntEdge * 1 + 3, n, 1);
-        mStrain4.col(nCG * i + 2) = strain.block(0, nPE * i + nPntEdge * 3 + 1, n, 1);
-        mStrain4.col(nCG * i + 3) = strain.block(0, nPE * i + nPntEdge * 3 + 3, n, 1);
+        for (int icg = 0; icg < nCG; icg++) {
+            mStrain4.col(nCG * i + icg) = strain.block(0, 
+                nPE * i + nPntEdge * ipolCG[icg] + jpolCG[icg], n, 1);
+        }
     }
     
-    // to avoid dynamic allocation, use mStressR.block(0, nCG * 3, n, nCG) to store Eii / 3    
-    mStressR.block(0, nCG * 3, n, nCG) = third * (mStrain4.block(0, nCG * 0, n, nCG) 
+    // new stress goes to mStressRNew, the previous one is kept for the update
+    // to avoid dynamic allocation, use mStressRNew.block(0, nCG * 3, n, nCG) to store Eii / 3    
+    mStressRNew.block(0, nCG * 3, n, nCG) = third * (mStrain4.block(0, nCG * 0, n, nCG) 
         + mStrain4.block(0, nCG * 1, n, nCG) + mStrain4.block(0, nCG * 2, n, nCG));
     if (mDoKappa) {
-        // to avoid dynamic allocation, use mStressR.block(0, nCG * 4, n, nCG) to store Sii
-        mStressR.block(0, nCG * 4, n, nCG) = mDKappa3.schur(mStressR.block(0, nCG * 3, n, nCG));
-        mStressR.block(0, nCG * 0, n, nCG) = mStressR.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 0, n, nCG) - mStressR.block(0, nCG * 3, n, nCG));
-        mStressR.block(0, nCG * 1, n, nCG) = mStressR.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 1, n, nCG) - mStressR.block(0, nCG * 3, n, nCG));
-        mStressR.block(0, nCG * 2, n, nCG) = mStressR.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 2, n, nCG) - mStressR.block(0, nCG * 3, n, nCG));
+        // to avoid dynamic allocation, use mStressRNew.block(0, nCG * 4, n, nCG) to store Sii
+        mStressRNew.block(0, nCG * 4, n, nCG) = mDKappa3.schur(mStressRNew.block(0, nCG * 3, n, nCG));
+        mStressRNew.block(0, nCG * 0, n, nCG) = mStressRNew.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 0, n, nCG) - mStressRNew.block(0, nCG * 3, n, nCG));
+        mStressRNew.block(0, nCG * 1, n, nCG) = mStressRNew.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 1, n, nCG) - mStressRNew.block(0, nCG * 3, n, nCG));
+        mStressRNew.block(0, nCG * 2, n, nCG) = mStressRNew.block(0, nCG * 4, n, nCG) + mDMu2.schur(mStrain4.block(0, nCG * 2, n, nCG) - mStressRNew.block(0, nCG * 3, n, nCG));
     } else {
-        mStressR.block(0, nCG * 0, n, nCG) = mDMu2.schur(mStrain4.block(0, nCG * 0, n, nCG) - mStressR.block(0, nCG * 3, n, nCG));
-        mStressR.block(0, nCG * 1, n, nCG) = mDMu2.schur(mStrain4.block(0, nCG * 1, n, nCG) - mStressR.block(0, nCG * 3, n, nCG));
-        mStressR.block(0, nCG * 2, n, nCG) = -(mStressR.block(0, nCG * 0, n, nCG) + mStressR.block(0, nCG * 1, n, nCG));
+        mStressRNew.block(0, nCG * 0, n, nCG) = mDMu2.schur(mStrain4.block(0, nCG * 0, n, nCG) - mStressRNew.block(0, nCG * 3, n, nCG));
+        mStressRNew.block(0, nCG * 1, n, nCG) = mDMu2.schur(mStrain4.block(0, nCG * 1, n, nCG) - mStressRNew.block(0, nCG * 3, n, nCG));
+        mStressRNew.block(0, nCG * 2, n, nCG) = -(mStressRNew.block(0, nCG * 0, n, nCG) + mStressRNew.block(0, nCG * 1, n, nCG));
     }
-    mStressR.block(0, nCG * 3, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 3, n, nCG));
-    mStressR.block(0, nCG * 4, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 4, n, nCG));
-    mStressR.block(0, nCG * 5, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 5, n, nCG));
+    mStressRNew.block(0, nCG * 3, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 3, n, nCG));
+    mStressRNew.block(0, nCG * 4, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 4, n, nCG));
+    mStressRNew.block(0, nCG * 5, n, nCG) = mDMu.schur(mStrain4.block(0, nCG * 5, n, nCG));
     
+    // single pass over each memory variable with both the previous and the new stress
+    int size = mStressR.size();
     for (int isls = 0; isls < mNSLS; isls++) {
-        mMemVar[isls] += mGamma[isls] * mStressR;
+        Real a = mAlpha(isls), b = mBeta(isls), g = mGamma(isls);
+        const Real *sOld = mStressR.data();
+        const Real *sNew = mStressRNew.data();
+        MemVar *memVar = mMemVar[isls].data();
+        for (int k = 0; k < size; k++) {
+            memVar[k] = toMemVar(a * fromMemVar(memVar[k]) + b * sOld[k] + g * sNew[k]);
+        }
     }
+    mStressR.swap(mStressRNew);
 }
 
 void Attenuation3D_CG4::checkCompatibility(int Nr) const
 {
-    if (nPol != 4) {
-        throw std::runtime_error("Attenuation3D_CG4::checkCompatibility "
-            " || Coarse grid attenuation is available only when nPol = 4.");
-    }
-        
     int myNr = mStressR.rows();
     if (Nr != myNr) {
         throw std::runtime_error("Attenuation3D_CG4::checkCompatibility || Incompatible size.");
@@ -76,6 +82,24 @@ void Attenuation3D_CG4::checkCompatibility(int Nr) const
 
 void Attenuation3D_CG4::resetZero() {
     mStressR.setZero();
-    mMemVar = std::vector<RMatX46>(mNSLS, mStressR);    
+    mStressRNew.setZero();
+    mMemVar.assign(mNSLS, MemVarMatX46::Zero(mStressR.rows(), nCG * 6));
 }
 
+void Attenuation3D_CG4::syncState(Checkpoint &cp) {
+    cp.syncEigen(mStressR);
+    for (int isls = 0; isls < mNSLS; isls++) {
+        cp.syncEigen(mMemVar[isls]);
+    }
+}
+
+
+size_t Attenuation3D_CG4::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytesSLS() + heapBytes(mStressR) + heapBytes(mStressRNew) + 
+        heapBytes(mStrain4) + heapBytes(mMemVar) + 
+        heapBytes(mDKappa3) + heapBytes(mDMu) + heapBytes(mDMu2);
+    for (const MemVarMatX46 &memVar: mMemVar) {
+        bytes += heapBytes(memVar);
+    }
+    return bytes;
+}
@@ -27,12 +27,20 @@ public:
     // reset to zero 
     void resetZero(); 
     
+    // save or load memory variables 
+    void syncState(Checkpoint &cp);
+    
+    // bytes owned, memory variables included
+    size_t memoryBytes() const;
+    
 private:
     
     // memory variables
     RMatX46 mStressR;
+    RMatX46 mStressRNew;
     RMatX46 mStrain4;
-    std::vector<RMatX46> mMemVar;
+    typedef Eigen::Matrix<MemVar, Eigen::Dynamic, nCG * 6> MemVarMatX46;
+    std::vector<MemVarMatX46> mMemVar;
     // modules
     RMatX4 mDKappa3; // dkappa * 3
     RMatX4 mDMu;     // dmu
@@ -3,50 +3,87 @@
 // 3D attenuation on full grid 
 
 #include "Attenuation3D_Full.h"
+#include "Checkpoint.h"
 
 Attenuation3D_Full::Attenuation3D_Full(int nsls, 
     const RColX &alpha, const RColX &beta, const RColX &gamma, 
     const RMatXN &dkappa, const RMatXN &dmu, bool doKappa):
 Attenuation3D(nsls, alpha, beta, gamma), 
 mDKappa3(three * dkappa), mDMu(dmu), mDMu2(two * dmu), mDoKappa(doKappa) {
-    mStressR = RMatXN6::Zero(mDMu.rows(), nPE * 6);
-    mMemVar = std::vector<RMatXN6>(mNSLS, mStressR);    
+    mStressR = mStressRNew = RMatXN6::Zero(mDMu.rows(), nPE * 6);
+    mMemVar = Eigen::Matrix<MemVar, Eigen::Dynamic, 1>::Zero(mStressR.size() * mNSLS);
 }
 
 void Attenuation3D_Full::applyToStress(RMatXN6 &stress) const {
     int n = mStressR.rows();
-    for (int isls = 0; isls < mNSLS; isls++) {
-        stress.topRows(n) -= mMemVar[isls];
+    const MemVar *memVar = mMemVar.data();
+    for (int col = 0; col < nPE * 6; col++) {
+        Real *s = stress.data() + col * stress.rows();
+        for (int row = 0; row < n; row++) {
+            for (int isls = 0; isls < mNSLS; isls++) {
+                s[row] -= fromMemVar(*memVar++);
+            }
+        }
     } 
 }
 
 void Attenuation3D_Full::updateMemoryVariables(const RMatXN6 &strain) {
-    for (int isls = 0; isls < mNSLS; isls++) {
-        mMemVar[isls] = mAlpha(isls) * mMemVar[isls] + mBeta(isls) * mStressR;
-    }
-    
-    int n = mStressR.rows();
-    // to avoid dynamic allocation, use mStressR.block(0, nPE * 3, n, nPE) to store Eii / 3
-    mStressR.block(0, nPE * 3, n, nPE) = third * (strain.block(0, nPE * 0, n, nPE) 
+    computeStressR(strain);
+    sweepMemoryVariables(0);
+}
+
+void Attenuation3D_Full::applyAndUpdate(RMatXN6 &stress, const RMatXN6 &strain) {
+    computeStressR(strain);
+    sweepMemoryVariables(&stress);
+}
+
+void Attenuation3D_Full::computeStressR(const RMatXN6 &strain) {
+    int n = mStressRNew.rows();
+    // to avoid dynamic allocation, use mStressRNew.block(0, nPE * 3, n, nPE) to store Eii / 3
+    mStressRNew.block(0, nPE * 3, n, nPE) = third * (strain.block(0, nPE * 0, n, nPE) 
         + strain.block(0, nPE * 1, n, nPE) + strain.block(0, nPE * 2, n, nPE));
     if (mDoKappa) {
-        // to avoid dynamic allocation, use mStressR.block(0, nPE * 4, n, nPE) to store Sii 
-        mStressR.block(0, nPE * 4, n, nPE) = mDKappa3.schur(mStressR.block(0, nPE * 3, n, nPE));
-        mStressR.block(0, nPE * 0, n, nPE) = mStressR.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 0, n, nPE) - mStressR.block(0, nPE * 3, n, nPE));
-        mStressR.block(0, nPE * 1, n, nPE) = mStressR.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 1, n, nPE) - mStressR.block(0, nPE * 3, n, nPE));
-        mStressR.block(0, nPE * 2, n, nPE) = mStressR.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 2, n, nPE) - mStressR.block(0, nPE * 3, n, nPE));
+        // to avoid dynamic allocation, use mStressRNew.block(0, nPE * 4, n, nPE) to store Sii 
+        mStressRNew.block(0, nPE * 4, n, nPE) = mDKappa3.schur(mStressRNew.block(0, nPE * 3, n, nPE));
+        mStressRNew.block(0, nPE * 0, n, nPE) = mStressRNew.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 0, n, nPE) - mStressRNew.block(0, nPE * 3, n, nPE));
+        mStressRNew.block(0, nPE * 1, n, nPE) = mStressRNew.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 1, n, nPE) - mStressRNew.block(0, nPE * 3, n, nPE));
+        mStressRNew.block(0, nPE * 2, n, nPE) = mStressRNew.block(0, nPE * 4, n, nPE) + mDMu2.schur(strain.block(0, nPE * 2, n, nPE) - mStressRNew.block(0, nPE * 3, n, nPE));
     } else {
-        mStressR.block(0, nPE * 0, n, nPE) = mDMu2.schur(strain.block(0, nPE * 0, n, nPE) - mStressR.block(0, nPE * 3, n, nPE));
-        mStressR.block(0, nPE * 1, n, nPE) = mDMu2.schur(strain.block(0, nPE * 1, n, nPE) - mStressR.block(0, nPE * 3, n, nPE));
-        mStressR.block(0, nPE * 2, n, nPE) = -(mStressR.block(0, nPE * 0, n, nPE) + mStressR.block(0, nPE * 1, n, nPE));
+        mStressRNew.block(0, nPE * 0, n, nPE) = mDMu2.schur(strain.block(0, nPE * 0, n, nPE) - mStressRNew.block(0, nPE * 3, n, nPE));
+        mStressRNew.block(0, nPE * 1, n, nPE) = mDMu2.schur(strain.block(0, nPE * 1, n, nPE) - mStressRNew.block(0, nPE * 3, n, nPE));
+        mStressRNew.block(0, nPE * 2, n, nPE) = -(mStressRNew.block(0, nPE * 0, n, nPE) + mStressRNew.block(0, nPE * 1, n, nPE));
     }
-    mStressR.block(0, nPE * 3, n, nPE) = mDMu.schur(strain.block(0, nPE * 3, n, nPE));
-    mStressR.block(0, nPE * 4, n, nPE) = mDMu.schur(strain.block(0, nPE * 4, n, nPE));
-    mStressR.block(0, nPE * 5, n, nPE) = mDMu.schur(strain.block(0, nPE * 5, n, nPE));
-    
-    for (int isls = 0; isls < mNSLS; isls++) {
-        mMemVar[isls] += mGamma[isls] * mStressR;        
+    mStressRNew.block(0, nPE * 3, n, nPE) = mDMu.schur(strain.block(0, nPE * 3, n, nPE));
+    mStressRNew.block(0, nPE * 4, n, nPE) = mDMu.schur(strain.block(0, nPE * 4, n, nPE));
+    mStressRNew.block(0, nPE * 5, n, nPE) = mDMu.schur(strain.block(0, nPE * 5, n, nPE));
+}
+
+void Attenuation3D_Full::sweepMemoryVariables(RMatXN6 *stress) {
+    int n = mStressR.rows();
+    const Real *a = mAlpha.data();
+    const Real *b = mBeta.data();
+    const Real *g = mGamma.data();
+    const Real *sOld = mStressR.data();
+    const Real *sNew = mStressRNew.data();
+    MemVar *memVar = mMemVar.data();
+    for (int col = 0; col < nPE * 6; col++) {
+        Real *s = stress ? stress->data() + col * stress->rows() : 0;
+        for (int row = 0; row < n; row++) {
+            Real sumR = 0.;
+            for (int isls = 0; isls < mNSLS; isls++) {
+                Real r = fromMemVar(memVar[isls]);
+                sumR += r;
+                memVar[isls] = toMemVar(a[isls] * r + b[isls] * (*sOld) + g[isls] * (*sNew));
+            }
+            if (s) {
+                s[row] -= sumR;
+            }
+            memVar += mNSLS;
+            sOld++;
+            sNew++;
+        }
     }
+    mStressR.swap(mStressRNew);
 }
 
 void Attenuation3D_Full::checkCompatibility(int Nr) const {
@@ -58,6 +95,17 @@ void Attenuation3D_Full::checkCompatibility(int Nr) const {
 
 void Attenuation3D_Full::resetZero() {
     mStressR.setZero();
-    mMemVar = std::vector<RMatXN6>(mNSLS, mStressR);    
+    mStressRNew.setZero();
+    mMemVar.setZero();
+}
+
+void Attenuation3D_Full::syncState(Checkpoint &cp) {
+    cp.syncEigen(mStressR);
+    cp.syncEigen(mMemVar);
 }
 
+
+size_t Attenuation3D_Full::memoryBytes() const {
+    return sizeof(*this) + heapBytesSLS() + heapBytes(mStressR) + heapBytes(mStressRNew) + 
+        heapBytes(mMemVar) + heapBytes(mDKappa3) + heapBytes(mDMu) + heapBytes(mDMu2);
+}
@@ -5,7 +5,6 @@
 #pragma once
 
 #include "Attenuation3D.h"
-#include <vector>
 
 class Attenuation3D_Full: public Attenuation3D {
     
@@ -20,16 +19,34 @@ public:
     // STEP 2.3: strain ==> R
     void updateMemoryVariables(const RMatXN6 &strain);
     
+    // STEP 2.1 + 2.3 in one sweep
+    void applyAndUpdate(RMatXN6 &stress, const RMatXN6 &strain);
+    
     // check memory variable size
     void checkCompatibility(int Nr) const;
     
     // reset to zero 
     void resetZero(); 
     
+    // save or load memory variables 
+    void syncState(Checkpoint &cp);
+    
+    // bytes owned, memory variables included
+    size_t memoryBytes() const;
+    
 private:
+    // strain ==> mStressRNew
+    void computeStressR(const RMatXN6 &strain);
+    
+    // sweep over all memory variables, subtracting them from stress if given
+    void sweepMemoryVariables(RMatXN6 *stress);
+    
     // memory variables
     RMatXN6 mStressR;
-    std::vector<RMatXN6> mMemVar;
+    RMatXN6 mStressRNew;
+    // interleaved with the mechanism as the fastest index: 
+    // mMemVar[(col * nr + row) * nsls + isls], col running over nPE * 6
+    Eigen::Matrix<MemVar, Eigen::Dynamic, 1> mMemVar;
     // modules
     RMatXN mDKappa3; // dkappa * 3
     RMatXN mDMu;     // dmu
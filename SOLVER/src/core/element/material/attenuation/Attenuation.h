@@ -6,8 +6,39 @@
 
 #include "eigenc.h"
 #include "global.h"
+#include "Arena.h"
+#include <cstdint>
+#include <cstring>
+class Checkpoint;
 
-class Attenuation {
+// storage type of 3D memory variables, computed in Real
+#ifdef _USE_BF16_MEMVAR
+    // bfloat16: the upper half of a float, rounded to nearest even
+    typedef uint16_t MemVar;
+    inline MemVar toMemVar(Real value) {
+        float f = value;
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        if ((u & 0x7fffffff) > 0x7f800000) {
+            // keep NaN a NaN
+            return (MemVar)((u >> 16) | 0x40);
+        }
+        u += 0x7fff + ((u >> 16) & 1);
+        return (MemVar)(u >> 16);
+    };
+    inline Real fromMemVar(MemVar value) {
+        uint32_t u = (uint32_t)value << 16;
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    };
+#else
+    typedef Real MemVar;
+    inline MemVar toMemVar(Real value) {return value;};
+    inline Real fromMemVar(MemVar value) {return value;};
+#endif
+
+class Attenuation: public ArenaObject {
 public:
     
     Attenuation(int nsls, const RColX &alpha, 
@@ -23,7 +54,18 @@ public:
     // reset to zero 
     virtual void resetZero() = 0; 
     
+    // save or load memory variables 
+    virtual void syncState(Checkpoint &cp) = 0;
+    
+    // bytes owned, memory variables included, for memory reports
+    virtual size_t memoryBytes() const = 0;
+    
 protected:
+    // heap bytes of the SLS coefficients
+    size_t heapBytesSLS() const {
+        return heapBytes(mAlpha) + heapBytes(mBeta) + heapBytes(mGamma);
+    };
+    
     int mNSLS;
     RColX mAlpha;
     RColX mBeta;
@@ -9,8 +9,15 @@
 #include <array>
 #include "global.h"
 
-// elemental fields - flat 
+// coarse-grid points, one at the centre of each quadrant of the element
+// nPol = 4: (1, 1), (1, 3), (3, 1), (3, 3); requires nPol >= 3
 static const int nCG = 4;
+const int nPolCGLow = (nPol + 2) / 4;
+const int nPolCGHigh = nPol - nPolCGLow;
+const int ipolCG[nCG] = {nPolCGLow, nPolCGLow, nPolCGHigh, nPolCGHigh};
+const int jpolCG[nCG] = {nPolCGLow, nPolCGHigh, nPolCGLow, nPolCGHigh};
+
+// elemental fields - flat 
 typedef Eigen::Matrix<Real, Eigen::Dynamic, nCG * 6> RMatX46;
 typedef Eigen::Matrix<Real, Eigen::Dynamic, nCG> RMatX4;
 
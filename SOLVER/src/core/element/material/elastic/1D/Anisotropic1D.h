@@ -30,6 +30,9 @@ public:
     // verbose
     std::string verbose() const {return "Anisotropic1D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this);};
+    
     // need TIso
     bool needTIso() const {return true;};
     
@@ -4,6 +4,7 @@
 
 #include "Elastic1D.h"
 #include "Attenuation1D.h"
+#include "Checkpoint.h"
 
 Elastic1D::Elastic1D(Attenuation1D *att):
 mAttenuation(att) {
@@ -28,3 +29,13 @@ void Elastic1D::resetZero() {
     }
 }
 
+void Elastic1D::syncState(Checkpoint &cp) {
+    if (mAttenuation) {
+        mAttenuation->syncState(cp);
+    }
+}
+
+
+size_t Elastic1D::attenuationBytes() const {
+    return mAttenuation ? mAttenuation->memoryBytes() : 0;
+}
@@ -19,6 +19,12 @@ public:
     // reset to zero 
     void resetZero(); 
     
+    // save or load memory variables 
+    void syncState(Checkpoint &cp);
+    
+    // bytes of the attenuation
+    size_t attenuationBytes() const;
+    
     // 1D or Fourier space
     bool is1D() const {return true;};
     
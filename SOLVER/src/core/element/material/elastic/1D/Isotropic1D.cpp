@@ -7,7 +7,7 @@
 #include "SolidElement.h"
 
 void Isotropic1D::strainToStress(SolidResponse &response) const {
-    static CMatPP sii;
+    static thread_local CMatPP sii;
     for (int alpha = 0; alpha <= response.mNu; alpha++) {
         const ar6_CMatPP &strain = response.mStrain6[alpha];
         ar6_CMatPP &stress = response.mStress6[alpha];
@@ -25,3 +25,7 @@ void Isotropic1D::strainToStress(SolidResponse &response) const {
     }
 }
 
+void Isotropic1D::attenuateMode(const ar6_CMatPP &strain, ar6_CMatPP &stress, int alpha) const {
+    mAttenuation->applyToStress(stress, alpha);
+    mAttenuation->updateMemoryVariables(strain, alpha);
+}
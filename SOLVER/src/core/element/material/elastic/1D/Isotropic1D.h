@@ -7,7 +7,7 @@
 #include "Elastic1D.h"
 #include "eigenc.h"
 
-class Isotropic1D: public Elastic1D {
+class Isotropic1D final: public Elastic1D {
 public:
     // constructor
     Isotropic1D(const RMatPP &lambda, const RMatPP &mu, Attenuation1D *att):
@@ -16,13 +16,37 @@ public:
     // STEP 2: strain ==>>> stress
     void strainToStress(SolidResponse &response) const;
     
+    // STEP 2 of a single mode
+    bool fusedModes() const {return true;};
+    bool linearModes() const {return mAttenuation == 0;};
+    // inline for the kernel of SolidElement bound to this class
+    void strainToStressMode(const ar6_CMatPP &strain, ar6_CMatPP &stress, int alpha) const {
+        static thread_local CMatPP sii;
+        sii = mLambda.schur(strain[0] + strain[1] + strain[2]);
+        stress[0] = sii + mMu2.schur(strain[0]);
+        stress[1] = sii + mMu2.schur(strain[1]);
+        stress[2] = sii + mMu2.schur(strain[2]);
+        stress[3] = mMu.schur(strain[3]);
+        stress[4] = mMu.schur(strain[4]);
+        stress[5] = mMu.schur(strain[5]);
+        if (mAttenuation) {
+            attenuateMode(strain, stress, alpha);
+        }
+    };
+    
     // verbose
     std::string verbose() const {return "Isotropic1D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this);};
+    
     // need TIso
     bool needTIso() const {return false;};
                     
 private:
+    // attenuation of a single mode
+    void attenuateMode(const ar6_CMatPP &strain, ar6_CMatPP &stress, int alpha) const;
+    
     // Cijkl scaled by integral factor
     RMatPP mLambda; 
     RMatPP mMu; 
@@ -7,7 +7,7 @@
 #include "SolidElement.h"
 
 void TransverselyIsotropic1D::strainToStress(SolidResponse &response) const {
-    static CMatPP e0_p_e1, temp;
+    static thread_local CMatPP e0_p_e1, temp;
     for (int alpha = 0; alpha <= response.mNu; alpha++) {
         const ar6_CMatPP &strainTIso = response.mStrain6[alpha];
         ar6_CMatPP &stressTIso = response.mStress6[alpha];
@@ -25,3 +25,9 @@ void TransverselyIsotropic1D::strainToStress(SolidResponse &response) const {
         mAttenuation->updateMemoryVariables(response.mStrain6);
     }
 }
+
+void TransverselyIsotropic1D::attenuateMode(const ar6_CMatPP &strainTIso, ar6_CMatPP &stressTIso, int alpha) const {
+    mAttenuation->applyToStress(stressTIso, alpha);
+    mAttenuation->updateMemoryVariables(strainTIso, alpha);
+}
+
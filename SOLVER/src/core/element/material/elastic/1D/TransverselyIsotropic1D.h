@@ -7,7 +7,7 @@
 #include "Elastic1D.h"
 #include "eigenc.h"
 
-class TransverselyIsotropic1D: public Elastic1D {
+class TransverselyIsotropic1D final: public Elastic1D {
 public:
     // constructor
     TransverselyIsotropic1D(const RMatPP &A, const RMatPP &C, const RMatPP &F, 
@@ -17,13 +17,37 @@ public:
     // STEP 2: strain ==>>> stress
     void strainToStress(SolidResponse &response) const;
     
+    // STEP 2 of a single mode
+    bool fusedModes() const {return true;};
+    bool linearModes() const {return mAttenuation == 0;};
+    // inline for the kernel of SolidElement bound to this class
+    void strainToStressMode(const ar6_CMatPP &strainTIso, ar6_CMatPP &stressTIso, int alpha) const {
+        static thread_local CMatPP e0_p_e1, temp;
+        e0_p_e1 = strainTIso[0] + strainTIso[1];
+        temp = mA.schur(e0_p_e1) + mF.schur(strainTIso[2]);
+        stressTIso[0] = temp - mN2.schur(strainTIso[1]);
+        stressTIso[1] = temp - mN2.schur(strainTIso[0]);
+        stressTIso[2] = mC.schur(strainTIso[2]) + mF.schur(e0_p_e1);
+        stressTIso[3] = mL.schur(strainTIso[3]);
+        stressTIso[4] = mL.schur(strainTIso[4]);
+        stressTIso[5] = mN.schur(strainTIso[5]);
+        if (mAttenuation) {
+            attenuateMode(strainTIso, stressTIso, alpha);
+        }
+    };
+    
     // verbose
     std::string verbose() const {return "TransverselyIsotropic1D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this);};
+    
     // need TIso
     bool needTIso() const {return true;};
     
 private:
+    // attenuation of a single mode
+    void attenuateMode(const ar6_CMatPP &strainTIso, ar6_CMatPP &stressTIso, int alpha) const;
     
     // Cijkl scaled by integral factor
     RMatPP mA;
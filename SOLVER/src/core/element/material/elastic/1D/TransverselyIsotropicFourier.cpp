@@ -0,0 +1,58 @@
+// TransverselyIsotropicFourier.cpp
+// created by Kuangdai on 14-Oct-2026 
+// weakly 3D transversely isotropic material in Fourier space
+// moduli are expanded into a few azimuthal orders and applied to the 
+// Fourier strain as a banded convolution, skipping the FFT pair
+
+#include "TransverselyIsotropicFourier.h"
+#include "Attenuation1D.h"
+#include "SolidElement.h"
+
+void TransverselyIsotropicFourier::strainToStress(SolidResponse &response) const {
+    static thread_local CMatPP a, c, f, l, n, e0_p_e1, temp;
+    static thread_local ar6_CMatPP strain;
+    int order = mA.size() - 1;
+    int Nu = response.mNu - response.mNyquist;
+    for (int alpha = 0; alpha <= Nu; alpha++) {
+        ar6_CMatPP &stressTIso = response.mStress6[alpha];
+        for (int i = 0; i < 6; i++) {
+            stressTIso[i].setZero();
+        }
+        // stress(alpha) = sum_k moduli(k) * strain(alpha - k)
+        for (int k = std::max(-order, alpha - Nu); k <= std::min(order, alpha + Nu); k++) {
+            // real fields: coefficients of negative orders are conjugates
+            int beta = alpha - k;
+            if (k >= 0) {
+                a = mA[k]; c = mC[k]; f = mF[k]; l = mL[k]; n = mN[k];
+            } else {
+                a = mA[-k].conjugate(); c = mC[-k].conjugate(); f = mF[-k].conjugate(); 
+                l = mL[-k].conjugate(); n = mN[-k].conjugate();
+            }
+            for (int i = 0; i < 6; i++) {
+                if (beta >= 0) {
+                    strain[i] = response.mStrain6[beta][i];
+                } else {
+                    strain[i] = response.mStrain6[-beta][i].conjugate();
+                }
+            }
+            e0_p_e1 = strain[0] + strain[1];
+            temp = a.schur(e0_p_e1) + f.schur(strain[2]);
+            stressTIso[0] += temp - two * n.schur(strain[1]);
+            stressTIso[1] += temp - two * n.schur(strain[0]);
+            stressTIso[2] += c.schur(strain[2]) + f.schur(e0_p_e1);
+            stressTIso[3] += l.schur(strain[3]);
+            stressTIso[4] += l.schur(strain[4]);
+            stressTIso[5] += n.schur(strain[5]);
+        }
+    }
+    // mask Nyquist
+    if (response.mNyquist) {
+        for (int i = 0; i < 6; i++) {
+            response.mStress6[response.mNu][i].setZero();
+        }
+    }
+    if (mAttenuation) {
+        mAttenuation->applyToStress(response.mStress6);
+        mAttenuation->updateMemoryVariables(response.mStrain6);
+    }
+}
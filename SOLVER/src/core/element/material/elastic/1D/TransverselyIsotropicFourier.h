@@ -0,0 +1,43 @@
+// TransverselyIsotropicFourier.h
+// created by Kuangdai on 14-Oct-2026 
+// weakly 3D transversely isotropic material in Fourier space
+// moduli are expanded into a few azimuthal orders and applied to the 
+// Fourier strain as a banded convolution, skipping the FFT pair
+
+#pragma once
+
+#include "Elastic1D.h"
+#include "eigenc.h"
+
+class TransverselyIsotropicFourier: public Elastic1D {
+public:
+    // constructor
+    // moduli of order 0, 1, ..., K; negative orders are complex conjugates
+    TransverselyIsotropicFourier(const vec_CMatPP &A, const vec_CMatPP &C, const vec_CMatPP &F, 
+        const vec_CMatPP &L, const vec_CMatPP &N, bool isotropic, Attenuation1D *att):
+        Elastic1D(att), mA(A), mC(C), mF(F), mL(L), mN(N), mIsotropic(isotropic) {};
+    
+    // STEP 2: strain ==>>> stress
+    void strainToStress(SolidResponse &response) const;
+    
+    // verbose
+    std::string verbose() const {return "TransverselyIsotropicFourier";};
+    
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mA) * 5;};
+    
+    // need TIso
+    bool needTIso() const {return !mIsotropic;};
+    
+private:
+    
+    // Fourier coefficients of Cijkl scaled by integral factor
+    vec_CMatPP mA;
+    vec_CMatPP mC;
+    vec_CMatPP mF;
+    vec_CMatPP mL;
+    vec_CMatPP mN;
+    
+    // isotropic moduli are frame independent
+    bool mIsotropic;
+};
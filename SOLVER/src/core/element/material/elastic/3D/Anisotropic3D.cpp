@@ -7,50 +7,44 @@
 #include "SolidElement.h"
 #include "SolverFFTW_N6.h"
 
-void Anisotropic3D::strainToStress(SolidResponse &response) const {
-    int Nr = response.mNr;
-    const RMatXN6 &strainTIsoR = SolverFFTW_N6::getC2R_RMat();
-    RMatXN6 &stressTIsoR = SolverFFTW_N6::getR2C_RMat();
-    stressTIsoR.block(0, 0 * nPE, Nr, nPE) = mC11.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC12.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC13.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC14.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC15.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC16.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 1 * nPE, Nr, nPE) = mC12.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC22.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC23.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC24.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC25.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC26.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));    
-    stressTIsoR.block(0, 2 * nPE, Nr, nPE) = mC13.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC23.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC33.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC34.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC35.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC36.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 3 * nPE, Nr, nPE) = mC14.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC24.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC34.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC44.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC45.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC46.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 4 * nPE, Nr, nPE) = mC15.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC25.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC35.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC45.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC55.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC56.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));  
-    stressTIsoR.block(0, 5 * nPE, Nr, nPE) = mC16.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE))
-                                           + mC26.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE))
-                                           + mC36.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE))
-                                           + mC46.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE))
-                                           + mC56.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE))
-                                           + mC66.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));                                                                                                                     
-    if (mAttenuation) {
-        mAttenuation->applyToStress(stressTIsoR);
-        mAttenuation->updateMemoryVariables(strainTIsoR);
-    }
+void Anisotropic3D::strainToStressBlock(const RMatXN6 &strainTIsoR, RMatXN6 &stressTIsoR, 
+    int r0, int nr) const {
+    stressTIsoR.block(r0, 0 * nPE, nr, nPE) = mC11.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC12.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC13.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC14.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC15.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC16.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 1 * nPE, nr, nPE) = mC12.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC22.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC23.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC24.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC25.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC26.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));    
+    stressTIsoR.block(r0, 2 * nPE, nr, nPE) = mC13.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC23.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC33.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC34.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC35.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC36.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 3 * nPE, nr, nPE) = mC14.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC24.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC34.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC44.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC45.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC46.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 4 * nPE, nr, nPE) = mC15.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC25.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC35.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC45.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC55.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC56.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));  
+    stressTIsoR.block(r0, 5 * nPE, nr, nPE) = mC16.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE))
+                                            + mC26.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE))
+                                            + mC36.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE))
+                                            + mC46.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE))
+                                            + mC56.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE))
+                                            + mC66.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));
 }
 
 void Anisotropic3D::checkCompatibility(int Nr) const {
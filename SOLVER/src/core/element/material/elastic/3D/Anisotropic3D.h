@@ -24,18 +24,23 @@ public:
         mC55(C55), mC56(C56),
         mC66(C66) {};
         
-    // STEP 2: strain ==>>> stress
-    void strainToStress(SolidResponse &response) const;
-    
     // check compatibility
     void checkCompatibility(int Nr) const; 
     
     // verbose
     std::string verbose() const {return "Anisotropic3D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mC11) * 21;};
+    
     // need TIso
     bool needTIso() const {return true;};
     
+protected:
+    // STEP 2: strain ==>>> stress of rows r0 to r0 + nr
+    void strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+        int r0, int nr) const;
+    
 private:
     // Cijkl scaled by integral factor
     RMatXN mC11;
@@ -4,6 +4,13 @@
 
 #include "Elastic3D.h"
 #include "Attenuation3D.h"
+#include "Checkpoint.h"
+#include "PRT_3D.h"
+#include "SolidElement.h"
+#include "SolverFFTW_N6.h"
+#include "SolverFFTW_N9.h"
+
+const int Elastic3D::sNrBlock;
 
 Elastic3D::Elastic3D(Attenuation3D *att):
 mAttenuation(att) {
@@ -16,6 +23,44 @@ Elastic3D::~Elastic3D() {
     }
 }
 
+void Elastic3D::strainToStress(SolidResponse &response) const {
+    int Nr = response.mNr;
+    const RMatXN6 &strainR = SolverFFTW_N6::getC2R_RMat();
+    RMatXN6 &stressR = SolverFFTW_N6::getR2C_RMat();
+    for (int r0 = 0; r0 < Nr; r0 += sNrBlock) {
+        int nr = std::min(sNrBlock, Nr - r0);
+        strainToStressBlock(strainR, stressR, r0, nr);
+    }
+    if (mAttenuation) {
+        mAttenuation->applyAndUpdate(stressR, strainR);
+    }
+}
+
+void Elastic3D::strainToStress(SolidResponse &response, const PRT &prt) const {
+    // SolidElement ensures that prt lives in the same space
+    const PRT_3D &prt3D = static_cast<const PRT_3D &>(prt);
+    int Nr = response.mNr;
+    const RMatXN9 &strainSph = SolverFFTW_N9::getC2R_RMat();
+    RMatXN6 &strainR = SolverFFTW_N6::getC2R_RMat();
+    RMatXN6 &stressR = SolverFFTW_N6::getR2C_RMat();
+    RMatXN9 &stressSph = SolverFFTW_N9::getR2C_RMat();
+    // the undulation Jacobian is applied to a block while its strain 
+    // is still in cache; the stress of a block can be rotated back at once 
+    // only without attenuation, which needs the whole undulated fields
+    for (int r0 = 0; r0 < Nr; r0 += sNrBlock) {
+        int nr = std::min(sNrBlock, Nr - r0);
+        prt3D.sphericalToUndulated(strainSph, strainR, r0, nr);
+        strainToStressBlock(strainR, stressR, r0, nr);
+        if (!mAttenuation) {
+            prt3D.undulatedToSpherical(stressR, stressSph, r0, nr);
+        }
+    }
+    if (mAttenuation) {
+        mAttenuation->applyAndUpdate(stressR, strainR);
+        prt3D.undulatedToSpherical(stressR, stressSph, 0, Nr);
+    }
+}
+
 void Elastic3D::checkCompatibility(int Nr) const {
     if (mAttenuation) {
         mAttenuation->checkCompatibility(Nr);
@@ -27,3 +72,13 @@ void Elastic3D::resetZero() {
         mAttenuation->resetZero();
     }
 }
+
+void Elastic3D::syncState(Checkpoint &cp) {
+    if (mAttenuation) {
+        mAttenuation->syncState(cp);
+    }
+}
+
+size_t Elastic3D::attenuationBytes() const {
+    return mAttenuation ? mAttenuation->memoryBytes() : 0;
+}
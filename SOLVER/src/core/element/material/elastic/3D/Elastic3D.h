@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Elastic.h"
+#include "eigenc.h"
 
 class Attenuation3D;
 
@@ -13,15 +14,35 @@ public:
     Elastic3D(Attenuation3D *att);
     virtual ~Elastic3D();
     
+    // STEP 2: strain ==> stress, block by block
+    void strainToStress(SolidResponse &response) const;
+    
+    // STEP 2 with particle relabelling, fused into the same block loop
+    void strainToStress(SolidResponse &response, const PRT &prt) const;
+    
     // check compatibility
     virtual void checkCompatibility(int Nr) const; 
     
     // reset to zero 
     void resetZero(); 
     
+    // save or load memory variables 
+    void syncState(Checkpoint &cp);
+    
+    // bytes of the attenuation
+    size_t attenuationBytes() const;
+    
     // 1D or Fourier space
     bool is1D() const {return false;};
     
 protected:
+    // strain ==> stress of rows r0 to r0 + nr, without attenuation
+    virtual void strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+        int r0, int nr) const = 0;
+    
     Attenuation3D *mAttenuation;
+    
+    // strainToStress runs over blocks of this many azimuthal rows, so that 
+    // strain, stress and moduli of one block stay in L1 across components
+    static const int sNrBlock = 8;
 };
@@ -0,0 +1,71 @@
+// Hexagonal3D.cpp
+// created by Kuangdai on 14-Oct-2026 
+// hexagonal (tilted transversely isotropic) 3D material 
+// stored as 5 moduli plus symmetry axis instead of 21 Cijkl
+
+#include "Hexagonal3D.h"
+#include "Attenuation3D.h"
+#include "SolidElement.h"
+#include "SolverFFTW_N6.h"
+
+void Hexagonal3D::strainToStressBlock(const RMatXN6 &strainTIsoR, RMatXN6 &stressTIsoR, 
+    int r0, int nr) const {
+    int Nr = mLambda.rows();
+    int ldStrain = strainTIsoR.rows();
+    int ldStress = stressTIsoR.rows();
+    for (int ipnt = 0; ipnt < nPE; ipnt++) {
+        // moduli and axis are expanded into Cijkl point by point
+        const Real *lambda = mLambda.data() + ipnt * Nr;
+        const Real *mu = mMu.data() + ipnt * Nr;
+        const Real *mu2 = mMu2.data() + ipnt * Nr;
+        const Real *a = mA.data() + ipnt * Nr;
+        const Real *b = mB.data() + ipnt * Nr;
+        const Real *c2 = mC2.data() + ipnt * Nr;
+        const Real *n1 = mN1.data() + ipnt * Nr;
+        const Real *n2 = mN2.data() + ipnt * Nr;
+        const Real *n3 = mN3.data() + ipnt * Nr;
+        const Real *e0 = strainTIsoR.data() + (0 * nPE + ipnt) * ldStrain;
+        const Real *e1 = strainTIsoR.data() + (1 * nPE + ipnt) * ldStrain;
+        const Real *e2 = strainTIsoR.data() + (2 * nPE + ipnt) * ldStrain;
+        const Real *e3 = strainTIsoR.data() + (3 * nPE + ipnt) * ldStrain;
+        const Real *e4 = strainTIsoR.data() + (4 * nPE + ipnt) * ldStrain;
+        const Real *e5 = strainTIsoR.data() + (5 * nPE + ipnt) * ldStrain;
+        Real *s0 = stressTIsoR.data() + (0 * nPE + ipnt) * ldStress;
+        Real *s1 = stressTIsoR.data() + (1 * nPE + ipnt) * ldStress;
+        Real *s2 = stressTIsoR.data() + (2 * nPE + ipnt) * ldStress;
+        Real *s3 = stressTIsoR.data() + (3 * nPE + ipnt) * ldStress;
+        Real *s4 = stressTIsoR.data() + (4 * nPE + ipnt) * ldStress;
+        Real *s5 = stressTIsoR.data() + (5 * nPE + ipnt) * ldStress;
+        for (int ir = r0; ir < r0 + nr; ir++) {
+            // shear strains are engineering strains in Voigt notation
+            Real e23 = half * e3[ir];
+            Real e13 = half * e4[ir];
+            Real e12 = half * e5[ir];
+            Real tr = e0[ir] + e1[ir] + e2[ir];
+            // v = strain * n, q = n * strain * n
+            Real v1 = e0[ir] * n1[ir] + e12 * n2[ir] + e13 * n3[ir];
+            Real v2 = e12 * n1[ir] + e1[ir] * n2[ir] + e23 * n3[ir];
+            Real v3 = e13 * n1[ir] + e23 * n2[ir] + e2[ir] * n3[ir];
+            Real q = n1[ir] * v1 + n2[ir] * v2 + n3[ir] * v3;
+            // stress = (lambda tr + a q) I + 2 mu strain 
+            //        + (a tr + b q) n n^T + 2 c (v n^T + n v^T)
+            Real iso = lambda[ir] * tr + a[ir] * q;
+            Real nn = a[ir] * tr + b[ir] * q;
+            s0[ir] = iso + mu2[ir] * e0[ir] + nn * n1[ir] * n1[ir] + two * c2[ir] * v1 * n1[ir];
+            s1[ir] = iso + mu2[ir] * e1[ir] + nn * n2[ir] * n2[ir] + two * c2[ir] * v2 * n2[ir];
+            s2[ir] = iso + mu2[ir] * e2[ir] + nn * n3[ir] * n3[ir] + two * c2[ir] * v3 * n3[ir];
+            s3[ir] = mu[ir] * e3[ir] + nn * n2[ir] * n3[ir] + c2[ir] * (v2 * n3[ir] + v3 * n2[ir]);
+            s4[ir] = mu[ir] * e4[ir] + nn * n1[ir] * n3[ir] + c2[ir] * (v1 * n3[ir] + v3 * n1[ir]);
+            s5[ir] = mu[ir] * e5[ir] + nn * n1[ir] * n2[ir] + c2[ir] * (v1 * n2[ir] + v2 * n1[ir]);
+        }
+    }
+}
+
+void Hexagonal3D::checkCompatibility(int Nr) const {
+    Elastic3D::checkCompatibility(Nr);
+    int myNr = mLambda.rows();
+    if (Nr != myNr) {
+        throw std::runtime_error("Hexagonal3D::checkCompatibility || Incompatible size.");
+    }
+}
+
@@ -0,0 +1,52 @@
+// Hexagonal3D.h
+// created by Kuangdai on 14-Oct-2026 
+// hexagonal (tilted transversely isotropic) 3D material 
+// stored as 5 moduli plus symmetry axis instead of 21 Cijkl
+
+#pragma once
+
+#include "Elastic3D.h"
+#include "eigenc.h"
+
+class Hexagonal3D: public Elastic3D {
+public:
+    // constructor
+    // Cijkl = lambda d_ij d_kl + mu (d_ik d_jl + d_il d_jk) 
+    //       + a (d_ij n_k n_l + n_i n_j d_kl) + b n_i n_j n_k n_l
+    //       + c (d_ik n_j n_l + d_il n_j n_k + d_jk n_i n_l + d_jl n_i n_k)
+    Hexagonal3D(const RMatXN &lambda, const RMatXN &mu, 
+        const RMatXN &a, const RMatXN &b, const RMatXN &c, 
+        const RMatXN &n1, const RMatXN &n2, const RMatXN &n3, Attenuation3D *att):
+        Elastic3D(att), mLambda(lambda), mMu(mu), mMu2(two * mu), 
+        mA(a), mB(b), mC2(two * c), mN1(n1), mN2(n2), mN3(n3) {};
+        
+    // check compatibility
+    void checkCompatibility(int Nr) const; 
+    
+    // verbose
+    std::string verbose() const {return "Hexagonal3D";};
+    
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mLambda) * 9;};
+    
+    // need TIso
+    bool needTIso() const {return true;};
+    
+protected:
+    // STEP 2: strain ==>>> stress of rows r0 to r0 + nr
+    void strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+        int r0, int nr) const;
+    
+private:
+    // moduli scaled by integral factor
+    RMatXN mLambda;
+    RMatXN mMu;
+    RMatXN mMu2;
+    RMatXN mA;
+    RMatXN mB;
+    RMatXN mC2;
+    // symmetry axis
+    RMatXN mN1;
+    RMatXN mN2;
+    RMatXN mN3;
+};
@@ -7,24 +7,18 @@
 #include "SolidElement.h"
 #include "SolverFFTW_N6.h"
 
-void Isotropic3D::strainToStress(SolidResponse &response) const {
-    int Nr = response.mNr;
-    // to avoid dynamic allocation, use stressR.block(0, 3 * nPE, Nr, nPE) to store Sii
-    const RMatXN6 &strainR = SolverFFTW_N6::getC2R_RMat();
-    RMatXN6 &stressR = SolverFFTW_N6::getR2C_RMat();
-    stressR.block(0, 3 * nPE, Nr, nPE) = mLambda.schur(strainR.block(0, 0 * nPE, Nr, nPE) 
-                                                     + strainR.block(0, 1 * nPE, Nr, nPE) 
-                                                     + strainR.block(0, 2 * nPE, Nr, nPE));
-    stressR.block(0, 0 * nPE, Nr, nPE) = stressR.block(0, 3 * nPE, Nr, nPE) + mMu2.schur(strainR.block(0, 0 * nPE, Nr, nPE));
-    stressR.block(0, 1 * nPE, Nr, nPE) = stressR.block(0, 3 * nPE, Nr, nPE) + mMu2.schur(strainR.block(0, 1 * nPE, Nr, nPE));
-    stressR.block(0, 2 * nPE, Nr, nPE) = stressR.block(0, 3 * nPE, Nr, nPE) + mMu2.schur(strainR.block(0, 2 * nPE, Nr, nPE));
-    stressR.block(0, 3 * nPE, Nr, nPE) = mMu.schur(strainR.block(0, 3 * nPE, Nr, nPE));
-    stressR.block(0, 4 * nPE, Nr, nPE) = mMu.schur(strainR.block(0, 4 * nPE, Nr, nPE));
-    stressR.block(0, 5 * nPE, Nr, nPE) = mMu.schur(strainR.block(0, 5 * nPE, Nr, nPE));
-    if (mAttenuation) {
-        mAttenuation->applyToStress(stressR);
-        mAttenuation->updateMemoryVariables(strainR);
-    }
+void Isotropic3D::strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+    int r0, int nr) const {
+    // to avoid dynamic allocation, use stressR.block(r0, 3 * nPE, nr, nPE) to store Sii
+    stressR.block(r0, 3 * nPE, nr, nPE) = mLambda.middleRows(r0, nr).schur(strainR.block(r0, 0 * nPE, nr, nPE) 
+                                                                         + strainR.block(r0, 1 * nPE, nr, nPE) 
+                                                                         + strainR.block(r0, 2 * nPE, nr, nPE));
+    stressR.block(r0, 0 * nPE, nr, nPE) = stressR.block(r0, 3 * nPE, nr, nPE) + mMu2.middleRows(r0, nr).schur(strainR.block(r0, 0 * nPE, nr, nPE));
+    stressR.block(r0, 1 * nPE, nr, nPE) = stressR.block(r0, 3 * nPE, nr, nPE) + mMu2.middleRows(r0, nr).schur(strainR.block(r0, 1 * nPE, nr, nPE));
+    stressR.block(r0, 2 * nPE, nr, nPE) = stressR.block(r0, 3 * nPE, nr, nPE) + mMu2.middleRows(r0, nr).schur(strainR.block(r0, 2 * nPE, nr, nPE));
+    stressR.block(r0, 3 * nPE, nr, nPE) = mMu.middleRows(r0, nr).schur(strainR.block(r0, 3 * nPE, nr, nPE));
+    stressR.block(r0, 4 * nPE, nr, nPE) = mMu.middleRows(r0, nr).schur(strainR.block(r0, 4 * nPE, nr, nPE));
+    stressR.block(r0, 5 * nPE, nr, nPE) = mMu.middleRows(r0, nr).schur(strainR.block(r0, 5 * nPE, nr, nPE));
 }
 
 void Isotropic3D::checkCompatibility(int Nr) const {
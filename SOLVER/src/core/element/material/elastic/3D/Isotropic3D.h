@@ -13,18 +13,23 @@ public:
     Isotropic3D(const RMatXN &lambda, const RMatXN &mu, Attenuation3D *att):
         Elastic3D(att), mLambda(lambda), mMu(mu), mMu2(two * mu) {};
     
-    // STEP 2: strain ==>>> stress
-    void strainToStress(SolidResponse &response) const;
-    
     // check compatibility
     void checkCompatibility(int Nr) const; 
     
     // verbose
     std::string verbose() const {return "Isotropic3D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mLambda) * 3;};
+    
     // need TIso
     bool needTIso() const {return false;};
                 
+protected:
+    // STEP 2: strain ==>>> stress of rows r0 to r0 + nr
+    void strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+        int r0, int nr) const;
+    
 private:    
     // Cijkl scaled by integral factor
     RMatXN mLambda;
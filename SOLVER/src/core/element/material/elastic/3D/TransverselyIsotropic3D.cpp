@@ -7,24 +7,18 @@
 #include "SolidElement.h"
 #include "SolverFFTW_N6.h"
 
-void TransverselyIsotropic3D::strainToStress(SolidResponse &response) const {
-    int Nr = response.mNr;
-    // to avoid dynamic allocation, use stressTIsoR.block(0, 3&4 * nPE, Nr, nPE) as temp memory
-    const RMatXN6 &strainTIsoR = SolverFFTW_N6::getC2R_RMat();
-    RMatXN6 &stressTIsoR = SolverFFTW_N6::getR2C_RMat();
-    stressTIsoR.block(0, 3 * nPE, Nr, nPE) = strainTIsoR.block(0, 0 * nPE, Nr, nPE) + strainTIsoR.block(0, 1 * nPE, Nr, nPE);
-    stressTIsoR.block(0, 4 * nPE, Nr, nPE) = mA.schur(stressTIsoR.block(0, 3 * nPE, Nr, nPE)) + mF.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE));
+void TransverselyIsotropic3D::strainToStressBlock(const RMatXN6 &strainTIsoR, RMatXN6 &stressTIsoR, 
+    int r0, int nr) const {
+    // to avoid dynamic allocation, use stressTIsoR.block(r0, 3&4 * nPE, nr, nPE) as temp memory
+    stressTIsoR.block(r0, 3 * nPE, nr, nPE) = strainTIsoR.block(r0, 0 * nPE, nr, nPE) + strainTIsoR.block(r0, 1 * nPE, nr, nPE);
+    stressTIsoR.block(r0, 4 * nPE, nr, nPE) = mA.middleRows(r0, nr).schur(stressTIsoR.block(r0, 3 * nPE, nr, nPE)) + mF.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE));
     
-    stressTIsoR.block(0, 0 * nPE, Nr, nPE) = stressTIsoR.block(0, 4 * nPE, Nr, nPE) - mN2.schur(strainTIsoR.block(0, 1 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 1 * nPE, Nr, nPE) = stressTIsoR.block(0, 4 * nPE, Nr, nPE) - mN2.schur(strainTIsoR.block(0, 0 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 2 * nPE, Nr, nPE) = mC.schur(strainTIsoR.block(0, 2 * nPE, Nr, nPE)) + mF.schur(stressTIsoR.block(0, 3 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 3 * nPE, Nr, nPE) = mL.schur(strainTIsoR.block(0, 3 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 4 * nPE, Nr, nPE) = mL.schur(strainTIsoR.block(0, 4 * nPE, Nr, nPE));
-    stressTIsoR.block(0, 5 * nPE, Nr, nPE) = mN.schur(strainTIsoR.block(0, 5 * nPE, Nr, nPE));
-    if (mAttenuation) {
-        mAttenuation->applyToStress(stressTIsoR);
-        mAttenuation->updateMemoryVariables(strainTIsoR);
-    }
+    stressTIsoR.block(r0, 0 * nPE, nr, nPE) = stressTIsoR.block(r0, 4 * nPE, nr, nPE) - mN2.middleRows(r0, nr).schur(strainTIsoR.block(r0, 1 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 1 * nPE, nr, nPE) = stressTIsoR.block(r0, 4 * nPE, nr, nPE) - mN2.middleRows(r0, nr).schur(strainTIsoR.block(r0, 0 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 2 * nPE, nr, nPE) = mC.middleRows(r0, nr).schur(strainTIsoR.block(r0, 2 * nPE, nr, nPE)) + mF.middleRows(r0, nr).schur(stressTIsoR.block(r0, 3 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 3 * nPE, nr, nPE) = mL.middleRows(r0, nr).schur(strainTIsoR.block(r0, 3 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 4 * nPE, nr, nPE) = mL.middleRows(r0, nr).schur(strainTIsoR.block(r0, 4 * nPE, nr, nPE));
+    stressTIsoR.block(r0, 5 * nPE, nr, nPE) = mN.middleRows(r0, nr).schur(strainTIsoR.block(r0, 5 * nPE, nr, nPE));
 }
 
 void TransverselyIsotropic3D::checkCompatibility(int Nr) const {
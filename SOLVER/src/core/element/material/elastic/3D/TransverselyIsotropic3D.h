@@ -14,18 +14,23 @@ public:
         const RMatXN &L, const RMatXN &N, Attenuation3D *att):
         Elastic3D(att) , mA(A), mC(C), mF(F), mL(L), mN(N), mN2(two * N) {};
         
-    // STEP 2: strain ==>>> stress
-    void strainToStress(SolidResponse &response) const;
-    
     // check compatibility
     void checkCompatibility(int Nr) const; 
     
     // verbose
     std::string verbose() const {return "TransverselyIsotropic3D";};
     
+    // bytes of the moduli
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mA) * 6;};
+    
     // need TIso
     bool needTIso() const {return true;};
     
+protected:
+    // STEP 2: strain ==>>> stress of rows r0 to r0 + nr
+    void strainToStressBlock(const RMatXN6 &strainR, RMatXN6 &stressR, 
+        int r0, int nr) const;
+    
 private:
     // Cijkl scaled by integral factor
     RMatXN mA;
@@ -5,15 +5,40 @@
 #pragma once
 
 class SolidResponse;
+class Checkpoint;
 #include <string>
+#include <cstddef>
+#include <stdexcept>
+#include "PRT.h"
+#include "eigenc.h"
+#include "Arena.h"
 
-class Elastic {
+class Elastic: public ArenaObject {
 public:
     
     virtual ~Elastic() {};
     
     // STEP 2: strain ==> stress
     virtual void strainToStress(SolidResponse &response) const = 0;
+    
+    // STEP 2 with particle relabelling: spherical strain ==> undulated strain 
+    // ==> stress ==> spherical stress
+    virtual void strainToStress(SolidResponse &response, const PRT &prt) const {
+        prt.sphericalToUndulated(response);
+        strainToStress(response);
+        prt.undulatedToSpherical(response);
+    };
+    
+    // STEP 2 of the single mode alpha, attenuation included, for the loop 
+    // of SolidElement fused over the modes; only where fusedModes()
+    virtual bool fusedModes() const {return false;};
+    virtual void strainToStressMode(const ar6_CMatPP &strain, ar6_CMatPP &stress, int alpha) const {
+        throw std::runtime_error("Elastic::strainToStressMode || Not implemented.");
+    };
+    
+    // strainToStressMode is a real map independent of alpha and of time,
+    // as without attenuation, so that the stiffness can be precomputed
+    virtual bool linearModes() const {return false;};
         
     // check compatibility
     virtual void checkCompatibility(int Nr) const = 0; 
@@ -29,4 +54,11 @@ public:
     
     // reset to zero 
     virtual void resetZero() = 0; 
+    
+    // save or load memory variables 
+    virtual void syncState(Checkpoint &cp) = 0;
+    
+    // bytes of the moduli and of the attenuation, for memory reports
+    virtual size_t memoryBytes() const = 0;
+    virtual size_t attenuationBytes() const = 0;
 };
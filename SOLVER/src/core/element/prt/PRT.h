@@ -7,9 +7,11 @@
 class SolidResponse;
 class FluidResponse;
 #include <string>
+#include <cstddef>
 #include "eigenp.h"
+#include "Arena.h"
 
-class PRT {
+class PRT: public ArenaObject {
 public:
     
     virtual ~PRT() {};
@@ -26,5 +28,8 @@ public:
     virtual std::string verbose() const = 0;
     virtual bool is1D() const = 0;
     
+    // bytes of the relabelling factors, for memory reports
+    virtual size_t memoryBytes() const = 0;
+    
     virtual void checkCompatibility(int Nr) const {};
 };
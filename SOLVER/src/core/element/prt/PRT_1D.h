@@ -22,6 +22,9 @@ public:
     void sphericalToUndulated9(SolidResponse &response) const;
     
     std::string verbose() const {return "PRT_1D";};
+    
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this);};
     bool is1D() const {return true;};
 
 private:
@@ -39,50 +39,53 @@ void PRT_3D::undulatedToSpherical(FluidResponse &response) const {
 }
 
 void PRT_3D::sphericalToUndulated(SolidResponse &response) const {
-    int Nr = response.mNr;
-    const RMatXN9 &sph = SolverFFTW_N9::getC2R_RMat();
-    RMatXN6 &und = SolverFFTW_N6::getC2R_RMat();
-    und.block(0, nPE * 0, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 0, Nr, nPE))
-                                   + mXFlat1.schur(sph.block(0, nPE * 2, Nr, nPE));
-    und.block(0, nPE * 1, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 4, Nr, nPE))
-                                   + mXFlat2.schur(sph.block(0, nPE * 5, Nr, nPE));
-    und.block(0, nPE * 2, Nr, nPE) = mXFlat3.schur(sph.block(0, nPE * 8, Nr, nPE));
-    und.block(0, nPE * 3, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 7, Nr, nPE))
-                                   + mXFlat2.schur(sph.block(0, nPE * 8, Nr, nPE))
-                                   + mXFlat3.schur(sph.block(0, nPE * 5, Nr, nPE));
-    und.block(0, nPE * 4, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 6, Nr, nPE))
-                                   + mXFlat1.schur(sph.block(0, nPE * 8, Nr, nPE))
-                                   + mXFlat3.schur(sph.block(0, nPE * 2, Nr, nPE));
-    und.block(0, nPE * 5, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 3, Nr, nPE) 
-                                                 + sph.block(0, nPE * 1, Nr, nPE))
-                                   + mXFlat1.schur(sph.block(0, nPE * 5, Nr, nPE))
-                                   + mXFlat2.schur(sph.block(0, nPE * 2, Nr, nPE));
+    sphericalToUndulated(SolverFFTW_N9::getC2R_RMat(), SolverFFTW_N6::getC2R_RMat(), 0, response.mNr);
 }
 
-void PRT_3D::undulatedToSpherical(SolidResponse &response) const{
-    int Nr = response.mNr;
-    const RMatXN6 &und = SolverFFTW_N6::getR2C_RMat();
-    RMatXN9 &sph = SolverFFTW_N9::getR2C_RMat();
-    sph.block(0, nPE * 0, Nr, nPE) = mXFlat0.schur(und.block(0, nPE * 0, Nr, nPE));
-    sph.block(0, nPE * 1, Nr, nPE) = mXFlat0.schur(und.block(0, nPE * 5, Nr, nPE));
-    sph.block(0, nPE * 2, Nr, nPE) = mXFlat1.schur(und.block(0, nPE * 0, Nr, nPE)) 
-                                   + mXFlat3.schur(und.block(0, nPE * 4, Nr, nPE))
-                                   + mXFlat2.schur(und.block(0, nPE * 5, Nr, nPE));
-    sph.block(0, nPE * 3, Nr, nPE) = sph.block(0, nPE * 1, Nr, nPE);                                  
-    sph.block(0, nPE * 4, Nr, nPE) = mXFlat0.schur(und.block(0, nPE * 1, Nr, nPE));
-    sph.block(0, nPE * 5, Nr, nPE) = mXFlat2.schur(und.block(0, nPE * 1, Nr, nPE)) 
-                                   + mXFlat3.schur(und.block(0, nPE * 3, Nr, nPE))
-                                   + mXFlat1.schur(und.block(0, nPE * 5, Nr, nPE));
-    sph.block(0, nPE * 6, Nr, nPE) = mXFlat0.schur(und.block(0, nPE * 4, Nr, nPE));
-    sph.block(0, nPE * 7, Nr, nPE) = mXFlat0.schur(und.block(0, nPE * 3, Nr, nPE));
-    sph.block(0, nPE * 8, Nr, nPE) = mXFlat3.schur(und.block(0, nPE * 2, Nr, nPE)) 
-                                   + mXFlat2.schur(und.block(0, nPE * 3, Nr, nPE))
-                                   + mXFlat1.schur(und.block(0, nPE * 4, Nr, nPE));
+void PRT_3D::undulatedToSpherical(SolidResponse &response) const {
+    undulatedToSpherical(SolverFFTW_N6::getR2C_RMat(), SolverFFTW_N9::getR2C_RMat(), 0, response.mNr);
+}
+
+void PRT_3D::sphericalToUndulated(const RMatXN9 &sph, RMatXN6 &und, int r0, int nr) const {
+    und.block(r0, nPE * 0, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(sph.block(r0, nPE * 0, nr, nPE))
+                                    + mXFlat1.middleRows(r0, nr).schur(sph.block(r0, nPE * 2, nr, nPE));
+    und.block(r0, nPE * 1, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(sph.block(r0, nPE * 4, nr, nPE))
+                                    + mXFlat2.middleRows(r0, nr).schur(sph.block(r0, nPE * 5, nr, nPE));
+    und.block(r0, nPE * 2, nr, nPE) = mXFlat3.middleRows(r0, nr).schur(sph.block(r0, nPE * 8, nr, nPE));
+    und.block(r0, nPE * 3, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(sph.block(r0, nPE * 7, nr, nPE))
+                                    + mXFlat2.middleRows(r0, nr).schur(sph.block(r0, nPE * 8, nr, nPE))
+                                    + mXFlat3.middleRows(r0, nr).schur(sph.block(r0, nPE * 5, nr, nPE));
+    und.block(r0, nPE * 4, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(sph.block(r0, nPE * 6, nr, nPE))
+                                    + mXFlat1.middleRows(r0, nr).schur(sph.block(r0, nPE * 8, nr, nPE))
+                                    + mXFlat3.middleRows(r0, nr).schur(sph.block(r0, nPE * 2, nr, nPE));
+    und.block(r0, nPE * 5, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(sph.block(r0, nPE * 3, nr, nPE) 
+                                                                   + sph.block(r0, nPE * 1, nr, nPE))
+                                    + mXFlat1.middleRows(r0, nr).schur(sph.block(r0, nPE * 5, nr, nPE))
+                                    + mXFlat2.middleRows(r0, nr).schur(sph.block(r0, nPE * 2, nr, nPE));
+}
+
+void PRT_3D::undulatedToSpherical(const RMatXN6 &und, RMatXN9 &sph, int r0, int nr) const {
+    sph.block(r0, nPE * 0, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(und.block(r0, nPE * 0, nr, nPE));
+    sph.block(r0, nPE * 1, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(und.block(r0, nPE * 5, nr, nPE));
+    sph.block(r0, nPE * 2, nr, nPE) = mXFlat1.middleRows(r0, nr).schur(und.block(r0, nPE * 0, nr, nPE)) 
+                                    + mXFlat3.middleRows(r0, nr).schur(und.block(r0, nPE * 4, nr, nPE))
+                                    + mXFlat2.middleRows(r0, nr).schur(und.block(r0, nPE * 5, nr, nPE));
+    sph.block(r0, nPE * 3, nr, nPE) = sph.block(r0, nPE * 1, nr, nPE);                                  
+    sph.block(r0, nPE * 4, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(und.block(r0, nPE * 1, nr, nPE));
+    sph.block(r0, nPE * 5, nr, nPE) = mXFlat2.middleRows(r0, nr).schur(und.block(r0, nPE * 1, nr, nPE)) 
+                                    + mXFlat3.middleRows(r0, nr).schur(und.block(r0, nPE * 3, nr, nPE))
+                                    + mXFlat1.middleRows(r0, nr).schur(und.block(r0, nPE * 5, nr, nPE));
+    sph.block(r0, nPE * 6, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(und.block(r0, nPE * 4, nr, nPE));
+    sph.block(r0, nPE * 7, nr, nPE) = mXFlat0.middleRows(r0, nr).schur(und.block(r0, nPE * 3, nr, nPE));
+    sph.block(r0, nPE * 8, nr, nPE) = mXFlat3.middleRows(r0, nr).schur(und.block(r0, nPE * 2, nr, nPE)) 
+                                    + mXFlat2.middleRows(r0, nr).schur(und.block(r0, nPE * 3, nr, nPE))
+                                    + mXFlat1.middleRows(r0, nr).schur(und.block(r0, nPE * 4, nr, nPE));
 }
 
 void PRT_3D::sphericalToUndulated9(SolidResponse &response) const {
     int Nr = response.mNr;
-    RMatXN9 &sph = SolverFFTW_N9::getC2R_RMat();
+    // output left in SolverFFTW_N9::getR2C_RMat, as input of transformP2F
+    const RMatXN9 &sph = SolverFFTW_N9::getC2R_RMat();
     RMatXN9 &und = SolverFFTW_N9::getR2C_RMat();
     und.block(0, nPE * 0, Nr, nPE) = mXFlat0.schur(sph.block(0, nPE * 0, Nr, nPE))
                                    + mXFlat1.schur(sph.block(0, nPE * 2, Nr, nPE));
@@ -99,8 +102,6 @@ void PRT_3D::sphericalToUndulated9(SolidResponse &response) const {
     und.block(0, nPE * 6, Nr, nPE) = mXFlat3.schur(sph.block(0, nPE * 2, Nr, nPE));
     und.block(0, nPE * 7, Nr, nPE) = mXFlat3.schur(sph.block(0, nPE * 5, Nr, nPE));
     und.block(0, nPE * 8, Nr, nPE) = mXFlat3.schur(sph.block(0, nPE * 8, Nr, nPE));
-    // replace
-    sph.block(0, 0, Nr, nPE * 9) = und.block(0, 0, Nr, nPE * 9);
 }
 
 void PRT_3D::checkCompatibility(int Nr) const{
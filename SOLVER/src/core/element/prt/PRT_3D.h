@@ -21,7 +21,14 @@ public:
     // 9 to 9, for curl computation
     void sphericalToUndulated9(SolidResponse &response) const;
     
+    // rows r0 to r0 + nr only, for the block loop of Elastic3D
+    void sphericalToUndulated(const RMatXN9 &sph, RMatXN6 &und, int r0, int nr) const;
+    void undulatedToSpherical(const RMatXN6 &und, RMatXN9 &sph, int r0, int nr) const;
+    
     std::string verbose() const {return "PRT_3D";};
+    
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mXFlat0) * 4;};
     bool is1D() const {return false;};
     
     void checkCompatibility(int Nr) const;
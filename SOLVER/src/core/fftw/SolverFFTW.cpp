@@ -4,12 +4,18 @@
 
 #include "SolverFFTW.h"
 #include "XMPI.h"
+#include "XOMP.h"
 
 #include <fstream>
 #include <sstream>
+#include <cstdlib>
 
 unsigned SolverFFTW::mWisdomLearnOption = FFTW_PATIENT;
 bool SolverFFTW::mDisableWisdom = false; 
+int SolverFFTW::sNumThreads = 1;
+int SolverFFTW::sNrThreadsThreshold = 0;
+std::vector<RMatXX> SolverFFTW::sDirectCos = SolverFFTW::formDirectTable(true);
+std::vector<RMatXX> SolverFFTW::sDirectSin = SolverFFTW::formDirectTable(false);
 
 void SolverFFTW::importWisdom(bool disableWisdom) {
     mDisableWisdom = disableWisdom;
@@ -63,3 +69,106 @@ void SolverFFTW::exportWisdom() {
     }
 }
 
+void SolverFFTW::shareWisdom() {
+    if (mDisableWisdom) {
+        return;
+    }
+    
+    std::string wisdomstr = "";
+    if (XMPI::root()) {
+        #ifdef _USE_DOUBLE
+            char *wisdom = fftw_export_wisdom_to_string();
+        #else
+            char *wisdom = fftwf_export_wisdom_to_string();
+        #endif
+        if (wisdom) {
+            wisdomstr = wisdom;
+            free(wisdom);
+        }
+    }
+    XMPI::bcast(wisdomstr);
+    if (!XMPI::root()) {
+        if (wisdomstr.length() > 0) {
+            #ifdef _USE_DOUBLE
+                fftw_import_wisdom_from_string(wisdomstr.c_str());
+            #else
+                fftwf_import_wisdom_from_string(wisdomstr.c_str());
+            #endif
+        }
+        mWisdomLearnOption |= FFTW_WISDOM_ONLY;
+    }
+}
+
+void SolverFFTW::initThreads(int nthreads, int nrThreshold) {
+    #ifdef _USE_FFTW_THREADS
+        if (nthreads > 1 && nrThreshold > 0 && XOMP::nThreads() == 1) {
+            if (initThreadsFFTW() == 0) {
+                throw std::runtime_error("SolverFFTW::initThreads || "
+                    "Error initializing FFTW threads.");
+            }
+            sNumThreads = nthreads;
+            sNrThreadsThreshold = nrThreshold;
+        }
+    #endif
+}
+
+void SolverFFTW::finalizeThreads() {
+    #ifdef _USE_FFTW_THREADS
+        if (sNumThreads > 1) {
+            cleanupThreadsFFTW();
+        }
+    #endif
+    sNumThreads = 1;
+    sNrThreadsThreshold = 0;
+}
+
+size_t SolverFFTW::memoryBytes() {
+    size_t bytes = 0;
+    for (int i = 0; i < sDirectCos.size(); i++) {
+        bytes += heapBytes(sDirectCos[i]) + heapBytes(sDirectSin[i]);
+    }
+    return bytes;
+}
+
+void SolverFFTW::planThreads(int nr) {
+    #ifdef _USE_FFTW_THREADS
+        if (sNumThreads > 1) {
+            planWithNThreadsFFTW(nr >= sNrThreadsThreshold ? sNumThreads : 1);
+        }
+    #endif
+}
+
+PlanFFTW SolverFFTW::planR2C(int nr, int howmany, Real *r, int rdist, Complex *c, int cdist, int cstride) {
+    planThreads(nr);
+    int n[] = {nr};
+    PlanFFTW plan = planR2CFFTW(1, n, howmany, r, n, 1, rdist, complexFFTW(c), n, cstride, cdist, mWisdomLearnOption);
+    if (!plan) {
+        plan = planR2CFFTW(1, n, howmany, r, n, 1, rdist, complexFFTW(c), n, cstride, cdist, FFTW_ESTIMATE);
+    }
+    return plan;
+}
+
+PlanFFTW SolverFFTW::planC2R(int nr, int howmany, Complex *c, int cdist, Real *r, int rdist, int cstride) {
+    planThreads(nr);
+    int n[] = {nr};
+    PlanFFTW plan = planC2RFFTW(1, n, howmany, complexFFTW(c), n, cstride, cdist, r, n, 1, rdist, mWisdomLearnOption);
+    if (!plan) {
+        plan = planC2RFFTW(1, n, howmany, complexFFTW(c), n, cstride, cdist, r, n, 1, rdist, FFTW_ESTIMATE);
+    }
+    return plan;
+}
+
+std::vector<RMatXX> SolverFFTW::formDirectTable(bool cosine) {
+    std::vector<RMatXX> table(sMaxNrDirect + 1);
+    for (int nr = 1; nr <= sMaxNrDirect; nr++) {
+        table[nr] = RMatXX(nr / 2 + 1, nr);
+        for (int k = 0; k < nr / 2 + 1; k++) {
+            for (int j = 0; j < nr; j++) {
+                double arg = 2. * pi * j * k / nr;
+                table[nr](k, j) = (Real)(cosine ? cos(arg) : sin(arg));
+            }
+        }
+    }
+    return table;
+}
+
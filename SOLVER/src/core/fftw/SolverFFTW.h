@@ -6,6 +6,7 @@
 
 #include <fftw3.h>
 #include <vector>
+#include <chrono>
 #include "eigenc.h"
 
 #ifdef _USE_DOUBLE
@@ -15,6 +16,11 @@
     #define planC2RFFTW fftw_plan_many_dft_c2r
     #define distroyFFTW fftw_destroy_plan
     #define execFFTW fftw_execute
+    #define execR2CFFTW fftw_execute_dft_r2c
+    #define alignmentFFTW fftw_alignment_of
+    #define initThreadsFFTW fftw_init_threads
+    #define planWithNThreadsFFTW fftw_plan_with_nthreads
+    #define cleanupThreadsFFTW fftw_cleanup_threads
 #else
     typedef fftwf_plan PlanFFTW;
     #define complexFFTW reinterpret_cast<fftwf_complex*>
@@ -22,14 +28,202 @@
     #define planC2RFFTW fftwf_plan_many_dft_c2r
     #define distroyFFTW fftwf_destroy_plan
     #define execFFTW fftwf_execute
+    #define execR2CFFTW fftwf_execute_dft_r2c
+    #define alignmentFFTW fftwf_alignment_of
+    #define initThreadsFFTW fftwf_init_threads
+    #define planWithNThreadsFFTW fftwf_plan_with_nthreads
+    #define cleanupThreadsFFTW fftwf_cleanup_threads
 #endif
 
 class SolverFFTW {
 public:
     static void importWisdom(bool disableWisdom);
     static void exportWisdom();    
+    // broadcast the wisdom learned on root, so that the other ranks 
+    // create their plans from wisdom only
+    static void shareWisdom();
     static unsigned mWisdomLearnOption;
     
+    // run plans of nr >= nrThreshold on nthreads threads; call before
+    // any plan is created; ignored without _USE_FFTW_THREADS or when 
+    // elements are already looped over by OpenMP threads
+    static void initThreads(int nthreads, int nrThreshold);
+    static void finalizeThreads();
+    
+    // bytes of the direct-transform tables, for memory reports
+    static size_t memoryBytes();
+    
+    // create plans with mWisdomLearnOption, or with FFTW_ESTIMATE 
+    // if plan creation from wisdom only fails
+    // real input or output is contiguous along nr; complex along nr is strided 
+    // by cstride, as in the row-major structured buffers of SolverFFTW_N*
+    static PlanFFTW planR2C(int nr, int howmany, Real *r, int rdist, Complex *c, int cdist, int cstride = 1);
+    static PlanFFTW planC2R(int nr, int howmany, Complex *c, int cdist, Real *r, int rdist, int cstride = 1);
+    
+    // transform backends, chosen per nr
+    // all have the same scaling as fftw-based computeR2C (normalized) 
+    // and computeC2R (unnormalized)
+    enum Backend {
+        BackendFFTW,
+        BackendClosedForm,
+        BackendDirect
+    };
+    
+    // closed-form transforms for nr <= 4, where the cost of a fftw call 
+    // exceeds that of the transform itself
+    // return false if nr is too large
+    static const int sMaxNrClosedForm = 4;
+    template<class RMat, class CMat>
+    static bool closedFormR2C(int nr, const RMat &r, CMat &c) {
+        const Real sqrt3_2 = (Real)(.5 * sqrt(3.));
+        switch (nr) {
+            case 1:
+                c.row(0).real() = r.row(0);
+                c.row(0).imag().setZero();
+                return true;
+            case 2:
+                c.row(0).real() = half * (r.row(0) + r.row(1));
+                c.row(1).real() = half * (r.row(0) - r.row(1));
+                c.row(0).imag().setZero();
+                c.row(1).imag().setZero();
+                return true;
+            case 3:
+                c.row(0).real() = third * (r.row(0) + r.row(1) + r.row(2));
+                c.row(1).real() = third * (r.row(0) - half * (r.row(1) + r.row(2)));
+                c.row(1).imag() = (- third * sqrt3_2) * (r.row(1) - r.row(2));
+                c.row(0).imag().setZero();
+                return true;
+            case 4:
+                c.row(0).real() = (half * half) * (r.row(0) + r.row(1) + r.row(2) + r.row(3));
+                c.row(1).real() = (half * half) * (r.row(0) - r.row(2));
+                c.row(1).imag() = (half * half) * (r.row(3) - r.row(1));
+                c.row(2).real() = (half * half) * (r.row(0) - r.row(1) + r.row(2) - r.row(3));
+                c.row(0).imag().setZero();
+                c.row(2).imag().setZero();
+                return true;
+            default:
+                return false;
+        }
+    };
+    
+    template<class RMat, class CMat>
+    static bool closedFormC2R(int nr, const CMat &c, RMat &r) {
+        const Real sqrt3 = (Real)sqrt(3.);
+        switch (nr) {
+            case 1:
+                r.row(0) = c.row(0).real();
+                return true;
+            case 2:
+                r.row(0) = c.row(0).real() + c.row(1).real();
+                r.row(1) = c.row(0).real() - c.row(1).real();
+                return true;
+            case 3:
+                r.row(0) = c.row(0).real() + two * c.row(1).real();
+                r.row(1) = c.row(0).real() - c.row(1).real() - sqrt3 * c.row(1).imag();
+                r.row(2) = c.row(0).real() - c.row(1).real() + sqrt3 * c.row(1).imag();
+                return true;
+            case 4:
+                r.row(0) = c.row(0).real() + c.row(2).real() + two * c.row(1).real();
+                r.row(1) = c.row(0).real() - c.row(2).real() - two * c.row(1).imag();
+                r.row(2) = c.row(0).real() + c.row(2).real() - two * c.row(1).real();
+                r.row(3) = c.row(0).real() - c.row(2).real() + two * c.row(1).imag();
+                return true;
+            default:
+                return false;
+        }
+    };
+    
+    // direct summation for nr <= 12 with tabulated cos(2 pi jk / nr) and 
+    // sin(2 pi jk / nr); faster than fftw for some small nr, see chooseBackend
+    // pruned to the lowest nc modes: modes from nc on are ignored on input 
+    // and zeroed on output
+    static const int sMaxNrDirect = 12;
+    template<class RMat, class CMat>
+    static void directR2C(int nr, const RMat &r, CMat &c, int nc) {
+        const RMatXX &cs = sDirectCos[nr];
+        const RMatXX &sn = sDirectSin[nr];
+        const Real inv_nr = one / (Real)nr;
+        for (int k = nc; k < nr / 2 + 1; k++) {
+            c.row(k).setZero();
+        }
+        for (int k = 0; k < nc; k++) {
+            c.row(k).real() = (cs(k, 0) * inv_nr) * r.row(0);
+            c.row(k).imag().setZero();
+            for (int j = 1; j < nr; j++) {
+                c.row(k).real() += (cs(k, j) * inv_nr) * r.row(j);
+                c.row(k).imag() -= (sn(k, j) * inv_nr) * r.row(j);
+            }
+        }
+    };
+    
+    // the imaginary part vanishes for pure cosine series and the real part 
+    // for pure sine series, as seen with monopole and dipole sources
+    template<class RMat, class CMat>
+    static void directC2R(int nr, const CMat &c, RMat &r, int nc) {
+        const RMatXX &cs = sDirectCos[nr];
+        const RMatXX &sn = sDirectSin[nr];
+        bool cosine = (c.topRows(nc).imag().array() == zero).all();
+        bool sine = (c.topRows(nc).real().array() == zero).all();
+        for (int j = 0; j < nr; j++) {
+            r.row(j).setZero();
+            for (int k = 0; k < nc; k++) {
+                // hermitian weight
+                Real w = (k == 0 || 2 * k == nr) ? one : two;
+                if (!sine) {
+                    r.row(j) += (w * cs(k, j)) * c.row(k).real();
+                }
+                if (!cosine) {
+                    r.row(j) -= (w * sn(k, j)) * c.row(k).imag();
+                }
+            }
+        }
+    };
+    
+    // modes carried through element transforms: the Nyquist mode of 
+    // an even nr is masked by Gradient on input and discarded on output
+    static int numModesPruned(int nr) {
+        return nr / 2 + 1 - (int)(nr % 2 == 0);
+    };
+    
+    // time fftw against direct summation on the given plans and buffers
+    template<class RMat, class CMat>
+    static Backend chooseBackend(int nr, PlanFFTW r2c, PlanFFTW c2r, 
+        RMat &r2c_r, CMat &r2c_c, RMat &c2r_r, CMat &c2r_c) {
+        if (nr <= sMaxNrClosedForm) {
+            return BackendClosedForm;
+        }
+        if (nr > sMaxNrDirect) {
+            return BackendFFTW;
+        }
+        // nonzero real and imaginary parts, avoiding the shortcuts in directC2R
+        r2c_r.setOnes();
+        c2r_c.setConstant(Complex(one, one));
+        const int nrep = 20;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int irep = 0; irep < nrep; irep++) {
+            execFFTW(r2c);
+            execFFTW(c2r);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        // fftw c2r destroys its input
+        c2r_c.setConstant(Complex(one, one));
+        for (int irep = 0; irep < nrep; irep++) {
+            directR2C(nr, r2c_r, r2c_c, numModesPruned(nr));
+            directC2R(nr, c2r_c, c2r_r, numModesPruned(nr));
+        }
+        auto t2 = std::chrono::high_resolution_clock::now();
+        return (t2 - t1 < t1 - t0) ? BackendDirect : BackendFFTW;
+    };
+    
 private:    
     static bool mDisableWisdom; 
+    
+    // threaded plans
+    static int sNumThreads;
+    static int sNrThreadsThreshold;
+    static void planThreads(int nr);
+    
+    static std::vector<RMatXX> formDirectTable(bool cosine);
+    static std::vector<RMatXX> sDirectCos;
+    static std::vector<RMatXX> sDirectSin;
 };
@@ -8,10 +8,12 @@
 
 class SolverFFTW_1 {
 public:
-    // initialize plans
-    static void initialize(int Nmax);
+    // initialize plans for the given nr, with buffers sized by Nmax
+    static void initialize(int Nmax, const std::vector<int> &NRs);
     // finalize plans
     static void finalize();
+    // bytes of the buffers, for memory reports
+    static size_t memoryBytes();
     
     // get input and output
     static RColX &getR2C_RMat() {return sR2C_RMat;};
@@ -12,32 +12,38 @@ CMatX3 SolverFFTW_3::sR2C_CMat;
 RMatX3 SolverFFTW_3::sC2R_RMat;
 CMatX3 SolverFFTW_3::sC2R_CMat;
 
-void SolverFFTW_3::initialize(int Nmax) {
+void SolverFFTW_3::initialize(int Nmax, const std::vector<int> &NRs) {
     int xx = 3;
     sNmax = Nmax;
-    sR2CPlans.reserve(Nmax);
-    sC2RPlans.reserve(Nmax);
-    sR2C_RMat = RMatX3(Nmax, xx);
-    sR2C_CMat = CMatX3(Nmax / 2 + 1, xx);
-    sC2R_RMat = RMatX3(Nmax, xx);
-    sC2R_CMat = CMatX3(Nmax / 2 + 1, xx);
-    for (int NR = 1; NR <= Nmax; NR++) {
-        int NC = NR / 2 + 1;
-        int n[] = {NR};
+    // leading dimensions padded for aligned columns
+    int ldr = paddedRows<Real>(Nmax);
+    int ldc = paddedRows<Complex>(Nmax / 2 + 1);
+    // plans only for the nr present in mesh; null elsewhere
+    sR2CPlans = std::vector<PlanFFTW>(Nmax, nullptr);
+    sC2RPlans = std::vector<PlanFFTW>(Nmax, nullptr);
+    sR2C_RMat = RMatX3(ldr, xx);
+    sR2C_CMat = CMatX3(ldc, xx);
+    sC2R_RMat = RMatX3(ldr, xx);
+    sC2R_CMat = CMatX3(ldc, xx);
+    for (int NR: NRs) {
         Real *r2c_r = &(sR2C_RMat(0, 0));
         Complex *r2c_c = &(sR2C_CMat(0, 0));
-        sR2CPlans.push_back(planR2CFFTW(1, n, xx, r2c_r, n, 1, Nmax, complexFFTW(r2c_c), n, 1, Nmax / 2 + 1, SolverFFTW::mWisdomLearnOption));   
+        sR2CPlans[NR - 1] = SolverFFTW::planR2C(NR, xx, r2c_r, ldr, r2c_c, ldc);
         Real *c2r_r = &(sC2R_RMat(0, 0));
         Complex *c2r_c = &(sC2R_CMat(0, 0));
-        sC2RPlans.push_back(planC2RFFTW(1, n, xx, complexFFTW(c2r_c), n, 1, Nmax / 2 + 1, c2r_r, n, 1, Nmax, SolverFFTW::mWisdomLearnOption)); 
+        sC2RPlans[NR - 1] = SolverFFTW::planC2R(NR, xx, c2r_c, ldc, c2r_r, ldr);
     }
 }
 
 void SolverFFTW_3::finalize() {
     for (int i = 0; i < sNmax; i++) {
-        distroyFFTW(sR2CPlans[i]);
-        distroyFFTW(sC2RPlans[i]);
+        if (sR2CPlans[i]) {
+            distroyFFTW(sR2CPlans[i]);
+            distroyFFTW(sC2RPlans[i]);
+        }
     }
+    sR2CPlans.clear();
+    sC2RPlans.clear();
     sNmax = 0;
 }
 
@@ -50,3 +56,8 @@ void SolverFFTW_3::computeR2C(int nr) {
 void SolverFFTW_3::computeC2R(int nr) {
     execFFTW(sC2RPlans[nr - 1]);
 }
+
+size_t SolverFFTW_3::memoryBytes() {
+    return heapBytes(sR2C_RMat) + heapBytes(sR2C_CMat) + 
+        heapBytes(sC2R_RMat) + heapBytes(sC2R_CMat);
+}
@@ -5,49 +5,124 @@
 #include "SolverFFTW_N3.h"
 
 int SolverFFTW_N3::sNmax = 0;
-std::vector<PlanFFTW> SolverFFTW_N3::sR2CPlans;
-std::vector<PlanFFTW> SolverFFTW_N3::sC2RPlans;
-RMatXN3 SolverFFTW_N3::sR2C_RMat;
-CMatXN3 SolverFFTW_N3::sR2C_CMat;
-RMatXN3 SolverFFTW_N3::sC2R_RMat;
-CMatXN3 SolverFFTW_N3::sC2R_CMat;
+std::vector<std::vector<PlanFFTW>> SolverFFTW_N3::sR2CPlans;
+std::vector<std::vector<PlanFFTW>> SolverFFTW_N3::sC2RPlans;
+std::vector<SolverFFTW::Backend> SolverFFTW_N3::sBackends;
+bool SolverFFTW_N3::sSameAlignment = false;
+std::vector<RMatXN3> SolverFFTW_N3::sR2C_RMat;
+std::vector<vec_ar3_CMatPP> SolverFFTW_N3::sR2C_CMat;
+std::vector<RMatXN3> SolverFFTW_N3::sC2R_RMat;
+std::vector<vec_ar3_CMatPP> SolverFFTW_N3::sC2R_CMat;
 
-void SolverFFTW_N3::initialize(int Nmax) {
+void SolverFFTW_N3::initialize(int Nmax, const std::vector<int> &NRs) {
     int ndim = 3;
     int xx = nPntElem * ndim;
+    int nthreads = XOMP::nThreads();
     sNmax = Nmax;
-    sR2CPlans.reserve(Nmax);
-    sC2RPlans.reserve(Nmax);
-    sR2C_RMat = RMatXN3(Nmax, xx);
-    sR2C_CMat = CMatXN3(Nmax / 2 + 1, xx);
-    sC2R_RMat = RMatXN3(Nmax, xx);
-    sC2R_CMat = CMatXN3(Nmax / 2 + 1, xx);
-    for (int NR = 1; NR <= Nmax; NR++) {
-        int NC = NR / 2 + 1;
-        int n[] = {NR};
-        Real *r2c_r = &(sR2C_RMat(0, 0));
-        Complex *r2c_c = &(sR2C_CMat(0, 0));
-        sR2CPlans.push_back(planR2CFFTW(1, n, xx, r2c_r, n, 1, Nmax, complexFFTW(r2c_c), n, 1, Nmax / 2 + 1, SolverFFTW::mWisdomLearnOption));   
-        Real *c2r_r = &(sC2R_RMat(0, 0));
-        Complex *c2r_c = &(sC2R_CMat(0, 0));
-        sC2RPlans.push_back(planC2RFFTW(1, n, xx, complexFFTW(c2r_c), n, 1, Nmax / 2 + 1, c2r_r, n, 1, Nmax, SolverFFTW::mWisdomLearnOption)); 
+    // leading dimension padded for aligned columns
+    int ldr = paddedRows<Real>(Nmax);
+    // Fourier modes are rows of the structured buffers, strided by xx
+    int nc = Nmax / 2 + 1;
+    sR2CPlans = std::vector<std::vector<PlanFFTW>>(nthreads);
+    sC2RPlans = std::vector<std::vector<PlanFFTW>>(nthreads);
+    sR2C_RMat = std::vector<RMatXN3>(nthreads, RMatXN3(ldr, xx));
+    sR2C_CMat = std::vector<vec_ar3_CMatPP>(nthreads, vec_ar3_CMatPP(nc, zero_ar3_CMatPP));
+    sC2R_RMat = std::vector<RMatXN3>(nthreads, RMatXN3(ldr, xx));
+    sC2R_CMat = std::vector<vec_ar3_CMatPP>(nthreads, vec_ar3_CMatPP(nc, zero_ar3_CMatPP));
+    // plans are created serially; fftw planner is not thread-safe
+    for (int tid = 0; tid < nthreads; tid++) {
+        // plans only for the nr present in mesh; null elsewhere
+        sR2CPlans[tid] = std::vector<PlanFFTW>(Nmax, nullptr);
+        sC2RPlans[tid] = std::vector<PlanFFTW>(Nmax, nullptr);
+        for (int NR: NRs) {
+            if (NR <= SolverFFTW::sMaxNrClosedForm) {
+                // handled in closed form
+                continue;
+            }
+            Real *r2c_r = &(sR2C_RMat[tid](0, 0));
+            Complex *r2c_c = sR2C_CMat[tid][0][0].data();
+            sR2CPlans[tid][NR - 1] = SolverFFTW::planR2C(NR, xx, r2c_r, ldr, r2c_c, 1, xx);
+            Real *c2r_r = &(sC2R_RMat[tid](0, 0));
+            Complex *c2r_c = sC2R_CMat[tid][0][0].data();
+            sC2RPlans[tid][NR - 1] = SolverFFTW::planC2R(NR, xx, c2r_c, 1, c2r_r, ldr, xx);
+        }
+    }
+    sSameAlignment = true;
+    for (int tid = 0; tid < nthreads; tid++) {
+        sSameAlignment = sSameAlignment && (alignmentFFTW(sR2C_RMat[tid].data()) == 
+            alignmentFFTW(sC2R_RMat[tid].data()));
+    }
+    // backends timed on thread 0 and shared by all threads
+    sBackends = std::vector<SolverFFTW::Backend>(Nmax, SolverFFTW::BackendFFTW);
+    CMatXN3Map r2c_c = flat(sR2C_CMat[0]);
+    CMatXN3Map c2r_c = flat(sC2R_CMat[0]);
+    for (int NR: NRs) {
+        sBackends[NR - 1] = SolverFFTW::chooseBackend(NR, sR2CPlans[0][NR - 1], sC2RPlans[0][NR - 1], 
+            sR2C_RMat[0], r2c_c, sC2R_RMat[0], c2r_c);
     }
 }
 
 void SolverFFTW_N3::finalize() {
-    for (int i = 0; i < sNmax; i++) {
-        distroyFFTW(sR2CPlans[i]);
-        distroyFFTW(sC2RPlans[i]);
+    for (int tid = 0; tid < sR2CPlans.size(); tid++) {
+        for (int i = 0; i < sNmax; i++) {
+            if (sR2CPlans[tid][i]) {
+                distroyFFTW(sR2CPlans[tid][i]);
+                distroyFFTW(sC2RPlans[tid][i]);
+            }
+        }
     }
+    sR2CPlans.clear();
+    sC2RPlans.clear();
+    sBackends.clear();
     sNmax = 0;
 }
 
-void SolverFFTW_N3::computeR2C(int nr) {
-    execFFTW(sR2CPlans[nr - 1]);
-    Real inv_nr = one / (Real)nr;
-    sR2C_CMat.topRows(nr / 2 + 1) *= inv_nr;
+void SolverFFTW_N3::computeR2C(int nr, bool inputC2R) {
+    int tid = XOMP::threadID();
+    RMatXN3 &input = inputC2R ? sC2R_RMat[tid] : sR2C_RMat[tid];
+    CMatXN3Map output = flat(sR2C_CMat[tid]);
+    switch (sBackends[nr - 1]) {
+        case SolverFFTW::BackendClosedForm:
+            SolverFFTW::closedFormR2C(nr, input, output);
+            break;
+        case SolverFFTW::BackendDirect:
+            SolverFFTW::directR2C(nr, input, output, SolverFFTW::numModesPruned(nr));
+            break;
+        default:
+            if (!inputC2R) {
+                execFFTW(sR2CPlans[tid][nr - 1]);
+            } else if (sSameAlignment) {
+                execR2CFFTW(sR2CPlans[tid][nr - 1], input.data(), 
+                    complexFFTW(output.data()));
+            } else {
+                sR2C_RMat[tid].topRows(nr) = input.topRows(nr);
+                execFFTW(sR2CPlans[tid][nr - 1]);
+            }
+            Real inv_nr = one / (Real)nr;
+            output.topRows(nr / 2 + 1) *= inv_nr;
+    }
 }
 
 void SolverFFTW_N3::computeC2R(int nr) {
-    execFFTW(sC2RPlans[nr - 1]);
+    int tid = XOMP::threadID();
+    CMatXN3Map input = flat(sC2R_CMat[tid]);
+    switch (sBackends[nr - 1]) {
+        case SolverFFTW::BackendClosedForm:
+            SolverFFTW::closedFormC2R(nr, input, sC2R_RMat[tid]);
+            break;
+        case SolverFFTW::BackendDirect:
+            SolverFFTW::directC2R(nr, input, sC2R_RMat[tid], SolverFFTW::numModesPruned(nr));
+            break;
+        default:
+            execFFTW(sC2RPlans[tid][nr - 1]);
+    }
+}
+
+size_t SolverFFTW_N3::memoryBytes() {
+    size_t bytes = 0;
+    for (int tid = 0; tid < sR2C_RMat.size(); tid++) {
+        bytes += heapBytes(sR2C_RMat[tid]) + heapBytes(sR2C_CMat[tid]) + 
+            heapBytes(sC2R_RMat[tid]) + heapBytes(sC2R_CMat[tid]);
+    }
+    return bytes;
 }
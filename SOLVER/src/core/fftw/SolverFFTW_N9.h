@@ -5,31 +5,50 @@
 #pragma once
 
 #include "SolverFFTW.h"
+#include "XOMP.h"
 
 class SolverFFTW_N9 {
 public:
-    // initialize plans
-    static void initialize(int Nmax);
+    // initialize plans for the given nr, with buffers sized by Nmax
+    static void initialize(int Nmax, const std::vector<int> &NRs);
     // finalize plans
     static void finalize();
+    // bytes of the buffers, for memory reports
+    static size_t memoryBytes();
     
     // get input and output
-    static RMatXN9 &getR2C_RMat() {return sR2C_RMat;};
-    static CMatXN9 &getR2C_CMat() {return sR2C_CMat;};
-    static RMatXN9 &getC2R_RMat() {return sC2R_RMat;};    
-    static CMatXN9 &getC2R_CMat() {return sC2R_CMat;};
+    // each thread owns a private set of buffers and plans
+    // the Fourier-space buffers are structured as the element fields, so that 
+    // Gradient writes and reads them in place
+    static RMatXN9 &getR2C_RMat() {return sR2C_RMat[XOMP::threadID()];};
+    static vec_ar9_CMatPP &getR2C_CMat() {return sR2C_CMat[XOMP::threadID()];};
+    static RMatXN9 &getC2R_RMat() {return sC2R_RMat[XOMP::threadID()];};    
+    static vec_ar9_CMatPP &getC2R_CMat() {return sC2R_CMat[XOMP::threadID()];};
      
+    // the Nyquist mode of an even nr may be ignored on input and 
+    // discarded on output, as it is masked in all element transforms
     // forward, real => complex
-    static void computeR2C(int nr);
+    // with inputC2R, the input is taken from getC2R_RMat instead of 
+    // getR2C_RMat, so that the output of computeC2R feeds computeR2C
+    // without a copy
+    static void computeR2C(int nr, bool inputC2R = false);
     // backward, complex => real
     static void computeC2R(int nr);
         
 private:
     static int sNmax;
-    static std::vector<PlanFFTW> sR2CPlans;
-    static std::vector<PlanFFTW> sC2RPlans;
-    static RMatXN9 sR2C_RMat;
-    static CMatXN9 sR2C_CMat;
-    static RMatXN9 sC2R_RMat;
-    static CMatXN9 sC2R_CMat;
+    static std::vector<std::vector<PlanFFTW>> sR2CPlans;
+    static std::vector<std::vector<PlanFFTW>> sC2RPlans;
+    static std::vector<SolverFFTW::Backend> sBackends;
+    // fftw new-array execution requires equal alignment
+    static bool sSameAlignment;
+    static std::vector<RMatXN9> sR2C_RMat;
+    static std::vector<vec_ar9_CMatPP> sR2C_CMat;
+    static std::vector<RMatXN9> sC2R_RMat;
+    static std::vector<vec_ar9_CMatPP> sC2R_CMat;
+    
+    // modes by (component, point) over a structured buffer
+    static CMatXN9Map flat(vec_ar9_CMatPP &c) {
+        return CMatXN9Map(c[0][0].data(), c.size(), nPntElem * 9);
+    };
 };
@@ -0,0 +1,221 @@
+// SensitivityKernel.cpp
+// created by Kuangdai on 14-Oct-2026
+// sensitivity kernels from the forward and adjoint wavefields in memory
+// The forward run keeps a snapshot of the domain state in memory at the start 
+// of every segment of time steps. The adjoint wavefield is then run segment 
+// by segment from the last, each forward segment being recomputed from its 
+// snapshot and held in memory by samples, against which the adjoint samples 
+// are integrated on the fly, per solid element in Fourier space. Nothing goes 
+// to disk but the kernels. Forward time step n pairs with adjoint step N - 1 - n.
+
+#include "SensitivityKernel.h"
+#include "Domain.h"
+#include "SolidElement.h"
+#include "Point.h"
+#include "Checkpoint.h"
+#include "NetCDF_Writer.h"
+#include "Parameters.h"
+#include "XMPI.h"
+#include <sstream>
+
+SensitivityKernel::SensitivityKernel(int segmentSteps, int sampleInterval, double dt, 
+    double srcLat, double srcLon, double srcDep):
+mSampleInterval(std::max(sampleInterval, 1)), mDeltaT(dt),
+mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
+    // segments start and end on samples
+    mSegmentSteps = std::max(segmentSteps, 1);
+    mSegmentSteps = (mSegmentSteps + mSampleInterval - 1) / mSampleInterval * mSampleInterval;
+}
+
+void SensitivityKernel::initialize(const Domain &domain, Checkpoint &checkpoint, int totalSteps) {
+    // samples of a segment, both ends included
+    int nslot = mSegmentSteps / mSampleInterval + 1;
+    int maxNu = 0;
+    for (int iele = 0; iele < domain.getNumElements(); iele++) {
+        // solid elements only, the fluid having no strain
+        if (!dynamic_cast<const SolidElement *>(domain.getElement(iele))) {
+            continue;
+        }
+        KernelElement ke;
+        ke.mElement = domain.getElement(iele);
+        ke.mNu1 = ke.mElement->getMaxNu() + 1;
+        ke.mForward = std::vector<CMatXX>(nslot, CMatXX::Zero(nPntElem, 9 * ke.mNu1));
+        ke.mAdjointLast = CMatXX::Zero(nPntElem, 3 * ke.mNu1);
+        ke.mKappa = ke.mMu = ke.mRho = CMatXX::Zero(nPntElem, ke.mNu1);
+        mElements.push_back(ke);
+        maxNu = std::max(maxNu, ke.mNu1 - 1);
+    }
+    mDispl = CMatXX::Zero(nPntElem, 3 * (maxNu + 1));
+    mStrain = CMatXX::Zero(nPntElem, 6 * (maxNu + 1));
+    mA = mB = mP = CColX::Zero(maxNu + 1);
+    mAdjointLastStep = -1;
+    
+    // snapshots, with their size probed from the initial state
+    mSnapshots.resize((totalSteps - 1) / mSegmentSteps + 1);
+    std::vector<char> probe;
+    checkpoint.saveMemory(domain, probe);
+    mSnapshotBytes = probe.size();
+    
+    // output directory
+    if (XMPI::root()) {
+        XMPI::mkdir(Parameters::sOutputDirectory + "/kernels");
+    }
+    XMPI::barrier();
+}
+
+void SensitivityKernel::beginSegment(int iseg) {
+    mSegmentStart = iseg * mSegmentSteps;
+}
+
+void SensitivityKernel::storeForward(int n) {
+    int slot = (n - mSegmentStart) / mSampleInterval;
+    for (KernelElement &ke: mElements) {
+        int nu1 = ke.mNu1;
+        ke.mElement->feedDisplFourier(mDispl);
+        ke.mElement->feedStrainFourier(mStrain);
+        CMatXX &forward = ke.mForward[slot];
+        forward.leftCols(3 * nu1) = mDispl.leftCols(3 * nu1);
+        forward.rightCols(6 * nu1) = mStrain.leftCols(6 * nu1);
+    }
+}
+
+void SensitivityKernel::accumulate(int n) {
+    int slot = (n - mSegmentStart) / mSampleInterval;
+    // an interval of the density kernel, back to the last sample
+    bool interval = (mAdjointLastStep == n + mSampleInterval);
+    Real w = (Real)(mSampleInterval * mDeltaT);
+    Real wv = (Real)(1. / (mSampleInterval * mDeltaT));
+    for (KernelElement &ke: mElements) {
+        int nu1 = ke.mNu1;
+        ke.mElement->feedDisplFourier(mDispl);
+        ke.mElement->feedStrainFourier(mStrain);
+        const CMatXX &forward = ke.mForward[slot];
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            // divergence
+            mA.head(nu1).setZero();
+            mB.head(nu1).setZero();
+            for (int i = 0; i < 3; i++) {
+                mA.head(nu1) += mStrain.block(ipnt, i * nu1, 1, nu1).transpose();
+                mB.head(nu1) += forward.block(ipnt, (3 + i) * nu1, 1, nu1).transpose();
+            }
+            // bulk modulus: -(div s+)(div s)
+            mP.head(nu1).setZero();
+            addProduct(mA, mB, nu1, -w, mP);
+            ke.mKappa.row(ipnt) += mP.head(nu1).transpose();
+            
+            // shear modulus: -2 D+ : D, with engineering shear strains
+            mP.head(nu1).setZero();
+            addProduct(mA, mB, nu1, w * (Real)(2. / 3.), mP);
+            for (int i = 0; i < 6; i++) {
+                mA.head(nu1) = mStrain.block(ipnt, i * nu1, 1, nu1).transpose();
+                mB.head(nu1) = forward.block(ipnt, (3 + i) * nu1, 1, nu1).transpose();
+                addProduct(mA, mB, nu1, i < 3 ? -two * w : -w, mP);
+            }
+            ke.mMu.row(ipnt) += mP.head(nu1).transpose();
+            
+            // density: -s+ . dt^2 s, by parts the product of velocities
+            // over the interval to the last sample
+            if (interval) {
+                mP.head(nu1).setZero();
+                for (int i = 0; i < 3; i++) {
+                    mA.head(nu1) = ke.mAdjointLast.block(ipnt, i * nu1, 1, nu1).transpose() 
+                        - mDispl.block(ipnt, i * nu1, 1, nu1).transpose();
+                    mB.head(nu1) = ke.mForward[slot + 1].block(ipnt, i * nu1, 1, nu1).transpose() 
+                        - forward.block(ipnt, i * nu1, 1, nu1).transpose();
+                    addProduct(mA, mB, nu1, wv, mP);
+                }
+                ke.mRho.row(ipnt) += mP.head(nu1).transpose();
+            }
+        }
+        ke.mAdjointLast = mDispl.leftCols(3 * nu1);
+    }
+    mAdjointLastStep = n;
+}
+
+void SensitivityKernel::addProduct(const CColX &a, const CColX &b, int nu1, 
+    Real factor, CColX &p) {
+    // p_m = sum_k a_k b_(m - k), with c_(-k) = conj(c_k)
+    int nu = nu1 - 1;
+    for (int m = 0; m <= nu; m++) {
+        Complex sum = czero;
+        for (int k = m - nu; k <= nu; k++) {
+            Complex ak = k >= 0 ? a(k) : std::conj(a(-k));
+            Complex bk = m - k >= 0 ? b(m - k) : std::conj(b(k - m));
+            sum += ak * bk;
+        }
+        p(m) += factor * sum;
+    }
+}
+
+void SensitivityKernel::finalize() const {
+    if (mElements.size() == 0) {
+        return;
+    }
+    
+    // flattened by element, point and order, padded to the largest order
+    int nele = mElements.size();
+    int nu1 = mDispl.cols() / 3;
+    size_t nflat = (size_t)nele * nPntElem * nu1;
+    std::vector<double> sz(nele * nPntElem * 2), nus(nele);
+    std::vector<std::vector<double>> kernels(6, std::vector<double>(nflat, 0.));
+    for (int iele = 0; iele < nele; iele++) {
+        const KernelElement &ke = mElements[iele];
+        nus[iele] = ke.mNu1 - 1;
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            const RDCol2 &crds = ke.mElement->getPoint(ipnt)->getCoords();
+            sz[(iele * nPntElem + ipnt) * 2] = crds(0);
+            sz[(iele * nPntElem + ipnt) * 2 + 1] = crds(1);
+            for (int alpha = 0; alpha < ke.mNu1; alpha++) {
+                size_t pos = ((size_t)iele * nPntElem + ipnt) * nu1 + alpha;
+                kernels[0][pos] = ke.mKappa(ipnt, alpha).real();
+                kernels[1][pos] = ke.mKappa(ipnt, alpha).imag();
+                kernels[2][pos] = ke.mMu(ipnt, alpha).real();
+                kernels[3][pos] = ke.mMu(ipnt, alpha).imag();
+                kernels[4][pos] = ke.mRho(ipnt, alpha).real();
+                kernels[5][pos] = ke.mRho(ipnt, alpha).imag();
+            }
+        }
+    }
+    
+    // write, one file per rank
+    std::stringstream fname;
+    fname << Parameters::sOutputDirectory << "/kernels/axisem3d_kernels.nc.rank" << XMPI::rank();
+    NetCDF_Writer nw;
+    nw.open(fname.str(), true);
+    std::vector<size_t> dimsEle = {(size_t)nele};
+    std::vector<size_t> dimsSZ = {(size_t)nele, (size_t)nPntElem, 2};
+    std::vector<size_t> dimsK = {(size_t)nele, (size_t)nPntElem, (size_t)nu1};
+    std::vector<std::string> names = {"K_kappa_r", "K_kappa_i", "K_mu_r", "K_mu_i", "K_rho_r", "K_rho_i"};
+    nw.defModeOn();
+    nw.defineVariable<double>("element_sz", dimsSZ, false);
+    nw.defineVariable<double>("element_nu", dimsEle, false);
+    for (const std::string &name: names) {
+        nw.defineVariable<double>(name, dimsK, false);
+    }
+    nw.defModeOff();
+    nw.writeVariableWhole("element_sz", sz);
+    nw.writeVariableWhole("element_nu", nus);
+    for (int i = 0; i < names.size(); i++) {
+        nw.writeVariableWhole(names[i], kernels[i]);
+    }
+    nw.addAttribute("", "source_latitude", mSrcLat);
+    nw.addAttribute("", "source_longitude", mSrcLon);
+    nw.addAttribute("", "source_depth", mSrcDep);
+    nw.addAttribute("", "sample_interval_time", mSampleInterval * mDeltaT);
+    nw.close();
+}
+
+size_t SensitivityKernel::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytes(mElements) + heapBytes(mSnapshots) +
+        mSnapshotBytes * mSnapshots.size() + heapBytes(mDispl) + heapBytes(mStrain) +
+        heapBytes(mA) * 3;
+    for (const KernelElement &ke: mElements) {
+        bytes += heapBytes(ke.mForward) + heapBytes(ke.mAdjointLast) + 
+            heapBytes(ke.mKappa) * 3;
+        for (const CMatXX &forward: ke.mForward) {
+            bytes += heapBytes(forward);
+        }
+    }
+    return bytes;
+}
+
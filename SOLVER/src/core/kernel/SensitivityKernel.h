@@ -0,0 +1,90 @@
+// SensitivityKernel.h
+// created by Kuangdai on 14-Oct-2026
+// sensitivity kernels from the forward and adjoint wavefields in memory
+// The forward run keeps a snapshot of the domain state in memory at the start 
+// of every segment of time steps. The adjoint wavefield is then run segment 
+// by segment from the last, each forward segment being recomputed from its 
+// snapshot and held in memory by samples, against which the adjoint samples 
+// are integrated on the fly, per solid element in Fourier space. Nothing goes 
+// to disk but the kernels. Forward time step n pairs with adjoint step N - 1 - n.
+
+#pragma once
+
+#include "eigenc.h"
+#include <vector>
+class Domain;
+class Element;
+class Checkpoint;
+
+class SensitivityKernel {
+public:
+    // segmentSteps: time steps of a forward segment, rounded up to sampleInterval
+    // sampleInterval: time steps between samples of the time integrals
+    SensitivityKernel(int segmentSteps, int sampleInterval, double dt, 
+        double srcLat, double srcLon, double srcDep);
+    
+    // allocate on the elements of the domain
+    void initialize(const Domain &domain, Checkpoint &checkpoint, int totalSteps);
+    
+    int getSegmentSteps() const {return mSegmentSteps;};
+    int getSampleInterval() const {return mSampleInterval;};
+    int getNumSegments() const {return mSnapshots.size();};
+    
+    // snapshot of the forward state at the start of segment iseg
+    std::vector<char> &getSnapshot(int iseg) {return mSnapshots[iseg];};
+    
+    // a segment recomputed from its first forward step on
+    void beginSegment(int iseg);
+    
+    // forward sample at time step n of the current segment
+    void storeForward(int n);
+    
+    // adjoint sample paired with forward step n, integrated against the 
+    // forward samples; n runs backwards through the current segment
+    void accumulate(int n);
+    
+    // write the kernels; collective
+    void finalize() const;
+    
+    // bytes of the samples, kernels and snapshots, for memory reports
+    size_t memoryBytes() const;
+    
+private:
+    // product of two real fields, a_0 + 2 Re sum_k a_k exp(i k phi), 
+    // added to the orders 0 to nu of p scaled by factor
+    static void addProduct(const CColX &a, const CColX &b, int nu1, 
+        Real factor, CColX &p);
+    
+    int mSegmentSteps;
+    int mSampleInterval;
+    double mDeltaT;
+    
+    // snapshots and their size on this rank
+    std::vector<std::vector<char>> mSnapshots;
+    size_t mSnapshotBytes = 0;
+    int mSegmentStart = 0;
+    
+    struct KernelElement {
+        const Element *mElement;
+        int mNu1;
+        // forward samples of the current segment, 
+        // nPntElem x 9 (nu + 1), displacement then strain
+        std::vector<CMatXX> mForward;
+        // adjoint displacement of the last sample
+        CMatXX mAdjointLast;
+        // kernels, nPntElem x (nu + 1)
+        CMatXX mKappa, mMu, mRho;
+    };
+    std::vector<KernelElement> mElements;
+    // forward step paired with the last adjoint sample, -1 before the first
+    int mAdjointLastStep = -1;
+    
+    // workspaces
+    CMatXX mDispl;
+    CMatXX mStrain;
+    CColX mA, mB, mP;
+    
+    // source location
+    double mSrcLat, mSrcLon, mSrcDep;
+};
+
@@ -0,0 +1,199 @@
+// Checkpoint.cpp
+// created by Kuangdai on 14-Oct-2026
+// checkpoint and restart of the time-loop state
+
+#include "Checkpoint.h"
+#include "Domain.h"
+#include "Parameters.h"
+#include "XMPI.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+
+namespace CheckpointHeader {
+    const int sMagic = 0x43503344;
+    
+    struct Header {
+        int mMagic;
+        int mNProc;
+        int mStep;
+        double mTime;
+        size_t mBytes;
+    };
+}
+
+Checkpoint::Checkpoint(int interval, bool restart):
+mInterval(interval), mRestart(restart) {
+    if (!mRestart) {
+        return;
+    }
+    // latest complete step on this rank
+    double t[2];
+    int step[2];
+    step[0] = readStep(0, t[0]);
+    step[1] = readStep(1, t[1]);
+    // latest step common to all ranks
+    mRestartStep = XMPI::min(std::max(step[0], step[1]));
+    if (mRestartStep < 0) {
+        throw std::runtime_error("Checkpoint::Checkpoint || "
+            "No complete checkpoint found for restart in: || "
+            + Parameters::sOutputDirectory + "/checkpoint");
+    }
+    for (int slot = 0; slot < 2; slot++) {
+        if (step[slot] == mRestartStep) {
+            mRestartSlot = slot;
+            mRestartTime = t[slot];
+        }
+    }
+    if (mRestartSlot < 0) {
+        throw std::runtime_error("Checkpoint::Checkpoint || "
+            "Checkpoint files are inconsistent across ranks.");
+    }
+    // keep the file being restarted from
+    mNextSlot = 1 - mRestartSlot;
+}
+
+Checkpoint::~Checkpoint() {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+}
+
+void Checkpoint::save(const Domain &domain, int tstep, double t) {
+    // the buffer is still being written
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+    
+    // header
+    mSaving = true;
+    mBuffer.clear();
+    CheckpointHeader::Header header;
+    header.mMagic = CheckpointHeader::sMagic;
+    header.mNProc = XMPI::nproc();
+    header.mStep = tstep;
+    header.mTime = t;
+    header.mBytes = 0;
+    sync(&header, sizeof(header));
+    
+    // state
+    domain.syncState(*this);
+    header.mBytes = mBuffer.size() - sizeof(header);
+    std::memcpy(mBuffer.data(), &header, sizeof(header));
+    
+    // write
+    mWriter = std::thread(&Checkpoint::writeBuffer, this, fileName(mNextSlot));
+    mNextSlot = 1 - mNextSlot;
+}
+
+void Checkpoint::load(const Domain &domain) {
+    // read file
+    std::string fname = fileName(mRestartSlot);
+    std::ifstream fs(fname, std::ios::binary | std::ios::ate);
+    if (!fs) {
+        throw std::runtime_error("Checkpoint::load || "
+            "Error opening checkpoint file: || " + fname);
+    }
+    mBuffer.resize(fs.tellg());
+    fs.seekg(0);
+    fs.read(mBuffer.data(), mBuffer.size());
+    fs.close();
+    
+    // state
+    mSaving = false;
+    mPosition = sizeof(CheckpointHeader::Header);
+    domain.syncState(*this);
+    if (mPosition != mBuffer.size()) {
+        throw std::runtime_error("Checkpoint::load || "
+            "Checkpoint does not match the domain of this run. || "
+            "Restart with the same input and number of ranks.");
+    }
+    std::vector<char>().swap(mBuffer);
+    mSaving = true;
+}
+
+void Checkpoint::saveMemory(const Domain &domain, std::vector<char> &buffer) {
+    // the buffer is still being written
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+    mSaving = true;
+    mBuffer.clear();
+    domain.syncState(*this);
+    mBuffer.swap(buffer);
+    std::vector<char>().swap(mBuffer);
+}
+
+void Checkpoint::loadMemory(const Domain &domain, std::vector<char> &buffer) {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+    mBuffer.swap(buffer);
+    mSaving = false;
+    mPosition = 0;
+    domain.syncState(*this);
+    mBuffer.swap(buffer);
+    mSaving = true;
+}
+
+void Checkpoint::sync(void *data, size_t bytes) {
+    if (mSaving) {
+        const char *src = static_cast<const char *>(data);
+        mBuffer.insert(mBuffer.end(), src, src + bytes);
+    } else {
+        if (mPosition + bytes > mBuffer.size()) {
+            throw std::runtime_error("Checkpoint::sync || "
+                "Checkpoint does not match the domain of this run. || "
+                "Restart with the same input and number of ranks.");
+        }
+        std::memcpy(data, mBuffer.data() + mPosition, bytes);
+        mPosition += bytes;
+    }
+}
+
+std::string Checkpoint::weightsFile() {
+    return Parameters::sOutputDirectory + "/checkpoint/element_weights.bin";
+}
+
+std::string Checkpoint::placementFile() {
+    return Parameters::sOutputDirectory + "/checkpoint/rank_placement.txt";
+}
+
+std::string Checkpoint::fileName(int slot) {
+    std::stringstream fname;
+    fname << Parameters::sOutputDirectory << "/checkpoint/checkpoint" << slot
+        << ".rank" << XMPI::rank();
+    return fname.str();
+}
+
+int Checkpoint::readStep(int slot, double &t) {
+    std::ifstream fs(fileName(slot), std::ios::binary | std::ios::ate);
+    if (!fs) {
+        return -1;
+    }
+    size_t fileBytes = fs.tellg();
+    if (fileBytes < sizeof(CheckpointHeader::Header)) {
+        return -1;
+    }
+    CheckpointHeader::Header header;
+    fs.seekg(0);
+    fs.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (header.mMagic != CheckpointHeader::sMagic || header.mNProc != XMPI::nproc() ||
+        header.mBytes + sizeof(header) != fileBytes) {
+        return -1;
+    }
+    t = header.mTime;
+    return header.mStep;
+}
+
+void Checkpoint::writeBuffer(std::string fname) {
+    // write to a temporary file and rename, so an interrupted write
+    // never replaces a complete checkpoint
+    std::string ftemp = fname + ".tmp";
+    std::ofstream fs(ftemp, std::ios::binary);
+    fs.write(mBuffer.data(), mBuffer.size());
+    fs.close();
+    std::rename(ftemp.c_str(), fname.c_str());
+}
+
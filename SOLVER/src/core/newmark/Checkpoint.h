@@ -0,0 +1,80 @@
+// Checkpoint.h
+// created by Kuangdai on 14-Oct-2026
+// checkpoint and restart of the time-loop state
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <thread>
+class Domain;
+
+class Checkpoint {
+public:
+    // interval: number of time steps between checkpoints, 0 for off
+    // restart: continue from the latest checkpoint common to all ranks
+    Checkpoint(int interval, bool restart);
+    ~Checkpoint();
+    
+    int getInterval() const {return mInterval;};
+    bool restart() const {return mRestart;};
+    
+    // time steps done and time reached by the run being restarted
+    int getRestartStep() const {return mRestartStep;};
+    double getRestartTime() const {return mRestartTime;};
+    
+    // save domain state after tstep; the file is written asynchronously
+    void save(const Domain &domain, int tstep, double t);
+    
+    // load domain state of the restart step
+    void load(const Domain &domain);
+    
+    // domain state kept in memory instead of a file, e.g., the forward 
+    // segments of sensitivity kernels; the buffer is swapped, not copied
+    void saveMemory(const Domain &domain, std::vector<char> &buffer);
+    void loadMemory(const Domain &domain, std::vector<char> &buffer);
+    
+    // serialization used by the domain components,
+    // copying into or out of the checkpoint depending on saving()
+    bool saving() const {return mSaving;};
+    void sync(void *data, size_t bytes);
+    
+    template<typename T>
+    void syncValue(T &value) {
+        sync(&value, sizeof(T));
+    };
+    
+    template<typename TEigen>
+    void syncEigen(TEigen &mat) {
+        sync(mat.data(), mat.size() * sizeof(typename TEigen::Scalar));
+    };
+    
+    // file of the element weights used for domain decomposition,
+    // written by the first run so that a restart rebuilds the same partition
+    static std::string weightsFile();
+    // partition of each rank of the first run, if ranks are reordered
+    static std::string placementFile();
+
+private:
+    // two slots per rank, so that one complete file always exists
+    static std::string fileName(int slot);
+    // header of a checkpoint file, -1 if missing or incomplete
+    static int readStep(int slot, double &t);
+    void writeBuffer(std::string fname);
+    
+    int mInterval;
+    bool mRestart;
+    int mRestartStep = 0;
+    double mRestartTime = 0.;
+    int mRestartSlot = -1;
+    int mNextSlot = 0;
+    
+    // serialized state
+    bool mSaving = true;
+    std::vector<char> mBuffer;
+    size_t mPosition = 0;
+    
+    // asynchronous writer
+    std::thread mWriter;
+};
+
@@ -5,17 +5,119 @@
 #include "Newmark.h"
 #include "Domain.h"
 #include "SourceTimeFunction.h"
+#include "Checkpoint.h"
+#include "Telemetry.h"
+#include "SensitivityKernel.h"
 #include <sstream>
 #include "XMPI.h"
 #include "MultilevelTimer.h"
+#include "Timeline.h"
+#include <cmath>
+#include <boost/algorithm/string.hpp>
 
-Newmark::Newmark(Domain *&domain, int reportInterval, int checkStabInterval, bool randomDispl):
+Newmark::Newmark(Domain *&domain, int reportInterval, int checkStabInterval, bool randomDispl, 
+    const std::string &scheme, Checkpoint *checkpoint, Telemetry *telemetry):
 mDomain(domain), mReportInterval(reportInterval), 
-mCheckStabInterval(checkStabInterval), mRandomDispl(randomDispl) {
+mCheckStabInterval(checkStabInterval), mRandomDispl(randomDispl), 
+mStages(schemeStages(scheme)), mCheckpoint(checkpoint), mTelemetry(telemetry) {
     if (mReportInterval <= 0) mReportInterval = 100;
     if (mCheckStabInterval <= 0) mCheckStabInterval = mReportInterval;
 }
 
+std::vector<double> Newmark::schemeStages(const std::string &scheme) {
+    if (boost::iequals(scheme, "newmark")) {
+        return std::vector<double>(1, 1.);
+    } 
+    if (boost::iequals(scheme, "symplectic4")) {
+        // Forest-Ruth / Yoshida triple jump, 4th order
+        double w1 = 1. / (2. - std::cbrt(2.));
+        double w0 = 1. - 2. * w1;
+        return std::vector<double>({w1, w0, w1});
+    }
+    throw std::runtime_error("Newmark::schemeStages || Unknown time scheme: " + scheme + ".");
+}
+
+double Newmark::schemeStability(const std::string &scheme) {
+    if (boost::iequals(scheme, "symplectic4")) {
+        // omega * dt < 1.5734 instead of 2
+        return .78;
+    }
+    return 1.;
+}
+
+void Newmark::step(int tstep, double t, const std::vector<double> &frac, 
+    StepSample sample) const {
+    double dt = mDomain->getSTF().getDeltaT();
+    int maxStep = mDomain->getSTF().getSize();
+    int nStages = mStages.size();
+    for (int s = 0; s < nStages; s++) {
+        // the last stage has been assembled in the previous loop
+        if (s > 0) {
+            Timeline::begin("assembleStiff wait");
+            mDomain->assembleStiff(1);
+            Timeline::end("assembleStiff wait");
+        }
+        
+        // update to next step
+        double dtLast = dt * mStages[(s + nStages - 2) % nStages];
+        double dtNext = dt * mStages[(s + nStages - 1) % nStages];
+        Timeline::begin("updateNewmark");
+        mDomain->updateNewmark(dtNext, dtLast);
+        Timeline::end("updateNewmark");
+        
+        // source
+        Timeline::begin("applySource");
+        mDomain->applySource(tstep - 1, frac[s]);
+        Timeline::end("applySource");
+        
+        // boundary element stiffness
+        Timeline::begin("computeStiff boundary");
+        mDomain->computeStiff(-1);
+        Timeline::end("computeStiff boundary");
+        
+        // boundary solid-fluid coupling
+        Timeline::begin("coupleSolidFluid boundary");
+        mDomain->coupleSolidFluid(-1);
+        Timeline::end("coupleSolidFluid boundary");
+        
+        // assemble phase 1: feed + send + recv 
+        Timeline::begin("assembleStiff send");
+        mDomain->assembleStiff(-1);
+        Timeline::end("assembleStiff send");
+        
+        // interior element stiffness, overlapped with communication
+        Timeline::begin("computeStiff interior");
+        mDomain->computeStiff(1);
+        Timeline::end("computeStiff interior");
+        
+        // interior solid-fluid coupling
+        Timeline::begin("coupleSolidFluid interior");
+        mDomain->coupleSolidFluid(1);
+        Timeline::end("coupleSolidFluid interior");
+        
+        // samples on the time grid, taken in the first stage
+        if (s == 0) {
+            if (sample == sRecord) {
+                // record seismograms
+                Timeline::begin("record");
+                mDomain->record(tstep - 1, t);
+                Timeline::end("record");
+            } else {
+                // forward step n, or the one paired with the adjoint step
+                SensitivityKernel *kernel = mDomain->getSensitivityKernel();
+                int n = (sample == sForward) ? tstep - 1 : maxStep - tstep;
+                if (n % kernel->getSampleInterval() == 0) {
+                    if (sample == sForward) {
+                        kernel->storeForward(n);
+                    } else {
+                        kernel->accumulate(n);
+                    }
+                }
+            }
+        }
+    }
+}
+
 void Newmark::solve(int verbose) const {
     if (verbose) {
         XMPI::cout << XMPI::endl;
@@ -31,44 +133,62 @@ void Newmark::solve(int verbose) const {
         Eigen::internal::set_is_malloc_allowed(true);
     #endif
     mDomain->resetZero();
+    // continue from checkpoint
+    int startStep = 1;
+    if (mCheckpoint->restart()) {
+        mCheckpoint->load(*mDomain);
+        startStep = mCheckpoint->getRestartStep() + 1;
+        t = mCheckpoint->getRestartTime();
+        if (verbose) {
+            XMPI::cout << "  RESTARTED FROM TIME STEP  =   " << startStep - 1 << XMPI::endl << XMPI::endl; 
+        }
+    }
     #ifndef NDEBUG
         Eigen::internal::set_is_malloc_allowed(false);
     #endif
     
-    if (mRandomDispl) {
+    if (mRandomDispl && !mCheckpoint->restart()) {
         mDomain->initDisplTinyRandom();
     }
+    
+    // forward state at the start of the first kernel segment
+    SensitivityKernel *kernel = mDomain->getSensitivityKernel();
+    if (kernel) {
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(true);
+        #endif
+        mDomain->setSourcesActive(true, false);
+        mCheckpoint->saveMemory(*mDomain, kernel->getSnapshot(0));
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(false);
+        #endif
+    }
     const double sec2h = 1. / 3600.;
     double elapsed_last = 0.;
     MyBoostTimer timer;
     timer.start();
+    mTelemetry->start(*mDomain, startStep - 1);
+    
+    // stages of a step; the displacement of stage s is at tstep + frac[s]
+    int nStages = mStages.size();
+    std::vector<double> frac(nStages, 0.);
+    for (int s = 1; s < nStages; s++) {
+        frac[s] = frac[s - 1] + mStages[s - 1];
+    }
     
     ////////////////////////// loop //////////////////////////
-    for (int tstep = 1; tstep <= maxStep; tstep++) {
-        // update to next step
-        mDomain->updateNewmark(dt);
+    for (int tstep = startStep; tstep <= maxStep; tstep++) {
+        // timeline of sampled steps
+        Timeline::sampleStep(tstep);
+        std::string stepName = Timeline::active() ? "Time Step " + std::to_string(tstep) : "";
+        Timeline::begin(stepName);
         
-        // source
-        mDomain->applySource(tstep - 1);
+        // Nu of the time window
+        mDomain->applyNuSchedule(tstep - 1);
         
-        // element stiffness
-        mDomain->computeStiff();
-        
-        // solid-fluid coupling
-        mDomain->coupleSolidFluid();
-        
-        // assemble phase 1: feed + send + recv 
-        mDomain->assembleStiff(-1);
-        
-        // record seismograms
-        mDomain->record(tstep - 1, t);    
+        step(tstep, t, frac, sRecord);
         t += dt;
         
-        // check stability
-        if (tstep % mCheckStabInterval == 0) {
-            mDomain->checkStability(dt, tstep, t);
-        }
-        
         // screen info    
         if (tstep % mReportInterval == 0 && verbose) {
             double elapsed = timer.elapsed() * sec2h;
@@ -85,13 +205,60 @@ void Newmark::solve(int verbose) const {
             ss << "  WALLTIME TOTAL    / h     =   " << total << XMPI::endl << XMPI::endl; 
             XMPI::cout << ss.str();
         }
+        
+        // telemetry, collective
+        if (mTelemetry->due(tstep)) {
+            mTelemetry->report(*mDomain, tstep, maxStep, t);
+        }
+        
+        // load balance, collective
+        mDomain->checkBalance(tstep);
+        mDomain->reportImbalance(tstep);
+        
         // learn wisdom
         mDomain->learnWisdom(tstep - 1);
         
         // assemble phase 2: wait + extract 
+        Timeline::begin("assembleStiff wait");
         mDomain->assembleStiff(1);
+        Timeline::end("assembleStiff wait");
+        
+        // check stability, probed in the next updateNewmark and reduced 
+        // in the background; all processors stop together at the same 
+        // step, with no halo message in flight
+        mDomain->checkStability(dt, tstep, t, tstep % mCheckStabInterval == 0);
+        
+        // checkpoint, with all records before it on disk
+        int interval = mCheckpoint->getInterval();
+        if (interval > 0 && tstep % interval == 0 && tstep < maxStep) {
+            // never save a state that has blown up
+            mDomain->finishStability(dt);
+            #ifndef NDEBUG
+                Eigen::internal::set_is_malloc_allowed(true);
+            #endif
+            mDomain->dumpLeft();
+            mCheckpoint->save(*mDomain, tstep, t);
+            #ifndef NDEBUG
+                Eigen::internal::set_is_malloc_allowed(false);
+            #endif
+        }
+        
+        // forward state at the start of a kernel segment, in memory
+        if (kernel && tstep % kernel->getSegmentSteps() == 0 && tstep < maxStep) {
+            #ifndef NDEBUG
+                Eigen::internal::set_is_malloc_allowed(true);
+            #endif
+            mCheckpoint->saveMemory(*mDomain, 
+                kernel->getSnapshot(tstep / kernel->getSegmentSteps()));
+            #ifndef NDEBUG
+                Eigen::internal::set_is_malloc_allowed(false);
+            #endif
+        }
+        Timeline::end(stepName);
     }
     ////////////////////////// loop //////////////////////////
+    mDomain->finishStability(dt);
+    Timeline::sampleStep(0);
     mDomain->dumpLeft();
     mDomain->dumpWisdom();
     double elapsed = timer.elapsed() * sec2h;
@@ -103,6 +270,106 @@ void Newmark::solve(int verbose) const {
         XMPI::cout << "TOTAL STEPS DONE        =   " << maxStep << " / " <<  maxStep << XMPI::endl;
         XMPI::cout << "WALLTIME ELAPSED / h    =   " << elapsed << XMPI::endl << XMPI::endl;
         XMPI::cout << mDomain->reportCost();
+        XMPI::cout << mDomain->reportCounters();
+    }
+    
+    // adjoint wavefield against the recomputed forward segments
+    if (kernel) {
+        solveKernel(verbose);
+    }
+}
+
+void Newmark::solveKernel(int verbose) const {
+    SensitivityKernel *kernel = mDomain->getSensitivityKernel();
+    double dt = mDomain->getSTF().getDeltaT();
+    double shift = mDomain->getSTF().getShift();
+    int maxStep = mDomain->getSTF().getSize();
+    int nseg = kernel->getNumSegments();
+    int segSteps = kernel->getSegmentSteps();
+    if (verbose) {
+        XMPI::cout << "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT" << XMPI::endl;
+        XMPI::cout << "TTTTTTTTT  KERNEL TIME LOOP STARTS  TTTTTTTTTTTT" << XMPI::endl;
+        XMPI::cout << "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT" << XMPI::endl << XMPI::endl;
+    }
+    MyBoostTimer timer;
+    timer.start();
+    
+    std::vector<double> frac(mStages.size(), 0.);
+    for (int s = 1; s < mStages.size(); s++) {
+        frac[s] = frac[s - 1] + mStages[s - 1];
+    }
+    
+    // the adjoint state while a forward segment is recomputed
+    std::vector<char> adjointState;
+    int adjointStep = 0;
+    for (int iseg = nseg - 1; iseg >= 0; iseg--) {
+        // forward steps n = iseg * segSteps to the first of the next segment
+        int nFirst = iseg * segSteps;
+        int nLast = std::min(nFirst + segSteps, maxStep - 1);
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(true);
+        #endif
+        if (iseg < nseg - 1) {
+            mCheckpoint->saveMemory(*mDomain, adjointState);
+        }
+        mCheckpoint->loadMemory(*mDomain, kernel->getSnapshot(iseg));
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(false);
+        #endif
+        
+        // forward segment
+        mDomain->setSourcesActive(true, false);
+        kernel->beginSegment(iseg);
+        for (int tstep = nFirst + 1; tstep <= nLast + 1; tstep++) {
+            step(tstep, -shift + (tstep - 1) * dt, frac, sForward);
+            mDomain->assembleStiff(1);
+        }
+        
+        // adjoint steps paired with the steps of this segment
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(true);
+        #endif
+        if (iseg < nseg - 1) {
+            mCheckpoint->loadMemory(*mDomain, adjointState);
+        } else {
+            mDomain->resetZero();
+        }
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(false);
+        #endif
+        mDomain->setSourcesActive(false, true);
+        int lastStep = maxStep - nFirst;
+        for (int tstep = adjointStep + 1; tstep <= lastStep; tstep++) {
+            step(tstep, -shift + (tstep - 1) * dt, frac, sAdjoint);
+            mDomain->assembleStiff(1);
+            mDomain->checkStability(dt, tstep, -shift + tstep * dt, 
+                tstep % mCheckStabInterval == 0);
+        }
+        mDomain->finishStability(dt);
+        adjointStep = lastStep;
+        
+        // screen info
+        if (verbose) {
+            std::stringstream ss;
+            ss << "  KERNEL SEGMENT / TOTAL    =   " << nseg - iseg << " / " << nseg << XMPI::endl;
+            ss << "  WALLTIME ELAPSED  / h     =   " << timer.elapsed() / 3600. << XMPI::endl << XMPI::endl;
+            XMPI::cout << ss.str();
+        }
+    }
+    mDomain->setSourcesActive(true, true);
+    
+    // write kernels
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    kernel->finalize();
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+    if (verbose) {
+        XMPI::cout << "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT" << XMPI::endl;
+        XMPI::cout << "TTTTTTTTT  KERNEL TIME LOOP FINISHES  TTTTTTTTTT" << XMPI::endl;
+        XMPI::cout << "TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT" << XMPI::endl << XMPI::endl;
     }
 }
 
@@ -4,19 +4,43 @@
 
 #pragma once
 #include "global.h"
+#include <vector>
+#include <string>
 class Domain;
+class Checkpoint;
+class Telemetry;
 
 class Newmark {
 public:
-    Newmark(Domain *&domain, int reportInterval, int checkStabInterval, bool randomDispl);
+    Newmark(Domain *&domain, int reportInterval, int checkStabInterval, bool randomDispl, 
+        const std::string &scheme, Checkpoint *checkpoint, Telemetry *telemetry);
     
     void solve(int verbose) const;
     
     // void testStability(int maxStep) const;
     
+    // time schemes as compositions of Newmark steps, 
+    // given by the stage lengths in units of dt
+    static std::vector<double> schemeStages(const std::string &scheme);
+    // stability limit relative to a single Newmark step
+    static double schemeStability(const std::string &scheme);
+    
 private:
+    // what is sampled on the time grid in a step
+    enum StepSample {sRecord, sForward, sAdjoint};
+    
+    // the stages of a time step
+    void step(int tstep, double t, const std::vector<double> &frac, 
+        StepSample sample) const;
+    
+    // sensitivity kernels after the forward run, segment by segment backwards
+    void solveKernel(int verbose) const;
+    
     Domain *mDomain;
     int mReportInterval;
     int mCheckStabInterval;
     bool mRandomDispl;
+    std::vector<double> mStages;
+    Checkpoint *mCheckpoint;
+    Telemetry *mTelemetry;
 };
\ No newline at end of file
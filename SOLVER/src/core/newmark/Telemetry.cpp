@@ -0,0 +1,113 @@
+// Telemetry.cpp
+// created by Kuangdai on 14-Oct-2026
+// machine-readable progress and performance records of the time loop
+
+#include "Telemetry.h"
+#include "Domain.h"
+#include "Parameters.h"
+#include "XMPI.h"
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <sys/resource.h>
+
+namespace TelemetryClock {
+    double walltime() {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+Telemetry::Telemetry(int interval, bool append): mInterval(interval) {
+    if (mInterval <= 0 || !XMPI::root()) {
+        return;
+    }
+    mFile.open(fileName(), append ? std::ofstream::app : std::ofstream::out);
+    if (!mFile) {
+        throw std::runtime_error("Telemetry::Telemetry || "
+            "Error opening telemetry file: || " + fileName());
+    }
+}
+
+Telemetry::~Telemetry() {
+    if (mFile.is_open()) {
+        mFile.close();
+    }
+}
+
+std::string Telemetry::fileName() {
+    return Parameters::sOutputDirectory + "/telemetry.jsonl";
+}
+
+void Telemetry::start(const Domain &domain, int tstep) {
+    mLastStep = tstep;
+    mLastWalltime = TelemetryClock::walltime();
+    domain.getCost(mLastCost);
+}
+
+void Telemetry::report(const Domain &domain, int tstep, int maxStep, double t) {
+    // per-rank values of this interval
+    double now = TelemetryClock::walltime();
+    std::vector<double> cost;
+    domain.getCost(cost);
+    std::vector<double> local;
+    local.push_back((tstep - mLastStep) / std::max(now - mLastWalltime, 1e-12));
+    for (int i = 0; i < cost.size(); i++) {
+        local.push_back(cost[i] - mLastCost[i]);
+    }
+    local.push_back(memoryHighWater());
+    mLastStep = tstep;
+    mLastWalltime = now;
+    mLastCost = cost;
+    
+    // one collective for all statistics
+    std::vector<double> all;
+    XMPI::gatherEqual(local, all);
+    if (!XMPI::root()) {
+        return;
+    }
+    
+    std::vector<std::string> keys = {"steps_per_sec"};
+    std::vector<std::string> costKeys = Domain::costNames();
+    if (cost.size() == costKeys.size()) {
+        keys.insert(keys.end(), costKeys.begin(), costKeys.end());
+    }
+    keys.push_back("memory_mb");
+    
+    int nproc = XMPI::nproc();
+    int nval = local.size();
+    std::stringstream ss;
+    ss.precision(6);
+    ss << "{\"step\": " << tstep << ", \"total_steps\": " << maxStep 
+        << ", \"time\": " << t << ", \"nproc\": " << nproc;
+    for (int ival = 0; ival < nval; ival++) {
+        double vmin = all[ival], vmax = all[ival], vmean = 0.;
+        int rmin = 0, rmax = 0;
+        for (int iproc = 0; iproc < nproc; iproc++) {
+            double v = all[iproc * nval + ival];
+            if (v < vmin) {vmin = v; rmin = iproc;}
+            if (v > vmax) {vmax = v; rmax = iproc;}
+            vmean += v;
+        }
+        vmean /= nproc;
+        ss << ", \"" << keys[ival] << "\": {\"min\": " << vmin << ", \"max\": " << vmax 
+            << ", \"mean\": " << vmean << ", \"rank_min\": " << rmin 
+            << ", \"rank_max\": " << rmax << "}";
+    }
+    ss << "}\n";
+    mFile << ss.str();
+    mFile.flush();
+}
+
+double Telemetry::memoryHighWater() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    #ifdef __APPLE__
+        // bytes
+        return usage.ru_maxrss / 1024. / 1024.;
+    #else
+        // kilobytes
+        return usage.ru_maxrss / 1024.;
+    #endif
+}
+
@@ -0,0 +1,42 @@
+// Telemetry.h
+// created by Kuangdai on 14-Oct-2026
+// machine-readable progress and performance records of the time loop
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+class Domain;
+
+class Telemetry {
+public:
+    // interval: number of time steps between records, 0 for off
+    // append: continue the file of a restarted run
+    Telemetry(int interval, bool append);
+    ~Telemetry();
+    
+    bool due(int tstep) const {return mInterval > 0 && tstep % mInterval == 0;};
+    
+    // start measuring the first interval
+    void start(const Domain &domain, int tstep);
+    
+    // one JSON line of the interval ending at tstep, written by root;
+    // must be called by all ranks
+    void report(const Domain &domain, int tstep, int maxStep, double t);
+    
+    static std::string fileName();
+    
+private:
+    int mInterval;
+    std::ofstream mFile;
+    
+    // state at the last record
+    int mLastStep = 0;
+    double mLastWalltime = 0.;
+    std::vector<double> mLastCost;
+    
+    // peak resident memory of this rank in MB
+    static double memoryHighWater();
+};
+
@@ -0,0 +1,8 @@
+// IOFlush.cpp
+// created by Kuangdai on 14-Oct-2026
+// flush schedule shared by all recorders
+
+#include "IOFlush.h"
+
+int IOFlush::sInterval = 10;
+
@@ -0,0 +1,18 @@
+// IOFlush.h
+// created by Kuangdai on 14-Oct-2026
+// flush schedule shared by all recorders
+
+#pragma once
+
+class IOFlush {
+public:
+    // count a dump; return true if its files should be flushed
+    static bool due(int &numDumps) {
+        numDumps++;
+        return sInterval > 0 && numDumps % sInterval == 0;
+    };
+    
+    // number of dumps between flushes, 0 for checkpoints and finalize only
+    static int sInterval;
+};
+
@@ -0,0 +1,118 @@
+// PointwiseFilter.cpp
+// created by Kuangdai on 14-Oct-2026
+// streaming anti-alias filter, decimation and time derivatives of records
+
+#include "PointwiseFilter.h"
+#include "Checkpoint.h"
+
+PointwiseFilter::PointwiseFilter(int decimation, int derivative, double dt):
+mDecimation(decimation), mDerivative(derivative), mDt(dt) {
+    // anti-alias low-pass: Blackman-windowed sinc with the cutoff at 80%
+    // of the output Nyquist; with 16 output samples on each side, the
+    // transition band ends below the output Nyquist
+    RDColX lowpass = RDColX::Ones(1);
+    if (mDecimation > 1) {
+        int len = 2 * 16 * mDecimation + 1;
+        double fc = 0.4 / mDecimation;
+        lowpass = RDColX::Zero(len);
+        for (int k = 0; k < len; k++) {
+            double x = k - (len - 1) / 2;
+            double sinc = (k == (len - 1) / 2) ? 2. * fc : sin(2. * pi * fc * x) / (pi * x);
+            double window = .42 - .5 * cos(2. * pi * k / (len - 1))
+                + .08 * cos(4. * pi * k / (len - 1));
+            lowpass(k) = sinc * window;
+        }
+        lowpass /= lowpass.sum();
+    }
+
+    // central differences
+    RDColX stencil = RDColX::Ones(1);
+    if (mDerivative == 1) {
+        stencil = RDColX::Zero(3);
+        stencil << 1., 0., -1.;
+        stencil /= 2. * mDt;
+    } else if (mDerivative == 2) {
+        stencil = RDColX::Zero(3);
+        stencil << 1., -2., 1.;
+        stencil /= mDt * mDt;
+    }
+
+    // kernels of the same delay for the differentiated and other channels
+    int lenLow = lowpass.size();
+    int lenSten = stencil.size();
+    mHalf = (lenLow - 1) / 2 + (lenSten - 1) / 2;
+    mKernelDispl = RDColX::Zero(2 * mHalf + 1);
+    for (int i = 0; i < lenLow; i++) {
+        for (int j = 0; j < lenSten; j++) {
+            mKernelDispl(i + j) += lowpass(i) * stencil(j);
+        }
+    }
+    mKernel = RDColX::Zero(2 * mHalf + 1);
+    mKernel.segment((lenSten - 1) / 2, lenLow) = lowpass;
+}
+
+void PointwiseFilter::initialize(int numChannels, int numDisplChannels) {
+    mNumDisplChannels = numDisplChannels;
+    // inputs before the first are zero
+    mHistory = RDMatXX_RM::Zero(2 * mHalf + 1, numChannels);
+    mHistoryTime = RDColX::Zero(2 * mHalf + 1);
+    mAccum = RDMatXX_RM::Zero(1, numChannels);
+    mNumInputs = 0;
+    mNumFlushed = 0;
+}
+
+int PointwiseFilter::numOutputs(int numInputs) const {
+    int last = numInputs - 1 - mHalf;
+    return last < 0 ? 0 : last / mDecimation + 1;
+}
+
+bool PointwiseFilter::push(const RRowX &input, double t, RRowX &output, double &tout) {
+    int pos = mNumInputs % mHistory.rows();
+    mHistory.row(pos) = input.cast<double>();
+    mHistoryTime(pos) = t;
+    mNumInputs++;
+    return emit(output, tout);
+}
+
+bool PointwiseFilter::flush(RRowX &output, double &tout) {
+    // pad with zeros until the last input is at the centre
+    while (mNumFlushed < mHalf) {
+        int len = mHistory.rows();
+        int pos = mNumInputs % len;
+        mHistory.row(pos).setZero();
+        mHistoryTime(pos) = mHistoryTime((mNumInputs - 1 + len) % len) + mDt;
+        mNumInputs++;
+        mNumFlushed++;
+        if (emit(output, tout)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PointwiseFilter::emit(RRowX &output, double &tout) {
+    // polyphase: only the retained samples are convolved
+    int centre = mNumInputs - 1 - mHalf;
+    if (centre < 0 || centre % mDecimation != 0) {
+        return false;
+    }
+    int len = mHistory.rows();
+    int nd = mNumDisplChannels;
+    int no = mHistory.cols() - nd;
+    mAccum.setZero();
+    for (int k = 0; k < len; k++) {
+        int pos = ((mNumInputs - 1 - k) % len + len) % len;
+        mAccum.leftCols(nd) += mKernelDispl(k) * mHistory.block(pos, 0, 1, nd);
+        mAccum.rightCols(no) += mKernel(k) * mHistory.block(pos, nd, 1, no);
+    }
+    output = mAccum.cast<Real>();
+    tout = mHistoryTime(centre % len);
+    return true;
+}
+
+void PointwiseFilter::syncState(Checkpoint &cp) {
+    cp.syncEigen(mHistory);
+    cp.syncEigen(mHistoryTime);
+    cp.syncValue(mNumInputs);
+}
+
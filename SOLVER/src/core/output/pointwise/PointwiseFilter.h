@@ -0,0 +1,64 @@
+// PointwiseFilter.h
+// created by Kuangdai on 14-Oct-2026
+// streaming anti-alias filter, decimation and time derivatives of records
+
+#pragma once
+
+#include "eigenc.h"
+#include "eigenp.h"
+class Checkpoint;
+
+class PointwiseFilter {
+public:
+    // decimation: input samples per output sample, 1 for no decimation
+    // derivative: 0 for displacement, 1 for velocity, 2 for acceleration
+    // dt: interval between input samples
+    PointwiseFilter(int decimation, int derivative, double dt);
+
+    // channels of a record; the first numDisplChannels are differentiated
+    void initialize(int numChannels, int numDisplChannels);
+
+    // nothing to do
+    bool isIdentity() const {return mDecimation == 1 && mDerivative == 0;};
+
+    // outputs emitted after so many inputs, excluding the final flush
+    int numOutputs(int numInputs) const;
+
+    // outputs of a whole run of so many inputs
+    static int totalOutputs(int numInputs, int decimation) {
+        return (numInputs + decimation - 1) / decimation;
+    };
+
+    // feed an input sample at time t; return true if an output is ready
+    bool push(const RRowX &input, double t, RRowX &output, double &tout);
+
+    // after the last input, return true while delayed outputs remain
+    bool flush(RRowX &output, double &tout);
+
+    // checkpoint
+    void syncState(Checkpoint &cp);
+
+private:
+    // output centred at the sample mNumInputs - 1 - mHalf
+    bool emit(RRowX &output, double &tout);
+
+    int mDecimation;
+    int mDerivative;
+    double mDt;
+
+    // linear-phase kernels of length 2 * mHalf + 1
+    int mHalf = 0;
+    RDColX mKernelDispl;
+    RDColX mKernel;
+    int mNumDisplChannels = 0;
+
+    // ring buffer of the latest inputs
+    RDMatXX_RM mHistory;
+    RDColX mHistoryTime;
+    int mNumInputs = 0;
+    int mNumFlushed = 0;
+
+    // workspace
+    RDMatXX_RM mAccum;
+};
+
@@ -14,9 +14,10 @@ public:
     virtual ~PointwiseIO() {};
     
     // before time loop
+    // restartRow: rows written by the run being restarted, 0 for a new run
     virtual void initialize(int totalRecordSteps, int bufferSize, 
         const std::string &components, const std::vector<PointwiseInfo> &receivers,
-        double srcLat, double srcLon, double srcDep) = 0;
+        double srcLat, double srcLon, double srcDep, int restartRow) = 0;
     
     // after time loop
     virtual void finalize() = 0;
@@ -26,5 +27,8 @@ public:
         const RMatXX_RM &bufferStrain, 
         const RMatXX_RM &bufferCurl, 
         const RDColX &bufferTime, int bufferLine) = 0;
+    
+    // flush dumped data to disk
+    virtual void flush() = 0;
 };
 
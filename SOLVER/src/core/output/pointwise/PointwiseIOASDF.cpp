@@ -0,0 +1,466 @@
+// PointwiseIOASDF.cpp
+// created by Kuangdai on 1-Jun-2017 
+// ASDF IO for point-wise receivers
+
+#include "PointwiseIOASDF.h"
+#include "Parameters.h"
+#include "NetCDF_Writer.h"
+#include "NetCDF_Reader.h"
+#include "XMPI.h"
+#include <sstream>
+#include <cstdio>
+#include "PointwiseRecorder.h"
+
+#include <fstream>
+#include <iomanip>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace PointwiseASDF {
+    std::string oneFile() {
+        return Parameters::sOutputDirectory + "/stations/axisem3d_synthetics.asdf.h5";
+    }
+    
+    std::string locFile() {
+        std::stringstream fname;
+        fname << oneFile() << ".rank" << XMPI::rank();
+        return fname.str();
+    }
+}
+
+void PointwiseIOASDF::initialize(int totalRecordSteps, int bufferSize, 
+    const std::string &components, const std::vector<PointwiseInfo> &receivers,
+    double srcLat, double srcLon, double srcDep, int restartRow) {
+    mCurrentRow = restartRow;
+    mTotalRecordSteps = totalRecordSteps;
+    mComponents = components;
+    mSrcLat = srcLat;
+    mSrcLon = srcLon;
+    mSrcDep = srcDep;
+    
+    // number
+    int numRec = receivers.size();
+    mMinRankWithRec = XMPI::min(numRec > 0 ? XMPI::rank() : XMPI::nproc());
+    if (mMinRankWithRec == XMPI::nproc()) {
+        // no receiver at all
+        mMinRankWithRec = -1;
+        return;
+    }
+    
+    // gather station info on root, which creates the file
+    std::vector<std::string> networks, names;
+    std::vector<double> lats, lons, deps;
+    for (int irec = 0; irec < numRec; irec++) {
+        mKeys.push_back(receivers[irec].mNetwork + "." + receivers[irec].mName);
+        networks.push_back(receivers[irec].mNetwork);
+        names.push_back(receivers[irec].mName);
+        lats.push_back(receivers[irec].mLat);
+        lons.push_back(receivers[irec].mLon);
+        deps.push_back(receivers[irec].mDep);
+    }
+    XMPI::gather(networks, mAllNetworks, false);
+    XMPI::gather(names, mAllNames, false);
+    XMPI::gather(lats, mAllLats, MPI_DOUBLE, false);
+    XMPI::gather(lons, mAllLons, MPI_DOUBLE, false);
+    XMPI::gather(deps, mAllDeps, MPI_DOUBLE, false);
+    
+    // event, whose origin time enters the waveform names
+    std::string quakeStr;
+    if (XMPI::root()) {
+        readQuakeML(quakeStr, mSourceID, mSourceT0_UTC);
+    }
+    XMPI::bcast(mSourceID);
+    XMPI::bcast(mSourceT0_UTC);
+    for (const std::string &key: mKeys) {
+        for (int ichan = 0; ichan < 3; ichan++) {
+            mWaveformNames.push_back(waveformName(key, ichan));
+        }
+    }
+    
+    // the ASDF file, with all waveforms defined and filled, 
+    // so that a rank only writes the data of its own stations
+    if (XMPI::root() && restartRow == 0) {
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(true);
+        #endif
+        createFile(totalRecordSteps, bufferSize, quakeStr);
+        #ifndef NDEBUG
+            Eigen::internal::set_is_malloc_allowed(false);
+        #endif
+    }
+    XMPI::barrier();
+    
+    #ifdef _USE_PARALLEL_NETCDF
+        mNetCDF = new NetCDF_Writer();
+        mNetCDF->openParallel(PointwiseASDF::oneFile());
+    #else
+        if (numRec == 0) {
+            return;
+        }
+        mNetCDF = new NetCDF_Writer();
+        if (restartRow > 0) {
+            // continue the file of the run being restarted
+            mNetCDF->open(PointwiseASDF::locFile(), false);
+            return;
+        }
+        mNetCDF->open(PointwiseASDF::locFile(), true);
+        std::vector<size_t> dims;
+        dims.push_back(totalRecordSteps);
+        dims.push_back(3);
+        mNetCDF->defModeOn();
+        for (const std::string &key: mKeys) {
+            mNetCDF->defineVariable<Real>(key, dims);
+        }
+        mNetCDF->defModeOff();
+        for (const std::string &key: mKeys) {
+            mNetCDF->fillConstant(key, dims, (Real)NC_ERR_VALUE);
+        }
+        mNetCDF->flush();
+    #endif
+}
+
+void PointwiseIOASDF::createFile(int totalRecordSteps, int bufferSize, 
+    const std::string &quakeStr) {
+    NetCDF_Writer nw;
+    nw.open(PointwiseASDF::oneFile(), true);
+    
+    // create groups
+    nw.createGroup("AuxiliaryData");
+    nw.createGroup("Provenance");
+    nw.createGroup("Waveforms");
+    nw.addAttributeString("", "file_format", "ASDF");
+    nw.addAttributeString("", "file_format_version", "1.0.0");
+    
+    // QuakeML
+    nw.writeStringInByte("QuakeML", quakeStr);
+    
+    // UTC
+    boost::posix_time::ptime utcFirst = UTCfromString(mSourceT0_UTC) 
+        + boost::posix_time::microseconds((long long)round(mStartTime * 1e6));
+    boost::posix_time::ptime utcZero = UTCfromString("1970-01-01T00:00:00");
+    long long tFirstLong = (utcFirst - utcZero).total_nanoseconds();
+    double samplingRate = 1. / mSamplingInterval;
+    
+    // stations
+    std::vector<size_t> dims;
+    dims.push_back(totalRecordSteps);
+    size_t chunkSteps = NetCDF_Writer::chunkTimeSteps(bufferSize);
+    nw.goToGroup("Waveforms");
+    for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+        for (int irec = 0; irec < mAllNames[iproc].size(); irec++) {
+            std::string key = mAllNetworks[iproc][irec] + "." + mAllNames[iproc][irec];
+            nw.createGroup(key);
+            nw.goToGroup(key);
+            
+            // StationXML
+            nw.writeStringInByte("StationXML", createStationML(
+                mAllNetworks[iproc][irec], mAllNames[iproc][irec],
+                mAllLats[iproc][irec], mAllLons[iproc][irec], mAllDeps[iproc][irec]));
+            
+            // waveforms, chunked in time as dumped
+            nw.defModeOn();
+            for (int ichan = 0; ichan < 3; ichan++) {
+                std::string varName = waveformName(key, ichan);
+                nw.defineTimeSeries<Real>(varName, dims, chunkSteps);
+                nw.addAttributeString(varName, "event_id", mSourceID);
+                nw.addAttribute(varName, "sampling_rate", samplingRate);
+                nw.addAttribute(varName, "starttime", tFirstLong);
+            }
+            nw.defModeOff();
+            for (int ichan = 0; ichan < 3; ichan++) {
+                nw.fillConstant(waveformName(key, ichan), dims, (Real)NC_ERR_VALUE);
+            }
+            
+            // back to waveforms
+            nw.goToFileRoot();
+            nw.goToGroup("Waveforms");
+        }
+    }
+    nw.close();
+}
+
+std::string PointwiseIOASDF::waveformName(const std::string &key, int ichan) const {
+    // NET.STA.LOC.CHA__START__END__TAG
+    boost::posix_time::ptime utcFirst = UTCfromString(mSourceT0_UTC) 
+        + boost::posix_time::microseconds((long long)round(mStartTime * 1e6));
+    boost::posix_time::ptime utcLastt = utcFirst + boost::posix_time::microseconds(
+        (long long)round((mTotalRecordSteps - 1) * mSamplingInterval * 1e6));
+    return key + ".." + mComponents.substr(ichan, 1) 
+        + "__" + UTCToString(utcFirst, false) + "__" + UTCToString(utcLastt, false) 
+        + "__synthetic";
+}
+
+void PointwiseIOASDF::finalize() {
+    if (mMinRankWithRec == -1) {
+        // no receiver at all
+        return;
+    }
+    
+    // dispose writer
+    if (mNetCDF) {
+        mNetCDF->close();
+        delete mNetCDF;
+        mNetCDF = 0;
+    }
+    
+    #ifdef _USE_PARALLEL_NETCDF
+        return;
+    #endif
+    
+    // merge local files into the ASDF file
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    int numRec = mKeys.size();
+    for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+        if (iproc == XMPI::rank() && numRec > 0) {
+            NetCDF_Reader nr;
+            nr.open(PointwiseASDF::locFile());
+            NetCDF_Writer nw;
+            nw.open(PointwiseASDF::oneFile(), false);
+            nw.goToGroup("Waveforms");
+            for (int irec = 0; irec < numRec; irec++) {
+                nw.goToGroup(mKeys[irec]);
+                RMatXX_RM seis;
+                nr.read2D(mKeys[irec], seis);
+                for (int ichan = 0; ichan < 3; ichan++) {
+                    nw.writeVariableWhole(mWaveformNames[irec * 3 + ichan], 
+                        seis.col(ichan).eval());
+                }
+                nw.goToFileRoot();
+                nw.goToGroup("Waveforms");
+            }
+            nw.close();
+            nr.close();
+        }
+        XMPI::barrier();
+    } 
+    
+    // delete local files
+    if (numRec > 0) {
+        std::remove(PointwiseASDF::locFile().c_str());
+    }
+    
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+}
+
+void PointwiseIOASDF::dumpToFile(const RMatXX_RM &bufferDisp, 
+    const RMatXX_RM &bufferStrain,
+    const RMatXX_RM &bufferCurl,
+    const RDColX &bufferTime, int bufferLine) {
+    int numRec = mKeys.size();
+    if (numRec == 0) {
+        return;
+    }  
+    if (bufferLine == 0) {
+        return;
+    }
+    
+    std::vector<size_t> start;
+    std::vector<size_t> count;
+    start.push_back(mCurrentRow);
+    count.push_back(bufferLine);
+    
+    // write seismograms
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    #ifdef _USE_PARALLEL_NETCDF
+        // independent writes to the waveforms of local stations
+        for (int irec = 0; irec < numRec; irec++) {
+            mNetCDF->goToFileRoot();
+            mNetCDF->goToGroup("Waveforms");
+            mNetCDF->goToGroup(mKeys[irec]);
+            for (int ichan = 0; ichan < 3; ichan++) {
+                mNetCDF->writeVariableChunk(mWaveformNames[irec * 3 + ichan], 
+                    bufferDisp.block(0, irec * 3 + ichan, bufferLine, 1).eval(), 
+                    start, count);
+            }
+        }
+        mNetCDF->goToFileRoot();
+    #else
+        start.push_back(0);
+        count.push_back(3);
+        for (int irec = 0; irec < numRec; irec++) {
+            mNetCDF->writeVariableChunk(mKeys[irec], 
+                bufferDisp.block(0, irec * 3, bufferLine, 3).eval(), 
+                start, count);
+        }
+    #endif
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+    
+    // record postion in nc file
+    mCurrentRow += bufferLine;
+}
+
+void PointwiseIOASDF::readQuakeML(std::string &quakeStr, std::string &sourceID, 
+    std::string &sourceT0_UTC) const {
+    std::fstream fs(Parameters::sInputDirectory + "/ASDF/quake.xml");
+    if (fs) {
+        // user provided
+        quakeStr = std::string((std::istreambuf_iterator<char>(fs)), 
+            std::istreambuf_iterator<char>());
+        
+        // try to find event publicID
+        std::string eventStr = "<event publicID=\"";
+        size_t pos = quakeStr.find(eventStr);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find event publicID in user-provided quake.xml.");
+        }
+        pos += eventStr.length();
+        size_t eventStart = pos;
+        
+        std::string eventStrEnd = "\">";
+        pos = quakeStr.find(eventStrEnd, pos);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find event publicID in user-provided quake.xml.");
+        }
+        sourceID = quakeStr.substr(eventStart, pos - eventStart);
+        pos += eventStrEnd.length();
+        
+        // try to find event time
+        std::string originStr = "<origin publicID=\"";
+        pos = quakeStr.find(originStr, pos);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find origin publicID in user-provided quake.xml.");
+        }
+        pos += originStr.length();
+        
+        std::string timeStr = "<time>";
+        pos = quakeStr.find(timeStr, pos);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find \"<time>\" under \"<origion>\" in user-provided quake.xml.");
+        }
+        pos += timeStr.length();
+        
+        std::string valueStr = "<value>";
+        pos = quakeStr.find(valueStr, pos);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find \"<value>\" under \"<time>\" under \"<origion>\" in user-provided quake.xml.");
+        }
+        pos += valueStr.length();
+        size_t timeStart = pos;
+        
+        std::string timeStrEnd = "</value>";
+        pos = quakeStr.find(timeStrEnd, pos);
+        if (pos == std::string::npos) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Unable to find \"</value>\" under \"<time>\" under \"<origion>\" in user-provided quake.xml.");
+        }
+        sourceT0_UTC = quakeStr.substr(timeStart, pos - timeStart);
+    } else {
+        // built-in
+        std::string path = projectDirectory + "/src/core/output/pointwise/minimum_quake.xml";
+        fs.open(path);
+        if (!fs) {
+            throw std::runtime_error("PointwiseIOASDF::readQuakeML || "
+                "Error opening minimum_quake.xml at directory: ||" + path);
+        }
+        quakeStr = std::string((std::istreambuf_iterator<char>(fs)), 
+            std::istreambuf_iterator<char>());
+        boost::replace_first(quakeStr, "@LAT@", boost::lexical_cast<std::string>(mSrcLat));
+        boost::replace_first(quakeStr, "@LON@", boost::lexical_cast<std::string>(mSrcLon));
+        boost::replace_first(quakeStr, "@DEP@", boost::lexical_cast<std::string>(mSrcDep));
+        boost::replace_first(quakeStr, "@PATH_TO_SOURCE_FILE@", mSourceFile);
+        sourceID = mSourceFile;
+        sourceT0_UTC = "1970-01-01T00:00:00";
+    }
+    fs.close();
+}
+
+std::string PointwiseIOASDF::createStationML(const std::string &network, 
+    const std::string &name, double lat, double lon, double dep) const {
+    std::string stationStr;
+    std::string key = network + "." + name;
+    std::fstream fs(Parameters::sInputDirectory + "/ASDF/" + key + ".xml");
+    if (fs) {
+        // user provided
+        stationStr = std::string((std::istreambuf_iterator<char>(fs)), 
+            std::istreambuf_iterator<char>());
+    } else {
+        // built-in
+        std::string path = projectDirectory + "/src/core/output/pointwise/minimum_station.xml";
+        fs.open(path);
+        if (!fs) {
+            throw std::runtime_error("PointwiseIOASDF::createStationML || "
+                "Error opening minimum_station.xml at directory: ||" + path);
+        }
+        stationStr = std::string((std::istreambuf_iterator<char>(fs)), 
+            std::istreambuf_iterator<char>());
+        boost::replace_first(stationStr, "@NETWORK@", network);
+        boost::replace_first(stationStr, "@NAME@", name);
+        boost::replace_first(stationStr, "@LAT@", boost::lexical_cast<std::string>(lat));
+        boost::replace_first(stationStr, "@LON@", boost::lexical_cast<std::string>(lon));
+        boost::replace_first(stationStr, "@DEP@", boost::lexical_cast<std::string>(dep));
+        boost::replace_first(stationStr, "@SOURCE@", mSourceID);
+    }
+    fs.close();
+    return stationStr;
+}
+
+boost::posix_time::ptime PointwiseIOASDF::UTCfromString(const std::string &utcStr) {
+    std::string processed(utcStr);
+    boost::replace_first(processed, "Z", "");
+    boost::replace_first(processed, "GMT", "");
+    std::vector<std::string> date_time = Parameters::splitString(processed, "T");
+    // date
+    std::vector<std::string> ymd = Parameters::splitString(date_time[0], "-");
+    long year = boost::lexical_cast<long>(ymd[0]);
+    long month = boost::lexical_cast<long>(ymd[1]);
+    long day = boost::lexical_cast<long>(ymd[2]);
+    // time
+    std::vector<std::string> hms = Parameters::splitString(date_time[1], ":");
+    long hour = boost::lexical_cast<long>(hms[0]);
+    long min = boost::lexical_cast<long>(hms[1]);
+    std::vector<std::string> sec_frac = Parameters::splitString(hms[2], ".");
+    long second = boost::lexical_cast<long>(sec_frac[0]);
+    long frac = 0;
+    if (sec_frac.size() > 1) {
+        if (sec_frac[1].length() > 0) {
+            frac = boost::lexical_cast<long>(sec_frac[1]);
+        }
+    }
+    return boost::posix_time::ptime(boost::gregorian::date(year, month, day), 
+        boost::posix_time::time_duration(hour, min, second, frac));
+}
+
+std::string PointwiseIOASDF::UTCToString(const boost::posix_time::ptime &utc, bool printfrac) {
+    // date
+    boost::gregorian::date myDate = utc.date();
+    long year = myDate.year();
+    long month = myDate.month();
+    long day = myDate.day();
+    // time
+    boost::posix_time::time_duration myTime = utc.time_of_day();
+    long hour = myTime.hours();
+    long min = myTime.minutes();
+    long second = myTime.seconds();
+    long frac = myTime.fractional_seconds();
+    std::stringstream ss;
+    ss << std::setfill ('0') << std::setw(4) << year << "-";
+    ss << std::setfill ('0') << std::setw(2) << month << "-";
+    ss << std::setfill ('0') << std::setw(2) << day << "T";
+    ss << std::setfill ('0') << std::setw(2) << hour << ":";
+    ss << std::setfill ('0') << std::setw(2) << min << ":";
+    ss << std::setfill ('0') << std::setw(2) << second;
+    if (frac > 0 && printfrac) {
+        ss << "." << frac;
+    }
+    return ss.str();
+}
+
+void PointwiseIOASDF::flush() {
+    if (mKeys.size() == 0 || mNetCDF == 0) {
+        return;
+    }
+    mNetCDF->flush();
+}
@@ -0,0 +1,87 @@
+// PointwiseIOASDF.h
+// created by Kuangdai on 1-Jun-2017 
+// ASDF IO for point-wise receivers
+
+#pragma once
+
+#include "PointwiseIO.h"
+#include "boost/date_time/posix_time/posix_time_types.hpp"
+class NetCDF_Writer;
+
+class PointwiseIOASDF: public PointwiseIO {
+public:
+    // startTime: time of the first record w.r.t. the source origin
+    // samplingInterval: time between two records
+    PointwiseIOASDF(const std::string &sourceFile, double startTime, 
+        double samplingInterval):
+        mSourceFile(sourceFile), mStartTime(startTime), 
+        mSamplingInterval(samplingInterval) {};
+    
+    // before time loop
+    void initialize(int totalRecordSteps, int bufferSize, 
+        const std::string &components, const std::vector<PointwiseInfo> &receivers, 
+        double srcLat, double srcLon, double srcDep, int restartRow);
+    
+    // after time loop
+    void finalize();
+    
+    // dump to user-specified format
+    void dumpToFile(const RMatXX_RM &bufferDisp, 
+        const RMatXX_RM &bufferStrain, 
+        const RMatXX_RM &bufferCurl, 
+        const RDColX &bufferTime, int bufferLine);
+    
+    // flush dumped data to disk
+    void flush();
+    
+private:
+    // create the ASDF file with all stations and waveforms defined
+    void createFile(int totalRecordSteps, int bufferSize, const std::string &quakeStr);
+    // waveform name of a station and a channel
+    std::string waveformName(const std::string &key, int ichan) const;
+    
+    void readQuakeML(std::string &quakeStr, std::string &sourceID, std::string &sourceT0_UTC) const;
+    std::string createStationML(const std::string &network, const std::string &name,
+        double lat, double lon, double dep) const;
+    
+    static boost::posix_time::ptime UTCfromString(const std::string &utcStr);
+    static std::string UTCToString(const boost::posix_time::ptime &utc, bool printfrac);
+    
+    // local stations, NETWORK.NAME 
+    std::vector<std::string> mKeys;
+    // waveform names of local stations, three channels per station
+    std::vector<std::string> mWaveformNames;
+    
+    // file ID
+    // parallel NetCDF: the ASDF file
+    // serial NetCDF: a local file, merged into the ASDF file after the time loop
+    NetCDF_Writer *mNetCDF = 0;
+    
+    // location in nc 
+    int mCurrentRow = 0;
+    
+    // minimum MPI rank that has receivers
+    int mMinRankWithRec = -1;
+    
+    // header info
+    std::string mComponents;
+    double mSrcLat;
+    double mSrcLon;
+    double mSrcDep;
+    std::string mSourceFile;
+    std::string mSourceID;
+    std::string mSourceT0_UTC;
+    
+    // time axis
+    double mStartTime;
+    double mSamplingInterval;
+    int mTotalRecordSteps = 0;
+    
+    // all stations, on the rank creating the file
+    std::vector<std::vector<std::string>> mAllNetworks;
+    std::vector<std::vector<std::string>> mAllNames;
+    std::vector<std::vector<double>> mAllLats;
+    std::vector<std::vector<double>> mAllLons;
+    std::vector<std::vector<double>> mAllDeps;
+};
+
@@ -6,9 +6,32 @@
 #include "Parameters.h"
 #include "PointwiseRecorder.h"
 
+namespace PointwiseAscii {
+    // open a new file, or continue the first nrow lines of an existing file
+    std::fstream *open(const std::string &fname, int nrow) {
+        if (nrow == 0) {
+            return new std::fstream(fname, std::fstream::out);
+        }
+        // drop rows written after the checkpoint
+        std::vector<std::string> lines;
+        std::fstream fin(fname, std::fstream::in);
+        std::string line;
+        while (lines.size() < nrow && getline(fin, line)) {
+            lines.push_back(line);
+        }
+        fin.close();
+        std::fstream *fs = new std::fstream(fname, std::fstream::out);
+        for (const std::string &l: lines) {
+            (*fs) << l << "\n";
+        }
+        fs->flush();
+        return fs;
+    }
+}
+
 void PointwiseIOAscii::initialize(int totalRecordSteps, int bufferSize, 
     const std::string &components, const std::vector<PointwiseInfo> &receivers,
-    double srcLat, double srcLon, double srcDep) {
+    double srcLat, double srcLon, double srcDep, int restartRow) {
     // number
     int numRec = receivers.size();
     mFileNamesDisp.clear();    
@@ -26,7 +49,7 @@ void PointwiseIOAscii::initialize(int totalRecordSteps, int bufferSize,
     for (int irec = 0; irec < numRec; irec++) {
         std::string fname_base = outdir + receivers[irec].mNetwork + "." + receivers[irec].mName;
         std::string fname_disp = fname_base + "." + components + ".ascii";
-        std::fstream *fs_disp = new std::fstream(fname_disp, std::fstream::out);
+        std::fstream *fs_disp = PointwiseAscii::open(fname_disp, restartRow);
         if (!(*fs_disp)) {
             throw std::runtime_error("PointwiseIOAscii::initialize || "
                 "Error opening ascii output file: || " + fname_disp
@@ -38,7 +61,7 @@ void PointwiseIOAscii::initialize(int totalRecordSteps, int bufferSize,
         // strain
         if (receivers[irec].mDumpStrain) {
             std::string fname_strain = fname_base + "." + "RTZ" + ".strain.ascii";
-            std::fstream *fs_strain = new std::fstream(fname_strain, std::fstream::out);
+            std::fstream *fs_strain = PointwiseAscii::open(fname_strain, restartRow);
             if (!(*fs_strain)) {
                 throw std::runtime_error("PointwiseIOAscii::initialize || "
                     "Error opening ascii output file: || " + fname_strain
@@ -51,7 +74,7 @@ void PointwiseIOAscii::initialize(int totalRecordSteps, int bufferSize,
         // curl
         if (receivers[irec].mDumpCurl) {
             std::string fname_curl = fname_base + "." + "RTZ" + ".curl.ascii";
-            std::fstream *fs_curl = new std::fstream(fname_curl, std::fstream::out);
+            std::fstream *fs_curl = PointwiseAscii::open(fname_curl, restartRow);
             if (!(*fs_curl)) {
                 throw std::runtime_error("PointwiseIOAscii::initialize || "
                     "Error opening ascii output file: || " + fname_curl
@@ -97,27 +120,36 @@ void PointwiseIOAscii::dumpToFile(const RMatXX_RM &bufferDisp,
     for (int irec = 0; irec < numRec; irec++) {
         mBufferDisp.topRows(bufferLine) << bufferTime.topRows(bufferLine), 
                                        bufferDisp.block(0, irec * 3, bufferLine, 3).cast<double>();
-        (*mFilesDisp[irec]) << mBufferDisp.topRows(bufferLine).format(EIGEN_FMT) << std::endl;   
-        mFilesDisp[irec]->flush();
+        (*mFilesDisp[irec]) << mBufferDisp.topRows(bufferLine).format(EIGEN_FMT) << "\n";
     }
     
     int numStrainRec = mFileNamesStrain.size();
     for (int irec = 0; irec < numStrainRec; irec++) {
         mBufferStrain.topRows(bufferLine) << bufferTime.topRows(bufferLine), 
                                        bufferStrain.block(0, irec * 6, bufferLine, 6).cast<double>();
-        (*mFilesStrain[irec]) << mBufferStrain.topRows(bufferLine).format(EIGEN_FMT) << std::endl;   
-        mFilesStrain[irec]->flush();
+        (*mFilesStrain[irec]) << mBufferStrain.topRows(bufferLine).format(EIGEN_FMT) << "\n";
     }
     
     int numCurlRec = mFileNamesCurl.size();
     for (int irec = 0; irec < numCurlRec; irec++) {
         mBufferCurl.topRows(bufferLine) << bufferTime.topRows(bufferLine), 
                                        bufferCurl.block(0, irec * 3, bufferLine, 3).cast<double>();
-        (*mFilesCurl[irec]) << mBufferCurl.topRows(bufferLine).format(EIGEN_FMT) << std::endl;   
-        mFilesCurl[irec]->flush();
+        (*mFilesCurl[irec]) << mBufferCurl.topRows(bufferLine).format(EIGEN_FMT) << "\n";
     }
     #ifndef NDEBUG
         Eigen::internal::set_is_malloc_allowed(false);
     #endif
 }
 
+void PointwiseIOAscii::flush() {
+    for (const auto &fs: mFilesDisp) {
+        fs->flush();
+    }
+    for (const auto &fs: mFilesStrain) {
+        fs->flush();
+    }
+    for (const auto &fs: mFilesCurl) {
+        fs->flush();
+    }
+}
+
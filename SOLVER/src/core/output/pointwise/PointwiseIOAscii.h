@@ -12,7 +12,7 @@ public:
     // before time loop
     void initialize(int totalRecordSteps, int bufferSize, 
         const std::string &components, const std::vector<PointwiseInfo> &receivers, 
-        double srcLat, double srcLon, double srcDep);
+        double srcLat, double srcLon, double srcDep, int restartRow);
     
     // after time loop
     void finalize();
@@ -23,6 +23,9 @@ public:
         const RMatXX_RM &bufferCurl,
         const RDColX &bufferTime, int bufferLine);
     
+    // flush dumped data to disk
+    void flush();
+    
 private:
     // file names
     std::vector<std::string> mFileNamesDisp;
@@ -0,0 +1,209 @@
+// PointwiseIOBinary.cpp
+// created by Kuangdai on 14-Oct-2026
+// flat binary IO for point-wise receivers, for memory-mapped reading
+
+#include "PointwiseIOBinary.h"
+#include "Parameters.h"
+#include "PointwiseRecorder.h"
+#include "XMPI.h"
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace PointwiseBinary {
+    const int64_t sHeaderBytes = 4096;
+    const int64_t sAlignment = 4096;
+
+    struct Header {
+        char mMagic[8];
+        int32_t mVersion;
+        int32_t mBytesPerValue;
+        int64_t mNumSteps;
+        int64_t mNumStations;
+        int64_t mNumComponents;
+        int64_t mTimeOffset;
+        int64_t mDataOffset;
+        double mSrcLat;
+        double mSrcLon;
+        double mSrcDep;
+    };
+}
+
+void PointwiseIOBinary::initialize(int totalRecordSteps, int bufferSize,
+    const std::string &components, const std::vector<PointwiseInfo> &receivers,
+    double srcLat, double srcLon, double srcDep, int restartRow) {
+    mReceivers = &receivers;
+    mSrcLat = srcLat;
+    mSrcLon = srcLon;
+    mSrcDep = srcDep;
+    mCurrentRow = restartRow;
+
+    // local stations of each quantity
+    std::vector<int> locDisp, locStrain, locCurl;
+    for (int irec = 0; irec < receivers.size(); irec++) {
+        locDisp.push_back(irec);
+        if (receivers[irec].mDumpStrain) {
+            locStrain.push_back(irec);
+        }
+        if (receivers[irec].mDumpCurl) {
+            locCurl.push_back(irec);
+        }
+    }
+
+    // the root writes time
+    mWriteTime = XMPI::root();
+    std::string fbase = Parameters::sOutputDirectory + "/stations/axisem3d_synthetics";
+    create(mFileDisp, fbase + "." + components + ".bin", 3, locDisp,
+        totalRecordSteps, restartRow);
+    create(mFileStrain, fbase + ".RTZ.strain.bin", 6, locStrain,
+        totalRecordSteps, restartRow);
+    create(mFileCurl, fbase + ".RTZ.curl.bin", 3, locCurl,
+        totalRecordSteps, restartRow);
+}
+
+void PointwiseIOBinary::create(SharedFile &file, const std::string &fname, int ncomp,
+    const std::vector<int> &localStations, int totalRecordSteps, int restartRow) {
+    // global order
+    int numLoc = localStations.size();
+    std::vector<int> allNumLoc;
+    XMPI::gather(numLoc, allNumLoc, true);
+    file.mFileName = fname;
+    file.mNumComponents = ncomp;
+    file.mNumStations = 0;
+    for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+        if (iproc == XMPI::rank()) {
+            file.mFirstStation = file.mNumStations;
+        }
+        file.mNumStations += allNumLoc[iproc];
+    }
+    if (file.mNumStations == 0) {
+        return;
+    }
+    file.mTimeOffset = PointwiseBinary::sHeaderBytes;
+    int64_t timeEnd = file.mTimeOffset + (int64_t)totalRecordSteps * sizeof(double);
+    file.mDataOffset = (timeEnd + PointwiseBinary::sAlignment - 1)
+        / PointwiseBinary::sAlignment * PointwiseBinary::sAlignment;
+
+    // text index
+    std::vector<std::string> myKeys;
+    for (int irec: localStations) {
+        const PointwiseInfo &info = (*mReceivers)[irec];
+        std::stringstream ss;
+        ss << info.mNetwork + "." + info.mName << " " << std::setprecision(10)
+            << info.mLat << " " << info.mLon << " " << info.mDep;
+        myKeys.push_back(ss.str());
+    }
+    std::vector<std::vector<std::string>> allKeys;
+    XMPI::gather(myKeys, allKeys, false);
+
+    // header and size, on root
+    if (XMPI::root() && restartRow == 0) {
+        std::fstream fout(fname + ".index", std::fstream::out);
+        fout << "# INDEX NETWORK.NAME LATITUDE LONGITUDE DEPTH\n";
+        int index = 0;
+        for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+            for (const std::string &key: allKeys[iproc]) {
+                fout << index++ << " " << key << "\n";
+            }
+        }
+        fout.close();
+
+        PointwiseBinary::Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::strncpy(header.mMagic, "AX3DSYN", 8);
+        header.mVersion = 1;
+        header.mBytesPerValue = sizeof(Real);
+        header.mNumSteps = totalRecordSteps;
+        header.mNumStations = file.mNumStations;
+        header.mNumComponents = ncomp;
+        header.mTimeOffset = file.mTimeOffset;
+        header.mDataOffset = file.mDataOffset;
+        header.mSrcLat = mSrcLat;
+        header.mSrcLon = mSrcLon;
+        header.mSrcDep = mSrcDep;
+        std::fstream fs(fname, std::fstream::out | std::fstream::binary);
+        if (!fs) {
+            throw std::runtime_error("PointwiseIOBinary::create || "
+                "Error creating binary output file: || " + fname);
+        }
+        fs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        // allocate the whole file, so that every rank can seek into it
+        int64_t bytes = file.mDataOffset + (int64_t)totalRecordSteps
+            * file.mNumStations * ncomp * sizeof(Real);
+        fs.seekp(bytes - 1);
+        fs.put(0);
+        fs.close();
+    }
+    XMPI::barrier();
+
+    // open on ranks with stations or time
+    if (numLoc > 0 || mWriteTime) {
+        file.mStream = new std::fstream(fname,
+            std::fstream::in | std::fstream::out | std::fstream::binary);
+        if (!(*file.mStream)) {
+            throw std::runtime_error("PointwiseIOBinary::create || "
+                "Error opening binary output file: || " + fname);
+        }
+    }
+}
+
+void PointwiseIOBinary::finalize() {
+    for (SharedFile *file: {&mFileDisp, &mFileStrain, &mFileCurl}) {
+        if (file->mStream) {
+            file->mStream->close();
+            delete file->mStream;
+            file->mStream = 0;
+        }
+    }
+}
+
+void PointwiseIOBinary::dumpToFile(const RMatXX_RM &bufferDisp,
+    const RMatXX_RM &bufferStrain,
+    const RMatXX_RM &bufferCurl,
+    const RDColX &bufferTime, int bufferLine) {
+    if (bufferLine == 0) {
+        return;
+    }
+
+    // time
+    if (mWriteTime) {
+        for (SharedFile *file: {&mFileDisp, &mFileStrain, &mFileCurl}) {
+            if (file->mStream) {
+                file->mStream->seekp(file->mTimeOffset + (int64_t)mCurrentRow * sizeof(double));
+                file->mStream->write(reinterpret_cast<const char *>(bufferTime.data()),
+                    bufferLine * sizeof(double));
+            }
+        }
+    }
+
+    // data
+    write(mFileDisp, bufferDisp, bufferLine);
+    write(mFileStrain, bufferStrain, bufferLine);
+    write(mFileCurl, bufferCurl, bufferLine);
+    mCurrentRow += bufferLine;
+}
+
+void PointwiseIOBinary::write(SharedFile &file, const RMatXX_RM &buffer,
+    int bufferLine) const {
+    if (file.mStream == 0) {
+        return;
+    }
+    if (buffer.cols() > 0) {
+        // local stations of a row are contiguous in both buffer and file
+        for (int row = 0; row < bufferLine; row++) {
+            int64_t offset = file.mDataOffset + (((int64_t)(mCurrentRow + row)
+                * file.mNumStations + file.mFirstStation) * file.mNumComponents) * sizeof(Real);
+            file.mStream->seekp(offset);
+            file.mStream->write(reinterpret_cast<const char *>(buffer.row(row).data()),
+                buffer.cols() * sizeof(Real));
+        }
+    }
+}
+
+void PointwiseIOBinary::flush() {
+    for (SharedFile *file: {&mFileDisp, &mFileStrain, &mFileCurl}) {
+        if (file->mStream) {
+            file->mStream->flush();
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// PointwiseIOBinary.h
+// created by Kuangdai on 14-Oct-2026
+// flat binary IO for point-wise receivers, for memory-mapped reading
+
+#pragma once
+
+#include <fstream>
+#include <cstdint>
+#include "PointwiseIO.h"
+
+// File layout, little-endian as written by the solver:
+//   header, 4096 bytes:
+//     char[8] magic "AX3DSYN", int32 version, int32 bytes per value,
+//     int64 steps, int64 stations, int64 components,
+//     int64 offset of time, int64 offset of data,
+//     double source latitude, longitude, depth
+//   time:   double[steps]
+//   data:   Real[steps][stations][components], at a 4096-byte boundary
+// Stations are indexed in the text file <file>.index.
+class PointwiseIOBinary: public PointwiseIO {
+public:
+    // before time loop
+    void initialize(int totalRecordSteps, int bufferSize,
+        const std::string &components, const std::vector<PointwiseInfo> &receivers,
+        double srcLat, double srcLon, double srcDep, int restartRow);
+
+    // after time loop
+    void finalize();
+
+    // dump to user-specified format
+    void dumpToFile(const RMatXX_RM &bufferDisp,
+        const RMatXX_RM &bufferStrain,
+        const RMatXX_RM &bufferCurl,
+        const RDColX &bufferTime, int bufferLine);
+    
+    // flush dumped data to disk
+    void flush();
+
+private:
+    // a binary file shared by all ranks, each writing its own stations
+    struct SharedFile {
+        std::string mFileName;
+        std::fstream *mStream = 0;
+        // global
+        int64_t mNumStations = 0;
+        int64_t mNumComponents = 0;
+        int64_t mTimeOffset = 0;
+        int64_t mDataOffset = 0;
+        // local stations are contiguous in the global order
+        int64_t mFirstStation = 0;
+    };
+
+    // create files and index of a quantity
+    void create(SharedFile &file, const std::string &fname, int ncomp,
+        const std::vector<int> &localStations, int totalRecordSteps, int restartRow);
+    // write rows of a quantity
+    void write(SharedFile &file, const RMatXX_RM &buffer, int bufferLine) const;
+
+    SharedFile mFileDisp;
+    SharedFile mFileStrain;
+    SharedFile mFileCurl;
+
+    // for the index
+    const std::vector<PointwiseInfo> *mReceivers;
+    double mSrcLat, mSrcLon, mSrcDep;
+
+    // location in file
+    int mCurrentRow = 0;
+
+    // writes the time axis
+    bool mWriteTime = false;
+};
+
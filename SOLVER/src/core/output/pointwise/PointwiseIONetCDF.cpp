@@ -14,8 +14,10 @@
 
 void PointwiseIONetCDF::initialize(int totalRecordSteps, int bufferSize, 
     const std::string &components, const std::vector<PointwiseInfo> &receivers,
-    double srcLat, double srcLon, double srcDep) {
+    double srcLat, double srcLon, double srcDep, int restartRow) {
     mReceivers = &receivers;
+    // record postion in nc file
+    mCurrentRow = restartRow;
     // source location
     mSrcLat = srcLat;
     mSrcLon = srcLon;
@@ -137,6 +139,11 @@ void PointwiseIONetCDF::initialize(int totalRecordSteps, int bufferSize,
             std::stringstream fname;
             fname << Parameters::sOutputDirectory + "/stations/axisem3d_synthetics.nc.rank" 
                 << XMPI::rank() + XMPI::nproc() * ifile;
+            if (restartRow > 0) {
+                // continue the file of the run being restarted
+                mNetCDFs[ifile]->open(fname.str(), false);
+                continue;
+            }
             mNetCDFs[ifile]->open(fname.str(), true);
             mNetCDFs[ifile]->defModeOn();
             // define time
@@ -214,27 +221,30 @@ void PointwiseIONetCDF::initialize(int totalRecordSteps, int bufferSize,
         mNetCDFs = std::vector<NetCDF_Writer *>(1, new NetCDF_Writer());
         // open file on min rank and define all variables
         std::string fname = Parameters::sOutputDirectory + "/stations/axisem3d_synthetics.nc";
-        if (XMPI::rank() == mMinRankWithRec) {
+        if (XMPI::rank() == mMinRankWithRec && restartRow == 0) {
             mNetCDFs[0]->open(fname, true);
             mNetCDFs[0]->defModeOn();
+            // chunks aligned with the dumps, so that each rank writes 
+            // whole chunks of its own receivers
+            size_t chunkSteps = NetCDF_Writer::chunkTimeSteps(bufferSize);
             // define time
-            mNetCDFs[0]->defineVariable<double>("time_points", dimsTime);
+            mNetCDFs[0]->defineTimeSeries<double>("time_points", dimsTime, chunkSteps);
             // define seismograms
             for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
                 for (int irec = 0; irec < allNamesDisp[iproc].size(); irec++) {
-                    mNetCDFs[0]->defineVariable<Real>(allNamesDisp[iproc][irec], dimsSeis);
+                    mNetCDFs[0]->defineTimeSeries<Real>(allNamesDisp[iproc][irec], dimsSeis, chunkSteps);
                     mNetCDFs[0]->addAttribute(allNamesDisp[iproc][irec], "latitude", allLats[iproc][irec]);
                     mNetCDFs[0]->addAttribute(allNamesDisp[iproc][irec], "longitude", allLons[iproc][irec]);
                     mNetCDFs[0]->addAttribute(allNamesDisp[iproc][irec], "depth", allDeps[iproc][irec]);
                 }
                 for (int irec = 0; irec < allNamesStrain[iproc].size(); irec++) {
-                    mNetCDFs[0]->defineVariable<Real>(allNamesStrain[iproc][irec], dimsStrain);
+                    mNetCDFs[0]->defineTimeSeries<Real>(allNamesStrain[iproc][irec], dimsStrain, chunkSteps);
                     mNetCDFs[0]->addAttribute(allNamesStrain[iproc][irec], "latitude", allLats[iproc][allIndexStrain[iproc][irec]]);
                     mNetCDFs[0]->addAttribute(allNamesStrain[iproc][irec], "longitude", allLons[iproc][allIndexStrain[iproc][irec]]);
                     mNetCDFs[0]->addAttribute(allNamesStrain[iproc][irec], "depth", allDeps[iproc][allIndexStrain[iproc][irec]]);
                 }
                 for (int irec = 0; irec < allNamesCurl[iproc].size(); irec++) {
-                    mNetCDFs[0]->defineVariable<Real>(allNamesCurl[iproc][irec], dimsCurl);
+                    mNetCDFs[0]->defineTimeSeries<Real>(allNamesCurl[iproc][irec], dimsCurl, chunkSteps);
                     mNetCDFs[0]->addAttribute(allNamesCurl[iproc][irec], "latitude", allLats[iproc][allIndexCurl[iproc][irec]]);
                     mNetCDFs[0]->addAttribute(allNamesCurl[iproc][irec], "longitude", allLons[iproc][allIndexCurl[iproc][irec]]);
                     mNetCDFs[0]->addAttribute(allNamesCurl[iproc][irec], "depth", allDeps[iproc][allIndexCurl[iproc][irec]]);
@@ -264,9 +274,6 @@ void PointwiseIONetCDF::initialize(int totalRecordSteps, int bufferSize,
         XMPI::barrier();
         mNetCDFs[0]->openParallel(fname);
     #endif
-    
-    // record postion in nc file
-    mCurrentRow = 0;
 }
 
 void PointwiseIONetCDF::finalize() {
@@ -313,20 +320,67 @@ void PointwiseIONetCDF::finalize() {
     dimsCurl.push_back(mCurrentRow);
     dimsCurl.push_back(3);
     
-    // create file 
-    if (XMPI::rank() == mMinRankWithRec) {
+    // gather all variables, so that they are defined in one pass and the
+    // ranks below only write their own data, without redefining the file
+    int numRec = mVarNamesDisp.size();
+    int numStrainRec = mVarNamesStrain.size();
+    int numCurlRec = mVarNamesCurl.size();
+    std::vector<double> mylats, mylons, mydeps;
+    for (int irec = 0; irec < numRec; irec++) {
+        mylats.push_back((*mReceivers)[irec].mLat);
+        mylons.push_back((*mReceivers)[irec].mLon);
+        mydeps.push_back((*mReceivers)[irec].mDep);
+    }
+    std::vector<int> allNumRec;
+    std::vector<std::vector<std::string>> allNamesDisp, allNamesStrain, allNamesCurl; 
+    std::vector<std::vector<int>> allIndexStrain, allIndexCurl;
+    std::vector<std::vector<double>> allLats, allLons, allDeps;
+    XMPI::gather(numRec, allNumRec, true);
+    XMPI::gather(mVarNamesDisp, allNamesDisp, false);
+    XMPI::gather(mVarNamesStrain, allNamesStrain, false);
+    XMPI::gather(mStrainIndex, allIndexStrain, MPI_INT, false);
+    XMPI::gather(mVarNamesCurl, allNamesCurl, false);
+    XMPI::gather(mCurlIndex, allIndexCurl, MPI_INT, false);
+    XMPI::gather(mylats, allLats, MPI_DOUBLE, false);
+    XMPI::gather(mylons, allLons, MPI_DOUBLE, false);
+    XMPI::gather(mydeps, allDeps, MPI_DOUBLE, false);
+    
+    // create file on root
+    if (XMPI::root()) {
         // read time
+        std::stringstream minFile;
+        minFile << Parameters::sOutputDirectory + "/stations/axisem3d_synthetics.nc.rank" << mMinRankWithRec;
         NetCDF_Reader nr;
-        nr.open(locFile);
+        nr.open(minFile.str());
         RDColX times;
         nr.read1D("time_points", times);
         nr.close();
         
-        // create file and write time
+        // create file and define all variables
         NetCDF_Writer nw;
         nw.open(oneFile, true);
         nw.defModeOn();
         nw.defineVariable<double>("time_points", dimsTime);
+        for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+            for (int irec = 0; irec < allNamesDisp[iproc].size(); irec++) {
+                nw.defineVariable<Real>(allNamesDisp[iproc][irec], dimsSeis);
+                nw.addAttribute(allNamesDisp[iproc][irec], "latitude", allLats[iproc][irec]);
+                nw.addAttribute(allNamesDisp[iproc][irec], "longitude", allLons[iproc][irec]);
+                nw.addAttribute(allNamesDisp[iproc][irec], "depth", allDeps[iproc][irec]);
+            }
+            for (int irec = 0; irec < allNamesStrain[iproc].size(); irec++) {
+                nw.defineVariable<Real>(allNamesStrain[iproc][irec], dimsStrain);
+                nw.addAttribute(allNamesStrain[iproc][irec], "latitude", allLats[iproc][allIndexStrain[iproc][irec]]);
+                nw.addAttribute(allNamesStrain[iproc][irec], "longitude", allLons[iproc][allIndexStrain[iproc][irec]]);
+                nw.addAttribute(allNamesStrain[iproc][irec], "depth", allDeps[iproc][allIndexStrain[iproc][irec]]);
+            }
+            for (int irec = 0; irec < allNamesCurl[iproc].size(); irec++) {
+                nw.defineVariable<Real>(allNamesCurl[iproc][irec], dimsCurl);
+                nw.addAttribute(allNamesCurl[iproc][irec], "latitude", allLats[iproc][allIndexCurl[iproc][irec]]);
+                nw.addAttribute(allNamesCurl[iproc][irec], "longitude", allLons[iproc][allIndexCurl[iproc][irec]]);
+                nw.addAttribute(allNamesCurl[iproc][irec], "depth", allDeps[iproc][allIndexCurl[iproc][irec]]);
+            }
+        }
         nw.defModeOff();
         nw.writeVariableWhole("time_points", times);
         
@@ -336,62 +390,48 @@ void PointwiseIONetCDF::finalize() {
         nw.addAttribute("", "source_depth", mSrcDep);
         nw.close();
     }
+    
+    // read local seismograms while root defines, unless too large to hold
+    std::vector<std::string> varNames(mVarNamesDisp);
+    varNames.insert(varNames.end(), mVarNamesStrain.begin(), mVarNamesStrain.end());
+    varNames.insert(varNames.end(), mVarNamesCurl.begin(), mVarNamesCurl.end());
+    size_t localBytes = (size_t)mCurrentRow * (numRec * 3 + numStrainRec * 6 + numCurlRec * 3) * sizeof(Real);
+    bool prefetch = localBytes <= mMaxMergePrefetchBytes;
+    std::vector<RMatXX_RM> seismograms;
+    if (numRec > 0 && prefetch) {
+        NetCDF_Reader nr;
+        nr.open(locFile);
+        seismograms.resize(varNames.size());
+        for (int ivar = 0; ivar < varNames.size(); ivar++) {
+            nr.read2D(varNames[ivar], seismograms[ivar]);
+        }
+        nr.close();
+    }
     XMPI::barrier();
     
-    // write seismograms
-    int numRec = mVarNamesDisp.size();
-    int numStrainRec = mVarNamesStrain.size();
-    int numCurlRec = mVarNamesCurl.size();
+    // write seismograms in turn, by the ranks with receivers
     for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
-        if (iproc == XMPI::rank() && numRec > 0) {
-            // open
-            NetCDF_Reader nr;
-            nr.open(locFile);
+        if (allNumRec[iproc] == 0) {
+            continue;
+        }
+        if (iproc == XMPI::rank()) {
             NetCDF_Writer nw;
             nw.open(oneFile, false);
-            
-            // create variable
-            nw.defModeOn();
-            for (int irec = 0; irec < numRec; irec++) {
-                nw.defineVariable<Real>(mVarNamesDisp[irec], dimsSeis);
-                nw.addAttribute(mVarNamesDisp[irec], "latitude", (*mReceivers)[irec].mLat);
-                nw.addAttribute(mVarNamesDisp[irec], "longitude", (*mReceivers)[irec].mLon);
-                nw.addAttribute(mVarNamesDisp[irec], "depth", (*mReceivers)[irec].mDep);
-            }
-            for (int irec = 0; irec < numStrainRec; irec++) {
-                nw.defineVariable<Real>(mVarNamesStrain[irec], dimsStrain);
-                nw.addAttribute(mVarNamesStrain[irec], "latitude", (*mReceivers)[mStrainIndex[irec]].mLat);
-                nw.addAttribute(mVarNamesStrain[irec], "longitude", (*mReceivers)[mStrainIndex[irec]].mLon);
-                nw.addAttribute(mVarNamesStrain[irec], "depth", (*mReceivers)[mStrainIndex[irec]].mDep);
-            }
-            for (int irec = 0; irec < numCurlRec; irec++) {
-                nw.defineVariable<Real>(mVarNamesCurl[irec], dimsCurl);
-                nw.addAttribute(mVarNamesCurl[irec], "latitude", (*mReceivers)[mCurlIndex[irec]].mLat);
-                nw.addAttribute(mVarNamesCurl[irec], "longitude", (*mReceivers)[mCurlIndex[irec]].mLon);
-                nw.addAttribute(mVarNamesCurl[irec], "depth", (*mReceivers)[mCurlIndex[irec]].mDep);
-            }
-            nw.defModeOff();
-            
-            // read and write seismograms
-            for (int irec = 0; irec < numRec; irec++) {
-                RMatXX_RM seis;
-                nr.read2D(mVarNamesDisp[irec], seis);
-                nw.writeVariableWhole(mVarNamesDisp[irec], seis);
-            }
-            for (int irec = 0; irec < numStrainRec; irec++) {
-                RMatXX_RM seis;
-                nr.read2D(mVarNamesStrain[irec], seis);
-                nw.writeVariableWhole(mVarNamesStrain[irec], seis);
-            }
-            for (int irec = 0; irec < numCurlRec; irec++) {
-                RMatXX_RM seis;
-                nr.read2D(mVarNamesCurl[irec], seis);
-                nw.writeVariableWhole(mVarNamesCurl[irec], seis);
+            if (prefetch) {
+                for (int ivar = 0; ivar < varNames.size(); ivar++) {
+                    nw.writeVariableWhole(varNames[ivar], seismograms[ivar]);
+                }
+            } else {
+                NetCDF_Reader nr;
+                nr.open(locFile);
+                for (int ivar = 0; ivar < varNames.size(); ivar++) {
+                    RMatXX_RM seis;
+                    nr.read2D(varNames[ivar], seis);
+                    nw.writeVariableWhole(varNames[ivar], seis);
+                }
+                nr.close();
             }
-            
-            // close
             nw.close();
-            nr.close();
         }
         XMPI::barrier();
     } 
@@ -473,8 +513,9 @@ void PointwiseIONetCDF::dumpToFile(const RMatXX_RM &bufferDisp,
     #ifndef NDEBUG
         Eigen::internal::set_is_malloc_allowed(false);
     #endif
-    
-    // flush to disk
+}
+
+void PointwiseIONetCDF::flush() {
     for (int ifile = 0; ifile < mNetCDFs.size(); ifile++) {
         mNetCDFs[ifile]->flush();
     }
@@ -16,7 +16,7 @@ public:
     // before time loop
     void initialize(int totalRecordSteps, int bufferSize, 
         const std::string &components, const std::vector<PointwiseInfo> &receivers, 
-        double srcLat, double srcLon, double srcDep);
+        double srcLat, double srcLon, double srcDep, int restartRow);
     
     // after time loop
     void finalize();
@@ -27,6 +27,9 @@ public:
         const RMatXX_RM &bufferCurl, 
         const RDColX &bufferTime, int bufferLine);
     
+    // flush dumped data to disk
+    void flush();
+    
 private:
     // receivers
     const std::vector<PointwiseInfo> *mReceivers;
@@ -55,5 +58,8 @@ private:
     
     // maximum number of stations per file
     const int mMaxNumRecPerFile = 10000;
+    
+    // local seismograms read before the merge up to this size
+    const size_t mMaxMergePrefetchBytes = 256 << 20;
 };
 
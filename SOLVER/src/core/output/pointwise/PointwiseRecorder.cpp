@@ -5,17 +5,28 @@
 #include "PointwiseRecorder.h"
 #include "Element.h"
 #include "PointwiseIO.h"
+#include "NetCDF_Writer.h"
+#include "IOFlush.h"
+#include "Checkpoint.h"
+#include "Parameters.h"
+#include "XMPI.h"
+#include <mutex>
+#include <map>
+#include <tuple>
+#include <sstream>
 
 PointwiseRecorder::PointwiseRecorder(int totalRecordSteps, int recordInterval, 
     int bufferSize, const std::string &components, 
-    double srcLat, double srcLon, double srcDep): 
+    double srcLat, double srcLon, double srcDep, 
+    const PointwiseFilter &filter): 
 mTotalRecordSteps(totalRecordSteps),
 mRecordInterval(recordInterval), mBufferSize(bufferSize), mComponents(components),
-mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
+mFilter(filter), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
     mBufferLine = 0;
 }
 
 PointwiseRecorder::~PointwiseRecorder() {
+    waitForIO();
     for (const auto &io: mIOs) {
         delete io;
     }
@@ -23,13 +34,116 @@ PointwiseRecorder::~PointwiseRecorder() {
 
 void PointwiseRecorder::addReceiver(const std::string &name, const std::string &network, 
     double phi, const RDMatPP &weights, const Element *ele, double theta, double baz,
-    double lat, double lon, double dep, bool dumpStrain, bool dumpCurl) {
-    mPointwiseInfo.push_back(PointwiseInfo(name, network, phi, weights, ele, theta, baz, 
-        lat, lon, dep, dumpStrain, dumpCurl));
+    double lat, double lon, double dep, bool dumpStrain, bool dumpCurl,
+    double windowBegin, double windowEnd, int decimation) {
+    PointwiseInfo info(name, network, phi, weights, ele, theta, baz, 
+        lat, lon, dep, dumpStrain, dumpCurl);
+    info.mWindowBegin = windowBegin;
+    info.mWindowEnd = windowEnd;
+    info.mDecimation = std::max(decimation, 1);
+    if (info.windowed()) {
+        mWindowedInfo.push_back(info);
+    } else {
+        mPointwiseInfo.push_back(info);
+    }
 }
 
-void PointwiseRecorder::initialize() {
+void PointwiseGroup::computeGroundMotion() {
+    if (mSparse) {
+        mElement->feedDisplFourier(mPoints, mDispl);
+    } else {
+        mElement->feedDisplFourier(mDispl);
+    }
+    mProj.noalias() = mWeights * mDispl;
+    int nu1 = mExpPhi.cols();
+    for (int idim = 0; idim < 3; idim++) {
+        mGroundMotion.col(idim) = mProj.middleCols(idim * nu1, nu1)
+            .cwiseProduct(mExpPhi).rowwise().sum().real();
+    }
+}
+
+void PointwiseRecorder::formGroups(std::vector<PointwiseInfo> &infos, 
+    std::vector<PointwiseGroup> &groups) {
+    // group receivers by element, and by schedule so that the receivers
+    // of a group are recorded together
+    std::map<std::tuple<const Element *, double, double, int>, int> groupOfKey;
+    for (int irec = 0; irec < infos.size(); irec++) {
+        const PointwiseInfo &info = infos[irec];
+        auto key = std::make_tuple(info.mElement, info.mWindowBegin, info.mWindowEnd, info.mDecimation);
+        if (groupOfKey.find(key) == groupOfKey.end()) {
+            groupOfKey.insert(std::make_pair(key, groups.size()));
+            groups.push_back(PointwiseGroup());
+            groups.back().mElement = info.mElement;
+        }
+        groups[groupOfKey.at(key)].mReceivers.push_back(irec);
+    }
+    for (auto &info: infos) {
+        info.mExpPhi = info.mElement->formPhaseTable(info.mPhi);
+        info.mSparseWeights.clear();
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                if (std::abs(info.mWeights(ipol, jpol)) >= tinyDouble) {
+                    info.mSparseWeights.push_back(std::make_pair(ipol * nPntEdge + jpol, 
+                        info.mWeights(ipol, jpol)));
+                }
+            }
+        }
+    }
+    for (auto &group: groups) {
+        int nrec = group.mReceivers.size();
+        int maxNu = group.mElement->getMaxNu();
+        // points with nonzero weights of any receiver in the group
+        std::map<int, int> columnOfPoint;
+        for (int k = 0; k < nrec; k++) {
+            for (const auto &pw: infos[group.mReceivers[k]].mSparseWeights) {
+                columnOfPoint.insert(std::make_pair(pw.first, 0));
+            }
+        }
+        group.mPoints.clear();
+        for (auto &it: columnOfPoint) {
+            it.second = group.mPoints.size();
+            group.mPoints.push_back(it.first);
+        }
+        // read from the points directly if that skips any
+        int npnt = group.mPoints.size();
+        group.mDispl = CMatXX::Zero(npnt, 3 * (maxNu + 1));
+        group.mSparse = npnt < nPntElem && 
+            group.mElement->feedDisplFourier(group.mPoints, group.mDispl);
+        if (!group.mSparse) {
+            npnt = nPntElem;
+            for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+                columnOfPoint[ipnt] = ipnt;
+            }
+        }
+        group.mWeights = CMatXX::Zero(nrec, npnt);
+        group.mExpPhi = CMatXX::Zero(nrec, maxNu + 1);
+        for (int k = 0; k < nrec; k++) {
+            const PointwiseInfo &info = infos[group.mReceivers[k]];
+            for (const auto &pw: info.mSparseWeights) {
+                group.mWeights(k, columnOfPoint.at(pw.first)) = pw.second;
+            }
+            group.mExpPhi.block(k, 0, 1, info.mExpPhi.size()) = info.mExpPhi.transpose();
+        }
+        group.mDispl = CMatXX::Zero(npnt, 3 * (maxNu + 1));
+        group.mProj = CMatXX::Zero(nrec, 3 * (maxNu + 1));
+        group.mGroundMotion = RMatX3::Zero(nrec, 3);
+    }
+}
+
+void PointwiseRecorder::initialize(int restartStep) {
     int numRec = mPointwiseInfo.size();
+    formGroups(mPointwiseInfo, mPointwiseGroups);
+    
+    // windowed receivers are subsampled without the anti-alias filter
+    if (mWindowedInfo.size() > 0 && !mFilter.isIdentity()) {
+        throw std::runtime_error("PointwiseRecorder::initialize || "
+            "Station windows and decimation cannot be combined with || "
+            "OUT_STATIONS_DECIMATION > 1 or OUT_STATIONS_QUANTITY other than displ.");
+    }
+    formGroups(mWindowedInfo, mWindowedGroups);
+    mWindowedTime = std::vector<std::vector<double>>(mWindowedInfo.size());
+    mWindowedRecords = std::vector<std::vector<Real>>(mWindowedInfo.size());
+    
     mBufferDisp = RMatXX_RM::Zero(mBufferSize, numRec * 3);
     mBufferTime = RDColX::Zero(mBufferSize);
     int numStrainRec = 0;
@@ -47,16 +161,45 @@ void PointwiseRecorder::initialize() {
         }
     }
     mBufferCurl = RMatXX_RM::Zero(mBufferSize, numCurlRec * 3);
+    
+    // double buffering
+    mWriteDisp = mBufferDisp;
+    mWriteStrain = mBufferStrain;
+    mWriteCurl = mBufferCurl;
+    mWriteTime = mBufferTime;
+    
+    // filter, differentiating the displacement
+    int numChannels = mBufferDisp.cols() + mBufferStrain.cols() + mBufferCurl.cols();
+    mFilter.initialize(numChannels, mBufferDisp.cols());
+    mFilterIn = RRowX::Zero(numChannels);
+    mFilterOut = RRowX::Zero(numChannels);
+    
+    // all records before a checkpoint are on disk
+    int restartRow = mFilter.numOutputs((restartStep + mRecordInterval - 1) / mRecordInterval);
     for (const auto &io: mIOs) {
         io->initialize(mTotalRecordSteps, mBufferSize, mComponents, mPointwiseInfo,
-            mSrcLat, mSrcLon, mSrcDep);
+            mSrcLat, mSrcLon, mSrcDep, restartRow);
     }
 }
 
 void PointwiseRecorder::finalize() {
+    // outputs delayed by the filter
+    double t;
+    while (mFilter.flush(mFilterOut, t)) {
+        mBufferTime(mBufferLine) = t;
+        setLine(mFilterOut);
+        mBufferLine++;
+        if (mBufferLine == mBufferSize) {
+            dumpToFile();
+        }
+    }
+    dumpToFile();
+    waitForIO();
     for (const auto &io: mIOs) {
         io->finalize();
     }
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+    writeWindowed();
 }
 
 void PointwiseRecorder::record(int tstep, double t) {
@@ -64,33 +207,24 @@ void PointwiseRecorder::record(int tstep, double t) {
         return;
     }
     
+    // windowed receivers, skipped outside their windows
+    recordWindowed(tstep / mRecordInterval, t);
+    
     // time
     mBufferTime(mBufferLine) = t;
     
-    // get disp
+    // get disp, once per element
+    for (auto &group: mPointwiseGroups) {
+        group.computeGroundMotion();
+        for (int k = 0; k < group.mReceivers.size(); k++) {
+            mBufferDisp.block(mBufferLine, group.mReceivers[k] * 3, 1, 3) = group.mGroundMotion.row(k);
+        }
+    }
     static RRow3 gm;
     for (int irec = 0; irec < mPointwiseInfo.size(); irec++) {
-        // compute from element, in SPZ
-        mPointwiseInfo[irec].mElement->computeGroundMotion(mPointwiseInfo[irec].mPhi, 
-            mPointwiseInfo[irec].mWeights, gm);
-        if (mComponents != "SPZ") {
-            // transform
-            Real cost = cos(mPointwiseInfo[irec].mTheta);
-            Real sint = sin(mPointwiseInfo[irec].mTheta);
-            Real ur = gm(0) * sint + gm(2) * cost; 
-            Real ut = gm(0) * cost - gm(2) * sint;
-            if (mComponents == "ENZ") {
-                Real cosbaz = cos(mPointwiseInfo[irec].mBAz);
-                Real sinbaz = sin(mPointwiseInfo[irec].mBAz);
-                gm(0) = -ut * sinbaz + gm(1) * cosbaz;
-                gm(1) = -ut * cosbaz - gm(1) * sinbaz;
-                gm(2) = ur;
-            } else { 
-                // RTZ
-                gm(0) = ut;
-                gm(2) = ur;
-            }
-        }    
+        // in SPZ
+        gm = mBufferDisp.block(mBufferLine, irec * 3, 1, 3);
+        rotateDispl(mPointwiseInfo[irec], gm);
         // write to buffer
         mBufferDisp.block(mBufferLine, irec * 3, 1, 3) = gm;
     }
@@ -101,7 +235,7 @@ void PointwiseRecorder::record(int tstep, double t) {
     for (int irec = 0; irec < mPointwiseInfo.size(); irec++) {
         if (mPointwiseInfo[irec].mDumpStrain) {
             // compute from element, in RTZ
-            mPointwiseInfo[irec].mElement->computeStrain(mPointwiseInfo[irec].mPhi, 
+            mPointwiseInfo[irec].mElement->computeStrain(mPointwiseInfo[irec].mExpPhi, 
                 mPointwiseInfo[irec].mWeights, strain);
             // write to buffer
             mBufferStrain.block(mBufferLine, istrain * 6, 1, 6) = strain;
@@ -115,25 +249,24 @@ void PointwiseRecorder::record(int tstep, double t) {
     for (int irec = 0; irec < mPointwiseInfo.size(); irec++) {
         if (mPointwiseInfo[irec].mDumpCurl) {
             // compute from element, in RTZ
-            mPointwiseInfo[irec].mElement->computeCurl(mPointwiseInfo[irec].mPhi, 
+            mPointwiseInfo[irec].mElement->computeCurl(mPointwiseInfo[irec].mExpPhi, 
                 mPointwiseInfo[irec].mWeights, curl);
-            if (mComponents == "ENZ") {
-                // transform
-                Real ur = curl(2);
-                Real ut = curl(0);
-                Real up = curl(1);
-                Real cosbaz = cos(mPointwiseInfo[irec].mBAz);
-                Real sinbaz = sin(mPointwiseInfo[irec].mBAz);
-                curl(0) = -ut * sinbaz + up * cosbaz;
-                curl(1) = -ut * cosbaz - up * sinbaz;
-                curl(2) = ur;
-            }        
+            rotateCurl(mPointwiseInfo[irec], curl);
             // write to buffer
             mBufferCurl.block(mBufferLine, icurl * 3, 1, 3) = curl;
             icurl++;
         }
     }
     
+    // filter and decimate, keeping the line until an output is ready
+    if (!mFilter.isIdentity()) {
+        getLine(mFilterIn);
+        if (!mFilter.push(mFilterIn, t, mFilterOut, mBufferTime(mBufferLine))) {
+            return;
+        }
+        setLine(mFilterOut);
+    }
+    
     // increment buffer line
     mBufferLine++;
     
@@ -143,10 +276,249 @@ void PointwiseRecorder::record(int tstep, double t) {
     }
 }
 
+void PointwiseRecorder::rotateDispl(const PointwiseInfo &info, RRow3 &gm) const {
+    if (mComponents == "SPZ") {
+        return;
+    }
+    Real cost = cos(info.mTheta);
+    Real sint = sin(info.mTheta);
+    Real ur = gm(0) * sint + gm(2) * cost; 
+    Real ut = gm(0) * cost - gm(2) * sint;
+    if (mComponents == "ENZ") {
+        Real cosbaz = cos(info.mBAz);
+        Real sinbaz = sin(info.mBAz);
+        gm(0) = -ut * sinbaz + gm(1) * cosbaz;
+        gm(1) = -ut * cosbaz - gm(1) * sinbaz;
+        gm(2) = ur;
+    } else { 
+        // RTZ
+        gm(0) = ut;
+        gm(2) = ur;
+    }
+}
+
+void PointwiseRecorder::rotateCurl(const PointwiseInfo &info, RRow3 &curl) const {
+    if (mComponents != "ENZ") {
+        return;
+    }
+    Real ur = curl(2);
+    Real ut = curl(0);
+    Real up = curl(1);
+    Real cosbaz = cos(info.mBAz);
+    Real sinbaz = sin(info.mBAz);
+    curl(0) = -ut * sinbaz + up * cosbaz;
+    curl(1) = -ut * cosbaz - up * sinbaz;
+    curl(2) = ur;
+}
+
+void PointwiseRecorder::recordWindowed(int irecord, double t) {
+    static RRow3 gm;
+    static RRow6 strain;
+    static RRow3 curl;
+    for (auto &group: mWindowedGroups) {
+        // a group shares the schedule of its receivers
+        if (!mWindowedInfo[group.mReceivers[0]].active(irecord, t)) {
+            continue;
+        }
+        group.computeGroundMotion();
+        for (int k = 0; k < group.mReceivers.size(); k++) {
+            int irec = group.mReceivers[k];
+            const PointwiseInfo &info = mWindowedInfo[irec];
+            std::vector<Real> &records = mWindowedRecords[irec];
+            gm = group.mGroundMotion.row(k);
+            rotateDispl(info, gm);
+            records.insert(records.end(), gm.data(), gm.data() + 3);
+            if (info.mDumpStrain) {
+                info.mElement->computeStrain(info.mExpPhi, info.mWeights, strain);
+                records.insert(records.end(), strain.data(), strain.data() + 6);
+            }
+            if (info.mDumpCurl) {
+                info.mElement->computeCurl(info.mExpPhi, info.mWeights, curl);
+                rotateCurl(info, curl);
+                records.insert(records.end(), curl.data(), curl.data() + 3);
+            }
+            mWindowedTime[irec].push_back(t);
+        }
+    }
+}
+
+void PointwiseRecorder::writeWindowed() const {
+    // one file per rank with windowed receivers, each receiver with 
+    // a length of its own
+    int numRec = 0;
+    for (int irec = 0; irec < mWindowedInfo.size(); irec++) {
+        numRec += mWindowedTime[irec].size() > 0;
+    }
+    if (numRec == 0) {
+        return;
+    }
+    std::stringstream fname;
+    fname << Parameters::sOutputDirectory + "/stations/axisem3d_synthetics_windowed.nc.rank" 
+        << XMPI::rank();
+    NetCDF_Writer nw;
+    nw.open(fname.str(), true);
+    nw.defModeOn();
+    for (int irec = 0; irec < mWindowedInfo.size(); irec++) {
+        const PointwiseInfo &info = mWindowedInfo[irec];
+        size_t nrow = mWindowedTime[irec].size();
+        if (nrow == 0) {
+            continue;
+        }
+        std::string key = info.mNetwork + "." + info.mName;
+        nw.defineVariable<double>(key + ".time_points", {nrow});
+        nw.defineVariable<Real>(key + "." + mComponents, {nrow, 3});
+        nw.addAttribute(key + "." + mComponents, "latitude", info.mLat);
+        nw.addAttribute(key + "." + mComponents, "longitude", info.mLon);
+        nw.addAttribute(key + "." + mComponents, "depth", info.mDep);
+        if (info.mDumpStrain) {
+            nw.defineVariable<Real>(key + ".RTZ.strain", {nrow, 6});
+        }
+        if (info.mDumpCurl) {
+            nw.defineVariable<Real>(key + ".RTZ.curl", {nrow, 3});
+        }
+    }
+    nw.defModeOff();
+    for (int irec = 0; irec < mWindowedInfo.size(); irec++) {
+        const PointwiseInfo &info = mWindowedInfo[irec];
+        size_t nrow = mWindowedTime[irec].size();
+        if (nrow == 0) {
+            continue;
+        }
+        std::string key = info.mNetwork + "." + info.mName;
+        nw.writeVariableWhole(key + ".time_points", mWindowedTime[irec]);
+        // split the rows into the channels of the receiver
+        int nch = info.numChannels();
+        const std::vector<Real> &records = mWindowedRecords[irec];
+        std::vector<Real> disp, strain, curl;
+        for (size_t irow = 0; irow < nrow; irow++) {
+            const Real *row = records.data() + irow * nch;
+            disp.insert(disp.end(), row, row + 3);
+            row += 3;
+            if (info.mDumpStrain) {
+                strain.insert(strain.end(), row, row + 6);
+                row += 6;
+            }
+            if (info.mDumpCurl) {
+                curl.insert(curl.end(), row, row + 3);
+            }
+        }
+        nw.writeVariableWhole(key + "." + mComponents, disp);
+        if (info.mDumpStrain) {
+            nw.writeVariableWhole(key + ".RTZ.strain", strain);
+        }
+        if (info.mDumpCurl) {
+            nw.writeVariableWhole(key + ".RTZ.curl", curl);
+        }
+    }
+    nw.addAttribute("", "source_latitude", mSrcLat);
+    nw.addAttribute("", "source_longitude", mSrcLon);
+    nw.addAttribute("", "source_depth", mSrcDep);
+    nw.close();
+}
+
+void PointwiseRecorder::syncState(Checkpoint &cp) {
+    mFilter.syncState(cp);
+    // records of the windowed receivers so far
+    for (int irec = 0; irec < mWindowedInfo.size(); irec++) {
+        int nrow = mWindowedTime[irec].size();
+        cp.syncValue(nrow);
+        if (!cp.saving()) {
+            mWindowedTime[irec].resize(nrow);
+            mWindowedRecords[irec].resize((size_t)nrow * mWindowedInfo[irec].numChannels());
+        }
+        cp.sync(mWindowedTime[irec].data(), mWindowedTime[irec].size() * sizeof(double));
+        cp.sync(mWindowedRecords[irec].data(), mWindowedRecords[irec].size() * sizeof(Real));
+    }
+}
+
 void PointwiseRecorder::dumpToFile() {
+    // the previous buffer is still being written
+    waitForIO();
+    
+    // swap buffers without copy
+    mBufferDisp.swap(mWriteDisp);
+    mBufferStrain.swap(mWriteStrain);
+    mBufferCurl.swap(mWriteCurl);
+    mBufferTime.swap(mWriteTime);
+    mWriteLine = mBufferLine;
+    mBufferLine = 0;
+    
+    #if defined(_USE_PARALLEL_NETCDF) || !defined(NDEBUG)
+        // collective writes must be issued by the main thread, 
+        // and Eigen's malloc guard is shared by all threads
+        writeBuffer();
+    #else
+        mWriter = std::thread(&PointwiseRecorder::writeBuffer, this);
+    #endif
+}
+
+void PointwiseRecorder::waitForIO() {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+}
+
+void PointwiseRecorder::writeBuffer() {
+    // NetCDF and HDF5 are not thread-safe
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
     for (const auto &io: mIOs) {
-        io->dumpToFile(mBufferDisp, mBufferStrain, mBufferCurl, mBufferTime, mBufferLine);
+        io->dumpToFile(mWriteDisp, mWriteStrain, mWriteCurl, mWriteTime, mWriteLine);
     }
-    mBufferLine = 0;
+    if (IOFlush::due(mNumDumps)) {
+        for (const auto &io: mIOs) {
+            io->flush();
+        }
+    }
+}
+
+void PointwiseRecorder::flush() {
+    waitForIO();
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+    for (const auto &io: mIOs) {
+        io->flush();
+    }
+}
+
+void PointwiseRecorder::getLine(RRowX &row) const {
+    int nd = mBufferDisp.cols();
+    int ns = mBufferStrain.cols();
+    int nc = mBufferCurl.cols();
+    row.segment(0, nd) = mBufferDisp.row(mBufferLine);
+    row.segment(nd, ns) = mBufferStrain.row(mBufferLine);
+    row.segment(nd + ns, nc) = mBufferCurl.row(mBufferLine);
+}
+
+void PointwiseRecorder::setLine(const RRowX &row) {
+    int nd = mBufferDisp.cols();
+    int ns = mBufferStrain.cols();
+    int nc = mBufferCurl.cols();
+    mBufferDisp.row(mBufferLine) = row.segment(0, nd);
+    mBufferStrain.row(mBufferLine) = row.segment(nd, ns);
+    mBufferCurl.row(mBufferLine) = row.segment(nd + ns, nc);
 }
 
+size_t PointwiseRecorder::memoryBytes() const {
+    size_t bytes = sizeof(*this) + 
+        heapBytes(mBufferDisp) + heapBytes(mBufferStrain) + heapBytes(mBufferCurl) + 
+        heapBytes(mBufferTime) + heapBytes(mWriteDisp) + heapBytes(mWriteStrain) + 
+        heapBytes(mWriteCurl) + heapBytes(mWriteTime) + heapBytes(mFilterIn) + heapBytes(mFilterOut) + 
+        heapBytes(mPointwiseInfo) + heapBytes(mPointwiseGroups);
+    bytes += heapBytes(mWindowedInfo) + heapBytes(mWindowedGroups) + 
+        heapBytes(mWindowedTime) + heapBytes(mWindowedRecords);
+    for (int irec = 0; irec < mWindowedInfo.size(); irec++) {
+        bytes += heapBytes(mWindowedTime[irec]) + heapBytes(mWindowedRecords[irec]);
+    }
+    for (const std::vector<PointwiseInfo> *infos: {&mPointwiseInfo, &mWindowedInfo}) {
+        for (const PointwiseInfo &info: *infos) {
+            bytes += heapBytes(info.mExpPhi) + heapBytes(info.mSparseWeights);
+        }
+    }
+    for (const std::vector<PointwiseGroup> *groups: {&mPointwiseGroups, &mWindowedGroups}) {
+        for (const PointwiseGroup &group: *groups) {
+            bytes += heapBytes(group.mReceivers) + heapBytes(group.mWeights) + heapBytes(group.mPoints) + 
+                heapBytes(group.mExpPhi) + heapBytes(group.mDispl) + 
+                heapBytes(group.mProj) + heapBytes(group.mGroundMotion);
+        }
+    }
+    return bytes;
+}
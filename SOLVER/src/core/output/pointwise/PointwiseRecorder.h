@@ -6,8 +6,14 @@
 
 #include "eigenc.h"
 #include "eigenp.h"
+#include "PointwiseFilter.h"
+#include <thread>
+#include <vector>
+#include <utility>
+#include <cfloat>
 class Element;
 class PointwiseIO;
+class Checkpoint;
 
 // receiver info
 struct PointwiseInfo {
@@ -27,6 +33,11 @@ struct PointwiseInfo {
     //// to compute disp from Element
     double mPhi;
     RMatPP mWeights;
+    // nonzero weights as (point in element, weight), formed at initialize;
+    // a single pair for a receiver on a GLL point
+    std::vector<std::pair<int, Real>> mSparseWeights;
+    // azimuthal factors at mPhi, formed at initialize
+    CColX mExpPhi;
     const Element *mElement;
     
     //// to transform disp to RTZ or ENZ
@@ -41,22 +52,68 @@ struct PointwiseInfo {
     
     // dump curl
     bool mDumpCurl;
+    
+    // time window and decimation of the records
+    double mWindowBegin = -DBL_MAX;
+    double mWindowEnd = DBL_MAX;
+    int mDecimation = 1;
+    
+    // recorded only in part of the run, kept out of the common buffers
+    bool windowed() const {
+        return mWindowBegin > -DBL_MAX || mWindowEnd < DBL_MAX || mDecimation > 1;
+    };
+    
+    // recorded at the record irecord, at time t
+    bool active(int irecord, double t) const {
+        return irecord % mDecimation == 0 && t >= mWindowBegin && t <= mWindowEnd;
+    };
+    
+    // channels per record
+    int numChannels() const {
+        return 3 + (mDumpStrain ? 6 : 0) + (mDumpCurl ? 3 : 0);
+    };
+};
+
+// receivers sharing an element, evaluated together
+struct PointwiseGroup {
+    const Element *mElement;
+    std::vector<int> mReceivers;
+    // interpolation weights, nrec x nPntElem, or nrec x npnt on the 
+    // points of mPoints if sparse
+    CMatXX mWeights;
+    // points in element with nonzero weights, read directly if sparse
+    std::vector<int> mPoints;
+    bool mSparse = false;
+    // Fourier factors at receiver phi, nrec x (nu + 1)
+    CMatXX mExpPhi;
+    // workspaces
+    CMatXX mDispl;
+    CMatXX mProj;
+    RMatX3 mGroundMotion;
+    
+    // compute ground motion in SPZ of all receivers
+    void computeGroundMotion();
 };
 
 class PointwiseRecorder {
 public:
+    // totalRecordSteps: rows of the output, after decimation
     PointwiseRecorder(int totalRecordSteps, int recordInterval, 
         int bufferSize, const std::string &components, 
-        double srcLat, double srcLon, double srcDep);
+        double srcLat, double srcLon, double srcDep, 
+        const PointwiseFilter &filter);
     ~PointwiseRecorder();
     
-    // add a receiver
+    // add a receiver, recorded in [windowBegin, windowEnd] at every 
+    // decimation-th record
     void addReceiver(const std::string &name, const std::string &network,
         double phi, const RDMatPP &weights, const Element *ele, double theta, double baz,
-        double lat, double lon, double dep, bool dumpStrain, bool dumpCurl);
+        double lat, double lon, double dep, bool dumpStrain, bool dumpCurl,
+        double windowBegin = -DBL_MAX, double windowEnd = DBL_MAX, int decimation = 1);
     
     // before time loop
-    void initialize();
+    // restartStep: time steps done by the run being restarted, 0 for a new run
+    void initialize(int restartStep);
     
     // after time loop
     void finalize();
@@ -64,14 +121,44 @@ public:
     // record at a time step
     void record(int tstep, double t);
     
-    // dump to user-specified format
+    // dump to user-specified format, in the background
     void dumpToFile();
     
+    // wait until all dumped records are written
+    void waitForIO();
+    
+    // flush written records to disk
+    void flush();
+    
+    // bytes of the buffers, for memory reports
+    size_t memoryBytes() const;
+    
     // add IO
     void addIO(PointwiseIO *io) {mIOs.push_back(io);};
     
+    // checkpoint
+    void syncState(Checkpoint &cp);
+    
 private:
+    // group receivers by element and schedule
+    static void formGroups(std::vector<PointwiseInfo> &infos, 
+        std::vector<PointwiseGroup> &groups);
+    
+    // displacement and curl from SPZ and RTZ to the components
+    void rotateDispl(const PointwiseInfo &info, RRow3 &gm) const;
+    void rotateCurl(const PointwiseInfo &info, RRow3 &curl) const;
+    
     std::vector<PointwiseInfo> mPointwiseInfo;
+    std::vector<PointwiseGroup> mPointwiseGroups;
+    
+    // windowed receivers, stored ragged with only their own records, 
+    // as rows of displacement, strain and curl; written at finalize
+    std::vector<PointwiseInfo> mWindowedInfo;
+    std::vector<PointwiseGroup> mWindowedGroups;
+    std::vector<std::vector<double>> mWindowedTime;
+    std::vector<std::vector<Real>> mWindowedRecords;
+    void recordWindowed(int irecord, double t);
+    void writeWindowed() const;
     
     // interval
     int mTotalRecordSteps;
@@ -86,9 +173,27 @@ private:
     RMatXX_RM mBufferCurl;
     RDColX mBufferTime;
     
+    // second buffer being written while the first is filled
+    int mWriteLine = 0;
+    RMatXX_RM mWriteDisp;
+    RMatXX_RM mWriteStrain;
+    RMatXX_RM mWriteCurl;
+    RDColX mWriteTime;
+    std::thread mWriter;
+    void writeBuffer();
+    int mNumDumps = 0;
+    
     // components
     std::string mComponents;
     
+    // anti-alias filter, decimation and time derivatives
+    PointwiseFilter mFilter;
+    RRowX mFilterIn;
+    RRowX mFilterOut;
+    // all records of a buffer line in one row
+    void getLine(RRowX &row) const;
+    void setLine(const RRowX &row);
+    
     // IO
     std::vector<PointwiseIO *> mIOs;    
     
@@ -0,0 +1,227 @@
+// SurfaceGroundMotion.cpp
+// created by Kuangdai on 14-Oct-2026
+// in-situ peak ground motion and response spectra on the surface
+
+#include "SurfaceGroundMotion.h"
+#include "SurfaceInfo.h"
+#include "SolverFFTW_3.h"
+#include "NetCDF_Writer.h"
+#include "Geodesy.h"
+#include "XMPI.h"
+#include "Parameters.h"
+
+SurfaceGroundMotion::SurfaceGroundMotion(const std::vector<double> &periods,
+    double damping, double dtRecord, double srcLat, double srcLon, double srcDep):
+mPeriods(periods), mDtRecord(dtRecord),
+mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
+    // unit mass, p = -ground acceleration; Chopra, Dynamics of Structures, 5.2
+    double z = damping;
+    double dt = dtRecord;
+    for (double period: mPeriods) {
+        double w = 2. * pi / period;
+        double k = w * w;
+        double sq = sqrt(1. - z * z);
+        double wd = w * sq;
+        double e = exp(-z * w * dt);
+        double s = sin(wd * dt);
+        double c = cos(wd * dt);
+        double r = z / sq;
+        Oscillator osc;
+        osc.mA = e * (r * s + c);
+        osc.mB = e * s / wd;
+        osc.mC = (2. * z / (w * dt) + e * (((1. - 2. * z * z) / (wd * dt) - r) * s
+            - (1. + 2. * z / (w * dt)) * c)) / k;
+        osc.mD = (1. - 2. * z / (w * dt) + e * ((2. * z * z - 1.) / (wd * dt) * s
+            + 2. * z / (w * dt) * c)) / k;
+        osc.mAp = -e * w / sq * s;
+        osc.mBp = e * (c - r * s);
+        osc.mCp = (-1. / dt + e * ((w / sq + r / dt) * s + c / dt)) / k;
+        osc.mDp = (1. - e * (r * s + c)) / (k * dt);
+        osc.mOmega2 = k;
+        mOscillators.push_back(osc);
+    }
+}
+
+void SurfaceGroundMotion::initialize(const std::vector<SurfaceInfo> &surfaceInfo) {
+    int nperiod = mPeriods.size();
+    for (int iele = 0; iele < surfaceInfo.size(); iele++) {
+        GroundMotionEdge edge;
+        edge.mElement = iele;
+        edge.mNr = surfaceInfo[iele].getMaxNr();
+        edge.mNu1 = surfaceInfo[iele].getMaxNu() + 1;
+        edge.mTheta = surfaceInfo[iele].getThetaOnSide();
+        int npnt = nPntEdge * edge.mNr;
+        edge.mDisp1 = edge.mDisp2 = edge.mAccel1 = RDMatX3::Zero(npnt, 3);
+        edge.mOscDisp = edge.mOscVelo = std::vector<RDMatX3>(nperiod, RDMatX3::Zero(npnt, 3));
+        edge.mPGD = edge.mPGV = edge.mPGA = RDColX::Zero(npnt);
+        edge.mSA = RDMatXX::Zero(npnt, nperiod);
+        mEdges.push_back(edge);
+    }
+    mNumRecords = 0;
+}
+
+void SurfaceGroundMotion::toPhysical(const Complex *fourier, int nu1, int nr,
+    RDMatX3 &disp) const {
+    CMatX3 &fourierC2R = SolverFFTW_3::getC2R_CMat();
+    RMatX3 &physicalC2R = SolverFFTW_3::getC2R_RMat();
+    int nc = nr / 2 + 1;
+    int nuCopy = std::min(nu1, nc);
+    for (int ipol = 0; ipol < nPntEdge; ipol++) {
+        fourierC2R.topRows(nc).setZero();
+        for (int idim = 0; idim < 3; idim++) {
+            for (int inu = 0; inu < nuCopy; inu++) {
+                fourierC2R(inu, idim) = fourier[idim * nPntEdge * nu1 + ipol * nu1 + inu];
+            }
+        }
+        SolverFFTW_3::computeC2R(nr);
+        disp.block(ipol * nr, 0, nr, 3) = physicalC2R.topRows(nr).cast<double>();
+    }
+}
+
+void SurfaceGroundMotion::record(const std::vector<CMatXX_RM> &bufferDisp,
+    int bufferLine) {
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    
+    double dt2 = mDtRecord * mDtRecord;
+    for (auto &edge: mEdges) {
+        RDMatX3 disp(edge.mDisp1.rows(), 3);
+        toPhysical(bufferDisp[edge.mElement].row(bufferLine).data(),
+            edge.mNu1, edge.mNr, disp);
+        // magnitudes do not depend on the frame, so SPZ is used as it is
+        edge.mPGD = edge.mPGD.cwiseMax(disp.rowwise().norm());
+        if (mNumRecords >= 1) {
+            edge.mPGV = edge.mPGV.cwiseMax((disp - edge.mDisp1).rowwise().norm() / mDtRecord);
+        }
+        if (mNumRecords >= 2) {
+            // acceleration at the last record; the oscillators start at rest
+            // under zero acceleration and advance by one recorded step
+            RDMatX3 accel = (disp - 2. * edge.mDisp1 + edge.mDisp2) / dt2;
+            edge.mPGA = edge.mPGA.cwiseMax(accel.rowwise().norm());
+            for (int iper = 0; iper < mOscillators.size(); iper++) {
+                const Oscillator &osc = mOscillators[iper];
+                RDMatX3 &x = edge.mOscDisp[iper];
+                RDMatX3 &v = edge.mOscVelo[iper];
+                RDMatX3 xn = osc.mA * x + osc.mB * v - osc.mC * edge.mAccel1 - osc.mD * accel;
+                v = osc.mAp * x + osc.mBp * v - osc.mCp * edge.mAccel1 - osc.mDp * accel;
+                x = xn;
+                edge.mSA.col(iper) = edge.mSA.col(iper).cwiseMax(
+                    x.rowwise().norm() * osc.mOmega2);
+            }
+            edge.mAccel1 = accel;
+        }
+        edge.mDisp2 = edge.mDisp1;
+        edge.mDisp1 = disp;
+    }
+    mNumRecords++;
+    
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+}
+
+void SurfaceGroundMotion::finalize() const {
+    // flatten local maps
+    int nperiod = mPeriods.size();
+    std::vector<double> theta, phi, pgd, pgv, pga, sa;
+    for (const auto &edge: mEdges) {
+        for (int ipol = 0; ipol < nPntEdge; ipol++) {
+            for (int k = 0; k < edge.mNr; k++) {
+                int ipnt = ipol * edge.mNr + k;
+                theta.push_back(edge.mTheta(ipol));
+                phi.push_back(2. * pi * k / edge.mNr);
+                pgd.push_back(edge.mPGD(ipnt));
+                pgv.push_back(edge.mPGV(ipnt));
+                pga.push_back(edge.mPGA(ipnt));
+                for (int iper = 0; iper < nperiod; iper++) {
+                    sa.push_back(edge.mSA(ipnt, iper));
+                }
+            }
+        }
+    }
+    
+    // gather to root
+    std::vector<std::vector<double>> allTheta, allPhi, allPGD, allPGV, allPGA, allSA;
+    XMPI::gather(theta, allTheta, MPI_DOUBLE, false);
+    XMPI::gather(phi, allPhi, MPI_DOUBLE, false);
+    XMPI::gather(pgd, allPGD, MPI_DOUBLE, false);
+    XMPI::gather(pgv, allPGV, MPI_DOUBLE, false);
+    XMPI::gather(pga, allPGA, MPI_DOUBLE, false);
+    XMPI::gather(sa, allSA, MPI_DOUBLE, false);
+    if (!XMPI::root()) {
+        return;
+    }
+    theta.clear(); phi.clear(); pgd.clear(); pgv.clear(); pga.clear(); sa.clear();
+    for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
+        theta.insert(theta.end(), allTheta[iproc].begin(), allTheta[iproc].end());
+        phi.insert(phi.end(), allPhi[iproc].begin(), allPhi[iproc].end());
+        pgd.insert(pgd.end(), allPGD[iproc].begin(), allPGD[iproc].end());
+        pgv.insert(pgv.end(), allPGV[iproc].begin(), allPGV[iproc].end());
+        pga.insert(pga.end(), allPGA[iproc].begin(), allPGA[iproc].end());
+        sa.insert(sa.end(), allSA[iproc].begin(), allSA[iproc].end());
+    }
+    
+    // geographic coordinates
+    size_t npnt = theta.size();
+    std::vector<double> lat(npnt), lon(npnt);
+    for (size_t ipnt = 0; ipnt < npnt; ipnt++) {
+        RDCol3 rtpS;
+        rtpS << 1., theta[ipnt], phi[ipnt];
+        const RDCol3 &rtpG = Geodesy::rotateSrc2Glob(rtpS, mSrcLat, mSrcLon, mSrcDep);
+        lat[ipnt] = Geodesy::theta2Lat_d(rtpG(1), 0.);
+        lon[ipnt] = Geodesy::phi2Lon(rtpG(2));
+    }
+    
+    // write
+    std::string fname = Parameters::sOutputDirectory + "/stations/axisem3d_surface_ground_motion.nc";
+    NetCDF_Writer nw;
+    nw.open(fname, true);
+    std::vector<size_t> dimsPnt = {npnt};
+    std::vector<size_t> dimsPer = {(size_t)nperiod};
+    std::vector<size_t> dimsSA = {npnt, (size_t)nperiod};
+    nw.defModeOn();
+    nw.defineVariable<double>("theta", dimsPnt);
+    nw.defineVariable<double>("phi", dimsPnt);
+    nw.defineVariable<double>("latitude", dimsPnt);
+    nw.defineVariable<double>("longitude", dimsPnt);
+    nw.defineVariable<double>("PGD", dimsPnt);
+    nw.defineVariable<double>("PGV", dimsPnt);
+    nw.defineVariable<double>("PGA", dimsPnt);
+    if (nperiod > 0) {
+        nw.defineVariable<double>("periods", dimsPer);
+        nw.defineVariable<double>("SA", dimsSA);
+    }
+    nw.defModeOff();
+    nw.writeVariableWhole("theta", theta);
+    nw.writeVariableWhole("phi", phi);
+    nw.writeVariableWhole("latitude", lat);
+    nw.writeVariableWhole("longitude", lon);
+    nw.writeVariableWhole("PGD", pgd);
+    nw.writeVariableWhole("PGV", pgv);
+    nw.writeVariableWhole("PGA", pga);
+    if (nperiod > 0) {
+        nw.writeVariableWhole("periods", mPeriods);
+        nw.writeVariableWhole("SA", sa);
+    }
+    nw.addAttribute("", "source_latitude", mSrcLat);
+    nw.addAttribute("", "source_longitude", mSrcLon);
+    nw.addAttribute("", "source_depth", mSrcDep);
+    nw.addAttribute("", "record_interval_time", mDtRecord);
+    nw.addAttribute("", "number_of_records", mNumRecords);
+    nw.close();
+}
+
+size_t SurfaceGroundMotion::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytes(mEdges) + heapBytes(mOscillators);
+    for (const auto &edge: mEdges) {
+        bytes += heapBytes(edge.mTheta) + heapBytes(edge.mDisp1) * 3 +
+            heapBytes(edge.mPGD) * 3 + heapBytes(edge.mSA) +
+            heapBytes(edge.mOscDisp) * 2;
+        for (const RDMatX3 &x: edge.mOscDisp) {
+            bytes += heapBytes(x) * 2;
+        }
+    }
+    return bytes;
+}
+
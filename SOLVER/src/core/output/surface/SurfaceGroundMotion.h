@@ -0,0 +1,70 @@
+// SurfaceGroundMotion.h
+// created by Kuangdai on 14-Oct-2026
+// in-situ peak ground motion and response spectra on the surface
+
+#pragma once
+
+#include "eigenc.h"
+#include "eigenp.h"
+class SurfaceInfo;
+
+class SurfaceGroundMotion {
+public:
+    // periods: natural periods of the oscillators for response spectra
+    // damping: ratio to critical damping of the oscillators
+    // dtRecord: time between two recorded steps
+    SurfaceGroundMotion(const std::vector<double> &periods, double damping,
+        double dtRecord, double srcLat, double srcLon, double srcDep);
+    
+    // allocate states over the GLL points of local surface elements
+    void initialize(const std::vector<SurfaceInfo> &surfaceInfo);
+    
+    // a recorded step
+    void record(const std::vector<CMatXX_RM> &bufferDisp, int bufferLine);
+    
+    // write the maps; collective
+    void finalize() const;
+    
+    // bytes of the states, for memory reports
+    size_t memoryBytes() const;
+
+private:
+    // displacement in SPZ on the physical slices of an edge
+    void toPhysical(const Complex *fourier, int nu1, int nr, RDMatX3 &disp) const;
+    
+    // oscillators by the piecewise-exact method (Nigam & Jennings, 1969),
+    // the ground acceleration being linear in a recorded step
+    struct Oscillator {
+        double mA, mB, mC, mD;
+        double mAp, mBp, mCp, mDp;
+        double mOmega2;
+    };
+    std::vector<Oscillator> mOscillators;
+    
+    // states of a local surface element;
+    // row of a point: ipol * mNr + k, at phi = 2 pi k / mNr
+    struct GroundMotionEdge {
+        int mElement;
+        int mNr;
+        int mNu1;
+        RDColX mTheta;
+        // displacement at the last two records and acceleration at the last
+        RDMatX3 mDisp1, mDisp2, mAccel1;
+        // relative displacement and velocity of the oscillators
+        std::vector<RDMatX3> mOscDisp, mOscVelo;
+        // maxima
+        RDColX mPGD, mPGV, mPGA;
+        RDMatXX mSA;
+    };
+    std::vector<GroundMotionEdge> mEdges;
+    
+    std::vector<double> mPeriods;
+    double mDtRecord;
+    
+    // records done; velocity needs two and acceleration three
+    int mNumRecords = 0;
+    
+    // source location
+    double mSrcLat, mSrcLon, mSrcDep;
+};
+
@@ -17,27 +17,22 @@
 
 void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
     const std::vector<SurfaceInfo> &surfaceInfo,
-    double srcLat, double srcLon, double srcDep) {
+    double srcLat, double srcLon, double srcDep, int restartRow) {
+    // record postion in nc file
+    mCurrentRow = restartRow;
+    // time steps per chunk of the parallel file
+    mChunkSteps = NetCDF_Writer::chunkTimeSteps(bufferSize);
     // source location
     mSrcLat = srcLat;
     mSrcLon = srcLon;
     mSrcDep = srcDep;
     // number
     int numEle = surfaceInfo.size();
-    std::vector<int> allNumEle;
-    XMPI::gather(numEle, allNumEle, false);
-    if (XMPI::root()) {
-        mMinRankWithEle = -1;
-        for (int i = 0; i < allNumEle.size(); i++) {
-            if (allNumEle[i] > 0) {
-                mMinRankWithEle = i;
-                break;
-            }
-        }
-    }
-    XMPI::bcast(mMinRankWithEle);
-    if (mMinRankWithEle == -1) {
+    // lowest rank with elements, in one reduction
+    mMinRankWithEle = XMPI::min(numEle > 0 ? XMPI::rank() : XMPI::nproc());
+    if (mMinRankWithEle == XMPI::nproc()) {
         // no element at all
+        mMinRankWithEle = -1;
         return;
     }
     
@@ -59,15 +54,12 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
         theta(surfaceInfo[iele].getGlobalTag(), 1) = surfaceInfo[iele].getTheta1();
     }
     XMPI::sumEigenDouble(theta);
-
+    
     // dims
     std::vector<size_t> dimsTime;
-    std::vector<size_t> dimsSeis;
     std::vector<size_t> dimsTheta;
     std::vector<size_t> dimsGLL;
     dimsTime.push_back(totalRecordSteps);
-    dimsSeis.push_back(totalRecordSteps);
-    dimsSeis.push_back(0);
     dimsTheta.push_back(numEleGlob);
     dimsTheta.push_back(2);
     dimsGLL.push_back(nPntEdge);
@@ -95,15 +87,18 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
         }
         std::stringstream fname;
         fname << Parameters::sOutputDirectory + "/stations/axisem3d_surface.nc.rank" << XMPI::rank();
+        if (restartRow > 0) {
+            // continue the file of the run being restarted
+            mNetCDF->open(fname.str(), false);
+            return;
+        }
         mNetCDF->open(fname.str(), true);
         mNetCDF->defModeOn();
         // define time
         mNetCDF->defineVariable<double>("time_points", dimsTime);
         // define seismograms
         for (int iele = 0; iele < numEle; iele++) {
-            dimsSeis[1] = nPntEdge * 3 * (mNu[iele] + 1);
-            mNetCDF->defineVariable<Real>(mVarNames[iele] + "r", dimsSeis);
-            mNetCDF->defineVariable<Real>(mVarNames[iele] + "i", dimsSeis);
+            defineEdge(*mNetCDF, mVarNames[iele], mNu[iele], totalRecordSteps);
         }
         // define theta
         mNetCDF->defineVariable<double>("theta", dimsTheta);
@@ -115,9 +110,7 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
         mNetCDF->fillConstant("time_points", dimsTime, NC_ERR_VALUE);
         // fill seismograms with err values
         for (int iele = 0; iele < numEle; iele++) {
-            dimsSeis[1] = nPntEdge * 3 * (mNu[iele] + 1);
-            mNetCDF->fillConstant(mVarNames[iele] + "r", dimsSeis, (Real)NC_ERR_VALUE);
-            mNetCDF->fillConstant(mVarNames[iele] + "i", dimsSeis, (Real)NC_ERR_VALUE);
+            fillEdge(*mNetCDF, mVarNames[iele], mNu[iele], totalRecordSteps);
         }
         // fill theta
         mNetCDF->writeVariableWhole("theta", theta);
@@ -142,17 +135,16 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
         
         // open file on min rank and define all variables
         std::string fname = Parameters::sOutputDirectory + "/stations/axisem3d_surface.nc";
-        if (XMPI::rank() == mMinRankWithEle) {
+        if (XMPI::rank() == mMinRankWithEle && restartRow == 0) {
             mNetCDF->open(fname, true);
             mNetCDF->defModeOn();
             // define time
-            mNetCDF->defineVariable<double>("time_points", dimsTime);
+            mNetCDF->defineTimeSeries<double>("time_points", dimsTime, mChunkSteps);
             // define seismograms
             for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
                 for (int iele = 0; iele < allNames[iproc].size(); iele++) {
-                    dimsSeis[1] = nPntEdge * 3 * (allNus[iproc][iele] + 1);
-                    mNetCDF->defineVariable<Real>(allNames[iproc][iele] + "r", dimsSeis);
-                    mNetCDF->defineVariable<Real>(allNames[iproc][iele] + "i", dimsSeis);
+                    defineEdge(*mNetCDF, allNames[iproc][iele], allNus[iproc][iele], 
+                        totalRecordSteps);
                 }
             }
             // define theta
@@ -166,9 +158,8 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
             // fill seismograms with err values
             for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
                 for (int iele = 0; iele < allNames[iproc].size(); iele++) {
-                    dimsSeis[1] = nPntEdge * 3 * (allNus[iproc][iele] + 1);
-                    mNetCDF->fillConstant<Real>(allNames[iproc][iele] + "r", dimsSeis, (Real)NC_ERR_VALUE);
-                    mNetCDF->fillConstant<Real>(allNames[iproc][iele] + "i", dimsSeis, (Real)NC_ERR_VALUE);
+                    fillEdge(*mNetCDF, allNames[iproc][iele], allNus[iproc][iele], 
+                        totalRecordSteps);
                 }
             }
             // fill theta
@@ -189,9 +180,6 @@ void SurfaceIO::initialize(int totalRecordSteps, int bufferSize,
         XMPI::barrier();
         mNetCDF->openParallel(fname);
     #endif
-    
-    // record postion in nc file
-    mCurrentRow = 0;
 }
 
 void SurfaceIO::finalize() {
@@ -226,11 +214,8 @@ void SurfaceIO::finalize() {
     
     // dims
     std::vector<size_t> dimsTime;
-    std::vector<size_t> dimsSeis;
     std::vector<size_t> dimsGLL;
     dimsTime.push_back(mCurrentRow);
-    dimsSeis.push_back(mCurrentRow);
-    dimsSeis.push_back(0);
     dimsGLL.push_back(nPntEdge);
     
     // create file 
@@ -285,23 +270,39 @@ void SurfaceIO::finalize() {
             NetCDF_Writer nw;
             nw.open(oneFile, false);
     
-            // create variable
-            nw.defModeOn();
-            for (int iele = 0; iele < numEle; iele++) {
-                dimsSeis[1] = nPntEdge * 3 * (mNu[iele] + 1);
-                nw.defineVariable<Real>(mVarNames[iele] + "r", dimsSeis);
-                nw.defineVariable<Real>(mVarNames[iele] + "i", dimsSeis);
-            }
-            nw.defModeOff();
-    
             // read and write seismograms
             for (int iele = 0; iele < numEle; iele++) {
-                RMatXX_RM seis_r;
-                RMatXX_RM seis_i;
+                int nu = mNu[iele];
+                RMatXX_RM seis_r, seis_i, strain_r, strain_i;
                 nr.read2D(mVarNames[iele] + "r", seis_r);
                 nr.read2D(mVarNames[iele] + "i", seis_i);
-                nw.writeVariableWhole(mVarNames[iele] + "r", seis_r);
-                nw.writeVariableWhole(mVarNames[iele] + "i", seis_i);
+                if (mStrain) {
+                    nr.read2D(mVarNames[iele] + "_strain_r", strain_r);
+                    nr.read2D(mVarNames[iele] + "_strain_i", strain_i);
+                }
+                
+                // truncate Nu by energy
+                int nuEff = nu;
+                if (mNuCutoff > 0.) {
+                    nuEff = effectiveNu(seis_r, seis_i, nu, 3);
+                    if (mStrain) {
+                        nuEff = std::max(nuEff, effectiveNu(strain_r, strain_i, nu, 6));
+                    }
+                }
+                
+                // create variable
+                nw.defModeOn();
+                defineEdge(nw, mVarNames[iele], nuEff, mCurrentRow);
+                nw.defModeOff();
+                
+                nw.writeVariableWhole(mVarNames[iele] + "r", truncateNu(seis_r, nu, nuEff, 3));
+                nw.writeVariableWhole(mVarNames[iele] + "i", truncateNu(seis_i, nu, nuEff, 3));
+                if (mStrain) {
+                    nw.writeVariableWhole(mVarNames[iele] + "_strain_r", 
+                        truncateNu(strain_r, nu, nuEff, 6));
+                    nw.writeVariableWhole(mVarNames[iele] + "_strain_i", 
+                        truncateNu(strain_i, nu, nuEff, 6));
+                }
             }
     
             // close
@@ -322,11 +323,14 @@ void SurfaceIO::finalize() {
 }
 
 void SurfaceIO::dumpToFile(const std::vector<CMatXX_RM> &bufferDisp, 
+    const std::vector<CMatXX_RM> &bufferStrain,
     const RDColX &bufferTime, int bufferLine) {
     int numEle = mVarNames.size();
     if (bufferLine == 0) {
         return;
     }
+    // pointwise recorder may be writing in the background
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
     
     // write time
     std::vector<size_t> start;
@@ -360,14 +364,110 @@ void SurfaceIO::dumpToFile(const std::vector<CMatXX_RM> &bufferDisp,
         count[1] = nPntEdge * 3 * (mNu[iele] + 1); 
         RMatXX_RM seis_r = bufferDisp[iele].block(0, 0, bufferLine, count[1]).real();
         RMatXX_RM seis_i = bufferDisp[iele].block(0, 0, bufferLine, count[1]).imag();
+        roundMantissa(seis_r, seis_i);
         mNetCDF->writeVariableChunk(mVarNames[iele] + "r", seis_r, start, count);
         mNetCDF->writeVariableChunk(mVarNames[iele] + "i", seis_i, start, count);
+        if (mStrain) {
+            count[1] = nPntEdge * 6 * (mNu[iele] + 1); 
+            seis_r = bufferStrain[iele].block(0, 0, bufferLine, count[1]).real();
+            seis_i = bufferStrain[iele].block(0, 0, bufferLine, count[1]).imag();
+            roundMantissa(seis_r, seis_i);
+            mNetCDF->writeVariableChunk(mVarNames[iele] + "_strain_r", seis_r, start, count);
+            mNetCDF->writeVariableChunk(mVarNames[iele] + "_strain_i", seis_i, start, count);
+        }
     }
     #ifndef NDEBUG
         Eigen::internal::set_is_malloc_allowed(false);
     #endif
-    
-    // flush to disk
+}
+
+void SurfaceIO::flush() {
+    if (mNetCDF == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
     mNetCDF->flush();
 }
 
+void SurfaceIO::defineEdge(const NetCDF_Writer &nw, const std::string &name, int nu, 
+    int nrow) const {
+    std::vector<std::string> vars = {name + "r", name + "i"};
+    std::vector<int> ncols = {3, 3};
+    if (mStrain) {
+        vars.push_back(name + "_strain_r");
+        vars.push_back(name + "_strain_i");
+        ncols.push_back(6);
+        ncols.push_back(6);
+    }
+    for (int ivar = 0; ivar < vars.size(); ivar++) {
+        std::vector<size_t> dims = {(size_t)nrow, (size_t)(nPntEdge * ncols[ivar] * (nu + 1))};
+        #ifndef _USE_PARALLEL_NETCDF
+            // compressed variables cannot be written independently in parallel
+            if (mDeflate > 0) {
+                // chunks aligned with the dumps
+                nw.defineTimeSeries<Real>(vars[ivar], dims, mChunkSteps);
+                nw.deflateVariable(vars[ivar], mDeflate);
+            } else {
+                nw.defineVariable<Real>(vars[ivar], dims);
+            }
+        #else
+            // chunks aligned with the dumps of the owner rank
+            nw.defineTimeSeries<Real>(vars[ivar], dims, mChunkSteps);
+        #endif
+    }
+}
+
+void SurfaceIO::roundMantissa(RMatXX_RM &seis_r, RMatXX_RM &seis_i) const {
+    if (mPrecisionBits > 0) {
+        NetCDF_Writer::roundMantissa(seis_r, mPrecisionBits);
+        NetCDF_Writer::roundMantissa(seis_i, mPrecisionBits);
+    }
+}
+
+int SurfaceIO::effectiveNu(const RMatXX_RM &seis_r, const RMatXX_RM &seis_i, 
+    int nu, int ncomp) const {
+    // energy of each order, over time, points and components
+    RDColX energy = RDColX::Zero(nu + 1);
+    for (int icol = 0; icol < ncomp * nPntEdge; icol++) {
+        for (int alpha = 0; alpha <= nu; alpha++) {
+            int col = icol * (nu + 1) + alpha;
+            energy(alpha) += seis_r.col(col).cast<double>().squaredNorm() 
+                + seis_i.col(col).cast<double>().squaredNorm();
+        }
+    }
+    // Hilbert norm, as in learnWisdom
+    double h2norm = energy.sum() - .5 * energy(0);
+    double tol = h2norm * mNuCutoff * mNuCutoff;
+    double tail = energy.sum();
+    for (int newNu = 0; newNu < nu; newNu++) {
+        tail -= energy(newNu);
+        if (tail <= tol) {
+            return newNu;
+        }
+    }
+    return nu;
+}
+
+RMatXX_RM SurfaceIO::truncateNu(const RMatXX_RM &seis, int nu, int nuEff, int ncomp) {
+    if (nuEff == nu) {
+        return seis;
+    }
+    RMatXX_RM trunc(seis.rows(), ncomp * nPntEdge * (nuEff + 1));
+    for (int icol = 0; icol < ncomp * nPntEdge; icol++) {
+        trunc.middleCols(icol * (nuEff + 1), nuEff + 1) = 
+            seis.middleCols(icol * (nu + 1), nuEff + 1);
+    }
+    return trunc;
+}
+
+void SurfaceIO::fillEdge(const NetCDF_Writer &nw, const std::string &name, int nu, 
+    int nrow) const {
+    std::vector<size_t> dims = {(size_t)nrow, (size_t)(nPntEdge * 3 * (nu + 1))};
+    nw.fillConstant<Real>(name + "r", dims, (Real)NC_ERR_VALUE);
+    nw.fillConstant<Real>(name + "i", dims, (Real)NC_ERR_VALUE);
+    if (mStrain) {
+        dims[1] = nPntEdge * 6 * (nu + 1);
+        nw.fillConstant<Real>(name + "_strain_r", dims, (Real)NC_ERR_VALUE);
+        nw.fillConstant<Real>(name + "_strain_i", dims, (Real)NC_ERR_VALUE);
+    }
+}
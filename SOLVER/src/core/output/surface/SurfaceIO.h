@@ -11,23 +11,47 @@ class SurfaceInfo;
 
 class SurfaceIO {
 public:
-    SurfaceIO(bool assemble): mAssemble(assemble) {
+    SurfaceIO(bool assemble, bool strain, int deflate, int precisionBits, 
+        double nuCutoff): 
+    mAssemble(assemble), mStrain(strain), mDeflate(deflate), 
+    mPrecisionBits(precisionBits), mNuCutoff(nuCutoff) {
         // nothing
     }
     
     // before time loop
+    // restartRow: rows written by the run being restarted, 0 for a new run
     void initialize(int totalRecordSteps, int bufferSize,
         const std::vector<SurfaceInfo> &surfaceInfo,
-        double srcLat, double srcLon, double srcDep);
+        double srcLat, double srcLon, double srcDep, int restartRow);
     
     // after time loop
     void finalize();
     
     // dump to netcdf
     void dumpToFile(const std::vector<CMatXX_RM> &bufferDisp, 
+        const std::vector<CMatXX_RM> &bufferStrain,
         const RDColX &bufferTime, int bufferLine);
     
+    // flush dumped data to disk
+    void flush();
+    
 private:
+    // define or fill the variables of an edge
+    void defineEdge(const NetCDF_Writer &nw, const std::string &name, int nu, 
+        int nrow) const;
+    void fillEdge(const NetCDF_Writer &nw, const std::string &name, int nu, 
+        int nrow) const;
+    // lossy rounding of a buffer before writing
+    void roundMantissa(RMatXX_RM &seis_r, RMatXX_RM &seis_i) const;
+    
+    // smallest Nu of an edge with a relative L2 error below mNuCutoff,
+    // as in Point::learnWisdom; ncomp: 3 for displacement, 6 for strain
+    int effectiveNu(const RMatXX_RM &seis_r, const RMatXX_RM &seis_i, 
+        int nu, int ncomp) const;
+    // keep the Fourier orders up to nuEff
+    static RMatXX_RM truncateNu(const RMatXX_RM &seis, int nu, int nuEff, int ncomp);
+    
+    
     // variable names
     std::vector<std::string> mVarNames;
     std::vector<int> mNu;
@@ -38,6 +62,9 @@ private:
     // location in nc 
     int mCurrentRow = 0;
     
+    // time steps per chunk of the parallel file
+    size_t mChunkSteps = 1;
+    
     // minimum MPI rank that has elements
     int mMinRankWithEle = -1;
     
@@ -46,5 +73,15 @@ private:
     
     // assemble or not
     bool mAssemble = true;
+    
+    // strain and lossless compression level
+    bool mStrain = false;
+    int mDeflate = 0;
+    
+    // mantissa bits kept by lossy rounding, 0 for lossless
+    int mPrecisionBits = 0;
+    
+    // energy cutoff of Nu truncation in the assembled file, 0 for off
+    double mNuCutoff = 0.;
 };
 
@@ -24,6 +24,38 @@ void SurfaceInfo::feedBuffer(int bufferLine, CMatXX_RM &bufferDisp) {
     mElement->feedDispOnSide(mSurfSide, bufferDisp, bufferLine);
 }
 
+void SurfaceInfo::initBufferStrain(int bufferSize, CMatXX_RM &bufferStrain) {
+    bufferStrain = CMatXX_RM::Zero(bufferSize, 
+        nPntEdge * 6 * (mElement->getMaxNu() + 1));
+}
+
+void SurfaceInfo::feedBufferStrain(int bufferLine, CMatXX_RM &bufferStrain) {
+    mElement->feedStrainOnSide(mSurfSide, bufferStrain, bufferLine);
+}
+
 int SurfaceInfo::getMaxNu() const {
     return mElement->getMaxNu();
 }
+
+int SurfaceInfo::getMaxNr() const {
+    return mElement->getMaxNr();
+}
+
+RDColX SurfaceInfo::getThetaOnSide() const {
+    const RDMatXX &sz = mElement->getCoordsOnSide(mSurfSide);
+    RDColX theta(nPntEdge);
+    for (int ipol = 0; ipol < nPntEdge; ipol++) {
+        const RDCol2 &szp = sz.col(ipol);
+        theta(ipol) = Geodesy::theta(szp);
+    }
+    return theta;
+}
+
+bool SurfaceInfo::axial() const {
+    return mElement->axial();
+}
+
+CColX SurfaceInfo::formPhaseTable(double phi) const {
+    return mElement->formPhaseTable(phi);
+}
+
@@ -6,6 +6,7 @@
 
 class Element;
 #include "eigenc.h"
+#include "eigenp.h"
 
 class SurfaceInfo {
 public:
@@ -22,7 +23,19 @@ public:
     void initBuffer(int bufferSize, CMatXX_RM &bufferDisp);
     void feedBuffer(int bufferLine, CMatXX_RM &bufferDisp);
     
+    // strain in RTZ
+    void initBufferStrain(int bufferSize, CMatXX_RM &bufferStrain);
+    void feedBufferStrain(int bufferLine, CMatXX_RM &bufferStrain);
+    
     int getMaxNu() const;
+    int getMaxNr() const;
+    bool axial() const;
+    
+    // theta of the points along the edge
+    RDColX getThetaOnSide() const;
+    
+    // azimuthal factors at phi
+    CColX formPhaseTable(double phi) const;
     
 private:    
     const Element *mElement;
@@ -0,0 +1,222 @@
+// SurfaceMovie.cpp
+// created by Kuangdai on 14-Oct-2026
+// VTK frames of the surface wavefield on a lat/lon grid
+
+#include "SurfaceMovie.h"
+#include "SurfaceInfo.h"
+#include "Geodesy.h"
+#include "SpectralConstants.h"
+#include "XMath.h"
+#include "XMPI.h"
+#include "Parameters.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+namespace SurfaceMovieVTK {
+    // legacy VTK binary is big-endian
+    template<typename T>
+    void writeBigEndian(std::ofstream &fs, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        std::reverse(bytes, bytes + sizeof(T));
+        fs.write(bytes, sizeof(T));
+    }
+}
+
+SurfaceMovie::SurfaceMovie(int interval, double latMin, double latMax, 
+    double lonMin, double lonMax, double spacing, double radius,
+    double srcLat, double srcLon, double srcDep):
+mInterval(interval), mLatMin(latMin), mLonMin(lonMin), mSpacing(spacing),
+mRadius(radius), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
+    mNumLat = (int)((latMax - latMin) / spacing + 1e-6) + 1;
+    mNumLon = (int)((lonMax - lonMin) / spacing + 1e-6) + 1;
+}
+
+void SurfaceMovie::gridPoint(int ilat, int ilon, RDCol3 &xyzG, 
+    double &theta, double &phi) const {
+    RDCol3 rtpG;
+    rtpG(0) = 1.;
+    rtpG(1) = Geodesy::lat2Theta_r(mLatMin + ilat * mSpacing, mRadius);
+    rtpG(2) = Geodesy::lon2Phi(mLonMin + ilon * mSpacing);
+    xyzG = Geodesy::toCartesian(rtpG);
+    RDCol3 rtpS = Geodesy::rotateGlob2Src(rtpG, mSrcLat, mSrcLon, mSrcDep);
+    theta = rtpS(1);
+    phi = rtpS(2);
+}
+
+void SurfaceMovie::initialize(const std::vector<SurfaceInfo> &surfaceInfo) {
+    // local elements sorted by theta
+    int numEle = surfaceInfo.size();
+    std::vector<std::pair<double, int>> thetaMinEle;
+    double thetaMaxLoc = 0.;
+    for (int iele = 0; iele < numEle; iele++) {
+        thetaMinEle.push_back(std::make_pair(surfaceInfo[iele].getThetaMin(), iele));
+        thetaMaxLoc = std::max(thetaMaxLoc, std::max(surfaceInfo[iele].getTheta0(), 
+            surfaceInfo[iele].getTheta1()));
+    }
+    std::sort(thetaMinEle.begin(), thetaMinEle.end());
+    // a point on an element boundary belongs to the element above it
+    double thetaMaxGlob = XMPI::max(thetaMaxLoc);
+    
+    // locate grid points
+    std::vector<int> groupOfEle(numEle, -1);
+    for (int ilat = 0; ilat < mNumLat; ilat++) {
+        for (int ilon = 0; ilon < mNumLon; ilon++) {
+            RDCol3 xyzG;
+            double theta, phi;
+            gridPoint(ilat, ilon, xyzG, theta, phi);
+            auto it = std::upper_bound(thetaMinEle.begin(), thetaMinEle.end(), 
+                std::make_pair(theta, numEle));
+            if (it == thetaMinEle.begin()) {
+                continue;
+            }
+            int iele = (--it)->second;
+            const SurfaceInfo &info = surfaceInfo[iele];
+            double thetaMax = std::max(info.getTheta0(), info.getTheta1());
+            if (theta > thetaMax || (theta == thetaMax && thetaMax < thetaMaxGlob)) {
+                continue;
+            }
+            if (groupOfEle[iele] < 0) {
+                groupOfEle[iele] = mGroups.size();
+                mGroups.push_back(MovieGroup());
+                mGroups.back().mElement = iele;
+            }
+            mGroups[groupOfEle[iele]].mPoints.push_back(ilat * mNumLon + ilon);
+        }
+    }
+    
+    // interpolation
+    for (auto &group: mGroups) {
+        const SurfaceInfo &info = surfaceInfo[group.mElement];
+        int npnt = group.mPoints.size();
+        int nu1 = info.getMaxNu() + 1;
+        const double *bases = info.axial() ? SpectralConstants::getP_GLJ().data() :
+            SpectralConstants::getP_GLL().data();
+        group.mTheta = RDColX::Zero(npnt);
+        group.mWeights = CMatXX::Zero(npnt, nPntEdge);
+        group.mExpPhi = CMatXX::Zero(npnt, nu1);
+        group.mProj = CMatXX::Zero(npnt, nu1);
+        for (int ipnt = 0; ipnt < npnt; ipnt++) {
+            RDCol3 xyzG;
+            double theta, phi;
+            gridPoint(group.mPoints[ipnt] / mNumLon, group.mPoints[ipnt] % mNumLon, 
+                xyzG, theta, phi);
+            group.mTheta(ipnt) = theta;
+            double eta = (theta - info.getTheta0()) / 
+                (info.getTheta1() - info.getTheta0()) * 2. - 1.;
+            RDColP weights;
+            XMath::interpLagrange(eta, nPntEdge, bases, weights.data());
+            group.mWeights.row(ipnt) = weights.transpose().cast<Complex>();
+            CColX expPhi = info.formPhaseTable(phi);
+            group.mExpPhi.block(ipnt, 0, 1, expPhi.size()) = expPhi.transpose();
+        }
+    }
+    mDisp = RDMatXX_RM::Zero(mNumLat * mNumLon, 3);
+}
+
+void SurfaceMovie::record(int irecord, double t, 
+    const std::vector<CMatXX_RM> &bufferDisp, int bufferLine) {
+    if (irecord % mInterval != 0) {
+        return;
+    }
+    
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    
+    // Fourier to physical, a matrix product per element
+    mDisp.setZero();
+    for (auto &group: mGroups) {
+        int nu1 = group.mExpPhi.cols();
+        const Complex *fourier = bufferDisp[group.mElement].row(bufferLine).data();
+        RDMatX3 spz(group.mPoints.size(), 3);
+        for (int idim = 0; idim < 3; idim++) {
+            Eigen::Map<const CMatXX_RM> fmat(fourier + idim * nPntEdge * nu1, nPntEdge, nu1);
+            group.mProj.noalias() = group.mWeights * fmat;
+            spz.col(idim) = group.mProj.cwiseProduct(group.mExpPhi)
+                .rowwise().sum().real().cast<double>();
+        }
+        // SPZ to RTZ
+        for (int ipnt = 0; ipnt < group.mPoints.size(); ipnt++) {
+            double theta = group.mTheta(ipnt);
+            int igrid = group.mPoints[ipnt];
+            mDisp(igrid, 0) = spz(ipnt, 0) * cos(theta) - spz(ipnt, 2) * sin(theta);
+            mDisp(igrid, 1) = spz(ipnt, 1);
+            mDisp(igrid, 2) = spz(ipnt, 0) * sin(theta) + spz(ipnt, 2) * cos(theta);
+        }
+    }
+    
+    // frames are written by the ranks in turn
+    int frame = irecord / mInterval;
+    int writer = frame % XMPI::nproc();
+    XMPI::reduceSumEigenDouble(mDisp, writer);
+    if (XMPI::rank() == writer) {
+        writeFrame(frame, t);
+    }
+    
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+}
+
+void SurfaceMovie::writeFrame(int frame, double t) const {
+    std::stringstream fname;
+    fname << Parameters::sOutputDirectory << "/stations/axisem3d_surface_vtk." << frame << ".vtk";
+    std::ofstream fs(fname.str(), std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error("SurfaceMovie::writeFrame || "
+            "Error opening VTK output file: || " + fname.str());
+    }
+    
+    // header
+    int npnt = mNumLat * mNumLon;
+    fs << "# vtk DataFile Version 3.0\n";
+    fs << "surface animation, t = " << t << "\n";
+    fs << "BINARY\nDATASET UNSTRUCTURED_GRID\n";
+    
+    // points on the unit sphere
+    fs << "POINTS " << npnt << " float\n";
+    for (int ilat = 0; ilat < mNumLat; ilat++) {
+        for (int ilon = 0; ilon < mNumLon; ilon++) {
+            RDCol3 xyzG;
+            double theta, phi;
+            gridPoint(ilat, ilon, xyzG, theta, phi);
+            for (int idim = 0; idim < 3; idim++) {
+                SurfaceMovieVTK::writeBigEndian(fs, (float)xyzG(idim));
+            }
+        }
+    }
+    
+    // quad cells
+    int ncell = (mNumLat - 1) * (mNumLon - 1);
+    fs << "\nCELLS " << ncell << " " << ncell * 5 << "\n";
+    for (int ilat = 0; ilat < mNumLat - 1; ilat++) {
+        for (int ilon = 0; ilon < mNumLon - 1; ilon++) {
+            int a = ilat * mNumLon + ilon;
+            SurfaceMovieVTK::writeBigEndian(fs, (int)4);
+            SurfaceMovieVTK::writeBigEndian(fs, a);
+            SurfaceMovieVTK::writeBigEndian(fs, a + 1);
+            SurfaceMovieVTK::writeBigEndian(fs, a + mNumLon + 1);
+            SurfaceMovieVTK::writeBigEndian(fs, a + mNumLon);
+        }
+    }
+    fs << "\nCELL_TYPES " << ncell << "\n";
+    for (int icell = 0; icell < ncell; icell++) {
+        // VTK_QUAD
+        SurfaceMovieVTK::writeBigEndian(fs, (int)9);
+    }
+    
+    // displacement
+    fs << "\nPOINT_DATA " << npnt << "\n";
+    fs << "VECTORS disp_RTZ float\n";
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        for (int idim = 0; idim < 3; idim++) {
+            SurfaceMovieVTK::writeBigEndian(fs, (float)mDisp(ipnt, idim));
+        }
+    }
+    fs << "\n";
+    fs.close();
+}
+
@@ -0,0 +1,62 @@
+// SurfaceMovie.h
+// created by Kuangdai on 14-Oct-2026
+// VTK frames of the surface wavefield on a lat/lon grid
+
+#pragma once
+
+#include "eigenc.h"
+#include "eigenp.h"
+class SurfaceInfo;
+
+class SurfaceMovie {
+public:
+    // interval: number of recorded steps between frames
+    // grid: latitudes from latMin to latMax and longitudes from lonMin to 
+    // lonMax, every spacing degrees, on the surface at radius
+    SurfaceMovie(int interval, double latMin, double latMax, 
+        double lonMin, double lonMax, double spacing, double radius,
+        double srcLat, double srcLon, double srcDep);
+    
+    // locate grid points in local surface elements
+    void initialize(const std::vector<SurfaceInfo> &surfaceInfo);
+    
+    // a recorded step; a frame is written every mInterval steps
+    void record(int irecord, double t, 
+        const std::vector<CMatXX_RM> &bufferDisp, int bufferLine);
+    
+private:
+    // grid point in geographic and source-centred spherical coordinates
+    void gridPoint(int ilat, int ilon, RDCol3 &xyzG, double &theta, double &phi) const;
+    
+    // legacy VTK file in binary
+    void writeFrame(int frame, double t) const;
+    
+    // grid points in a local surface element
+    struct MovieGroup {
+        int mElement;
+        std::vector<int> mPoints;
+        RDColX mTheta;
+        // Lagrange interpolation along the edge
+        CMatXX mWeights;
+        // azimuthal factors
+        CMatXX mExpPhi;
+        // workspace
+        CMatXX mProj;
+    };
+    std::vector<MovieGroup> mGroups;
+    
+    int mInterval;
+    
+    // grid
+    double mLatMin, mLonMin, mSpacing;
+    int mNumLat, mNumLon;
+    double mRadius;
+    
+    // source location
+    double mSrcLat, mSrcLon, mSrcDep;
+    
+    // displacement in RTZ on the whole grid, 
+    // summed on the rank writing the frame
+    RDMatXX_RM mDisp;
+};
+
@@ -5,61 +5,90 @@
 #include "SurfaceRecorder.h"
 #include "SurfaceIO.h"
 #include "SurfaceInfo.h"
+#include "SurfaceMovie.h"
+#include "SurfaceGroundMotion.h"
+#include "IOFlush.h"
 #include "XMPI.h"
+#include <algorithm>
+#include <tuple>
 
 SurfaceRecorder::SurfaceRecorder(int totalRecordSteps, int recordInterval, 
-    int bufferSize, double srcLat, double srcLon, double srcDep, bool assemble): 
+    int bufferSize, double srcLat, double srcLon, double srcDep, bool assemble, 
+    bool strain, int deflate, int precisionBits, double nuCutoff, 
+    bool timeSeries): 
 mTotalRecordSteps(totalRecordSteps),
-mRecordInterval(recordInterval), mBufferSize(bufferSize),
+mRecordInterval(recordInterval), mBufferSize(bufferSize), mStrain(strain),
 mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
     mBufferLine = 0;
-    mIO = new SurfaceIO(assemble);
+    if (timeSeries) {
+        mIO = new SurfaceIO(assemble, strain, deflate, precisionBits, nuCutoff);
+    }
 }
 
 SurfaceRecorder::~SurfaceRecorder() {
-    delete mIO;
+    if (mIO) {
+        delete mIO;
+    }
+    if (mMovie) {
+        delete mMovie;
+    }
+    if (mGroundMotion) {
+        delete mGroundMotion;
+    }
 }
 
 void SurfaceRecorder::addElement(Element *ele, int surfSide) {
     mSurfaceInfo.push_back(SurfaceInfo(ele, surfSide));
 }
 
-void SurfaceRecorder::initialize() {
-    // global tag
+void SurfaceRecorder::initialize(int restartStep) {
+    // global tag, sorted by theta; a distributed bucket sort, 
+    // so that no rank holds the whole surface
     int numSurfEle = mSurfaceInfo.size();
-    std::vector<int> numSurfEleAll;
-    XMPI::gather(numSurfEle, numSurfEleAll, true);
-    int startGlobalTag = 0;
-    for (int iproc = 0; iproc < XMPI::rank(); iproc++) {
-        startGlobalTag += numSurfEleAll[iproc];
-    }
-    // theta and tag
-    std::vector<double> minTheta;
-    std::vector<int> unsortedTag;
+    int startGlobalTag = XMPI::exscan(numSurfEle);
+    int nproc = XMPI::nproc();
+    // theta buckets, surface elements being nearly uniform in theta
+    double thetaMin = pi, thetaMax = 0.;
     for (int iele = 0; iele < numSurfEle; iele++) {
-        minTheta.push_back(mSurfaceInfo[iele].getThetaMin());
-        unsortedTag.push_back(startGlobalTag + iele);
-    }
-    // gather
-    std::vector<std::vector<double>> minThetaAll;
-    std::vector<std::vector<int>> unsortedTagAll;
-    XMPI::gather(minTheta, minThetaAll, MPI_DOUBLE, true);
-    XMPI::gather(unsortedTag, unsortedTagAll, MPI_INT, true);
-    // flatten
-    std::vector<std::pair<double, int>> minThetaTagAll;
-    for (int iproc = 0; iproc < XMPI::nproc(); iproc++) {
-        for (int iele = 0; iele < numSurfEleAll[iproc]; iele++) {
-            minThetaTagAll.push_back(std::make_pair(minThetaAll[iproc][iele], 
-                unsortedTagAll[iproc][iele]));
+        thetaMin = std::min(thetaMin, mSurfaceInfo[iele].getThetaMin());
+        thetaMax = std::max(thetaMax, mSurfaceInfo[iele].getThetaMin());
+    }
+    thetaMin = XMPI::min(thetaMin);
+    thetaMax = XMPI::max(thetaMax);
+    double bucketWidth = std::max(thetaMax - thetaMin, tinyDouble) / nproc;
+    // send theta and unsorted tag to bucket owners
+    std::vector<std::vector<double>> sendTheta(nproc), recvTheta;
+    std::vector<std::vector<int>> sendTag(nproc), recvTag;
+    for (int iele = 0; iele < numSurfEle; iele++) {
+        double theta = mSurfaceInfo[iele].getThetaMin();
+        int owner = std::min(std::max((int)((theta - thetaMin) / bucketWidth), 0), nproc - 1);
+        sendTheta[owner].push_back(theta);
+        sendTag[owner].push_back(startGlobalTag + iele);
+    }
+    XMPI::alltoall(sendTheta, recvTheta, MPI_DOUBLE);
+    XMPI::alltoall(sendTag, recvTag, MPI_INT);
+    // sort bucket; ties broken by the unsorted tag
+    std::vector<std::tuple<double, int, int>> bucket;
+    for (int iproc = 0; iproc < nproc; iproc++) {
+        for (int k = 0; k < recvTheta[iproc].size(); k++) {
+            bucket.push_back(std::make_tuple(recvTheta[iproc][k], recvTag[iproc][k], iproc));
         }
     }
-    // sort
-    std::sort(minThetaTagAll.begin(), minThetaTagAll.end());
-    // assigned sorted tag
-    for (int gtag = 0; gtag < minThetaTagAll.size(); gtag++) {
-        int ltag = minThetaTagAll[gtag].second - startGlobalTag;
-        if (ltag >= 0 && ltag < numSurfEle) {
-            mSurfaceInfo[ltag].setGlobalTag(gtag);
+    std::sort(bucket.begin(), bucket.end());
+    // buckets are in the order of ranks
+    int startSortedTag = XMPI::exscan((int)bucket.size());
+    std::vector<std::vector<int>> sendSorted(nproc), recvSorted;
+    for (int k = 0; k < bucket.size(); k++) {
+        int iproc = std::get<2>(bucket[k]);
+        sendSorted[iproc].push_back(std::get<1>(bucket[k]));
+        sendSorted[iproc].push_back(startSortedTag + k);
+    }
+    XMPI::alltoall(sendSorted, recvSorted, MPI_INT);
+    // assign sorted tag
+    for (int iproc = 0; iproc < nproc; iproc++) {
+        for (int k = 0; k < recvSorted[iproc].size(); k += 2) {
+            int ltag = recvSorted[iproc][k] - startGlobalTag;
+            mSurfaceInfo[ltag].setGlobalTag(recvSorted[iproc][k + 1]);
         }
     }
     
@@ -69,15 +98,34 @@ void SurfaceRecorder::initialize() {
         CMatXX_RM buf;
         mSurfaceInfo[iele].initBuffer(mBufferSize, buf);
         mBufferDisp.push_back(buf);
+        if (mStrain) {
+            mSurfaceInfo[iele].initBufferStrain(mBufferSize, buf);
+            mBufferStrain.push_back(buf);
+        }
     }    
     
     // IO
-    mIO->initialize(mTotalRecordSteps, mBufferSize, mSurfaceInfo, 
-        mSrcLat, mSrcLon, mSrcDep);
+    // all records before a checkpoint are on disk
+    int restartRow = (restartStep + mRecordInterval - 1) / mRecordInterval;
+    if (mIO) {
+        mIO->initialize(mTotalRecordSteps, mBufferSize, mSurfaceInfo, 
+            mSrcLat, mSrcLon, mSrcDep, restartRow);
+    }
+    if (mMovie) {
+        mMovie->initialize(mSurfaceInfo);
+    }
+    if (mGroundMotion) {
+        mGroundMotion->initialize(mSurfaceInfo);
+    }
 }
 
 void SurfaceRecorder::finalize() {
-    mIO->finalize();
+    if (mIO) {
+        mIO->finalize();
+    }
+    if (mGroundMotion) {
+        mGroundMotion->finalize();
+    }
 }
 
 void SurfaceRecorder::record(int tstep, double t) {
@@ -92,6 +140,19 @@ void SurfaceRecorder::record(int tstep, double t) {
     for (int iele = 0; iele < mSurfaceInfo.size(); iele++) {
         // compute from element
         mSurfaceInfo[iele].feedBuffer(mBufferLine, mBufferDisp[iele]);
+        if (mStrain) {
+            mSurfaceInfo[iele].feedBufferStrain(mBufferLine, mBufferStrain[iele]);
+        }
+    }
+    
+    // VTK frame
+    if (mMovie) {
+        mMovie->record(tstep / mRecordInterval, t, mBufferDisp, mBufferLine);
+    }
+    
+    // peak ground motion and response spectra
+    if (mGroundMotion) {
+        mGroundMotion->record(mBufferDisp, mBufferLine);
     }
     
     // increment buffer line
@@ -104,7 +165,32 @@ void SurfaceRecorder::record(int tstep, double t) {
 }
 
 void SurfaceRecorder::dumpToFile() {
-    mIO->dumpToFile(mBufferDisp, mBufferTime, mBufferLine);
+    if (mIO) {
+        mIO->dumpToFile(mBufferDisp, mBufferStrain, mBufferTime, mBufferLine);
+        if (IOFlush::due(mNumDumps)) {
+            mIO->flush();
+        }
+    }
     mBufferLine = 0;
 }
 
+void SurfaceRecorder::flush() {
+    if (mIO) {
+        mIO->flush();
+    }
+}
+
+size_t SurfaceRecorder::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytes(mBufferTime) + 
+        heapBytes(mBufferDisp) + heapBytes(mBufferStrain);
+    for (const CMatXX_RM &buffer: mBufferDisp) {
+        bytes += heapBytes(buffer);
+    }
+    for (const CMatXX_RM &buffer: mBufferStrain) {
+        bytes += heapBytes(buffer);
+    }
+    if (mGroundMotion) {
+        bytes += mGroundMotion->memoryBytes();
+    }
+    return bytes;
+}
@@ -8,28 +8,45 @@
 #include "eigenp.h"
 class SurfaceInfo;
 class SurfaceIO;
+class SurfaceMovie;
+class SurfaceGroundMotion;
 class Element;
 
 class SurfaceRecorder {
 public:
     SurfaceRecorder(int totalRecordSteps, int recordInterval, int bufferSize,
-        double srcLat, double srcLon, double srcDep, bool assemble);
+        double srcLat, double srcLon, double srcDep, bool assemble, 
+        bool strain, int deflate, int precisionBits, double nuCutoff,
+        bool timeSeries = true);
     ~SurfaceRecorder();
-
+    
     // add a surface element
     void addElement(Element *ele, int surfSide);
-
+    
+    // VTK frames on a lat/lon grid, taking ownership
+    void setMovie(SurfaceMovie *movie) {mMovie = movie;};
+    
+    // peak ground motion and response spectra, taking ownership
+    void setGroundMotion(SurfaceGroundMotion *groundMotion) {mGroundMotion = groundMotion;};
+    
     // before time loop
-    void initialize();
-
+    // restartStep: time steps done by the run being restarted, 0 for a new run
+    void initialize(int restartStep);
+    
     // after time loop
     void finalize();
-
+    
     // record at a time step
     void record(int tstep, double t);
-
+    
     // dump to netcdf
     void dumpToFile();
+    
+    // flush written records to disk
+    void flush();
+    
+    // bytes of the buffers, for memory reports
+    size_t memoryBytes() const;
 
 private:
     // surface elements
@@ -38,17 +55,28 @@ private:
     // interval
     int mTotalRecordSteps;
     int mRecordInterval;
-
+    
     // buffer
     int mBufferSize;
     int mBufferLine;
+    int mNumDumps = 0;
     
     // buffer
     RDColX mBufferTime;
     std::vector<CMatXX_RM> mBufferDisp;
+    std::vector<CMatXX_RM> mBufferStrain;
+    
+    // record strain
+    bool mStrain;
+    
+    // IO, null if time series are not written
+    SurfaceIO *mIO = 0;
+    
+    // VTK frames
+    SurfaceMovie *mMovie = 0;
     
-    // IO
-    SurfaceIO *mIO;
+    // in-situ maps
+    SurfaceGroundMotion *mGroundMotion = 0;
     
     // source location
     double mSrcLat, mSrcLon, mSrcDep;
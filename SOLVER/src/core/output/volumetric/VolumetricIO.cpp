@@ -0,0 +1,154 @@
+// VolumetricIO.cpp
+// created by Kuangdai on 14-Oct-2026
+// NetCDF IO for volumetric wavefield
+
+#include "VolumetricIO.h"
+#include "Parameters.h"
+#include "NetCDF_Writer.h"
+#include "XMPI.h"
+#include <sstream>
+#include <fstream>
+
+void VolumetricIO::initialize(int totalRecordSteps, int bufferSize, 
+    const std::vector<int> &nus, const std::vector<RDMatXX_RM> &coords,
+    double srcLat, double srcLon, double srcDep, int restartRow) {
+    // record postion in nc file
+    mCurrentRow = restartRow;
+    
+    // global tags, contiguous on each rank
+    int numEle = nus.size();
+    std::vector<int> allNumEle;
+    XMPI::gather(numEle, allNumEle, true);
+    int startGlobalTag = 0;
+    for (int iproc = 0; iproc < XMPI::rank(); iproc++) {
+        startGlobalTag += allNumEle[iproc];
+    }
+    for (int iele = 0; iele < numEle; iele++) {
+        std::stringstream ss;
+        ss << "element_" << startGlobalTag + iele;
+        mVarNames.push_back(ss.str());
+    }
+    
+    // element list of the rank files
+    std::vector<std::vector<std::string>> allNames;
+    XMPI::gather(mVarNames, allNames, false);
+    if (XMPI::root() && restartRow == 0) {
+        std::fstream fout(Parameters::sOutputDirectory + "/stations/rank_volume.txt", std::fstream::out);
+        fout << "# MPI_RANK ELEMENT_TAG\n";
+        for (int rank = 0; rank < XMPI::nproc(); rank++) {
+            for (int iele = 0; iele < allNames[rank].size(); iele++) {
+                fout << rank << " " << allNames[rank][iele] << "\n";
+            }
+        }
+    }
+    
+    // open file on all ranks with elements
+    if (numEle == 0) {
+        return;
+    }
+    mNetCDF = new NetCDF_Writer();
+    std::stringstream fname;
+    fname << Parameters::sOutputDirectory + "/stations/axisem3d_volume.nc.rank" << XMPI::rank();
+    if (restartRow > 0) {
+        // continue the file of the run being restarted
+        mNetCDF->open(fname.str(), false);
+        return;
+    }
+    mNetCDF->open(fname.str(), true);
+    mNetCDF->defModeOn();
+    // streaming: chunks aligned with the dumps
+    size_t chunkSteps = NetCDF_Writer::chunkTimeSteps(bufferSize);
+    std::vector<size_t> dimsTime(1, totalRecordSteps);
+    mNetCDF->defineTimeSeries<double>("time_points", dimsTime, chunkSteps);
+    for (int iele = 0; iele < numEle; iele++) {
+        std::vector<size_t> dims = {(size_t)totalRecordSteps, 
+            (size_t)(coords[iele].rows() * 3 * (nus[iele] + 1))};
+        defineField(mVarNames[iele], dims, chunkSteps);
+        if (mStrain) {
+            dims[1] *= 2;
+            defineField(mVarNames[iele] + "_strain_", dims, chunkSteps);
+        }
+        std::vector<size_t> dimsCoords = {(size_t)coords[iele].rows(), 2};
+        mNetCDF->defineVariable<double>(mVarNames[iele] + "_sz", dimsCoords);
+    }
+    mNetCDF->defModeOff();
+    // coordinates
+    for (int iele = 0; iele < numEle; iele++) {
+        mNetCDF->writeVariableWhole(mVarNames[iele] + "_sz", coords[iele]);
+    }
+    // source location
+    mNetCDF->addAttribute("", "source_latitude", srcLat);
+    mNetCDF->addAttribute("", "source_longitude", srcLon);
+    mNetCDF->addAttribute("", "source_depth", srcDep);
+    mNetCDF->flush();
+}
+
+void VolumetricIO::finalize() {
+    if (mNetCDF) {
+        mNetCDF->close();
+        delete mNetCDF;
+        mNetCDF = 0;
+    }
+}
+
+void VolumetricIO::dumpToFile(const std::vector<CMatXX_RM> &bufferDisp, 
+    const std::vector<CMatXX_RM> &bufferStrain,
+    const RDColX &bufferTime, int bufferLine) {
+    if (bufferLine == 0 || mNetCDF == 0) {
+        return;
+    }
+    
+    // write time
+    std::vector<size_t> start(1, mCurrentRow);
+    std::vector<size_t> count(1, bufferLine);
+    mNetCDF->writeVariableChunk("time_points", 
+        bufferTime.topRows(bufferLine), start, count);
+    mCurrentRow += bufferLine;
+    
+    // write wavefield
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    start.push_back(0);
+    count.push_back(0);
+    for (int iele = 0; iele < mVarNames.size(); iele++) {
+        writeField(mVarNames[iele], bufferDisp[iele], bufferLine, start, count);
+        if (mStrain) {
+            writeField(mVarNames[iele] + "_strain_", bufferStrain[iele], 
+                bufferLine, start, count);
+        }
+    }
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+}
+
+void VolumetricIO::flush() {
+    if (mNetCDF == 0) {
+        return;
+    }
+    mNetCDF->flush();
+}
+
+void VolumetricIO::defineField(const std::string &vname, 
+    const std::vector<size_t> &dims, size_t chunkSteps) const {
+    for (const std::string &part: {"r", "i"}) {
+        mNetCDF->defineTimeSeries<Real>(vname + part, dims, chunkSteps);
+        if (mDeflate > 0) {
+            mNetCDF->deflateVariable(vname + part, mDeflate);
+        }
+    }
+}
+
+void VolumetricIO::writeField(const std::string &vname, const CMatXX_RM &buffer, 
+    int bufferLine, std::vector<size_t> &start, std::vector<size_t> &count) const {
+    count[1] = buffer.cols();
+    RMatXX_RM seis_r = buffer.topRows(bufferLine).real();
+    RMatXX_RM seis_i = buffer.topRows(bufferLine).imag();
+    if (mPrecisionBits > 0) {
+        NetCDF_Writer::roundMantissa(seis_r, mPrecisionBits);
+        NetCDF_Writer::roundMantissa(seis_i, mPrecisionBits);
+    }
+    mNetCDF->writeVariableChunk(vname + "r", seis_r, start, count);
+    mNetCDF->writeVariableChunk(vname + "i", seis_i, start, count);
+}
@@ -0,0 +1,59 @@
+// VolumetricIO.h
+// created by Kuangdai on 14-Oct-2026
+// NetCDF IO for volumetric wavefield
+
+#pragma once
+
+class NetCDF_Writer;
+#include "eigenc.h"
+#include "eigenp.h"
+
+class VolumetricIO {
+public:
+    VolumetricIO(bool strain, int deflate, int precisionBits):
+    mStrain(strain), mDeflate(deflate), mPrecisionBits(precisionBits) {
+        // nothing
+    }
+    
+    // before time loop
+    // nus: Nu of the elements
+    // coords: (s, z) of the recorded points of the elements
+    // restartRow: rows written by the run being restarted, 0 for a new run
+    void initialize(int totalRecordSteps, int bufferSize, 
+        const std::vector<int> &nus, const std::vector<RDMatXX_RM> &coords,
+        double srcLat, double srcLon, double srcDep, int restartRow);
+    
+    // after time loop
+    void finalize();
+    
+    // dump to netcdf; the caller holds NetCDF_Writer::ioMutex()
+    void dumpToFile(const std::vector<CMatXX_RM> &bufferDisp, 
+        const std::vector<CMatXX_RM> &bufferStrain,
+        const RDColX &bufferTime, int bufferLine);
+    
+    // flush dumped data to disk
+    void flush();
+    
+private:
+    // variable names
+    std::vector<std::string> mVarNames;
+    
+    // file ID, one file per rank
+    NetCDF_Writer *mNetCDF = 0;
+    
+    // location in nc 
+    int mCurrentRow = 0;
+    
+    // strain, lossless compression level and mantissa bits kept
+    bool mStrain = false;
+    int mDeflate = 0;
+    int mPrecisionBits = 0;
+    
+    // define a wavefield variable
+    void defineField(const std::string &vname, const std::vector<size_t> &dims, 
+        size_t chunkSteps) const;
+    // write a wavefield buffer, split into real and imaginary parts
+    void writeField(const std::string &vname, const CMatXX_RM &buffer, 
+        int bufferLine, std::vector<size_t> &start, std::vector<size_t> &count) const;
+};
+
@@ -0,0 +1,175 @@
+// VolumetricRecorder.cpp
+// created by Kuangdai on 14-Oct-2026
+// recorder for volumetric wavefield on selected elements
+
+#include "VolumetricRecorder.h"
+#include "VolumetricIO.h"
+#include "Element.h"
+#include "Point.h"
+#include "NetCDF_Writer.h"
+#include "IOFlush.h"
+#include <mutex>
+
+VolumetricRecorder::VolumetricRecorder(int totalRecordSteps, int recordInterval, 
+    int bufferSize, int gllStride, double srcLat, double srcLon, double srcDep, 
+    bool strain, int deflate, int precisionBits, double memoryMB): 
+mTotalRecordSteps(totalRecordSteps), mRecordInterval(recordInterval), 
+mBufferSize(bufferSize), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep), 
+mStrainOn(strain), mMemoryMB(memoryMB) {
+    mBufferLine = 0;
+    for (int ipol = 0; ipol <= nPol; ipol += gllStride) {
+        for (int jpol = 0; jpol <= nPol; jpol += gllStride) {
+            mGLLPoints.push_back(ipol * nPntEdge + jpol);
+        }
+    }
+    mIO = new VolumetricIO(strain, deflate, precisionBits);
+}
+
+VolumetricRecorder::~VolumetricRecorder() {
+    waitForIO();
+    delete mIO;
+}
+
+void VolumetricRecorder::initialize(int restartStep) {
+    // buffer rows within the memory budget, counting both buffers
+    int maxNu = 0;
+    int npnt = mGLLPoints.size();
+    int ncomp = mStrainOn ? 9 : 3;
+    double bytesPerRow = 0.;
+    for (const auto &ele: mElements) {
+        bytesPerRow += 2. * ncomp * npnt * (ele->getMaxNu() + 1) * sizeof(Complex);
+    }
+    if (mMemoryMB > 0. && bytesPerRow > 0.) {
+        int rows = (int)(mMemoryMB * 1024. * 1024. / bytesPerRow);
+        mBufferSize = std::max(1, std::min(mBufferSize, rows));
+    }
+    
+    mBufferTime = RDColX::Zero(mBufferSize);
+    std::vector<int> nus;
+    std::vector<RDMatXX_RM> coords;
+    for (const auto &ele: mElements) {
+        int nu = ele->getMaxNu();
+        maxNu = std::max(maxNu, nu);
+        mBufferDisp.push_back(CMatXX_RM::Zero(mBufferSize, 3 * npnt * (nu + 1)));
+        if (mStrainOn) {
+            mBufferStrain.push_back(CMatXX_RM::Zero(mBufferSize, 6 * npnt * (nu + 1)));
+        }
+        nus.push_back(nu);
+        RDMatXX_RM sz(npnt, 2);
+        for (int ipnt = 0; ipnt < npnt; ipnt++) {
+            sz.row(ipnt) = ele->getPoint(mGLLPoints[ipnt])->getCoords().transpose();
+        }
+        coords.push_back(sz);
+    }
+    mDispl = CMatXX::Zero(nPntElem, 3 * (maxNu + 1));
+    if (mStrainOn) {
+        mStrain = CMatXX::Zero(nPntElem, 6 * (maxNu + 1));
+    }
+    
+    // double buffering
+    mWriteTime = mBufferTime;
+    mWriteDisp = mBufferDisp;
+    mWriteStrain = mBufferStrain;
+    
+    // IO
+    // all records before a checkpoint are on disk
+    int restartRow = (restartStep + mRecordInterval - 1) / mRecordInterval;
+    mIO->initialize(mTotalRecordSteps, mBufferSize, nus, coords, 
+        mSrcLat, mSrcLon, mSrcDep, restartRow);
+}
+
+void VolumetricRecorder::finalize() {
+    waitForIO();
+    mIO->finalize();
+}
+
+void VolumetricRecorder::record(int tstep, double t) {
+    if (tstep % mRecordInterval != 0) {
+        return;
+    }
+    
+    // time
+    mBufferTime(mBufferLine) = t;
+    
+    // disp in Fourier space
+    int npnt = mGLLPoints.size();
+    for (int iele = 0; iele < mElements.size(); iele++) {
+        int nu1 = mElements[iele]->getMaxNu() + 1;
+        mElements[iele]->feedDisplFourier(mDispl);
+        for (int idim = 0; idim < 3; idim++) {
+            for (int ipnt = 0; ipnt < npnt; ipnt++) {
+                mBufferDisp[iele].block(mBufferLine, (idim * npnt + ipnt) * nu1, 1, nu1) = 
+                    mDispl.block(mGLLPoints[ipnt], idim * nu1, 1, nu1);
+            }
+        }
+        if (mStrainOn) {
+            mElements[iele]->feedStrainFourier(mStrain);
+            for (int idim = 0; idim < 6; idim++) {
+                for (int ipnt = 0; ipnt < npnt; ipnt++) {
+                    mBufferStrain[iele].block(mBufferLine, (idim * npnt + ipnt) * nu1, 1, nu1) = 
+                        mStrain.block(mGLLPoints[ipnt], idim * nu1, 1, nu1);
+                }
+            }
+        }
+    }
+    
+    // increment buffer line
+    mBufferLine++;
+    
+    // dump and clear buffer
+    if (mBufferLine == mBufferSize) {
+        dumpToFile();
+    }
+}
+
+void VolumetricRecorder::dumpToFile() {
+    // the previous buffer is still being written
+    waitForIO();
+    
+    // swap buffers without copy
+    mBufferTime.swap(mWriteTime);
+    mBufferDisp.swap(mWriteDisp);
+    mBufferStrain.swap(mWriteStrain);
+    mWriteLine = mBufferLine;
+    mBufferLine = 0;
+    
+    #ifndef NDEBUG
+        // Eigen's malloc guard is shared by all threads
+        writeBuffer();
+    #else
+        mWriter = std::thread(&VolumetricRecorder::writeBuffer, this);
+    #endif
+}
+
+void VolumetricRecorder::waitForIO() {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+}
+
+void VolumetricRecorder::writeBuffer() {
+    // NetCDF and HDF5 are not thread-safe
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+    mIO->dumpToFile(mWriteDisp, mWriteStrain, mWriteTime, mWriteLine);
+    if (IOFlush::due(mNumDumps)) {
+        mIO->flush();
+    }
+}
+
+void VolumetricRecorder::flush() {
+    waitForIO();
+    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+    mIO->flush();
+}
+
+size_t VolumetricRecorder::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytes(mBufferTime) + heapBytes(mWriteTime) + 
+        heapBytes(mGLLPoints) + heapBytes(mDispl) + heapBytes(mStrain);
+    for (const std::vector<CMatXX_RM> *buffers: {&mBufferDisp, &mBufferStrain, &mWriteDisp, &mWriteStrain}) {
+        bytes += heapBytes(*buffers);
+        for (const CMatXX_RM &buffer: *buffers) {
+            bytes += heapBytes(buffer);
+        }
+    }
+    return bytes;
+}
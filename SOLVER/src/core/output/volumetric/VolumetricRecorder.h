@@ -0,0 +1,91 @@
+// VolumetricRecorder.h
+// created by Kuangdai on 14-Oct-2026
+// recorder for volumetric wavefield on selected elements
+
+#pragma once
+
+#include "eigenc.h"
+#include "eigenp.h"
+#include <thread>
+class Element;
+class VolumetricIO;
+
+class VolumetricRecorder {
+public:
+    // gllStride: record every so many GLL points in each direction
+    // strain: also record strain, e.g., as the forward field of kernels
+    // memoryMB: upper bound of the buffers on a rank, 0 for no bound
+    VolumetricRecorder(int totalRecordSteps, int recordInterval, int bufferSize,
+        int gllStride, double srcLat, double srcLon, double srcDep, 
+        bool strain, int deflate, int precisionBits, double memoryMB);
+    ~VolumetricRecorder();
+    
+    // add an element
+    void addElement(const Element *ele) {mElements.push_back(ele);};
+    int getNumElements() const {return mElements.size();};
+    
+    // before time loop
+    // restartStep: time steps done by the run being restarted, 0 for a new run
+    void initialize(int restartStep);
+    
+    // after time loop
+    void finalize();
+    
+    // record at a time step
+    void record(int tstep, double t);
+    
+    // dump to netcdf, in the background
+    void dumpToFile();
+    
+    // wait until all dumped records are written
+    void waitForIO();
+    
+    // flush written records to disk
+    void flush();
+    
+    // bytes of the buffers, for memory reports
+    size_t memoryBytes() const;
+    
+private:
+    // elements
+    std::vector<const Element *> mElements;
+    
+    // recorded GLL points of an element
+    std::vector<int> mGLLPoints;
+    
+    // interval
+    int mTotalRecordSteps;
+    int mRecordInterval;
+    
+    // buffer
+    int mBufferSize;
+    int mBufferLine;
+    RDColX mBufferTime;
+    // fast dim: Fourier orders, then points, then components
+    std::vector<CMatXX_RM> mBufferDisp;
+    std::vector<CMatXX_RM> mBufferStrain;
+    
+    // second buffer being written while the first is filled
+    int mWriteLine = 0;
+    RDColX mWriteTime;
+    std::vector<CMatXX_RM> mWriteDisp;
+    std::vector<CMatXX_RM> mWriteStrain;
+    std::thread mWriter;
+    void writeBuffer();
+    int mNumDumps = 0;
+    
+    // workspaces, nPntElem x 3 (nu + 1) and nPntElem x 6 (nu + 1)
+    CMatXX mDispl;
+    CMatXX mStrain;
+    
+    // record strain
+    bool mStrainOn;
+    double mMemoryMB;
+    
+    // IO
+    VolumetricIO *mIO;
+    
+    // source location
+    double mSrcLat, mSrcLon, mSrcDep;
+};
+
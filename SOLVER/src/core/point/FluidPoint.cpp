@@ -4,23 +4,37 @@
 
 #include "FluidPoint.h"
 #include "Mass.h"
+#include "PointBatch.h"
 #include "MultilevelTimer.h"
+#include "Checkpoint.h"
 
 FluidPoint::FluidPoint(int nr, bool axial, const RDCol2 &crds, Mass *mass, bool fluidSurf):
-Point(nr, axial, crds), mMass(mass), mFluidSurf(fluidSurf) {
-    mDispl = CColX::Zero(mNu + 1, 1);
-    mVeloc = CColX::Zero(mNu + 1, 1);
-    mAccel = CColX::Zero(mNu + 1, 1);
-    mStiff = CColX::Zero(mNu + 1, 1);
+Point(nr, axial, crds), mStorage(CMatXX::Zero(mNu + 1, 3)), 
+#ifdef _USE_MIXED_PRECISION
+    mStorageN(CNMatXX::Zero(mNu + 1, 2)),
+#else
+    mStorageN(CNMatXX::Zero(mNu + 1, 1)),
+#endif
+mDispl(mStorage.col(0).data(), mNu + 1), mVeloc(mStorageN.col(0).data(), mNu + 1), 
+mAccel(mStorage.col(1).data(), mNu + 1), mStiff(mStorage.col(2).data(), mNu + 1), 
+#ifdef _USE_MIXED_PRECISION
+    mDisplN(mStorageN.col(1).data(), mNu + 1),
+#endif
+mMass(mass), mFluidSurf(fluidSurf) {
     mMass->checkCompatibility(nr);
     mNuWisdom = mNu;
 }
 
+void FluidPoint::resetWisdom() {
+    mMaxDisplWisdom = -1.;
+    mNuWisdom = mNu;
+}
+
 FluidPoint::~FluidPoint() {
     delete mMass;
 }
 
-void FluidPoint::updateNewmark(double dt) {
+void FluidPoint::updateNewmark(double dt, double dtLast) {
     
     if (mFluidSurf) {
         resetZero();
@@ -33,12 +47,17 @@ void FluidPoint::updateNewmark(double dt) {
     mMass->computeAccel(mStiff);
     // mask accel (masking must be called twice if mass is 3D)
     maskField(mStiff);
-    // update dt
-    double half_dt = half * dt;
-    double half_dt_dt = half_dt * dt;
-    mVeloc += (Real)half_dt * (mAccel + mStiff);
+    // update dt, closing the last step and starting the next
+    double half_dt_last = half * dtLast;
+    double half_dt_dt = half * dt * dt;
+    mVeloc += (RealN)half_dt_last * (mAccel + mStiff).cast<ComplexN>();
     mAccel = mStiff;
-    mDispl += (Real)dt * mVeloc + (Real)half_dt_dt * mAccel;  
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN += dt * mVeloc + half_dt_dt * mAccel.cast<ComplexN>();
+        mDispl = mDisplN.cast<Complex>();
+    #else
+        mDispl += (Real)dt * mVeloc + (Real)half_dt_dt * mAccel;  
+    #endif
     // zero stiffness for next time step
     mStiff.setZero();
 }
@@ -48,6 +67,21 @@ void FluidPoint::resetZero() {
     mDispl.setZero();
     mVeloc.setZero();
     mAccel.setZero();
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN.setZero();
+    #endif
+}
+
+void FluidPoint::syncState(Checkpoint &cp) {
+    cp.syncEigen(mDispl);
+    cp.syncEigen(mVeloc);
+    cp.syncEigen(mAccel);
+    cp.syncEigen(mStiff);
+    #ifdef _USE_MIXED_PRECISION
+        cp.syncEigen(mDisplN);
+    #endif
+    cp.syncValue(mMaxDisplWisdom);
+    cp.syncValue(mNuWisdom);
 }
 
 void FluidPoint::randomDispl(Real factor, int seed, int max_order) {
@@ -61,6 +95,9 @@ void FluidPoint::randomDispl(Real factor, int seed, int max_order) {
     }
     mDispl *= factor;
     maskField(mDispl);
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN = mDispl.cast<ComplexN>();
+    #endif
 }
 
 void FluidPoint::randomStiff(Real factor, int seed, int max_order) {
@@ -80,6 +117,10 @@ std::string FluidPoint::verbose() const {
     return "FluidPoint$" + mMass->verbose();
 }
 
+size_t FluidPoint::memoryBytes() const {
+    return sizeof(*this) + heapBytes(mStorage) + heapBytes(mStorageN) + mMass->memoryBytes();
+}
+
 double FluidPoint::measure(int count) {
     Real dt = .1;
     randomStiff((Real)1e6); 
@@ -91,9 +132,14 @@ double FluidPoint::measure(int count) {
         maskField(mStiff);
         Real half_dt = half * dt;
         Real half_dt_dt = half_dt * dt;
-        mVeloc += half_dt * (mAccel + mStiff);
+        mVeloc += (RealN)half_dt * (mAccel + mStiff).cast<ComplexN>();
         mAccel = mStiff;
-        mDispl += dt * mVeloc + half_dt_dt * mAccel; 
+        #ifdef _USE_MIXED_PRECISION
+            mDisplN += (RealN)dt * mVeloc + (RealN)half_dt_dt * mAccel.cast<ComplexN>();
+            mDispl = mDisplN.cast<Complex>();
+        #else
+            mDispl += dt * mVeloc + half_dt_dt * mAccel; 
+        #endif
         mVeloc.setZero();
     }
     double elapsed_time = timer.elapsed();
@@ -115,7 +161,7 @@ void FluidPoint::test() {
         if (alpha == 0) {mStiff(alpha) = two;}
                 
         // compute stiff 
-        updateNewmark(1.);
+        updateNewmark(1., 1.);
                 
         // positive-definite
         Real sr = mAccel(alpha).real();
@@ -154,16 +200,30 @@ void FluidPoint::test() {
     }
 }
 
-void FluidPoint::feedBuffer(CColX &buffer, int &row) {
-    int rows = mStiff.rows();
-    buffer.block(row, 0, rows, 1) = mStiff;
-    row += rows;
+void FluidPoint::getCommStiff(std::vector<std::pair<Complex *, int>> &blocks) {
+    blocks.push_back(std::pair<Complex *, int>(mStiff.data(), mStiff.size()));
 }
 
-void FluidPoint::extractBuffer(CColX &buffer, int &row) {
-    int rows = mStiff.rows();
-    mStiff += buffer.block(row, 0, rows, 1);
-    row += rows;
+int FluidPoint::batchCols() const {
+    return (!mAxial && !mFluidSurf && mMass->getScalarInvMass() > zero) ? 1 : 0;
+}
+
+void FluidPoint::moveToBatch(PointBatch &batch, int icol) {
+    CColXMap(batch.getDispl(icol), mNu + 1) = mDispl;
+    CNColXMap(batch.getVeloc(icol), mNu + 1) = mVeloc;
+    CColXMap(batch.getAccel(icol), mNu + 1) = mAccel;
+    CColXMap(batch.getStiff(icol), mNu + 1) = mStiff;
+    new (&mDispl) CColXMap(batch.getDispl(icol), mNu + 1);
+    new (&mVeloc) CNColXMap(batch.getVeloc(icol), mNu + 1);
+    new (&mAccel) CColXMap(batch.getAccel(icol), mNu + 1);
+    new (&mStiff) CColXMap(batch.getStiff(icol), mNu + 1);
+    #ifdef _USE_MIXED_PRECISION
+        CNColXMap(batch.getDisplN(icol), mNu + 1) = mDisplN;
+        new (&mDisplN) CNColXMap(batch.getDisplN(icol), mNu + 1);
+    #endif
+    batch.setInvMass(icol, 1, mMass->getScalarInvMass());
+    mStorage.resize(0, 0);
+    mStorageN.resize(0, 0);
 }
 
 void FluidPoint::scatterDisplToElement(vec_CMatPP &displ, int ipol, int jpol, int maxNu) const {
@@ -194,7 +254,7 @@ void FluidPoint::gatherStiffFromElement(const vec_CMatPP &stiff, int ipol, int j
     }
 }
 
-void FluidPoint::maskField(CColX &field) {
+void FluidPoint::maskField(CColXMap &field) {
     field.row(0).imag().setZero();
     // axial boundary condition
     if (mAxial) {
@@ -216,16 +276,18 @@ void FluidPoint::learnWisdom(Real cutoff) {
     }
     mMaxDisplWisdom = h2norm;
     
-    // try smaller orders
+    // smallest order leaving the residual under the tolerance, 
+    // accumulating the residual from the top in a single pass
     Real tol = h2norm * cutoff * cutoff;
-    for (int newNu = 0; newNu < mNu; newNu++) {
-        Real diff = L2norm - mDispl.topRows(newNu + 1).squaredNorm();
-        if (diff <= tol) {
-            mNuWisdom = newNu;
+    Real residual = zero;
+    for (int alpha = mNu; alpha >= 1; alpha--) {
+        residual += std::norm(mDispl(alpha));
+        if (residual > tol) {
+            mNuWisdom = alpha;
             return;
         }
     }
-    mNuWisdom = mNu;
+    mNuWisdom = 0;
 }
 
 
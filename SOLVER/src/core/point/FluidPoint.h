@@ -7,7 +7,7 @@
 class Mass;
 #include "Point.h"
 
-class FluidPoint: public Point {
+class FluidPoint final: public Point {
     friend class SolidFluidPoint;
 
 public:    
@@ -15,7 +15,7 @@ public:
     ~FluidPoint();
 
     // update in time domain by Newmark
-    void updateNewmark(double dt);
+    void updateNewmark(double dt, double dtLast);
     
     // check stability
     bool stable() const {return mDispl.allFinite();};
@@ -23,6 +23,9 @@ public:
     // reset to zero 
     void resetZero(); 
     
+    // save or load field variables 
+    void syncState(Checkpoint &cp);
+    
     // randomize disp and stiff
     void randomDispl(Real factor = one, int seed = -1, int max_order = -1);
     void randomStiff(Real factor = one, int seed = -1, int max_order = -1);
@@ -30,6 +33,9 @@ public:
     // verbose
     std::string verbose() const;
     
+    // bytes
+    size_t memoryBytes() const;
+    
     // measure cost 
     double measure(int count);
     
@@ -40,10 +46,16 @@ public:
     int sizeComm() const {return mStiff.rows();};
     
     // communication
-    void feedBuffer(CColX &buffer, int &row);
-    void extractBuffer(CColX &buffer, int &row);
+    void getCommStiff(std::vector<std::pair<Complex *, int>> &blocks);
+    
+    // structure-of-arrays batching
+    int batchCols() const;
+    void moveToBatch(PointBatch &batch, int icol);
     
     ///////////// fluid-only /////////////
+    // fields of this point
+    FluidPoint *fluidPoint() {return this;};
+    
     // scatter displ to element
     void scatterDisplToElement(vec_CMatPP &displ, int ipol, int jpol, int maxNu) const;
     
@@ -52,21 +64,29 @@ public:
     
     // wisdom
     void learnWisdom(Real cutoff);
+    void resetWisdom();
     int getNuWisdom() const {return mNuWisdom;};
     
     // get displacement
-    const CColX &getDispFourierFluid() const {return mDispl;};
+    const CColXMap &getDispFourierFluid() const {return mDispl;};
     
 private:
     
     // mask 
-    void maskField(CColX &field);
+    void maskField(CColXMap &field);
 
-    // fields
-    CColX mDispl;
-    CColX mVeloc;
-    CColX mAccel;
-    CColX mStiff;
+    // fields, mapped to mStorage/mStorageN or to a PointBatch
+    // veloc is kept in Newmark precision, see RealN
+    CMatXX mStorage;
+    CNMatXX mStorageN;
+    CColXMap mDispl;
+    CNColXMap mVeloc;
+    CColXMap mAccel;
+    CColXMap mStiff;
+    #ifdef _USE_MIXED_PRECISION
+        // displ in Newmark precision, mDispl is its rounded copy
+        CNColXMap mDisplN;
+    #endif
     
     // mass
     Mass *mMass;
@@ -29,16 +29,20 @@ void Point::addToStiff(const CMatX3 &source) {
     throw std::runtime_error("Point::addToStiff || Incompatible point type.");
 }
 
+void Point::addToStiff(const CMatX3 &source, Real factor) {
+    throw std::runtime_error("Point::addToStiff || Incompatible point type.");
+}
+
 std::string Point::costSignature() const {
     std::stringstream ss;
     ss << verbose() << "$DimAzimuth=" << mNr << "$Axial=" << (axial() ? "T" : "F");
     return ss.str();
 }
 
-const CMatX3 &Point::getDispFourierSolid() const {
+const CMatX3Map &Point::getDispFourierSolid() const {
     throw std::runtime_error("Point::getDispFourier || Incompatible point type.");
 }
 
-const CColX &Point::getDispFourierFluid() const {
+const CColXMap &Point::getDispFourierFluid() const {
     throw std::runtime_error("Point::getDispFourier || Incompatible point type.");
 }
\ No newline at end of file
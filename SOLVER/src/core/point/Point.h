@@ -4,17 +4,26 @@
 
 #pragma once
 
+#include <vector>
 #include "global.h"
 #include "eigenc.h"
 #include "eigenp.h"
+#include "Arena.h"
 
-class Point {
+class PointBatch;
+class SolidPoint;
+class FluidPoint;
+class Checkpoint;
+
+class Point: public ArenaObject {
 public:    
     Point(int nr, bool axial, const RDCol2 &crds);
     virtual ~Point() {};
     
     // update in time domain by Newmark
-    virtual void updateNewmark(double dt) = 0;
+    // dtLast: step closed by the velocity update; dt: step the displacement starts
+    // both equal to dt except in composition schemes
+    virtual void updateNewmark(double dt, double dtLast) = 0;
     
     // check stability
     virtual bool stable() const = 0;
@@ -22,6 +31,9 @@ public:
     // reset to zero 
     virtual void resetZero() = 0; 
     
+    // save or load field variables 
+    virtual void syncState(Checkpoint &cp) = 0;
+    
     // randomize disp and stiff
     virtual void randomDispl(Real factor = one, int seed = -1, int max_order = -1) = 0;
     virtual void randomStiff(Real factor = one, int seed = -1, int max_order = -1) = 0;
@@ -29,6 +41,10 @@ public:
     // verbose
     virtual std::string verbose() const = 0;
     
+    // bytes of the fields and the mass, excluding fields moved into 
+    // a PointBatch, for memory reports
+    virtual size_t memoryBytes() const = 0;
+    
     // measure cost
     virtual double measure(int count) = 0;
     
@@ -39,8 +55,22 @@ public:
     virtual int sizeComm() const = 0;
     
     // communication
-    virtual void feedBuffer(CColX &buffer, int &row) = 0;
-    virtual void extractBuffer(CColX &buffer, int &row) = 0;
+    // append the address and size of the stiffness array(s) to be assembled,
+    // stored contiguously in memory and fixed after construction
+    virtual void getCommStiff(std::vector<std::pair<Complex *, int>> &blocks) = 0;
+    
+    // structure-of-arrays batching
+    // number of field columns if batchable, 0 otherwise
+    virtual int batchCols() const {return 0;};
+    // whether batched with a 3D ocean-load mass, in batches of its own
+    virtual bool batchOcean() const {return false;};
+    // move fields into batch, starting from column icol
+    virtual void moveToBatch(PointBatch &batch, int icol) {};
+    
+    // the point holding the solid or fluid fields, 0 if none,
+    // for elements to bind their calls at construction
+    virtual SolidPoint *solidPoint() {return 0;};
+    virtual FluidPoint *fluidPoint() {return 0;};
     
     // scatter displ to element
     virtual void scatterDisplToElement(vec_ar3_CMatPP &displ, int ipol, int jpol, int maxNu) const;
@@ -52,6 +82,7 @@ public:
     
     // add to stiff, used by source
     virtual void addToStiff(const CMatX3 &source);
+    virtual void addToStiff(const CMatX3 &source, Real factor);
     
     // n_u, n_r
     int getNr() const {return mNr;};
@@ -66,13 +97,15 @@ public:
     // wisdom 
     virtual void learnWisdom(Real cutoff) = 0;
     virtual int getNuWisdom() const = 0;
+    // start learning over, at a new time window
+    virtual void resetWisdom() = 0;
     
     // signature for cost measurement
     std::string costSignature() const;
     
     // get displacement
-    virtual const CMatX3 &getDispFourierSolid() const;
-    virtual const CColX &getDispFourierFluid() const;
+    virtual const CMatX3Map &getDispFourierSolid() const;
+    virtual const CColXMap &getDispFourierFluid() const;
 
 protected:
     
@@ -0,0 +1,145 @@
+// PointBatch.cpp
+// created by Kuangdai on 14-Oct-2026 
+// structure-of-arrays storage of points with equal nr and scalar mass
+// or with equal nr and 3D ocean-load mass
+
+#include "PointBatch.h"
+#include "Affinity.h"
+#include <sstream>
+#include <algorithm>
+
+namespace PointBatchAlloc {
+    // huge pages are advised before the first touch by setZero
+    template <class MatType>
+    void zeroAdvised(MatType &mat, int rows, int cols) {
+        mat.resize(rows, cols);
+        Affinity::adviseHugePages(mat.data(), mat.size() * sizeof(typename MatType::Scalar));
+        mat.setZero();
+    }
+}
+
+PointBatch::PointBatch(int nr, int ncols, bool ocean): mNr(nr), mNu(nr / 2), mOcean(ocean) {
+    PointBatchAlloc::zeroAdvised(mDispl, mNu + 1, ncols);
+    PointBatchAlloc::zeroAdvised(mVeloc, mNu + 1, ncols);
+    PointBatchAlloc::zeroAdvised(mAccel, mNu + 1, ncols);
+    PointBatchAlloc::zeroAdvised(mStiff, mNu + 1, ncols);
+    #ifdef _USE_MIXED_PRECISION
+        PointBatchAlloc::zeroAdvised(mDisplN, mNu + 1, ncols);
+    #endif
+    mInvMass = RRowX::Zero(ncols);
+    
+    if (mOcean) {
+        mInvMass3D = RMatXX::Zero(mNr, ncols / 3);
+        mNormal = RMatXX::Zero(mNr, ncols);
+        mStiffR = RMatXX::Zero(mNr, ncols);
+        mStiffNormal = RColX::Zero(mNr);
+        // C2R from and R2C back to the stiffness, which is zeroed anyway;
+        // planning happens before the fields are moved in
+        mC2R = SolverFFTW::planC2R(mNr, ncols, mStiff.data(), mNu + 1, mStiffR.data(), mNr);
+        mR2C = SolverFFTW::planR2C(mNr, ncols, mStiffR.data(), mNr, mStiff.data(), mNu + 1);
+        mStiff.setZero();
+    }
+}
+
+PointBatch::~PointBatch() {
+    if (mOcean) {
+        distroyFFTW(mC2R);
+        distroyFFTW(mR2C);
+    }
+}
+
+void PointBatch::setOcean(int icol, const RColX &invMass, const RMatX3 &normal) {
+    mInvMass3D.col(icol / 3) = invMass;
+    mNormal.middleCols(icol, 3) = normal;
+}
+
+double PointBatch::updateNewmark(double dt, double dtLast, bool probe) {
+    // mask stiff, only off-axis points are batched
+    mStiff.row(0).imag().setZero();
+    if (mNr % 2 == 0) {
+        mStiff.row(mNu).setZero();
+    }
+    // compute accel inplace
+    if (mOcean) {
+        computeAccelOcean();
+    } else {
+        // a scalar mass preserves the mask, no need to mask again
+        mStiff.array().rowwise() *= mInvMass.array();
+    }
+    // update dt, closing the last step and starting the next, in blocks 
+    // of the flattened fields that stay in cache through all updates
+    double half_dt_last = half * dtLast;
+    double half_dt_dt = half * dt * dt;
+    const int n = mDispl.size();
+    CColXMap displ(mDispl.data(), n);
+    CNColXMap veloc(mVeloc.data(), n);
+    CColXMap accel(mAccel.data(), n);
+    CColXMap stiff(mStiff.data(), n);
+    #ifdef _USE_MIXED_PRECISION
+        CNColXMap displN(mDisplN.data(), n);
+    #endif
+    double norm2 = 0.;
+    for (int i0 = 0; i0 < n; i0 += sBlockSize) {
+        int len = std::min((int)sBlockSize, n - i0);
+        veloc.segment(i0, len) += (RealN)half_dt_last * 
+            (accel.segment(i0, len) + stiff.segment(i0, len)).cast<ComplexN>();
+        accel.segment(i0, len) = stiff.segment(i0, len);
+        #ifdef _USE_MIXED_PRECISION
+            displN.segment(i0, len) += dt * veloc.segment(i0, len) + 
+                half_dt_dt * accel.segment(i0, len).cast<ComplexN>();
+            displ.segment(i0, len) = displN.segment(i0, len).cast<Complex>();
+        #else
+            displ.segment(i0, len) += (Real)dt * veloc.segment(i0, len) + 
+                (Real)half_dt_dt * accel.segment(i0, len);  
+        #endif
+        // NaN and overflow propagate through the sum
+        if (probe) {
+            norm2 += displ.segment(i0, len).squaredNorm();
+        }
+    }
+    // zero stiffness for next time step
+    mStiff.setZero();
+    return norm2;
+}
+
+void PointBatch::computeAccelOcean() {
+    // FFT forward
+    execFFTW(mC2R);
+    
+    // stiff => accel, as in MassOcean3D
+    for (int icol = 0; icol < mStiffR.cols(); icol += 3) {
+        mStiffNormal = mStiffR.col(icol + 0).schur(mNormal.col(icol + 0))
+                     + mStiffR.col(icol + 1).schur(mNormal.col(icol + 1))
+                     + mStiffR.col(icol + 2).schur(mNormal.col(icol + 2));
+        for (int idim = 0; idim < 3; idim++) {
+            mStiffR.col(icol + idim) = mStiffR.col(icol + idim).schur(mInvMass3D.col(icol / 3))
+                                     - mStiffNormal.schur(mNormal.col(icol + idim));
+        }
+    }
+    
+    // FFT backward
+    execFFTW(mR2C);
+    mStiff *= one / (Real)mNr;
+    
+    // mask accel, the real FFT keeps the imaginary part at alpha = 0 zero
+    if (mNr % 2 == 0) {
+        mStiff.row(mNu).setZero();
+    }
+}
+
+std::string PointBatch::costSignature() const {
+    std::stringstream ss;
+    ss << "PointBatch$DimAzimuth=" << mNr << "$Ocean=" << (mOcean ? "T" : "F");
+    return ss.str();
+}
+
+size_t PointBatch::memoryBytes() const {
+    size_t bytes = sizeof(*this) + heapBytes(mDispl) + heapBytes(mVeloc) + 
+        heapBytes(mAccel) + heapBytes(mStiff) + heapBytes(mInvMass) + 
+        heapBytes(mInvMass3D) + heapBytes(mNormal) + heapBytes(mStiffR) + heapBytes(mStiffNormal);
+    #ifdef _USE_MIXED_PRECISION
+        bytes += heapBytes(mDisplN);
+    #endif
+    return bytes;
+}
+
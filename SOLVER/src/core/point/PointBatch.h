@@ -0,0 +1,77 @@
+// PointBatch.h
+// created by Kuangdai on 14-Oct-2026 
+// structure-of-arrays storage of points with equal nr and scalar mass
+// or with equal nr and 3D ocean-load mass
+
+#pragma once
+
+#include "eigenc.h"
+#include <string>
+#include "SolverFFTW.h"
+
+class PointBatch {
+public:
+    // ncols: total number of field columns, 3 per solid and 1 per fluid point
+    // ocean: solid points with 3D ocean-load mass, applied in physical space
+    PointBatch(int nr, int ncols, bool ocean = false);
+    ~PointBatch();
+    
+    // update in time domain by Newmark; with probe, returns the squared 
+    // norm of the new displacement, not finite if the batch blew up
+    double updateNewmark(double dt, double dtLast, bool probe = false);
+    
+    // storage of icol-th column, mapped by the points
+    Complex *getDispl(int icol) {return mDispl.col(icol).data();};
+    ComplexN *getVeloc(int icol) {return mVeloc.col(icol).data();};
+    Complex *getAccel(int icol) {return mAccel.col(icol).data();};
+    Complex *getStiff(int icol) {return mStiff.col(icol).data();};
+    #ifdef _USE_MIXED_PRECISION
+        ComplexN *getDisplN(int icol) {return mDisplN.col(icol).data();};
+    #endif
+    
+    // scalar inverse mass of ncols columns starting from icol
+    void setInvMass(int icol, int ncols, Real invMass) {
+        mInvMass.segment(icol, ncols).fill(invMass);
+    };
+    
+    // 3D inverse mass and scaled normal of an ocean-loaded point at icol
+    void setOcean(int icol, const RColX &invMass, const RMatX3 &normal);
+    
+    // signature for cost measurement
+    std::string costSignature() const;
+    
+    // bytes of the fields and the inverse mass
+    size_t memoryBytes() const;
+    
+private:
+    // n_r, n_u
+    int mNr;
+    int mNu;
+    
+    // fields of all points in this batch, one column per component
+    CMatXX mDispl;
+    CNMatXX mVeloc;
+    CMatXX mAccel;
+    CMatXX mStiff;
+    #ifdef _USE_MIXED_PRECISION
+        CNMatXX mDisplN;
+    #endif
+    
+    // inverse mass of each column
+    RRowX mInvMass;
+    
+    // complex values per block of the Newmark update
+    static const int sBlockSize = 512;
+    
+    // ocean load, 1 column per point for inverse mass and 3 for normal
+    // stiff => accel by one many-transform FFT pair over the whole batch
+    void computeAccelOcean();
+    bool mOcean;
+    RMatXX mInvMass3D;
+    RMatXX mNormal;
+    RMatXX mStiffR;
+    RColX mStiffNormal;
+    PlanFFTW mC2R;
+    PlanFFTW mR2C;
+};
+
@@ -8,6 +8,7 @@
 #include "SFCoupling.h"
 #include "Mass.h"
 #include "MultilevelTimer.h"
+#include "Checkpoint.h"
 
 SolidFluidPoint::SolidFluidPoint(SolidPoint *sp, FluidPoint *fp, SFCoupling *couple): 
 mSolidPoint(sp), mFluidPoint(fp), mSFCoupling(couple),
@@ -24,9 +25,9 @@ SolidFluidPoint::~SolidFluidPoint() {
     delete mSFCoupling;
 }
 
-void SolidFluidPoint::updateNewmark(double dt) {
-    mSolidPoint->updateNewmark(dt);
-    mFluidPoint->updateNewmark(dt);
+void SolidFluidPoint::updateNewmark(double dt, double dtLast) {
+    mSolidPoint->updateNewmark(dt, dtLast);
+    mFluidPoint->updateNewmark(dt, dtLast);
 }
 
 bool SolidFluidPoint::stable() const {
@@ -38,6 +39,11 @@ void SolidFluidPoint::resetZero() {
     mFluidPoint->resetZero();
 }
 
+void SolidFluidPoint::syncState(Checkpoint &cp) {
+    mSolidPoint->syncState(cp);
+    mFluidPoint->syncState(cp);
+}
+
 void SolidFluidPoint::randomDispl(Real factor, int seed, int max_order) {
     mSolidPoint->randomDispl(factor, seed, max_order);
     mFluidPoint->randomDispl(factor, seed, max_order);
@@ -53,6 +59,11 @@ std::string SolidFluidPoint::verbose() const {
         + "$" + mFluidPoint->mMass->verbose() + "$" + mSFCoupling->verbose();
 } 
 
+size_t SolidFluidPoint::memoryBytes() const {
+    return sizeof(*this) + mSolidPoint->memoryBytes() + mFluidPoint->memoryBytes() 
+        + mSFCoupling->memoryBytes();
+}
+
 double SolidFluidPoint::measure(int count) {
     double cost = 0.;
     // solid
@@ -73,14 +84,9 @@ int SolidFluidPoint::sizeComm() const {
     return mSolidPoint->sizeComm() + mFluidPoint->sizeComm();
 }
 
-void SolidFluidPoint::feedBuffer(CColX &buffer, int &row) {
-    mSolidPoint->feedBuffer(buffer, row);
-    mFluidPoint->feedBuffer(buffer, row);
-}
-
-void SolidFluidPoint::extractBuffer(CColX &buffer, int &row) {
-    mSolidPoint->extractBuffer(buffer, row);
-    mFluidPoint->extractBuffer(buffer, row);
+void SolidFluidPoint::getCommStiff(std::vector<std::pair<Complex *, int>> &blocks) {
+    mSolidPoint->getCommStiff(blocks);
+    mFluidPoint->getCommStiff(blocks);
 }
 
 void SolidFluidPoint::scatterDisplToElement(vec_ar3_CMatPP &displ, int ipol, int jpol, int maxNu) const {
@@ -103,12 +109,28 @@ void SolidFluidPoint::addToStiff(const CMatX3 &source) {
     mSolidPoint->addToStiff(source);
 }
 
+void SolidFluidPoint::addToStiff(const CMatX3 &source, Real factor) {
+    mSolidPoint->addToStiff(source, factor);
+}
+
 void SolidFluidPoint::coupleSolidFluid() {
     // this order matters!
     mSFCoupling->coupleSolidToFluid(mSolidPoint->mDispl, mFluidPoint->mStiff);
     mSFCoupling->coupleFluidToSolid(mFluidPoint->mStiff, mSolidPoint->mStiff);
 }
 
+const CMatX3Map &SolidFluidPoint::getSolidDispl() const {
+    return mSolidPoint->mDispl;
+}
+
+CMatX3Map &SolidFluidPoint::getSolidStiff() {
+    return mSolidPoint->mStiff;
+}
+
+CColXMap &SolidFluidPoint::getFluidStiff() {
+    return mFluidPoint->mStiff;
+}
+
 double SolidFluidPoint::measureCoupling(int count) {
     mSolidPoint->randomDispl((Real)1e-6);
     MyBoostTimer timer;
@@ -126,14 +148,19 @@ void SolidFluidPoint::learnWisdom(Real cutoff) {
     mFluidPoint->learnWisdom(cutoff);
 }
 
+void SolidFluidPoint::resetWisdom() {
+    mSolidPoint->resetWisdom();
+    mFluidPoint->resetWisdom();
+}
+
 int SolidFluidPoint::getNuWisdom() const {
     return std::max(mSolidPoint->getNuWisdom(), mFluidPoint->getNuWisdom());
 }
 
-const CMatX3 &SolidFluidPoint::getDispFourierSolid() const {
+const CMatX3Map &SolidFluidPoint::getDispFourierSolid() const {
     return mSolidPoint->getDispFourierSolid();
 }
 
-const CColX &SolidFluidPoint::getDispFourierFluid() const {
+const CColXMap &SolidFluidPoint::getDispFourierFluid() const {
     return mFluidPoint->getDispFourierFluid();
 }
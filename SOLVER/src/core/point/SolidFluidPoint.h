@@ -15,7 +15,7 @@ public:
     SolidFluidPoint(SolidPoint *sp, FluidPoint *fp, SFCoupling *couple);
     ~SolidFluidPoint();
     
-    void updateNewmark(double dt);
+    void updateNewmark(double dt, double dtLast);
     
     // check stability
     bool stable() const;
@@ -23,6 +23,9 @@ public:
     // reset to zero 
     void resetZero(); 
     
+    // save or load field variables 
+    void syncState(Checkpoint &cp);
+    
     // randomize disp and stiff
     void randomDispl(Real factor = one, int seed = -1, int max_order = -1);
     void randomStiff(Real factor = one, int seed = -1, int max_order = -1);
@@ -30,6 +33,9 @@ public:
     // verbose
     std::string verbose() const;
     
+    // bytes
+    size_t memoryBytes() const;
+    
     // measure cost
     double measure(int count);
     
@@ -40,8 +46,11 @@ public:
     int sizeComm() const;
     
     // communication
-    void feedBuffer(CColX &buffer, int &row);
-    void extractBuffer(CColX &buffer, int &row);
+    void getCommStiff(std::vector<std::pair<Complex *, int>> &blocks);
+    
+    // fields of the two parts
+    SolidPoint *solidPoint() {return mSolidPoint;};
+    FluidPoint *fluidPoint() {return mFluidPoint;};
     
     // scatter displ to element
     void scatterDisplToElement(vec_ar3_CMatPP &displ, int ipol, int jpol, int maxNu) const;
@@ -53,17 +62,25 @@ public:
     
     // add to stiff, used by source
     void addToStiff(const CMatX3 &source);
+    void addToStiff(const CMatX3 &source, Real factor);
     
     ///////////// solid-fluid-only /////////////   
     void coupleSolidFluid();
     
+    // coupling and fields, used by SFBatch
+    const SFCoupling *getSFCoupling() const {return mSFCoupling;};
+    const CMatX3Map &getSolidDispl() const;
+    CMatX3Map &getSolidStiff();
+    CColXMap &getFluidStiff();
+    
     // wisdom
     void learnWisdom(Real cutoff);
+    void resetWisdom();
     int getNuWisdom() const;
     
     // get displacement
-    const CMatX3 &getDispFourierSolid() const;
-    const CColX &getDispFourierFluid() const;
+    const CMatX3Map &getDispFourierSolid() const;
+    const CColXMap &getDispFourierFluid() const;
     
 private:
     double measureCoupling(int count);
@@ -4,14 +4,24 @@
 
 #include "SolidPoint.h"
 #include "Mass.h"
+#include "MassOcean3D.h"
+#include "PointBatch.h"
 #include "MultilevelTimer.h"
+#include "Checkpoint.h"
 
 SolidPoint::SolidPoint(int nr, bool axial, const RDCol2 &crds, Mass *mass):
-Point(nr, axial, crds), mMass(mass) {
-    mDispl = CMatX3::Zero(mNu + 1, 3);
-    mVeloc = CMatX3::Zero(mNu + 1, 3);
-    mAccel = CMatX3::Zero(mNu + 1, 3);
-    mStiff = CMatX3::Zero(mNu + 1, 3);
+Point(nr, axial, crds), mStorage(CMatXX::Zero(mNu + 1, 9)), 
+#ifdef _USE_MIXED_PRECISION
+    mStorageN(CNMatXX::Zero(mNu + 1, 6)),
+#else
+    mStorageN(CNMatXX::Zero(mNu + 1, 3)),
+#endif
+mDispl(mStorage.col(0).data(), mNu + 1, 3), mVeloc(mStorageN.col(0).data(), mNu + 1, 3), 
+mAccel(mStorage.col(3).data(), mNu + 1, 3), mStiff(mStorage.col(6).data(), mNu + 1, 3), 
+#ifdef _USE_MIXED_PRECISION
+    mDisplN(mStorageN.col(3).data(), mNu + 1, 3),
+#endif
+mMass(mass) {
     mMass->checkCompatibility(nr);
     mNuWisdom.fill(mNu);
 }
@@ -20,19 +30,24 @@ SolidPoint::~SolidPoint() {
     delete mMass;
 }
 
-void SolidPoint::updateNewmark(double dt) {
+void SolidPoint::updateNewmark(double dt, double dtLast) {
     // mask stiff 
     maskField(mStiff);
     // compute accel inplace
     mMass->computeAccel(mStiff);
     // mask accel (masking must be called twice if mass is 3D)
     maskField(mStiff);
-    // update dt
-    double half_dt = half * dt;
-    double half_dt_dt = half_dt * dt;
-    mVeloc += (Real)half_dt * (mAccel + mStiff);
+    // update dt, closing the last step and starting the next
+    double half_dt_last = half * dtLast;
+    double half_dt_dt = half * dt * dt;
+    mVeloc += (RealN)half_dt_last * (mAccel + mStiff).cast<ComplexN>();
     mAccel = mStiff;
-    mDispl += (Real)dt * mVeloc + (Real)half_dt_dt * mAccel;  
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN += dt * mVeloc + half_dt_dt * mAccel.cast<ComplexN>();
+        mDispl = mDisplN.cast<Complex>();
+    #else
+        mDispl += (Real)dt * mVeloc + (Real)half_dt_dt * mAccel;  
+    #endif
     // zero stiffness for next time step
     mStiff.setZero();
 }
@@ -42,6 +57,21 @@ void SolidPoint::resetZero() {
     mDispl.setZero();
     mVeloc.setZero();
     mAccel.setZero();
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN.setZero();
+    #endif
+}
+
+void SolidPoint::syncState(Checkpoint &cp) {
+    cp.syncEigen(mDispl);
+    cp.syncEigen(mVeloc);
+    cp.syncEigen(mAccel);
+    cp.syncEigen(mStiff);
+    #ifdef _USE_MIXED_PRECISION
+        cp.syncEigen(mDisplN);
+    #endif
+    cp.syncEigen(mMaxDisplWisdom);
+    cp.syncEigen(mNuWisdom);
 }
 
 void SolidPoint::randomDispl(Real factor, int seed, int max_order) {
@@ -55,6 +85,9 @@ void SolidPoint::randomDispl(Real factor, int seed, int max_order) {
     }
     mDispl *= factor;
     maskField(mDispl);
+    #ifdef _USE_MIXED_PRECISION
+        mDisplN = mDispl.cast<ComplexN>();
+    #endif
 }
 
 void SolidPoint::randomStiff(Real factor, int seed, int max_order) {
@@ -74,6 +107,10 @@ std::string SolidPoint::verbose() const {
     return "SolidPoint$" + mMass->verbose();
 }
 
+size_t SolidPoint::memoryBytes() const {
+    return sizeof(*this) + heapBytes(mStorage) + heapBytes(mStorageN) + mMass->memoryBytes();
+}
+
 double SolidPoint::measure(int count) {
     Real dt = .1;
     randomStiff((Real)1e6); 
@@ -85,9 +122,14 @@ double SolidPoint::measure(int count) {
         maskField(mStiff);
         Real half_dt = half * dt;
         Real half_dt_dt = half_dt * dt;
-        mVeloc += half_dt * (mAccel + mStiff);
+        mVeloc += (RealN)half_dt * (mAccel + mStiff).cast<ComplexN>();
         mAccel = mStiff;
-        mDispl += dt * mVeloc + half_dt_dt * mAccel; 
+        #ifdef _USE_MIXED_PRECISION
+            mDisplN += (RealN)dt * mVeloc + (RealN)half_dt_dt * mAccel.cast<ComplexN>();
+            mDispl = mDisplN.cast<Complex>();
+        #else
+            mDispl += dt * mVeloc + half_dt_dt * mAccel; 
+        #endif
         mVeloc.setZero();
     }
     double elapsed_time = timer.elapsed();
@@ -114,7 +156,7 @@ void SolidPoint::test() {
             if (alpha == 0) {mStiff(alpha, idim) = two;}
                     
             // compute stiff 
-            updateNewmark(1.);
+            updateNewmark(1., 1.);
                     
             // positive-definite
             Real sr = mAccel(alpha, idim).real();
@@ -160,16 +202,39 @@ void SolidPoint::test() {
     }
 }
 
-void SolidPoint::feedBuffer(CColX &buffer, int &row) {
-    int size = mStiff.size();
-    buffer.block(row, 0, size, 1) = Eigen::Map<CColX>(mStiff.data(), size);
-    row += size;
+void SolidPoint::getCommStiff(std::vector<std::pair<Complex *, int>> &blocks) {
+    blocks.push_back(std::pair<Complex *, int>(mStiff.data(), mStiff.size()));
 }
 
-void SolidPoint::extractBuffer(CColX &buffer, int &row) {
-    int size = mStiff.size();
-    mStiff += Eigen::Map<CMatX3>(buffer.block(row, 0, size, 1).data(), mStiff.rows(), 3);
-    row += size;
+int SolidPoint::batchCols() const {
+    return (!mAxial && (mMass->getScalarInvMass() > zero || batchOcean())) ? 3 : 0;
+}
+
+bool SolidPoint::batchOcean() const {
+    return mMass->isOcean3D();
+}
+
+void SolidPoint::moveToBatch(PointBatch &batch, int icol) {
+    CMatX3Map(batch.getDispl(icol), mNu + 1, 3) = mDispl;
+    CNMatX3Map(batch.getVeloc(icol), mNu + 1, 3) = mVeloc;
+    CMatX3Map(batch.getAccel(icol), mNu + 1, 3) = mAccel;
+    CMatX3Map(batch.getStiff(icol), mNu + 1, 3) = mStiff;
+    new (&mDispl) CMatX3Map(batch.getDispl(icol), mNu + 1, 3);
+    new (&mVeloc) CNMatX3Map(batch.getVeloc(icol), mNu + 1, 3);
+    new (&mAccel) CMatX3Map(batch.getAccel(icol), mNu + 1, 3);
+    new (&mStiff) CMatX3Map(batch.getStiff(icol), mNu + 1, 3);
+    #ifdef _USE_MIXED_PRECISION
+        CNMatX3Map(batch.getDisplN(icol), mNu + 1, 3) = mDisplN;
+        new (&mDisplN) CNMatX3Map(batch.getDisplN(icol), mNu + 1, 3);
+    #endif
+    if (batchOcean()) {
+        const MassOcean3D *ocean = static_cast<const MassOcean3D *>(mMass);
+        batch.setOcean(icol, ocean->getInvMass(), ocean->getNormalScaled());
+    } else {
+        batch.setInvMass(icol, 3, mMass->getScalarInvMass());
+    }
+    mStorage.resize(0, 0);
+    mStorageN.resize(0, 0);
 }
 
 void SolidPoint::scatterDisplToElement(vec_ar3_CMatPP &displ, int ipol, int jpol, int maxNu) const {
@@ -213,7 +278,12 @@ void SolidPoint::addToStiff(const CMatX3 &source) {
     mStiff.topRows(source.rows()) += source;
 }
 
-void SolidPoint::maskField(CMatX3 &field) {
+void SolidPoint::addToStiff(const CMatX3 &source, Real factor) {
+    // scaled on the fly, no temporary
+    mStiff.topRows(source.rows()) += factor * source;
+}
+
+void SolidPoint::maskField(CMatX3Map &field) {
     field.row(0).imag().setZero();
     // axial boundary condition
     if (mAxial) {
@@ -238,33 +308,39 @@ void SolidPoint::maskField(CMatX3 &field) {
 }
 
 void SolidPoint::learnWisdom(Real cutoff) {
+    // L2 and Hilbert norms of the three components
+    RRow3 L2norm = mDispl.cwiseAbs2().colwise().sum();
+    RRow3 h2norm = L2norm - (Real).5 * mDispl.row(0).cwiseAbs2();
+    
+    // components reaching a new maximum learn again
+    RRow3 tol = -RRow3::Ones();
     for (int idim = 0; idim < 3; idim++) {
-        // L2 norm
-        Real L2norm = mDispl.col(idim).squaredNorm();
-        // Hilbert norm
-        Real h2norm = L2norm - .5 * mDispl.col(idim).row(0).squaredNorm();
-        if (h2norm <= mMaxDisplWisdom(idim)) {
-            continue;
+        if (h2norm(idim) > mMaxDisplWisdom(idim)) {
+            mMaxDisplWisdom(idim) = h2norm(idim);
+            tol(idim) = h2norm(idim) * cutoff * cutoff;
+            mNuWisdom(idim) = 0;
         }
-        mMaxDisplWisdom(idim) = h2norm;
-        
-        // try smaller orders
-        Real tol = h2norm * cutoff * cutoff;
-        bool found = false;
-        for (int newNu = 0; newNu < mNu; newNu++) {
-            Real diff = L2norm - mDispl.col(idim).topRows(newNu + 1).squaredNorm();
-            if (diff <= tol) {
-                mNuWisdom(idim) = newNu;
-                found = true;
-                break;
+    }
+    
+    // smallest orders leaving the residual under the tolerance, 
+    // accumulating the residual from the top in a single pass
+    RRow3 residual = RRow3::Zero();
+    for (int alpha = mNu; alpha >= 1 && (tol.array() >= zero).any(); alpha--) {
+        residual += mDispl.row(alpha).cwiseAbs2();
+        for (int idim = 0; idim < 3; idim++) {
+            if (tol(idim) >= zero && residual(idim) > tol(idim)) {
+                mNuWisdom(idim) = alpha;
+                tol(idim) = -one;
             }
         }
-        if (!found) {
-            mNuWisdom(idim) = mNu;
-        }
     }
 }
 
+void SolidPoint::resetWisdom() {
+    mMaxDisplWisdom = -RRow3::Ones();
+    mNuWisdom.setZero();
+}
+
 int SolidPoint::getNuWisdom() const {
     // int maxloc = 0;
     // mMaxDisplWisdom.maxCoeff(&maxloc);
@@ -7,7 +7,7 @@
 class Mass;
 #include "Point.h"
 
-class SolidPoint: public Point {
+class SolidPoint final: public Point {
     friend class SolidFluidPoint;
     
 public:    
@@ -15,7 +15,7 @@ public:
     ~SolidPoint();
     
     // update in time domain by Newmark
-    void updateNewmark(double dt);
+    void updateNewmark(double dt, double dtLast);
     
     // check stability
     bool stable() const {return mDispl.allFinite();};
@@ -23,6 +23,9 @@ public:
     // reset to zero 
     void resetZero(); 
     
+    // save or load field variables 
+    void syncState(Checkpoint &cp);
+    
     // randomize disp and stiff
     void randomDispl(Real factor = one, int seed = -1, int max_order = -1);
     void randomStiff(Real factor = one, int seed = -1, int max_order = -1);
@@ -30,6 +33,9 @@ public:
     // verbose
     std::string verbose() const;
     
+    // bytes
+    size_t memoryBytes() const;
+    
     // measure cost 
     double measure(int count);
     
@@ -40,10 +46,17 @@ public:
     int sizeComm() const {return mStiff.size();};
     
     // communication
-    void feedBuffer(CColX &buffer, int &row);
-    void extractBuffer(CColX &buffer, int &row);
+    void getCommStiff(std::vector<std::pair<Complex *, int>> &blocks);
+    
+    // structure-of-arrays batching
+    int batchCols() const;
+    bool batchOcean() const;
+    void moveToBatch(PointBatch &batch, int icol);
     
     ///////////// solid-only /////////////   
+    // fields of this point
+    SolidPoint *solidPoint() {return this;};
+    
     // scatter displ to element
     void scatterDisplToElement(vec_ar3_CMatPP &displ, int ipol, int jpol, int maxNu) const;
     
@@ -52,24 +65,33 @@ public:
     
     // add to stiff, used by source
     void addToStiff(const CMatX3 &source);
+    void addToStiff(const CMatX3 &source, Real factor);
     
     // wisdom
     void learnWisdom(Real cutoff);
+    void resetWisdom();
     int getNuWisdom() const;
     
     // get displacement
-    const CMatX3 &getDispFourierSolid() const {return mDispl;};
+    const CMatX3Map &getDispFourierSolid() const {return mDispl;};
     
 private:
     
     // mask 
-    void maskField(CMatX3 &field);
+    void maskField(CMatX3Map &field);
 
-    // fields
-    CMatX3 mDispl;
-    CMatX3 mVeloc;
-    CMatX3 mAccel;
-    CMatX3 mStiff;
+    // fields, mapped to mStorage/mStorageN or to a PointBatch
+    // veloc is kept in Newmark precision, see RealN
+    CMatXX mStorage;
+    CNMatXX mStorageN;
+    CMatX3Map mDispl;
+    CNMatX3Map mVeloc;
+    CMatX3Map mAccel;
+    CMatX3Map mStiff;
+    #ifdef _USE_MIXED_PRECISION
+        // displ in Newmark precision, mDispl is its rounded copy
+        CNMatX3Map mDisplN;
+    #endif
     
     // mass
     Mass *mMass;
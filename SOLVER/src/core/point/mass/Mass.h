@@ -5,18 +5,28 @@
 #pragma once
 
 #include "eigenc.h"
+#include "Arena.h"
 
-class Mass {
+class Mass: public ArenaObject {
 public:
     virtual ~Mass() {};
     
     // compute accel in-place
-    virtual void computeAccel(CMatX3 &stiff) const = 0;
-    virtual void computeAccel(CColX &stiff) const = 0;
+    virtual void computeAccel(CMatX3Map &stiff) const = 0;
+    virtual void computeAccel(CColXMap &stiff) const = 0;
     
     // check compatibility
     virtual void checkCompatibility(int nr) const {};
     
+    // scalar inverse mass for PointBatch, negative if not a scalar
+    virtual Real getScalarInvMass() const {return -one;};
+    
+    // 3D ocean-load mass, batched by PointBatch in Fourier space
+    virtual bool isOcean3D() const {return false;};
+    
     // verbose 
     virtual std::string verbose() const = 0;
+    
+    // bytes, for memory reports
+    virtual size_t memoryBytes() const = 0;
 };
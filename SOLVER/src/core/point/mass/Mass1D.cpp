@@ -9,10 +9,10 @@ mInvMass(invMass) {
     // nothing
 }
 
-void Mass1D::computeAccel(CMatX3 &stiff) const {
+void Mass1D::computeAccel(CMatX3Map &stiff) const {
     stiff *= mInvMass; 
 }
 
-void Mass1D::computeAccel(CColX &stiff) const {
+void Mass1D::computeAccel(CColXMap &stiff) const {
     stiff *= mInvMass; 
 }
\ No newline at end of file
@@ -11,12 +11,18 @@ public:
     Mass1D(Real invMass);
 
     // compute accel in-place
-    void computeAccel(CMatX3 &stiff) const;
-    void computeAccel(CColX &stiff) const;
+    void computeAccel(CMatX3Map &stiff) const;
+    void computeAccel(CColXMap &stiff) const;
+    
+    // scalar inverse mass for PointBatch
+    Real getScalarInvMass() const {return mInvMass;};
     
     // verbose
     std::string verbose() const {return "Mass1D";};
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this);};
+    
 private:
     // the scalar mass
     Real mInvMass;
@@ -10,7 +10,7 @@ Mass3D::Mass3D(const RColX &invMass): mInvMass(invMass) {
     // nothing
 }
 
-void Mass3D::computeAccel(CMatX3 &stiff) const {
+void Mass3D::computeAccel(CMatX3Map &stiff) const {
     // constants
     int Nr = mInvMass.rows();
     int Nc = Nr / 2 + 1;
@@ -34,7 +34,7 @@ void Mass3D::computeAccel(CMatX3 &stiff) const {
     stiff = SolverFFTW_3::getR2C_CMat().topRows(Nc);
 }
 
-void Mass3D::computeAccel(CColX &stiff) const {
+void Mass3D::computeAccel(CColXMap &stiff) const {
     // constants
     int Nr = mInvMass.rows();
     int Nc = Nr / 2 + 1;
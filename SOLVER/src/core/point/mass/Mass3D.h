@@ -11,14 +11,17 @@ public:
     Mass3D(const RColX &invMass);
     
     // compute accel in-place
-    void computeAccel(CMatX3 &stiff) const;
-    void computeAccel(CColX &stiff) const;
+    void computeAccel(CMatX3Map &stiff) const;
+    void computeAccel(CColXMap &stiff) const;
     
     void checkCompatibility(int nr) const;
     
     // verbose
     std::string verbose() const {return "Mass3D";};
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mInvMass);};
+    
 private:
     RColX mInvMass;
 };
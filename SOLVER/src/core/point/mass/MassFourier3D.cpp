@@ -0,0 +1,66 @@
+// MassFourier3D.cpp
+// created by Kuangdai on 14-Oct-2026 
+// weakly 3D mass in Fourier space
+// the inverse mass is expanded into a few azimuthal orders and applied to 
+// the Fourier stiffness as a short circulant convolution, skipping the FFT pair
+
+#include "MassFourier3D.h"
+
+MassFourier3D::MassFourier3D(const CColX &invMass, int nr): 
+mInvMass(invMass), mNr(nr) {
+    // nothing
+}
+
+namespace MassFourier3DAux {
+    // accel(alpha) = sum_k invMass(k) * stiff(alpha - k), with the orders 
+    // taken modulo Nr and those above Nr / 2 conjugated as in a real field, 
+    // which reproduces the product in physical space exactly
+    template<class TMap, class TMat, class TRow>
+    void convolve(const CColX &invMass, int nr, TMap &stiff, TMat &orig, TRow &acc) {
+        int order = invMass.rows() - 1;
+        int nc = stiff.rows();
+        bool nyquist = nr % 2 == 0;
+        orig = stiff;
+        auto element = [&](int beta, TRow &row) {
+            beta = ((beta % nr) + nr) % nr;
+            if (beta < nc) {
+                row = orig.row(beta);
+                if (nyquist && 2 * beta == nr) {
+                    // the imaginary part of the Nyquist mode is dropped by C2R
+                    row = row.real().template cast<Complex>();
+                }
+            } else {
+                row = orig.row(nr - beta).conjugate();
+            }
+        };
+        static thread_local TRow prev, next;
+        for (int alpha = 0; alpha < nc; alpha++) {
+            element(alpha, acc);
+            acc *= invMass(0);
+            for (int k = 1; k <= order; k++) {
+                element(alpha - k, prev);
+                element(alpha + k, next);
+                acc += invMass(k) * prev + std::conj(invMass(k)) * next;
+            }
+            stiff.row(alpha) = acc;
+        }
+    }
+}
+
+void MassFourier3D::computeAccel(CMatX3Map &stiff) const {
+    static thread_local CMatX3 orig;
+    static thread_local Eigen::Matrix<Complex, 1, 3> acc;
+    MassFourier3DAux::convolve(mInvMass, mNr, stiff, orig, acc);
+}
+
+void MassFourier3D::computeAccel(CColXMap &stiff) const {
+    static thread_local CColX orig;
+    static thread_local Eigen::Matrix<Complex, 1, 1> acc;
+    MassFourier3DAux::convolve(mInvMass, mNr, stiff, orig, acc);
+}
+
+void MassFourier3D::checkCompatibility(int nr) const {
+    if (mNr != nr) {
+        throw std::runtime_error("MassFourier3D::checkCompatibility || Incompatible size.");
+    }
+}
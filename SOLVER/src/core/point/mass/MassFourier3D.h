@@ -0,0 +1,32 @@
+// MassFourier3D.h
+// created by Kuangdai on 14-Oct-2026 
+// weakly 3D mass in Fourier space
+// the inverse mass is expanded into a few azimuthal orders and applied to 
+// the Fourier stiffness as a short circulant convolution, skipping the FFT pair
+
+#pragma once
+
+#include "Mass.h"
+
+class MassFourier3D : public Mass {
+public:
+    // inverse mass of order 0, 1, ..., K; negative orders are complex conjugates
+    MassFourier3D(const CColX &invMass, int nr);
+    
+    // compute accel in-place
+    void computeAccel(CMatX3Map &stiff) const;
+    void computeAccel(CColXMap &stiff) const;
+    
+    void checkCompatibility(int nr) const;
+    
+    // verbose
+    std::string verbose() const {return "MassFourier3D";};
+    
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mInvMass);};
+    
+private:
+    // Fourier coefficients of the inverse mass
+    CColX mInvMass;
+    int mNr;
+};
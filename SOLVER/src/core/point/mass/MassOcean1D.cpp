@@ -12,7 +12,7 @@ MassOcean1D::MassOcean1D(double mass, double massOcean, double theta) {
     mCost = (Real)cos(theta);
 }
 
-void MassOcean1D::computeAccel(CMatX3 &stiff) const {
+void MassOcean1D::computeAccel(CMatX3Map &stiff) const {
     int nr_small = (stiff.rows() - 1) * 2;
     int nc_small = nr_small / 2 + 1;
     CColX &stiff_Z = SolverFFTW_1::getC2R_CMat();
@@ -26,6 +26,6 @@ void MassOcean1D::computeAccel(CMatX3 &stiff) const {
     stiff.col(1) *= mInvMassR;
 }
 
-void MassOcean1D::computeAccel(CColX &stiff) const {
+void MassOcean1D::computeAccel(CColXMap &stiff) const {
     stiff *= mInvMassR; 
 }
\ No newline at end of file
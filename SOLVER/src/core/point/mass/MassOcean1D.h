@@ -11,12 +11,15 @@ public:
     MassOcean1D(double mass, double massOcean, double theta);
 
     // compute accel in-place
-    void computeAccel(CMatX3 &stiff) const;
-    void computeAccel(CColX &stiff) const;
+    void computeAccel(CMatX3Map &stiff) const;
+    void computeAccel(CColXMap &stiff) const;
     
     // verbose
     std::string verbose() const {return "MassOcean1D";};
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this);};
+    
 private:
     // the scalar mass
     Real mInvMassZ;
@@ -15,7 +15,7 @@ MassOcean3D::MassOcean3D(const RDColX &mass, const RDColX &massOcean, const RDMa
     mNormal_scal.col(2).array() *= scal.array();
 }
 
-void MassOcean3D::computeAccel(CMatX3 &stiff) const {
+void MassOcean3D::computeAccel(CMatX3Map &stiff) const {
     // constants
     int Nr = mInvMass.rows();
     int Nc = Nr / 2 + 1;
@@ -48,7 +48,7 @@ void MassOcean3D::computeAccel(CMatX3 &stiff) const {
     stiff = SolverFFTW_3::getR2C_CMat().topRows(Nc);
 }
 
-void MassOcean3D::computeAccel(CColX &stiff) const {
+void MassOcean3D::computeAccel(CColXMap &stiff) const {
     throw std::runtime_error("MassOcean3D::checkCompatibility || Fluid point with ocean load.");
 }
 
@@ -12,14 +12,22 @@ public:
     MassOcean3D(const RDColX &mass, const RDColX &massOcean, const RDMatX3 &normal);
     
     // compute accel in-place
-    void computeAccel(CMatX3 &stiff) const;
-    void computeAccel(CColX &stiff) const;
+    void computeAccel(CMatX3Map &stiff) const;
+    void computeAccel(CColXMap &stiff) const;
     
     void checkCompatibility(int nr) const;
     
+    // inverse mass and scaled normal, used by PointBatch
+    bool isOcean3D() const {return true;};
+    const RColX &getInvMass() const {return mInvMass;};
+    const RMatX3 &getNormalScaled() const {return mNormal_scal;};
+    
     // verbose
     std::string verbose() const {return "MassOcean3D";};
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mInvMass) + heapBytes(mNormal_scal);};
+    
 private:
     RColX mInvMass;
     RMatX3 mNormal_scal; 
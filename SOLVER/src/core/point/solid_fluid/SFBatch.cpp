@@ -0,0 +1,79 @@
+// SFBatch.cpp
+// created by Kuangdai on 14-Oct-2026 
+// batched 3D solid-fluid coupling of points with equal nr
+
+#include "SFBatch.h"
+#include "SolidFluidPoint.h"
+#include "SFCoupling3D.h"
+
+SFBatch::SFBatch(int nr, const std::vector<SolidFluidPoint *> &points): 
+mNr(nr), mNu(nr / 2), mPoints(points) {
+    int npnt = mPoints.size();
+    mNormal_unassembled = RMatXX(mNr, 3 * npnt);
+    mNormal_assembled_invMassFluid = RMatXX(mNr, 3 * npnt);
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        const SFCoupling3D *couple = 
+            static_cast<const SFCoupling3D *>(mPoints[ipnt]->getSFCoupling());
+        mNormal_unassembled.block(0, 3 * ipnt, mNr, 3) = couple->getNormal();
+        mNormal_assembled_invMassFluid.block(0, 3 * ipnt, mNr, 3) = couple->getNormalInvMassFluid();
+    }
+    
+    // buffers and plans
+    mSolidR = RMatXX::Zero(mNr, 3 * npnt);
+    mSolidC = CMatXX::Zero(mNu + 1, 3 * npnt);
+    mFluidR = RMatXX::Zero(mNr, npnt);
+    mFluidC = CMatXX::Zero(mNu + 1, npnt);
+    mSolidC2R = SolverFFTW::planC2R(mNr, 3 * npnt, mSolidC.data(), mNu + 1, mSolidR.data(), mNr);
+    mSolidR2C = SolverFFTW::planR2C(mNr, 3 * npnt, mSolidR.data(), mNr, mSolidC.data(), mNu + 1);
+    mFluidC2R = SolverFFTW::planC2R(mNr, npnt, mFluidC.data(), mNu + 1, mFluidR.data(), mNr);
+    mFluidR2C = SolverFFTW::planR2C(mNr, npnt, mFluidR.data(), mNr, mFluidC.data(), mNu + 1);
+}
+
+SFBatch::~SFBatch() {
+    distroyFFTW(mSolidC2R);
+    distroyFFTW(mSolidR2C);
+    distroyFFTW(mFluidC2R);
+    distroyFFTW(mFluidR2C);
+}
+
+void SFBatch::coupleSolidFluid() {
+    // same order as SolidFluidPoint::coupleSolidFluid
+    int npnt = mPoints.size();
+    Real inv_nr = one / (Real)mNr;
+    
+    // solid => fluid
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        mSolidC.block(0, 3 * ipnt, mNu + 1, 3) = mPoints[ipnt]->getSolidDispl();
+    }
+    execFFTW(mSolidC2R);
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        mFluidR.col(ipnt) = mNormal_unassembled.col(3 * ipnt + 0).schur(mSolidR.col(3 * ipnt + 0))
+                          + mNormal_unassembled.col(3 * ipnt + 1).schur(mSolidR.col(3 * ipnt + 1))
+                          + mNormal_unassembled.col(3 * ipnt + 2).schur(mSolidR.col(3 * ipnt + 2));
+    }
+    execFFTW(mFluidR2C);
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        CColXMap &fluidStiff = mPoints[ipnt]->getFluidStiff();
+        fluidStiff += inv_nr * mFluidC.col(ipnt);
+        mFluidC.col(ipnt) = fluidStiff;
+    }
+    
+    // fluid => solid
+    execFFTW(mFluidC2R);
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        for (int idim = 0; idim < 3; idim++) {
+            mSolidR.col(3 * ipnt + idim) = 
+                mNormal_assembled_invMassFluid.col(3 * ipnt + idim).schur(mFluidR.col(ipnt));
+        }
+    }
+    execFFTW(mSolidR2C);
+    for (int ipnt = 0; ipnt < npnt; ipnt++) {
+        mPoints[ipnt]->getSolidStiff() -= inv_nr * mSolidC.block(0, 3 * ipnt, mNu + 1, 3);
+    }
+}
+
+size_t SFBatch::memoryBytes() const {
+    return sizeof(*this) + heapBytes(mPoints) + 
+        heapBytes(mNormal_unassembled) + heapBytes(mNormal_assembled_invMassFluid) + 
+        heapBytes(mSolidR) + heapBytes(mSolidC) + heapBytes(mFluidR) + heapBytes(mFluidC);
+}
@@ -0,0 +1,45 @@
+// SFBatch.h
+// created by Kuangdai on 14-Oct-2026 
+// batched 3D solid-fluid coupling of points with equal nr
+
+#pragma once
+
+#include "eigenc.h"
+#include "SolverFFTW.h"
+
+class SolidFluidPoint;
+
+class SFBatch {
+public:
+    // all points must have 3D coupling and the given nr
+    SFBatch(int nr, const std::vector<SolidFluidPoint *> &points);
+    ~SFBatch();
+    
+    // solid-fluid coupling of all points, one many-transform FFT per stage
+    void coupleSolidFluid();
+    
+    int getNumPoints() const {return mPoints.size();};
+    
+    // bytes of the normals and the FFT buffers
+    size_t memoryBytes() const;
+    
+private:
+    // n_r, n_u
+    int mNr;
+    int mNu;
+    std::vector<SolidFluidPoint *> mPoints;
+    
+    // contiguous normals, 3 columns per point
+    RMatXX mNormal_unassembled;
+    RMatXX mNormal_assembled_invMassFluid;
+    
+    // transform buffers, 3 columns per point for solid and 1 for fluid
+    RMatXX mSolidR;
+    CMatXX mSolidC;
+    RMatXX mFluidR;
+    CMatXX mFluidC;
+    PlanFFTW mSolidC2R;
+    PlanFFTW mSolidR2C;
+    PlanFFTW mFluidC2R;
+    PlanFFTW mFluidR2C;
+};
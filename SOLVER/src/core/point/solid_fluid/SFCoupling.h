@@ -5,18 +5,25 @@
 #pragma once
 
 #include "eigenc.h"
+#include "Arena.h"
 
-class SFCoupling {
+class SFCoupling: public ArenaObject {
 public:   
     virtual ~SFCoupling() {};
     
     // solid-fluid coupling
-    virtual void coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStiff) const = 0; 
-    virtual void coupleSolidToFluid(const CMatX3 &solidDispl, CColX &fluidStiff) const = 0;
+    virtual void coupleFluidToSolid(const CColXMap &fluidStiff, CMatX3Map &solidStiff) const = 0; 
+    virtual void coupleSolidToFluid(const CMatX3Map &solidDispl, CColXMap &fluidStiff) const = 0;
     
     // verbose
     virtual std::string verbose() const = 0;    
     
+    // bytes, for memory reports
+    virtual size_t memoryBytes() const = 0;
+    
     // check compatibility
     virtual void checkCompatibility(int nr) const {};
+    
+    // 3D couplings are batched by nr in Domain
+    virtual bool is3D() const {return false;};
 };
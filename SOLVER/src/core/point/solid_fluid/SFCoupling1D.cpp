@@ -6,12 +6,12 @@
 #include "SolidPoint.h"
 #include "FluidPoint.h"
 
-void SFCoupling1D::coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStiff) const {
+void SFCoupling1D::coupleFluidToSolid(const CColXMap &fluidStiff, CMatX3Map &solidStiff) const {
     solidStiff.col(0) -= mNormalS_assembled_invMassFluid * fluidStiff;
     solidStiff.col(2) -= mNormalZ_assembled_invMassFluid * fluidStiff;
 }
 
-void SFCoupling1D::coupleSolidToFluid(const CMatX3 &solidDispl, CColX &fluidStiff) const {
+void SFCoupling1D::coupleSolidToFluid(const CMatX3Map &solidDispl, CColXMap &fluidStiff) const {
     fluidStiff += mNormalS_unassembled * solidDispl.col(0) 
                 + mNormalZ_unassembled * solidDispl.col(2);
 }
@@ -15,12 +15,15 @@ public:
         mNormalZ_assembled_invMassFluid(nz_invmf) {};
     
     // solid-fluid coupling
-    void coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStiff) const; 
-    void coupleSolidToFluid(const CMatX3 &solidDispl, CColX &fluidStiff) const;
+    void coupleFluidToSolid(const CColXMap &fluidStiff, CMatX3Map &solidStiff) const; 
+    void coupleSolidToFluid(const CMatX3Map &solidDispl, CColXMap &fluidStiff) const;
     
     // verbose
     std::string verbose() const {return "SFCoupling1D";};    
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this);};
+    
 private:    
     Real mNormalS_unassembled;
     Real mNormalZ_unassembled;
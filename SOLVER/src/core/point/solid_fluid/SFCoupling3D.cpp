@@ -6,7 +6,7 @@
 #include "SolverFFTW_1.h"
 #include "SolverFFTW_3.h"
 
-void SFCoupling3D::coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStiff) const {
+void SFCoupling3D::coupleFluidToSolid(const CColXMap &fluidStiff, CMatX3Map &solidStiff) const {
     // constants
     int Nr = mNormal_assembled_invMassFluid.rows();
     int Nc = Nr / 2 + 1;
@@ -30,7 +30,7 @@ void SFCoupling3D::coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStif
     solidStiff -= SolverFFTW_3::getR2C_CMat().topRows(Nc);
 }
 
-void SFCoupling3D::coupleSolidToFluid(const CMatX3 &solidDispl, CColX &fluidStiff) const {
+void SFCoupling3D::coupleSolidToFluid(const CMatX3Map &solidDispl, CColXMap &fluidStiff) const {
     // constants
     int Nr = mNormal_unassembled.rows();
     int Nc = Nr / 2 + 1;
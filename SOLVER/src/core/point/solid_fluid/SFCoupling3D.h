@@ -13,14 +13,22 @@ public:
         mNormal_assembled_invMassFluid(n_invmf) {};
     
     // solid-fluid coupling
-    void coupleFluidToSolid(const CColX &fluidStiff, CMatX3 &solidStiff) const; 
-    void coupleSolidToFluid(const CMatX3 &solidDispl, CColX &fluidStiff) const;
+    void coupleFluidToSolid(const CColXMap &fluidStiff, CMatX3Map &solidStiff) const; 
+    void coupleSolidToFluid(const CMatX3Map &solidDispl, CColXMap &fluidStiff) const;
     
     // verbose
     std::string verbose() const {return "SFCoupling3D";};
     
+    // bytes
+    size_t memoryBytes() const {return sizeof(*this) + heapBytes(mNormal_unassembled) + heapBytes(mNormal_assembled_invMassFluid);};
+    
     // check compatibility
     void checkCompatibility(int nr) const;
+    
+    // normals, used by SFBatch
+    bool is3D() const {return true;};
+    const RMatX3 &getNormal() const {return mNormal_unassembled;};
+    const RMatX3 &getNormalInvMassFluid() const {return mNormal_assembled_invMassFluid;};
 
 private:    
     RMatX3 mNormal_unassembled;
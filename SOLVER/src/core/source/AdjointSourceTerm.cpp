@@ -0,0 +1,144 @@
+// AdjointSourceTerm.cpp
+// created by Kuangdai on 14-Oct-2026 
+// adjoint sources in the solver
+// Each station carries three unit forces (Ft, Fp, Fr) on the points of its 
+// element, scaled by the three components of its trace, time reversed. 
+// The unit forces on a point are stacked as the columns of one matrix, so 
+// that a time step costs one matrix-vector product per point, whatever the 
+// number of stations sharing the point. The traces are read from a NetCDF 
+// file in chunks of samples following the time loop, only the stations 
+// owned by this rank being kept.
+
+#include "AdjointSourceTerm.h"
+#include "Domain.h"
+#include "Element.h"
+#include "Point.h"
+#include "NetCDF_Reader.h"
+
+AdjointSourceTerm::AdjointSourceTerm(const std::string &fileName, int numStations, 
+    int numSamples, double dt, double t0):
+mFileName(fileName), mNumStations(numStations), mNumSamples(numSamples),
+mDeltaT(dt), mTimeStart(t0) {
+    // nothing
+}
+
+void AdjointSourceTerm::addForce(const Domain &domain, const Element *element, 
+    const arPP_CMatX3 &force, int ista, int icomp) {
+    // local column
+    auto its = mStationIndex.find(ista);
+    if (its == mStationIndex.end()) {
+        its = mStationIndex.insert(std::make_pair(ista, (int)mStations.size())).first;
+        mStations.push_back(ista);
+        mValues = CColX::Zero(mStations.size() * 3);
+    }
+    int icol = its->second * 3 + icomp;
+    
+    for (int i = 0; i < nPntElem; i++) {
+        Point *point = domain.getPoint(element->getPoint(i)->getDomainTag());
+        auto it = mPointIndex.find(point);
+        if (it == mPointIndex.end()) {
+            it = mPointIndex.insert(std::make_pair(point, (int)mPoints.size())).first;
+            AdjointPoint ap;
+            ap.mPoint = point;
+            ap.mRows = point->getNu() + 1;
+            ap.mForces = CMatXX::Zero(ap.mRows * 3, 0);
+            ap.mForce = CMatX3::Zero(ap.mRows, 3);
+            mPoints.push_back(ap);
+        }
+        AdjointPoint &ap = mPoints[it->second];
+        // make the order consistent
+        int length = std::min(ap.mRows, (int)force[i].rows());
+        CMatX3 unit = CMatX3::Zero(ap.mRows, 3);
+        unit.topRows(length) = force[i].topRows(length);
+        // a column of its own, or added to the column of the same component 
+        // if the station has been added to this point
+        int jcol = -1;
+        for (int j = 0; j < ap.mColumns.size(); j++) {
+            if (ap.mColumns[j] == icol) {
+                jcol = j;
+            }
+        }
+        if (jcol < 0) {
+            jcol = ap.mColumns.size();
+            ap.mColumns.push_back(icol);
+            ap.mForces.conservativeResize(Eigen::NoChange, jcol + 1);
+            ap.mForces.col(jcol).setZero();
+            ap.mValues = CColX::Zero(jcol + 1);
+        }
+        ap.mForces.col(jcol) += Eigen::Map<const CColX>(unit.data(), ap.mRows * 3);
+    }
+}
+
+void AdjointSourceTerm::readChunk(int start) {
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(true);
+    #endif
+    
+    // the range of local stations only
+    int nsta = mStations.size();
+    int staMin = mStationIndex.begin()->first;
+    int staMax = mStationIndex.rbegin()->first;
+    int nstaRead = staMax - staMin + 1;
+    mChunkStart = start;
+    mChunkCount = std::min(mChunkSamples, mNumSamples - start);
+    NetCDF_Reader reader;
+    reader.open(mFileName);
+    reader.readHyperslab("traces", mBuffer, {(size_t)mChunkStart, (size_t)staMin, 0}, 
+        {(size_t)mChunkCount, (size_t)nstaRead, 3});
+    reader.close();
+    mChunk = RMatXX::Zero(mChunkCount, nsta * 3);
+    for (int it = 0; it < mChunkCount; it++) {
+        for (int ista = 0; ista < nsta; ista++) {
+            for (int icomp = 0; icomp < 3; icomp++) {
+                mChunk(it, ista * 3 + icomp) = (Real)mBuffer[
+                    (it * nstaRead + mStations[ista] - staMin) * 3 + icomp];
+            }
+        }
+    }
+    
+    #ifndef NDEBUG
+        Eigen::internal::set_is_malloc_allowed(false);
+    #endif
+}
+
+void AdjointSourceTerm::apply(double t) {
+    if (mStations.size() == 0) {
+        return;
+    }
+    
+    // time reversed, the last sample at the start time
+    double pos = (mNumSamples - 1) - (t - mTimeStart) / mDeltaT;
+    if (pos <= -1. || pos >= mNumSamples) {
+        return;
+    }
+    // linear between two samples, zero beyond the ends of the traces
+    int i0 = (int)floor(pos);
+    int i1 = i0 + 1;
+    Real w1 = (Real)(pos - i0);
+    Real w0 = one - w1;
+    if (i0 < 0) {
+        i0 = i1;
+        w0 = zero;
+    }
+    if (i1 > mNumSamples - 1) {
+        i1 = i0;
+        w1 = zero;
+    }
+    
+    // samples run backwards with time, so a chunk ends at the later one
+    if (i0 < mChunkStart || i1 >= mChunkStart + mChunkCount) {
+        readChunk(std::max(i1 - mChunkSamples + 1, 0));
+    }
+    mValues.real() = w0 * mChunk.row(i0 - mChunkStart).transpose() 
+        + w1 * mChunk.row(i1 - mChunkStart).transpose();
+    
+    // forces on points
+    for (AdjointPoint &ap: mPoints) {
+        for (int j = 0; j < ap.mColumns.size(); j++) {
+            ap.mValues(j) = mValues(ap.mColumns[j]);
+        }
+        Eigen::Map<CColX>(ap.mForce.data(), ap.mRows * 3).noalias() = ap.mForces * ap.mValues;
+        ap.mPoint->addToStiff(ap.mForce);
+    }
+}
+
@@ -0,0 +1,75 @@
+// AdjointSourceTerm.h
+// created by Kuangdai on 14-Oct-2026 
+// adjoint sources in the solver
+// Each station carries three unit forces (Ft, Fp, Fr) on the points of its 
+// element, scaled by the three components of its trace, time reversed. 
+// The unit forces on a point are stacked as the columns of one matrix, so 
+// that a time step costs one matrix-vector product per point, whatever the 
+// number of stations sharing the point. The traces are read from a NetCDF 
+// file in chunks of samples following the time loop, only the stations 
+// owned by this rank being kept.
+
+#pragma once
+
+#include "eigenc.h"
+#include <map>
+
+class Domain;
+class Element;
+class Point;
+
+class AdjointSourceTerm {
+public:
+    // traces(nt, nsta, 3) in fileName, injected reversed at interval dt, 
+    // the last sample at t0 after origin
+    AdjointSourceTerm(const std::string &fileName, int numStations, 
+        int numSamples, double dt, double t0);
+    
+    // add the unit force of component icomp of station ista in element
+    void addForce(const Domain &domain, const Element *element, 
+        const arPP_CMatX3 &force, int ista, int icomp);
+    
+    // apply at time t after origin
+    void apply(double t);
+    
+    int getNumStations() const {return mStationIndex.size();};
+    
+private:
+    // samples of the local columns from sample start on
+    void readChunk(int start);
+    
+    // file
+    std::string mFileName;
+    int mNumStations;
+    int mNumSamples;
+    double mDeltaT;
+    double mTimeStart;
+    
+    // local columns, 3 per local station
+    std::map<int, int> mStationIndex;
+    std::vector<int> mStations;
+    
+    struct AdjointPoint {
+        Point *mPoint;
+        int mRows;
+        // unit forces flattened as columns, with their local columns
+        CMatXX mForces;
+        std::vector<int> mColumns;
+        // buffers
+        CColX mValues;
+        CMatX3 mForce;
+    };
+    std::vector<AdjointPoint> mPoints;
+    std::map<Point *, int> mPointIndex;
+    
+    // current chunk of traces, (sample, local column)
+    const int mChunkSamples = 1000;
+    int mChunkStart = 0;
+    int mChunkCount = 0;
+    RMatXX mChunk;
+    std::vector<double> mBuffer;
+    
+    // trace values of the local columns at the current step
+    CColX mValues;
+};
+
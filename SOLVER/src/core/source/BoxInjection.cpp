@@ -0,0 +1,330 @@
+// BoxInjection.cpp
+// created by Kuangdai on 14-Oct-2026
+// wavefield injection on the boundary of a box, for regional studies
+// of a distant source
+// File of a rank: a header of version, nPol, number of keys, steps per
+// chunk, number of steps, dt and time of the first step, followed by
+// the keys and their numbers of orders; then the chunks, as mBuffer.
+
+#include "BoxInjection.h"
+#include "Element.h"
+#include "Point.h"
+#include "XMPI.h"
+#include <cmath>
+#include <sstream>
+
+namespace BoxInjectionFile {
+    const int sVersion = 1;
+    // version, nPol, nKeys, chunk steps, nSteps; dt, t0
+    const size_t sFixedBytes = 5 * sizeof(int) + 2 * sizeof(double);
+    // offset of nSteps, rewritten at the end of a record run
+    const size_t sStepsOffset = 4 * sizeof(int);
+    // key and number of orders
+    const size_t sKeyBytes = 4 * sizeof(int);
+}
+
+BoxInjection::BoxInjection(bool record, const std::string &directory, int bufferSize):
+mRecord(record), mDirectory(directory), mBufferSize(bufferSize) {
+    if (mRecord && mBufferSize <= 0) {
+        throw std::runtime_error("BoxInjection::BoxInjection || "
+            "Non-positive BOX_INJECTION_BUFFER_SIZE.");
+    }
+}
+
+BoxInjection::~BoxInjection() {
+    for (const auto &source: mSources) {
+        delete source.mFile;
+    }
+    if (mOutFile) {
+        delete mOutFile;
+    }
+}
+
+int BoxInjection::findOrAddKey(const std::array<int, 3> &key, int norder) {
+    auto it = mKeyIndex.find(key);
+    if (it != mKeyIndex.end()) {
+        mKeyOrders[it->second] = std::max(mKeyOrders[it->second], norder);
+        return it->second;
+    }
+    mKeyIndex.insert(std::make_pair(key, (int)mKeys.size()));
+    mKeys.push_back(key);
+    mKeyOrders.push_back(norder);
+    return mKeys.size() - 1;
+}
+
+void BoxInjection::formKeyOffsets() {
+    mKeyOffsets.clear();
+    mStepValues = 0;
+    for (int norder: mKeyOrders) {
+        mKeyOffsets.push_back(mStepValues);
+        mStepValues += norder * 6;
+    }
+}
+
+void BoxInjection::addTap(Element *elem, const std::vector<int> &ipnts,
+    const std::vector<std::array<int, 3>> &keys) {
+    elem->setStiffTap(ipnts);
+    Tap tap;
+    tap.mElement = elem;
+    for (const auto &key: keys) {
+        tap.mKeys.push_back(findOrAddKey(key, elem->getMaxNu() + 1));
+    }
+    mTaps.push_back(tap);
+}
+
+void BoxInjection::addPoint(Point *point, const std::array<int, 3> &key, Real share) {
+    if (point->solidPoint() == 0) {
+        throw std::runtime_error("BoxInjection::addPoint || "
+            "The boundary of BOX_INJECTION_REGION must be in the solid.");
+    }
+    mPoints.push_back(point);
+    mPointKeys.push_back(findOrAddKey(key, point->getNu() + 1));
+    mShares.push_back(share);
+    mForces.push_back(CMatX3::Zero(point->getNu() + 1, 3));
+}
+
+void BoxInjection::addDormant(int elemTag) {
+    if (elemTag >= (int)mDormant.size()) {
+        mDormant.resize(elemTag + 1, false);
+    }
+    mDormant[elemTag] = true;
+}
+
+int BoxInjection::getNumDormant() const {
+    int ndormant = 0;
+    for (bool dormant: mDormant) {
+        ndormant += (int)dormant;
+    }
+    return ndormant;
+}
+
+std::string BoxInjection::fileName(int rank) const {
+    std::stringstream ss;
+    ss << mDirectory << "/box_injection_" << rank << ".bin";
+    return ss.str();
+}
+
+void BoxInjection::initialize(int totalSteps, double dt, double t0, int restartStep) {
+    formKeyOffsets();
+    if (mRecord) {
+        if (restartStep > 0) {
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Box injection cannot be recorded by a restarted run.");
+        }
+        if (XMPI::root()) {
+            XMPI::mkdir(mDirectory);
+            if (!XMPI::dirExists(mDirectory)) {
+                throw std::runtime_error("BoxInjection::initialize || "
+                    "Error creating directory: || " + mDirectory);
+            }
+        }
+        XMPI::barrier();
+        
+        // every rank writes a file, keyless or not, read in order of ranks
+        mOutFile = new std::ofstream(fileName(XMPI::rank()), std::ios::binary);
+        if (!(*mOutFile)) {
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Error opening file: || " + fileName(XMPI::rank()));
+        }
+        int fixed[5] = {BoxInjectionFile::sVersion, nPol, (int)mKeys.size(), mBufferSize, 0};
+        double times[2] = {dt, t0};
+        mOutFile->write((const char *)fixed, sizeof(fixed));
+        mOutFile->write((const char *)times, sizeof(times));
+        for (int ikey = 0; ikey < mKeys.size(); ikey++) {
+            int key[4] = {mKeys[ikey][0], mKeys[ikey][1], mKeys[ikey][2], mKeyOrders[ikey]};
+            mOutFile->write((const char *)key, sizeof(key));
+        }
+        mBuffer.assign(mBufferSize * mStepValues, 0.);
+        mChunk = 0;
+        return;
+    }
+    
+    // inject: all files recorded, keeping those with keys of this rank
+    std::vector<bool> found(mKeys.size(), false);
+    mBufferSize = 0;
+    size_t maxMatch = 0;
+    for (int irank = 0; ; irank++) {
+        std::ifstream *fs = new std::ifstream(fileName(irank), std::ios::binary);
+        if (!(*fs)) {
+            delete fs;
+            if (irank == 0) {
+                throw std::runtime_error("BoxInjection::initialize || "
+                    "Error opening file: || " + fileName(irank));
+            }
+            break;
+        }
+        int fixed[5];
+        double times[2];
+        fs->read((char *)fixed, sizeof(fixed));
+        fs->read((char *)times, sizeof(times));
+        if (!(*fs) || fixed[0] != BoxInjectionFile::sVersion) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Invalid file: || " + fileName(irank));
+        }
+        if (fixed[1] != nPol) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Recorded with a different nPol: || " + fileName(irank));
+        }
+        if (std::abs(times[0] - dt) > 1e-6 * dt || std::abs(times[1] - t0) > 1e-6 * dt) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Recorded with a different time step or start time: || " + fileName(irank) +
+                " || Use the same source time function and TIME_DELTA_T in both runs.");
+        }
+        if (fixed[4] < totalSteps) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Fewer steps recorded than simulated: || " + fileName(irank));
+        }
+        if (mBufferSize > 0 && fixed[3] != mBufferSize) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Inconsistent steps per chunk: || " + fileName(irank));
+        }
+        mBufferSize = fixed[3];
+        
+        Source source;
+        source.mFile = fs;
+        source.mHeaderBytes = BoxInjectionFile::sFixedBytes +
+            fixed[2] * BoxInjectionFile::sKeyBytes;
+        source.mChunkValues = 0;
+        for (int ikey = 0; ikey < fixed[2]; ikey++) {
+            int key[4];
+            fs->read((char *)key, sizeof(key));
+            auto it = mKeyIndex.find({key[0], key[1], key[2]});
+            if (it != mKeyIndex.end()) {
+                Match match;
+                match.mKey = it->second;
+                match.mOffset = source.mChunkValues;
+                match.mOrders = key[3];
+                source.mMatches.push_back(match);
+                found[it->second] = true;
+                maxMatch = std::max(maxMatch, (size_t)key[3] * 6);
+            }
+            source.mChunkValues += (size_t)mBufferSize * key[3] * 6;
+        }
+        if (!(*fs)) {
+            delete fs;
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Invalid file: || " + fileName(irank));
+        }
+        if (source.mMatches.size() > 0) {
+            mSources.push_back(source);
+        } else {
+            delete fs;
+        }
+    }
+    for (int ikey = 0; ikey < mKeys.size(); ikey++) {
+        if (!found[ikey]) {
+            throw std::runtime_error("BoxInjection::initialize || "
+                "Boundary points missing from the recorded files. || "
+                "Use the same mesh, nPol and BOX_INJECTION_REGION in both runs.");
+        }
+    }
+    mBuffer.assign(mBufferSize * mStepValues, 0.);
+    mScratch.assign(mBufferSize * maxMatch, 0.);
+    mChunk = -1;
+}
+
+void BoxInjection::finalize() {
+    if (!mRecord || !mOutFile) {
+        return;
+    }
+    if (mRecordedSteps > mChunk * mBufferSize) {
+        writeChunk();
+    }
+    mOutFile->seekp(BoxInjectionFile::sStepsOffset);
+    mOutFile->write((const char *)&mRecordedSteps, sizeof(int));
+    mOutFile->close();
+    delete mOutFile;
+    mOutFile = 0;
+}
+
+void BoxInjection::writeChunk() {
+    mOutFile->write((const char *)mBuffer.data(), mBuffer.size() * sizeof(double));
+    if (!(*mOutFile)) {
+        throw std::runtime_error("BoxInjection::writeChunk || "
+            "Error writing file: || " + fileName(XMPI::rank()));
+    }
+}
+
+void BoxInjection::readChunk(int ichunk) {
+    std::fill(mBuffer.begin(), mBuffer.end(), 0.);
+    for (const auto &source: mSources) {
+        size_t chunkStart = source.mHeaderBytes +
+            ichunk * source.mChunkValues * sizeof(double);
+        for (const auto &match: source.mMatches) {
+            size_t nread = (size_t)mBufferSize * match.mOrders * 6;
+            source.mFile->seekg(chunkStart + match.mOffset * sizeof(double));
+            source.mFile->read((char *)mScratch.data(), nread * sizeof(double));
+            if (!(*source.mFile)) {
+                throw std::runtime_error("BoxInjection::readChunk || "
+                    "Error reading recorded box injection.");
+            }
+            // orders beyond those of this run dropped
+            int norder = mKeyOrders[match.mKey];
+            int ncopy = std::min(norder, match.mOrders) * 6;
+            double *buffer = mBuffer.data() + mBufferSize * mKeyOffsets[match.mKey];
+            for (int istep = 0; istep < mBufferSize; istep++) {
+                const double *scratch = mScratch.data() + istep * match.mOrders * 6;
+                double *step = buffer + istep * norder * 6;
+                for (int i = 0; i < ncopy; i++) {
+                    step[i] += scratch[i];
+                }
+            }
+        }
+    }
+    mChunk = ichunk;
+}
+
+void BoxInjection::record(int tstep) {
+    int ichunk = tstep / mBufferSize;
+    if (ichunk != mChunk) {
+        writeChunk();
+        std::fill(mBuffer.begin(), mBuffer.end(), 0.);
+        mChunk = ichunk;
+    }
+    int istep = tstep % mBufferSize;
+    for (const auto &tap: mTaps) {
+        const CMatXX &stiff = tap.mElement->getStiffTap();
+        for (int ip = 0; ip < tap.mKeys.size(); ip++) {
+            int ikey = tap.mKeys[ip];
+            int norder = mKeyOrders[ikey];
+            double *step = mBuffer.data() + mBufferSize * mKeyOffsets[ikey] +
+                istep * norder * 6;
+            for (int alpha = 0; alpha < stiff.rows(); alpha++) {
+                for (int idim = 0; idim < 3; idim++) {
+                    const Complex &value = stiff(alpha, ip * 3 + idim);
+                    step[alpha * 6 + idim * 2] += value.real();
+                    step[alpha * 6 + idim * 2 + 1] += value.imag();
+                }
+            }
+        }
+    }
+    mRecordedSteps = std::max(mRecordedSteps, tstep + 1);
+}
+
+void BoxInjection::apply(int tstep) {
+    int ichunk = tstep / mBufferSize;
+    if (ichunk != mChunk) {
+        readChunk(ichunk);
+    }
+    int istep = tstep % mBufferSize;
+    for (int ip = 0; ip < mPoints.size(); ip++) {
+        int ikey = mPointKeys[ip];
+        int norder = mKeyOrders[ikey];
+        const double *step = mBuffer.data() + mBufferSize * mKeyOffsets[ikey] +
+            istep * norder * 6;
+        CMatX3 &force = mForces[ip];
+        for (int alpha = 0; alpha < force.rows(); alpha++) {
+            for (int idim = 0; idim < 3; idim++) {
+                force(alpha, idim) = Complex((Real)step[alpha * 6 + idim * 2],
+                    (Real)step[alpha * 6 + idim * 2 + 1]);
+            }
+        }
+        // the element stiffness enters the points with a minus sign
+        mPoints[ip]->addToStiff(force, -mShares[ip]);
+    }
+}
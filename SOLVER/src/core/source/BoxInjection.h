@@ -0,0 +1,138 @@
+// BoxInjection.h
+// created by Kuangdai on 14-Oct-2026
+// wavefield injection on the boundary of a box, for regional studies
+// of a distant source
+// A record run computes the whole mesh, usually in 1D, and writes at every
+// step the stiffness that the elements outside the box contribute to the
+// points on its boundary. An inject run applies this stiffness as a force
+// on the boundary points instead of the source, and computes only the
+// elements inside the box, usually in 3D. Inside the box, the wavefield is
+// then that of the 3D model, excited by the incident wavefield of the 1D
+// model; waves scattered out of the box are reflected at its boundary.
+// The box is axisymmetric about the source, made of whole quads of the
+// mesh, and must have its boundary in the solid. Both runs must share the
+// mesh, nPol, the source time function and dt.
+
+#pragma once
+
+#include "eigenc.h"
+#include <array>
+#include <map>
+#include <fstream>
+
+class Element;
+class Point;
+
+class BoxInjection {
+public:
+    // record: files are written into directory, one per rank;
+    // inject: all files in directory are read
+    // bufferSize: number of steps written at once; on inject, 
+    // that of the record run
+    BoxInjection(bool record, const std::string &directory, int bufferSize);
+    ~BoxInjection();
+    
+    bool recording() const {return mRecord;};
+    
+    // record: an element outside the box, with its points on the boundary
+    // by index in the element and by global key
+    void addTap(Element *elem, const std::vector<int> &ipnts,
+        const std::vector<std::array<int, 3>> &keys);
+    
+    // inject: a point on the boundary, sharing its force with the
+    // other ranks that have it
+    void addPoint(Point *point, const std::array<int, 3> &key, Real share);
+    
+    // inject: an element outside the box, not computed
+    void addDormant(int elemTag);
+    bool dormant(int elemTag) const {
+        return elemTag < (int)mDormant.size() && mDormant[elemTag];
+    };
+    
+    // before time loop
+    // t0: time of the first step; restartStep: steps done by the run
+    // being restarted, 0 for a new run
+    void initialize(int totalSteps, double dt, double t0, int restartStep);
+    
+    // after time loop
+    void finalize();
+    
+    // record the stiffness of the taps after their computeStiff
+    void record(int tstep);
+    
+    // apply the recorded stiffness, in place of the source
+    void apply(int tstep);
+    
+    // numbers of taps or boundary points and of dormant elements
+    int getNumTaps() const {return mTaps.size();};
+    int getNumPoints() const {return mPoints.size();};
+    int getNumDormant() const;
+    
+    // bytes of the buffers, for memory reports
+    size_t memoryBytes() const {return mBuffer.size() * sizeof(double);};
+    
+private:
+    // write the buffer of chunk mChunk
+    void writeChunk();
+    // read the buffer of chunk ichunk
+    void readChunk(int ichunk);
+    
+    // file of a rank
+    std::string fileName(int rank) const;
+    
+    bool mRecord;
+    std::string mDirectory;
+    int mBufferSize;
+    
+    // keys of the boundary points on this rank, in the order of the files,
+    // with their numbers of orders and their first values in a step
+    std::map<std::array<int, 3>, int> mKeyIndex;
+    std::vector<std::array<int, 3>> mKeys;
+    std::vector<int> mKeyOrders;
+    std::vector<size_t> mKeyOffsets;
+    size_t mStepValues = 0;
+    int findOrAddKey(const std::array<int, 3> &key, int norder);
+    void formKeyOffsets();
+    
+    // record: elements and keys of their points
+    struct Tap {
+        Element *mElement;
+        std::vector<int> mKeys;
+    };
+    std::vector<Tap> mTaps;
+    
+    // inject: points, their keys and shares, and forces
+    std::vector<Point *> mPoints;
+    std::vector<int> mPointKeys;
+    std::vector<Real> mShares;
+    std::vector<CMatX3> mForces;
+    std::vector<bool> mDormant;
+    
+    // inject: recorded files with keys of this rank; for each, its keys 
+    // matched by index of this rank, first value in a chunk and orders
+    struct Match {
+        int mKey;
+        size_t mOffset;
+        int mOrders;
+    };
+    struct Source {
+        std::ifstream *mFile;
+        size_t mHeaderBytes;
+        size_t mChunkValues;
+        std::vector<Match> mMatches;
+    };
+    std::vector<Source> mSources;
+    // a key of a chunk as read from a file
+    std::vector<double> mScratch;
+    
+    // buffer of a chunk of steps, key-major: for each key, the
+    // steps of the chunk, each with its orders of real and imaginary
+    // parts of three components
+    std::vector<double> mBuffer;
+    int mChunk = -1;
+    
+    // record: file of this rank and steps recorded
+    std::ofstream *mOutFile = 0;
+    int mRecordedSteps = 0;
+};
+
@@ -0,0 +1,110 @@
+// FiniteFaultTerm.cpp
+// created by Kuangdai on 14-Oct-2026 
+// finite-fault source in the solver
+// Each subfault is a force on the points of its element, scaled by a source 
+// time function of its own, delayed by its rupture time. Subfaults sharing 
+// a source time function and a delay form a group, whose forces are combined 
+// per point when added, so that a time step costs one factor per group and 
+// one update per point of the groups active at that time.
+// An analytic stf is tabulated once in time normalized by its half duration 
+// and shared by all groups, each with its own time scale and amplitude.
+
+#include "FiniteFaultTerm.h"
+#include "SourceTimeFunction.h"
+#include "Domain.h"
+#include "Element.h"
+#include "Point.h"
+#include <climits>
+
+FiniteFaultTerm::~FiniteFaultTerm() {
+    for (const auto &stf: mSTFs) {
+        delete stf;
+    }
+}
+
+int FiniteFaultTerm::addSTF(SourceTimeFunction *stf) {
+    // nonzero range, relative to the peak
+    int nstep = stf->getSize();
+    Real peak = zero;
+    for (int i = 0; i < nstep; i++) {
+        peak = std::max(peak, std::abs(stf->getFactor(i)));
+    }
+    int first = nstep;
+    int last = -1;
+    for (int i = 0; i < nstep; i++) {
+        if (std::abs(stf->getFactor(i)) > (Real)1e-6 * peak) {
+            first = std::min(first, i);
+            last = i;
+        }
+    }
+    if (last == nstep - 1) {
+        last = INT_MAX;
+    }
+    mSTFs.push_back(stf);
+    mFirstSteps.push_back(first);
+    mLastSteps.push_back(last);
+    return mSTFs.size() - 1;
+}
+
+int FiniteFaultTerm::addGroup(int istf, double delay, double timeScale, Real amplitude) {
+    Group group;
+    group.mSTF = istf;
+    group.mDelay = delay;
+    group.mTimeScale = timeScale;
+    group.mAmplitude = amplitude;
+    mGroups.push_back(group);
+    mFactors.push_back(zero);
+    return mGroups.size() - 1;
+}
+
+void FiniteFaultTerm::addSubfault(const Domain &domain, const Element *element, 
+    const arPP_CMatX3 &force, int igroup) {
+    Group &group = mGroups[igroup];
+    for (int i = 0; i < nPntElem; i++) {
+        Point *point = domain.getPoint(element->getPoint(i)->getDomainTag());
+        // make the order consistent
+        int length = std::min(point->getNu() + 1, (int)force[i].rows());
+        auto it = group.mPointIndex.find(point);
+        if (it == group.mPointIndex.end()) {
+            it = group.mPointIndex.insert(std::make_pair(point, (int)group.mPoints.size())).first;
+            group.mPoints.push_back(point);
+            group.mForces.push_back(CMatX3::Zero(length, 3));
+        }
+        CMatX3 &combined = group.mForces[it->second];
+        int nrow = combined.rows();
+        if (nrow < length) {
+            combined.conservativeResize(length, 3);
+            combined.bottomRows(length - nrow).setZero();
+        }
+        combined.topRows(length) += force[i].topRows(length);
+    }
+    mNumSubfaults++;
+}
+
+void FiniteFaultTerm::apply(double t) const {
+    // factors of all groups, zero out of the nonzero ranges of their stfs
+    int ngroup = mGroups.size();
+    for (int ig = 0; ig < ngroup; ig++) {
+        const Group &group = mGroups[ig];
+        const SourceTimeFunction &stf = *(mSTFs[group.mSTF]);
+        double pos = ((t - group.mDelay) / group.mTimeScale + stf.getShift()) / stf.getDeltaT();
+        if (pos <= mFirstSteps[group.mSTF] - 1 || 
+            (mLastSteps[group.mSTF] < INT_MAX && pos >= mLastSteps[group.mSTF] + 1)) {
+            mFactors[ig] = zero;
+        } else {
+            // clamped to the ends of the stf
+            mFactors[ig] = group.mAmplitude * stf.getFactor(0, pos);
+        }
+    }
+    
+    // forces of active groups
+    for (int ig = 0; ig < ngroup; ig++) {
+        if (mFactors[ig] == zero) {
+            continue;
+        }
+        const Group &group = mGroups[ig];
+        for (int ip = 0; ip < group.mPoints.size(); ip++) {
+            group.mPoints[ip]->addToStiff(group.mForces[ip], mFactors[ig]);
+        }
+    }
+}
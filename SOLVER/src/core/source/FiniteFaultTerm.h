@@ -0,0 +1,67 @@
+// FiniteFaultTerm.h
+// created by Kuangdai on 14-Oct-2026 
+// finite-fault source in the solver
+// Each subfault is a force on the points of its element, scaled by a source 
+// time function of its own, delayed by its rupture time. Subfaults sharing 
+// a source time function and a delay form a group, whose forces are combined 
+// per point when added, so that a time step costs one factor per group and 
+// one update per point of the groups active at that time.
+// An analytic stf is tabulated once in time normalized by its half duration 
+// and shared by all groups, each with its own time scale and amplitude.
+
+#pragma once
+
+#include "eigenc.h"
+#include <map>
+
+class Domain;
+class Element;
+class Point;
+class SourceTimeFunction;
+
+class FiniteFaultTerm {
+public:
+    ~FiniteFaultTerm();
+    
+    // add a source time function, sampled from its own shift before origin
+    // return the index of the stf
+    int addSTF(SourceTimeFunction *stf);
+    
+    // add a group using stf istf, delayed by delay seconds after origin, 
+    // factor = amplitude * stf((t - delay) / timeScale)
+    // return the index of the group
+    int addGroup(int istf, double delay, double timeScale = 1., Real amplitude = one);
+    
+    // add the force of a subfault in element to group igroup
+    void addSubfault(const Domain &domain, const Element *element, 
+        const arPP_CMatX3 &force, int igroup);
+    
+    // apply all active groups at time t after origin
+    void apply(double t) const;
+    
+    int getNumSubfaults() const {return mNumSubfaults;};
+    int getNumGroups() const {return mGroups.size();};
+    
+private:
+    // source time functions and their ranges of nonzero steps, 
+    // the last being INT_MAX if it never decays, e.g., a Heaviside
+    std::vector<SourceTimeFunction *> mSTFs;
+    std::vector<int> mFirstSteps;
+    std::vector<int> mLastSteps;
+    
+    struct Group {
+        int mSTF;
+        double mDelay;
+        double mTimeScale;
+        Real mAmplitude;
+        // combined force on each point
+        std::vector<Point *> mPoints;
+        std::vector<CMatX3> mForces;
+        std::map<Point *, int> mPointIndex;
+    };
+    std::vector<Group> mGroups;
+    int mNumSubfaults = 0;
+    
+    // factor of each group at the current step
+    mutable std::vector<Real> mFactors;
+};
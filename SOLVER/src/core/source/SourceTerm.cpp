@@ -23,13 +23,9 @@ mElement(element) {
             mForce[i] = force[i];
         }
     }
-    mForceXSTF = mForce;
 }
 
 void SourceTerm::apply(Real stf) {
-    // using mForceXSTF avoids dynamic allocation
-    for (int i = 0; i < nPntElem; i++) {
-        mForceXSTF[i] = mForce[i] * stf;
-    }
-    mElement->addSourceTerm(mForceXSTF);
+    // scaled when added to the points, no copy of the force
+    mElement->addSourceTerm(mForce, stf);
 }
\ No newline at end of file
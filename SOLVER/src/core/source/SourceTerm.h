@@ -28,5 +28,4 @@ private:
     
     Element *mElement;
     arPP_CMatX3 mForce;
-    arPP_CMatX3 mForceXSTF;
 };
\ No newline at end of file
@@ -8,3 +8,20 @@ SourceTimeFunction::SourceTimeFunction(const std::vector<Real> &stf, double dt,
 mSTF(stf), mDeltaT(dt), mShift(shift) {
     // nothing
 }
+
+Real SourceTimeFunction::getFactor(int tstep, double frac) const {
+    if (frac == 0.) {
+        return mSTF[tstep];
+    }
+    double pos = tstep + frac;
+    int last = (int)mSTF.size() - 1;
+    if (pos <= 0.) {
+        return mSTF[0];
+    }
+    if (pos >= last) {
+        return mSTF[last];
+    }
+    int i0 = (int)pos;
+    Real w1 = (Real)(pos - i0);
+    return (one - w1) * mSTF[i0] + w1 * mSTF[i0 + 1];
+}
@@ -14,6 +14,8 @@ public:
     
     int getSize() const {return mSTF.size();};
     Real getFactor(int tstep) const {return mSTF[tstep];};
+    // linear interpolation at tstep + frac, used by stages between steps
+    Real getFactor(int tstep, double frac) const;
     double getDeltaT() const {return mDeltaT;};
     double getShift() const {return mShift;};
     
@@ -22,6 +22,15 @@ const double tinyDouble = 1e-10;
 typedef std::complex<Real>   Complex;
 typedef std::complex<double> ComplexD;
 
+// precision of Newmark state (displ and veloc) 
+// double in mixed-precision mode, otherwise same as solver
+#ifdef _USE_MIXED_PRECISION
+    typedef double RealN;
+#else
+    typedef Real RealN;
+#endif
+typedef std::complex<RealN>  ComplexN;
+
 // polynomial order
 #ifndef _NPOL
     #define _NPOL 4
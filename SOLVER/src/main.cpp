@@ -3,11 +3,53 @@
 // main 
 
 #include "axisem.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <unistd.h>
 
 extern "C" void set_ftz();
 
+// OPTION_NPOL in inparam.advanced, 0 if unset; read by every processor
+// before MPI, from the input directory located as in XMPI::initialize
+int requestedNPol(const std::string &execDirectory) {
+    std::ifstream fs(execDirectory + "/input/inparam.advanced");
+    std::string line;
+    while (getline(fs, line)) {
+        std::istringstream ss(line.substr(0, line.find("#")));
+        std::string key;
+        int npol = 0;
+        if (ss >> key && key == "OPTION_NPOL" && ss >> npol) {
+            return npol;
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     
+    // polynomial order selected in inparam: hand over to the solver built
+    // for it, axisem3d_np<N> in the same directory, by all processors
+    std::string argv0(argv[0]);
+    std::size_t found = argv0.find_last_of("/\\");
+    std::string execDirectory = (found == std::string::npos) ? "." : argv0.substr(0, found);
+    if (execDirectory.length() == 0) {
+        execDirectory = ".";
+    }
+    int npol = requestedNPol(execDirectory);
+    if (npol > 0 && npol != nPol) {
+        std::stringstream ss;
+        ss << execDirectory << "/axisem3d_np" << npol;
+        std::string exec = ss.str();
+        argv[0] = &exec[0];
+        execv(exec.c_str(), argv);
+        // only returns on failure
+        std::cerr << "main || OPTION_NPOL = " << npol << ", but this solver is built for nPol = "
+            << nPol << " and " << exec << " cannot be run; add " << npol
+            << " to NPOL_EXTRA in CMakeLists.txt and copy the executable here." << std::endl;
+        return 1;
+    }
+    
     // denormal float handling 
     set_ftz();
     
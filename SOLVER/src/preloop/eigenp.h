@@ -20,6 +20,9 @@ typedef Eigen::Matrix<double, 3, 3> RDMat33;
 typedef Eigen::Matrix<double, 3, 1> RDCol3;
 typedef Eigen::Matrix<double, Eigen::Dynamic, 3> RDMatX3;
 
+// elasticity tensor in Voigt notation
+typedef Eigen::Matrix<double, 6, 6> RDMat66;
+
 // elemental fields 
 typedef Eigen::Matrix<double, Eigen::Dynamic, 1> RDColX;
 typedef Eigen::Matrix<ComplexD, Eigen::Dynamic, 1> CDColX;
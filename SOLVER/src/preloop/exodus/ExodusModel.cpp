@@ -24,10 +24,72 @@
 #include "NetCDF_Reader.h"
 
 #include <algorithm>
+#include <fstream>
+#include <cstdio>
 #include <boost/lexical_cast.hpp>
 #include "XMath.h"
 
-ExodusModel::ExodusModel(const std::string &fileName): mExodusFileName(fileName) {
+namespace ExodusCache {
+    const int sMagic = 0x45584331;
+    // bump when the raw data or its processing in readRawData changes
+    const int sVersion = 1;
+    
+    // binary archive of the raw data, reading or writing
+    class Archive {
+    public:
+        Archive(const std::string &fname, bool write): mWrite(write) {
+            mFile.open(fname, std::ios::binary | (write ? std::ios::out : std::ios::in));
+        };
+        
+        bool good() const {return mFile.good();};
+        
+        void sync(void *data, size_t bytes) {
+            if (mWrite) {
+                mFile.write(static_cast<const char *>(data), bytes);
+            } else {
+                mFile.read(static_cast<char *>(data), bytes);
+            }
+        };
+        
+        template<typename T>
+        void syncValue(T &value) {
+            sync(&value, sizeof(T));
+        };
+        
+        template<typename TEigen>
+        void syncEigen(TEigen &mat) {
+            int dim[2] = {(int)mat.rows(), (int)mat.cols()};
+            sync(dim, sizeof(dim));
+            if (!mWrite && good()) {
+                mat = TEigen::Zero(dim[0], dim[1]);
+            }
+            sync(mat.data(), mat.size() * sizeof(typename TEigen::Scalar));
+        };
+        
+        void syncStrings(std::vector<std::string> &strs) {
+            int num = strs.size();
+            syncValue(num);
+            if (!mWrite && good()) {
+                strs.resize(num);
+            }
+            for (auto &str: strs) {
+                int len = str.size();
+                syncValue(len);
+                if (!mWrite && good()) {
+                    str.resize(len);
+                }
+                sync(&str[0], len);
+            }
+        };
+        
+    private:
+        bool mWrite;
+        std::fstream mFile;
+    };
+}
+
+ExodusModel::ExodusModel(const std::string &fileName, bool attenuation): 
+mExodusFileName(fileName), mAttenuation(attenuation) {
     std::vector<std::string> substrs = Parameters::splitString(mExodusFileName, "/");
     mExodusTitle = substrs[substrs.size() - 1];
     boost::trim_if(mExodusTitle, boost::is_any_of("\t "));
@@ -35,8 +97,9 @@ ExodusModel::ExodusModel(const std::string &fileName): mExodusFileName(fileName)
 
 void ExodusModel::initialize() {
     MultilevelTimer::begin("Read Exodus", 1);
-    if (XMPI::root()) {
+    if (XMPI::root() && !readCache()) {
         readRawData();
+        writeCache();
     }
     MultilevelTimer::end("Read Exodus", 1);
     
@@ -119,7 +182,13 @@ void ExodusModel::readRawData() {
         mEllipKnots = RDColX::Zero(0);
         mEllipCoeffs = RDColX::Zero(0);
         // set radius to PREM 
-        mGlobalVariables.insert(std::pair<std::string, double>("radius", 6371e3));
+        int iradius = std::find(mGlobalVariableNames.begin(), mGlobalVariableNames.end(), 
+            "radius") - mGlobalVariableNames.begin();
+        if (iradius == mGlobalVariableNames.size()) {
+            mGlobalVariableNames.push_back("radius");
+            mGlobalVariableValues.conservativeResize(iradius + 1);
+        }
+        mGlobalVariableValues(iradius) = 6371e3;
     } else {
         // ellipticity
         reader.read2D("ellipticity", dbuffer);
@@ -173,9 +242,13 @@ void ExodusModel::readRawData() {
         mElementalVariableCoords_axis(j) = coords[j];
     }
     
-    // names of axial variables
+    // names of axial variables, without Q for an elastic run
     for (int iname = 0; iname < mElementalVariableNames_all.size(); iname++) {
         std::string varName = mElementalVariableNames_all[iname];
+        if (!mAttenuation && (boost::starts_with(varName, "QMU") || 
+            boost::starts_with(varName, "QKAPPA"))) {
+            continue;
+        }
         if (varName.substr(varName.length() - 2, 1) == std::string("_")) {
             std::string vname = varName.substr(0, varName.length() - 2);
             std::string inode_str = varName.substr(varName.length() - 1, 1);
@@ -187,6 +260,16 @@ void ExodusModel::readRawData() {
         }
     }
     
+    // only the range of the axial quads is read
+    int quadFirst = getNumQuads();
+    int quadLast = -1;
+    for (int idep = 0; idep < quad_nodes.size(); idep++) {
+        quadFirst = std::min(quadFirst, quad_nodes[idep].first);
+        quadLast = std::max(quadLast, quad_nodes[idep].first);
+    }
+    int quadCount = std::max(quadLast - quadFirst + 1, 0);
+    quadFirst = std::min(quadFirst, quadLast + 1);
+    
     // elemental variables only on axis
     mElementalVariableValues_axis = RDMatXX::Zero(mElementalVariableCoords_axis.size(), 
         mElementalVariableNames_axis.size());
@@ -205,11 +288,11 @@ void ExodusModel::readRawData() {
                     mElementalVariableNames_all.begin() + 1;
                 ss.str("");
                 ss << "vals_elem_var" << index << "eb1";
-                reader.read1D(ss.str(), buffer[inode]);
+                reader.read1D(ss.str(), buffer[inode], quadFirst, quadCount);
             }
             for (int idep = 0; idep < coords.size(); idep++) {
                 mElementalVariableValues_axis(idep, iname) = 
-                    buffer[quad_nodes[idep].second](quad_nodes[idep].first);
+                    buffer[quad_nodes[idep].second](quad_nodes[idep].first - quadFirst);
             }
         } else {
             // nodal independent
@@ -219,10 +302,10 @@ void ExodusModel::readRawData() {
                 mElementalVariableNames_all.end(), varName) - 
                 mElementalVariableNames_all.begin() + 1;
             ss << "vals_elem_var" << index << "eb1";
-            reader.read1D(ss.str(), buffer);
+            reader.read1D(ss.str(), buffer, quadFirst, quadCount);
             for (int idep = 0; idep < coords.size(); idep++) {
                 mElementalVariableValues_axis(idep, iname) = 
-                    buffer(quad_nodes[idep].first);
+                    buffer(quad_nodes[idep].first - quadFirst);
             }
         }
     }            
@@ -246,6 +329,71 @@ void ExodusModel::readRawData() {
     reader.close();
 }
 
+bool ExodusModel::readCache() {
+    if (mCacheFile == "") {
+        return false;
+    }
+    ExodusCache::Archive ar(mCacheFile, false);
+    int magic = 0, version = 0;
+    ar.syncValue(magic);
+    ar.syncValue(version);
+    if (!ar.good() || magic != ExodusCache::sMagic || version != ExodusCache::sVersion) {
+        return false;
+    }
+    syncRawData(ar);
+    if (!ar.good()) {
+        // partially read; start over from the Exodus file
+        std::string cacheFile = mCacheFile;
+        *this = ExodusModel(mExodusFileName, mAttenuation);
+        mCacheFile = cacheFile;
+        return false;
+    }
+    return true;
+}
+
+void ExodusModel::writeCache() {
+    if (mCacheFile == "") {
+        return;
+    }
+    // write to a temporary file and rename, so that an interrupted 
+    // write never leaves a partial cache
+    std::string ftemp = mCacheFile + ".tmp";
+    {
+        ExodusCache::Archive ar(ftemp, true);
+        int magic = ExodusCache::sMagic, version = ExodusCache::sVersion;
+        ar.syncValue(magic);
+        ar.syncValue(version);
+        syncRawData(ar);
+    }
+    std::rename(ftemp.c_str(), mCacheFile.c_str());
+}
+
+template<class Archive>
+void ExodusModel::syncRawData(Archive &ar) {
+    // same content as bcastRawData
+    ar.syncStrings(mGlobalVariableNames);
+    ar.syncEigen(mGlobalVariableValues);
+    ar.syncStrings(mGlobalRecordsRaw);
+    
+    ar.syncEigen(mConnectivity);
+    ar.syncEigen(mNodalS);
+    ar.syncEigen(mNodalZ);
+    ar.syncValue(mDistTolerance);
+    
+    ar.syncStrings(mElementalVariableNames_all);
+    ar.syncStrings(mElementalVariableNames_elem);
+    ar.syncStrings(mElementalVariableNames_axis);
+    ar.syncEigen(mElementalVariableValues_elem);
+    ar.syncEigen(mElementalVariableValues_axis);
+    ar.syncEigen(mElementalVariableCoords_axis);
+    
+    ar.syncStrings(mSideSetNames);
+    ar.syncEigen(mSideSetValues);
+    
+    ar.syncEigen(mEllipKnots);
+    ar.syncEigen(mEllipCoeffs);
+}
+
 void ExodusModel::bcastRawData() {
     // 
     // XMPI::cout << XMath::eigenMemoryInfo("mGlobalVariableValues", mGlobalVariableValues) << XMPI::endl;
@@ -523,7 +671,14 @@ void ExodusModel::buildInparam(ExodusModel *&exModel, const Parameters &par,
     }
     std::string exfile = par.getValue<std::string>("MODEL_1D_EXODUS_MESH_FILE");
     exfile = Parameters::sInputDirectory + "/" + exfile;
-    exModel = new ExodusModel(exfile);
+    exModel = new ExodusModel(exfile, par.getValue<bool>("ATTENUATION"));
+    if (par.getValue<bool>("OPTION_CACHE_EXODUS") && XMPI::root()) {
+        // keyed by the content of the Exodus file
+        std::stringstream fname;
+        fname << Parameters::sOutputDirectory << "/cache/exodus_" << std::hex 
+            << XMath::hashFile(exfile) << "_" << (int)exModel->mAttenuation << ".bin";
+        exModel->mCacheFile = fname.str();
+    }
     exModel->initialize();
     if (verbose) {
         XMPI::cout << exModel->verbose();
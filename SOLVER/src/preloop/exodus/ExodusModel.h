@@ -18,12 +18,15 @@ class AttParameters;
 class ExodusModel {
     
 public:
-    ExodusModel(const std::string &fileName);
+    // attenuation: read the Q variables of an anelastic model
+    ExodusModel(const std::string &fileName, bool attenuation = true);
     void initialize();
     
     // general
     bool isIsotropic() const;
-    bool hasAttenuation() const {return mGlobalVariables.find("nr_lin_solids") != mGlobalVariables.end();};
+    bool hasAttenuation() const {
+        return mAttenuation && mGlobalVariables.find("nr_lin_solids") != mGlobalVariables.end();
+    };
     int getNumQuads() const {return mConnectivity.rows();};
     int getNumNodes() const {return mNodalS.rows();};
     double getROuter() const {return mGlobalVariables.at("radius");};
@@ -61,11 +64,18 @@ private:
     
     void readRawData();
     void bcastRawData();
+    // binary cache of the raw data, on root
+    bool readCache();
+    void writeCache();
+    template<class Archive>
+    void syncRawData(Archive &ar);
     void formStructured();
     void formAuxiliary();
     
     // file name
     std::string mExodusFileName;
+    bool mAttenuation;
+    std::string mCacheFile = "";
 
     // file properties
     std::string mExodusTitle;
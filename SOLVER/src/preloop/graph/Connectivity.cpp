@@ -7,6 +7,7 @@
 #include "XMPI.h"
 #include <algorithm>
 #include <map>
+#include <fstream>
 
 #include "MultilevelTimer.h"
 
@@ -39,159 +40,155 @@ Connectivity::Connectivity(const Connectivity &super, const IColX &mask) {
     }
 }
 
-void Connectivity::formElemToGLL(int &ngll, std::vector<IMatPP> &elemToGLL, 
-    std::vector<IColX> &neighbours, int ncommon) const {
-    // form static
-    if (sNodeIJPol[0].size() == 0) {
-        formNodeEdge();
+void Connectivity::formElemToGLL(const std::vector<int> &elems, 
+    int &ngll, std::vector<IMatPP> &elemToGLL) const {
+    // sorted tables of the nodes and edges of the elements, built once;
+    // an edge is stored as (smaller node, larger node)
+    int nloc = elems.size();
+    std::vector<int> nodes;
+    std::vector<std::pair<int, int>> edges;
+    nodes.reserve(nloc * 4);
+    edges.reserve(nloc * 4);
+    for (int iloc = 0; iloc < nloc; iloc++) {
+        const IRow4 &nodesElem = mConnectivity.row(elems[iloc]);
+        for (int i = 0; i < 4; i++) {
+            int node0 = nodesElem(i);
+            int node1 = nodesElem((i + 1) % 4);
+            nodes.push_back(node0);
+            edges.push_back(std::make_pair(std::min(node0, node1), std::max(node0, node1)));
+        }
     }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
     
-    // get neighbours from metis
-    DualGraph::formNeighbourhood(mConnectivity, ncommon, neighbours);
-
-    // build local to global mapping
+    // points on nodes and edges are shared by their table entries;
+    // a point is labelled by the first element that has it 
     ngll = 0;
-    int nelem = size();
-    elemToGLL = std::vector<IMatPP>(nelem, IMatPP::Constant(-1));
-
-    // loop over all elements
-    for (int ielem = 0; ielem < nelem; ielem++) {
-
-        // the mask will be True for all points, that are not shared with an
-        // element with lower element id
-        IMatPP mask = IMatPP::Ones();
-
-        // loop over all neighbouring elements with smaller element id
-        for (int in = 0; in < neighbours[ielem].rows(); in++) {
-            int ineighbour = neighbours[ielem](in);
-            if (ineighbour >= ielem) {
-                continue;
-            }
-            
-            // get ipol and jpol of shared points in both elements
-            std::vector<IRow2> map1, map2;
-            get_shared_DOF_quad(mConnectivity.row(ineighbour), mConnectivity.row(ielem), 
-                map1, map2, ielem);
-            
-            // for global points that already have a number, get the global
-            // number from the other element
-            for (int i = 0; i < map2.size(); i++) {
-                mask(map2[i](0), map2[i](1)) = 0;
-                elemToGLL[ielem](map2[i](0), map2[i](1)) = 
-                    elemToGLL[ineighbour](map1[i](0), map1[i](1));
-            }
+    elemToGLL = std::vector<IMatPP>(nloc, IMatPP::Constant(-1));
+    std::vector<int> nodeGLL(nodes.size(), -1);
+    std::vector<int> edgeGLL(edges.size() * (nPol - 1), -1);
+    for (int iloc = 0; iloc < nloc; iloc++) {
+        const IRow4 &nodesElem = mConnectivity.row(elems[iloc]);
+        std::array<int, 4> inode, iedge;
+        for (int i = 0; i < 4; i++) {
+            int node0 = nodesElem(i);
+            int node1 = nodesElem((i + 1) % 4);
+            inode[i] = std::lower_bound(nodes.begin(), nodes.end(), node0) - nodes.begin();
+            iedge[i] = std::lower_bound(edges.begin(), edges.end(), 
+                std::make_pair(std::min(node0, node1), std::max(node0, node1))) - edges.begin();
         }
-
-        // compute number of new global points in this element and label them
         for (int ipol = 0; ipol <= nPol; ipol++) {
             for (int jpol = 0; jpol <= nPol; jpol++) {
-                if (mask(ipol, jpol)) {
-                    elemToGLL[ielem](ipol, jpol) = ngll++;
+                if (!onEdge(ipol, jpol)) {
+                    elemToGLL[iloc](ipol, jpol) = ngll++;
+                    continue;
+                }
+                const std::array<int, 3> &key = edgeKey(nodesElem, ipol, jpol);
+                int *tag = 0;
+                for (int i = 0; i < 4; i++) {
+                    if (key[1] < 0 && nodesElem(i) == key[0]) {
+                        tag = &nodeGLL[inode[i]];
+                        break;
+                    }
+                    if (key[1] >= 0 && edges[iedge[i]].first == key[0] && 
+                        edges[iedge[i]].second == key[1]) {
+                        tag = &edgeGLL[iedge[i] * (nPol - 1) + key[2] - 1];
+                        break;
+                    }
                 }
+                if (*tag < 0) {
+                    *tag = ngll++;
+                }
+                elemToGLL[iloc](ipol, jpol) = *tag;
             }
-        }        
+        }
     }
 }
 
 void Connectivity::decompose(const DecomposeOption &option, 
     int &nGllLocal, std::vector<IMatPP> &elemToGllLocal, 
     MessagingInfo &msgInfo, IColX &procMask) const {
+    // form static
+    if (sNodeIJPol[0].size() == 0) {
+        formNodeEdge();
+    }
+    
     // domain decomposition
     MultilevelTimer::begin("Metis Partition", 3);
     IColX elemToProc;
     DualGraph::decompose(mConnectivity, option, elemToProc);
     MultilevelTimer::end("Metis Partition", 3);
     
-    // global element-gll mapping
-    // neighbourhood with ncommon = 1 (NOT 2)
+    // neighbours of the local elements, with ncommon = 1 (NOT 2)
     // NOTE: Though we decompose with ncommon = 2, metis may still (but rarely) yields 
     //       a decomposition where two processors only share one single point. 
     //       This could happen when a large nproc is used on a relatively small mesh.
-    MultilevelTimer::begin("Global Element-Gll", 3);
+    // Only the local elements and their halo are visited; no global 
+    // element-gll mapping is formed on any rank.
+    MultilevelTimer::begin("Local Neighbourhood", 3);
     int nElemGlobal = size();
-    int nGllGlobal = 0;
-    std::vector<IMatPP> elemToGllGlobal;
-    std::vector<IColX> neighboursGlobal;
-    formElemToGLL(nGllGlobal, elemToGllGlobal, neighboursGlobal, 1);
-    MultilevelTimer::end("Global Element-Gll", 3);
+    std::vector<int> elemsLocal;
+    std::vector<std::vector<int>> neighbours;
+    formLocalNeighbours(elemToProc, elemsLocal, neighbours);
+    MultilevelTimer::end("Local Neighbourhood", 3);
+    
+    // rank placement
+    if (option.mReorderRanks) {
+        MultilevelTimer::begin("Rank Placement", 3);
+        placeRanks(option, elemsLocal, neighbours, elemToProc);
+        formLocalNeighbours(elemToProc, elemsLocal, neighbours);
+        MultilevelTimer::end("Rank Placement", 3);
+    }
     
-    // map of to-be-communicated global gll points 
+    // map of to-be-communicated points
     MultilevelTimer::begin("To-be-communicated Global", 3);
     // key: proc_id
-    // value: map<global_gll, array_of_3(elem_id, ipol, jpol)>
-    std::map<int, std::map<int, std::array<int, 3>>> gllCommGlb;
-    for (int ielem = 0; ielem < nElemGlobal; ielem++) {
-        if (elemToProc(ielem) != XMPI::rank()) {
-            continue;
-        }
-        for (int in = 0; in < neighboursGlobal[ielem].rows(); in++) {
-            int ineighbour = neighboursGlobal[ielem](in);
+    // value: map<point_key, array_of_3(elem_id, ipol, jpol)>
+    // NOTE: points are keyed by the mesh nodes they lie on, so that both 
+    //       sides of a boundary sort them by the same rule
+    std::map<int, std::map<std::array<int, 3>, std::array<int, 3>>> gllCommGlb;
+    for (int iloc = 0; iloc < elemsLocal.size(); iloc++) {
+        int ielem = elemsLocal[iloc];
+        for (int ineighbour: neighbours[iloc]) {
             // within the same proc
-            if (elemToProc(ineighbour) == XMPI::rank()) {
-                continue;
-            }
-            // add proc 
             int rankOther = elemToProc(ineighbour);
-            gllCommGlb.insert(std::pair<int, std::map<int, std::array<int, 3>>>
-                (rankOther, std::map<int, std::array<int, 3>>()));
-                
-            // create temp vector of neighbour gll's for fast search
-            std::vector<int> gllOther;
-            for (int ipol = 0; ipol <= nPol; ipol++) {
-                for (int jpol = 0; jpol <= nPol; jpol++) {
-                    if (onEdge(ipol, jpol)) {
-                        gllOther.push_back(elemToGllGlobal[ineighbour](ipol, jpol));
-                    }
-                }
-            }
-                
-            // find common gll
-            int nfound = 0;
-            for (int ipol = 0; ipol <= nPol; ipol++) {
-                for (int jpol = 0; jpol <= nPol; jpol++) {
-                    if (!onEdge(ipol, jpol)) {
-                        continue;
-                    }
-                    int targetGll = elemToGllGlobal[ielem](ipol, jpol);
-                    if (std::find(gllOther.begin(), gllOther.end(), targetGll) != gllOther.end()) {
-                        std::array<int, 3> ielem_ipol_jpol;
-                        ielem_ipol_jpol[0] = ielem;
-                        ielem_ipol_jpol[1] = ipol;
-                        ielem_ipol_jpol[2] = jpol;
-                        // NOTE: the components are inherently sorted by global gll-point tags
-                        //       we do not care how they are sorted by std::map since all processors
-                        //       should use the same sorting rule 
-                        gllCommGlb.at(rankOther).insert(std::pair<int, std::array<int, 3>>
-                            (targetGll, ielem_ipol_jpol));
-                        nfound++;
-                    }
-                }
+            if (rankOther == XMPI::rank()) {
+                continue;
             }
+            
             // either a common edge or a common point
-            if (nfound != nPntEdge && nfound != 1) {
-                throw std::runtime_error("Connectivity::decompose || Domain decomposition failed.");
+            int ncommon = 0;
+            int index = -1;
+            int indexOther = -1;
+            common_nodes(mConnectivity.row(ielem), mConnectivity.row(ineighbour), 
+                ncommon, index, indexOther);
+            const std::vector<IRow2> &ijpol = 
+                (ncommon == 1) ? sNodeIJPol[index] : sEdgeIJPol[index];
+            for (int i = 0; i < ijpol.size(); i++) {
+                std::array<int, 3> ielem_ipol_jpol;
+                ielem_ipol_jpol[0] = ielem;
+                ielem_ipol_jpol[1] = ijpol[i](0);
+                ielem_ipol_jpol[2] = ijpol[i](1);
+                gllCommGlb[rankOther].insert(std::make_pair(
+                    pointKey(mConnectivity.row(ielem), ncommon, index, i), ielem_ipol_jpol));
             }
         }
     }
     MultilevelTimer::end("To-be-communicated Global", 3);
     
-    // global-to-local element map and local mask
+    // local mask
     MultilevelTimer::begin("Global-to-local Element", 3);
-    IColX elemGlbToLoc = IColX::Constant(nElemGlobal, -1);
     procMask = IColX::Zero(nElemGlobal);
-    int nElemLocal = 0;
-    for (int ielem = 0; ielem < nElemGlobal; ielem++) {
-        if (elemToProc(ielem) == XMPI::rank()) {
-            elemGlbToLoc(ielem) = nElemLocal++;
-            procMask(ielem) = 1;
-        }
-    } 
+    for (int ielem: elemsLocal) {
+        procMask(ielem) = 1;
+    }
     MultilevelTimer::end("Global-to-local Element", 3);
     
     // local element-gll mapping
     MultilevelTimer::begin("Local Element-Gll", 3);
-    std::vector<IColX> neighboursLocal;
-    Connectivity(*this, procMask).formElemToGLL(nGllLocal, elemToGllLocal, neighboursLocal, 1);
+    formElemToGLL(elemsLocal, nGllLocal, elemToGllLocal);
     MultilevelTimer::end("Local Element-Gll", 3);
     
     // form local messaging
@@ -207,7 +204,9 @@ void Connectivity::decompose(const DecomposeOption &option,
             int ielem_glb = ielem_ipol_jpol[0];
             int ipol = ielem_ipol_jpol[1];
             int jpol = ielem_ipol_jpol[2];
-            int ielem_loc = elemGlbToLoc(ielem_glb);
+            // local elements are sorted by global tag
+            int ielem_loc = std::lower_bound(elemsLocal.begin(), elemsLocal.end(), 
+                ielem_glb) - elemsLocal.begin();
             gll_loc.push_back(elemToGllLocal[ielem_loc](ipol, jpol));
         }
         msgInfo.mNLocalPoints.push_back(gll_loc.size());
@@ -220,23 +219,124 @@ void Connectivity::decompose(const DecomposeOption &option,
     MultilevelTimer::end("Local Messaging", 3);
 }
 
-void Connectivity::get_shared_DOF_quad(const IRow4 &connectivity1, const IRow4 &connectivity2, 
-    std::vector<IRow2> &map1, std::vector<IRow2> &map2, int ielem) {
-    int ncommon = 0;
-    int index1 = -1;
-    int index2 = -1;
-    common_nodes(connectivity1, connectivity2, ncommon, index1, index2);
+void Connectivity::formLocalNeighbours(const IColX &elemToProc, std::vector<int> &elems, 
+    std::vector<std::vector<int>> &neighbours) const {
+    // local elements
+    int nelem = size();
+    elems.clear();
+    for (int ielem = 0; ielem < nelem; ielem++) {
+        if (elemToProc(ielem) == XMPI::rank()) {
+            elems.push_back(ielem);
+        }
+    }
     
+    // elements sharing at least one node, from the node-to-element 
+    // incidence already formed for the decomposition
+    DualGraph::formNeighbours(mConnectivity, elems, 1, neighbours);
+}
+
+std::array<int, 3> Connectivity::pointKey(const IRow4 &nodes, int ncommon, int index, int i) {
+    std::array<int, 3> key;
+    key[1] = -1;
+    key[2] = 0;
     if (ncommon == 1) {
-        // a single common point
-        map1 = sNodeIJPol[index1];
-        map2 = sNodeIJPol[index2];
-    } else { 
-        // a common edge
-        map1 = sEdgeIJPol[index1];
-        map2 = sEdgeIJPol[index2];
-        std::reverse(map2.begin(), map2.end());
-    }    
+        // a mesh node
+        key[0] = nodes(index);
+        return key;
+    }
+    // i-th point of an edge, counted from its node of the smaller tag
+    int node0 = nodes(index);
+    int node1 = nodes((index + 1) % 4);
+    int k = (node0 < node1) ? i : nPol - i;
+    if (k == 0 || k == nPol) {
+        key[0] = (k == 0) ? std::min(node0, node1) : std::max(node0, node1);
+        return key;
+    }
+    key[0] = std::min(node0, node1);
+    key[1] = std::max(node0, node1);
+    key[2] = k;
+    return key;
+}
+
+void Connectivity::placeRanks(const DecomposeOption &option, const std::vector<int> &elems,
+    const std::vector<std::vector<int>> &neighbours, IColX &elemToProc) {
+    int nproc = XMPI::nproc();
+    int rank = XMPI::rank();
+    std::vector<int> partitionOfRank;
+    
+    // the placement of the run being restarted
+    if (option.mPlacementRestart) {
+        if (XMPI::root()) {
+            std::ifstream fs(option.mPlacementFile);
+            int part;
+            while (fs >> part) {
+                partitionOfRank.push_back(part);
+            }
+            fs.close();
+        }
+        XMPI::bcast(partitionOfRank);
+        if (partitionOfRank.size() != nproc) {
+            throw std::runtime_error("Connectivity::placeRanks || "
+                "Error reading rank placement for restart: || " + option.mPlacementFile);
+        }
+    } else {
+        // halo of the partition of this rank, in values exchanged per step
+        bool wcomm = option.mCommWeights.size() == elemToProc.size();
+        std::map<int, double> halo;
+        for (int iloc = 0; iloc < elems.size(); iloc++) {
+            int ielem = elems[iloc];
+            for (int ineighbour: neighbours[iloc]) {
+                int rankOther = elemToProc(ineighbour);
+                if (rankOther != rank) {
+                    halo[rankOther] += wcomm ? std::min(option.mCommWeights(ielem),
+                        option.mCommWeights(ineighbour)) : 1.;
+                }
+            }
+        }
+        std::vector<int> ranks, weights;
+        for (auto it = halo.begin(); it != halo.end(); it++) {
+            ranks.push_back(it->first);
+            weights.push_back(std::max(1, (int)std::min(it->second, 1e9)));
+        }
+        
+        // MPI places the graph nodes on the hardware
+        int part = XMPI::graphReorder(ranks, weights);
+        XMPI::gather(part, partitionOfRank, true);
+        if (!option.mPlacementFile.empty() && XMPI::root()) {
+            std::ofstream fs(option.mPlacementFile);
+            for (int iproc = 0; iproc < nproc; iproc++) {
+                fs << partitionOfRank[iproc] << std::endl;
+            }
+            fs.close();
+        }
+    }
+    
+    // ranks to own the partitions
+    std::vector<int> rankOfPartition(nproc, -1);
+    for (int iproc = 0; iproc < nproc; iproc++) {
+        int part = partitionOfRank[iproc];
+        if (part < 0 || part >= nproc || rankOfPartition[part] >= 0) {
+            throw std::runtime_error("Connectivity::placeRanks || "
+                "Rank placement is not a permutation.");
+        }
+        rankOfPartition[part] = iproc;
+    }
+    for (int ielem = 0; ielem < elemToProc.size(); ielem++) {
+        elemToProc(ielem) = rankOfPartition[elemToProc(ielem)];
+    }
+}
+
+std::array<int, 3> Connectivity::edgeKey(const IRow4 &nodes, int ipol, int jpol) {
+    // edges run from node i to node i + 1, as in sEdgeIJPol
+    if (jpol == 0) {
+        return pointKey(nodes, 2, 0, ipol);
+    } else if (ipol == nPol) {
+        return pointKey(nodes, 2, 1, jpol);
+    } else if (jpol == nPol) {
+        return pointKey(nodes, 2, 2, nPol - ipol);
+    } else {
+        return pointKey(nodes, 2, 3, nPol - jpol);
+    }
 }
 
 void Connectivity::common_nodes(const IRow4 &a, const IRow4 &b, 
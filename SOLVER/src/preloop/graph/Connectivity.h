@@ -26,16 +26,26 @@ public:
         int &nlocalGLL, std::vector<IMatPP> &localElemToGLL, 
         MessagingInfo &msgInfo, IColX &procMask) const;
     
+    // global key of a point on the edges of an element
+    static std::array<int, 3> edgeKey(const IRow4 &nodes, int ipol, int jpol);
+    
 private:
     IColX mGlobalQuadID;
     IMatX4 mConnectivity;
     
 private:
-    // form element-to-gll mapping 
-    void formElemToGLL(int &ngll, std::vector<IMatPP> &elemToGLL, 
-        std::vector<IColX> &neighbours, int ncommon) const;
-    static void get_shared_DOF_quad(const IRow4 &connectivity1, const IRow4 &connectivity2, 
-        std::vector<IRow2> &map1, std::vector<IRow2> &map2, int ielem);
+    // form element-to-gll mapping of a subset of elements 
+    void formElemToGLL(const std::vector<int> &elems, 
+        int &ngll, std::vector<IMatPP> &elemToGLL) const;
+    // elements of this rank and their neighbours sharing a point,
+    // without forming the global dual graph
+    void formLocalNeighbours(const IColX &elemToProc, std::vector<int> &elems, 
+        std::vector<std::vector<int>> &neighbours) const;
+    // global key of the i-th point of a common node or edge of an element
+    static std::array<int, 3> pointKey(const IRow4 &nodes, int ncommon, int index, int i);
+    // relabel partitions such that heavily communicating ones share a node
+    static void placeRanks(const DecomposeOption &option, const std::vector<int> &elems,
+        const std::vector<std::vector<int>> &neighbours, IColX &elemToProc);
     static void common_nodes(const IRow4 &a, const IRow4 &b, 
         int &ncommon, int &aindex, int &bindex);
     static void formNodeEdge();
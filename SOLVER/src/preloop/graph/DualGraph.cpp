@@ -5,31 +5,64 @@
 #include "DualGraph.h"
 #include "XMPI.h"
 #include <metis.h>
+#ifdef _USE_PARMETIS
+    #include <parmetis.h>
+#endif
 #include <algorithm>
 #include <limits>
 #include <numeric>
+#include <cmath>
+
+IMatX4 DualGraph::sConnectivity = IMatX4::Zero(0, 4);
+int DualGraph::sNodeMin = 0;
+std::vector<int> DualGraph::sNodePtr;
+std::vector<int> DualGraph::sNodeElems;
+std::vector<int> DualGraph::sXadj;
+std::vector<int> DualGraph::sAdjncy;
 
 void DualGraph::formNeighbourhood(const IMatX4 &connectivity, int ncommon, 
     std::vector<IColX> &neighbours) {
-    // form graph
-    int *xadj, *adjncy;
-    formAdjacency(connectivity, ncommon, xadj, adjncy);
-    
-    // convert CRS format to neighbours
+    // all elements
     int nelem = connectivity.rows();
+    std::vector<int> elems(nelem);
+    std::iota(elems.begin(), elems.end(), 0);
+    std::vector<std::vector<int>> neighbs;
+    formNeighbours(connectivity, elems, ncommon, neighbs);
+    
+    // convert to neighbours
     neighbours.clear();
     neighbours.reserve(nelem);
     for (int i = 0; i < nelem; i++) {
-        int nNeighb = xadj[i + 1] - xadj[i];
-        IColX neighb(nNeighb);
-        for (int j = 0; j < nNeighb; j++) {
-            neighb(j) = adjncy[xadj[i] + j];
+        neighbours.push_back(Eigen::Map<IColX>(neighbs[i].data(), neighbs[i].size()));
+    }
+}
+
+void DualGraph::formNeighbours(const IMatX4 &connectivity, const std::vector<int> &elems, 
+    int ncommon, std::vector<std::vector<int>> &neighbours) {
+    formIncidence(connectivity);
+    int nelem = elems.size();
+    neighbours = std::vector<std::vector<int>>(nelem);
+    #ifdef _USE_OPENMP
+        #pragma omp parallel
+    #endif
+    {
+        std::vector<int> buffer;
+        #ifdef _USE_OPENMP
+            #pragma omp for schedule(static)
+        #endif
+        for (int i = 0; i < nelem; i++) {
+            int nn = elemNeighbours(elems[i], ncommon, buffer);
+            neighbours[i].assign(buffer.begin(), buffer.begin() + nn);
         }
-        neighbours.push_back(neighb);
     }
+}
 
-    // delete graph 
-    freeAdjacency(xadj, adjncy);
+void DualGraph::freeCache() {
+    sConnectivity = IMatX4::Zero(0, 4);
+    std::vector<int>().swap(sNodePtr);
+    std::vector<int>().swap(sNodeElems);
+    std::vector<int>().swap(sXadj);
+    std::vector<int>().swap(sAdjncy);
 }
 
 void DualGraph::decompose(const IMatX4 &connectivity, const DecomposeOption &option, 
@@ -42,48 +75,45 @@ void DualGraph::decompose(const IMatX4 &connectivity, const DecomposeOption &opt
         return;
     }
     
+    // check size of weights
+    bool welem = option.mElemWeights.size() > 0;
+    if (welem && option.mElemWeights.size() != nelem) {
+        throw std::runtime_error("DualGraph::decompose || "
+            "Incompatible size of element weights.");
+    }
+    bool wcomm = option.mCommWeights.size() > 0;
+    if (wcomm && option.mCommWeights.size() != nelem) {
+        throw std::runtime_error("DualGraph::decompose || "
+            "Incompatible size of communication weights.");
+    }
+    
+    // node layout
+    std::vector<std::vector<int>> ranksOfNode;
+    if (option.mHierarchical) {
+        XMPI::nodeRanks(ranksOfNode);
+    }
+    if (ranksOfNode.size() > 1 && ranksOfNode.size() < nproc) {
+        decomposeHierarchical(connectivity, option, ranksOfNode, elemToProc);
+        return;
+    }
+    
+    #ifdef _USE_PARMETIS
+        decomposeParallel(connectivity, option, elemToProc);
+        return;
+    #endif
+    
     int objval = std::numeric_limits<int>::max();
     if (XMPI::rank() % option.mProcInterval == 0) {
         // form graph
         int *xadj, *adjncy;
-        formAdjacency(connectivity, 2, xadj, adjncy);
-        
-        // check size of weights
-        bool welem = option.mElemWeights.size() > 0;
-        if (welem && option.mElemWeights.size() != nelem) {
-            throw std::runtime_error("DualGraph::decompose || "
-                "Incompatible size of element weights.");
-        }
-        
-        // metis options
-        int metis_option[METIS_NOPTIONS];
-        metisError(METIS_SetDefaultOptions(metis_option), "METIS_SetDefaultOptions");
-        metis_option[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
-        metis_option[METIS_OPTION_CONTIG] = 1;
-        metis_option[METIS_OPTION_NCUTS] = option.mNCutsPerProc;
-        metis_option[METIS_OPTION_SEED] = XMPI::rank(); // generate different partitions
-        
-        // prepare input
-        int ncon = 1;
-        float ubvec = (float)(1. + option.mImbalance);
-        int *vwgt = NULL;
-        IColX elemWeightsInt;
-        double imax = std::numeric_limits<int>::max() * .9;
-        double sum = 0.;
-        if (welem) {
-            sum += option.mElemWeights.sum();
-            elemWeightsInt = (option.mElemWeights / sum * imax).array().round().matrix().cast<int>();
-            vwgt = elemWeightsInt.data();
-        }
+        formAdjacency(connectivity, xadj, adjncy);
+        IColX vwgt;
+        std::vector<int> adjwgt;
+        formWeights(option, nelem, xadj, adjncy, vwgt, adjwgt);
         
         // run
-        metisError(METIS_PartGraphKway(&nelem, &ncon, xadj, adjncy, 
-            vwgt, NULL, NULL, &nproc, NULL, &ubvec, 
-            metis_option, &objval, elemToProc.data()), 
-            "METIS_PartGraphKway");
-         
-        // free memory 
-        freeAdjacency(xadj, adjncy);
+        partition(nelem, xadj, adjncy, vwgt, adjwgt, nproc, std::vector<float>(), 
+            option, XMPI::rank(), elemToProc, objval);
     }
     
     // find best result
@@ -93,39 +123,323 @@ void DualGraph::decompose(const IMatX4 &connectivity, const DecomposeOption &opt
     XMPI::bcastEigen(elemToProc, proc_min);
 }
 
-void DualGraph::formAdjacency(const IMatX4 &connectivity, int ncommon, int *&xadj, int *&adjncy) {
-    DualGraph::check_idx_t();
-    
-    // get unique node list
+void DualGraph::decomposeHierarchical(const IMatX4 &connectivity, const DecomposeOption &option, 
+    const std::vector<std::vector<int>> &ranksOfNode, IColX &elemToProc) {
     int nelem = connectivity.rows();
-    std::vector<int> nodes(connectivity.data(), connectivity.data() + nelem * 4);
-    std::sort(nodes.begin(), nodes.end());
-    auto itu = std::unique(nodes.begin(), nodes.end());
-    int nnode = std::distance(nodes.begin(), itu);
+    int nproc = XMPI::nproc();
+    int nnode = ranksOfNode.size();
+    int *xadj, *adjncy;
+    formAdjacency(connectivity, xadj, adjncy);
+    IColX vwgt;
+    std::vector<int> adjwgt;
+    formWeights(option, nelem, xadj, adjncy, vwgt, adjwgt);
     
-    // convert connectivity to CSR format
-    IColX eptr = IColX(nelem + 1);
-    for (int i = 0; i < nelem + 1; i++) {
-        eptr(i) = i * 4;
+    // level 1: elements to nodes, sized by ranks per node
+    std::vector<float> tpwgts;
+    for (int inode = 0; inode < nnode; inode++) {
+        tpwgts.push_back((float)ranksOfNode[inode].size() / nproc);
     }
-    IColX eind = IColX(nelem * 4);
-    for (int i = 0; i < nelem; i++) {
-        for (int j = 0; j < 4; j++) {
-            eind(i * 4 + j) = std::distance(nodes.begin(), 
-                std::lower_bound(nodes.begin(), itu, connectivity(i, j)));
+    IColX elemToNode = IColX::Zero(nelem);
+    int objval = std::numeric_limits<int>::max();
+    if (XMPI::rank() % option.mProcInterval == 0) {
+        partition(nelem, xadj, adjncy, vwgt, adjwgt, nnode, tpwgts, 
+            option, XMPI::rank(), elemToNode, objval);
+    }
+    std::vector<int> objall;
+    XMPI::gather(objval, objall, true);
+    int proc_min = std::min_element(objall.begin(), objall.end()) - objall.begin();
+    XMPI::bcastEigen(elemToNode, proc_min);
+    
+    // level 2: elements of a node to its ranks, by the first rank of the node;
+    // each element is set by one node only, stored as rank + 1 for the sum
+    elemToProc = IColX::Zero(nelem);
+    for (int inode = 0; inode < nnode; inode++) {
+        if (ranksOfNode[inode][0] != XMPI::rank()) {
+            continue;
+        }
+        // sub-graph of the node
+        std::vector<int> elems;
+        IColX subTag = IColX::Constant(nelem, -1);
+        for (int ielem = 0; ielem < nelem; ielem++) {
+            if (elemToNode(ielem) == inode) {
+                subTag(ielem) = elems.size();
+                elems.push_back(ielem);
+            }
+        }
+        int nsub = elems.size();
+        std::vector<int> subXadj(1, 0), subAdjncy, subAdjwgt;
+        IColX subVwgt(vwgt.size() > 0 ? nsub : 0);
+        for (int isub = 0; isub < nsub; isub++) {
+            int ielem = elems[isub];
+            for (int j = xadj[ielem]; j < xadj[ielem + 1]; j++) {
+                if (subTag(adjncy[j]) >= 0) {
+                    subAdjncy.push_back(subTag(adjncy[j]));
+                    if (adjwgt.size() > 0) {
+                        subAdjwgt.push_back(adjwgt[j]);
+                    }
+                }
+            }
+            subXadj.push_back(subAdjncy.size());
+            if (vwgt.size() > 0) {
+                subVwgt(isub) = vwgt(ielem);
+            }
+        }
+        const std::vector<int> &ranks = ranksOfNode[inode];
+        IColX subPart = IColX::Zero(nsub);
+        int subObjval = 0;
+        if (ranks.size() > 1 && nsub > 0) {
+            partition(nsub, subXadj.data(), subAdjncy.data(), subVwgt, subAdjwgt, 
+                ranks.size(), std::vector<float>(), option, XMPI::rank(), subPart, subObjval);
+        }
+        for (int isub = 0; isub < nsub; isub++) {
+            elemToProc(elems[isub]) = ranks[subPart(isub)] + 1;
         }
     }
+    XMPI::sumEigenInt(elemToProc);
+    elemToProc.array() -= 1;
+}
 
-    // convert to dual graph
-    int numflag = 0;
-    metisError(METIS_MeshToDual(&nelem, &nnode, eptr.data(), eind.data(), 
-        &ncommon, &numflag, &xadj, &adjncy), "METIS_MeshToDual"); 
+void DualGraph::formWeights(const DecomposeOption &option, int nelem, const int *xadj, 
+    const int *adjncy, IColX &vwgt, std::vector<int> &adjwgt) {
+    vwgt = IColX(0);
+    adjwgt.clear();
+    if (option.mElemWeights.size() > 0) {
+        double imax = std::numeric_limits<int>::max() * .9;
+        double sum = option.mElemWeights.sum();
+        vwgt = (option.mElemWeights / sum * imax).array().round().matrix().cast<int>();
+    }
+    // an edge is cut into values of the coarser element on both ranks;
+    // scaled to at most 1000 to keep the cut within int
+    if (option.mCommWeights.size() > 0) {
+        double cmax = option.mCommWeights.maxCoeff();
+        adjwgt.resize(xadj[nelem]);
+        for (int i = 0; i < nelem; i++) {
+            for (int j = xadj[i]; j < xadj[i + 1]; j++) {
+                double c = std::min(option.mCommWeights(i), option.mCommWeights(adjncy[j]));
+                adjwgt[j] = std::max(1, (int)std::round(c / cmax * 1000.));
+            }
+        }
+    }
 }
 
-void DualGraph::freeAdjacency(int *&xadj, int *&adjncy) {
-    // free CRS created by metis 
+void DualGraph::partition(int nvtx, int *xadj, int *adjncy, IColX &vwgt, 
+    std::vector<int> &adjwgt, int nparts, std::vector<float> tpwgts, 
+    const DecomposeOption &option, int seed, IColX &part, int &objval) {
+    // metis options
+    int metis_option[METIS_NOPTIONS];
+    metisError(METIS_SetDefaultOptions(metis_option), "METIS_SetDefaultOptions");
+    metis_option[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
+    metis_option[METIS_OPTION_CONTIG] = 1;
+    metis_option[METIS_OPTION_NCUTS] = option.mNCutsPerProc;
+    metis_option[METIS_OPTION_SEED] = seed; // generate different partitions
+    
+    // run
+    int ncon = 1;
+    float ubvec = (float)(1. + option.mImbalance);
+    metisError(METIS_PartGraphKway(&nvtx, &ncon, xadj, adjncy, 
+        vwgt.size() > 0 ? vwgt.data() : NULL, NULL, 
+        adjwgt.size() > 0 ? adjwgt.data() : NULL, &nparts, 
+        tpwgts.size() > 0 ? tpwgts.data() : NULL, &ubvec, 
+        metis_option, &objval, part.data()), 
+        "METIS_PartGraphKway");
+}
+
+#ifdef _USE_PARMETIS
+void DualGraph::decomposeParallel(const IMatX4 &connectivity, 
+    const DecomposeOption &option, IColX &elemToProc) {
+    DualGraph::check_idx_t();
+    int nelem = connectivity.rows();
+    int nproc = XMPI::nproc();
+    bool welem = option.mElemWeights.size() > 0;
+    if (welem && option.mElemWeights.size() != nelem) {
+        throw std::runtime_error("DualGraph::decomposeParallel || "
+            "Incompatible size of element weights.");
+    }
+    bool wcomm = option.mCommWeights.size() > 0;
+    if (wcomm && option.mCommWeights.size() != nelem) {
+        throw std::runtime_error("DualGraph::decomposeParallel || "
+            "Incompatible size of communication weights.");
+    }
+    
+    // block of elements on this rank
+    std::vector<int> elmdist(nproc + 1);
+    for (int iproc = 0; iproc <= nproc; iproc++) {
+        elmdist[iproc] = (int)((long)nelem * iproc / nproc);
+    }
+    int ebeg = elmdist[XMPI::rank()];
+    int nloc = elmdist[XMPI::rank() + 1] - ebeg;
+    std::vector<int> eptr(nloc + 1), eind(nloc * 4);
+    for (int i = 0; i < nloc; i++) {
+        eptr[i] = i * 4;
+        for (int j = 0; j < 4; j++) {
+            eind[i * 4 + j] = connectivity(ebeg + i, j);
+        }
+    }
+    eptr[nloc] = nloc * 4;
+    
+    // distributed dual graph, adjncy in global element tags
+    MPI_Comm comm = XMPI::comm();
+    int numflag = 0;
+    int ncommon = 2;
+    int *xadj, *adjncy;
+    parmetisError(ParMETIS_V3_Mesh2Dual(elmdist.data(), eptr.data(), eind.data(), 
+        &numflag, &ncommon, &xadj, &adjncy, &comm), "ParMETIS_V3_Mesh2Dual");
+    
+    // weights, scaled as in the serial path
+    int wgtflag = 0;
+    std::vector<int> vwgt(std::max(nloc, 1), 1);
+    if (welem) {
+        double imax = std::numeric_limits<int>::max() * .9;
+        double sum = option.mElemWeights.sum();
+        for (int i = 0; i < nloc; i++) {
+            vwgt[i] = std::max(1, (int)std::round(option.mElemWeights(ebeg + i) / sum * imax));
+        }
+        wgtflag += 2;
+    }
+    std::vector<int> adjwgt(std::max(xadj[nloc], 1), 1);
+    if (wcomm) {
+        double cmax = option.mCommWeights.maxCoeff();
+        for (int i = 0; i < nloc; i++) {
+            for (int j = xadj[i]; j < xadj[i + 1]; j++) {
+                double c = std::min(option.mCommWeights(ebeg + i), 
+                    option.mCommWeights(adjncy[j]));
+                adjwgt[j] = std::max(1, (int)std::round(c / cmax * 1000.));
+            }
+        }
+        wgtflag += 1;
+    }
+    
+    // run
+    int ncon = 1;
+    std::vector<float> tpwgts(nproc, 1.f / nproc);
+    float ubvec = (float)(1. + option.mImbalance);
+    int options[3] = {1, 0, 0};
+    int edgecut = 0;
+    std::vector<int> part(std::max(nloc, 1), 0);
+    parmetisError(ParMETIS_V3_PartKway(elmdist.data(), xadj, adjncy, 
+        vwgt.data(), adjwgt.data(), &wgtflag, &numflag, &ncon, &nproc, 
+        tpwgts.data(), &ubvec, options, &edgecut, part.data(), &comm), 
+        "ParMETIS_V3_PartKway");
     metisError(METIS_Free(xadj), "METIS_Free"); 
     metisError(METIS_Free(adjncy), "METIS_Free"); 
+    
+    // assemble the blocks
+    part.resize(nloc);
+    std::vector<std::vector<int>> allPart;
+    XMPI::gather(part, allPart, MPI_INT, true);
+    for (int iproc = 0; iproc < nproc; iproc++) {
+        for (int i = 0; i < allPart[iproc].size(); i++) {
+            elemToProc(elmdist[iproc] + i) = allPart[iproc][i];
+        }
+    }
+}
+
+void DualGraph::parmetisError(const int retval, const std::string &func_name) {
+    if (retval != METIS_OK) {
+        throw std::runtime_error("DualGraph::parmetisError || "
+            "Error in parmetis function: " + func_name);
+    }
+}
+#endif
+
+void DualGraph::formAdjacency(const IMatX4 &connectivity, int *&xadj, int *&adjncy) {
+    DualGraph::check_idx_t();
+    formIncidence(connectivity);
+    int nelem = connectivity.rows();
+    if (sXadj.size() != nelem + 1) {
+        // degrees, then neighbours at their offsets, both in parallel
+        sXadj.assign(nelem + 1, 0);
+        #ifdef _USE_OPENMP
+            #pragma omp parallel
+        #endif
+        {
+            std::vector<int> buffer;
+            #ifdef _USE_OPENMP
+                #pragma omp for schedule(static)
+            #endif
+            for (int ielem = 0; ielem < nelem; ielem++) {
+                sXadj[ielem + 1] = elemNeighbours(ielem, 2, buffer);
+            }
+        }
+        std::partial_sum(sXadj.begin(), sXadj.end(), sXadj.begin());
+        sAdjncy.resize(sXadj[nelem]);
+        #ifdef _USE_OPENMP
+            #pragma omp parallel
+        #endif
+        {
+            std::vector<int> buffer;
+            #ifdef _USE_OPENMP
+                #pragma omp for schedule(static)
+            #endif
+            for (int ielem = 0; ielem < nelem; ielem++) {
+                int nn = elemNeighbours(ielem, 2, buffer);
+                std::copy(buffer.begin(), buffer.begin() + nn, sAdjncy.begin() + sXadj[ielem]);
+            }
+        }
+    }
+    // metis does not modify the graph
+    xadj = sXadj.data();
+    adjncy = sAdjncy.data();
+}
+
+void DualGraph::formIncidence(const IMatX4 &connectivity) {
+    // the same connectivity as the last call
+    int nelem = connectivity.rows();
+    if (sConnectivity.rows() == nelem && sNodePtr.size() > 0 && 
+        (sConnectivity.array() == connectivity.array()).all()) {
+        return;
+    }
+    freeCache();
+    sConnectivity = connectivity;
+    if (nelem == 0) {
+        sNodePtr.assign(1, 0);
+        return;
+    }
+    
+    // counting sort of the elements by node, without relabelling the nodes
+    sNodeMin = connectivity.minCoeff();
+    int nnode = connectivity.maxCoeff() - sNodeMin + 1;
+    sNodePtr.assign(nnode + 1, 0);
+    for (int ielem = 0; ielem < nelem; ielem++) {
+        for (int j = 0; j < 4; j++) {
+            sNodePtr[connectivity(ielem, j) - sNodeMin + 1]++;
+        }
+    }
+    std::partial_sum(sNodePtr.begin(), sNodePtr.end(), sNodePtr.begin());
+    sNodeElems.resize(sNodePtr[nnode]);
+    std::vector<int> fill(sNodePtr.begin(), sNodePtr.end() - 1);
+    for (int ielem = 0; ielem < nelem; ielem++) {
+        for (int j = 0; j < 4; j++) {
+            sNodeElems[fill[connectivity(ielem, j) - sNodeMin]++] = ielem;
+        }
+    }
+}
+
+int DualGraph::elemNeighbours(int ielem, int ncommon, std::vector<int> &buffer) {
+    // elements on the nodes of ielem, each appearing once per common node;
+    // the neighbours are then compacted to the front of buffer
+    buffer.clear();
+    for (int j = 0; j < 4; j++) {
+        int inode = sConnectivity(ielem, j) - sNodeMin;
+        for (int k = sNodePtr[inode]; k < sNodePtr[inode + 1]; k++) {
+            if (sNodeElems[k] != ielem) {
+                buffer.push_back(sNodeElems[k]);
+            }
+        }
+    }
+    std::sort(buffer.begin(), buffer.end());
+    int nn = 0;
+    for (int i = 0; i < buffer.size();) {
+        int j = i;
+        while (j < buffer.size() && buffer[j] == buffer[i]) {
+            j++;
+        }
+        if (j - i >= ncommon) {
+            buffer[nn++] = buffer[i];
+        }
+        i = j;
+    }
+    return nn;
 }
 
 void DualGraph::metisError(const int retval, const std::string &func_name) {
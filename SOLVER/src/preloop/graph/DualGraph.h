@@ -9,6 +9,16 @@
 // domain decomposition option
 struct DecomposeOption {
     RDColX mElemWeights = RDColX::Zero(0);
+    // values exchanged per point on the edges of an element,
+    // weighting the dual-graph edges by halo size
+    RDColX mCommWeights = RDColX::Zero(0);
+    // place partitions on ranks by an MPI graph communicator of the halo
+    bool mReorderRanks = false;
+    // placement written for checkpoint or read for restart, empty for neither
+    std::string mPlacementFile = "";
+    bool mPlacementRestart = false;
+    // partition into shared-memory nodes first, then into their ranks
+    bool mHierarchical = false;
     double mImbalance = 0.01;
     int mProcInterval = 1;
     int mNCutsPerProc = 1;
@@ -21,15 +31,54 @@ public:
     static void formNeighbourhood(const IMatX4 &connectivity, int ncommon, 
         std::vector<IColX> &neighbours);
     
+    // elements sharing at least ncommon nodes with each of the given 
+    // elements, sorted, from the cached node-to-element incidence
+    static void formNeighbours(const IMatX4 &connectivity, const std::vector<int> &elems, 
+        int ncommon, std::vector<std::vector<int>> &neighbours);
+    
+    // free the incidence and the dual graph kept between decompositions
+    static void freeCache();
+    
     // domain decomposition
     static void decompose(const IMatX4 &connectivity, const DecomposeOption &option, 
         IColX &elemToProc);
     
 private:
-    static void formAdjacency(const IMatX4 &connectivity, int ncommon, int *&xadj, int *&adjncy);
-    static void freeAdjacency(int *&xadj, int *&adjncy);
+    // first into nodes, then into the ranks of each node
+    static void decomposeHierarchical(const IMatX4 &connectivity, const DecomposeOption &option, 
+        const std::vector<std::vector<int>> &ranksOfNode, IColX &elemToProc);
+    // metis weights of the dual graph, empty if not given
+    static void formWeights(const DecomposeOption &option, int nelem, const int *xadj, 
+        const int *adjncy, IColX &vwgt, std::vector<int> &adjwgt);
+    // a single metis run, tpwgts empty for equal parts
+    static void partition(int nvtx, int *xadj, int *adjncy, IColX &vwgt, 
+        std::vector<int> &adjwgt, int nparts, std::vector<float> tpwgts, 
+        const DecomposeOption &option, int seed, IColX &part, int &objval);
+    #ifdef _USE_PARMETIS
+        // parmetis on a contiguous block of elements per rank
+        static void decomposeParallel(const IMatX4 &connectivity, 
+            const DecomposeOption &option, IColX &elemToProc);
+        static void parmetisError(const int retval, const std::string &func_name);
+    #endif
+    // dual graph of elements sharing at least two nodes, in CSR; 
+    // kept for the decomposition of the weighted mesh
+    static void formAdjacency(const IMatX4 &connectivity, int *&xadj, int *&adjncy);
+    // node-to-element incidence in CSR, formed once per connectivity
+    static void formIncidence(const IMatX4 &connectivity);
+    // neighbours of an element, written to the front of buffer
+    static int elemNeighbours(int ielem, int ncommon, std::vector<int> &buffer);
     static void metisError(const int retval, const std::string &func_name);
     static void check_idx_t();
+    
+    // cache of the last connectivity
+    static IMatX4 sConnectivity;
+    // elements on node n: sNodeElems[sNodePtr[n - sNodeMin]] until sNodePtr[n - sNodeMin + 1]
+    static int sNodeMin;
+    static std::vector<int> sNodePtr;
+    static std::vector<int> sNodeElems;
+    // dual graph with ncommon = 2
+    static std::vector<int> sXadj;
+    static std::vector<int> sAdjncy;
 };
 
 
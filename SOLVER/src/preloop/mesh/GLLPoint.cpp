@@ -5,6 +5,7 @@
 #include "GLLPoint.h"
 #include "Mass1D.h"
 #include "Mass3D.h"
+#include "MassFourier3D.h"
 #include "SolidPoint.h"
 #include "FluidPoint.h"
 #include "SolidFluidPoint.h"
@@ -17,6 +18,7 @@
 #include "MassOcean1D.h"
 #include "MassOcean3D.h"
 #include "OceanLoad3D.h"
+#include "PreloopFFTW.h"
 
 GLLPoint::GLLPoint(): mNr(0) {
     // nothing
@@ -45,7 +47,60 @@ void GLLPoint::setup(int nr, bool axial, bool surface, const RDCol2 &crds, doubl
     }
 }
 
-int GLLPoint::release(Domain &domain) const {
+// 3D inverse mass, in Fourier space if it has only a few azimuthal orders
+double GLLPoint::predictBytes() const {
+    bool isSolid = mMassSolid.norm() > tinyDouble;
+    bool isFluid = mMassFluid.norm() > tinyDouble; 
+    int ncomp = (isSolid ? 3 : 0) + (isFluid ? 1 : 0);
+    // displ, accel and stiff; veloc in Newmark precision
+    int nbytes = 3 * sizeof(Complex) + sizeof(ComplexN);
+    #ifdef _USE_MIXED_PRECISION
+        nbytes += sizeof(ComplexN);
+    #endif
+    double bytes = (double)ncomp * (mNr / 2 + 1) * nbytes;
+    // 3D mass, ocean load and solid-fluid normals
+    if (isSolid && !XMath::equalRows(mMassSolid)) {
+        bytes += mNr * sizeof(Real);
+    }
+    if (isFluid && !XMath::equalRows(mMassFluid)) {
+        bytes += mNr * sizeof(Real);
+    }
+    if (isSolid && mOceanDepth.array().abs().maxCoeff() > tinyDouble) {
+        bytes += 4. * mNr * sizeof(Real);
+    }
+    if (isSolid && isFluid) {
+        bytes += 6. * mNr * sizeof(Real);
+    }
+    return bytes;
+}
+
+int GLLPoint::predictSizeComm() const {
+    bool isSolid = mMassSolid.norm() > tinyDouble;
+    bool isFluid = mMassFluid.norm() > tinyDouble; 
+    return ((isSolid ? 3 : 0) + (isFluid ? 1 : 0)) * (mNr / 2 + 1);
+}
+
+Mass *GLLPoint::createMass3D(const RDColX &invMass, int fourierOrder, double fourierTol) const {
+    if (fourierOrder > 0) {
+        PreloopFFTW::getR2C_RMat(mNr) = invMass;
+        PreloopFFTW::computeR2C(mNr);
+        const CDColX &coeffs = PreloopFFTW::getR2C_CMat(mNr);
+        double amplitude0 = std::abs(coeffs(0));
+        int order = mNr / 2;
+        while (order > 0 && std::abs(coeffs(order)) <= fourierTol * amplitude0) {
+            order--;
+        }
+        // the convolution must be much cheaper than the FFT pair
+        if (order == 0) {
+            return new Mass1D((Real)coeffs(0).real());
+        } else if (order <= fourierOrder && 4 * order < mNr) {
+            return new MassFourier3D(coeffs.topRows(order + 1).cast<Complex>(), mNr);
+        }
+    }
+    return new Mass3D(invMass.cast<Real>());
+}
+
+int GLLPoint::release(Domain &domain, int fourierOrder, double fourierTol) const {
     // solid fluid
     bool isSolid = mMassSolid.norm() > tinyDouble;
     bool isFluid = mMassFluid.norm() > tinyDouble; 
@@ -75,7 +130,7 @@ int GLLPoint::release(Domain &domain) const {
                 mass = new Mass1D((Real)(1. / mMassSolid(0)));
             } else {
                 const RDColX &invMass = mMassSolid.array().pow(-1.).matrix(); 
-                mass = new Mass3D(invMass.cast<Real>());
+                mass = createMass3D(invMass, fourierOrder, fourierTol);
             }
         }
         solid = new SolidPoint(mNr, mIsAxial, mCoords, mass);
@@ -89,7 +144,7 @@ int GLLPoint::release(Domain &domain) const {
             mass = new Mass1D((Real)(1. / mMassFluid(0)));
         } else {
             const RDColX &invMass = mMassFluid.array().pow(-1.).matrix(); 
-            mass = new Mass3D(invMass.cast<Real>());
+            mass = createMass3D(invMass, fourierOrder, fourierTol);
         }
         fluid = new FluidPoint(mNr, mIsAxial, mCoords, mass, mOnSurface);
     }
@@ -127,22 +182,74 @@ int GLLPoint::release(Domain &domain) const {
     } 
 }
 
-void GLLPoint::feedBuffer(RDMatXX &buffer, int col) {
-    int nr = mSFNormal_assmble.rows();
-    buffer.block(0, col, nr, 1) = mMassSolid;
-    buffer.block(nr, col, nr, 1) = mMassFluid;
-    buffer.block(nr * 2, col, nr * 3, 1) = Eigen::Map<RDColX>(mSFNormal_assmble.data(), nr * 3);
-    buffer.block(nr * 5, col, nr * 3, 1) = Eigen::Map<RDColX>(mSurfNormal.data(), nr * 3);
-    buffer(nr * 8, col) = (double)mReferenceCount;
+namespace GLLPointBuffer {
+    // fields of the assembly and their number of values per nr
+    enum Field {MassSolid = 1, MassFluid = 2, SFNormal = 4, SurfNormal = 8};
+    
+    int fieldMask(const RDColX &massSolid, const RDColX &massFluid, 
+        const RDMatX3 &sfNormal, const RDMatX3 &surfNormal) {
+        return (massSolid.isZero(0.) ? 0 : MassSolid) | (massFluid.isZero(0.) ? 0 : MassFluid) |
+            (sfNormal.isZero(0.) ? 0 : SFNormal) | (surfNormal.isZero(0.) ? 0 : SurfNormal);
+    }
+    
+    int sizeFields(int mask, int nr) {
+        return ((mask & MassSolid) ? nr : 0) + ((mask & MassFluid) ? nr : 0) +
+            ((mask & SFNormal) ? nr * 3 : 0) + ((mask & SurfNormal) ? nr * 3 : 0);
+    }
 }
 
-void GLLPoint::extractBuffer(RDMatXX &buffer, int col) {
-    int nr = mSFNormal_assmble.rows();
-    mMassSolid += buffer.block(0, col, nr, 1);
-    mMassFluid += buffer.block(nr, col, nr, 1);
-    mSFNormal_assmble += Eigen::Map<RDMatX3>(buffer.block(nr * 2, col, nr * 3, 1).data(), nr, 3);
-    mSurfNormal += Eigen::Map<RDMatX3>(buffer.block(nr * 5, col, nr * 3, 1).data(), nr, 3);
-    mReferenceCount += round(buffer(nr * 8, col));
+int GLLPoint::sizeBuffer() const {
+    int mask = GLLPointBuffer::fieldMask(mMassSolid, mMassFluid, mSFNormal_assmble, mSurfNormal);
+    return 2 + GLLPointBuffer::sizeFields(mask, mNr);
+}
+
+int GLLPoint::feedBuffer(double *buffer) const {
+    using namespace GLLPointBuffer;
+    int mask = fieldMask(mMassSolid, mMassFluid, mSFNormal_assmble, mSurfNormal);
+    buffer[0] = (double)mReferenceCount;
+    buffer[1] = (double)mask;
+    int row = 2;
+    if (mask & MassSolid) {
+        Eigen::Map<RDColX>(buffer + row, mNr) = mMassSolid;
+        row += mNr;
+    }
+    if (mask & MassFluid) {
+        Eigen::Map<RDColX>(buffer + row, mNr) = mMassFluid;
+        row += mNr;
+    }
+    if (mask & SFNormal) {
+        Eigen::Map<RDMatX3>(buffer + row, mNr, 3) = mSFNormal_assmble;
+        row += mNr * 3;
+    }
+    if (mask & SurfNormal) {
+        Eigen::Map<RDMatX3>(buffer + row, mNr, 3) = mSurfNormal;
+        row += mNr * 3;
+    }
+    return row;
+}
+
+int GLLPoint::extractBuffer(const double *buffer) {
+    using namespace GLLPointBuffer;
+    mReferenceCount += round(buffer[0]);
+    int mask = (int)round(buffer[1]);
+    int row = 2;
+    if (mask & MassSolid) {
+        mMassSolid += Eigen::Map<const RDColX>(buffer + row, mNr);
+        row += mNr;
+    }
+    if (mask & MassFluid) {
+        mMassFluid += Eigen::Map<const RDColX>(buffer + row, mNr);
+        row += mNr;
+    }
+    if (mask & SFNormal) {
+        mSFNormal_assmble += Eigen::Map<const RDMatX3>(buffer + row, mNr, 3);
+        row += mNr * 3;
+    }
+    if (mask & SurfNormal) {
+        mSurfNormal += Eigen::Map<const RDMatX3>(buffer + row, mNr, 3);
+        row += mNr * 3;
+    }
+    return row;
 }
 
 
@@ -7,6 +7,7 @@
 #include "eigenp.h"
 
 class Domain;
+class Mass;
 
 class GLLPoint {
 public:
@@ -26,18 +27,30 @@ public:
     void addSurfNormal(const RDMatX3 &normal) {mSurfNormal += normal;};
     
     // release to domain
-    int release(Domain &domain) const;
+    // 3D masses with at most fourierOrder azimuthal orders above 
+    // fourierTol are applied in Fourier space; 0 to turn off
+    int release(Domain &domain, int fourierOrder = 0, double fourierTol = 0.) const;
     
     // gets 
     int getNr() const {return mNr;};
     int getReferenceCount() const {return mReferenceCount;};
+    
+    // bytes of the point to be released and the values it exchanges 
+    // per message, predicted before release for the memory budget
+    double predictBytes() const;
+    int predictSizeComm() const;
     const RDCol2 &getCoords() const {return mCoords;};
     
-    // feed/extract buffer
-    void feedBuffer(RDMatXX &buffer, int col);
-    void extractBuffer(RDMatXX &buffer, int col);
+    // feed/extract buffer, packed as the reference count, a mask of 
+    // the nonzero fields and those fields; returning the values used
+    static int sizeBufferMax(int nr) {return nr * 8 + 2;};
+    int sizeBuffer() const;
+    int feedBuffer(double *buffer) const;
+    int extractBuffer(const double *buffer);
     
 private:
+    Mass *createMass3D(const RDColX &invMass, int fourierOrder, double fourierTol) const;
+    
     // properties
     int mNr;
     bool mIsAxial;
@@ -17,13 +17,27 @@
 #include "Point.h"
 #include "Geodesy.h"
 #include "Geometric3D.h"
+#include "Volumetric3D.h"
 #include "NuWisdom.h"
 #include "NrField.h"
 
 #include "MultilevelTimer.h"
 #include "SlicePlot.h"
+#include "Checkpoint.h"
+#include "XMath.h"
+#include "SharedHalo.h"
+#include "HaloAggregator.h"
+#include "PreloopFFTW.h"
+#include "XOMP.h"
+#include "PackedBuffer.h"
+#include "QuadIndex.h"
+#include "BoxInjection.h"
 #include <fstream>
+#include <sstream>
 #include <cfloat>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
 
 Mesh::~Mesh() {
     destroy(); // local build
@@ -39,9 +53,13 @@ Mesh::Mesh(const ExodusModel *exModel, const NrField *nrf,
 mExModel(exModel), mNrField(nrf), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
     mAttBuilder = 0;
     mMsgInfo = 0;
+    mQuadIndex = 0;
     mOceanLoad3D = 0;
-    mDDPar = new DDParameters(par);
+    mDDPar = new DDParameters(par, srcLat, srcLon, srcDep);
     mLearnPar = new LearnParameters(par);
+    mLearnPar->mSrcLat = srcLat;
+    mLearnPar->mSrcLon = srcLon;
+    mLearnPar->mSrcDep = srcDep;
     
     // 2D mode
     std::string mode2d = par.getValue<std::string>("MODEL_2D_MODE");
@@ -68,6 +86,56 @@ mExModel(exModel), mNrField(nrf), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcD
          throw std::runtime_error("Mesh::Mesh || Invalid input for MODEL_2D_MODE.");
     }
     
+    // demote weakly 3D elements
+    mDemoteTol3D = par.getValue<double>("MODEL_3D_DEMOTE_TOLERANCE");
+    mDemoteTolUndulation = par.getValue<double>("MODEL_3D_DEMOTE_TOLERANCE_UNDULATION");
+    
+    // precomputed stiffness of 1D elements
+    if (par.getSize("OPTION_LUMPED_STIFFNESS_MB") != 2) {
+        throw std::runtime_error("Mesh::Mesh || "
+            "OPTION_LUMPED_STIFFNESS_MB requires two budgets, Isotropic1D and TransverselyIsotropic1D.");
+    }
+    const std::vector<std::string> lumpedClasses = {"Isotropic1D", "TransverselyIsotropic1D"};
+    for (int i = 0; i < lumpedClasses.size(); i++) {
+        double mb = par.getValue<double>("OPTION_LUMPED_STIFFNESS_MB", i);
+        if (mb > 0.) {
+            mLumpedStiffnessMB[lumpedClasses[i]] = mb;
+        }
+    }
+    
+    // first-touch release by the computing threads
+    mFirstTouch = par.getValue<bool>("OMP_FIRST_TOUCH");
+    
+    // weakly 3D solids in Fourier space
+    mFourierOrder3D = par.getValue<int>("MODEL_3D_FOURIER_ORDER");
+    mFourierTol3D = par.getValue<double>("MODEL_3D_FOURIER_TOLERANCE");
+    
+    // box injection
+    std::string boxMode = par.getValue<std::string>("BOX_INJECTION_MODE");
+    if (boost::iequals(boxMode, "none")) {
+        mBoxMode = 0;
+    } else if (boost::iequals(boxMode, "record")) {
+        mBoxMode = 1;
+    } else if (boost::iequals(boxMode, "inject")) {
+        mBoxMode = 2;
+    } else {
+        throw std::runtime_error("Mesh::Mesh || Invalid input for BOX_INJECTION_MODE.");
+    }
+    if (mBoxMode > 0) {
+        if (par.getSize("BOX_INJECTION_REGION") != 4) {
+            throw std::runtime_error("Mesh::Mesh || "
+                "BOX_INJECTION_REGION requires rmin, rmax, distmin and distmax.");
+        }
+        mBoxRange[0] = par.getValue<double>("BOX_INJECTION_REGION", 0) * 1e3;
+        mBoxRange[1] = par.getValue<double>("BOX_INJECTION_REGION", 1) * 1e3;
+        mBoxRange[2] = par.getValue<double>("BOX_INJECTION_REGION", 2) * degree;
+        mBoxRange[3] = par.getValue<double>("BOX_INJECTION_REGION", 3) * degree;
+        if (mBoxRange[0] >= mBoxRange[1] || mBoxRange[2] >= mBoxRange[3]) {
+            throw std::runtime_error("Mesh::Mesh || Empty BOX_INJECTION_REGION.");
+        }
+    }
+    mBoxBufferSize = par.getValue<int>("BOX_INJECTION_BUFFER_SIZE");
+    
     // slice plots
     SlicePlot::buildInparam(mSlicePlots, par, this, verbose);
     if (mSlicePlots.size() > 0 && XMPI::root()) {
@@ -86,19 +154,37 @@ mExModel(exModel), mNrField(nrf), mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcD
 }
 
 void Mesh::buildUnweighted() {
-    // balance by Nr
+    // balance by the modes of the maximum Nr at the nodes, 
+    // weighted by the costs per mode of solids and fluids on this machine
+    std::map<std::string, double> elemCostModel, pointCostModel;
+    if (mDDPar->mEstimateCosts) {
+        readCostModel(elemCostModel, pointCostModel);
+    }
+    double costSolid = costPerMode(elemCostModel, "SolidElement");
+    double costFluid = costPerMode(elemCostModel, "FluidElement");
+    if (costSolid <= 0. || costFluid <= 0.) {
+        // by the number of components
+        costSolid = 3.;
+        costFluid = 1.;
+    }
     DecomposeOption option;
     option.mProcInterval = mDDPar->mProcInterval;
     option.mNCutsPerProc = mDDPar->mNCutsPerProc;
     int nElemGlobal = mExModel->getNumQuads(); 
     option.mElemWeights = RDColX::Zero(nElemGlobal);
     for (int iquad = 0; iquad < nElemGlobal; iquad++) {
-        int inode = mExModel->getConnectivity()(iquad, 0);
-        RDCol2 sz;
-        sz(0) = mExModel->getNodalS(inode);
-        sz(1) = mExModel->getNodalZ(inode);
-        option.mElemWeights(iquad) = mNrField->getNrAtPoint(sz) * 1.;
+        int nr = 1;
+        for (int i = 0; i < 4; i++) {
+            int inode = mExModel->getConnectivity()(iquad, i);
+            RDCol2 sz;
+            sz(0) = mExModel->getNodalS(inode);
+            sz(1) = mExModel->getNodalZ(inode);
+            nr = std::max(nr, mNrField->getNrAtPoint(sz));
+        }
+        bool fluid = mExModel->getElementalVariables("fluid", iquad) > .5;
+        option.mElemWeights(iquad) = (fluid ? costFluid : costSolid) * (nr / 2 + 1);
     }
+    formCommWeights(option);
     MultilevelTimer::begin("Build Local", 1);
     buildLocal(option);
     MultilevelTimer::end("Build Local", 1);
@@ -113,8 +199,9 @@ double Mesh::getDeltaT() const {
     double dtMin = std::numeric_limits<double>::max();
     double s = 0.;
     double z = 0.;
+    std::vector<double> dtQuads(getNumQuads());
     for (int i = 0; i < getNumQuads(); i++) {
-        double dt = mQuads[i]->getDeltaT();
+        double dt = dtQuads[i] = mQuads[i]->getDeltaT();
         if (dtMin > dt) {
             dtMin = dt;
             const auto &sz = mQuads[i]->getNodalCoords().rowwise().mean();
@@ -123,19 +210,12 @@ double Mesh::getDeltaT() const {
         }
     }
     
-    // minimum dt over ranks
-    std::vector<double> dtV;
-    std::vector<double> sV;
-    std::vector<double> zV;
-    XMPI::gather(dtMin, dtV, true);
-    XMPI::gather(s, sV, true);
-    XMPI::gather(z, zV, true);
-    
-    // rank with minimum dt
-    Eigen::Index rankDt;
-    dtMin = Eigen::Map<RDColX>(dtV.data(), dtV.size()).minCoeff(&rankDt);
-    s = sV[rankDt];
-    z = zV[rankDt];
+    // minimum dt over ranks and its location from the owner
+    int rankDt = XMPI::minLoc(dtMin);
+    double sz[2] = {s, z};
+    XMPI::bcast(sz, 2, rankDt);
+    s = sz[0];
+    z = sz[1];
     double r = sqrt(s*s+z*z);
     double t = acos(z/r);
     
@@ -146,6 +226,29 @@ double Mesh::getDeltaT() const {
     ss << "  Location z   =   " << z << std::endl;
     ss << "  Location r   =   " << r << std::endl;
     ss << "  Location θ   =   " << t << std::endl;
+    
+    // local time stepping levels, quads binned by their own dt into 2^k * dtMin, 
+    // with the cost of a quad taken as its nr 
+    const int nLevels = 6;
+    std::vector<double> levelCost(nLevels, 0.);
+    for (int i = 0; i < getNumQuads(); i++) {
+        int level = (int)std::floor(std::log2(dtQuads[i] / dtMin));
+        level = std::max(0, std::min(level, nLevels - 1));
+        levelCost[level] += mQuads[i]->getNr();
+    }
+    XMPI::sumVector(levelCost);
+    double costGlobal = 0.;
+    double costLocal = 0.;
+    for (int level = 0; level < nLevels; level++) {
+        costGlobal += levelCost[level];
+        costLocal += levelCost[level] / std::pow(2., level);
+    }
+    ss << "  LTS levels (share of cost by dt = 2^k * Minimum DT)" << std::endl;
+    for (int level = 0; level < nLevels; level++) {
+        ss << "    k = " << level << (level == nLevels - 1 ? "+" : " ") << "    =   " 
+            << levelCost[level] / costGlobal * 100. << "%" << std::endl;
+    }
+    ss << "  LTS speedup bound   =   " << costGlobal / costLocal << std::endl;
     ss << "============================ DT ============================\n" << std::endl;
     XMPI::cout << ss.str();
     return dtMin;
@@ -160,11 +263,38 @@ void Mesh::buildWeighted() {
     measured.mProcInterval = mDDPar->mProcInterval;
     measured.mNCutsPerProc = mDDPar->mNCutsPerProc;
     MultilevelTimer::begin("Measure", 1);
-    measure(measured);
+    if (mDDPar->mRestart) {
+        // measured costs vary between runs; 
+        // use the weights of the run being restarted to rebuild its partition
+        if (!readWeights(Checkpoint::weightsFile(), measured.mElemWeights)) {
+            throw std::runtime_error("Mesh::buildWeighted || "
+                "Error reading element weights for restart: || " + Checkpoint::weightsFile());
+        }
+    } else if (!mDDPar->mCacheWeights || 
+        !readWeights(mDDPar->mCacheFile, measured.mElemWeights)) {
+        measure(measured);
+        if (mDDPar->mCheckpoint) {
+            writeWeights(Checkpoint::weightsFile(), measured.mElemWeights);
+        }
+        if (mDDPar->mCacheWeights) {
+            writeWeights(mDDPar->mCacheFile, measured.mElemWeights);
+        }
+    }
     MultilevelTimer::end("Measure", 1);
+    mElemWeights = measured.mElemWeights;
+    formCommWeights(measured);
+    // a hierarchical partition is already placed on the nodes
+    measured.mHierarchical = mDDPar->mHierarchical;
+    measured.mReorderRanks = mDDPar->mReorderRanks && !mDDPar->mHierarchical;
+    if (mDDPar->mCheckpoint || mDDPar->mRestart) {
+        measured.mPlacementFile = Checkpoint::placementFile();
+        measured.mPlacementRestart = mDDPar->mRestart;
+    }
     
     MultilevelTimer::begin("Build Local", 1);
     buildLocal(measured);
+    // the dual graph is kept from the unweighted phase until here
+    DualGraph::freeCache();
     MultilevelTimer::end("Build Local", 1);
     // slice plots
     MultilevelTimer::begin("Plot at Weighted Phase", 1);
@@ -174,37 +304,400 @@ void Mesh::buildWeighted() {
     MultilevelTimer::end("Plot at Weighted Phase", 1);
 }
 
-void Mesh::release(Domain &domain) {
+void Mesh::release(Domain &domain, bool freeLocal) {
+    // points and elements in the order of the local quads
+    Arena::open(domain.getArena());
     MultilevelTimer::begin("Release Points", 2);
     for (const auto &point: mGLLPoints) {
-        point->release(domain);
+        point->release(domain, mFourierOrder3D, mFourierTol3D);
+        if (freeLocal) {
+            delete point;
+        }
     }
+    if (freeLocal) {
+        mGLLPoints.clear();
+    }
+    // halo messages grouped by point type and nr, which both sides 
+    // of a boundary agree on; the key order is kept within a group
+    for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+        std::stable_sort(mMsgInfo->mILocalPoints[i].begin(), mMsgInfo->mILocalPoints[i].end(), 
+            [&domain](int a, int b) {
+                const Point *pa = domain.getPoint(a);
+                const Point *pb = domain.getPoint(b);
+                int ca = pa->sizeComm() / (pa->getNu() + 1);
+                int cb = pb->sizeComm() / (pb->getNu() + 1);
+                return ca < cb || (ca == cb && pa->getNu() < pb->getNu());
+            });
+    }
+    // structure-of-arrays point storage, with the halo points placed 
+    // in message order, such that a message packs a few long blocks
+    std::vector<int> batchRank(domain.getNumPoints(), -1);
+    int nranked = 0;
+    for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+        for (int pTag: mMsgInfo->mILocalPoints[i]) {
+            if (batchRank[pTag] < 0) {
+                batchRank[pTag] = nranked++;
+            }
+        }
+    }
+    for (int &rank: batchRank) {
+        if (rank < 0) {
+            rank = nranked++;
+        }
+    }
+    domain.formPointBatches(batchRank);
     MultilevelTimer::end("Release Points", 2);
     
     MultilevelTimer::begin("Release Elements", 2);
-    for (int iloc = 0; iloc < getNumQuads(); iloc++) {
-        int etag = mQuads[iloc]->release(domain, mLocalElemToGLL[iloc], mAttBuilder);
+    int nquad = getNumQuads();
+    std::vector<Element *> elems(nquad, 0);
+    bool firstTouch = mFirstTouch && XOMP::nThreads() > 1;
+    if (firstTouch) {
+        // an element is created, hence first touched, by the thread 
+        // that computes it in the time loop; the arena of each thread 
+        // keeps its elements on the memory of its own socket
+        Arena::close();
+        Arena::open(domain.getArena(), true);
+        std::vector<int> homes(nquad, 0);
+        std::string error = "";
+        #ifdef _USE_OPENMP
+            #pragma omp parallel for schedule(static)
+        #endif
+        for (int iloc = 0; iloc < nquad; iloc++) {
+            try {
+                elems[iloc] = mQuads[iloc]->createElement(domain, mLocalElemToGLL[iloc], mAttBuilder);
+                homes[iloc] = XOMP::threadID();
+            } catch (const std::exception &e) {
+                // exceptions must not leave a parallel region
+                #ifdef _USE_OPENMP
+                    #pragma omp critical(Mesh_release)
+                #endif
+                if (error == "") {
+                    error = e.what();
+                }
+            }
+        }
+        if (error != "") {
+            for (const auto &elem: elems) {
+                delete elem;
+            }
+            throw std::runtime_error(error);
+        }
+        // domain tags follow the order of the local quads
+        domain.setElementHomes(homes);
+    }
+    int nDemoted = 0;
+    int nUndulated = 0;
+    for (int iloc = 0; iloc < nquad; iloc++) {
+        nDemoted += mQuads[iloc]->isRelabellingDemoted();
+        nUndulated += mQuads[iloc]->hasRelabelling();
+        if (!firstTouch) {
+            elems[iloc] = mQuads[iloc]->createElement(domain, mLocalElemToGLL[iloc], mAttBuilder);
+        }
+        int etag = domain.addElement(elems[iloc]);
         mQuads[iloc]->setElementTag(etag);
+        if (freeLocal) {
+            mQuads[iloc]->freeMaterial();
+        }
     }
     MultilevelTimer::end("Release Elements", 2);
+    Arena::close();
+    
+    // report of weakly 3D undulation demoted to 1D
+    if (mDemoteTolUndulation > 0.) {
+        nDemoted = XMPI::sum(nDemoted);
+        nUndulated = XMPI::sum(nUndulated);
+        std::stringstream ss;
+        ss << "\n==================== Undulation Demotion ====================" << std::endl;
+        ss << "  Tolerance               =   " << mDemoteTolUndulation << std::endl;
+        ss << "  Undulated Elements      =   " << nUndulated << std::endl;
+        ss << "  Demoted to PRT_1D       =   " << nDemoted << std::endl;
+        ss << "==================== Undulation Demotion ====================\n" << std::endl;
+        XMPI::cout << ss.str();
+    }
+    
+    // precomputed stiffness of 1D elements
+    if (mLumpedStiffnessMB.size() > 0) {
+        MultilevelTimer::begin("Lumped Stiffness", 2);
+        const std::map<std::string, int> &nLumped = domain.formLumpedStiffness(mLumpedStiffnessMB);
+        std::stringstream ss;
+        ss << "\n===================== Lumped Stiffness ======================" << std::endl;
+        for (const auto &it: nLumped) {
+            ss << "  " << std::setw(24) << std::left << it.first << "=   " << XMPI::sum(it.second) << 
+                " elements, " << mLumpedStiffnessMB.at(it.first) << " MB per processor" << std::endl;
+        }
+        ss << "===================== Lumped Stiffness ======================\n" << std::endl;
+        XMPI::cout << ss.str();
+        MultilevelTimer::end("Lumped Stiffness", 2);
+    }
     
     // set messaging 
     MessagingBuffer *buf = new MessagingBuffer();
+    std::vector<int> sizes;
     for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
         int sz_total = 0;
         int npoint = mMsgInfo->mNLocalPoints[i];
+        std::vector<std::pair<Complex *, int>> blocks;
+        std::vector<std::array<int, 3>> shapes;
         for (int j = 0; j < npoint; j++) {
             int pTag = mMsgInfo->mILocalPoints[i][j];
-            sz_total += domain.getPoint(pTag)->sizeComm();
+            const Point *point = domain.getPoint(pTag);
+            int nblock = blocks.size();
+            sz_total += point->sizeComm();
+            domain.getPoint(pTag)->getCommStiff(blocks);
+            std::array<int, 3> shape;
+            shape[0] = point->getNu() + 1;
+            shape[1] = point->sizeComm() / shape[0];
+            shape[2] = blocks.size() - nblock;
+            shapes.push_back(shape);
         }
-        buf->mBufferSend.push_back(CColX(sz_total));
-        buf->mBufferRecv.push_back(CColX(sz_total));
-    }    
+        sizes.push_back(sz_total);
+        // neighbouring arrays merged, unless trimmed point by point
+        if (!mDDPar->mTrimModes && blocks.size() > 0) {
+            int nmerged = 0;
+            for (int iblock = 1; iblock < blocks.size(); iblock++) {
+                std::pair<Complex *, int> &last = blocks[nmerged];
+                if (last.first + last.second == blocks[iblock].first) {
+                    last.second += blocks[iblock].second;
+                } else {
+                    blocks[++nmerged] = blocks[iblock];
+                }
+            }
+            blocks.resize(nmerged + 1);
+        }
+        buf->mStiffBlocks.push_back(blocks);
+        buf->mPointShapes.push_back(shapes);
+    }
+    buf->mTrimModes = mDDPar->mTrimModes;
+    buf->mTrimTolerance = (Real)mDDPar->mTrimTolerance;
+    // node-local neighbours through a shared window
+    if (mDDPar->mSharedHalo) {
+        buf->mSharedHalo = new SharedHalo(mMsgInfo->mIProcComm, sizes);
+    }
+    // off-node neighbours through the node leaders
+    if (mDDPar->mAggregateHalo) {
+        buf->mAggregator = new HaloAggregator(mMsgInfo->mIProcComm, sizes);
+    }
     MessagingInfo *msg = new MessagingInfo(*mMsgInfo);
+    msg->mReqSend.clear();
+    msg->mReqRecv.clear();
+    std::vector<bool> direct;
+    for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+        direct.push_back(!(buf->mSharedHalo && buf->mSharedHalo->shared(i)) &&
+            !(buf->mAggregator && buf->mAggregator->aggregated(i)));
+        // a header per point if trimmed
+        int size = sizes[i] + (buf->mTrimModes ? mMsgInfo->mNLocalPoints[i] : 0);
+        buf->mBufferSend.push_back(CColX(direct[i] ? size : 0));
+        buf->mBufferRecv.push_back(CColX(direct[i] ? size : 0));
+    }
+    // persistent requests, freed by domain;
+    // trimmed messages vary in length and are sent by isend
+    for (int i = 0; i < msg->mNProcComm; i++) {
+        if (!direct[i]) {
+            continue;
+        }
+        msg->mReqSend.push_back(MPI_REQUEST_NULL);
+        msg->mReqRecv.push_back(MPI_Request());
+        if (!buf->mTrimModes) {
+            XMPI::sendInitComplex(msg->mIProcComm[i], buf->mBufferSend[i], msg->mReqSend.back(),
+                msg->mTag, msg->mComm);
+        }
+        XMPI::recvInitComplex(msg->mIProcComm[i], buf->mBufferRecv[i], msg->mReqRecv.back(),
+            msg->mTag, msg->mComm);
+    }
     domain.setMessaging(msg, buf);
     
+    // box injection, before the element groups leave out dormant elements
+    if (mBoxMode > 0) {
+        MultilevelTimer::begin("Box Injection", 2);
+        releaseBox(domain);
+        MultilevelTimer::end("Box Injection", 2);
+    }
+    
+    // boundary/interior element groups for overlapping and threading
+    domain.formElementGroups();
+    
     // set learn parameters
     domain.setLearnParameters(new LearnParameters(*mLearnPar));
+    domain.setNumNuWindows(mNrField->getNumNuWindows());
+    
+    // set balance parameters; the next run reads the weights from the cache
+    BalanceParameters *bpar = new BalanceParameters();
+    bpar->mInterval = mDDPar->mRebalanceInterval;
+    bpar->mThreshold = mDDPar->mRebalanceThreshold;
+    if (mDDPar->mCacheWeights) {
+        bpar->mFileName = mDDPar->mCacheFile;
+    }
+    bpar->mQuadTags = std::vector<int>(domain.getNumElements(), -1);
+    for (int iloc = 0; iloc < getNumQuads(); iloc++) {
+        bpar->mQuadTags[mQuads[iloc]->getElementTag()] = mQuads[iloc]->getQuadTag();
+    }
+    bpar->mNumQuads = mExModel->getNumQuads();
+    bpar->mReportInterval = mDDPar->mImbalanceInterval;
+    bpar->mReportFile = Parameters::sOutputDirectory + "/develop/imbalance.txt";
+    domain.setBalanceParameters(bpar);
+}
+
+bool Mesh::inBox(int quadTag) const {
+    const IRow4 &nodes = mExModel->getConnectivity(quadTag);
+    double s = 0., z = 0.;
+    for (int j = 0; j < 4; j++) {
+        s += mExModel->getNodalS(nodes(j)) * .25;
+        z += mExModel->getNodalZ(nodes(j)) * .25;
+    }
+    double r = std::sqrt(s * s + z * z);
+    double theta = std::atan2(s, z);
+    return r >= mBoxRange[0] && r <= mBoxRange[1] && 
+        theta >= mBoxRange[2] && theta <= mBoxRange[3];
+}
+
+void Mesh::releaseBox(Domain &domain) const {
+    // quads in the box and sides of the nodes, 1 inside and 2 outside
+    int nquad = mExModel->getNumQuads();
+    std::vector<bool> quadIn(nquad);
+    std::vector<int> nodeSide(mExModel->getNumNodes(), 0);
+    for (int iquad = 0; iquad < nquad; iquad++) {
+        quadIn[iquad] = inBox(iquad);
+        const IRow4 &nodes = mExModel->getConnectivity(iquad);
+        for (int j = 0; j < 4; j++) {
+            nodeSide[nodes(j)] |= quadIn[iquad] ? 1 : 2;
+        }
+    }
+    // quads of the nodes on both sides
+    std::map<int, std::vector<int>> boundaryNodeQuads;
+    for (int iquad = 0; iquad < nquad; iquad++) {
+        const IRow4 &nodes = mExModel->getConnectivity(iquad);
+        for (int j = 0; j < 4; j++) {
+            if (nodeSide[nodes(j)] == 3) {
+                boundaryNodeQuads[nodes(j)].push_back(iquad);
+            }
+        }
+    }
+    
+    // points of a quad on the boundary, with their keys; corners on the 
+    // boundary if their nodes are, and other edge points if the quad 
+    // across the edge is on the other side
+    auto boundaryPoints = [&](int quadTag, std::vector<std::pair<int, int>> &ijpols, 
+        std::vector<std::array<int, 3>> &keys) {
+        ijpols.clear();
+        keys.clear();
+        const IRow4 &nodes = mExModel->getConnectivity(quadTag);
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                bool iedge = ipol == 0 || ipol == nPol;
+                bool jedge = jpol == 0 || jpol == nPol;
+                if (!iedge && !jedge) {
+                    continue;
+                }
+                bool onBoundary = false;
+                if (iedge && jedge) {
+                    int inode = (ipol == 0) ? (jpol == 0 ? 0 : 3) : (jpol == 0 ? 1 : 2);
+                    onBoundary = nodeSide[nodes(inode)] == 3;
+                } else {
+                    // edges run from node i to node i + 1
+                    int iedge4 = (jpol == 0) ? 0 : (ipol == nPol ? 1 : (jpol == nPol ? 2 : 3));
+                    int node0 = nodes(iedge4);
+                    int node1 = nodes((iedge4 + 1) % 4);
+                    if (nodeSide[node0] == 3 && nodeSide[node1] == 3) {
+                        for (int iquad: boundaryNodeQuads.at(node0)) {
+                            if (iquad == quadTag || quadIn[iquad] == quadIn[quadTag]) {
+                                continue;
+                            }
+                            const IRow4 &other = mExModel->getConnectivity(iquad);
+                            if ((other.array() == node1).any()) {
+                                onBoundary = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (onBoundary) {
+                    ijpols.push_back(std::make_pair(ipol, jpol));
+                    keys.push_back(Connectivity::edgeKey(nodes, ipol, jpol));
+                }
+            }
+        }
+    };
+    
+    // number of ranks sharing each point
+    std::vector<int> nShared(domain.getNumPoints(), 1);
+    for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+        for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
+            nShared[mMsgInfo->mILocalPoints[i][j]]++;
+        }
+    }
+    
+    bool record = mBoxMode == 1;
+    BoxInjection *box = new BoxInjection(record, (record ? Parameters::sOutputDirectory : 
+        Parameters::sInputDirectory) + "/injection", mBoxBufferSize);
+    std::vector<bool> pointAdded(domain.getNumPoints(), false);
+    std::vector<std::pair<int, int>> ijpols;
+    std::vector<std::array<int, 3>> keys;
+    for (int iloc = 0; iloc < getNumQuads(); iloc++) {
+        int quadTag = mQuads[iloc]->getQuadTag();
+        int elemTag = mQuads[iloc]->getElementTag();
+        if (!record && !quadIn[quadTag]) {
+            box->addDormant(elemTag);
+        }
+        boundaryPoints(quadTag, ijpols, keys);
+        if (ijpols.size() == 0) {
+            continue;
+        }
+        if (record) {
+            // the stiffness from outside the box
+            if (quadIn[quadTag]) {
+                continue;
+            }
+            std::vector<int> ipnts;
+            for (const auto &ij: ijpols) {
+                ipnts.push_back(ij.first * nPntEdge + ij.second);
+            }
+            box->addTap(domain.getElement(elemTag), ipnts, keys);
+        } else {
+            // each point once, shared by all ranks with it
+            for (int k = 0; k < ijpols.size(); k++) {
+                int ip = mLocalElemToGLL[iloc](ijpols[k].first, ijpols[k].second);
+                if (pointAdded[ip]) {
+                    continue;
+                }
+                pointAdded[ip] = true;
+                box->addPoint(domain.getPoint(ip), keys[k], one / nShared[ip]);
+            }
+        }
+    }
+    
+    int nquadIn = 0;
+    for (int iquad = 0; iquad < nquad; iquad++) {
+        nquadIn += (int)quadIn[iquad];
+    }
+    std::stringstream ss;
+    ss << "\n======================= Box Injection =======================" << std::endl;
+    ss << "  Mode                    =   " << (record ? "record" : "inject") << std::endl;
+    ss << "  Radius Range (km)       =   " << mBoxRange[0] / 1e3 << " ~ " << mBoxRange[1] / 1e3 << std::endl;
+    ss << "  Distance Range (deg)    =   " << mBoxRange[2] / degree << " ~ " << mBoxRange[3] / degree << std::endl;
+    ss << "  Elements in Box         =   " << nquadIn << " / " << nquad << std::endl;
+    if (record) {
+        ss << "  Elements Tapped         =   " << XMPI::sum(box->getNumTaps()) << std::endl;
+    } else {
+        ss << "  Boundary Points         =   " << XMPI::sum(box->getNumPoints()) << std::endl;
+        ss << "  Dormant Elements        =   " << XMPI::sum(box->getNumDormant()) << std::endl;
+    }
+    ss << "======================= Box Injection =======================\n" << std::endl;
+    XMPI::cout << ss.str();
+    if (nquadIn == 0 || nquadIn == nquad) {
+        delete box;
+        throw std::runtime_error("Mesh::releaseBox || "
+            "BOX_INJECTION_REGION contains no element or all elements.");
+    }
+    domain.setBoxInjection(box);
+}
+
+void Mesh::findQuads(double s, double z, std::vector<int> &locs) const {
+    if (mQuadIndex) {
+        mQuadIndex->query(s, z, locs);
+    } else {
+        locs.clear();
+    }
 }
 
 double Mesh::computeRadiusRef(double depth, double lat, double lon) const {
@@ -236,11 +729,15 @@ double Mesh::computeRadiusRef(double depth, double lat, double lon) const {
     double R = computeRPhysical(router, theta, phi) - depth;
     double distTol = std::min((double)tinySingle, mExModel->getDistTolerance() * tinySingle);
     
-    // computeRPhysical is monotonically increasing, so we use Divide-and-Conquer method
-    // initial guess = router - depth
+    // computeRPhysical is monotonically increasing, so the root is bracketed;
+    // secant steps converge in a few iterations because the undulations vary 
+    // slowly with r, with bisection whenever a step leaves the bracket
+    // initial guess = router - depth, with unit slope for the first step
     double current = router - depth;
     double upper = router;
     double lower = 0.;
+    double previous = current;
+    double diffPrevious = 0.;
     int maxIter = 10000;
     int iter = 0;
     while (iter++ <= maxIter) {
@@ -253,7 +750,16 @@ double Mesh::computeRadiusRef(double depth, double lat, double lon) const {
         } else {
             lower = current;
         }
-        current = .5 * (lower + upper);
+        double slope = 1.;
+        if (iter > 1 && current != previous) {
+            slope = (diff - diffPrevious) / (current - previous);
+        }
+        previous = current;
+        diffPrevious = diff;
+        current -= diff / slope;
+        if (!(slope > 0.) || !(current > lower && current < upper)) {
+            current = .5 * (lower + upper);
+        }
     }
     throw std::runtime_error("Mesh::computeRadiusRef || Failed to find reference radius.");
 }
@@ -266,8 +772,38 @@ double Mesh::computeRPhysical(double r, double theta, double phi) const {
     return r + deltaR;
 }
 
+void Mesh::computeLocalRange(double &rMin, double &rMax, 
+    double &distMin, double &distMax) const {
+    // the box of (s, z) spanned by the local quads, with s >= 0
+    rMax = 0.;
+    distMin = pi;
+    distMax = 0.;
+    for (double s: {mSMin, mSMax}) {
+        for (double z: {mZMin, mZMax}) {
+            double r = sqrt(s * s + z * z);
+            double dist = atan2(s, z);
+            rMax = std::max(rMax, r);
+            distMin = std::min(distMin, dist);
+            distMax = std::max(distMax, dist);
+        }
+    }
+    // closest point of the box to the centre
+    double sNear = std::max(mSMin, 0.);
+    double zNear = std::min(std::max(0., mZMin), mZMax);
+    rMin = sqrt(sNear * sNear + zNear * zNear);
+    if (rMin < tinyDouble) {
+        distMin = 0.;
+        distMax = pi;
+    }
+}
+
 // # include "NetCDF_Writer.h"
 void Mesh::buildLocal(const DecomposeOption &option) {
+    // quads of a previous build are migrated to the new partition
+    std::vector<Quad *> quadsBuilt;
+    quadsBuilt.swap(mQuads);
+    bool migrate = XMPI::sum((int)quadsBuilt.size()) > 0;
+    
     // destroy existent
     destroy();
     
@@ -293,27 +829,104 @@ void Mesh::buildLocal(const DecomposeOption &option) {
     double s_max, s_min, z_max, z_min;
     mSMax = mZMax = -1e30;
     mSMin = mZMin = 1e30;
-    mQuads.reserve(mLocalElemToGLL.size());
+    std::vector<int> quadTags;
     for (int iquad = 0; iquad < mExModel->getNumQuads(); iquad++) {
         if (procMask(iquad)) {
-            // 1D Quad
-            Quad *quad = new Quad(*mExModel, iquad, *mNrField);
-            // 3D model
-            quad->addVolumetric3D(mVolumetric3D, mSrcLat, mSrcLon, mSrcDep, mPhi2D);
-            quad->addGeometric3D(mGeometric3D, mSrcLat, mSrcLon, mSrcDep, mPhi2D);
+            quadTags.push_back(iquad);
+        }
+    }
+    if (mDDPar->mLocalOrder) {
+        MultilevelTimer::begin("Order Quads", 3);
+        orderLocal(quadTags);
+        MultilevelTimer::end("Order Quads", 3);
+    }
+    // results of the 3D models from the previous build
+    std::vector<double> migrated;
+    std::map<int, std::pair<size_t, size_t>> migratedRanges;
+    if (migrate) {
+        MultilevelTimer::begin("Migrate Quads", 3);
+        migrateQuads(quadsBuilt, procMask, migrated, migratedRanges);
+        MultilevelTimer::end("Migrate Quads", 3);
+    }
+    
+    // quads are independent, and the 3D models are thread-safe
+    int nquad = quadTags.size();
+    mQuads = std::vector<Quad *>(nquad, 0);
+    PreloopFFTW::initThreads(XOMP::nThreads());
+    std::string error = "";
+    // 1D Quad
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int iloc = 0; iloc < nquad; iloc++) {
+        try {
+            mQuads[iloc] = new Quad(*mExModel, quadTags[iloc], *mNrField);
+        } catch (const std::exception &e) {
+            // exceptions must not leave a parallel region
+            #ifdef _USE_OPENMP
+                #pragma omp critical(Mesh_buildLocal)
+            #endif
+            if (error == "") {
+                error = e.what();
+            }
+        }
+    }
+    if (error != "") {
+        throw std::runtime_error(error);
+    }
+    
+    // spatial range and index
+    mQuadIndex = new QuadIndex(mQuads);
+    for (const auto &quad: mQuads) {
+        quad->getSpatialRange(s_max, s_min, z_max, z_min);
+        mSMax = std::max(mSMax, s_max);
+        mSMin = std::min(mSMin, s_min);
+        mZMax = std::max(mZMax, z_max);
+        mZMin = std::min(mZMin, z_min);
+    }
+    
+    // models may restrict their data to the local range
+    if (nquad > 0) {
+        double rMin, rMax, distMin, distMax;
+        computeLocalRange(rMin, rMax, distMin, distMax);
+        for (const auto &m3D: mVolumetric3D) {
+            m3D->setLocalRange(rMin, rMax, distMin, distMax, mSrcLat, mSrcLon, mSrcDep);
+        }
+    }
+    
+    // 3D models
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int iloc = 0; iloc < nquad; iloc++) {
+        try {
+            Quad *quad = mQuads[iloc];
+            auto it = migratedRanges.find(quadTags[iloc]);
+            if (it != migratedRanges.end()) {
+                PackedBuffer buf(migrated.data() + it->second.first, it->second.second);
+                quad->sync3D(buf);
+                continue;
+            }
+            quad->addVolumetric3D(mVolumetric3D, mSrcLat, mSrcLon, mSrcDep, mPhi2D, mDemoteTol3D,
+                mFourierOrder3D, mFourierTol3D);
+            quad->addGeometric3D(mGeometric3D, mSrcLat, mSrcLon, mSrcDep, mPhi2D, 
+                mDemoteTolUndulation);
             if (mOceanLoad3D != 0) {
                 quad->setOceanLoad3D(*mOceanLoad3D, mSrcLat, mSrcLon, mSrcDep, mPhi2D);
-            }    
-            // spatial range
-            quad->getSpatialRange(s_max, s_min, z_max, z_min);
-            mSMax = std::max(mSMax, s_max);
-            mSMin = std::min(mSMin, s_min);
-            mZMax = std::max(mZMax, z_max);
-            mZMin = std::min(mZMin, z_min);
-            // add to local build
-            mQuads.push_back(quad);
+            }
+        } catch (const std::exception &e) {
+            // exceptions must not leave a parallel region
+            #ifdef _USE_OPENMP
+                #pragma omp critical(Mesh_buildLocal)
+            #endif
+            if (error == "") {
+                error = e.what();
+            }
         }
     }
+    if (error != "") {
+        throw std::runtime_error(error);
+    }
     MultilevelTimer::end("Generate Quads", 2);
     
     // setup GLL points
@@ -338,38 +951,35 @@ void Mesh::buildLocal(const DecomposeOption &option) {
     
     /////////////////////////////// assemble mass and normal ///////////////////////////////
     MultilevelTimer::begin("Assemble Mass", 2);
-    // mpi buffer
-    std::vector<RDMatXX> bufferGLLSend;
-    std::vector<RDMatXX> bufferGLLRecv;
+    // mpi buffer, packed point by point with only the nonzero fields;
+    // the length of a received message is bounded by the nr of its points
+    std::vector<RDColX> bufferGLLSend;
+    std::vector<RDColX> bufferGLLRecv;
     for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
-        int nr_max = -1;
-        int npoint = mMsgInfo->mNLocalPoints[i];
-        for (int j = 0; j < npoint; j++) {
-            int pTag = mMsgInfo->mILocalPoints[i][j];
-            int nr = mGLLPoints[pTag]->getNr();
-            nr_max = std::max(nr, nr_max);
-        }
-        // nr_max for solid mass
-        // nr_max for fluid mass
-        // nr_max * 3 for surface normal
-        // nr_max * 3 for solid-fluid normal
-        // 1 for reference count
-        bufferGLLSend.push_back(RDMatXX::Zero(nr_max * 8 + 1, npoint));
-        bufferGLLRecv.push_back(RDMatXX::Zero(nr_max * 8 + 1, npoint));
+        int sizeSend = 0;
+        int sizeRecv = 0;
+        for (int pTag: mMsgInfo->mILocalPoints[i]) {
+            sizeSend += mGLLPoints[pTag]->sizeBuffer();
+            sizeRecv += GLLPoint::sizeBufferMax(mGLLPoints[pTag]->getNr());
+        }
+        bufferGLLSend.push_back(RDColX(sizeSend));
+        bufferGLLRecv.push_back(RDColX(sizeRecv));
     }    
     
     // feed buffer
     for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
-        for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
-            int pTag = mMsgInfo->mILocalPoints[i][j];
-            mGLLPoints[pTag]->feedBuffer(bufferGLLSend[i], j);
+        int row = 0;
+        for (int pTag: mMsgInfo->mILocalPoints[i]) {
+            row += mGLLPoints[pTag]->feedBuffer(bufferGLLSend[i].data() + row);
         }
     }
     
     // send and recv
     for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
-        XMPI::isendDouble(mMsgInfo->mIProcComm[i], bufferGLLSend[i], mMsgInfo->mReqSend[i]);
-        XMPI::irecvDouble(mMsgInfo->mIProcComm[i], bufferGLLRecv[i], mMsgInfo->mReqRecv[i]);
+        XMPI::isendDouble(mMsgInfo->mIProcComm[i], bufferGLLSend[i], mMsgInfo->mReqSend[i],
+            mMsgInfo->mTag, mMsgInfo->mComm);
+        XMPI::irecvDouble(mMsgInfo->mIProcComm[i], bufferGLLRecv[i], mMsgInfo->mReqRecv[i],
+            mMsgInfo->mTag, mMsgInfo->mComm);
     }
     
     // wait recv
@@ -377,9 +987,9 @@ void Mesh::buildLocal(const DecomposeOption &option) {
     
     // extract buffer 
     for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
-        for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
-            int pTag = mMsgInfo->mILocalPoints[i][j];
-            mGLLPoints[pTag]->extractBuffer(bufferGLLRecv[i], j);
+        int row = 0;
+        for (int pTag: mMsgInfo->mILocalPoints[i]) {
+            row += mGLLPoints[pTag]->extractBuffer(bufferGLLRecv[i].data() + row);
         }
     }
     
@@ -389,6 +999,115 @@ void Mesh::buildLocal(const DecomposeOption &option) {
     MultilevelTimer::end("Assemble Mass", 2);
 }
 
+void Mesh::orderLocal(std::vector<int> &quadTags) {
+    // centres of the quads
+    int nquad = quadTags.size();
+    if (nquad == 0) {
+        return;
+    }
+    std::vector<RDCol2> centres(nquad);
+    RDCol2 cmin = RDCol2::Constant(DBL_MAX);
+    RDCol2 cmax = RDCol2::Constant(-DBL_MAX);
+    for (int iloc = 0; iloc < nquad; iloc++) {
+        const IRow4 &nodes = mExModel->getConnectivity(quadTags[iloc]);
+        centres[iloc].setZero();
+        for (int j = 0; j < 4; j++) {
+            centres[iloc](0) += mExModel->getNodalS(nodes(j)) * .25;
+            centres[iloc](1) += mExModel->getNodalZ(nodes(j)) * .25;
+        }
+        cmin = cmin.cwiseMin(centres[iloc]);
+        cmax = cmax.cwiseMax(centres[iloc]);
+    }
+    
+    // Hilbert indices on a 2^16 grid over the local range, 
+    // with the same cell size in s and z
+    const int order = 16;
+    double cell = std::max((cmax - cmin).maxCoeff(), tinyDouble) / ((1 << order) - 1);
+    std::vector<std::pair<uint64_t, int>> keys(nquad);
+    for (int iloc = 0; iloc < nquad; iloc++) {
+        uint32_t x = (uint32_t)std::round((centres[iloc](0) - cmin(0)) / cell);
+        uint32_t y = (uint32_t)std::round((centres[iloc](1) - cmin(1)) / cell);
+        keys[iloc] = std::make_pair(XMath::hilbertIndex(x, y, order), iloc);
+    }
+    std::sort(keys.begin(), keys.end());
+    
+    // quads
+    std::vector<int> tags(nquad);
+    std::vector<IMatPP> elemToGLL(nquad);
+    for (int inew = 0; inew < nquad; inew++) {
+        tags[inew] = quadTags[keys[inew].second];
+        elemToGLL[inew] = mLocalElemToGLL[keys[inew].second];
+    }
+    quadTags.swap(tags);
+    mLocalElemToGLL.swap(elemToGLL);
+    
+    // points, by first touch
+    std::vector<int> pointOld2New(mGLLPoints.size(), -1);
+    int npoint = 0;
+    for (IMatPP &gll: mLocalElemToGLL) {
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                int &ip = pointOld2New[gll(ipol, jpol)];
+                if (ip < 0) {
+                    ip = npoint++;
+                }
+                gll(ipol, jpol) = ip;
+            }
+        }
+    }
+    if (npoint != mGLLPoints.size()) {
+        throw std::runtime_error("Mesh::orderLocal || "
+            "Local points not covered by the local quads.");
+    }
+    
+    // messaging keeps the order of the communicated points
+    for (std::vector<int> &points: mMsgInfo->mILocalPoints) {
+        for (int &ip: points) {
+            ip = pointOld2New[ip];
+        }
+    }
+}
+
+void Mesh::migrateQuads(std::vector<Quad *> &quadsBuilt, const IColX &procMask, 
+    std::vector<double> &migrated, std::map<int, std::pair<size_t, size_t>> &ranges) const {
+    // new rank of each quad
+    IColX elemToProc = procMask * (XMPI::rank() + 1);
+    XMPI::sumEigenInt(elemToProc);
+    elemToProc.array() -= 1;
+    
+    // pack quad tag, length and 3D results for the new owner
+    std::vector<std::vector<double>> send(XMPI::nproc());
+    for (const auto &quad: quadsBuilt) {
+        PackedBuffer buf;
+        quad->sync3D(buf);
+        std::vector<double> &dest = send[elemToProc(quad->getQuadTag())];
+        dest.push_back(quad->getQuadTag());
+        dest.push_back(buf.getPacked().size());
+        dest.insert(dest.end(), buf.getPacked().begin(), buf.getPacked().end());
+        delete quad;
+    }
+    quadsBuilt.clear();
+    
+    // exchange
+    std::vector<std::vector<double>> recv;
+    XMPI::alltoall(send, recv, MPI_DOUBLE);
+    std::vector<std::vector<double>>().swap(send);
+    
+    // ranges of the quads in one buffer
+    migrated.clear();
+    for (const auto &part: recv) {
+        migrated.insert(migrated.end(), part.begin(), part.end());
+    }
+    std::vector<std::vector<double>>().swap(recv);
+    size_t pos = 0;
+    while (pos < migrated.size()) {
+        int quadTag = (int)migrated[pos];
+        size_t size = (size_t)migrated[pos + 1];
+        ranges.insert(std::make_pair(quadTag, std::make_pair(pos + 2, size)));
+        pos += 2 + size;
+    }
+}
+
 void Mesh::destroy() {
     // points
     for (const auto &point: mGLLPoints) {
@@ -407,12 +1126,23 @@ void Mesh::destroy() {
         delete mMsgInfo;
         mMsgInfo = 0;
     }
+    // quad index
+    if (mQuadIndex) {
+        delete mQuadIndex;
+        mQuadIndex = 0;
+    }
 }
 
 void Mesh::measure(DecomposeOption &measured) {
-    // a temp Domain
-    Domain domain;
-    release(domain);
+    // a temp Domain, unless sampled, with which an element or a point is
+    // built with its points in a scratch domain and dropped after timing, 
+    // so that no more than one element lives at a time
+    bool sampled = mDDPar->mSampledMeasure;
+    Domain *domain = 0;
+    if (!sampled) {
+        domain = new Domain();
+        release(*domain);
+    }
     
     // user clock resolution
     double clockFactor = 1e4;
@@ -422,41 +1152,93 @@ void Mesh::measure(DecomposeOption &measured) {
     // how may elements of the same kind will be measured
     int nMeasureSameKind = 3;
     
+    // signatures in the cost model are not measured
+    std::map<std::string, double> elemCostModel, pointCostModel;
+    if (mDDPar->mCostModel) {
+        readCostModel(elemCostModel, pointCostModel);
+    }
+    
+    // nor are those estimated from their class or kind in the model, 
+    // which are not added to it; -1 if not estimated
+    auto estimate = [this](const std::map<std::string, double> &model, 
+        const std::string &signature) -> double {
+        if (!mDDPar->mEstimateCosts || model.find(signature) != model.end()) {
+            return -1.;
+        }
+        size_t posNr = signature.find("$DimAzimuth=");
+        if (posNr == std::string::npos) {
+            return -1.;
+        }
+        int nr = atoi(signature.c_str() + posNr + 12);
+        double perMode = costPerMode(model, signature.substr(0, posNr));
+        if (perMode < 0.) {
+            perMode = costPerMode(model, signature.substr(0, signature.find("$")));
+        }
+        return perMode < 0. ? -1. : perMode * (nr / 2 + 1);
+    };
+    
     ////////// measure elements //////////
     MultilevelTimer::begin("Measure Elements", 2);
     // initialize with zero weights
     int nElemGlobal = mExModel->getNumQuads();
     RDColX eWgtEle = RDColX::Zero(nElemGlobal);
-    // create library
+    // create library; the first element of a signature decides the steps,
+    // and the minimum of it and the next few of the kind is taken
     std::map<std::string, double> elemCostLibrary;
+    std::map<std::string, std::pair<int, int>> elemTiming;
+    // signatures of the local elements
+    std::vector<std::string> elemKinds;
+    std::map<std::string, int> elemKindIndex;
+    std::vector<int> elemKind(getNumQuads());
     for (int iloc = 0; iloc < getNumQuads(); iloc++) {
-        int elemTag = mQuads[iloc]->getElementTag();
-        Element *elem = domain.getElement(elemTag);
+        Domain *scratch = 0;
+        Element *elem = 0;
+        if (sampled) {
+            scratch = new Domain();
+            IMatPP pointTags;
+            for (int ipol = 0; ipol <= nPol; ipol++) {
+                for (int jpol = 0; jpol <= nPol; jpol++) {
+                    const GLLPoint *point = mGLLPoints[mLocalElemToGLL[iloc](ipol, jpol)];
+                    pointTags(ipol, jpol) = point->release(*scratch, mFourierOrder3D, mFourierTol3D);
+                }
+            }
+            elem = mQuads[iloc]->createElement(*scratch, pointTags, mAttBuilder);
+            scratch->addElement(elem);
+        } else {
+            elem = domain->getElement(mQuads[iloc]->getElementTag());
+        }
         // get cost signature
         std::string coststr = elem->costSignature();
+        auto itKind = elemKindIndex.insert(std::make_pair(coststr, (int)elemKinds.size()));
+        if (itKind.second) {
+            elemKinds.push_back(coststr);
+        }
+        elemKind[iloc] = itKind.first->second;
         // insert to library
-        elemCostLibrary.insert(std::pair<std::string, double>(coststr, -1.));
-        // perform measurement only if it is new (measure = -1.)
-        if (elemCostLibrary.at(coststr) < 0.) {
-            // find how may steps are needed to use USER clock
-            double wall = elem->measure(minStep);
-            int nstep = std::max(minStep, (int)(clockResolution * clockFactor / wall) + 1);
-            elemCostLibrary.at(coststr) = elem->measure(nstep);
-            // find elements with the same signature
-            int sameKindFound = 0;
-            for (int jloc = iloc + 1; jloc < getNumQuads(); jloc++) {
-                int elemTagOther = mQuads[jloc]->getElementTag();
-                Element *elemOther = domain.getElement(elemTagOther);
-                if (elemOther->costSignature() == coststr) {
-                    // use minimum
-                    elemCostLibrary.at(coststr) = std::min(elemOther->measure(nstep), 
-                        elemCostLibrary.at(coststr));
-                    if (++sameKindFound == nMeasureSameKind) {
-                        break;
-                    }
-                }
+        auto itLib = elemCostLibrary.find(coststr);
+        if (itLib == elemCostLibrary.end()) {
+            auto itModel = elemCostModel.find(coststr);
+            double cost = itModel == elemCostModel.end() ? estimate(elemCostModel, coststr) : itModel->second;
+            // perform measurement only if it is new (measure = -1.)
+            if (cost < 0.) {
+                // find how may steps are needed to use USER clock
+                double wall = elem->measure(minStep);
+                int nstep = std::max(minStep, (int)(clockResolution * clockFactor / wall) + 1);
+                cost = elem->measure(nstep);
+                elemTiming.insert(std::make_pair(coststr, std::make_pair(nstep, nMeasureSameKind)));
+            }
+            elemCostLibrary.insert(std::make_pair(coststr, cost));
+        } else {
+            // elements with the same signature, using minimum
+            auto itTiming = elemTiming.find(coststr);
+            if (itTiming != elemTiming.end() && itTiming->second.second > 0) {
+                itLib->second = std::min(elem->measure(itTiming->second.first), itLib->second);
+                itTiming->second.second--;
             }
         }
+        if (scratch) {
+            delete scratch;
+        }
     }
     MultilevelTimer::end("Measure Elements", 2);
     
@@ -475,19 +1257,25 @@ void Mesh::measure(DecomposeOption &measured) {
     }
     // read library
     for (int iloc = 0; iloc < getNumQuads(); iloc++) {
-        int elemTag = mQuads[iloc]->getElementTag();
-        Element *elem = domain.getElement(elemTag);
-        // read library
-        double measure = elemCostLibraryGlobal.at(elem->costSignature());
+        double measure = elemCostLibraryGlobal.at(elemKinds[elemKind[iloc]]);
         // assign to element
         int quadTag = mQuads[iloc]->getQuadTag();
         eWgtEle(quadTag) = measure;
     }
+    // elements outside the box are not computed in inject mode
+    if (mBoxMode == 2) {
+        for (int iloc = 0; iloc < getNumQuads(); iloc++) {
+            int quadTag = mQuads[iloc]->getQuadTag();
+            if (!inBox(quadTag)) {
+                eWgtEle(quadTag) = 0.;
+            }
+        }
+    }
     // sum up
     XMPI::sumEigenDouble(eWgtEle);
     MultilevelTimer::end("Bcast Element Costs", 2);
     
-
+    
     ////////// measure points //////////
     MultilevelTimer::begin("Measure Points", 2);
     // initialize with zero weights
@@ -495,31 +1283,51 @@ void Mesh::measure(DecomposeOption &measured) {
     RDColX pWgt = RDColX::Zero(ngll);
     // create library
     std::map<std::string, double> pointCostLibrary;
+    std::map<std::string, std::pair<int, int>> pointTiming;
+    std::vector<std::string> pointKinds;
+    std::map<std::string, int> pointKindIndex;
+    std::vector<int> pointKind(ngll);
     for (int ip = 0; ip < ngll; ip++) {
-        Point *point = domain.getPoint(ip);
+        Domain *scratch = 0;
+        Point *point = 0;
+        if (sampled) {
+            scratch = new Domain();
+            point = scratch->getPoint(mGLLPoints[ip]->release(*scratch, mFourierOrder3D, mFourierTol3D));
+        } else {
+            point = domain->getPoint(ip);
+        }
         // get cost signature
         std::string coststr = point->costSignature();
+        auto itKind = pointKindIndex.insert(std::make_pair(coststr, (int)pointKinds.size()));
+        if (itKind.second) {
+            pointKinds.push_back(coststr);
+        }
+        pointKind[ip] = itKind.first->second;
         // insert to library
-        pointCostLibrary.insert(std::pair<std::string, double>(coststr, -1.));
-        // perform measurement only if it is new (measure = -1.)
-        if (pointCostLibrary.at(coststr) < 0.) {
-            // find how may steps are needed to use USER clock
-            double wall = point->measure(minStep);
-            int nstep = std::max(minStep, (int)(clockResolution * clockFactor / 10. / wall) + 1);
-            pointCostLibrary.at(coststr) = point->measure(nstep);
-            // find points with the same signature
-            int sameKindFound = 0;
-            for (int jp = ip + 1; jp < ngll; jp++) {
-                Point *pointOther = domain.getPoint(jp);
-                if (pointOther->costSignature() == coststr) {
-                    pointCostLibrary.at(coststr) = std::min(pointOther->measure(nstep),
-                        pointCostLibrary.at(coststr));
-                    if (++sameKindFound == nMeasureSameKind) {
-                        break;
-                    }
-                }
+        auto itLib = pointCostLibrary.find(coststr);
+        if (itLib == pointCostLibrary.end()) {
+            auto itModel = pointCostModel.find(coststr);
+            double cost = itModel == pointCostModel.end() ? estimate(pointCostModel, coststr) : itModel->second;
+            // perform measurement only if it is new (measure = -1.)
+            if (cost < 0.) {
+                // find how may steps are needed to use USER clock
+                double wall = point->measure(minStep);
+                int nstep = std::max(minStep, (int)(clockResolution * clockFactor / 10. / wall) + 1);
+                cost = point->measure(nstep);
+                pointTiming.insert(std::make_pair(coststr, std::make_pair(nstep, nMeasureSameKind)));
+            }
+            pointCostLibrary.insert(std::make_pair(coststr, cost));
+        } else {
+            // points with the same signature, using minimum
+            auto itTiming = pointTiming.find(coststr);
+            if (itTiming != pointTiming.end() && itTiming->second.second > 0) {
+                itLib->second = std::min(point->measure(itTiming->second.first), itLib->second);
+                itTiming->second.second--;
             }
         }
+        if (scratch) {
+            delete scratch;
+        }
     }
     MultilevelTimer::end("Measure Points", 2);
     
@@ -538,11 +1346,30 @@ void Mesh::measure(DecomposeOption &measured) {
     }
     // read library
     for (int ip = 0; ip < ngll; ip++) {
-        Point *point = domain.getPoint(ip);
-        pWgt(ip) = pointCostLibraryGlobal.at(point->costSignature());
+        pWgt(ip) = pointCostLibraryGlobal.at(pointKinds[pointKind[ip]]);
     }
     MultilevelTimer::end("Bcast Point Costs", 2);
     
+    // add new measured signatures to the cost model
+    if (mDDPar->mCostModel) {
+        std::map<std::string, double> elemCostNew = elemCostModel;
+        std::map<std::string, double> pointCostNew = pointCostModel;
+        for (auto it = elemCostLibraryGlobal.begin(); it != elemCostLibraryGlobal.end(); it++) {
+            if (estimate(elemCostModel, it->first) < 0.) {
+                elemCostNew.insert(*it);
+            }
+        }
+        for (auto it = pointCostLibraryGlobal.begin(); it != pointCostLibraryGlobal.end(); it++) {
+            if (estimate(pointCostModel, it->first) < 0.) {
+                pointCostNew.insert(*it);
+            }
+        }
+        if (elemCostNew.size() > elemCostModel.size() || 
+            pointCostNew.size() > pointCostModel.size()) {
+            writeCostModel(elemCostNew, pointCostNew);
+        }
+    }
+    
     // report
     MultilevelTimer::begin("Report Measurements", 2);
     if (XMPI::root() && mDDPar->mReportMeasure) {
@@ -580,11 +1407,163 @@ void Mesh::measure(DecomposeOption &measured) {
     
     // plot 
     MultilevelTimer::begin("Plot during Cost Measurements", 2);
+    std::vector<std::string> elemTypes;
+    if (mSlicePlots.size() > 0) {
+        for (int iloc = 0; iloc < getNumQuads(); iloc++) {
+            const std::string &coststr = elemKinds[elemKind[iloc]];
+            elemTypes.push_back(coststr.substr(0, coststr.find("$DimAzimuth=")));
+        }
+    }
     for (const auto &sp: mSlicePlots) {
-        sp->plotEleType(domain);
+        sp->plotEleType(elemTypes);
         sp->plotMeasured(measured.mElemWeights);
     }
     MultilevelTimer::end("Plot during Cost Measurements", 2);    
+    
+    if (domain) {
+        delete domain;
+    }
+}
+
+void Mesh::formCommWeights(DecomposeOption &option) const {
+    // Fourier coefficients times components of a point, with the element 
+    // Nr as the maximum at its nodes, as in Point::sizeComm
+    int nElemGlobal = mExModel->getNumQuads(); 
+    option.mCommWeights = RDColX::Zero(nElemGlobal);
+    for (int iquad = 0; iquad < nElemGlobal; iquad++) {
+        int nr = 1;
+        for (int j = 0; j < 4; j++) {
+            int inode = mExModel->getConnectivity()(iquad, j);
+            RDCol2 sz;
+            sz(0) = mExModel->getNodalS(inode);
+            sz(1) = mExModel->getNodalZ(inode);
+            nr = std::max(nr, mNrField->getNrAtPoint(sz));
+        }
+        bool fluid = mExModel->getElementalVariables("fluid", iquad) > .5;
+        option.mCommWeights(iquad) = (nr / 2 + 1) * (fluid ? 1. : 3.);
+    }
+}
+
+void Mesh::predictMemory(std::map<std::string, double> &bytes) const {
+    double &bytesPoints = bytes["Points"];
+    for (const auto &point: mGLLPoints) {
+        bytesPoints += point->predictBytes();
+    }
+    double &bytesElems = bytes["Elements"];
+    for (const auto &quad: mQuads) {
+        bytesElems += quad->predictBytes(mAttBuilder);
+    }
+    // send and recv buffers of each neighbour
+    double &bytesMsg = bytes["Messaging"];
+    for (int i = 0; i < mMsgInfo->mNProcComm; i++) {
+        int size = 0;
+        for (int j = 0; j < mMsgInfo->mNLocalPoints[i]; j++) {
+            size += mGLLPoints[mMsgInfo->mILocalPoints[i][j]]->predictSizeComm();
+        }
+        bytesMsg += 2. * size * sizeof(Complex);
+    }
+    // FFT buffers and element workspaces, already allocated
+    Domain::memoryBytesStatic(bytes);
+}
+
+std::string Mesh::reportPlan(int nStep, int nStage, double budgetMB) const {
+    // seconds per step of this rank, the slowest rank paces the step
+    double local = 0.;
+    for (const auto &quad: mQuads) {
+        local += mElemWeights(quad->getQuadTag()) * nStage;
+    }
+    std::vector<double> all_local;
+    XMPI::gather(local, all_local, true);
+    int nproc = all_local.size();
+    double stepMax = *std::max_element(all_local.begin(), all_local.end());
+    double stepTotal = 0.;
+    for (double sec: all_local) {
+        stepTotal += sec;
+    }
+    double imbalance = stepTotal > 0. ? stepMax * nproc / stepTotal : 1.;
+    // no partition is finer than its most costly element
+    double stepElem = mElemWeights.size() > 0 ? mElemWeights.maxCoeff() * nStage : 0.;
+    
+    // memory, the static part being the same on any number of processors
+    std::map<std::string, double> bytes, bytesStatic;
+    predictMemory(bytes);
+    Domain::memoryBytesStatic(bytesStatic);
+    double memMax = 0.;
+    std::string memReport = Domain::reportMemory(bytes, 
+        "----------------------------- PREDICTED MEMORY FOOTPRINT BY SUBSYSTEM -----------------------------", 
+        memMax);
+    double memStatic = 0.;
+    for (auto it = bytesStatic.begin(); it != bytesStatic.end(); it++) {
+        memStatic += it->second / 1024. / 1024.;
+    }
+    memStatic = XMPI::max(memStatic);
+    double memLocal = std::max(memMax - memStatic, 0.) * nproc;
+    if (!XMPI::root()) {
+        return "";
+    }
+    
+    // on p processors, the load and memory of the decomposed part scale by 
+    // nproc / p with the imbalance of this run
+    auto stepAt = [&](int p) {return std::max(stepTotal / p * imbalance, stepElem);};
+    auto memAt = [&](int p) {return memStatic + memLocal / p;};
+    int procMin = 1;
+    if (budgetMB > 0.) {
+        procMin = budgetMB > memStatic ? 
+            std::max((int)std::ceil(memLocal / (budgetMB - memStatic)), 1) : -1;
+    }
+    int procMax = stepElem > 0. ? std::max((int)(stepTotal / stepElem), 1) : nproc;
+    
+    std::stringstream ss;
+    ss << memReport;
+    ss << "\n------------------------------------------- RUN PLAN -------------------------------------------" << std::endl;
+    ss << "  Time steps                          =   " << nStep << std::endl;
+    ss << "  Stiffness evaluations per step      =   " << nStage << std::endl;
+    ss << "  Seconds per step                    =   " << stepMax << std::endl;
+    ss << "  Load imbalance (max / mean)         =   " << imbalance << std::endl;
+    ss << "  Predicted wall time (hours)         =   " << stepMax * nStep / 3600. << std::endl;
+    ss << "  Predicted core hours                =   " << stepMax * nStep * nproc / 3600. << std::endl;
+    ss << "  Most costly element (s per step)    =   " << stepElem << std::endl;
+    ss << "  Max. memory per processor (MB)      =   " << memMax << std::endl;
+    ss.precision(4);
+    ss << "\n  NPROC       STEP(s)      WALL(h)      MEMORY(MB)   EFFICIENCY" << std::endl;
+    // powers of two up to the granularity limit, and this run
+    std::vector<int> procs;
+    for (int p = 1; p / 2 <= procMax && p > 0; p *= 2) {
+        procs.push_back(p);
+    }
+    procs.push_back(nproc);
+    std::sort(procs.begin(), procs.end());
+    procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+    int procBest = -1;
+    for (int p: procs) {
+        // the fraction of the step spent on the balanced load
+        double eff = stepTotal / p * imbalance / stepAt(p);
+        bool fits = procMin > 0 && p >= procMin;
+        if (fits && eff > .8) {
+            procBest = p;
+        }
+        ss << "  " << std::setw(12) << std::left << p;
+        ss << std::setw(13) << std::left << stepAt(p);
+        ss << std::setw(13) << std::left << stepAt(p) * nStep / 3600.;
+        ss << std::setw(13) << std::left << memAt(p);
+        ss << std::setw(10) << std::left << eff;
+        ss << (p == nproc ? "(this run)" : "") << (fits ? "" : "(over budget)") << std::endl;
+    }
+    ss << std::endl;
+    if (procMin < 0) {
+        ss << "  The static memory of " << memStatic << " MB per processor exceeds "
+            "OPTION_MEMORY_BUDGET_MB." << std::endl;
+    } else {
+        ss << "  Min. number of processors by memory =   " << procMin << std::endl;
+    }
+    ss << "  Max. number of processors by load   =   " << procMax << std::endl;
+    if (procBest > 0) {
+        ss << "  Recommended number of processors    =   " << procBest << std::endl;
+    }
+    ss << "  Communication is not modelled; predictions on many more processors than " << std::endl;
+    ss << "  this run are lower bounds of the step time." << std::endl;
+    ss << "------------------------------------------------------------------------------------------------\n" << std::endl;
+    return ss.str();
 }
 
 void Mesh::test() {
@@ -594,10 +1573,159 @@ void Mesh::test() {
     domain.test();
 }
 
-Mesh::DDParameters::DDParameters(const Parameters &par) {
+bool Mesh::readWeights(const std::string &fname, RDColX &weights) const {
+    int found = 0;
+    if (XMPI::root()) {
+        std::ifstream fs(fname, std::ios::binary);
+        int size = 0;
+        fs.read(reinterpret_cast<char *>(&size), sizeof(int));
+        if (fs && size == mExModel->getNumQuads()) {
+            weights = RDColX::Zero(size);
+            fs.read(reinterpret_cast<char *>(weights.data()), size * sizeof(double));
+            found = fs ? 1 : 0;
+        }
+        fs.close();
+    }
+    XMPI::bcast(found);
+    if (found) {
+        XMPI::bcastEigen(weights);
+    }
+    return found;
+}
+
+void Mesh::writeWeights(const std::string &fname, const RDColX &weights) const {
+    if (XMPI::root()) {
+        std::ofstream fs(fname, std::ios::binary);
+        int size = weights.size();
+        fs.write(reinterpret_cast<const char *>(&size), sizeof(int));
+        fs.write(reinterpret_cast<const char *>(weights.data()), size * sizeof(double));
+        fs.close();
+    }
+}
+
+std::string Mesh::costModelFile() {
+    std::stringstream fname;
+    fname << fftwWisdomDirectory << "/cost_model.npol" << nPol;
+    #ifdef _USE_DOUBLE
+        fname << ".double";
+    #else
+        fname << ".float";
+    #endif
+    return fname.str();
+}
+
+void Mesh::readCostModel(std::map<std::string, double> &elemCosts, 
+    std::map<std::string, double> &pointCosts) const {
+    std::string model = "";
+    if (XMPI::root()) {
+        std::ifstream fs(costModelFile());
+        std::stringstream buffer;
+        if (fs) {
+            buffer << fs.rdbuf();
+            fs.close();
+        }
+        model = buffer.str();
+    }
+    XMPI::bcast(model);
+    
+    // line: E or P, cost, signature
+    elemCosts.clear();
+    pointCosts.clear();
+    std::stringstream ss(model);
+    std::string line;
+    while (std::getline(ss, line)) {
+        std::stringstream ls(line);
+        std::string kind, signature;
+        double cost;
+        if (!(ls >> kind >> cost) || !std::getline(ls >> std::ws, signature)) {
+            continue;
+        }
+        if (kind == "E") {
+            elemCosts[signature] = cost;
+        } else if (kind == "P") {
+            pointCosts[signature] = cost;
+        }
+    }
+}
+
+void Mesh::writeCostModel(const std::map<std::string, double> &elemCosts, 
+    const std::map<std::string, double> &pointCosts) const {
+    if (XMPI::root()) {
+        XMPI::mkdir(fftwWisdomDirectory);
+        std::ofstream fs(costModelFile());
+        if (!fs) {
+            throw std::runtime_error("Mesh::writeCostModel || "
+                "Error creating cost model file: || " + costModelFile());
+        }
+        fs.precision(10);
+        for (auto it = elemCosts.begin(); it != elemCosts.end(); it++) {
+            fs << "E " << it->second << " " << it->first << std::endl;
+        }
+        for (auto it = pointCosts.begin(); it != pointCosts.end(); it++) {
+            fs << "P " << it->second << " " << it->first << std::endl;
+        }
+        fs.close();
+    }
+}
+
+double Mesh::costPerMode(const std::map<std::string, double> &costs, 
+    const std::string &classOrKind) {
+    // ratio of the sums, weighting the signatures by their modes
+    double sumCost = 0.;
+    double sumModes = 0.;
+    bool isKind = classOrKind.find("$") == std::string::npos;
+    for (auto it = costs.begin(); it != costs.end(); it++) {
+        const std::string &signature = it->first;
+        size_t posNr = signature.find("$DimAzimuth=");
+        if (posNr == std::string::npos) {
+            continue;
+        }
+        const std::string &name = isKind ? 
+            signature.substr(0, signature.find("$")) : signature.substr(0, posNr);
+        if (name != classOrKind) {
+            continue;
+        }
+        int nr = atoi(signature.c_str() + posNr + 12);
+        sumCost += it->second;
+        sumModes += nr / 2 + 1;
+    }
+    return sumModes > 0. ? sumCost / sumModes : -1.;
+}
+
+Mesh::DDParameters::DDParameters(const Parameters &par, 
+    double srcLat, double srcLon, double srcDep) {
     mReportMeasure = par.getValue<bool>("DEVELOP_MEASURED_COSTS");
     mProcInterval = par.getValue<int>("DD_PROC_INTERVAL");
     mNCutsPerProc = par.getValue<int>("DD_NCUTS_PER_PROC");
+    mCheckpoint = par.getValue<int>("OPTION_CHECKPOINT_INTERVAL") > 0;
+    mRestart = par.getValue<bool>("OPTION_CHECKPOINT_RESTART");
+    mCacheWeights = par.getValue<bool>("DD_CACHE_WEIGHTS");
+    mCostModel = par.getValue<bool>("DD_COST_MODEL");
+    mEstimateCosts = mCostModel && par.getValue<bool>("DD_ESTIMATE_COSTS");
+    mSampledMeasure = par.getValue<bool>("DD_SAMPLED_MEASURE");
+    mReorderRanks = par.getValue<bool>("DD_REORDER_RANKS");
+    mLocalOrder = par.getValue<bool>("DD_LOCAL_HILBERT_ORDER");
+    mSharedHalo = par.getValue<bool>("DD_SHARED_MEMORY_HALO");
+    mHierarchical = par.getValue<bool>("DD_HIERARCHICAL");
+    mAggregateHalo = par.getValue<bool>("DD_AGGREGATE_HALO");
+    mTrimModes = par.getValue<bool>("DD_HALO_TRIM_MODES");
+    mTrimTolerance = par.getValue<double>("DD_HALO_TRIM_TOLERANCE");
+    mRebalanceInterval = par.getValue<int>("DD_REBALANCE_INTERVAL");
+    mRebalanceThreshold = par.getValue<double>("DD_REBALANCE_THRESHOLD");
+    mImbalanceInterval = par.getValue<int>("DD_IMBALANCE_INTERVAL");
+    if (mCacheWeights && XMPI::root()) {
+        // keyed by everything that changes element costs
+        std::stringstream key;
+        key << par.signature({"MODEL_", "NU_", "ATTENUATION"});
+        key << srcLat << " " << srcLon << " " << srcDep << " ";
+        key << nPol << " " << sizeof(Real) << " ";
+        key << XMath::hashFile(Parameters::sInputDirectory + "/" + 
+            par.getValue<std::string>("MODEL_1D_EXODUS_MESH_FILE"));
+        std::stringstream fname;
+        fname << Parameters::sOutputDirectory << "/cache/dd_weights_" 
+            << std::hex << XMath::hash(key.str()) << ".bin";
+        mCacheFile = fname.str();
+    }
     if (mProcInterval <= 0) {
         mProcInterval = 1;
     }
@@ -613,3 +1741,25 @@ int Mesh::getMaxNr() const {
     }
     return XMPI::max(maxNr);
 }
+
+std::vector<int> Mesh::getNrSet() const {
+    // flag Nr present in local quads, then merge over ranks; 
+    // quads are repartitioned later, so the set must be global
+    IColX present = IColX::Zero(getMaxNr() + 1);
+    for (int i = 0; i < getNumQuads(); i++) {
+        present(mQuads[i]->getNr()) = 1;
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                present(mQuads[i]->getPointNr(ipol, jpol)) = 1;
+            }
+        }
+    }
+    XMPI::sumEigenInt(present);
+    std::vector<int> nrSet;
+    for (int nr = 1; nr < present.size(); nr++) {
+        if (present(nr) > 0) {
+            nrSet.push_back(nr);
+        }
+    }
+    return nrSet;
+}
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <vector>
+#include <map>
+#include <string>
+#include <array>
 #include "eigenp.h"
 
 class Parameters;
@@ -22,6 +25,7 @@ struct DecomposeOption;
 struct MessagingInfo;
 struct LearnParameters;
 class SlicePlot;
+class QuadIndex;
 
 class Mesh {
     friend class SlicePlot;
@@ -46,7 +50,18 @@ public:
     void buildWeighted();
     
     // step 5: release to domain 
-    void release(Domain &domain);    
+    // freeLocal: free the points and the materials of the quads as soon as 
+    // they are released; the quads remain for sources and receivers
+    void release(Domain &domain, bool freeLocal = false);
+    
+    // optional step: bytes of the domain to be released on this rank, 
+    // by subsystem, predicted before release for the memory budget
+    void predictMemory(std::map<std::string, double> &bytes) const;
+    
+    // optional step: run plan by the weights of the weighted phase, in seconds 
+    // per stiffness evaluation; step time, wall time of nStep steps with nStage 
+    // stages, memory per processor and number of processors, on root
+    std::string reportPlan(int nStep, int nStage, double budgetMB) const;
     
     // optional step: test stiffness and mass
     void test();
@@ -54,6 +69,8 @@ public:
     // get Quads 
     int getNumQuads() const {return mQuads.size();};
     const Quad *getQuad(int index) const {return mQuads[index];};
+    // local indices of the quads whose bounding boxes contain (s, z), ascending
+    void findQuads(double s, double z, std::vector<int> &locs) const;
     
     // solve r such that
     // deltaR(router) + router - depth = deltaR(r) + r
@@ -66,8 +83,14 @@ public:
     double zMax() const {return mZMax;};
     double zMin() const {return mZMin;};
     
+    // radial range and range of epicentral distance of the local quads
+    void computeLocalRange(double &rMin, double &rMax, 
+        double &distMin, double &distMax) const;
+    
     // get max. Nr to initialize solver
     int getMaxNr() const;
+    // get all distinct Nr, of elements and points, over all ranks
+    std::vector<int> getNrSet() const;
     
     const ExodusModel *getExodusModel() const {
         return mExModel;
@@ -81,9 +104,43 @@ private:
     // destroy local
     void destroy();
     
+    // local quads along a Hilbert curve of their centres in (s, z),
+    // and local points numbered by first touch in that order
+    void orderLocal(std::vector<int> &quadTags);
+    
+    // box injection: whether the centre of a quad is in the box, and 
+    // the taps, boundary points and dormant elements of the domain
+    bool inBox(int quadTag) const;
+    void releaseBox(Domain &domain) const;
+    
+    // send the 3D results of the quads built to their owners in procMask;
+    // ranges: quad tag => position and length in migrated
+    void migrateQuads(std::vector<Quad *> &quadsBuilt, const IColX &procMask, 
+        std::vector<double> &migrated, std::map<int, std::pair<size_t, size_t>> &ranges) const;
+    
     // measure
     void measure(DecomposeOption &measured);
     
+    // halo size of each element for the dual-graph edge weights
+    void formCommWeights(DecomposeOption &option) const;
+    
+    // element weights saved for restart or reuse, read by root and broadcast
+    bool readWeights(const std::string &fname, RDColX &weights) const;
+    void writeWeights(const std::string &fname, const RDColX &weights) const;
+    
+    // costs by element and point signature, persisted per machine 
+    // like FFTW wisdom; read by root and broadcast
+    static std::string costModelFile();
+    void readCostModel(std::map<std::string, double> &elemCosts, 
+        std::map<std::string, double> &pointCosts) const;
+    void writeCostModel(const std::map<std::string, double> &elemCosts, 
+        const std::map<std::string, double> &pointCosts) const;
+    // seconds per Fourier mode fitted to the costs of a class, the signature 
+    // without its Nr and axis, or of a kind, the first field of the signature, 
+    // such as SolidElement; -1 if none in costs
+    static double costPerMode(const std::map<std::string, double> &costs, 
+        const std::string &classOrKind);
+    
 private:
     
     /////////////////////// global properties ///////////////////////
@@ -121,6 +178,12 @@ private:
     // message info
     MessagingInfo *mMsgInfo;
     
+    // element weights of the weighted phase, by quad tag
+    RDColX mElemWeights;
+    
+    // rtree over the quads for findQuads
+    QuadIndex *mQuadIndex;
+    
     // spatial ranges
     double mSMax;
     double mSMin;
@@ -129,10 +192,40 @@ private:
     
     ////////////////// domain decomposition //////////////////
     struct DDParameters {
-        DDParameters(const Parameters &par);
+        DDParameters(const Parameters &par, double srcLat, double srcLon, double srcDep);
         bool mReportMeasure;
         int mProcInterval;
         int mNCutsPerProc;
+        // decomposition weights saved by or read for checkpoint/restart
+        bool mCheckpoint;
+        bool mRestart;
+        // weights cached for runs of the same model, file name on root
+        bool mCacheWeights;
+        std::string mCacheFile;
+        // costs by signature from the machine's cost model
+        bool mCostModel;
+        // signatures not in the cost model estimated by their class or kind
+        bool mEstimateCosts;
+        // elements and points timed one at a time, without a temp Domain
+        bool mSampledMeasure;
+        // partitions placed on ranks by the halo graph
+        bool mReorderRanks;
+        // local quads and points along a space-filling curve
+        bool mLocalOrder;
+        // node-local halo exchange through MPI-3 shared windows
+        bool mSharedHalo;
+        // partition into nodes first, then into their ranks
+        bool mHierarchical;
+        // one message per node pair through the node leaders
+        bool mAggregateHalo;
+        // trailing-mode trimming of halo messages
+        bool mTrimModes;
+        double mTrimTolerance;
+        // imbalance check in the time loop, weights written to mCacheFile
+        int mRebalanceInterval;
+        double mRebalanceThreshold;
+        // imbalance diagnostics in the time loop
+        int mImbalanceInterval;
     } *mDDPar;
     
     ////////////////// wisdom learning //////////////////
@@ -141,6 +234,28 @@ private:
     ////////////////// 2D in-plane mode //////////////////
     double mPhi2D;
     
+    ////////////////// demote weakly 3D elements to 1D //////////////////
+    double mDemoteTol3D;
+    double mDemoteTolUndulation;
+    
+    ////////////////// precomputed stiffness of 1D elements //////////////////
+    // budget in MB by element class, classes without a budget left out
+    std::map<std::string, double> mLumpedStiffnessMB;
+    
+    ////////////////// first-touch release by the computing threads //////////////////
+    bool mFirstTouch;
+    
+    ////////////////// weakly 3D solids in Fourier space //////////////////
+    int mFourierOrder3D;
+    double mFourierTol3D;
+    
+    ////////////////// box injection //////////////////
+    // 0 for none, 1 for record, 2 for inject
+    int mBoxMode;
+    // radius in metres and epicentral distance in radians, min and max
+    std::array<double, 4> mBoxRange;
+    int mBoxBufferSize;
+    
     ////////////////// slice plotss //////////////////
     std::vector<SlicePlot *> mSlicePlots;
 };
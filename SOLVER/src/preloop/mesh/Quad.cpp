@@ -12,19 +12,23 @@
 #include "SpectralConstants.h"
 
 #include "Material.h"
+#include "Volumetric3D.h"
 #include "Relabelling.h"
+#include "AttBuilder.h"
 
 #include "Elastic.h"
 #include "Acoustic.h"
 
 #include "Gradient.h"
 #include "PreloopGradient.h"
+#include "PackedBuffer.h"
 #include "SolidElement.h"
 #include "FluidElement.h"
 #include "Domain.h"
 
 #include "GLLPoint.h" 
 #include "NrField.h"
+#include "NrCostTable.h"
 
 #include "XMath.h"
 #include "Geodesy.h"
@@ -32,6 +36,7 @@
 #include "OceanLoad3D.h"
 
 #include "PreloopFFTW.h"
+#include "eigen_cg4.h"
 #include <cfloat>
 
 Quad::Quad(const ExodusModel &exModel, int quadTag, const NrField &nrf): 
@@ -102,7 +107,7 @@ mQuadTag(quadTag) {
             throw std::runtime_error("Quad::Quad || Axial side must be 3.");
         }
     }
-
+    
     // solid-fluid boundary
     ///////////////////////////////////////////////
     ////// this piece of code is correct and more general,
@@ -236,22 +241,53 @@ mQuadTag(quadTag) {
 
 Quad::~Quad() {
     delete mMapping;
-    delete mMaterial;
+    freeMaterial();
     if (mRelabelling) {
         delete mRelabelling;
     }
 }
 
+void Quad::freeMaterial() {
+    if (mMaterial) {
+        delete mMaterial;
+        mMaterial = 0;
+    }
+}
+
 void Quad::addVolumetric3D(const std::vector<Volumetric3D *> &m3D, 
-    double srcLat, double srcLon, double srcDep, double phi2D) {
-    mMaterial->addVolumetric3D(m3D, srcLat, srcLon, srcDep, phi2D);
+    double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol,
+    int fourierOrder, double fourierTol) {
+    // skip the models not reaching any GLL point of this quad
+    std::vector<Volumetric3D *> m3DInRegion;
+    if (m3D.size() > 0) {
+        double rMin = DBL_MAX, rMax = 0.;
+        double distMin = pi, distMax = 0.;
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                const RDCol2 &sz = mapping(SpectralConstants::getXiEta(ipol, jpol, mIsAxial));
+                double r = sz.norm();
+                double dist = atan2(sz(0), sz(1));
+                rMin = std::min(rMin, r);
+                rMax = std::max(rMax, r);
+                distMin = std::min(distMin, dist);
+                distMax = std::max(distMax, dist);
+            }
+        }
+        for (const auto &model: m3D) {
+            if (model->inRegion(rMin, rMax, distMin, distMax, srcLat, srcLon, srcDep)) {
+                m3DInRegion.push_back(model);
+            }
+        }
+    }
+    mMaterial->addVolumetric3D(m3DInRegion, srcLat, srcLon, srcDep, phi2D, demoteTol, 
+        fourierOrder, fourierTol);
 }
 
 void Quad::addGeometric3D(const std::vector<Geometric3D *> &g3D, 
-    double srcLat, double srcLon, double srcDep, double phi2D) {
+    double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol) {
     if (g3D.size() > 0) {
         mRelabelling = new Relabelling(this);
-        mRelabelling->addUndulation(g3D, srcLat, srcLon, srcDep, phi2D);
+        mRelabelling->addUndulation(g3D, srcLat, srcLon, srcDep, phi2D, demoteTol);
     }    
 }
 
@@ -271,17 +307,32 @@ void Quad::setOceanLoad3D(const OceanLoad3D &o3D,
                 int nr_read = getPointNr(ipol, jpol);
                 int ipnt = ipol * nPntEdge + jpol;
                 const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mIsAxial);
-                const RDMatX3 &rtpS = computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, nr_read, phi2D);
-                for (int alpha = 0; alpha < nr_read; alpha++) {
-                    double t = rtpS(alpha, 1);
-                    double p = rtpS(alpha, 2);
-                    mOceanDepth[ipnt](alpha) = o3D.getOceanDepth(t, p); 
+                // 2D mode: one point, the same on all slices
+                if (phi2D > -DBL_MAX * .9) {
+                    const RDMatX3 &rtpS = computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, 1, phi2D);
+                    mOceanDepth[ipnt].setConstant(o3D.getOceanDepth(rtpS(0, 1), rtpS(0, 2)));
+                    continue;
                 }
+                const RDMatX3 &rtpS = computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, nr_read, phi2D);
+                o3D.getOceanDepths(rtpS, mOceanDepth[ipnt]);
             }    
         }
     }
 }
 
+void Quad::sync3D(PackedBuffer &buf) {
+    mMaterial->sync3D(buf);
+    bool relabelling = (mRelabelling != 0);
+    buf.syncValue(relabelling);
+    if (relabelling) {
+        if (!buf.packing() && !mRelabelling) {
+            mRelabelling = new Relabelling(this);
+        }
+        mRelabelling->sync(buf);
+    }
+    buf.syncEigenArray(mOceanDepth);
+}
+
 bool Quad::hasRelabelling() const {
     if (!mRelabelling) {
         return false;
@@ -289,6 +340,10 @@ bool Quad::hasRelabelling() const {
     return !(mRelabelling->isZero());
 }
 
+bool Quad::isRelabellingDemoted() const {
+    return hasRelabelling() && mRelabelling->isDemoted();
+}
+
 double Quad::getDeltaT() const {
     // courant number
     double courant = getCourant();
@@ -324,7 +379,7 @@ double Quad::getDeltaT() const {
 void Quad::setupGLLPoints(std::vector<GLLPoint *> &gllPoints, const IMatPP &myPointTags, double distTol) {
     // compute mass on points
     const arPP_RDColX &mass = mMaterial->computeElementalMass();
-
+    
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             int ipnt = ipol * nPntEdge + jpol;
@@ -376,17 +431,26 @@ void Quad::setupGLLPoints(std::vector<GLLPoint *> &gllPoints, const IMatPP &myPo
 }
 
 int Quad::release(Domain &domain, const IMatPP &myPointTags, const AttBuilder *attBuild) const {
+    return domain.addElement(createElement(domain, myPointTags, attBuild));
+}
+
+Element *Quad::createElement(const Domain &domain, const IMatPP &myPointTags, 
+    const AttBuilder *attBuild) const {
     if (mIsFluid) {
-        return releaseFluid(domain, myPointTags);
+        return createFluid(domain, myPointTags);
     } else {
-        return releaseSolid(domain, myPointTags, attBuild);
+        return createSolid(domain, myPointTags, attBuild);
     } 
 }
 
-int Quad::releaseSolid(Domain &domain, const IMatPP &myPointTags, const AttBuilder *attBuild) const {
+Element *Quad::createSolid(const Domain &domain, const IMatPP &myPointTags, const AttBuilder *attBuild) const {
     bool elem1D = mMaterial->isSolidPar1D(attBuild != 0);
-    if (hasRelabelling()) {
-        elem1D = elem1D && mRelabelling->isPar1D();
+    bool prt1D = !hasRelabelling() || mRelabelling->isPar1D();
+    elem1D = elem1D && prt1D;
+    // weakly 3D solid in Fourier space
+    int fourierOrder = -1;
+    if (!elem1D && prt1D) {
+        fourierOrder = mMaterial->getFourierOrderSolid(attBuild != 0);
     }
     std::array<Point *, nPntElem> points;
     for (int ipol = 0; ipol <= nPol; ipol++) {
@@ -395,13 +459,19 @@ int Quad::releaseSolid(Domain &domain, const IMatPP &myPointTags, const AttBuild
         }
     }
     Gradient *grad = createGraident();
-    PRT *prt = mRelabelling ? mRelabelling->createPRT(elem1D) : 0;
-    Elastic *elas = mMaterial->createElastic(elem1D, attBuild);
+    PRT *prt = mRelabelling ? mRelabelling->createPRT(elem1D || fourierOrder >= 0) : 0;
+    Elastic *elas = 0;
+    if (fourierOrder >= 0) {
+        elas = mMaterial->createElasticFourier(fourierOrder, attBuild);
+    } else {
+        elas = mMaterial->createElastic(elem1D, attBuild);
+    }
     Element *elem = new SolidElement(grad, prt, points, elas);
-    return domain.addElement(elem);
+    elem->setNuSchedule(mNuSchedule);
+    return elem;
 }
 
-int Quad::releaseFluid(Domain &domain, const IMatPP &myPointTags) const {
+Element *Quad::createFluid(const Domain &domain, const IMatPP &myPointTags) const {
     bool elem1D = mMaterial->isFluidPar1D();
     if (hasRelabelling()) {
         elem1D = elem1D && mRelabelling->isPar1D();
@@ -416,7 +486,50 @@ int Quad::releaseFluid(Domain &domain, const IMatPP &myPointTags) const {
     PRT *prt = mRelabelling ? mRelabelling->createPRT(elem1D) : 0;
     Acoustic *acous = mMaterial->createAcoustic(elem1D);
     Element *elem = new FluidElement(grad, prt, points, acous);
-    return domain.addElement(elem);
+    elem->setNuSchedule(mNuSchedule);
+    return elem;
+}
+
+double Quad::predictBytes(const AttBuilder *attBuild) const {
+    // same choices as createSolid and createFluid
+    bool prt1D = !hasRelabelling() || mRelabelling->isPar1D();
+    int nu = mNr / 2;
+    double bytes = sizeof(Gradient);
+    if (mIsFluid) {
+        bool elem1D = mMaterial->isFluidPar1D() && prt1D;
+        bytes += sizeof(FluidElement) + (elem1D ? 1 : mNr) * nPntElem * sizeof(Real);
+    } else {
+        bool elem1D = mMaterial->isSolidPar1D(attBuild != 0) && prt1D;
+        int fourierOrder = -1;
+        if (!elem1D && prt1D) {
+            fourierOrder = mMaterial->getFourierOrderSolid(attBuild != 0);
+        }
+        bool elas3D = !elem1D && fourierOrder < 0;
+        // moduli
+        int nmod = mMaterial->isFullAniso() ? 21 : (mMaterial->isIsotropic() ? 3 : 6);
+        bytes += sizeof(SolidElement);
+        if (fourierOrder >= 0) {
+            bytes += 5. * (fourierOrder + 1) * nPntElem * sizeof(Complex);
+        } else {
+            bytes += (double)nmod * (elas3D ? mNr : 1) * nPntElem * sizeof(Real);
+        }
+        // attenuation, memory variables of each SLS and the stress
+        if (attBuild) {
+            int nsls = attBuild->getNSLS();
+            int ncol = attBuild->useCG4() ? nCG : nPntElem;
+            if (elas3D) {
+                int nbuf = attBuild->useCG4() ? 3 : 2;
+                bytes += (6. * (nsls + nbuf) + 3.) * mNr * ncol * sizeof(Real);
+            } else {
+                bytes += 6. * (nsls + 1) * (nu + 1) * ncol * sizeof(Complex);
+            }
+        }
+    }
+    // particle relabelling
+    if (!prt1D) {
+        bytes += 4. * mNr * nPntElem * sizeof(Real);
+    }
+    return bytes;
 }
 
 RDCol2 Quad::mapping(const RDCol2 &xieta) const {
@@ -436,50 +549,62 @@ bool Quad::invMapping(const RDCol2 &sz, RDCol2 &xieta) const {
 }
 
 RDRow4 Quad::computeWeightsCG4() const {
-    RDRow4 weights_cg4;
     RDMatPP ifact;
     XMath::structuredUseFirstRow(mIntegralFactor, ifact);
-    weights_cg4(0) = (ifact(0, 0) + ifact(0, 1)
-                   + ifact(1, 0) + ifact(1, 1)
-            + 0.5 * (ifact(0, 2) + ifact(1, 2)
-                   + ifact(2, 0) + ifact(2, 1))
-            + 0.25 * ifact(2, 2)) / ifact(1, 1);
-            
-    weights_cg4(1) = (ifact(0, 3) + ifact(0, 4)
-                   + ifact(1, 3) + ifact(1, 4)
-            + 0.5 * (ifact(0, 2) + ifact(1, 2)
-                   + ifact(2, 3) + ifact(2, 4))
-            + 0.25 * ifact(2, 2)) / ifact(1, 3);
-            
-    weights_cg4(2) = (ifact(3, 0) + ifact(3, 1)
-                   + ifact(4, 0) + ifact(4, 1)
-            + 0.5 * (ifact(2, 0) + ifact(2, 1)
-                   + ifact(3, 2) + ifact(4, 2))
-            + 0.25 * ifact(2, 2)) / ifact(3, 1);
-            
-    weights_cg4(3) = (ifact(3, 3) + ifact(3, 4)
-                   + ifact(4, 3) + ifact(4, 4)
-            + 0.5 * (ifact(2, 3) + ifact(2, 4)
-                   + ifact(3, 2) + ifact(4, 2))
-            + 0.25 * ifact(2, 2)) / ifact(3, 3);            
+    // share of each GLL line in the lower and upper halves of the element
+    RDColP lower, upper;
+    for (int i = 0; i <= nPol; i++) {
+        lower(i) = (2 * i < nPol) ? 1. : ((2 * i == nPol) ? .5 : 0.);
+        upper(i) = 1. - lower(i);
+    }
+    // integral over a quadrant, lumped onto its coarse-grid point
+    RDRow4 weights_cg4;
+    for (int icg = 0; icg < nCG; icg++) {
+        const RDColP &hi = (ipolCG[icg] == nPolCGLow) ? lower : upper;
+        const RDColP &hj = (jpolCG[icg] == nPolCGLow) ? lower : upper;
+        weights_cg4(icg) = hi.dot(ifact * hj) / ifact(ipolCG[icg], jpolCG[icg]);
+    }
     return weights_cg4;
 }
 
 RDMatX3 Quad::computeGeocentricGlobal(double srcLat, double srcLon, double srcDep,
     const RDCol2 &xieta, int npnt, double phi2D) const {
     RDMatX3 rtpG_Nr(npnt, 3);
-    RDCol3 rtpS;
-    Geodesy::rtheta(mapping(xieta), rtpS(0), rtpS(1));
+    double r, theta;
+    Geodesy::rtheta(mapping(xieta), r, theta);
     // debug relabelling
-    // rtpS(1) = Geodesy::theta(mapping(RDCol2::Zero()));
+    // theta = Geodesy::theta(mapping(RDCol2::Zero()));
     double dphi = 2. * pi / npnt;
     for (int i = 0; i < npnt; i++) {
-        rtpS(2) = phi2D < -DBL_MAX * .9 ? dphi * i : phi2D;
-        rtpG_Nr.row(i) = Geodesy::rotateSrc2Glob(rtpS, srcLat, srcLon, srcDep).transpose();
+        rtpG_Nr(i, 0) = r;
+        rtpG_Nr(i, 1) = theta;
+        rtpG_Nr(i, 2) = phi2D < -DBL_MAX * .9 ? dphi * i : phi2D;
     }
+    // all slices rotated at once
+    SourceRotation(srcLat, srcLon, srcDep).src2Glob(rtpG_Nr);
     return rtpG_Nr;
 }
 
+void Quad::computeGeocentricGlobal(double srcLat, double srcLon, double srcDep,
+    int npnt, double phi2D, RDMatX3 &rtpG) const {
+    rtpG.resize(nPntElem * npnt, 3);
+    double dphi = 2. * pi / npnt;
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            double r, theta;
+            Geodesy::rtheta(mapping(SpectralConstants::getXiEta(ipol, jpol, mIsAxial)), r, theta);
+            int row = (ipol * nPntEdge + jpol) * npnt;
+            for (int i = 0; i < npnt; i++) {
+                rtpG(row + i, 0) = r;
+                rtpG(row + i, 1) = theta;
+                rtpG(row + i, 2) = phi2D < -DBL_MAX * .9 ? dphi * i : phi2D;
+            }
+        }
+    }
+    // all points and slices rotated at once
+    SourceRotation(srcLat, srcLon, srcDep).src2Glob(rtpG);
+}
+
 double Quad::computeCenterRadius() const {
     // xi = eta = 0
     return mapping(RDCol2::Zero()).norm();
@@ -547,6 +672,9 @@ void Quad::formIntegralFactor() {
 }
 
 void Quad::formNrField(const NrField &nrf, double distTol) {
+    int nwin = nrf.getNumNuWindows();
+    mNuSchedule.assign(nwin, 0);
+    std::vector<int> nuWindows;
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             // interpolate
@@ -556,20 +684,20 @@ void Quad::formNrField(const NrField &nrf, double distTol) {
             double offset = std::min((double)tinySingle, distTol / 1e3);
             crds(0) = round(crds(0) / offset) * offset;
             crds(1) = round(crds(1) / offset) * offset;
-            mPointNr(ipol, jpol) = nrf.getNrAtPoint(crds);
+            mPointNr(ipol, jpol) = nrf.quantizeUp(nrf.getNrAtPoint(crds));
             
-            // upper limit
+            // upper limit, also on the levels
             double spacing = Mapping::interpolate(mNodalAveGLLSpacing, xieta);
             double circ = 2. * pi * crds(0);
-            int upper = (int)(circ / spacing);
+            int upper = nrf.quantizeDown((int)(circ / spacing));
             if (upper < 3) upper = 3; // axis
             mPointNr(ipol, jpol) = std::min(mPointNr(ipol, jpol), upper);
             
             ////////// deal with even numbers ////////
-            bool forceOdd = false;
+            bool forceOdd = nrf.forceOddNr();
             if (mPointNr(ipol, jpol) % 2 == 0) {
-                if (mIsAxial) {
-                    // axis
+                if (mIsAxial || forceOdd) {
+                    // axis, or no Nyquist mode anywhere
                     mPointNr(ipol, jpol)++;
                     forceOdd = true;
                 } else if (mNearAxisNodes.maxCoeff() >= 0) {
@@ -606,9 +734,18 @@ void Quad::formNrField(const NrField &nrf, double distTol) {
                 }
             }
             
-            // luck number
+            // cheapest nr by the measured cost
             if (nrf.useLuckyNumber()) {
-                mPointNr(ipol, jpol) = PreloopFFTW::nextLuckyNumber(mPointNr(ipol, jpol), forceOdd);
+                mPointNr(ipol, jpol) = NrCostTable::cheapestNr(mPointNr(ipol, jpol), forceOdd);
+            }
+            
+            // schedule over time, within the Nu of the point
+            if (nwin > 0) {
+                nrf.getNuWindowsAtPoint(crds, nuWindows);
+                for (int iw = 0; iw < nwin; iw++) {
+                    mNuSchedule[iw] = std::max(mNuSchedule[iw], 
+                        std::min(nuWindows[iw], mPointNr(ipol, jpol) / 2));
+                }
             }
         }
     }
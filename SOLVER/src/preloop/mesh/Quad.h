@@ -24,6 +24,8 @@ class Material;
 class AttBuilder;
 
 class Domain;
+class Element;
+class PackedBuffer;
 
 class Quad {
     
@@ -33,15 +35,22 @@ public:
     
     // 3D models
     void addVolumetric3D(const std::vector<Volumetric3D *> &m3D, 
-        double srcLat, double srcLon, double srcDep, double phi2D);
+        double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol,
+        int fourierOrder, double fourierTol);
     void addGeometric3D(const std::vector<Geometric3D *> &g3D, 
-        double srcLat, double srcLon, double srcDep, double phi2D);
+        double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol = 0.);
     void setOceanLoad3D(const OceanLoad3D &o3D, 
         double srcLat, double srcLon, double srcDep, double phi2D);
     
+    // pack or unpack the results of the 3D models above
+    void sync3D(PackedBuffer &buf);
+    
     // has relabelling or not
     bool hasRelabelling() const;
     
+    // relabelling demoted from 3D to 1D
+    bool isRelabellingDemoted() const;
+    
     // get new deltaT
     double getDeltaT() const;
     
@@ -52,9 +61,18 @@ public:
     // create elements and push to domain
     int release(Domain &domain, const IMatPP &myPointTags, 
         const AttBuilder *attBuild) const;
-    int releaseSolid(Domain &domain, const IMatPP &myPointTags, 
+    // create elements on released points without pushing them, 
+    // thread-safe for the first-touch release
+    Element *createElement(const Domain &domain, const IMatPP &myPointTags, 
+        const AttBuilder *attBuild) const;
+    Element *createSolid(const Domain &domain, const IMatPP &myPointTags, 
         const AttBuilder *attBuild) const;
-    int releaseFluid(Domain &domain, const IMatPP &myPointTags) const;
+    Element *createFluid(const Domain &domain, const IMatPP &myPointTags) const;
+    // bytes of the element to be released, predicted before release
+    // for the memory budget; full anisotropy counted as Anisotropic3D
+    double predictBytes(const AttBuilder *attBuild) const;
+    // material is not needed once the element is released
+    void freeMaterial();
     
     // mapping interfaces
     RDCol2 mapping(const RDCol2 &xieta) const;
@@ -68,6 +86,9 @@ public:
     // compute geographic coordinates
     RDMatX3 computeGeocentricGlobal(double srcLat, double srcLon, double srcDep,
         const RDCol2 &xieta, int npnt, double phi2D) const;
+    // all GLL points at once, row ipnt * npnt + i for slice i of point ipnt
+    void computeGeocentricGlobal(double srcLat, double srcLon, double srcDep,
+        int npnt, double phi2D, RDMatX3 &rtpG) const;
     double computeCenterRadius() const;
     
     // get properties
@@ -149,6 +170,8 @@ protected:
     // Nr field
     int mNr;
     IMatPP mPointNr;
+    // Nu of each time window, empty if not scheduled
+    std::vector<int> mNuSchedule;
     
     // data needed to generate Nr field
     RDRow4 mNodalAveGLLSpacing;
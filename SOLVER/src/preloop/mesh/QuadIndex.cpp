@@ -0,0 +1,34 @@
+// QuadIndex.cpp
+// created by Kuangdai on 14-Oct-2026
+// rtree of the bounding boxes of the local quads for point location
+
+#include "QuadIndex.h"
+#include "Quad.h"
+#include <algorithm>
+
+QuadIndex::QuadIndex(const std::vector<Quad *> &quads) {
+    std::vector<QuadIndexValue> values;
+    values.reserve(quads.size());
+    for (int iloc = 0; iloc < quads.size(); iloc++) {
+        double s_max, s_min, z_max, z_min;
+        quads[iloc]->getSpatialRange(s_max, s_min, z_max, z_min);
+        QuadIndexBox box(QuadIndexPoint(s_min - tinySingle, z_min - tinySingle), 
+            QuadIndexPoint(s_max + tinySingle, z_max + tinySingle));
+        values.push_back(QuadIndexValue(box, iloc));
+    }
+    // bulk loading
+    mRTree = boost::geometry::index::rtree<QuadIndexValue, 
+        boost::geometry::index::quadratic<16>>(values.begin(), values.end());
+}
+
+void QuadIndex::query(double s, double z, std::vector<int> &locs) const {
+    std::vector<QuadIndexValue> found;
+    mRTree.query(boost::geometry::index::intersects(QuadIndexPoint(s, z)), 
+        std::back_inserter(found));
+    locs.clear();
+    for (const auto &value: found) {
+        locs.push_back(value.second);
+    }
+    std::sort(locs.begin(), locs.end());
+}
+
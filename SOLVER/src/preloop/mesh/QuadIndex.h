@@ -0,0 +1,31 @@
+// QuadIndex.h
+// created by Kuangdai on 14-Oct-2026
+// rtree of the bounding boxes of the local quads for point location
+
+#pragma once
+
+#include <vector>
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+class Quad;
+
+typedef boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian> QuadIndexPoint;
+typedef boost::geometry::model::box<QuadIndexPoint> QuadIndexBox;
+typedef std::pair<QuadIndexBox, int> QuadIndexValue;
+
+class QuadIndex {
+public:
+    // boxes padded as in Quad::nearMe
+    QuadIndex(const std::vector<Quad *> &quads);
+    
+    // local indices of the quads near (s, z), ascending so that
+    // the first match is the same as in a linear scan over the quads
+    void query(double s, double z, std::vector<int> &locs) const;
+    
+private:
+    boost::geometry::index::rtree<QuadIndexValue, boost::geometry::index::quadratic<16>> mRTree;
+};
+
@@ -15,8 +15,6 @@
 #include "Parameters.h"
 #include "ExodusModel.h"
 #include "Quad.h"
-#include "Domain.h"
-#include "Element.h"
 
 SlicePlot::SlicePlot(const std::string &params, const Mesh *mesh):
 mMesh(mesh) {
@@ -117,9 +115,12 @@ void SlicePlot::plotPhysicalProperties() const {
     if (mSampleType == SampleTypes::Vertex) ncol = 4;
     if (mSampleType == SampleTypes::GLLPnt) ncol = nPntElem;
     int nrow = mMesh->mExModel->getNumQuads();
-    RDMatXX data = RDMatXX::Zero(nrow, ncol);
+    std::vector<int> rows;
+    std::vector<double> values;
+    rows.reserve(mMesh->getNumQuads());
+    values.reserve(mMesh->getNumQuads() * ncol);
     
-    // gather local data
+    // local data
     for (int i = 0; i < mMesh->getNumQuads(); i++) {
         RDRowN quadData;
         if (boost::iequals(mParName, "undulation")) {
@@ -127,29 +128,21 @@ void SlicePlot::plotPhysicalProperties() const {
         } else {
             quadData = mMesh->mQuads[i]->getMaterialOnSlice(mParName, mRefType, mPhi);
         }
-        int row = mMesh->mQuads[i]->getQuadTag();
+        rows.push_back(mMesh->mQuads[i]->getQuadTag());
         if (mSampleType == SampleTypes::Center) {
-            data(row, 0) = quadData(nPol / 2 * nPntEdge + nPol / 2);
+            values.push_back(quadData(nPol / 2 * nPntEdge + nPol / 2));
         } else if (mSampleType == SampleTypes::Vertex) {
-            data(row, 0) = quadData(0);
-            data(row, 1) = quadData(nPol * nPntEdge);
-            data(row, 2) = quadData(nPol * nPntEdge + nPol);
-            data(row, 3) = quadData(nPol);
+            values.push_back(quadData(0));
+            values.push_back(quadData(nPol * nPntEdge));
+            values.push_back(quadData(nPol * nPntEdge + nPol));
+            values.push_back(quadData(nPol));
         } else {
-            data.row(row) = quadData;
+            values.insert(values.end(), quadData.data(), quadData.data() + nPntElem);
         }
     }
     
-    // sum MPI
-    XMPI::sumEigenDouble(data);
-    
-    // dump to file
-    if (XMPI::root()) {
-        std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
-        std::fstream fs(fname, std::fstream::out);
-        fs << data << std::endl;
-        fs.close();
-    }
+    // gather to root and dump to file
+    dumpToFile(gatherRows(rows, values, nrow, ncol, MPI_DOUBLE));
 }
 
 void SlicePlot::plotNu() const {
@@ -160,39 +153,33 @@ void SlicePlot::plotNu() const {
     if (mSampleType == SampleTypes::Vertex) ncol = 4;
     if (mSampleType == SampleTypes::GLLPnt) ncol = nPntElem;
     int nrow = mMesh->mExModel->getNumQuads();
-    Eigen::Matrix<int, Eigen::Dynamic, Eigen::Dynamic> data(nrow, ncol);
-    data.setZero();
+    std::vector<int> rows;
+    std::vector<int> values;
+    rows.reserve(mMesh->getNumQuads());
+    values.reserve(mMesh->getNumQuads() * ncol);
     
-    // gather local data
+    // local data
     for (int i = 0; i < mMesh->getNumQuads(); i++) {
-        int row = mMesh->mQuads[i]->getQuadTag();
+        const Quad *quad = mMesh->mQuads[i];
+        rows.push_back(quad->getQuadTag());
         if (mSampleType == SampleTypes::Center) {
-            data(row, 0) = mMesh->mQuads[i]->getNu(); // use max
+            values.push_back(quad->getNu()); // use max
         } else if (mSampleType == SampleTypes::Vertex) {
-            data(row, 0) = mMesh->mQuads[i]->getPointNr(0, 0);
-            data(row, 1) = mMesh->mQuads[i]->getPointNr(nPol, 0);
-            data(row, 2) = mMesh->mQuads[i]->getPointNr(nPol, nPol);
-            data(row, 3) = mMesh->mQuads[i]->getPointNr(0, nPol);
+            values.push_back(quad->getPointNr(0, 0));
+            values.push_back(quad->getPointNr(nPol, 0));
+            values.push_back(quad->getPointNr(nPol, nPol));
+            values.push_back(quad->getPointNr(0, nPol));
         } else {
             for (int ipol = 0; ipol <= nPol; ipol++) {
                 for (int jpol = 0; jpol <= nPol; jpol++) {
-                    int ipnt = ipol * nPntEdge + jpol;
-                    data(row, ipnt) = mMesh->mQuads[i]->getPointNr(ipol, jpol);
+                    values.push_back(quad->getPointNr(ipol, jpol));
                 }
             }
         }
     }
     
-    // sum MPI
-    XMPI::sumEigenInt(data);
-    
-    // dump to file
-    if (XMPI::root()) {
-        std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
-        std::fstream fs(fname, std::fstream::out);
-        fs << data << std::endl;
-        fs.close();
-    }
+    // gather to root and dump to file
+    dumpToFile(gatherRows(rows, values, nrow, ncol, MPI_INT));
 }
 
 void SlicePlot::plotRank(bool weighted) const {
@@ -202,42 +189,28 @@ void SlicePlot::plotRank(bool weighted) const {
     
     // data size
     int nrow = mMesh->mExModel->getNumQuads();
-    IColX data = IColX::Zero(nrow);
-    
-    // gather local data
+    std::vector<int> rows;
     for (int i = 0; i < mMesh->getNumQuads(); i++) {
-        int row = mMesh->mQuads[i]->getQuadTag();
-        data(row) = XMPI::rank();
+        rows.push_back(mMesh->mQuads[i]->getQuadTag());
     }
+    std::vector<int> values(rows.size(), XMPI::rank());
     
-    // sum MPI
-    XMPI::sumEigenInt(data);
-    
-    // dump to file
-    if (XMPI::root()) {
-        std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
-        std::fstream fs(fname, std::fstream::out);
-        fs << data << std::endl;
-        fs.close();
-    }
+    // gather to root and dump to file
+    dumpToFile(gatherRows(rows, values, nrow, 1, MPI_INT));
 }
 
-void SlicePlot::plotEleType(const Domain &domain) const {
+void SlicePlot::plotEleType(const std::vector<std::string> &elemTypes) const {
     if (!boost::iequals(mParName, "eleType")) return;
     
     // data size
     int nrow = mMesh->mExModel->getNumQuads();
     std::vector<std::string> data(nrow, "");
-    std::vector<std::string> etype;
+    std::vector<std::string> etype = elemTypes;
     std::vector<int> etag;
     
     // gather local data
     for (int iloc = 0; iloc < mMesh->getNumQuads(); iloc++) {
-        int elemTag = mMesh->mQuads[iloc]->getElementTag();
-        int quadTag = mMesh->mQuads[iloc]->getQuadTag();
-        Element *elem = domain.getElement(elemTag);
-        etype.push_back(elem->verbose());
-        etag.push_back(quadTag);
+        etag.push_back(mMesh->mQuads[iloc]->getQuadTag());
     }
     
     // sum MPI
@@ -253,22 +226,66 @@ void SlicePlot::plotEleType(const Domain &domain) const {
                 data[all_etag[i][j]] = all_etype[i][j];
             }
         }
-        std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
-        std::fstream fs(fname, std::fstream::out);
-        for (int i = 0; i < nrow; i++) fs << data[i] << std::endl;
-        fs.close();
     }
+    dumpToFile(data);
 }
 
 void SlicePlot::plotMeasured(const RDColX &cost) const {
     if (!boost::iequals(mParName, "eleCost")) return;
-    // dump to file
+    dumpToFile(cost);
+}
+
+template<typename Type>
+Eigen::Matrix<Type, Eigen::Dynamic, Eigen::Dynamic> SlicePlot::gatherRows(
+    const std::vector<int> &rows, const std::vector<Type> &values, 
+    int nrow, int ncol, MPI_Datatype mpitype) {
+    // only the local rows are sent, instead of summing a global matrix
+    std::vector<std::vector<int>> allRows;
+    std::vector<std::vector<Type>> allValues;
+    XMPI::gather(rows, allRows, MPI_INT, false);
+    XMPI::gather(values, allValues, mpitype, false);
+    Eigen::Matrix<Type, Eigen::Dynamic, Eigen::Dynamic> data;
     if (XMPI::root()) {
-        std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
-        std::fstream fs(fname, std::fstream::out);
-        fs << cost << std::endl;
-        fs.close();
+        data = Eigen::Matrix<Type, Eigen::Dynamic, Eigen::Dynamic>::Zero(nrow, ncol);
+        for (int iproc = 0; iproc < allRows.size(); iproc++) {
+            for (int i = 0; i < allRows[iproc].size(); i++) {
+                for (int j = 0; j < ncol; j++) {
+                    data(allRows[iproc][i], j) = allValues[iproc][i * ncol + j];
+                }
+            }
+        }
     }
+    return data;
+}
+
+template<typename Data>
+void SlicePlot::dumpToFile(const Data &data) const {
+    if (!XMPI::root()) {
+        return;
+    }
+    // the previous file is still being written
+    waitForIO();
+    std::string fname = Parameters::sOutputDirectory + "/plots/" + verbose('_') + ".txt";
+    mWriter = std::thread([fname, data]() {writeText(fname, data);});
+}
+
+void SlicePlot::waitForIO() const {
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+}
+
+template<typename Data>
+void SlicePlot::writeText(const std::string &fname, const Data &data) {
+    std::fstream fs(fname, std::fstream::out);
+    fs << data << std::endl;
+    fs.close();
+}
+
+void SlicePlot::writeText(const std::string &fname, const std::vector<std::string> &data) {
+    std::fstream fs(fname, std::fstream::out);
+    for (int i = 0; i < data.size(); i++) fs << data[i] << std::endl;
+    fs.close();
 }
 
 int SlicePlot::numArgs(const std::string &parName) const {
@@ -6,10 +6,11 @@
 
 #include <string>
 #include <vector>
+#include <thread>
 #include "eigenp.h"
+#include "XMPI.h"
 class Parameters;
 class Mesh;
-class Domain;
 
 class SlicePlot {
     
@@ -18,10 +19,11 @@ public:
     enum SampleTypes {Center, Vertex, GLLPnt};
     
     SlicePlot(const std::string &params, const Mesh *mesh);
+    ~SlicePlot() {waitForIO();};
     
     void plotUnweighted() const;
     void plotWeighted() const;
-    void plotEleType(const Domain &domain) const;
+    void plotEleType(const std::vector<std::string> &elemTypes) const;
     void plotMeasured(const RDColX &cost) const;
         
     // build from input parameters
@@ -33,6 +35,21 @@ private:
     void plotNu() const;
     void plotRank(bool weighted) const;
     
+    // rows of the local quads, ncol values each, to a global matrix on root
+    template<typename Type>
+    static Eigen::Matrix<Type, Eigen::Dynamic, Eigen::Dynamic> gatherRows(
+        const std::vector<int> &rows, const std::vector<Type> &values, 
+        int nrow, int ncol, MPI_Datatype mpitype);
+    
+    // the file is written by a background thread on root, 
+    // so that the build continues meanwhile
+    template<typename Data>
+    void dumpToFile(const Data &data) const;
+    void waitForIO() const;
+    template<typename Data>
+    static void writeText(const std::string &fname, const Data &data);
+    static void writeText(const std::string &fname, const std::vector<std::string> &data);
+    
     int numArgs(const std::string &parName) const;
     bool isPhysical(const std::string &parName) const;
     std::string verbose(char sep = ' ') const; 
@@ -43,4 +60,7 @@ private:
     PropertyRefTypes mRefType = PropertyRefTypes::Property1D;
     
     const Mesh *mMesh;
+    
+    // writer thread
+    mutable std::thread mWriter;
 };
\ No newline at end of file
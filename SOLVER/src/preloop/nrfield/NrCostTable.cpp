@@ -0,0 +1,186 @@
+// NrCostTable.cpp
+// created by Kuangdai on 14-Oct-2026 
+// measured cost of nr, replacing the lucky numbers
+
+#include "NrCostTable.h"
+#include "PreloopFFTW.h"
+#include "SolverFFTW.h"
+#include "XMPI.h"
+#include "global.h"
+#include <fstream>
+#include <sstream>
+#include <cfloat>
+
+std::vector<double> NrCostTable::sCostFFT;
+double NrCostTable::sCostPerMode = 0.;
+std::vector<int> NrCostTable::sCheapest;
+std::vector<int> NrCostTable::sCheapestOdd;
+bool NrCostTable::sMeasured = false;
+
+void NrCostTable::initialize() {
+    std::vector<double> table;
+    if (XMPI::root()) {
+        // line 1: per-mode cost; then: nr, fft cost
+        std::ifstream fs(costTableFile());
+        double perMode;
+        if (fs >> perMode) {
+            table.push_back(perMode);
+            int nr;
+            double cost;
+            while (fs >> nr >> cost) {
+                if (nr != table.size()) {
+                    break;
+                }
+                table.push_back(cost);
+            }
+        }
+        fs.close();
+        sMeasured = false;
+        if (table.size() != sMaxNr + 1) {
+            measure();
+            sMeasured = true;
+            table.clear();
+            table.push_back(sCostPerMode);
+            table.insert(table.end(), sCostFFT.begin(), sCostFFT.end());
+            XMPI::mkdir(fftwWisdomDirectory);
+            std::ofstream fo(costTableFile());
+            if (!fo) {
+                throw std::runtime_error("NrCostTable::initialize || "
+                    "Error creating cost table file: || " + costTableFile());
+            }
+            fo.precision(10);
+            fo << sCostPerMode << std::endl;
+            for (int nr = 1; nr <= sMaxNr; nr++) {
+                fo << nr << "    " << sCostFFT[nr - 1] << std::endl;
+            }
+            fo.close();
+        }
+    }
+    XMPI::bcast(table);
+    sCostPerMode = table[0];
+    sCostFFT = std::vector<double>(table.begin() + 1, table.end());
+    formCheapest();
+}
+
+void NrCostTable::finalize() {
+    sCostFFT.clear();
+    sCheapest.clear();
+    sCheapestOdd.clear();
+}
+
+int NrCostTable::cheapestNr(int n, bool forceOdd) {
+    // also where the table ends before the lucky number
+    int lucky = PreloopFFTW::nextLuckyNumber(n, forceOdd);
+    if (n < 1 || lucky > sMaxNr || sCheapest.size() == 0) {
+        return lucky;
+    }
+    return forceOdd ? sCheapestOdd[n - 1] : sCheapest[n - 1];
+}
+
+std::string NrCostTable::verbose() {
+    std::stringstream ss;
+    ss << "\n================== Cost of Fourier Orders ==================" << std::endl;
+    ss << "  Cost Table               =   " << costTableFile() << 
+        (sMeasured ? " (measured)" : "") << std::endl;
+    ss << "  Table Range of Nr        =   [1, " << sMaxNr << "]" << std::endl;
+    ss << "  Seconds per Mode         =   " << sCostPerMode << std::endl;
+    if (sCostFFT.size() > 0) {
+        ss << "  Seconds of FFT at Max Nr =   " << sCostFFT.back() << std::endl;
+    }
+    ss << "================== Cost of Fourier Orders ==================\n" << std::endl;
+    return ss.str();
+}
+
+std::string NrCostTable::costTableFile() {
+    std::stringstream fname;
+    fname << fftwWisdomDirectory << "/nr_cost_table.npol" << nPol;
+    #ifdef _USE_DOUBLE
+        fname << ".double";
+    #else
+        fname << ".float";
+    #endif
+    return fname.str();
+}
+
+namespace NrCostMeasure {
+    // seconds per call of func, repeated until the clock is reliable
+    template<class Func>
+    double timeIt(Func func) {
+        const double minTime = 2e-4;
+        for (int nrep = 1; ; nrep *= 2) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int irep = 0; irep < nrep; irep++) {
+                func();
+            }
+            auto t1 = std::chrono::high_resolution_clock::now();
+            double sec = std::chrono::duration<double>(t1 - t0).count();
+            if (sec >= minTime || nrep >= (1 << 20)) {
+                return sec / nrep;
+            }
+        }
+    }
+}
+
+void NrCostTable::measure() {
+    // an element of three components, as SolverFFTW_N3 
+    int xx = nPntElem * 3;
+    // with Fourier modes strided by xx, as in its structured buffers
+    RMatXX rmat = RMatXX::Ones(sMaxNr, xx);
+    CMatXX_RM cmat = CMatXX_RM::Constant(sMaxNr / 2 + 1, xx, Complex(one, one));
+    sCostFFT = std::vector<double>(sMaxNr, 0.);
+    for (int nr = 1; nr <= sMaxNr; nr++) {
+        int n[] = {nr};
+        PlanFFTW r2c = planR2CFFTW(1, n, xx, rmat.data(), n, 1, sMaxNr, 
+            complexFFTW(cmat.data()), n, xx, 1, FFTW_ESTIMATE);
+        PlanFFTW c2r = planC2RFFTW(1, n, xx, complexFFTW(cmat.data()), n, xx, 1, 
+            rmat.data(), n, 1, sMaxNr, FFTW_ESTIMATE);
+        sCostFFT[nr - 1] = NrCostMeasure::timeIt([&]() {
+            execFFTW(r2c);
+            execFFTW(c2r);
+            // c2r destroys its input and the round trip scales by nr
+            rmat.topRows(nr).setOnes();
+        });
+        distroyFFTW(r2c);
+        distroyFFTW(c2r);
+    }
+    
+    // per mode: derivatives of three components on the two axes, 
+    // forward and backward, as in the Gradient loops
+    RMatPP g = RMatPP::Ones();
+    ar3_CMatPP u, v;
+    for (int i = 0; i < 3; i++) {
+        u[i].setConstant(Complex(one, one));
+    }
+    Complex sum = czero;
+    sCostPerMode = NrCostMeasure::timeIt([&]() {
+        for (int i = 0; i < 3; i++) {
+            v[i] = g * u[i] + u[i] * g.transpose();
+            u[i] = g.transpose() * v[i] + v[i] * g;
+            u[i] *= (Real)1e-3;
+        }
+        sum += u[0](0, 0);
+    });
+    // keep the loop
+    volatile Real sink = std::abs(sum);
+    (void)sink;
+}
+
+void NrCostTable::formCheapest() {
+    sCheapest = std::vector<int>(sMaxNr, -1);
+    sCheapestOdd = std::vector<int>(sMaxNr, -1);
+    double best = DBL_MAX, bestOdd = DBL_MAX;
+    int nrBest = -1, nrBestOdd = -1;
+    for (int nr = sMaxNr; nr >= 1; nr--) {
+        double cost = sCostFFT[nr - 1] + sCostPerMode * (nr / 2 + 1);
+        if (cost < best) {
+            best = cost;
+            nrBest = nr;
+        }
+        if (nr % 2 == 1 && cost < bestOdd) {
+            bestOdd = cost;
+            nrBestOdd = nr;
+        }
+        sCheapest[nr - 1] = nrBest;
+        sCheapestOdd[nr - 1] = nrBestOdd;
+    }
+}
@@ -0,0 +1,38 @@
+// NrCostTable.h
+// created by Kuangdai on 14-Oct-2026 
+// measured cost of nr, replacing the lucky numbers
+
+#pragma once
+#include <string>
+#include <vector>
+
+class NrCostTable {
+public:
+    // read the table cached for this machine, or measure and cache it; 
+    // root reads or measures and broadcasts, so all ranks agree on nr
+    static void initialize();
+    static void finalize();
+    
+    // cheapest nr >= n by the table, odd if forceOdd; 
+    // lucky numbers beyond the table or without it
+    static int cheapestNr(int n, bool forceOdd = false);
+    
+    static std::string verbose();
+    
+    // nr covered by the table; larger sizes are close to their lucky numbers
+    static const int sMaxNr = 1024;
+    
+private:
+    static std::string costTableFile();
+    static void measure();
+    static void formCheapest();
+    
+    // seconds of one r2c and c2r pair of an element at each nr, index nr - 1
+    static std::vector<double> sCostFFT;
+    // seconds of the element loops per Fourier mode
+    static double sCostPerMode;
+    // suffix minima of the total cost, index n - 1
+    static std::vector<int> sCheapest;
+    static std::vector<int> sCheapestOdd;
+    static bool sMeasured;
+};
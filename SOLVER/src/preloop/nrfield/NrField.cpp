@@ -7,12 +7,14 @@
 #include "EmpNrField.h"
 #include "WisdomNrField.h"
 #include "UserNrField.h"
+#include "NrCostTable.h"
 
 #include "Parameters.h"
 #include "XMPI.h"
 #include <boost/algorithm/string.hpp>
 
-void NrField::buildInparam(NrField *&nrf, const Parameters &par, int verbose) {
+void NrField::buildInparam(NrField *&nrf, const Parameters &par, 
+    double srcLat, double srcLon, double srcDep, int verbose) {
     if (nrf) {
         delete nrf;
     }
@@ -39,12 +41,18 @@ void NrField::buildInparam(NrField *&nrf, const Parameters &par, int verbose) {
         nrf = new EmpNrField(useLucky, nu_ref, nu_min, scaleS, scaleT, scaleD, 
             powS, factPI, startT, powT, factD0, startD, endD);
     } else if (boost::iequals(type, "wisdom")) {
-        std::string fname = Parameters::sInputDirectory + "/" + par.getValue<std::string>("NU_WISDOM_REUSE_INPUT");
+        std::vector<std::string> fnames;
+        for (int i = 0; i < par.getSize("NU_WISDOM_REUSE_INPUT"); i++) {
+            fnames.push_back(Parameters::sInputDirectory + "/" + 
+                par.getValue<std::string>("NU_WISDOM_REUSE_INPUT", i));
+        }
         double factor = par.getValue<double>("NU_WISDOM_REUSE_FACTOR");
         if (factor <= tinyDouble) {
             factor = 1.0;
         }
-        nrf = new WisdomNrField(useLucky, fname, factor);
+        double raster = par.getValue<double>("NU_WISDOM_REUSE_RASTER");
+        bool windows = par.getValue<bool>("NU_WISDOM_REUSE_WINDOWS");
+        nrf = new WisdomNrField(useLucky, fnames, factor, srcLat, srcLon, srcDep, raster, windows);
     } else if (boost::iequals(type, "user-defined")) {
         int nsize = par.getSize("NU_USER_PARAMETER_LIST");
         std::vector<double> params;
@@ -58,7 +66,50 @@ void NrField::buildInparam(NrField *&nrf, const Parameters &par, int verbose) {
             "Invalid parameter, keyword = NU_TYPE.");
     }
     
+    nrf->setQuantization(par.getValue<double>("NU_QUANTIZATION_RATIO"));
+    nrf->setForceOddNr(par.getValue<bool>("NU_FORCE_ODD_NR"));
+    
+    // cost of nr on this machine, collective
+    if (useLucky) {
+        NrCostTable::initialize();
+    }
+    
     if (verbose) {
         XMPI::cout << nrf->verbose();
+        if (useLucky) {
+            XMPI::cout << NrCostTable::verbose();
+        }
+        if (nrf->forceOddNr()) {
+            XMPI::cout << "  Nr forced to be odd\n" << XMPI::endl;
+        }
+        if (nrf->getQuantization() > 1.) {
+            XMPI::cout << "  Nr quantized with level ratio = " << 
+                nrf->getQuantization() << "\n" << XMPI::endl;
+        }
+    }
+}
+
+int NrField::quantizeUp(int nr) const {
+    if (mQuantizeRatio <= 1.) {
+        return nr;
+    }
+    int level = 1;
+    while (level < nr) {
+        level = std::max(level + 1, (int)ceil(level * mQuantizeRatio));
+    }
+    return level;
+}
+
+int NrField::quantizeDown(int nr) const {
+    if (mQuantizeRatio <= 1.) {
+        return nr;
+    }
+    int level = 1;
+    while (true) {
+        int next = std::max(level + 1, (int)ceil(level * mQuantizeRatio));
+        if (next > nr) {
+            return level;
+        }
+        level = next;
     }
 }
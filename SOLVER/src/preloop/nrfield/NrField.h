@@ -4,6 +4,7 @@
 
 #pragma once
 #include "eigenp.h"
+#include <vector>
 
 class Parameters;
 
@@ -15,13 +16,31 @@ public:
     
     virtual int getNrAtPoint(const RDCol2 &coords) const = 0;
     
+    // Nu of each time window, for fields with a schedule over time
+    virtual int getNumNuWindows() const {return 0;};
+    virtual void getNuWindowsAtPoint(const RDCol2 &coords, std::vector<int> &nus) const {nus.clear();};
+    
     virtual std::string verbose() const = 0;
     
-    static void buildInparam(NrField *&nrf, const Parameters &par, int verbose);
+    static void buildInparam(NrField *&nrf, const Parameters &par, 
+        double srcLat, double srcLon, double srcDep, int verbose);
         
     bool useLuckyNumber() const {return mUseLuckyNumber;};
     
+    // snap nr to the levels 1, 2, ..., each about ratio times the last, 
+    // so that nearby points share a few values; identity if ratio <= 1
+    void setQuantization(double ratio) {mQuantizeRatio = ratio;};
+    double getQuantization() const {return mQuantizeRatio;};
+    int quantizeUp(int nr) const;
+    int quantizeDown(int nr) const;
+    
+    // odd nr only, so that no point or element carries a Nyquist mode
+    void setForceOddNr(bool odd) {mForceOddNr = odd;};
+    bool forceOddNr() const {return mForceOddNr;};
+    
 protected:
     bool mUseLuckyNumber;
+    double mQuantizeRatio = 0.;
+    bool mForceOddNr = false;
 };
 
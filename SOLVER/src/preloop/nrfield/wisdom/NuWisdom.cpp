@@ -9,11 +9,25 @@
 #include "NetCDF_ReaderAscii.h"
 #include "NetCDF_Writer.h"
 #include "eigenp.h"
+#include "Geodesy.h"
+#include "XOMP.h"
 
-void NuWisdom::insert(double s, double z, int nu_learn, int nu_orign) {
+void NuWisdom::insert(double s, double z, int nu_learn, int nu_orign, 
+    const std::vector<int> &nu_windows) {
+    if (mRTree.size() == 0) {
+        mNumWindows = nu_windows.size();
+        mWindows.clear();
+    }
+    if (nu_windows.size() != mNumWindows) {
+        throw std::runtime_error("NuWisdom::insert || "
+            "Inconsistent number of time windows.");
+    }
     RTreePoint newPoint(s, z);
-    std::array<int, 2> nu = {nu_learn, nu_orign};
+    int row = mNumWindows > 0 ? mWindows.size() / mNumWindows : -1;
+    mWindows.insert(mWindows.end(), nu_windows.begin(), nu_windows.end());
+    std::array<int, 3> nu = {nu_learn, nu_orign, row};
     mRTree.insert(std::make_pair(newPoint, nu));
+    mRasterSamples = 0;
 }
 
 void NuWisdom::writeToFile(const std::string &fname) const {
@@ -21,7 +35,8 @@ void NuWisdom::writeToFile(const std::string &fname) const {
         #ifndef NDEBUG
             Eigen::internal::set_is_malloc_allowed(true);
         #endif
-        RDMatXX_RM data(mRTree.size(), 4);
+        int ncol = 4 + mNumWindows;
+        RDMatXX_RM data(mRTree.size(), ncol);
         #ifndef NDEBUG
             Eigen::internal::set_is_malloc_allowed(false);
         #endif
@@ -31,21 +46,32 @@ void NuWisdom::writeToFile(const std::string &fname) const {
             data(row, 1) = value.first.get<1>();
             data(row, 2) = value.second[0] * 1.;
             data(row, 3) = value.second[1] * 1.;
+            for (int iw = 0; iw < mNumWindows; iw++) {
+                data(row, 4 + iw) = mWindows[value.second[2] * mNumWindows + iw] * 1.;
+            }
             row++;
         }
         NetCDF_Writer ncw;
         ncw.open(fname, true);
         std::vector<size_t> dims;
         dims.push_back(mRTree.size());
-        dims.push_back(4);
+        dims.push_back(ncol);
         ncw.defineVariable<double>("axisem3d_wisdom", dims);
+        if (mHasSource) {
+            ncw.defineVariable<double>("axisem3d_wisdom_source", std::vector<size_t>(1, 3));
+        }
         ncw.writeVariableWhole("axisem3d_wisdom", data);
+        if (mHasSource) {
+            std::vector<double> source = {mSrcLat, mSrcLon, mSrcDep};
+            ncw.writeVariableWhole("axisem3d_wisdom_source", source);
+        }
         ncw.close();
     }
 }
 
 void NuWisdom::readFromFile(const std::string &fname) {
     RDMatXX data;
+    std::vector<double> source;
     if (XMPI::root()) {
         RDMatXX dataRead;
         if (NetCDF_Reader::checkNetCDF_isAscii(fname)) {
@@ -57,35 +83,60 @@ void NuWisdom::readFromFile(const std::string &fname) {
             NetCDF_Reader reader;
             reader.open(fname);
             reader.read2D("axisem3d_wisdom", dataRead);
+            // absent in files written before the source was saved
+            try {
+                reader.read1D("axisem3d_wisdom_source", source);
+            } catch (const std::exception &e) {
+                source.clear();
+            }
             reader.close();
         }
         if (dataRead.cols() == 3) {
             data = RDMatXX(dataRead.rows(), 4);
             data.leftCols(3) = dataRead;
             data.col(3) = data.col(2);
-        } else if (dataRead.cols() == 4) {
+        } else if (dataRead.cols() >= 4) {
+            // columns after the 4th are time windows
             data = dataRead;
         } else {
             throw std::runtime_error("NuWisdom::readFromFile || "
-                "Inconsistent dimensions for wisdom data, must be a matrix of 3 or 4 columns "
+                "Inconsistent dimensions for wisdom data, must be a matrix of at least 3 columns "
                 "|| File = " + fname);
         }
     }
     XMPI::bcastEigen(data);
+    XMPI::bcast(source);
+    mHasSource = (source.size() == 3);
+    if (mHasSource) {
+        setSource(source[0], source[1], source[2]);
+    }
     
     // pop rtree
     mRTree.clear();
+    mRasterSamples = 0;
+    mNumWindows = std::max((int)data.cols() - 4, 0);
+    mWindows.clear();
+    mWindows.reserve(data.rows() * mNumWindows);
     for (int i = 0; i < data.rows(); i++) {
         // no need to check duplicated here
         RTreePoint newPoint(data(i, 0), data(i, 1));
         int nu_learn = round(data(i, 2));
         int nu_orign = round(data(i, 3));
-        std::array<int, 2> nu = {nu_learn, nu_orign};
+        for (int iw = 0; iw < mNumWindows; iw++) {
+            mWindows.push_back(round(data(i, 4 + iw)));
+        }
+        std::array<int, 3> nu = {nu_learn, nu_orign, mNumWindows > 0 ? i : -1};
         mRTree.insert(std::make_pair(newPoint, nu));
     }
 }
 
 int NuWisdom::getNu(double s, double z, int numSamples) const {
+    if (mRasterSamples == numSamples) {
+        int nu = getNuRaster(s, z);
+        if (nu >= 0) {
+            return nu;
+        }
+    }
     RTreePoint target(s, z);
     const std::vector<RTreeValue> &nearest = queryKNN(target, numSamples);
     if (nearest.size() == 0) {
@@ -105,6 +156,103 @@ int NuWisdom::getNu(double s, double z, int numSamples) const {
     return round(nuTarget / distTotal);
 }
 
+void NuWisdom::setSource(double srcLat, double srcLon, double srcDep) {
+    mHasSource = true;
+    mSrcLat = srcLat;
+    mSrcLon = srcLon;
+    mSrcDep = srcDep;
+}
+
+bool NuWisdom::sameSource(double srcLat, double srcLon, double srcDep) const {
+    if (!mHasSource) {
+        return true;
+    }
+    // the frame only depends on the epicentre
+    return std::abs(srcLat - mSrcLat) < tinySingle && 
+        std::abs(Geodesy::lon2Phi(srcLon) - Geodesy::lon2Phi(mSrcLon)) < tinySingle;
+}
+
+int NuWisdom::getNu(double s, double z, int numSamples, 
+    double srcLat, double srcLon, double srcDep, int numRing) const {
+    std::vector<std::pair<double, double>> ring;
+    formRing(s, z, srcLat, srcLon, srcDep, numRing, ring);
+    int nu = 0;
+    for (const auto &sz: ring) {
+        nu = std::max(nu, getNu(sz.first, sz.second, numSamples));
+    }
+    return nu;
+}
+
+void NuWisdom::getNuWindows(double s, double z, int numSamples, std::vector<int> &nus) const {
+    nus.assign(mNumWindows, 0);
+    if (mNumWindows == 0) {
+        return;
+    }
+    RTreePoint target(s, z);
+    const std::vector<RTreeValue> &nearest = queryKNN(target, numSamples);
+    if (nearest.size() == 0) {
+        throw std::runtime_error("NuWisdom::getNuWindows || Wisdom is empty.");
+    }
+    
+    // same weights as getNu
+    std::vector<double> nuTarget(mNumWindows, 0.);
+    double distTotal = 0.;
+    for (int i = 0; i < nearest.size(); i++) {
+        const int *nuWin = &mWindows[nearest[i].second[2] * mNumWindows];
+        double dist = boost::geometry::distance(target, nearest[i].first);
+        if (dist < tinyDouble) {
+            nus.assign(nuWin, nuWin + mNumWindows);
+            return;
+        }
+        distTotal += 1. / dist;
+        for (int iw = 0; iw < mNumWindows; iw++) {
+            nuTarget[iw] += nuWin[iw] / dist;
+        }
+    }
+    for (int iw = 0; iw < mNumWindows; iw++) {
+        nus[iw] = round(nuTarget[iw] / distTotal);
+    }
+}
+
+void NuWisdom::getNuWindows(double s, double z, int numSamples, 
+    double srcLat, double srcLon, double srcDep, int numRing, std::vector<int> &nus) const {
+    std::vector<std::pair<double, double>> ring;
+    formRing(s, z, srcLat, srcLon, srcDep, numRing, ring);
+    nus.assign(mNumWindows, 0);
+    std::vector<int> nusRing;
+    for (const auto &sz: ring) {
+        getNuWindows(sz.first, sz.second, numSamples, nusRing);
+        for (int iw = 0; iw < mNumWindows; iw++) {
+            nus[iw] = std::max(nus[iw], nusRing[iw]);
+        }
+    }
+}
+
+void NuWisdom::formRing(double s, double z, double srcLat, double srcLon, double srcDep, 
+    int numRing, std::vector<std::pair<double, double>> &ring) const {
+    ring.clear();
+    RDCol3 rtpS;
+    rtpS(0) = sqrt(s * s + z * z);
+    if (sameSource(srcLat, srcLon, srcDep) || rtpS(0) < tinyDouble) {
+        ring.push_back(std::make_pair(s, z));
+        return;
+    }
+    rtpS(1) = acos(std::max(-1., std::min(1., z / rtpS(0))));
+    // a point on the axis is a ring of one
+    int nring = (s < tinyDouble) ? 1 : numRing;
+    RDMatX3 rtp(nring, 3);
+    for (int iring = 0; iring < nring; iring++) {
+        rtp.row(iring) << rtpS(0), rtpS(1), 2. * pi / nring * iring;
+    }
+    // source of the run => globe => source of the wisdom
+    SourceRotation(srcLat, srcLon, srcDep).src2Glob(rtp);
+    SourceRotation(mSrcLat, mSrcLon, mSrcDep).glob2Src(rtp);
+    for (int iring = 0; iring < nring; iring++) {
+        ring.push_back(std::make_pair(rtp(iring, 0) * sin(rtp(iring, 1)), 
+            rtp(iring, 0) * cos(rtp(iring, 1))));
+    }
+}
+
 int NuWisdom::getMaxNu() const {
     int nu_max = -1;
     for (RTreeValue const &v: mRTree) {
@@ -124,6 +272,59 @@ double NuWisdom::getCompressionRatio() const {
     return nu_learn / nu_orign;
 }
 
+void NuWisdom::bakeRaster(double spacingFactor, int numSamples) {
+    mRaster.resize(0, 0);
+    mRasterSamples = 0;
+    if (spacingFactor <= 0. || mRTree.size() == 0) {
+        return;
+    }
+    
+    // bounds and mean spacing of the samples
+    const auto &box = mRTree.bounds();
+    mRasterS0 = box.min_corner().get<0>();
+    mRasterZ0 = box.min_corner().get<1>();
+    double ls = box.max_corner().get<0>() - mRasterS0;
+    double lz = box.max_corner().get<1>() - mRasterZ0;
+    mRasterCell = sqrt(ls * lz / mRTree.size()) * spacingFactor;
+    if (mRasterCell < tinyDouble) {
+        return;
+    }
+    int ns = (int)ceil(ls / mRasterCell) + 1;
+    int nz = (int)ceil(lz / mRasterCell) + 1;
+    
+    // nodes, computed as by the rtree
+    mRaster = IMatXX::Constant(ns, nz, -1);
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int is = 0; is < ns; is++) {
+        for (int iz = 0; iz < nz; iz++) {
+            RTreePoint node(mRasterS0 + is * mRasterCell, mRasterZ0 + iz * mRasterCell);
+            const std::vector<RTreeValue> &nearest = queryKNN(node, 1);
+            if (boost::geometry::distance(node, nearest[0].first) <= mRasterCell) {
+                mRaster(is, iz) = getNu(node.get<0>(), node.get<1>(), numSamples);
+            }
+        }
+    }
+    mRasterSamples = numSamples;
+}
+
+int NuWisdom::getNuRaster(double s, double z) const {
+    double fs = (s - mRasterS0) / mRasterCell;
+    double fz = (z - mRasterZ0) / mRasterCell;
+    int is = (int)floor(fs);
+    int iz = (int)floor(fz);
+    if (is < 0 || iz < 0 || is + 1 >= mRaster.rows() || iz + 1 >= mRaster.cols()) {
+        return -1;
+    }
+    // maximum of the corners, not lower than the field in the cell
+    const auto &corners = mRaster.block(is, iz, 2, 2);
+    if (corners.minCoeff() < 0) {
+        return -1;
+    }
+    return corners.maxCoeff();
+}
+
 std::vector<RTreeValue> NuWisdom::queryKNN(const RTreePoint &target, int number) const {
     std::vector<RTreeValue> returned_values; 
     mRTree.query(boost::geometry::index::nearest(target, number),
@@ -146,4 +347,16 @@ LearnParameters::LearnParameters(const Parameters &par) {
     }
     mFileName = par.getValue<std::string>("NU_WISDOM_LEARN_OUTPUT");
     mFileName = Parameters::sOutputDirectory + "/" + mFileName;
+    mSwitch = par.getValue<double>("NU_WISDOM_LEARN_SWITCH");
+    if (mSwitch < 0. || mSwitch >= 1.) {
+        mSwitch = 0.;
+    }
+    mNumWindows = par.getValue<int>("NU_WISDOM_LEARN_WINDOWS");
+    if (mNumWindows < 1) {
+        mNumWindows = 1;
+    }
+    mSampling = par.getValue<int>("NU_WISDOM_LEARN_SAMPLING");
+    if (mSampling < 1) {
+        mSampling = 1;
+    }
 }
@@ -7,30 +7,79 @@
 class Parameters;
 
 #include <string>
+#include <vector>
+#include <array>
+#include "eigenp.h"
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
 #include <boost/geometry/index/rtree.hpp>
 
 typedef boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian> RTreePoint;
-typedef std::pair<RTreePoint, std::array<int, 2>> RTreeValue;
+// learned Nu, starting Nu, row of the windows
+typedef std::pair<RTreePoint, std::array<int, 3>> RTreeValue;
 
 class NuWisdom {
 public:
     NuWisdom() {};
     ~NuWisdom() {};
     
-    void insert(double s, double z, int nu_learn, int nu_orign);
+    // nu_windows: learned Nu in each time window, empty if not windowed
+    void insert(double s, double z, int nu_learn, int nu_orign, 
+        const std::vector<int> &nu_windows = std::vector<int>());
     void writeToFile(const std::string &fname) const;
     void readFromFile(const std::string &fname);
     int getNu(double s, double z, int numSamples) const;
+    
+    // source of the frame in which (s, z) are learned; 
+    // files without a source are taken as learned with the current one
+    void setSource(double srcLat, double srcLon, double srcDep);
+    bool hasSource() const {return mHasSource;};
+    bool sameSource(double srcLat, double srcLon, double srcDep) const;
+    
+    // Nu at (s, z) in the frame of another source: the maximum over 
+    // numRing points on the ring of (s, z) mapped into the learned frame
+    int getNu(double s, double z, int numSamples, 
+        double srcLat, double srcLon, double srcDep, int numRing) const;
     int getMaxNu() const;
+    
+    // learned Nu of each time window, interpolated as getNu; 
+    // the re-projected version takes the maximum over the ring
+    int getNumWindows() const {return mNumWindows;};
+    void getNuWindows(double s, double z, int numSamples, std::vector<int> &nus) const;
+    void getNuWindows(double s, double z, int numSamples, 
+        double srcLat, double srcLon, double srcDep, int numRing, std::vector<int> &nus) const;
     double getCompressionRatio() const;
     
+    // bake getNu(numSamples) into a regular (s, z) raster for O(1) lookup, 
+    // with cells of spacingFactor times the mean spacing of the samples
+    void bakeRaster(double spacingFactor, int numSamples);
+    
 private:
+    // raster value at (s, z), -1 if not covered
+    int getNuRaster(double s, double z) const;
+    
+    // (s, z) of the numRing points on the ring of (s, z) in the learned frame
+    void formRing(double s, double z, double srcLat, double srcLon, double srcDep, 
+        int numRing, std::vector<std::pair<double, double>> &ring) const;
+    
     // KNN query
     std::vector<RTreeValue> queryKNN(const RTreePoint &target, int number) const;
     // rtree
     boost::geometry::index::rtree<RTreeValue, boost::geometry::index::quadratic<16>> mRTree;   
+    
+    // time windows, mNumWindows per sample
+    int mNumWindows = 0;
+    std::vector<int> mWindows;
+    
+    // raster; -1 at nodes with no sample within a cell, 
+    // where the rtree is queried instead
+    IMatXX mRaster;
+    int mRasterSamples = 0;
+    double mRasterS0 = 0., mRasterZ0 = 0., mRasterCell = 0.;
+    
+    // learned source
+    bool mHasSource = false;
+    double mSrcLat = 0., mSrcLon = 0., mSrcDep = 0.;
 };
 
 // learning options
@@ -40,5 +89,13 @@ struct LearnParameters {
     double mCutoff;
     int mInterval;
     std::string mFileName;
+    // fraction of the record after which the learned Nu is applied, 0 for off
+    double mSwitch;
+    // number of time windows in which Nu is learned separately, 1 for none
+    int mNumWindows;
+    // points learn in turns, one of every mSampling at each interval
+    int mSampling;
+    // source saved with the wisdom, set by Mesh
+    double mSrcLat = 0., mSrcLon = 0., mSrcDep = 0.;
 };
 
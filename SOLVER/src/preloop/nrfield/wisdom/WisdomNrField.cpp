@@ -7,29 +7,72 @@
 
 #include "NuWisdom.h"
 
-WisdomNrField::WisdomNrField(bool useLucky, const std::string &fname, double factor): 
-NrField(useLucky), mFileName(fname), mFactor(factor) {
-    mNuWisdom = new NuWisdom();
-    mNuWisdom->readFromFile(fname);
+WisdomNrField::WisdomNrField(bool useLucky, const std::vector<std::string> &fnames, double factor,
+    double srcLat, double srcLon, double srcDep, double rasterFactor, bool useWindows): 
+NrField(useLucky), mFileNames(fnames), mFactor(factor), mRasterFactor(rasterFactor),
+mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep) {
+    for (const std::string &fname: mFileNames) {
+        NuWisdom *wis = new NuWisdom();
+        wis->readFromFile(fname);
+        wis->bakeRaster(mRasterFactor, mNumInterpPoints);
+        mNuWisdoms.push_back(wis);
+    }
+    
+    // time windows
+    if (useWindows && mNuWisdoms.size() > 0) {
+        mNumWindows = mNuWisdoms[0]->getNumWindows();
+        for (const auto &wis: mNuWisdoms) {
+            if (wis->getNumWindows() != mNumWindows) {
+                mNumWindows = 0;
+            }
+        }
+    }
 }
 
 WisdomNrField::~WisdomNrField() {
-    delete mNuWisdom;
+    for (const auto &wis: mNuWisdoms) {
+        delete wis;
+    }
 }
 
 int WisdomNrField::getNrAtPoint(const RDCol2 &coords) const {
-    int nu = round(mNuWisdom->getNu(coords(0), coords(1), mNumInterpPoints) * mFactor);
+    // max envelope
+    int nuMax = 0;
+    for (const auto &wis: mNuWisdoms) {
+        nuMax = std::max(nuMax, wis->getNu(coords(0), coords(1), mNumInterpPoints, 
+            mSrcLat, mSrcLon, mSrcDep, mNumRingPoints));
+    }
+    int nu = round(nuMax * mFactor);
     int nr = nu * 2 + 1;
     return nr;
 }
 
+void WisdomNrField::getNuWindowsAtPoint(const RDCol2 &coords, std::vector<int> &nus) const {
+    // max envelope
+    nus.assign(mNumWindows, 0);
+    std::vector<int> nusWis;
+    for (const auto &wis: mNuWisdoms) {
+        wis->getNuWindows(coords(0), coords(1), mNumInterpPoints, 
+            mSrcLat, mSrcLon, mSrcDep, mNumRingPoints, nusWis);
+        for (int iw = 0; iw < mNumWindows; iw++) {
+            nus[iw] = std::max(nus[iw], (int)round(nusWis[iw] * mFactor));
+        }
+    }
+}
+
 std::string WisdomNrField::verbose() const {
     std::stringstream ss;
     ss << "\n================= Fourier Expansion Order ==================" << std::endl;
     ss << "  Type                     =   Wisdom" << std::endl;
-    ss << "  Wisdom File              =   " << mFileName << std::endl;
+    for (int i = 0; i < mFileNames.size(); i++) {
+        bool remapped = !mNuWisdoms[i]->sameSource(mSrcLat, mSrcLon, mSrcDep);
+        ss << "  Wisdom File              =   " << mFileNames[i] << 
+            (remapped ? " (re-projected)" : "") << std::endl;
+        ss << "  Compression Ratio        =   " << mNuWisdoms[i]->getCompressionRatio() << std::endl;
+    }
     ss << "  Wisdom Factor            =   " << mFactor << std::endl;
-    ss << "  Compression Ratio        =   " << mNuWisdom->getCompressionRatio() << std::endl;
+    ss << "  Raster Factor            =   " << mRasterFactor << std::endl;
+    ss << "  Time Windows             =   " << mNumWindows << std::endl;
     ss << "  Use FFTW Lucky Numbers   =   " << (mUseLuckyNumber ? "YES" : "NO") << std::endl;
     ss << "================= Fourier Expansion Order ==================\n" << std::endl;
     return ss.str();
@@ -4,23 +4,37 @@
 
 #pragma once
 #include "NrField.h"
+#include <vector>
 
 class NuWisdom;
 
 class WisdomNrField: public NrField {
 public:
-    WisdomNrField(bool useLucky, const std::string &fname, double factor);
+    // a library of wisdoms, merged by maximum and 
+    // re-projected from their own sources onto the current one
+    // rasterFactor: raster cell over the mean sample spacing, 0 for the rtree only
+    // useWindows: follow the time windows, if all wisdoms have the same number 
+    WisdomNrField(bool useLucky, const std::vector<std::string> &fnames, double factor,
+        double srcLat, double srcLon, double srcDep, double rasterFactor, bool useWindows);
     ~WisdomNrField();
     
     int getNrAtPoint(const RDCol2 &coords) const;
     
+    int getNumNuWindows() const {return mNumWindows;};
+    void getNuWindowsAtPoint(const RDCol2 &coords, std::vector<int> &nus) const;
+    
     std::string verbose() const;
     
 private:
-    std::string mFileName;
+    std::vector<std::string> mFileNames;
     double mFactor;
+    double mRasterFactor;
+    double mSrcLat, mSrcLon, mSrcDep;
+    int mNumWindows = 0;
     
-    NuWisdom *mNuWisdom;
+    std::vector<NuWisdom *> mNuWisdoms;
     const int mNumInterpPoints = 4;
+    // samples on the ring of a point to re-project a wisdom
+    const int mNumRingPoints = 12;
 };
 
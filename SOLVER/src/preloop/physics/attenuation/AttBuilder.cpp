@@ -43,19 +43,17 @@ Attenuation1D *AttBuilder::createAttenuation1D(const RDMatXN &QKp, const RDMatXN
     if (mUseCG4) {
         const RDRow4 &weights_cg4 = quad->computeWeightsCG4();
         RDRow4 dkp, dmu;
-        std::vector<int> ipol = {1, 1, 3, 3};
-        std::vector<int> jpol = {1, 3, 1, 3};
-        for (int i = 0; i < 4; i++) {
-            int ip = ipol[i];
-            int jp = jpol[i];
+        for (int i = 0; i < nCG; i++) {
+            int ip = ipolCG[i];
+            int jp = jpolCG[i];
             dkp(i) = weights_cg4(i) * dKpFactStr(ip, jp) * kpStr(ip, jp);
             dmu(i) = weights_cg4(i) * dMuFactStr(ip, jp) * muStr(ip, jp);
         }
         kpStr.array() *= kpFactNoAttStr.array();
         muStr.array() *= muFactNoAttStr.array();
-        for (int i = 0; i < 4; i++) {
-            int ip = ipol[i];
-            int jp = jpol[i];
+        for (int i = 0; i < nCG; i++) {
+            int ip = ipolCG[i];
+            int jp = jpolCG[i];
             kpStr(ip, jp) *= 1. + weights_cg4(i) * (kpFactAttStr(ip, jp) / kpFactNoAttStr(ip, jp) - 1.);
             muStr(ip, jp) *= 1. + weights_cg4(i) * (muFactAttStr(ip, jp) / muFactNoAttStr(ip, jp) - 1.);
         }
@@ -95,20 +93,18 @@ Attenuation3D *AttBuilder::createAttenuation3D(const RDMatXN &QKp, const RDMatXN
         const RDRow4 &weights_cg4 = quad->computeWeightsCG4();
         int nr = quad->getNr();
         RDMatX4 dkp(nr, 4), dmu(nr, 4);
-        std::vector<int> ipol = {1, 1, 3, 3};
-        std::vector<int> jpol = {1, 3, 1, 3};
-        for (int i = 0; i < 4; i++) {
-            int ip = ipol[i];
-            int jp = jpol[i];
+        for (int i = 0; i < nCG; i++) {
+            int ip = ipolCG[i];
+            int jp = jpolCG[i];
             dkp.col(i) = weights_cg4(i) * dKpFact.col(nPntEdge * ip + jp).schur(kp.col(nPntEdge * ip + jp));
             dmu.col(i) = weights_cg4(i) * dMuFact.col(nPntEdge * ip + jp).schur(mu.col(nPntEdge * ip + jp));
         }
         kp.array() *= kpFactNoAtt.array();
         mu.array() *= muFactNoAtt.array();
         RDColX ones = RDColX::Ones(nr);
-        for (int i = 0; i < 4; i++) {
-            int ip = ipol[i];
-            int jp = jpol[i];
+        for (int i = 0; i < nCG; i++) {
+            int ip = ipolCG[i];
+            int jp = jpolCG[i];
             kp.col(nPntEdge * ip + jp).array() *= ones.array() + weights_cg4(i) * (kpFactAtt.col(nPntEdge * ip + jp).array() 
                 / kpFactNoAtt.col(nPntEdge * ip + jp).array() - ones.array());
             mu.col(nPntEdge * ip + jp).array() *= ones.array() + weights_cg4(i) * (muFactAtt.col(nPntEdge * ip + jp).array() 
@@ -128,6 +124,18 @@ Attenuation3D *AttBuilder::createAttenuation3D(const RDMatXN &QKp, const RDMatXN
     }
 }
 
+bool AttBuilder::isNegligible(const RDMatXN &QKp, const RDMatXN &QMu) const {
+    if (mSkipTolerance <= 0.) {
+        return false;
+    }
+    // a wave cannot travel in the element longer than the record length
+    double Qmin = QMu.minCoeff();
+    if (doKappa()) {
+        Qmin = std::min(Qmin, QKp.minCoeff());
+    }
+    return pi * mFmax * mRecordLength < mSkipTolerance * Qmin;
+}
+
 std::string AttBuilder::verbose() const {
     std::stringstream ss;
     ss << "\n=================== Attenuation Builder ====================" << std::endl;
@@ -137,6 +145,9 @@ std::string AttBuilder::verbose() const {
     ss << "  Ref. Freq. (Hz)   =   " << mFref << std::endl;
     ss << "  Time Step         =   " << mDeltaT << std::endl;
     ss << "  Include QKappa    =   " << (doKappa() ? "YES" : "NO") << std::endl;
+    if (mSkipTolerance > 0.) {
+        ss << "  Skip if loss <    =   " << mSkipTolerance << std::endl;
+    }
     if (legacy()) ss << "  Using SPECFEM Legacy model." << std::endl;
     ss << "=================== Attenuation Builder ====================\n" << std::endl;
     return ss.str();
@@ -164,9 +175,9 @@ void AttBuilder::buildInparam(AttBuilder *&attBuild, const Parameters &par,
     bool cg4 = par.getValue<bool>("ATTENUATION_CG4");
     bool dokappa = par.getValue<bool>("ATTENUATION_QKAPPA");
     
-    if (cg4 && nPol != 4) {
+    if (cg4 && nPol < 3) {
         throw std::runtime_error("AttBuilder::buildInparam || "
-            "ATTENUATION_CG4 is turned on but nPol is not 4.");
+            "ATTENUATION_CG4 is turned on but nPol is less than 3.");
     }
     
     // create model
@@ -180,11 +191,16 @@ void AttBuilder::buildInparam(AttBuilder *&attBuild, const Parameters &par,
                 "Number of SLSs can only be 3 when ATTENUATION_SPECFEM_LEGACY = true.");
         }
         attBuild = new AttSimplex(cg4, attPar->mNSLS, attPar->mFmin, attPar->mFmax, attPar->mFref, dt);
+        attBuild->readCache();
     } else {
         attBuild = new AttAxiSEM(cg4, attPar->mNSLS, attPar->mFmin, attPar->mFmax, attPar->mFref, 
             attPar->mW, attPar->mY, dt, dokappa);
     }
     
+    // skip memory variables where Q is effectively infinite
+    attBuild->mSkipTolerance = par.getValue<double>("ATTENUATION_SKIP_TOLERANCE");
+    attBuild->mRecordLength = par.getValue<double>("TIME_RECORD_LENGTH");
+    
     // verbose 
     if (verbose) {
         XMPI::cout << attBuild->verbose();
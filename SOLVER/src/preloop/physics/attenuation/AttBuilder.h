@@ -37,8 +37,21 @@ public:
         RDMatXN &kp, RDMatXN &mu, const Quad *quad) const;
     std::string verbose() const;
     
+    bool useCG4() const {return mUseCG4;};
+    int getNSLS() const {return mNSLS;};
+    
+    // whether the amplitude loss over the record length, pi * fmax * T / Q,
+    // is below ATTENUATION_SKIP_TOLERANCE everywhere in an element, 
+    // so that its memory variables can be skipped
+    bool isNegligible(const RDMatXN &QKp, const RDMatXN &QMu) const;
+    
     static void buildInparam(AttBuilder *&attBuild, const Parameters &par, 
         const AttParameters *attPar, double dt, int verbose);
+    
+    // fitted relaxation parameters cached across runs, collective;
+    // nothing for builders without fitting
+    virtual void readCache() {};
+    virtual void writeCache() const {};
 
 protected:    
     virtual void computeAttFactors(const RDMatXN &QKp, const RDMatXN &QMu,
@@ -57,4 +70,8 @@ protected:
     double mFmax;
     double mFref;
     double mDeltaT;
+    
+    // criterion for skipping memory variables, 0 for never
+    double mSkipTolerance = 0.;
+    double mRecordLength = 0.;
 };
@@ -4,6 +4,10 @@
 
 #include "AttSimplex.h"
 #include "XMath.h"
+#include "XMPI.h"
+#include <fstream>
+#include <sstream>
+#include <set>
 
 extern "C" {
     void __simplex_MOD_simplex_fminsearch(double *tau_e, const double *tau_s, const int *nsls, 
@@ -51,14 +55,7 @@ void AttSimplex::computeAttFactors(const RDMatXN &QKp, const RDMatXN &QMu,
     double QMuAVE = QMu.row(0).sum() / nPntElem;
     
     // minimization of frequency misfit
-    RDColX tau_e = mTau_s * (1. + 2. / QMuAVE);
-    int niter, ierr; double tol;
-    __simplex_MOD_simplex_fminsearch(tau_e.data(), mTau_s.data(), &mNSLS, 
-        mFreqs.data(), &mNFreq, &QMuAVE, &niter, &tol, &ierr);
-    if (ierr > 0) {
-        throw std::runtime_error("AttSimplex::computeFactors || "
-            "Convergence failed in Fortran subroutine simplex_fminsearch.");
-    }
+    const RDColX &tau_e = fitTauE(QMuAVE);
     
     // alpha beta gamma
     RDColX onesSLS = RDColX::Ones(mNSLS);
@@ -98,5 +95,108 @@ void AttSimplex::computeAttFactors(const RDMatXN &QKp, const RDMatXN &QMu,
     muFactNoAtt.fill(muFactNoAttValue);
 }
 
+RDColX AttSimplex::fitTauE(double QMu) const {
+    RDColX tau_e;
+    bool converged = true;
+    #ifdef _USE_OPENMP
+        #pragma omp critical(AttSimplex_fitTauE)
+    #endif
+    {
+        auto it = mTauE.find(QMu);
+        if (it != mTauE.end()) {
+            tau_e = it->second;
+        } else {
+            tau_e = mTau_s * (1. + 2. / QMu);
+            int niter, ierr; double tol;
+            __simplex_MOD_simplex_fminsearch(tau_e.data(), mTau_s.data(), &mNSLS, 
+                mFreqs.data(), &mNFreq, &QMu, &niter, &tol, &ierr);
+            converged = (ierr <= 0);
+            if (converged) {
+                mTauE[QMu] = tau_e;
+                mTauENew[QMu] = tau_e;
+            }
+        }
+    }
+    if (!converged) {
+        throw std::runtime_error("AttSimplex::computeAttFactors || "
+            "Convergence failed in Fortran subroutine simplex_fminsearch.");
+    }
+    return tau_e;
+}
+
+std::string AttSimplex::cacheFile() {
+    return fftwWisdomDirectory + "/attenuation_simplex.txt";
+}
 
+void AttSimplex::readCache() {
+    std::string cache = "";
+    if (XMPI::root()) {
+        std::ifstream fs(cacheFile());
+        if (fs) {
+            std::stringstream buffer;
+            buffer << fs.rdbuf();
+            cache = buffer.str();
+        }
+    }
+    XMPI::bcast(cache);
+    
+    // line: nsls fmin fmax QMu tau_e(0) ... tau_e(nsls - 1)
+    std::stringstream ss(cache);
+    std::string line;
+    while (getline(ss, line)) {
+        std::stringstream ls(line);
+        int nsls;
+        double fmin, fmax, QMu;
+        if (!(ls >> nsls >> fmin >> fmax >> QMu) || 
+            nsls != mNSLS || fmin != mFmin || fmax != mFmax) {
+            continue;
+        }
+        RDColX tau_e(mNSLS);
+        for (int i = 0; i < mNSLS; i++) {
+            ls >> tau_e(i);
+        }
+        if (ls) {
+            mTauE[QMu] = tau_e;
+        }
+    }
+}
 
+void AttSimplex::writeCache() const {
+    // fits of this run on all processors
+    std::stringstream ss;
+    ss.precision(17);
+    for (auto it = mTauENew.begin(); it != mTauENew.end(); it++) {
+        ss << mNSLS << " " << mFmin << " " << mFmax << " " << it->first;
+        for (int i = 0; i < mNSLS; i++) {
+            ss << " " << it->second(i);
+        }
+        ss << "\n";
+    }
+    std::vector<std::string> allFits;
+    XMPI::gather(ss.str(), allFits, false);
+    if (!XMPI::root()) {
+        return;
+    }
+    
+    // append to the file the lines not yet there; 
+    // the same QMu may have been fitted on several processors
+    std::string newFits = "";
+    std::set<std::string> written;
+    for (const std::string &fits: allFits) {
+        std::stringstream fs(fits);
+        std::string line;
+        while (getline(fs, line)) {
+            if (written.insert(line).second) {
+                newFits += line + "\n";
+            }
+        }
+    }
+    if (newFits.length() == 0) {
+        return;
+    }
+    XMPI::mkdir(fftwWisdomDirectory);
+    std::ofstream fs(cacheFile(), std::ios::app);
+    if (fs) {
+        fs << newFits;
+    }
+}
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "AttBuilder.h"
+#include <map>
 
 class AttSimplex: public AttBuilder {
 public:
@@ -15,12 +16,23 @@ public:
         RDMatXN &dKpFact, RDMatXN &kpFactAtt, RDMatXN &kpFactNoAtt, 
         RDMatXN &dMuFact, RDMatXN &muFactAtt, RDMatXN &muFactNoAtt) const;
     bool doKappa() const {return false;};
+    
+    // fitted tau_e in the wisdom directory, by number of SLSs, band and QMu
+    void readCache();
+    void writeCache() const;
         
 private:
+    // tau_e fitted to a QMu by simplex, or found in the cache
+    RDColX fitTauE(double QMu) const;
+    static std::string cacheFile();
     
     // intermediate 
     RDColX mTau_s, mFreqs; 
     double mW_central;
     
     const int mNFreq = 100;
+    
+    // fitted tau_e by QMu, shared by the elements; those fitted in this run
+    mutable std::map<double, RDColX> mTauE;
+    mutable std::map<double, RDColX> mTauENew;
 };
@@ -22,13 +22,18 @@
 #include "Isotropic3D.h"
 #include "TransverselyIsotropic1D.h"
 #include "TransverselyIsotropic3D.h"
+#include "TransverselyIsotropicFourier.h"
 
 #include "Anisotropic1D.h"
 #include "Anisotropic3D.h"
+#include "Hexagonal3D.h"
 #include "Geodesy.h"
 
 #include <boost/algorithm/string.hpp>
 #include "SlicePlot.h"
+#include "PreloopFFTW.h"
+#include "PackedBuffer.h"
+#include <cfloat>
 
 Material::Material(const Quad *myQuad, const ExodusModel &exModel): mMyQuad(myQuad) {
     // read Exodus model
@@ -94,7 +99,10 @@ Material::Material(const Quad *myQuad, const ExodusModel &exModel): mMyQuad(myQu
 }
 
 void Material::addVolumetric3D(const std::vector<Volumetric3D *> &m3D, 
-    double srcLat, double srcLon, double srcDep, double phi2D) {
+    double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol,
+    int fourierOrder, double fourierTol) {
+    mFourierMaxOrder = fourierOrder;
+    mFourierTol = fourierTol;
     if (m3D.size() == 0) {
         return;
     }    
@@ -122,88 +130,94 @@ void Material::addVolumetric3D(const std::vector<Volumetric3D *> &m3D,
     // radius at element center 
     double rElemCenter = mMyQuad->computeCenterRadius();
     
-    // read 3D model
+    // read 3D model: coordinates of all GLL points computed once and 
+    // one batched query per model over them; buffers reused across models
     int Nr = mMyQuad->getNr();
-    for (int ipol = 0; ipol <= nPol; ipol++) {
-        for (int jpol = 0; jpol <= nPol; jpol++) {
-            // geographic oordinates of cardinal points
-            const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
-            const RDMatX3 &rtp = mMyQuad->computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, Nr, phi2D);
-            int ipnt = ipol * nPntEdge + jpol;
-            for (int alpha = 0; alpha < Nr; alpha++) {
-                double r = rtp(alpha, 0);
-                double t = rtp(alpha, 1);
-                double p = rtp(alpha, 2);
-                for (const auto &model: m3D) {
-                    if (mMyQuad->isFluid() && !model->makeFluid3D()) {
-                        continue;
-                    }
-                    std::vector<Volumetric3D::MaterialProperty> properties; 
-                    std::vector<Volumetric3D::MaterialRefType> refTypes;
-                    std::vector<double> values;
-                    if (!model->get3dProperties(r, t, p, rElemCenter, properties, refTypes, values)) {
-                        // point (r, t, p) not in model range
-                        continue;
-                    }
-                    
-                    if (!_3Dprepared()) {
-                        prepare3D();
-                    }
-                    
-                    // deal with VP and VS
-                    std::vector<Volumetric3D::MaterialProperty> propertiesTIso; 
-                    std::vector<Volumetric3D::MaterialRefType> refTypesTIso;
-                    std::vector<double> valuesTIso;
-                    for (int iprop = 0; iprop < properties.size(); iprop++) {
-                        if (properties[iprop] == Volumetric3D::MaterialProperty::VP) {
-                            propertiesTIso.push_back(Volumetric3D::MaterialProperty::VPV);
-                            propertiesTIso.push_back(Volumetric3D::MaterialProperty::VPH);
-                            refTypesTIso.push_back(refTypes[iprop]);
-                            refTypesTIso.push_back(refTypes[iprop]);
-                            valuesTIso.push_back(values[iprop]);
-                            valuesTIso.push_back(values[iprop]);
-                        } else if (properties[iprop] == Volumetric3D::MaterialProperty::VS) {
-                            propertiesTIso.push_back(Volumetric3D::MaterialProperty::VSV);
-                            propertiesTIso.push_back(Volumetric3D::MaterialProperty::VSH);
-                            refTypesTIso.push_back(refTypes[iprop]);
-                            refTypesTIso.push_back(refTypes[iprop]);
-                            valuesTIso.push_back(values[iprop]);
-                            valuesTIso.push_back(values[iprop]);
-                        } else {
-                            propertiesTIso.push_back(properties[iprop]);
-                            refTypesTIso.push_back(refTypes[iprop]);
-                            valuesTIso.push_back(values[iprop]);
-                        }
-                    }
-                    // change values
-                    for (int iprop = 0; iprop < propertiesTIso.size(); iprop++) {
-                        // initialize anisotropy
-                        if (!mFullAniso && propertiesTIso[iprop] >= Volumetric3D::MaterialProperty::C11) {
-                            initAniso();
+    // 2D mode: one query per GLL point, the same on all slices, so that
+    // the element is exactly 1D in the source-centred frame
+    bool mode2D = phi2D > -DBL_MAX * .9;
+    int nQuery = mode2D ? 1 : Nr;
+    RDMatX3 rtp;
+    std::vector<Volumetric3D::MaterialProperty> properties; 
+    std::vector<Volumetric3D::MaterialRefType> refTypes;
+    RDMatXX values;
+    IColX inRange;
+    std::vector<Volumetric3D::MaterialProperty> propertiesTIso; 
+    std::vector<Volumetric3D::MaterialRefType> refTypesTIso;
+    std::vector<int> columnsTIso;
+    for (const auto &model: m3D) {
+        if (mMyQuad->isFluid() && !model->makeFluid3D()) {
+            continue;
+        }
+        if (rtp.rows() == 0) {
+            mMyQuad->computeGeocentricGlobal(srcLat, srcLon, srcDep, nQuery, phi2D, rtp);
+        }
+        properties.clear();
+        refTypes.clear();
+        if (!model->get3dPropertiesBatch(rtp, rElemCenter, properties, refTypes, values, inRange)) {
+            // no point of the quad in model range
+            continue;
+        }
+        
+        if (!_3Dprepared()) {
+            prepare3D();
+        }
+        
+        // deal with VP and VS
+        propertiesTIso.clear();
+        refTypesTIso.clear();
+        columnsTIso.clear();
+        for (int iprop = 0; iprop < properties.size(); iprop++) {
+            if (properties[iprop] == Volumetric3D::MaterialProperty::VP) {
+                propertiesTIso.push_back(Volumetric3D::MaterialProperty::VPV);
+                propertiesTIso.push_back(Volumetric3D::MaterialProperty::VPH);
+                refTypesTIso.push_back(refTypes[iprop]);
+                refTypesTIso.push_back(refTypes[iprop]);
+                columnsTIso.push_back(iprop);
+                columnsTIso.push_back(iprop);
+            } else if (properties[iprop] == Volumetric3D::MaterialProperty::VS) {
+                propertiesTIso.push_back(Volumetric3D::MaterialProperty::VSV);
+                propertiesTIso.push_back(Volumetric3D::MaterialProperty::VSH);
+                refTypesTIso.push_back(refTypes[iprop]);
+                refTypesTIso.push_back(refTypes[iprop]);
+                columnsTIso.push_back(iprop);
+                columnsTIso.push_back(iprop);
+            } else {
+                propertiesTIso.push_back(properties[iprop]);
+                refTypesTIso.push_back(refTypes[iprop]);
+                columnsTIso.push_back(iprop);
+            }
+        }
+        
+        // change values
+        for (int iprop = 0; iprop < propertiesTIso.size(); iprop++) {
+            // initialize anisotropy
+            if (!mFullAniso && propertiesTIso[iprop] >= Volumetric3D::MaterialProperty::C11) {
+                initAniso();
+            }
+            
+            RDRow4 &row1D = *prop1DPtr[propertiesTIso[iprop]];
+            RDMatXN &mat3D = *prop3DPtr[propertiesTIso[iprop]];
+            Volumetric3D::MaterialRefType ref_type = refTypesTIso[iprop];
+            for (int ipol = 0; ipol <= nPol; ipol++) {
+                for (int jpol = 0; jpol <= nPol; jpol++) {
+                    const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
+                    int ipnt = ipol * nPntEdge + jpol;
+                    double ref1D = Mapping::interpolate(row1D, xieta);
+                    for (int alpha = 0; alpha < Nr; alpha++) {
+                        int iquery = ipnt * nQuery + (mode2D ? 0 : alpha);
+                        if (!inRange(iquery)) {
+                            // point (r, t, p) not in model range
+                            continue;
                         }
-                        
-                        // // check
-                        // if (mFullAniso) {
-                        //     if (propertiesTIso[iprop] <= Volumetric3D::MaterialProperty::ANIS_ETA) {
-                        //         throw std::runtime_error("Material::addVolumetric3D || " 
-                        //             "Velocity, density and eta can no longer be changed once "
-                        //             "full anisotropy has been activated.");
-                        //     }
-                        // } 
-                        
-                        RDRow4 &row1D = *prop1DPtr[propertiesTIso[iprop]];
-                        RDMatXN &mat3D = *prop3DPtr[propertiesTIso[iprop]];
-                        Volumetric3D::MaterialRefType ref_type = refTypesTIso[iprop];
-                        double value3D = valuesTIso[iprop];
+                        double value3D = values(iquery, columnsTIso[iprop]);
                         if (ref_type == Volumetric3D::MaterialRefType::Absolute) {
                             mat3D(alpha, ipnt) = value3D;
                         } else if (ref_type == Volumetric3D::MaterialRefType::Reference1D) {
-                            double ref1D = Mapping::interpolate(row1D, xieta);
                             mat3D(alpha, ipnt) = ref1D * (1. + value3D);
                         } else if (ref_type == Volumetric3D::MaterialRefType::Reference3D) {
                             mat3D(alpha, ipnt) *= 1. + value3D;
                         } else {
-                            double ref1D = Mapping::interpolate(row1D, xieta);
                             mat3D(alpha, ipnt) = (mat3D(alpha, ipnt) - ref1D) * (1. + value3D) + ref1D;
                         }
                     }
@@ -212,6 +226,16 @@ void Material::addVolumetric3D(const std::vector<Volumetric3D *> &m3D,
         }
     }
     
+    // rotate anisotropy from geographic to source-centred
+    if (mFullAniso) {
+        rotateAniso(srcLat, srcLon, srcDep, phi2D);
+    }
+    
+    // demote weakly 3D elements to 1D
+    if (_3Dprepared() && demoteTol > 0.) {
+        demote3D(demoteTol);
+    }
+    
     // form mass point sampling
     if (_3Dprepared()) {
         for (int ipol = 0; ipol <= nPol; ipol++) {
@@ -223,11 +247,6 @@ void Material::addVolumetric3D(const std::vector<Volumetric3D *> &m3D,
             }
         }
     }
-    
-    // rotate anisotropy from geographic to source-centred
-    if (mFullAniso) {
-        rotateAniso(srcLat, srcLon, srcDep);
-    }
 }
 
 arPP_RDColX Material::computeElementalMass() const {
@@ -283,57 +302,13 @@ Elastic *Material::createElastic(bool elem1D, const AttBuilder *attBuild) const
     }
     
     // elasticity tensor
-    const RDRowN &iFact = mMyQuad->getIntegralFactor(); 
-    RDMatXN vpv3D, vph3D;
-    RDMatXN vsv3D, vsh3D;
-    RDMatXN rho3D;
-    RDMatXN eta3D;
-    RDMatXN qkp3D, qmu3D;
-    
-    if (_3Dprepared()) {
-        vpv3D = mVpv3D;
-        vph3D = mVph3D;
-        vsv3D = mVsv3D;
-        vsh3D = mVsh3D;
-        rho3D = mRho3D;
-        eta3D = mEta3D;
-        qkp3D = mQkp3D;
-        qmu3D = mQmu3D;
-    } else {
-        vpv3D = mVpv3D.replicate(mMyQuad->getNr(), 1);
-        vph3D = mVph3D.replicate(mMyQuad->getNr(), 1);
-        vsv3D = mVsv3D.replicate(mMyQuad->getNr(), 1);
-        vsh3D = mVsh3D.replicate(mMyQuad->getNr(), 1);
-        rho3D = mRho3D.replicate(mMyQuad->getNr(), 1);
-        eta3D = mEta3D.replicate(mMyQuad->getNr(), 1);
-        qkp3D = mQkp3D.replicate(mMyQuad->getNr(), 1);
-        qmu3D = mQmu3D.replicate(mMyQuad->getNr(), 1);
-    }
-    
-    RDMatXN A(rho3D), C(rho3D), F(rho3D), L(rho3D), N(rho3D);
-    for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
-        // A C L N
-        A.col(ipnt).array() *= vph3D.col(ipnt).array().pow(2.) * iFact(ipnt);
-        C.col(ipnt).array() *= vpv3D.col(ipnt).array().pow(2.) * iFact(ipnt);
-        L.col(ipnt).array() *= vsv3D.col(ipnt).array().pow(2.) * iFact(ipnt);
-        N.col(ipnt).array() *= vsh3D.col(ipnt).array().pow(2.) * iFact(ipnt);
-    }
-    // F
-    F = eta3D.schur(A - 2. * L);
-    // must do relabelling before attenuation
-    if (mMyQuad->hasRelabelling()) {
-        const RDMatXN &J = mMyQuad->getRelabelling().getStiffJacobian();
-        A = A.schur(J);
-        C = C.schur(J);
-        F = F.schur(J);
-        L = L.schur(J);
-        N = N.schur(J);
-    }
+    RDMatXN A, C, F, L, N, qkp3D, qmu3D;
+    computeTIsoModuli(A, C, F, L, N, qkp3D, qmu3D);
     
     // attenuation
     Attenuation1D *att1D = 0;
     Attenuation3D *att3D = 0;
-    if (attBuild) {
+    if (attBuild && !attBuild->isNegligible(qkp3D, qmu3D)) {
         // Voigt average
         RDMatXN kappa = (4. * A + C + 4. * F - 4. * N) / 9.;
         RDMatXN mu = (A + C - 2. * F + 6. * L + 5. * N) / 15.;
@@ -378,6 +353,46 @@ Elastic *Material::createElastic(bool elem1D, const AttBuilder *attBuild) const
     }
 }
 
+void Material::computeTIsoModuli(RDMatXN &A, RDMatXN &C, RDMatXN &F, RDMatXN &L, RDMatXN &N, 
+    RDMatXN &qkp3D, RDMatXN &qmu3D) const {
+    const RDRowN &iFact = mMyQuad->getIntegralFactor(); 
+    // views of the 3D material, replicated only if not prepared
+    RDMatXN buf[6];
+    const RDMatXN &vpv3D = full3D(mVpv3D, buf[0]);
+    const RDMatXN &vph3D = full3D(mVph3D, buf[1]);
+    const RDMatXN &vsv3D = full3D(mVsv3D, buf[2]);
+    const RDMatXN &vsh3D = full3D(mVsh3D, buf[3]);
+    const RDMatXN &rho3D = full3D(mRho3D, buf[4]);
+    const RDMatXN &eta3D = full3D(mEta3D, buf[5]);
+    qkp3D = mQkp3D.replicate(mMyQuad->getNr() / mQkp3D.rows(), 1);
+    qmu3D = mQmu3D.replicate(mMyQuad->getNr() / mQmu3D.rows(), 1);
+    
+    // A C L N
+    A = (rho3D.array() * vph3D.array().square()).matrix() * iFact.asDiagonal();
+    C = (rho3D.array() * vpv3D.array().square()).matrix() * iFact.asDiagonal();
+    L = (rho3D.array() * vsv3D.array().square()).matrix() * iFact.asDiagonal();
+    N = (rho3D.array() * vsh3D.array().square()).matrix() * iFact.asDiagonal();
+    // F
+    F = eta3D.schur(A - 2. * L);
+    // must do relabelling before attenuation
+    if (mMyQuad->hasRelabelling()) {
+        const RDMatXN &J = mMyQuad->getRelabelling().getStiffJacobian();
+        A = A.schur(J);
+        C = C.schur(J);
+        F = F.schur(J);
+        L = L.schur(J);
+        N = N.schur(J);
+    }
+}
+
+const RDMatXN &Material::full3D(const RDMatXN &mat, RDMatXN &buffer) const {
+    if (mat.rows() == mMyQuad->getNr()) {
+        return mat;
+    }
+    buffer = mat.replicate(mMyQuad->getNr(), 1);
+    return buffer;
+}
+
 Elastic *Material::createElasticAniso(bool elem1D, const AttBuilder *attBuild) const {
     // elasticity tensor
     const RDRowN &iFact = mMyQuad->getIntegralFactor(); 
@@ -439,7 +454,7 @@ Elastic *Material::createElasticAniso(bool elem1D, const AttBuilder *attBuild) c
     // attenuation
     Attenuation1D *att1D = 0;
     Attenuation3D *att3D = 0;
-    if (attBuild) {
+    if (attBuild && !attBuild->isNegligible(mQkp3D, mQmu3D)) {
         // Voigt average
         // https://materialsproject.org/wiki/index.php/Elasticity_calculations
         RDMatXN kappa = (C11_3D + C22_3D + C33_3D + 2. * (C12_3D + C23_3D + C13_3D)) / 9.;
@@ -507,6 +522,38 @@ Elastic *Material::createElasticAniso(bool elem1D, const AttBuilder *attBuild) c
             C66_1D.cast<Real>(), 
             att1D);
     } else {
+        // most anisotropy models are hexagonal with a tilted axis, 
+        // for which 8 fields are stored instead of 21
+        RDMatXN hLambda(C11_3D.rows(), nPntElem), hMu(hLambda), hA(hLambda), hB(hLambda), hC(hLambda);
+        RDMatXN hN1(hLambda), hN2(hLambda), hN3(hLambda);
+        bool hexagonal = true;
+        RDMat66 inCijkl;
+        RDColX hexa;
+        RDCol3 n;
+        for (int alpha = 0; alpha < C11_3D.rows() && hexagonal; alpha++) {
+            for (int ipnt = 0; ipnt < nPntElem && hexagonal; ipnt++) {
+                inCijkl << C11_3D(alpha, ipnt), C12_3D(alpha, ipnt), C13_3D(alpha, ipnt), C14_3D(alpha, ipnt), C15_3D(alpha, ipnt), C16_3D(alpha, ipnt),
+                           C12_3D(alpha, ipnt), C22_3D(alpha, ipnt), C23_3D(alpha, ipnt), C24_3D(alpha, ipnt), C25_3D(alpha, ipnt), C26_3D(alpha, ipnt),
+                           C13_3D(alpha, ipnt), C23_3D(alpha, ipnt), C33_3D(alpha, ipnt), C34_3D(alpha, ipnt), C35_3D(alpha, ipnt), C36_3D(alpha, ipnt),
+                           C14_3D(alpha, ipnt), C24_3D(alpha, ipnt), C34_3D(alpha, ipnt), C44_3D(alpha, ipnt), C45_3D(alpha, ipnt), C46_3D(alpha, ipnt),
+                           C15_3D(alpha, ipnt), C25_3D(alpha, ipnt), C35_3D(alpha, ipnt), C45_3D(alpha, ipnt), C55_3D(alpha, ipnt), C56_3D(alpha, ipnt),
+                           C16_3D(alpha, ipnt), C26_3D(alpha, ipnt), C36_3D(alpha, ipnt), C46_3D(alpha, ipnt), C56_3D(alpha, ipnt), C66_3D(alpha, ipnt);
+                hexagonal = fitHexagonal(inCijkl, 1e-7, hexa, n);
+                hLambda(alpha, ipnt) = hexa(0);
+                hMu(alpha, ipnt) = hexa(1);
+                hA(alpha, ipnt) = hexa(2);
+                hB(alpha, ipnt) = hexa(3);
+                hC(alpha, ipnt) = hexa(4);
+                hN1(alpha, ipnt) = n(0);
+                hN2(alpha, ipnt) = n(1);
+                hN3(alpha, ipnt) = n(2);
+            }
+        }
+        if (hexagonal) {
+            return new Hexagonal3D(hLambda.cast<Real>(), hMu.cast<Real>(), 
+                hA.cast<Real>(), hB.cast<Real>(), hC.cast<Real>(), 
+                hN1.cast<Real>(), hN2.cast<Real>(), hN3.cast<Real>(), att3D);
+        }
         return new Anisotropic3D(
             C11_3D.cast<Real>(), C12_3D.cast<Real>(), C13_3D.cast<Real>(), C14_3D.cast<Real>(), C15_3D.cast<Real>(), C16_3D.cast<Real>(),
             C22_3D.cast<Real>(), C23_3D.cast<Real>(), C24_3D.cast<Real>(), C25_3D.cast<Real>(), C26_3D.cast<Real>(),
@@ -518,21 +565,104 @@ Elastic *Material::createElasticAniso(bool elem1D, const AttBuilder *attBuild) c
     }
 }
 
+Elastic *Material::createElasticFourier(int order, const AttBuilder *attBuild) const {
+    // elasticity tensor
+    RDMatXN A, C, F, L, N, qkp3D, qmu3D;
+    computeTIsoModuli(A, C, F, L, N, qkp3D, qmu3D);
+    int nr = mMyQuad->getNr();
+    
+    // attenuation
+    Attenuation1D *att1D = 0;
+    if (attBuild && !attBuild->isNegligible(qkp3D, qmu3D)) {
+        // Voigt average
+        RDMatXN kappa = (4. * A + C + 4. * F - 4. * N) / 9.;
+        RDMatXN mu = (A + C - 2. * F + 6. * L + 5. * N) / 15.;
+        A -= (kappa + 4. / 3. * mu);
+        C -= (kappa + 4. / 3. * mu);
+        F -= (kappa - 2. / 3. * mu);
+        L -= mu;
+        N -= mu;
+        // memory variables are based on the azimuthal average; the change of 
+        // the elastic moduli depends only on Q (1D here), so it is applied 
+        // to the 3D moduli as a ratio
+        const RDMatXN &kappaAvg = kappa.colwise().mean().replicate(nr, 1);
+        const RDMatXN &muAvg = mu.colwise().mean().replicate(nr, 1);
+        RDMatXN kappaAtt(kappaAvg), muAtt(muAvg);
+        att1D = attBuild->createAttenuation1D(qkp3D, qmu3D, kappaAtt, muAtt, mMyQuad);
+        kappa = kappa.schur(kappaAtt.cwiseQuotient(kappaAvg));
+        mu = mu.schur(muAtt.cwiseQuotient(muAvg));
+        A += (kappa + 4. / 3. * mu);
+        C += (kappa + 4. / 3. * mu);
+        F += (kappa - 2. / 3. * mu);
+        L += mu;
+        N += mu;
+    }
+    
+    // Fourier coefficients up to order
+    std::vector<RDMatXN *> moduli = {&A, &C, &F, &L, &N};
+    std::vector<vec_CMatPP> fourier(moduli.size(), vec_CMatPP(order + 1));
+    for (int imod = 0; imod < moduli.size(); imod++) {
+        for (int ipol = 0; ipol <= nPol; ipol++) {
+            for (int jpol = 0; jpol <= nPol; jpol++) {
+                int ipnt = ipol * nPntEdge + jpol;
+                PreloopFFTW::getR2C_RMat(nr) = moduli[imod]->col(ipnt);
+                PreloopFFTW::computeR2C(nr);
+                const CDColX &coeffs = PreloopFFTW::getR2C_CMat(nr);
+                for (int k = 0; k <= order; k++) {
+                    fourier[imod][k](ipol, jpol) = (Complex)coeffs(k);
+                }
+            }
+        }
+    }
+    return new TransverselyIsotropicFourier(fourier[0], fourier[1], fourier[2], 
+        fourier[3], fourier[4], isIsotropic(), att1D);
+}
+
+int Material::getFourierOrderSolid(bool attenuation) const {
+    if (mFourierMaxOrder <= 0 || !_3Dprepared() || mFullAniso || mMyQuad->isFluid()) {
+        return -1;
+    }
+    // Q must be 1D to use 1D attenuation
+    if (attenuation && !(XMath::equalRows(mQkp3D) && XMath::equalRows(mQmu3D))) {
+        return -1;
+    }
+    
+    // maximum amplitude of each azimuthal order over moduli and points
+    RDMatXN A, C, F, L, N, qkp3D, qmu3D;
+    computeTIsoModuli(A, C, F, L, N, qkp3D, qmu3D);
+    std::vector<RDMatXN *> moduli = {&A, &C, &F, &L, &N};
+    int nr = mMyQuad->getNr();
+    RDColX amplitude = RDColX::Zero(nr / 2 + 1);
+    for (const auto &modulus: moduli) {
+        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+            PreloopFFTW::getR2C_RMat(nr) = modulus->col(ipnt);
+            PreloopFFTW::computeR2C(nr);
+            const CDColX &coeffs = PreloopFFTW::getR2C_CMat(nr);
+            amplitude = amplitude.cwiseMax(coeffs.cwiseAbs());
+        }
+    }
+    
+    // lowest order beyond which all coefficients are negligible
+    int order = nr / 2;
+    while (order > 0 && amplitude(order) <= mFourierTol * amplitude(0)) {
+        order--;
+    }
+    // the convolution must be much cheaper than the FFT pair
+    if (order > mFourierMaxOrder || 4 * order >= nr) {
+        return -1;
+    }
+    return order;
+}
+
 double Material::getVMaxRef() const {
     return std::max(mVph1D.maxCoeff(), mVpv1D.maxCoeff());
 }
 
 RDColX Material::getVMax() const {
-    RDMatXN vpv3D, vph3D;
-    if (_3Dprepared()) {
-        vpv3D = mVpv3D;
-        vph3D = mVph3D;
-    } else {
-        vpv3D = mVpv3D.replicate(mMyQuad->getNr(), 1);
-        vph3D = mVph3D.replicate(mMyQuad->getNr(), 1);
-    }
-    const RDColX &vpvMax = vpv3D.rowwise().maxCoeff();
-    const RDColX &vphMax = vph3D.rowwise().maxCoeff();
+    // rows are replicated if not prepared 
+    int Nr = mMyQuad->getNr();
+    const RDColX &vpvMax = mVpv3D.rowwise().maxCoeff().replicate(Nr / mVpv3D.rows(), 1);
+    const RDColX &vphMax = mVph3D.rowwise().maxCoeff().replicate(Nr / mVph3D.rows(), 1);
     return (vpvMax.array().max(vphMax.array())).matrix();
 }
 
@@ -581,108 +711,112 @@ RDMatXN Material::getProperty(const std::string &vname, int refType) {
     if (boost::iequals(vname, "vs")) {
         varname = "vsv";
     }
-    RDRow4 data1D;
-    RDMatXN data3D;
+    // select without copying
+    const RDRow4 *data1D = 0;
+    const RDMatXN *data3D = 0;
     if (boost::iequals(varname, "vpv")) {
-        data1D = mVpv1D;
-        data3D = mVpv3D;
+        data1D = &mVpv1D;
+        data3D = &mVpv3D;
     } else if (boost::iequals(varname, "vsv")) {
-        data1D = mVsv1D;
-        data3D = mVsv3D;
+        data1D = &mVsv1D;
+        data3D = &mVsv3D;
     } else if (boost::iequals(varname, "vph")) {
-        data1D = mVph1D;
-        data3D = mVph3D;
+        data1D = &mVph1D;
+        data3D = &mVph3D;
     } else if (boost::iequals(varname, "vsh")) {
-        data1D = mVsh1D;
-        data3D = mVsh3D;
+        data1D = &mVsh1D;
+        data3D = &mVsh3D;
     } else if (boost::iequals(varname, "rho")) {
-        data1D = mRho1D;
-        data3D = mRho3D;
+        data1D = &mRho1D;
+        data3D = &mRho3D;
     } else if (boost::iequals(varname, "eta")) {
-        data1D = mEta1D;
-        data3D = mEta3D;
+        data1D = &mEta1D;
+        data3D = &mEta3D;
     } else if (boost::iequals(varname, "qkappa")) {
-        data1D = mQkp1D;
-        data3D = mQkp3D;
+        data1D = &mQkp1D;
+        data3D = &mQkp3D;
     } else if (boost::iequals(varname, "qmu")) {
-        data1D = mQmu1D;
-        data3D = mQmu3D;
+        data1D = &mQmu1D;
+        data3D = &mQmu3D;
     } else if (mFullAniso) {
         if (boost::iequals(varname, "c11")) {
-            data1D = mC11_1D;
-            data3D = mC11_3D;
+            data1D = &mC11_1D;
+            data3D = &mC11_3D;
         } else if (boost::iequals(varname, "c12")) {
-            data1D = mC12_1D;
-            data3D = mC12_3D;
+            data1D = &mC12_1D;
+            data3D = &mC12_3D;
         } else if (boost::iequals(varname, "c13")) {
-            data1D = mC13_1D;
-            data3D = mC13_3D;
+            data1D = &mC13_1D;
+            data3D = &mC13_3D;
         } else if (boost::iequals(varname, "c14")) {
-            data1D = mC14_1D;
-            data3D = mC14_3D;
+            data1D = &mC14_1D;
+            data3D = &mC14_3D;
         } else if (boost::iequals(varname, "c15")) {
-            data1D = mC15_1D;
-            data3D = mC15_3D;
+            data1D = &mC15_1D;
+            data3D = &mC15_3D;
         } else if (boost::iequals(varname, "c16")) {
-            data1D = mC16_1D;
-            data3D = mC16_3D;
+            data1D = &mC16_1D;
+            data3D = &mC16_3D;
         } else if (boost::iequals(varname, "c22")) {
-            data1D = mC22_1D;
-            data3D = mC22_3D;
+            data1D = &mC22_1D;
+            data3D = &mC22_3D;
         } else if (boost::iequals(varname, "c23")) {
-            data1D = mC23_1D;
-            data3D = mC23_3D;
+            data1D = &mC23_1D;
+            data3D = &mC23_3D;
         } else if (boost::iequals(varname, "c24")) {
-            data1D = mC24_1D;
-            data3D = mC24_3D;
+            data1D = &mC24_1D;
+            data3D = &mC24_3D;
         } else if (boost::iequals(varname, "c25")) {
-            data1D = mC25_1D;
-            data3D = mC25_3D;
+            data1D = &mC25_1D;
+            data3D = &mC25_3D;
         } else if (boost::iequals(varname, "c26")) {
-            data1D = mC26_1D;
-            data3D = mC26_3D;
+            data1D = &mC26_1D;
+            data3D = &mC26_3D;
         } else if (boost::iequals(varname, "c33")) {
-            data1D = mC33_1D;
-            data3D = mC33_3D;
+            data1D = &mC33_1D;
+            data3D = &mC33_3D;
         } else if (boost::iequals(varname, "c34")) {
-            data1D = mC34_1D;
-            data3D = mC34_3D;
+            data1D = &mC34_1D;
+            data3D = &mC34_3D;
         } else if (boost::iequals(varname, "c35")) {
-            data1D = mC35_1D;
-            data3D = mC35_3D;
+            data1D = &mC35_1D;
+            data3D = &mC35_3D;
         } else if (boost::iequals(varname, "c36")) {
-            data1D = mC36_1D;
-            data3D = mC36_3D;
+            data1D = &mC36_1D;
+            data3D = &mC36_3D;
         } else if (boost::iequals(varname, "c44")) {
-            data1D = mC44_1D;
-            data3D = mC44_3D;
+            data1D = &mC44_1D;
+            data3D = &mC44_3D;
         } else if (boost::iequals(varname, "c45")) {
-            data1D = mC45_1D;
-            data3D = mC45_3D;
+            data1D = &mC45_1D;
+            data3D = &mC45_3D;
         } else if (boost::iequals(varname, "c46")) {
-            data1D = mC46_1D;
-            data3D = mC46_3D;
+            data1D = &mC46_1D;
+            data3D = &mC46_3D;
         } else if (boost::iequals(varname, "c55")) {
-            data1D = mC55_1D;
-            data3D = mC55_3D;
+            data1D = &mC55_1D;
+            data3D = &mC55_3D;
         } else if (boost::iequals(varname, "c56")) {
-            data1D = mC56_1D;
-            data3D = mC56_3D;
+            data1D = &mC56_1D;
+            data3D = &mC56_3D;
         } else if (boost::iequals(varname, "c66")) {
-            data1D = mC66_1D;
-            data3D = mC66_3D;
+            data1D = &mC66_1D;
+            data3D = &mC66_3D;
         } 
     } else {
         throw std::runtime_error("Material::getProperty || Unknown field variable name: " + vname);
     }
     
-    if (data3D.rows() != Nr) {
-        data3D = data3D.replicate(Nr, 1);
+    // unknown anisotropic component
+    if (data3D == 0) {
+        throw std::runtime_error("Material::getProperty || Unknown field variable name: " + vname);
     }
+    RDMatXN buffer;
+    const RDMatXN &data3DXN = full3D(*data3D, buffer);
     
     // 3D
     if (refType == SlicePlot::PropertyRefTypes::Property3D) {
-        return data3D;
+        return data3DXN;
     }
     
     // fill 1D
@@ -691,7 +825,7 @@ RDMatXN Material::getProperty(const std::string &vname, int refType) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             int ipnt = ipol * nPntEdge + jpol;
             const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
-            data1DXN.col(ipnt).fill(Mapping::interpolate(data1D, xieta));
+            data1DXN.col(ipnt).fill(Mapping::interpolate(*data1D, xieta));
         }
     }
     
@@ -702,7 +836,7 @@ RDMatXN Material::getProperty(const std::string &vname, int refType) {
     
     // perturb
     RDMatXN data1DBase = data1DXN.array().max(tinyDouble).matrix(); // in fluid, vs = 0
-    return ((data3D - data1DXN).array() / data1DBase.array()).matrix();
+    return ((data3DXN - data1DXN).array() / data1DBase.array()).matrix();
 }
 
 void Material::initAniso() {
@@ -750,114 +884,71 @@ void Material::initAniso() {
     mFullAniso = true;
 }
 
-void Material::rotateAniso(double srcLat, double srcLon, double srcDep) {
-    RDMatXX inCijkl(6, 6);
+void Material::rotateAniso(double srcLat, double srcLon, double srcDep, double phi2D) {
+    // upper triangle of the Voigt matrix
+    const std::array<RDMatXN *, 21> c3D = {
+        &mC11_3D, &mC12_3D, &mC13_3D, &mC14_3D, &mC15_3D, &mC16_3D,
+        &mC22_3D, &mC23_3D, &mC24_3D, &mC25_3D, &mC26_3D,
+        &mC33_3D, &mC34_3D, &mC35_3D, &mC36_3D,
+        &mC44_3D, &mC45_3D, &mC46_3D,
+        &mC55_3D, &mC56_3D,
+        &mC66_3D};
+    RDMat66 inCijkl;
     
     // 3D
-    for (int alpha = 0; alpha < mC11_3D.rows(); alpha++) {
-        // azimuth of the slice
-        double phi = 2. * pi / mC11_3D.rows() * alpha;
-        // loop over GLL points
-        for (int ipol = 0; ipol <= nPol; ipol++) {
-            for (int jpol = 0; jpol <= nPol; jpol++) {
-                int ipnt = ipol * nPntEdge + jpol;
-
-                inCijkl(1 - 1, 1 - 1) = mC11_3D(alpha, ipnt);
-                inCijkl(1 - 1, 2 - 1) = mC12_3D(alpha, ipnt);
-                inCijkl(1 - 1, 3 - 1) = mC13_3D(alpha, ipnt);
-                inCijkl(1 - 1, 4 - 1) = mC14_3D(alpha, ipnt);
-                inCijkl(1 - 1, 5 - 1) = mC15_3D(alpha, ipnt);
-                inCijkl(1 - 1, 6 - 1) = mC16_3D(alpha, ipnt);
-                
-                inCijkl(2 - 1, 1 - 1) = mC12_3D(alpha, ipnt);
-                inCijkl(2 - 1, 2 - 1) = mC22_3D(alpha, ipnt);
-                inCijkl(2 - 1, 3 - 1) = mC23_3D(alpha, ipnt);
-                inCijkl(2 - 1, 4 - 1) = mC24_3D(alpha, ipnt);
-                inCijkl(2 - 1, 5 - 1) = mC25_3D(alpha, ipnt);
-                inCijkl(2 - 1, 6 - 1) = mC26_3D(alpha, ipnt);
-                
-                inCijkl(3 - 1, 1 - 1) = mC13_3D(alpha, ipnt);
-                inCijkl(3 - 1, 2 - 1) = mC23_3D(alpha, ipnt);
-                inCijkl(3 - 1, 3 - 1) = mC33_3D(alpha, ipnt);
-                inCijkl(3 - 1, 4 - 1) = mC34_3D(alpha, ipnt);
-                inCijkl(3 - 1, 5 - 1) = mC35_3D(alpha, ipnt);
-                inCijkl(3 - 1, 6 - 1) = mC36_3D(alpha, ipnt);
-                
-                inCijkl(4 - 1, 1 - 1) = mC14_3D(alpha, ipnt);
-                inCijkl(4 - 1, 2 - 1) = mC24_3D(alpha, ipnt);
-                inCijkl(4 - 1, 3 - 1) = mC34_3D(alpha, ipnt);
-                inCijkl(4 - 1, 4 - 1) = mC44_3D(alpha, ipnt);
-                inCijkl(4 - 1, 5 - 1) = mC45_3D(alpha, ipnt);
-                inCijkl(4 - 1, 6 - 1) = mC46_3D(alpha, ipnt);
-                
-                inCijkl(5 - 1, 1 - 1) = mC15_3D(alpha, ipnt);
-                inCijkl(5 - 1, 2 - 1) = mC25_3D(alpha, ipnt);
-                inCijkl(5 - 1, 3 - 1) = mC35_3D(alpha, ipnt);
-                inCijkl(5 - 1, 4 - 1) = mC45_3D(alpha, ipnt);
-                inCijkl(5 - 1, 5 - 1) = mC55_3D(alpha, ipnt);
-                inCijkl(5 - 1, 6 - 1) = mC56_3D(alpha, ipnt);
+    int nr = mC11_3D.rows();
+    // 2D mode: all slices take the rotation at the azimuth of the plane
+    bool mode2D = phi2D > -DBL_MAX * .9;
+    int nrot = mode2D ? 1 : nr;
+    const SourceRotation rotation(srcLat, srcLon, srcDep);
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            int ipnt = ipol * nPntEdge + jpol;
+            // location of the GLL point, the same on all slices
+            const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
+            RDCol2 rtheta = Geodesy::rtheta(mMyQuad->mapping(xieta));
+            RDCol3 rtpS, rtpG;
+            rtpS(0) = rtheta(0);
+            rtpS(1) = rtheta(1);
+            for (int alpha = 0; alpha < nrot; alpha++) {
+                int ic = 0;
+                for (int i = 0; i < 6; i++) {
+                    for (int j = i; j < 6; j++) {
+                        inCijkl(i, j) = inCijkl(j, i) = (*c3D[ic++])(alpha, ipnt);
+                    }
+                }
                 
-                inCijkl(6 - 1, 1 - 1) = mC16_3D(alpha, ipnt);
-                inCijkl(6 - 1, 2 - 1) = mC26_3D(alpha, ipnt);
-                inCijkl(6 - 1, 3 - 1) = mC36_3D(alpha, ipnt);
-                inCijkl(6 - 1, 4 - 1) = mC46_3D(alpha, ipnt);
-                inCijkl(6 - 1, 5 - 1) = mC56_3D(alpha, ipnt);
-                inCijkl(6 - 1, 6 - 1) = mC66_3D(alpha, ipnt);
-            
-                // compute backazimuth
-                const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
-                RDCol2 rtheta = Geodesy::rtheta(mMyQuad->mapping(xieta));
-                RDCol3 rtpS, rtpG;
-                rtpS(0) = rtheta(0);
-                rtpS(1) = rtheta(1);
-                rtpS(2) = phi;
-                rtpG = Geodesy::rotateSrc2Glob(rtpS, srcLat, srcLon, srcDep);
-                double recDep = Geodesy::getROuter() - rtheta(0);
-                double recLat = Geodesy::theta2Lat_d(rtpG(1), recDep);
-                double recLon = Geodesy::phi2Lon(rtpG(2));
-                double baz = Geodesy::backAzimuth(srcLat, srcLon, srcDep, recLat, recLon, recDep);
+                // compute backazimuth at the azimuth of the slice
+                rtpS(2) = mode2D ? phi2D : 2. * pi / nr * alpha;
+                rtpG = rotation.src2Glob(rtpS);
+                double baz = rotation.backAzimuth(rtpG(1), rtpG(2));
                 
                 // global => source centred RTZ (theta, phi, r)
-                const RDMatXX &outCijkl = bondTransformation(inCijkl, 0., 0., -baz);
+                const RDMat66 &outCijkl = bondTransformation(inCijkl, 0., 0., -baz);
                 
                 // by convention, input is in RTZ 
                 // // (r, theta, phi) => (R, T, Z)
-                // const RDMatXX &RTZ_Cijkl_x = bondTransformation(rtp_Cijkl, 0., 0., pi/2.);
-                // const RDMatXX &outCijkl = bondTransformation(RTZ_Cijkl_x, pi/2., 0., 0.);
+                // const RDMat66 &RTZ_Cijkl_x = bondTransformation(rtp_Cijkl, 0., 0., pi/2.);
+                // const RDMat66 &outCijkl = bondTransformation(RTZ_Cijkl_x, pi/2., 0., 0.);
                 
                 // copy back
-                mC11_3D(alpha, ipnt) = outCijkl(1 - 1, 1 - 1);
-                mC12_3D(alpha, ipnt) = outCijkl(1 - 1, 2 - 1);
-                mC13_3D(alpha, ipnt) = outCijkl(1 - 1, 3 - 1);
-                mC14_3D(alpha, ipnt) = outCijkl(1 - 1, 4 - 1);
-                mC15_3D(alpha, ipnt) = outCijkl(1 - 1, 5 - 1);
-                mC16_3D(alpha, ipnt) = outCijkl(1 - 1, 6 - 1);
-                
-                mC22_3D(alpha, ipnt) = outCijkl(2 - 1, 2 - 1);
-                mC23_3D(alpha, ipnt) = outCijkl(2 - 1, 3 - 1);
-                mC24_3D(alpha, ipnt) = outCijkl(2 - 1, 4 - 1);
-                mC25_3D(alpha, ipnt) = outCijkl(2 - 1, 5 - 1);
-                mC26_3D(alpha, ipnt) = outCijkl(2 - 1, 6 - 1);
-                
-                mC33_3D(alpha, ipnt) = outCijkl(3 - 1, 3 - 1);
-                mC34_3D(alpha, ipnt) = outCijkl(3 - 1, 4 - 1);
-                mC35_3D(alpha, ipnt) = outCijkl(3 - 1, 5 - 1);
-                mC36_3D(alpha, ipnt) = outCijkl(3 - 1, 6 - 1);
-                
-                mC44_3D(alpha, ipnt) = outCijkl(4 - 1, 4 - 1);
-                mC45_3D(alpha, ipnt) = outCijkl(4 - 1, 5 - 1);
-                mC46_3D(alpha, ipnt) = outCijkl(4 - 1, 6 - 1);
-                
-                mC55_3D(alpha, ipnt) = outCijkl(5 - 1, 5 - 1);
-                mC56_3D(alpha, ipnt) = outCijkl(5 - 1, 6 - 1);
-                
-                mC66_3D(alpha, ipnt) = outCijkl(6 - 1, 6 - 1);
+                ic = 0;
+                for (int i = 0; i < 6; i++) {
+                    for (int j = i; j < 6; j++) {
+                        (*c3D[ic++])(alpha, ipnt) = outCijkl(i, j);
+                    }
+                }
+            }
+            if (mode2D) {
+                for (int ic = 0; ic < 21; ic++) {
+                    c3D[ic]->col(ipnt).setConstant((*c3D[ic])(0, ipnt));
+                }
             }
         }
     }
 }
 
-RDMatXX Material::bondTransformation(RDMatXX inCijkl, double alpha, double beta, double gamma) {
+RDMat66 Material::bondTransformation(const RDMat66 &inCijkl, double alpha, double beta, double gamma) {
     RDMat33 R1, R2, R3, R;
     R1 << 1., 0., 0.,
           0., cos(alpha), sin(alpha),
@@ -889,14 +980,42 @@ RDMatXX Material::bondTransformation(RDMatXX inCijkl, double alpha, double beta,
           R(0, 2) * R(1, 0) + R(0, 0) * R(1, 2), 
           R(0, 0) * R(1, 1) + R(0, 1) * R(1, 0);
     
-    RDMatXX K(6, 6);
+    RDMat66 K;
     K.block(0, 0, 3, 3) = K1;
     K.block(0, 3, 3, 3) = 2. * K2;
     K.block(3, 0, 3, 3) = K3;
     K.block(3, 3, 3, 3) = K4;
     
-    RDMatXX outCijkl(K * inCijkl * K.transpose());
-    return outCijkl;
+    return K * inCijkl * K.transpose();
+}
+
+void Material::sync3D(PackedBuffer &buf) {
+    // 1D moduli are changed by initAniso
+    std::vector<RDRow4 *> prop1DPtr = {&mVpv1D, &mVph1D, &mVsv1D, &mVsh1D, &mRho1D, &mEta1D, &mQkp1D, &mQmu1D,
+                                       &mC11_1D, &mC12_1D, &mC13_1D, &mC14_1D, &mC15_1D, &mC16_1D,
+                                       &mC22_1D, &mC23_1D, &mC24_1D, &mC25_1D, &mC26_1D,
+                                       &mC33_1D, &mC34_1D, &mC35_1D, &mC36_1D,
+                                       &mC44_1D, &mC45_1D, &mC46_1D,
+                                       &mC55_1D, &mC56_1D,
+                                       &mC66_1D};
+    std::vector<RDMatXN *> prop3DPtr = {&mVpv3D, &mVph3D, &mVsv3D, &mVsh3D, &mRho3D, &mEta3D, &mQkp3D, &mQmu3D,
+                                        &mC11_3D, &mC12_3D, &mC13_3D, &mC14_3D, &mC15_3D, &mC16_3D,
+                                        &mC22_3D, &mC23_3D, &mC24_3D, &mC25_3D, &mC26_3D,
+                                        &mC33_3D, &mC34_3D, &mC35_3D, &mC36_3D,
+                                        &mC44_3D, &mC45_3D, &mC46_3D,
+                                        &mC55_3D, &mC56_3D,
+                                        &mC66_3D};
+    for (const auto &prop: prop1DPtr) {
+        buf.syncEigen(*prop);
+    }
+    for (const auto &prop: prop3DPtr) {
+        buf.syncEigen(*prop);
+    }
+    buf.syncValue(mFullAniso);
+    buf.syncValue(mFourierMaxOrder);
+    buf.syncValue(mFourierTol);
+    buf.syncEigenArray(mRhoMass3D);
+    buf.syncEigenArray(mVpFluid3D);
 }
 
 void Material::prepare3D() {
@@ -935,4 +1054,102 @@ bool Material::_3Dprepared() const {
     return mVpv3D.rows() == mMyQuad->getNr();
 }
 
+void Material::demote3D(double tol) {
+    std::vector<RDMatXN *> prop3DPtr = {&mVpv3D, &mVph3D, &mVsv3D, &mVsh3D, &mRho3D, &mEta3D, &mQkp3D, &mQmu3D};
+    if (mFullAniso) {
+        std::vector<RDMatXN *> aniso3DPtr = {&mC11_3D, &mC12_3D, &mC13_3D, &mC14_3D, &mC15_3D, &mC16_3D,
+                                             &mC22_3D, &mC23_3D, &mC24_3D, &mC25_3D, &mC26_3D,
+                                             &mC33_3D, &mC34_3D, &mC35_3D, &mC36_3D,
+                                             &mC44_3D, &mC45_3D, &mC46_3D,
+                                             &mC55_3D, &mC56_3D,
+                                             &mC66_3D};
+        prop3DPtr.insert(prop3DPtr.end(), aniso3DPtr.begin(), aniso3DPtr.end());
+    }
+    
+    // maximum deviation from the azimuthal average, relative to 
+    // the largest average of the same property in the element
+    RDMatXX means(prop3DPtr.size(), nPntElem);
+    for (int iprop = 0; iprop < prop3DPtr.size(); iprop++) {
+        const RDMatXN &prop = *prop3DPtr[iprop];
+        means.row(iprop) = prop.colwise().mean();
+        double scale = means.row(iprop).cwiseAbs().maxCoeff();
+        double dev = (prop.rowwise() - means.row(iprop)).cwiseAbs().maxCoeff();
+        if (dev > tol * scale) {
+            return;
+        }
+    }
+    
+    // replace by the azimuthal average
+    for (int iprop = 0; iprop < prop3DPtr.size(); iprop++) {
+        int nr = prop3DPtr[iprop]->rows();
+        *prop3DPtr[iprop] = means.row(iprop).replicate(nr, 1);
+    }
+}
+
+bool Material::fitHexagonal(const RDMat66 &inCijkl, double tol, RDColX &hexa, RDCol3 &n) {
+    // Voigt index of (i, j)
+    static const int voigt[3][3] = {{0, 5, 4}, {5, 1, 3}, {4, 3, 2}};
+    
+    // the symmetry axis is the distinct eigenvector of the dilatational 
+    // tensor C_ijkk, or of the Voigt tensor C_ijkj if the former is isotropic 
+    RDMat33 dil, vgt;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            dil(i, j) = vgt(i, j) = 0.;
+            for (int k = 0; k < 3; k++) {
+                dil(i, j) += inCijkl(voigt[i][j], voigt[k][k]);
+                vgt(i, j) += inCijkl(voigt[i][k], voigt[j][k]);
+            }
+        }
+    }
+    double norm = inCijkl.norm();
+    n << 0., 0., 1.;
+    for (const RDMat33 &axial: {dil, vgt}) {
+        Eigen::SelfAdjointEigenSolver<RDMat33> eig(axial);
+        const RDCol3 &ev = eig.eigenvalues();
+        if (ev(2) - ev(0) > tol * norm) {
+            n = eig.eigenvectors().col(ev(1) - ev(0) > ev(2) - ev(1) ? 0 : 2);
+            break;
+        }
+    }
+    
+    // Voigt matrices of the five basis tensors
+    std::array<RDMat66, 5> basis;
+    for (auto &b: basis) {
+        b.setZero();
+    }
+    RDMat33 I = RDMat33::Identity();
+    for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) {
+            for (int k = 0; k < 3; k++) {
+                for (int l = k; l < 3; l++) {
+                    int I6 = voigt[i][j];
+                    int J6 = voigt[k][l];
+                    basis[0](I6, J6) = I(i, j) * I(k, l);
+                    basis[1](I6, J6) = I(i, k) * I(j, l) + I(i, l) * I(j, k);
+                    basis[2](I6, J6) = I(i, j) * n(k) * n(l) + n(i) * n(j) * I(k, l);
+                    basis[3](I6, J6) = n(i) * n(j) * n(k) * n(l);
+                    basis[4](I6, J6) = I(i, k) * n(j) * n(l) + I(i, l) * n(j) * n(k) 
+                                     + I(j, k) * n(i) * n(l) + I(j, l) * n(i) * n(k);
+                }
+            }
+        }
+    }
+    
+    // least squares 
+    RDMatXX gram(5, 5);
+    RDColX rhs(5);
+    for (int m = 0; m < 5; m++) {
+        rhs(m) = basis[m].cwiseProduct(inCijkl).sum();
+        for (int q = 0; q < 5; q++) {
+            gram(m, q) = basis[m].cwiseProduct(basis[q]).sum();
+        }
+    }
+    hexa = gram.ldlt().solve(rhs);
+    RDMat66 misfit = inCijkl;
+    for (int m = 0; m < 5; m++) {
+        misfit -= hexa(m) * basis[m];
+    }
+    return misfit.norm() <= tol * norm;
+}
 
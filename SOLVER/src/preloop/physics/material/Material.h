@@ -11,6 +11,7 @@ class Volumetric3D;
 class Acoustic;
 class Elastic;
 class AttBuilder;
+class PackedBuffer;
 
 #include "eigenp.h"
 #include <array>
@@ -21,8 +22,12 @@ public:
     Material(const Quad *myQuad, const ExodusModel &exModel);
     
     // add 3D
+    // demoteTol: relative azimuthal variation below which the element
+    // is demoted to 1D by its azimuthal average; 0 for exact 1D only
+    // fourierOrder, fourierTol: see getFourierOrderSolid
     void addVolumetric3D(const std::vector<Volumetric3D *> &m3D, 
-        double srcLat, double srcLon, double srcDep, double phi2D);
+        double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol,
+        int fourierOrder, double fourierTol);
         
     // Mass
     arPP_RDColX computeElementalMass() const;
@@ -33,6 +38,12 @@ public:
     // Elastic
     Elastic *createElastic(bool elem1D, const AttBuilder *attBuild) const;
     Elastic *createElasticAniso(bool elem1D, const AttBuilder *attBuild) const;
+    Elastic *createElasticFourier(int order, const AttBuilder *attBuild) const;
+    
+    // azimuthal order of a weakly 3D solid in Fourier space, -1 if it should
+    // stay in physical space; the order is the lowest one beyond which the 
+    // Fourier coefficients of the moduli are below fourierTol of their average
+    int getFourierOrderSolid(bool attenuation) const;
         
     // get v_max to compute dt 
     double getVMaxRef() const;
@@ -44,19 +55,34 @@ public:
     
     // check isotropic
     bool isIsotropic() const;
+    bool isFullAniso() const {return mFullAniso;};
     
     // get properties
     RDMatXN getProperty(const std::string &vname, int refType);
+    
+    // pack or unpack the properties after addVolumetric3D, 
+    // to migrate the quad instead of evaluating the 3D models again
+    void sync3D(PackedBuffer &buf);
         
     //////////// anisotropy /////////////
 private:    
     void initAniso();
-    void rotateAniso(double srcLat, double srcLon, double srcDep);
-    static RDMatXX bondTransformation(RDMatXX inCijkl, double alpha, double beta, double gamma);
+    // phi2D: azimuth of the plane in 2D mode, -DBL_MAX otherwise
+    void rotateAniso(double srcLat, double srcLon, double srcDep, double phi2D);
+    // fixed-size, no dynamic allocation
+    static RDMat66 bondTransformation(const RDMat66 &inCijkl, double alpha, double beta, double gamma);
+    // fit a Voigt Cijkl by hexagonal symmetry about axis n, 
+    // hexa = (lambda, mu, a, b, c) as in Hexagonal3D; false if misfit > tol
+    static bool fitHexagonal(const RDMat66 &inCijkl, double tol, RDColX &hexa, RDCol3 &n);
     
 private:
     void prepare3D();
     bool _3Dprepared() const;
+    void demote3D(double tol);
+    void computeTIsoModuli(RDMatXN &A, RDMatXN &C, RDMatXN &F, RDMatXN &L, RDMatXN &N, 
+        RDMatXN &qkp3D, RDMatXN &qmu3D) const;
+    // mat if prepared, otherwise its row replicated into buffer
+    const RDMatXN &full3D(const RDMatXN &mat, RDMatXN &buffer) const;
     
     // 1D reference material
     RDRow4 mVpv1D, mVph1D;
@@ -87,6 +113,10 @@ private:
     RDMatXN mC66_3D;
     bool mFullAniso = false;
     
+    // Fourier-space elasticity of weakly 3D solids
+    int mFourierMaxOrder = 0;
+    double mFourierTol = 0.;
+    
     // 3D material sampled at mass points
     arPP_RDColX mRhoMass3D;
     arPP_RDColX mVpFluid3D;
@@ -11,6 +11,8 @@
 #include "PreloopFFTW.h"
 #include "PRT_1D.h"
 #include "PRT_3D.h"
+#include "PackedBuffer.h"
+#include <cfloat>
 
 Relabelling::Relabelling(const Quad *quad):
 mMyQuad(quad) {
@@ -30,27 +32,35 @@ mMyQuad(quad) {
 }
 
 void Relabelling::addUndulation(const std::vector<Geometric3D *> &g3D, 
-    double srcLat, double srcLon, double srcDep, double phi2D) {
+    double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol) {
     if (g3D.size() == 0) {
         return;
     }    
     double rElemCenter = mMyQuad->computeCenterRadius();
     int Nr = mMyQuad->getNr();
+    // 2D mode: one point per column, the same on all slices
+    int nQuery = phi2D > -DBL_MAX * .9 ? 1 : Nr;
+    RDColX deltaR(nQuery);
     for (int ipol = 0; ipol <= nPol; ipol++) {
         for (int jpol = 0; jpol <= nPol; jpol++) {
             int ipnt = ipol * nPntEdge + jpol;
             const RDCol2 &xieta = SpectralConstants::getXiEta(ipol, jpol, mMyQuad->isAxial());
-            const RDMatX3 &rtpS = mMyQuad->computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, Nr, phi2D);
-            for (int alpha = 0; alpha < Nr; alpha++) {
-                double r = rtpS(alpha, 0);
-                double t = rtpS(alpha, 1);
-                double p = rtpS(alpha, 2);
-                for (const auto &model: g3D) {
-                    mStiff_dZ(alpha, ipnt) += model->getDeltaR(r, t, p, rElemCenter); 
-                }
+            const RDMatX3 &rtpS = mMyQuad->computeGeocentricGlobal(srcLat, srcLon, srcDep, xieta, nQuery, phi2D);
+            // one batch per model for the Nr points of a column
+            deltaR.setZero();
+            for (const auto &model: g3D) {
+                model->getDeltaRBatch(rtpS, rElemCenter, deltaR); 
+            }
+            if (nQuery == Nr) {
+                mStiff_dZ.col(ipnt) += deltaR;
+            } else {
+                mStiff_dZ.col(ipnt).array() += deltaR(0);
             }
         }
     }
+    if (demoteTol > 0. && !isZero() && !isPar1D()) {
+        demote3D(demoteTol);
+    }
     if (!isZero()) {
         checkHmin();
         formGradientUndulation();
@@ -209,6 +219,20 @@ void Relabelling::checkHmin() {
     throw std::runtime_error("Relabelling::checkHmin || Program should not have reached here.");
 }
 
+void Relabelling::demote3D(double tol) {
+    // maximum deviation from the azimuthal average, 
+    // relative to the smallest point distance in the element
+    const RDRowN &mean = mStiff_dZ.colwise().mean();
+    double dev = (mStiff_dZ.rowwise() - mean).cwiseAbs().maxCoeff();
+    if (dev > tol * mMyQuad->getHminSlices().minCoeff()) {
+        return;
+    }
+    
+    // replace by the azimuthal average
+    mStiff_dZ = mean.replicate(mStiff_dZ.rows(), 1);
+    mDemoted = true;
+}
+
 void Relabelling::formGradientUndulation() {
     int Nr = mMyQuad->getNr();
     int Nu = Nr / 2;
@@ -287,5 +311,15 @@ void Relabelling::formMassUndulation() {
     }
 }
 
-
+void Relabelling::sync(PackedBuffer &buf) {
+    buf.syncEigen(mStiff_dZ);
+    buf.syncEigen(mStiff_dZdR);
+    buf.syncEigen(mStiff_dZdT);
+    buf.syncEigen(mStiff_dZdZ);
+    buf.syncEigenArray(mMass_dZ);
+    buf.syncEigenArray(mMass_dZdR);
+    buf.syncEigenArray(mMass_dZdT);
+    buf.syncEigenArray(mMass_dZdZ);
+    buf.syncValue(mDemoted);
+}
 
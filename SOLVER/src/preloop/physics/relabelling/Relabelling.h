@@ -9,6 +9,7 @@
 class Quad;
 class Geometric3D;
 class PRT;
+class PackedBuffer;
 
 class Relabelling {
 public:
@@ -16,8 +17,10 @@ public:
     Relabelling(const Quad *quad);
     
     // add deltaR on mass sampling points
+    // demoteTol: azimuthal variation, relative to the element size, below 
+    // which the undulation is replaced by its azimuthal average; 0 for off
     void addUndulation(const std::vector<Geometric3D *> &g3D, 
-        double srcLat, double srcLon, double srcDep, double phi2D);
+        double srcLat, double srcLon, double srcDep, double phi2D, double demoteTol = 0.);
     
     // stiffness
     RDMatXN getStiffJacobian() const;
@@ -35,16 +38,25 @@ public:
     // is undulation 1D
     bool isPar1D() const;
     
+    // is undulation 1D by demotion
+    bool isDemoted() const {return mDemoted;};
+    
     // create PRT pointer
     PRT *createPRT(bool elem1D) const;
     
     // deltaR
     const RDMatXN &getDeltaR() const {return mStiff_dZ;};
     
+    // pack or unpack the undulation after addUndulation
+    void sync(PackedBuffer &buf);
+    
 private:
     // check hmin
     void checkHmin();
     
+    // replace weakly 3D undulation by its azimuthal average
+    void demote3D(double tol);
+    
     // compute gradient of deltaR 
     void formGradientUndulation();
     
@@ -66,5 +78,8 @@ private:
     arPP_RDColX mMass_dZdR;
     arPP_RDColX mMass_dZdT;
     arPP_RDColX mMass_dZdZ;
+    
+    // demoted to 1D by addUndulation
+    bool mDemoted = false;
 };
 
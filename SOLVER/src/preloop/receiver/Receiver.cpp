@@ -43,6 +43,14 @@ mName(name), mNetwork(network), mDepth(depth), mDumpStrain(dumpStrain), mDumpCur
     // XMPI::cout << mLat << " " << mLon << " " << " 0.0 " << mDepth << XMPI::endl;
 }
 
+Receiver::Receiver(const std::string &name, const std::string &network, 
+    double theta, double phi, double lat, double lon, 
+    double depth, double backAzimuth, bool dumpStrain, bool dumpCurl):
+mName(name), mNetwork(network), mTheta(theta), mPhi(phi), mLat(lat), mLon(lon),
+mDepth(depth), mBackAzimuth(backAzimuth), mDumpStrain(dumpStrain), mDumpCurl(dumpCurl) {
+    // nothing
+}
+
 void Receiver::release(PointwiseRecorder &recorderPW, const Domain &domain, 
     int elemTag, const RDMatPP &interpFact) {
     Element *myElem = domain.getElement(elemTag);
@@ -50,17 +58,19 @@ void Receiver::release(PointwiseRecorder &recorderPW, const Domain &domain,
         myElem->forceTIso();
     }
     recorderPW.addReceiver(mName, mNetwork, mPhi, interpFact, myElem, mTheta, mBackAzimuth,
-        mLat, mLon, mDepth, mDumpStrain, mDumpCurl);
+        mLat, mLon, mDepth, mDumpStrain, mDumpCurl, mWindowBegin, mWindowEnd, mDecimation);
 }
 
-bool Receiver::locate(const Mesh &mesh, int &elemTag, int &quadTag, bool depthInRef) const {
-    RDCol2 recCrds, srcXiEta;
-    double r = 0.;
+double Receiver::computeRadius(const Mesh &mesh, bool depthInRef) const {
     if (!depthInRef) {
-        r = mesh.computeRadiusRef(mDepth, mLat, mLon);
+        return mesh.computeRadiusRef(mDepth, mLat, mLon);
     } else {
-        r = Geodesy::getROuter() - mDepth;
+        return Geodesy::getROuter() - mDepth;
     }
+}
+
+bool Receiver::locate(const Mesh &mesh, double r, int &elemTag, int &quadTag) const {
+    RDCol2 recCrds, srcXiEta;
     recCrds(0) = r * sin(mTheta);
     recCrds(1) = r * cos(mTheta);
     if (recCrds(0) > mesh.sMax() + tinySingle || recCrds(0) < mesh.sMin() - tinySingle) {
@@ -69,11 +79,10 @@ bool Receiver::locate(const Mesh &mesh, int &elemTag, int &quadTag, bool depthIn
     if (recCrds(1) > mesh.zMax() + tinySingle || recCrds(1) < mesh.zMin() - tinySingle) {
         return false;
     }
-    for (int iloc = 0; iloc < mesh.getNumQuads(); iloc++) {
+    std::vector<int> locs;
+    mesh.findQuads(recCrds(0), recCrds(1), locs);
+    for (int iloc: locs) {
         const Quad *quad = mesh.getQuad(iloc);
-        if (!quad->nearMe(recCrds(0), recCrds(1))) {
-            continue;
-        }
         if (quad->invMapping(recCrds, srcXiEta)) {
             if (std::abs(srcXiEta(0)) <= 1.000001 && std::abs(srcXiEta(1)) <= 1.000001) {
                 elemTag = quad->getElementTag();
@@ -85,14 +94,8 @@ bool Receiver::locate(const Mesh &mesh, int &elemTag, int &quadTag, bool depthIn
     return false;
 }
 
-void Receiver::computeInterpFact(const Mesh &mesh, int quadTag, RDMatPP &interpFact, bool depthInRef) const {
+void Receiver::computeInterpFact(const Mesh &mesh, double r, int quadTag, RDMatPP &interpFact) const {
     RDCol2 recCrds, srcXiEta;
-    double r = 0.;
-    if (!depthInRef) {
-        r = mesh.computeRadiusRef(mDepth, mLat, mLon);
-    } else {
-        r = Geodesy::getROuter() - mDepth;
-    }
     recCrds(0) = r * sin(mTheta);
     recCrds(1) = r * cos(mTheta);
     const Quad *quad = mesh.getQuad(quadTag);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <cfloat>
 #include "eigenp.h"
 
 class Domain;
@@ -17,18 +18,34 @@ public:
         double theta_lat, double phi_lon, bool geographic, 
         double depth, bool dumpStrain, bool dumpCurl, 
         double srcLat, double srcLon, double srcDep);
+    // with coordinates in both frames computed in bulk: theta and phi 
+    // source-centered in radians, lat and lon geographic in degrees
+    Receiver(const std::string &name, const std::string &network, 
+        double theta, double phi, double lat, double lon, 
+        double depth, double backAzimuth, bool dumpStrain, bool dumpCurl);
+    
+    // time window and decimation of the records, all times by default
+    void setSchedule(double windowBegin, double windowEnd, int decimation) {
+        mWindowBegin = windowBegin;
+        mWindowEnd = windowEnd;
+        mDecimation = decimation;
+    };
     
     void release(PointwiseRecorder &recorderPW, const Domain &domain, 
         int elemTag, const RDMatPP &interpFact);     
     
     // bool locate(const Mesh &mesh, int &elemTag, RDMatPP &interpFact) const;
-    bool locate(const Mesh &mesh, int &elemTag, int &quadTag, bool depthInRef) const;
-    void computeInterpFact(const Mesh &mesh, int quadTag, RDMatPP &interpFact, bool depthInRef) const;
+    // radius in the reference mesh, computed once for locate and computeInterpFact
+    double computeRadius(const Mesh &mesh, bool depthInRef) const;
+    bool locate(const Mesh &mesh, double r, int &elemTag, int &quadTag) const;
+    void computeInterpFact(const Mesh &mesh, double r, int quadTag, RDMatPP &interpFact) const;
     
     std::string verbose(bool geographic, int wname, int wnet) const;
     
     const std::string &getName() const {return mName;};
     const std::string &getNetwork() const {return mNetwork;};
+    // epicentral distance
+    double getTheta() const {return mTheta;};
     
 private:
     std::string mName;
@@ -39,5 +56,8 @@ private:
     double mBackAzimuth;
     bool mDumpStrain;
     bool mDumpCurl;
+    double mWindowBegin = -DBL_MAX;
+    double mWindowEnd = DBL_MAX;
+    int mDecimation = 1;
 };
 
@@ -14,14 +14,181 @@
 #include "Domain.h"
 #include "MultilevelTimer.h"
 #include "PointwiseRecorder.h"
+#include "PointwiseFilter.h"
 #include "PointwiseIOAscii.h"
 #include "PointwiseIONetCDF.h"
+#include "PointwiseIOBinary.h"
+#include "PointwiseIOASDF.h"
+#include "SurfaceMovie.h"
+#include "SurfaceGroundMotion.h"
+#include "NetCDF_Writer.h"
+#include "NetCDF_Reader.h"
+#include "IOFlush.h"
 #include "SurfaceRecorder.h"
+#include "VolumetricRecorder.h"
 #include "Mesh.h"
 #include "Quad.h"
 
 #include "ExodusModel.h"
 #include "Geodesy.h"
+#include <set>
+#include <cstring>
+
+// stations packed into bytes, broadcast as one buffer
+namespace StationTable {
+    struct Station {
+        double mTheta;
+        double mPhi;
+        double mDepth;
+        int mDumpStrain;
+        int mDumpCurl;
+        // time window and decimation of the records
+        double mWindowBegin;
+        double mWindowEnd;
+        int mDecimation;
+    };
+    
+    // the station followed by its name and network, null-terminated
+    void pack(std::vector<char> &table, const Station &station, 
+        const std::string &name, const std::string &network) {
+        size_t pos = table.size();
+        table.resize(pos + sizeof(Station) + name.size() + network.size() + 2, 0);
+        std::memcpy(table.data() + pos, &station, sizeof(Station));
+        pos += sizeof(Station);
+        std::memcpy(table.data() + pos, name.c_str(), name.size() + 1);
+        pos += name.size() + 1;
+        std::memcpy(table.data() + pos, network.c_str(), network.size() + 1);
+    }
+    
+    void unpack(const std::vector<char> &table, std::vector<Station> &stations, 
+        std::vector<std::string> &names, std::vector<std::string> &networks) {
+        size_t pos = 0;
+        while (pos < table.size()) {
+            Station station;
+            std::memcpy(&station, table.data() + pos, sizeof(Station));
+            pos += sizeof(Station);
+            stations.push_back(station);
+            names.push_back(std::string(table.data() + pos));
+            pos += names.back().size() + 1;
+            networks.push_back(std::string(table.data() + pos));
+            pos += networks.back().size() + 1;
+        }
+    }
+    
+    // text file, one station per line
+    void readText(const std::string &fname, std::vector<char> &table) {
+        std::fstream fs(fname, std::fstream::in);
+        if (!fs) {
+            throw std::runtime_error("ReceiverCollection::ReceiverCollection || "
+                "Error opening station data file " + fname + ".");
+        }
+        std::string line;
+        while (getline(fs, line)) {
+            try {
+                std::vector<std::string> strs = Parameters::splitString(line, "\t ");
+                int npar = strs.size();
+                if (npar < 6) {
+                    continue;
+                }
+                Station station;
+                station.mTheta = boost::lexical_cast<double>(strs[2]);
+                station.mPhi = boost::lexical_cast<double>(strs[3]);
+                // the 4th column (elevation) is ignored
+                station.mDepth = boost::lexical_cast<double>(strs[5]);
+                station.mDumpStrain = 0;
+                station.mDumpCurl = 0;
+                station.mWindowBegin = -DBL_MAX;
+                station.mWindowEnd = DBL_MAX;
+                station.mDecimation = 1;
+                for (int ipar = 6; ipar < npar; ipar++) {
+                    if (boost::iequals(strs[ipar], "dump_strain")) {
+                        station.mDumpStrain = 1;
+                    }
+                    if (boost::iequals(strs[ipar], "dump_curl")) {
+                        station.mDumpCurl = 1;
+                    }
+                    // window=begin,end and decimation=n
+                    if (boost::istarts_with(strs[ipar], "window=")) {
+                        std::vector<std::string> range = Parameters::splitString(strs[ipar].substr(7), ",");
+                        if (range.size() != 2) {
+                            throw std::runtime_error("invalid window");
+                        }
+                        station.mWindowBegin = boost::lexical_cast<double>(range[0]);
+                        station.mWindowEnd = boost::lexical_cast<double>(range[1]);
+                    }
+                    if (boost::istarts_with(strs[ipar], "decimation=")) {
+                        station.mDecimation = std::max(1, boost::lexical_cast<int>(strs[ipar].substr(11)));
+                    }
+                }
+                pack(table, station, strs[0], strs[1]);
+            } catch(std::exception) {
+                // simply ignore invalid lines
+                continue;
+            }
+        }
+        fs.close();
+    }
+    
+    // NetCDF file, one array per column
+    void readNetCDF(const std::string &fname, bool geographic, std::vector<char> &table) {
+        NetCDF_Reader reader;
+        reader.open(fname);
+        std::vector<std::string> name, network;
+        std::vector<double> theta, phi, depth;
+        std::vector<int> dumpStrain, dumpCurl, decimation;
+        std::vector<double> windowBegin, windowEnd;
+        reader.readString("name", name);
+        reader.readString("network", network);
+        reader.read1D(geographic ? "latitude" : "distance", theta);
+        reader.read1D(geographic ? "longitude" : "azimuth", phi);
+        reader.read1D("depth", depth);
+        int nsta = name.size();
+        if (reader.hasVariable("dump_strain")) {
+            reader.read1D("dump_strain", dumpStrain);
+        } else {
+            dumpStrain.assign(nsta, 0);
+        }
+        if (reader.hasVariable("dump_curl")) {
+            reader.read1D("dump_curl", dumpCurl);
+        } else {
+            dumpCurl.assign(nsta, 0);
+        }
+        if (reader.hasVariable("window_begin")) {
+            reader.read1D("window_begin", windowBegin);
+        } else {
+            windowBegin.assign(nsta, -DBL_MAX);
+        }
+        if (reader.hasVariable("window_end")) {
+            reader.read1D("window_end", windowEnd);
+        } else {
+            windowEnd.assign(nsta, DBL_MAX);
+        }
+        if (reader.hasVariable("decimation")) {
+            reader.read1D("decimation", decimation);
+        } else {
+            decimation.assign(nsta, 1);
+        }
+        reader.close();
+        if (network.size() != nsta || theta.size() != nsta || phi.size() != nsta || 
+            depth.size() != nsta || dumpStrain.size() != nsta || dumpCurl.size() != nsta ||
+            windowBegin.size() != nsta || windowEnd.size() != nsta || decimation.size() != nsta) {
+            throw std::runtime_error("ReceiverCollection::ReceiverCollection || "
+                "Inconsistent numbers of stations in station data file " + fname + ".");
+        }
+        for (int i = 0; i < nsta; i++) {
+            Station station;
+            station.mTheta = theta[i];
+            station.mPhi = phi[i];
+            station.mDepth = depth[i];
+            station.mDumpStrain = (int)(dumpStrain[i] != 0);
+            station.mDumpCurl = (int)(dumpCurl[i] != 0);
+            station.mWindowBegin = windowBegin[i];
+            station.mWindowEnd = windowEnd[i];
+            station.mDecimation = std::max(1, decimation[i]);
+            pack(table, station, name[i], network[i]);
+        }
+    }
+}
 
 ReceiverCollection::ReceiverCollection(const std::string &fileRec, bool geographic, 
     double srcLat, double srcLon, double srcDep, int duplicated, 
@@ -32,79 +199,35 @@ mSrcLat(srcLat), mSrcLon(srcLon), mSrcDep(srcDep),
 mSaveSurfaceAtRadius(saveSurfRadius), 
 mSaveSurfaceDistMin(saveSurfDistMin), mSaveSurfaceDistMax(saveSurfDistMax),
 mSaveSurfaceFromUpper(saveSurfUpper) {
-    std::vector<std::string> name, network;
-    std::vector<double> theta, phi, depth;
-    std::vector<int> dumpStrain;
-    std::vector<int> dumpCurl;
+    // the station table, packed by root and broadcast at once
+    std::vector<char> table;
     if (!boost::iequals(fileRec, "none")) {
         mInputFile = Parameters::sInputDirectory + "/" + mInputFile;
         if (XMPI::root()) {
-            std::fstream fs(mInputFile, std::fstream::in);
-            if (!fs) {
-                throw std::runtime_error("ReceiverCollection::ReceiverCollection || "
-                    "Error opening station data file " + mInputFile + ".");
+            if (NetCDF_Reader::isNetCDF(mInputFile)) {
+                StationTable::readNetCDF(mInputFile, geographic, table);
+            } else {
+                StationTable::readText(mInputFile, table);
             }
-            std::string line;
-            while (getline(fs, line)) {
-                try {
-                    std::vector<std::string> strs = Parameters::splitString(line, "\t ");
-                    int npar = strs.size();
-                    if (npar < 6) {
-                        continue;
-                    }
-                    double theta_try = boost::lexical_cast<double>(strs[2]);
-                    double phi_try = boost::lexical_cast<double>(strs[3]);
-                    // the 4th column (elevation) is ignored
-                    double depth_try = boost::lexical_cast<double>(strs[5]);
-                    int strain_try = 0;
-                    int curl_try = 0;
-                    if (npar > 6) {
-                        for (int ipar = 6; ipar < npar; ipar++) {
-                            if (boost::iequals(strs[ipar], "dump_strain")) {
-                                strain_try = 1;
-                            }
-                            if (boost::iequals(strs[ipar], "dump_curl")) {
-                                curl_try = 1;
-                            }
-                        }
-                    }
-                    name.push_back(strs[0]);
-                    network.push_back(strs[1]);
-                    theta.push_back(theta_try);
-                    phi.push_back(phi_try);
-                    depth.push_back(depth_try);
-                    dumpStrain.push_back(strain_try);
-                    dumpCurl.push_back(curl_try);
-                } catch(std::exception) {
-                    // simply ignore invalid lines
-                    continue;
-                }
-            }
-            fs.close();
         }
-        XMPI::bcast(name);
-        XMPI::bcast(network);
-        XMPI::bcast(theta);
-        XMPI::bcast(phi);
-        XMPI::bcast(depth);
-        XMPI::bcast(dumpStrain);
-        XMPI::bcast(dumpCurl);
+        XMPI::bcast(table);
     }
     
-    // create receivers
-    mWidthName = -1;
-    mWidthNetwork = -1;
-    for (int i = 0; i < name.size(); i++) {
-        // check duplicated
-        if (duplicated != 0) {
-            std::vector<std::string> recKeys;
+    // unpack, renaming or rejecting duplicated keys
+    std::vector<StationTable::Station> stations;
+    std::vector<std::string> name, network;
+    StationTable::unpack(table, stations, name, network);
+    std::vector<char>().swap(table);
+    if (duplicated != 0) {
+        std::set<std::string> recKeys;
+        for (int i = 0; i < name.size(); i++) {
             std::string key = network[i] + "." + name[i];
-            if (std::find(recKeys.begin(), recKeys.end(), key) != recKeys.end()) {
+            if (recKeys.find(key) != recKeys.end()) {
                 if (duplicated == 1) {
                     // rename
                     int append = 0;
                     std::string nameOriginal = name[i];
-                    while (std::find(recKeys.begin(), recKeys.end(), key) != recKeys.end()) {
+                    while (recKeys.find(key) != recKeys.end()) {
                         name[i] = nameOriginal + "__DUPLICATED" + boost::lexical_cast<std::string>(++append);
                         key = network[i] + "." + name[i];
                     }
@@ -115,15 +238,56 @@ mSaveSurfaceFromUpper(saveSurfUpper) {
                         "Name = " + name[i] + "; Network = " + network[i]);
                 }
             }
-            recKeys.push_back(key);
+            recKeys.insert(key);
+        }
+    }
+    
+    // coordinates in both frames, rotated in bulk
+    int nrec = name.size();
+    RDMatX3 rtpG(nrec, 3), rtpS(nrec, 3);
+    for (int i = 0; i < nrec; i++) {
+        const StationTable::Station &station = stations[i];
+        if (geographic) {
+            rtpG(i, 0) = 1.;
+            rtpG(i, 1) = Geodesy::lat2Theta_d(station.mTheta, station.mDepth);
+            rtpG(i, 2) = Geodesy::lon2Phi(station.mPhi);
+        } else {
+            rtpS(i, 0) = 1.;
+            rtpS(i, 1) = station.mTheta * degree;
+            rtpS(i, 2) = station.mPhi * degree;
         }
-        // add receiver
-        mReceivers.push_back(new Receiver(name[i], network[i], 
-            theta[i], phi[i], geographic, depth[i], (bool)dumpStrain[i], (bool)dumpCurl[i], 
-            srcLat, srcLon, srcDep));
+    }
+    const SourceRotation rotation(srcLat, srcLon, srcDep);
+    if (geographic) {
+        rtpS = rtpG;
+        rotation.glob2Src(rtpS);
+    } else {
+        rtpG = rtpS;
+        rotation.src2Glob(rtpG);
+    }
+    const RDColX &baz = rotation.backAzimuth(rtpG.col(1), rtpG.col(2));
+    
+    // create receivers
+    mReceivers = std::vector<Receiver *>(nrec, 0);
+    for (int i = 0; i < nrec; i++) {
+        double depth = stations[i].mDepth;
+        mReceivers[i] = new Receiver(name[i], network[i], rtpS(i, 1), rtpS(i, 2), 
+            Geodesy::theta2Lat_d(rtpG(i, 1), depth), Geodesy::phi2Lon(rtpG(i, 2)), 
+            depth, baz(i), (bool)stations[i].mDumpStrain, (bool)stations[i].mDumpCurl);
+        mReceivers[i]->setSchedule(stations[i].mWindowBegin, stations[i].mWindowEnd, 
+            stations[i].mDecimation);
+    }
+    mWidthName = -1;
+    mWidthNetwork = -1;
+    for (int i = 0; i < nrec; i++) {
         mWidthName = std::max(mWidthName, (int)name[i].length());
         mWidthNetwork = std::max(mWidthNetwork, (int)network[i].length());
     }
+    mNumReceivers = nrec;
+    if (nrec > 0) {
+        mVerboseFirst = mReceivers[0]->verbose(mGeographic, mWidthName, mWidthNetwork);
+        mVerboseLast = mReceivers[nrec - 1]->verbose(mGeographic, mWidthName, mWidthNetwork);
+    }
 }
 
 ReceiverCollection::~ReceiverCollection() {
@@ -138,20 +302,58 @@ void ReceiverCollection::release(Domain &domain, const Mesh &mesh, bool depthInR
     std::vector<int> recRank(mReceivers.size(), XMPI::nproc());
     std::vector<int> recETag(mReceivers.size(), -1);
     std::vector<int> recQTag(mReceivers.size(), -1);
-    // std::vector<RDMatPP> recInterpFact(mReceivers.size(), RDMatPP::Zero());
-    for (int irec = 0; irec < mReceivers.size(); irec++) {
-        bool found = mReceivers[irec]->locate(mesh, recETag[irec], recQTag[irec], depthInRef);
-        if (found) {
-            recRank[irec] = XMPI::rank();
+    std::vector<double> recRadius(mReceivers.size(), 0.);
+    int nrec = mReceivers.size();
+    
+    // epicentral distances covered by the local quads: receivers outside
+    // are skipped before solving for their radii; the margin covers the
+    // tolerance of the location in (s, z)
+    double rMinLocal, rMaxLocal, distMinLocal, distMaxLocal;
+    mesh.computeLocalRange(rMinLocal, rMaxLocal, distMinLocal, distMaxLocal);
+    double distMargin = pi;
+    if (mesh.getNumQuads() > 0 && rMinLocal > tinySingle) {
+        distMargin = 2. * tinySingle / rMinLocal;
+    }
+    
+    std::string error = "";
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int irec = 0; irec < nrec; irec++) {
+        try {
+            double theta = mReceivers[irec]->getTheta();
+            if (mesh.getNumQuads() == 0 || theta < distMinLocal - distMargin 
+                || theta > distMaxLocal + distMargin) {
+                continue;
+            }
+            recRadius[irec] = mReceivers[irec]->computeRadius(mesh, depthInRef);
+            bool found = mReceivers[irec]->locate(mesh, recRadius[irec], recETag[irec], recQTag[irec]);
+            if (found) {
+                recRank[irec] = XMPI::rank();
+            }
+        } catch (const std::exception &e) {
+            // exceptions must not leave a parallel region
+            #ifdef _USE_OPENMP
+                #pragma omp critical(ReceiverCollection_release)
+            #endif
+            if (error == "") {
+                error = e.what();
+            }
         }
     }
+    if (error != "") {
+        throw std::runtime_error(error);
+    }
     MultilevelTimer::end("Locate Receivers", 2);
     
     // release to domain
     MultilevelTimer::begin("Release to Domain", 2);
+    IOFlush::sInterval = mFlushInterval;
+    int totalRows = PointwiseFilter::totalOutputs(mTotalRecordSteps, mDecimation);
     PointwiseRecorder *recorderPW = new PointwiseRecorder(
-        mTotalRecordSteps, mRecordInterval, mBufferSize, mComponents,
-        mSrcLat, mSrcLon, mSrcDep);
+        totalRows, mRecordInterval, std::min(mBufferSize, totalRows), mComponents,
+        mSrcLat, mSrcLon, mSrcDep, 
+        PointwiseFilter(mDecimation, mDerivative, mDeltaT * mRecordInterval));
     
     MultilevelTimer::begin("Find Min Rank", 3);    
     std::vector<int> recRankMinG(recRank);
@@ -159,7 +361,8 @@ void ReceiverCollection::release(Domain &domain, const Mesh &mesh, bool depthInR
     MultilevelTimer::end("Find Min Rank", 3);
     
     MultilevelTimer::begin("Release receivers", 3);
-    for (int irec = 0; irec < mReceivers.size(); irec++) {
+    std::vector<int> recLocal;
+    for (int irec = 0; irec < nrec; irec++) {
         int recRankMin = recRankMinG[irec];
         if (recRankMin == XMPI::nproc()) {
             throw std::runtime_error("ReceiverCollection::release || Error locating receiver || " 
@@ -167,12 +370,35 @@ void ReceiverCollection::release(Domain &domain, const Mesh &mesh, bool depthInR
                 "Network = " + mReceivers[irec]->getNetwork());
         }
         if (recRankMin == XMPI::rank()) {
-            RDMatPP interpFact;
-            mReceivers[irec]->computeInterpFact(mesh, recQTag[irec], interpFact, depthInRef);
-            mReceivers[irec]->release(*recorderPW, 
-                domain, recETag[irec], interpFact);
+            recLocal.push_back(irec);
         }
     }
+    // interpolation factors in parallel, released in receiver order
+    int nlocal = recLocal.size();
+    std::vector<RDMatPP> recInterpFact(nlocal, RDMatPP::Zero());
+    #ifdef _USE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int ilocal = 0; ilocal < nlocal; ilocal++) {
+        int irec = recLocal[ilocal];
+        mReceivers[irec]->computeInterpFact(mesh, recRadius[irec], recQTag[irec], 
+            recInterpFact[ilocal]);
+    }
+    for (int ilocal = 0; ilocal < nlocal; ilocal++) {
+        int irec = recLocal[ilocal];
+        mReceivers[irec]->release(*recorderPW, 
+            domain, recETag[irec], recInterpFact[ilocal]);
+    }
+    // only the receivers of this rank are kept
+    std::vector<Receiver *> receivers;
+    for (int irec = 0; irec < nrec; irec++) {
+        if (recRankMinG[irec] == XMPI::rank()) {
+            receivers.push_back(mReceivers[irec]);
+        } else {
+            delete mReceivers[irec];
+        }
+    }
+    mReceivers = receivers;
     MultilevelTimer::end("Release receivers", 3);
     
     // IO
@@ -186,9 +412,12 @@ void ReceiverCollection::release(Domain &domain, const Mesh &mesh, bool depthInR
     // whole surface
     if (mSaveSurfaceAtRadius > 0.) {
         MultilevelTimer::begin("Whole Surface", 3);
+        // without time series, a buffer holds only the current record
         SurfaceRecorder *recorderSF = new SurfaceRecorder(mTotalRecordSteps, 
-            mRecordInterval, mBufferSize, 
-            mSrcLat, mSrcLon, mSrcDep, mAssemble);
+            mRecordInterval, mSaveSurfaceTimeSeries ? mBufferSize : 1, 
+            mSrcLat, mSrcLon, mSrcDep, mAssemble, 
+            mSaveSurfaceStrain, mSaveSurfaceDeflate, mSaveSurfacePrecision, 
+            mSaveSurfaceNuCutoff, mSaveSurfaceTimeSeries);
         int nEdge  = 0;
         for (int iloc = 0; iloc < mesh.getNumQuads(); iloc++) {
             const Quad *quad = mesh.getQuad(iloc);
@@ -217,24 +446,70 @@ void ReceiverCollection::release(Domain &domain, const Mesh &mesh, bool depthInR
             }
         }
         std::cout <<"Number of edges for surface output: "<<nEdge<<std::endl;
+        if (mSaveSurfaceVTK) {
+            recorderSF->setMovie(new SurfaceMovie(mSurfaceVTKInterval, 
+                mSurfaceVTKLatMin, mSurfaceVTKLatMax, mSurfaceVTKLonMin, mSurfaceVTKLonMax, 
+                mSurfaceVTKSpacing, mSaveSurfaceAtRadius, mSrcLat, mSrcLon, mSrcDep));
+        }
+        if (mSaveSurfaceGroundMotion) {
+            recorderSF->setGroundMotion(new SurfaceGroundMotion(mSurfaceGroundMotionPeriods, 
+                0.05, mDeltaT * mRecordInterval, mSrcLat, mSrcLon, mSrcDep));
+        }
         domain.setSurfaceRecorder(recorderSF);
         MultilevelTimer::end("Whole Surface", 3);
     }
+    
+    // volumetric wavefield
+    if (mSaveVolume) {
+        MultilevelTimer::begin("Volumetric", 3);
+        int totalSteps = (mTotalStepsSTF + mVolumeInterval - 1) / mVolumeInterval;
+        VolumetricRecorder *recorderVL = new VolumetricRecorder(totalSteps, 
+            mVolumeInterval, std::min(mBufferSize, totalSteps), mVolumeGLLStride, 
+            mSrcLat, mSrcLon, mSrcDep, mVolumeStrain, mVolumeDeflate, 
+            mVolumePrecision, mVolumeMemoryMB);
+        for (int iloc = 0; iloc < mesh.getNumQuads(); iloc++) {
+            const Quad *quad = mesh.getQuad(iloc);
+            // strain is solid only
+            if (mVolumeStrain && quad->isFluid()) {
+                continue;
+            }
+            // element centre
+            RDMat24 sz = quad->getNodalCoords() / 4;
+            double s = sz(0, 0) + sz(0, 1) + sz(0, 2) + sz(0, 3);
+            double z = sz(1, 0) + sz(1, 1) + sz(1, 2) + sz(1, 3);
+            double r = std::max(tinyDouble, sqrt(s*s+z*z));
+            double dist_deg = acos(z / r) / degree;
+            if (r < mVolumeRMin || r > mVolumeRMax || 
+                dist_deg < mVolumeDistMin || dist_deg > mVolumeDistMax) {
+                continue;
+            }
+            recorderVL->addElement(domain.getElement(quad->getElementTag()));
+        }
+        std::cout <<"Number of elements for volumetric output: "
+            << recorderVL->getNumElements() << std::endl;
+        domain.setVolumetricRecorder(recorderVL);
+        MultilevelTimer::end("Volumetric", 3);
+    }
     MultilevelTimer::end("Release to Domain", 2);
 }
 
 std::string ReceiverCollection::verbose() const {
     std::stringstream ss;
     ss << "\n========================= Receivers ========================" << std::endl;
-    ss << "  Number of Receivers   =   " << mReceivers.size() << std::endl;
+    ss << "  Number of Receivers   =   " << mNumReceivers << std::endl;
     ss << "  Coordinate System     =   " << (mGeographic ? "Geographic" : "Source-centered") << std::endl;
-    if (mReceivers.size() > 0) {
+    if (mNumReceivers > 0) {
         ss << "  Receiver List: " << std::endl;
-        ss << "    " << mReceivers[0]->verbose(mGeographic, mWidthName, mWidthNetwork) << std::endl;
+        ss << "    " << mVerboseFirst << std::endl;
     }
-    if (mReceivers.size() > 1) {
+    if (mNumReceivers > 1) {
         ss << "    " << std::setw(mWidthName) << "..." << std::endl;
-        ss << "    " << mReceivers[mReceivers.size() - 1]->verbose(mGeographic, mWidthName, mWidthNetwork) << std::endl;
+        ss << "    " << mVerboseLast << std::endl;
+    }
+    if (mDecimation > 1 || mDerivative > 0) {
+        const std::string quantity[] = {"Displacement", "Velocity", "Acceleration"};
+        ss << "  Seismogram Quantity   =   " << quantity[mDerivative] << std::endl;
+        ss << "  Anti-alias Decimation =   " << mDecimation << std::endl;
     }
     if (mSaveSurfaceAtRadius > 0.) {
         ss << "  * Wavefield on the whole surface will be saved." << std::endl;
@@ -242,13 +517,27 @@ std::string ReceiverCollection::verbose() const {
         ss << "  * Min Dist / deg = " << mSaveSurfaceDistMin << std::endl;
         ss << "  * Max Dist / deg = " << mSaveSurfaceDistMax << std::endl;
         ss << "  * From Upper     = " << (mSaveSurfaceFromUpper ? "YES" : "NO") << std::endl;
+        ss << "  * With Strain    = " << (mSaveSurfaceStrain ? "YES" : "NO") << std::endl;
+        ss << "  * Deflate Level  = " << mSaveSurfaceDeflate << std::endl;
+        if (mSaveSurfaceNuCutoff > 0.) {
+            ss << "  * Nu Cutoff      = " << mSaveSurfaceNuCutoff << std::endl;
+        }
+    }
+    if (mSaveVolume) {
+        ss << "  * Volumetric wavefield will be saved." << std::endl;
+        ss << "  * Radius / km    = " << mVolumeRMin / 1e3 << " to " << mVolumeRMax / 1e3 << std::endl;
+        ss << "  * Dist / deg     = " << mVolumeDistMin << " to " << mVolumeDistMax << std::endl;
+        ss << "  * Interval       = " << mVolumeInterval << std::endl;
+        ss << "  * GLL Stride     = " << mVolumeGLLStride << std::endl;
+        ss << "  * With Strain    = " << (mVolumeStrain ? "YES" : "NO") << std::endl;
     }
     ss << "========================= Receivers ========================\n" << std::endl;
     return ss.str();
 }
 
 void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters &par, 
-    double srcLat, double srcLon, double srcDep, int totalStepsSTF, int verbose) {
+    double srcLat, double srcLon, double srcDep, int totalStepsSTF, double shiftSTF,
+    double dt, int verbose) {
     if (rec) {
         delete rec;
     }
@@ -315,6 +604,7 @@ void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters
     if (rec->mRecordInterval <= 0) {
         rec->mRecordInterval = 1;
     }
+    rec->mTotalStepsSTF = totalStepsSTF;
     rec->mTotalRecordSteps = totalStepsSTF / rec->mRecordInterval;
     if (totalStepsSTF % rec->mRecordInterval > 0) {
         rec->mTotalRecordSteps += 1;
@@ -326,6 +616,129 @@ void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters
     if (rec->mBufferSize > rec->mTotalRecordSteps) {
         rec->mBufferSize = rec->mTotalRecordSteps;
     }
+    rec->mFlushInterval = par.getValue<int>("OUT_STATIONS_FLUSH_INTERVAL");
+    if (rec->mFlushInterval < 0) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_FLUSH_INTERVAL.");
+    }
+    rec->mDeltaT = dt;
+    rec->mDecimation = par.getValue<int>("OUT_STATIONS_DECIMATION");
+    if (rec->mDecimation < 1) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_DECIMATION.");
+    }
+    std::string strquant = par.getValue<std::string>("OUT_STATIONS_QUANTITY");
+    if (boost::iequals(strquant, "displ")) {
+        rec->mDerivative = 0;
+    } else if (boost::iequals(strquant, "veloc")) {
+        rec->mDerivative = 1;
+    } else if (boost::iequals(strquant, "accel")) {
+        rec->mDerivative = 2;
+    } else {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_QUANTITY.");
+    }
+    rec->mSaveSurfaceStrain = par.getValue<bool>("OUT_STATIONS_WHOLE_SURFACE_STRAIN");
+    rec->mSaveSurfaceDeflate = par.getValue<int>("OUT_STATIONS_WHOLE_SURFACE_DEFLATE");
+    if (rec->mSaveSurfaceDeflate < 0 || rec->mSaveSurfaceDeflate > 9) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_DEFLATE.");
+    }
+    rec->mSaveSurfacePrecision = par.getValue<int>("OUT_STATIONS_WHOLE_SURFACE_PRECISION");
+    if (rec->mSaveSurfacePrecision < 0) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_PRECISION.");
+    }
+    rec->mSaveSurfaceNuCutoff = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_NU_CUTOFF");
+    if (rec->mSaveSurfaceNuCutoff < 0. || rec->mSaveSurfaceNuCutoff >= 1.) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_NU_CUTOFF.");
+    }
+    rec->mSaveSurfaceVTK = par.getValue<bool>("OUT_STATIONS_WHOLE_SURFACE_VTK", 0);
+    if (rec->mSaveSurfaceVTK) {
+        if (!saveSurf) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "OUT_STATIONS_WHOLE_SURFACE_VTK requires OUT_STATIONS_WHOLE_SURFACE.");
+        }
+        if (par.getSize("OUT_STATIONS_WHOLE_SURFACE_VTK") != 6) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_VTK.");
+        }
+        rec->mSurfaceVTKLatMin = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_VTK", 1);
+        rec->mSurfaceVTKLatMax = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_VTK", 2);
+        rec->mSurfaceVTKLonMin = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_VTK", 3);
+        rec->mSurfaceVTKLonMax = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_VTK", 4);
+        rec->mSurfaceVTKSpacing = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_VTK", 5);
+        if (rec->mSurfaceVTKLatMin >= rec->mSurfaceVTKLatMax || 
+            rec->mSurfaceVTKLonMin >= rec->mSurfaceVTKLonMax ||
+            rec->mSurfaceVTKLatMin < -90. || rec->mSurfaceVTKLatMax > 90. || 
+            rec->mSurfaceVTKSpacing <= 0.) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_VTK.");
+        }
+        rec->mSurfaceVTKInterval = par.getValue<int>("OUT_STATIONS_WHOLE_SURFACE_VTK_INTERVAL");
+        if (rec->mSurfaceVTKInterval <= 0) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_VTK_INTERVAL.");
+        }
+    }
+    rec->mSaveSurfaceGroundMotion = par.getValue<bool>("OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION", 0);
+    if (rec->mSaveSurfaceGroundMotion) {
+        if (!saveSurf) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION requires OUT_STATIONS_WHOLE_SURFACE.");
+        }
+        int size = par.getSize("OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION");
+        for (int i = 1; i < size; i++) {
+            double period = par.getValue<double>("OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION", i);
+            if (period <= 0.) {
+                throw std::runtime_error("ReceiverCollection::buildInparam || "
+                    "Invalid parameter, keyword = OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION.");
+            }
+            rec->mSurfaceGroundMotionPeriods.push_back(period);
+        }
+    }
+    rec->mSaveSurfaceTimeSeries = par.getValue<bool>("OUT_STATIONS_WHOLE_SURFACE_TIME_SERIES");
+    // parallel NetCDF
+    NetCDF_Writer::sChunkTimeSteps = par.getValue<int>("NETCDF_CHUNK_TIME_STEPS");
+    NetCDF_Writer::sIOAggregators = par.getValue<int>("NETCDF_IO_AGGREGATORS");
+    if (NetCDF_Writer::sChunkTimeSteps < 0 || NetCDF_Writer::sIOAggregators < 0) {
+        throw std::runtime_error("ReceiverCollection::buildInparam || "
+            "Invalid parameter, keyword = NETCDF_CHUNK_TIME_STEPS or NETCDF_IO_AGGREGATORS.");
+    }
+    // volumetric wavefield
+    rec->mSaveVolume = par.getValue<bool>("OUT_VOLUME", 0);
+    if (rec->mSaveVolume) {
+        if (par.getSize("OUT_VOLUME") != 5) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_VOLUME.");
+        }
+        rec->mVolumeRMin = par.getValue<double>("OUT_VOLUME", 1) * 1e3;
+        rec->mVolumeRMax = par.getValue<double>("OUT_VOLUME", 2) * 1e3;
+        rec->mVolumeDistMin = par.getValue<double>("OUT_VOLUME", 3);
+        rec->mVolumeDistMax = par.getValue<double>("OUT_VOLUME", 4);
+        rec->mVolumeInterval = par.getValue<int>("OUT_VOLUME_RECORD_INTERVAL");
+        if (rec->mVolumeInterval <= 0) {
+            rec->mVolumeInterval = rec->mRecordInterval;
+        }
+        rec->mVolumeGLLStride = par.getValue<int>("OUT_VOLUME_GLL_STRIDE");
+        if (rec->mVolumeGLLStride <= 0 || nPol % rec->mVolumeGLLStride != 0) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "OUT_VOLUME_GLL_STRIDE must be a divisor of nPol.");
+        }
+        rec->mVolumeStrain = par.getValue<bool>("OUT_VOLUME_STRAIN");
+        rec->mVolumeDeflate = par.getValue<int>("OUT_VOLUME_DEFLATE");
+        if (rec->mVolumeDeflate < 0 || rec->mVolumeDeflate > 9) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_VOLUME_DEFLATE.");
+        }
+        rec->mVolumePrecision = par.getValue<int>("OUT_VOLUME_PRECISION");
+        rec->mVolumeMemoryMB = par.getValue<double>("OUT_VOLUME_MEMORY_MB");
+        if (rec->mVolumePrecision < 0 || rec->mVolumeMemoryMB < 0.) {
+            throw std::runtime_error("ReceiverCollection::buildInparam || "
+                "Invalid parameter, keyword = OUT_VOLUME_PRECISION or OUT_VOLUME_MEMORY_MB.");
+        }
+    }
     std::string strcomp = par.getValue<std::string>("OUT_STATIONS_COMPONENTS");
     if (boost::iequals(strcomp, "RTZ")) {
         rec->mComponents = "RTZ";
@@ -341,7 +754,7 @@ void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters
     // IO
     int numFmt = par.getSize("OUT_STATIONS_FORMAT");
     // use bool first to avoid duplicated IO
-    bool ascii = false, netcdf = false, netcdf_no_assemble = false; 
+    bool ascii = false, netcdf = false, netcdf_no_assemble = false, binary = false, asdf = false; 
     for (int i = 0; i < numFmt; i++) {
         std::string strfmt = par.getValue<std::string>("OUT_STATIONS_FORMAT", i); 
         if (boost::iequals(strfmt, "ascii")) {
@@ -350,6 +763,10 @@ void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters
             netcdf = true;
         } else if (boost::iequals(strfmt, "netcdf_no_assemble")) {
             netcdf_no_assemble = true;
+        } else if (boost::iequals(strfmt, "binary")) {
+            binary = true;
+        } else if (boost::iequals(strfmt, "asdf")) {
+            asdf = true;
         } else {
             throw std::runtime_error("ReceiverCollection::buildInparam || "
                 "Invalid parameter, keyword = OUT_STATIONS_FORMAT.");
@@ -381,6 +798,15 @@ void ReceiverCollection::buildInparam(ReceiverCollection *&rec, const Parameters
         rec->mPointwiseIO.push_back(new PointwiseIONetCDF(false));
         rec->mAssemble = false;
     }
+    if (binary) {
+        rec->mPointwiseIO.push_back(new PointwiseIOBinary());
+    }
+    if (asdf) {
+        // the first record is at time step 0
+        double samplingInterval = dt * rec->mRecordInterval * rec->mDecimation;
+        rec->mPointwiseIO.push_back(new PointwiseIOASDF(
+            par.getValue<std::string>("SOURCE_FILE"), -shiftSTF, samplingInterval));
+    }
     
     if (verbose) {
         XMPI::cout << rec->verbose();
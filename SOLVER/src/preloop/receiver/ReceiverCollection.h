@@ -26,26 +26,37 @@ public:
     std::string verbose() const;
     
     static void buildInparam(ReceiverCollection *&rec, const Parameters &par, 
-        double srcLat, double srcLon, double srcDep, int totalStepsSTF, int verbose);
+        double srcLat, double srcLon, double srcDep, int totalStepsSTF, double shiftSTF,
+        double dt, int verbose);
         
 private:
     
-    // receivers
+    // receivers, all until release and those of this rank after
     std::vector<Receiver *> mReceivers;
+    // number of all receivers, the first and the last for verbose
+    int mNumReceivers = 0;
+    std::string mVerboseFirst = "";
+    std::string mVerboseLast = "";
     
     // input
     std::string mInputFile;
     bool mGeographic;
     
     // options
+    int mTotalStepsSTF = 0;
     int mTotalRecordSteps = 0;
     int mRecordInterval = 1;
     int mBufferSize = 1000;
+    int mFlushInterval = 10;
+    // streaming filter of seismograms
+    int mDecimation = 1;
+    int mDerivative = 0;
+    double mDeltaT = 0.;
     std::string mComponents = "RTZ";
     
     // IO
     std::vector<PointwiseIO *> mPointwiseIO;
-
+    
     // for verbose
     int mWidthName;
     int mWidthNetwork;
@@ -55,6 +66,36 @@ private:
     double mSaveSurfaceDistMin = 0.;
     double mSaveSurfaceDistMax = 180.;
     bool mSaveSurfaceFromUpper = false;
+    bool mSaveSurfaceStrain = false;
+    int mSaveSurfaceDeflate = 0;
+    int mSaveSurfacePrecision = 0;
+    double mSaveSurfaceNuCutoff = 0.;
+    // VTK frames of the surface wavefield
+    bool mSaveSurfaceVTK = false;
+    double mSurfaceVTKLatMin = -90.;
+    double mSurfaceVTKLatMax = 90.;
+    double mSurfaceVTKLonMin = -180.;
+    double mSurfaceVTKLonMax = 180.;
+    double mSurfaceVTKSpacing = 1.;
+    int mSurfaceVTKInterval = 1;
+    // time series of the surface wavefield
+    bool mSaveSurfaceTimeSeries = true;
+    // peak ground motion and response spectra
+    bool mSaveSurfaceGroundMotion = false;
+    std::vector<double> mSurfaceGroundMotionPeriods;
+    
+    // volumetric wavefield
+    bool mSaveVolume = false;
+    double mVolumeRMin = 0.;
+    double mVolumeRMax = 0.;
+    double mVolumeDistMin = 0.;
+    double mVolumeDistMax = 180.;
+    int mVolumeInterval = 1;
+    int mVolumeGLLStride = 1;
+    bool mVolumeStrain = false;
+    int mVolumeDeflate = 0;
+    int mVolumePrecision = 0;
+    double mVolumeMemoryMB = 0.;
     bool mAssemble = true;
     
     // source location
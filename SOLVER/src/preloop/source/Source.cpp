@@ -12,6 +12,7 @@
 #include "XMath.h"
 #include "SpectralConstants.h"
 #include "XMPI.h"
+#include "InputBundle.h"
 #include "MultilevelTimer.h"
 
 Source::Source(double depth, double lat, double lon):
@@ -36,14 +37,14 @@ void Source::release(Domain &domain, const Mesh &mesh) const {
     if (locate(mesh, locTag, interpFactZ)) {
         myrank = XMPI::rank();
     }
-
+    
     // min recRank
     int myrank_min = XMPI::min(myrank);
     if (myrank_min == XMPI::nproc()) {
         throw std::runtime_error("Source::release || Error locating source.");
     }
     MultilevelTimer::end("Locate Source", 2);
-
+    
     MultilevelTimer::begin("Compute Source", 2);
     // release to me
     if (myrank_min == XMPI::rank()) {
@@ -63,7 +64,7 @@ bool Source::locate(const Mesh &mesh, int &locTag, RDColP &interpFactZ) const {
     RDCol2 srcCrds = RDCol2::Zero();
     srcCrds(1) = mesh.computeRadiusRef(mDepth, mLatitude, mLongitude);
     MultilevelTimer::end("R Source", 3);
-
+    
     // check range of subdomain
     if (srcCrds(0) > mesh.sMax() + tinySingle || srcCrds(0) < mesh.sMin() - tinySingle) {
         return false;
@@ -73,9 +74,11 @@ bool Source::locate(const Mesh &mesh, int &locTag, RDColP &interpFactZ) const {
     }
     // find host element
     RDCol2 srcXiEta;
-    for (int iloc = 0; iloc < mesh.getNumQuads(); iloc++) {
+    std::vector<int> locs;
+    mesh.findQuads(srcCrds(0), srcCrds(1), locs);
+    for (int iloc: locs) {
         const Quad *quad = mesh.getQuad(iloc);
-        if (!quad->isAxial() || quad->isFluid() || !quad->nearMe(srcCrds(0), srcCrds(1))) {
+        if (!quad->isAxial() || quad->isFluid()) {
             continue;
         }
         if (quad->invMapping(srcCrds, srcXiEta)) {
@@ -97,6 +100,9 @@ bool Source::locate(const Mesh &mesh, int &locTag, RDColP &interpFactZ) const {
 #include "Earthquake.h"
 #include "PointForce.h"
 #include "NullSource.h"
+#include "FiniteFault.h"
+#include "AdjointSource.h"
+#include "NetCDF_Reader.h"
 #include <fstream>
 #include <boost/algorithm/string.hpp>
 #include <cfloat>
@@ -122,7 +128,7 @@ void Source::buildInparam(Source *&src, const Parameters &par, int verbose) {
     if (src) {
         delete src;
     }
-
+    
     // null source
     if (par.getValue<bool>("DEVELOP_NON_SOURCE_MODE")) {
         src = new NullSource();
@@ -131,99 +137,165 @@ void Source::buildInparam(Source *&src, const Parameters &par, int verbose) {
         }
         return;
     }
-
+    
     std::string src_type = par.getValue<std::string>("SOURCE_TYPE");
     std::string src_file = par.getValue<std::string>("SOURCE_FILE");
-
+    
     if (boost::iequals(src_type, "earthquake")) {
         std::string cmtfile = Parameters::sInputDirectory + "/" + src_file;
         double depth = DBL_MAX, lat = DBL_MAX, lon = DBL_MAX;
         double Mrr = DBL_MAX, Mtt = DBL_MAX, Mpp = DBL_MAX; 
         double Mrt = DBL_MAX, Mrp = DBL_MAX, Mtp = DBL_MAX;
-        if (XMPI::root()) {
-            std::fstream fs(cmtfile, std::fstream::in);
-            if (!fs) {
-                throw std::runtime_error("Source::buildInparam || "
-                    "Error opening CMT data file: ||" + cmtfile);
-            }
-            std::string line;
-            while (std::getline(fs, line)) {
-                parseLine(line, "latitude", lat);
-                parseLine(line, "longitude", lon);
-                parseLine(line, "depth", depth);
-                parseLine(line, "Mrr", Mrr);
-                parseLine(line, "Mtt", Mtt);
-                parseLine(line, "Mpp", Mpp);
-                parseLine(line, "Mrt", Mrt);
-                parseLine(line, "Mrp", Mrp);
-                parseLine(line, "Mtp", Mtp);
-            }
-            checkValue("latitude", lat);
-            checkValue("longitude", lon);
-            checkValue("depth", depth);
-            checkValue("Mrr", Mrr);
-            checkValue("Mtt", Mtt);
-            checkValue("Mpp", Mpp);
-            checkValue("Mrt", Mrt);
-            checkValue("Mrp", Mrp);
-            checkValue("Mtp", Mtp);
-            // unit
-            depth *= 1e3;
-            Mrr *= 1e-7;
-            Mtt *= 1e-7;
-            Mpp *= 1e-7;
-            Mrt *= 1e-7;
-            Mrp *= 1e-7;
-            Mtp *= 1e-7;
-            fs.close();
+        // parsed by every rank from the input bundle
+        std::vector<std::string> lines;
+        if (!InputBundle::readLines(cmtfile, lines)) {
+            throw std::runtime_error("Source::buildInparam || "
+                "Error opening CMT data file: ||" + cmtfile);
         }
-        XMPI::bcast(depth);
-        XMPI::bcast(lat);
-        XMPI::bcast(lon);
-        XMPI::bcast(Mrr);
-        XMPI::bcast(Mtt);
-        XMPI::bcast(Mpp);
-        XMPI::bcast(Mrt);
-        XMPI::bcast(Mrp);
-        XMPI::bcast(Mtp);
+        for (const std::string &line: lines) {
+            parseLine(line, "latitude", lat);
+            parseLine(line, "longitude", lon);
+            parseLine(line, "depth", depth);
+            parseLine(line, "Mrr", Mrr);
+            parseLine(line, "Mtt", Mtt);
+            parseLine(line, "Mpp", Mpp);
+            parseLine(line, "Mrt", Mrt);
+            parseLine(line, "Mrp", Mrp);
+            parseLine(line, "Mtp", Mtp);
+        }
+        checkValue("latitude", lat);
+        checkValue("longitude", lon);
+        checkValue("depth", depth);
+        checkValue("Mrr", Mrr);
+        checkValue("Mtt", Mtt);
+        checkValue("Mpp", Mpp);
+        checkValue("Mrt", Mrt);
+        checkValue("Mrp", Mrp);
+        checkValue("Mtp", Mtp);
+        // unit
+        depth *= 1e3;
+        Mrr *= 1e-7;
+        Mtt *= 1e-7;
+        Mpp *= 1e-7;
+        Mrt *= 1e-7;
+        Mrp *= 1e-7;
+        Mtp *= 1e-7;
         src = new Earthquake(depth, lat, lon, Mrr, Mtt, Mpp, Mrt, Mrp, Mtp);
     } else if (boost::iequals(src_type, "point_force")) {
         // point force
         std::string pointffile = Parameters::sInputDirectory + "/" + src_file;
         double depth = DBL_MAX, lat = DBL_MAX, lon = DBL_MAX;
         double f1 = DBL_MAX, f2 = DBL_MAX, f3 = DBL_MAX;
+        // parsed by every rank from the input bundle
+        std::vector<std::string> lines;
+        if (!InputBundle::readLines(pointffile, lines)) {
+            throw std::runtime_error("Source::buildInparam || "
+                "Error opening point force data file: ||" + pointffile);
+        }
+        for (const std::string &line: lines) {
+            parseLine(line, "latitude", lat);
+            parseLine(line, "longitude", lon);
+            parseLine(line, "depth", depth);
+            parseLine(line, "Ft", f1);
+            parseLine(line, "Fp", f2);
+            parseLine(line, "Fr", f3);
+        }
+        checkValue("latitude", lat);
+        checkValue("longitude", lon);
+        checkValue("depth", depth);
+        checkValue("Ft", f1);
+        checkValue("Fp", f2);
+        checkValue("Fr", f3);
+        // unit
+        depth *= 1e3;
+        src = new PointForce(depth, lat, lon, f1, f2, f3);
+    } else if (boost::iequals(src_type, "finite_fault")) {
+        // finite fault
+        std::string faultfile = Parameters::sInputDirectory + "/" + src_file;
+        double depth = DBL_MAX, lat = DBL_MAX, lon = DBL_MAX;
+        RDMatXX subfaults;
+        int netcdf = 0, nsub = 0;
         if (XMPI::root()) {
-            std::fstream fs(pointffile, std::fstream::in);
-            if (!fs) {
-                throw std::runtime_error("Source::buildInparam || "
-                    "Error opening point force data file: ||" + pointffile);
+            if (NetCDF_Reader::isNetCDF(faultfile)) {
+                // subfaults read and located by every rank in release
+                netcdf = 1;
+                FiniteFault::readHypocentre(faultfile, depth, lat, lon, nsub);
+            } else {
+                std::fstream fs(faultfile, std::fstream::in);
+                if (!fs) {
+                    throw std::runtime_error("Source::buildInparam || "
+                        "Error opening finite fault data file: ||" + faultfile);
+                }
+                std::string line;
+                std::vector<std::vector<double>> rows;
+                while (std::getline(fs, line)) {
+                    parseLine(line, "latitude", lat);
+                    parseLine(line, "longitude", lon);
+                    parseLine(line, "depth", depth);
+                    // subfault lat lon depth Ft Fp Fr delay [hdur]
+                    std::vector<std::string> strs = Parameters::splitString(line, "\t ");
+                    if (!boost::iequals(strs[0], "subfault")) {
+                        continue;
+                    }
+                    if (strs.size() != 8 && strs.size() != 9) {
+                        throw std::runtime_error("Source::buildInparam || "
+                            "Bad subfault line: || " + line);
+                    }
+                    std::vector<double> row(8, -1.);
+                    for (int i = 1; i < strs.size(); i++) {
+                        row[i - 1] = boost::lexical_cast<double>(strs[i]);
+                    }
+                    rows.push_back(row);
+                }
+                checkValue("latitude", lat);
+                checkValue("longitude", lon);
+                checkValue("depth", depth);
+                if (rows.size() == 0) {
+                    throw std::runtime_error("Source::buildInparam || "
+                        "No subfault in finite fault data file: ||" + faultfile);
+                }
+                subfaults = RDMatXX(rows.size(), 8);
+                for (int isub = 0; isub < rows.size(); isub++) {
+                    for (int j = 0; j < 8; j++) {
+                        subfaults(isub, j) = rows[isub][j];
+                    }
+                }
+                // unit
+                depth *= 1e3;
+                subfaults.col(2) *= 1e3;
+                fs.close();
             }
-            std::string line;
-            while (std::getline(fs, line)) {
-                parseLine(line, "latitude", lat);
-                parseLine(line, "longitude", lon);
-                parseLine(line, "depth", depth);
-                parseLine(line, "Ft", f1);
-                parseLine(line, "Fp", f2);
-                parseLine(line, "Fr", f3);
+        }
+        XMPI::bcast(netcdf);
+        XMPI::bcast(depth);
+        XMPI::bcast(lat);
+        XMPI::bcast(lon);
+        if (netcdf) {
+            XMPI::bcast(nsub);
+            src = new FiniteFault(depth, lat, lon, faultfile, nsub);
+        } else {
+            XMPI::bcastEigen(subfaults);
+            src = new FiniteFault(depth, lat, lon, subfaults, 
+                par.getValue<std::string>("SOURCE_TIME_FUNCTION"),
+                par.getValue<double>("SOURCE_STF_HALF_DURATION"));
+        }
+    } else if (boost::iequals(src_type, "adjoint")) {
+        // adjoint, stations read and located by every rank in release
+        std::string adjointfile = Parameters::sInputDirectory + "/" + src_file;
+        double depth = DBL_MAX, lat = DBL_MAX, lon = DBL_MAX;
+        int nsta = 0;
+        if (XMPI::root()) {
+            if (!NetCDF_Reader::isNetCDF(adjointfile)) {
+                throw std::runtime_error("Source::buildInparam || "
+                    "Adjoint source data file must be NetCDF: ||" + adjointfile);
             }
-            checkValue("latitude", lat);
-            checkValue("longitude", lon);
-            checkValue("depth", depth);
-            checkValue("Ft", f1);
-            checkValue("Fp", f2);
-            checkValue("Fr", f3);
-            // unit
-            depth *= 1e3;
-            fs.close();
+            AdjointSource::readHypocentre(adjointfile, depth, lat, lon, nsta);
         }
         XMPI::bcast(depth);
         XMPI::bcast(lat);
         XMPI::bcast(lon);
-        XMPI::bcast(f1);
-        XMPI::bcast(f2);
-        XMPI::bcast(f3);
-        src = new PointForce(depth, lat, lon, f1, f2, f3);
+        XMPI::bcast(nsta);
+        src = new AdjointSource(depth, lat, lon, adjointfile, nsta);
     } else {
         throw std::runtime_error("Source::buildInparam || Unknown source type: " + src_type);
     }
@@ -0,0 +1,167 @@
+// AdjointSource.cpp
+// created by Kuangdai on 14-Oct-2026 
+// adjoint source, time-reversed traces injected as forces at stations
+
+#include "AdjointSource.h"
+#include "OffAxisPointForce.h"
+#include "AdjointSourceTerm.h"
+#include "Domain.h"
+#include "Mesh.h"
+#include "Quad.h"
+#include "NetCDF_Reader.h"
+#include "XMPI.h"
+#include "MultilevelTimer.h"
+#include <map>
+#include <sstream>
+
+AdjointSource::AdjointSource(double depth, double lat, double lon, 
+    const std::string &fileName, int numStations):
+Source(depth, lat, lon), mFileName(fileName), mNumStations(numStations) {
+    // nothing
+}
+
+void AdjointSource::release(Domain &domain, const Mesh &mesh) const {
+    MultilevelTimer::begin("Adjoint Source", 2);
+    
+    // stations and time axis, read by every rank
+    RDMatXX stations;
+    RDColX tracedt, tracet0;
+    std::vector<size_t> dims;
+    NetCDF_Reader reader;
+    reader.open(mFileName);
+    reader.read2D("stations", stations);
+    reader.read1D("trace_dt", tracedt);
+    reader.read1D("trace_t0", tracet0);
+    reader.readDims("traces", dims);
+    reader.close();
+    if (stations.rows() != mNumStations || stations.cols() != 3) {
+        throw std::runtime_error("AdjointSource::release || "
+            "Variable stations must be of shape (nsta, 3). || NetCDF file: " + mFileName);
+    }
+    if (dims.size() != 3 || dims[0] < 1 || dims[1] != mNumStations || dims[2] != 3) {
+        throw std::runtime_error("AdjointSource::release || "
+            "Variable traces must be of shape (nt, nsta, 3). || NetCDF file: " + mFileName);
+    }
+    // unit
+    stations.col(2) *= 1e3;
+    
+    // locate locally, one collective for all stations
+    MultilevelTimer::begin("Locate Stations", 3);
+    struct Located {
+        int mTag;
+        RDColP mInterpXii;
+        RDColP mInterpEta;
+    };
+    std::map<int, Located> located;
+    std::vector<int> myranks(mNumStations, XMPI::nproc());
+    for (int ista = 0; ista < mNumStations; ista++) {
+        OffAxisPointForce *force = OffAxisPointForce::createGeographic(stations(ista, 2), 
+            stations(ista, 0), stations(ista, 1), RDCol3::Zero(), mLatitude, mLongitude, mDepth);
+        Located loc;
+        if (force->locate(mesh, loc.mTag, loc.mInterpXii, loc.mInterpEta)) {
+            located.insert(std::make_pair(ista, loc));
+            myranks[ista] = XMPI::rank();
+        }
+        delete force;
+    }
+    std::vector<int> ranks;
+    XMPI::min(myranks, ranks);
+    for (int ista = 0; ista < mNumStations; ista++) {
+        if (ranks[ista] == XMPI::nproc()) {
+            std::stringstream ss;
+            ss << "AdjointSource::release || Error locating station " << ista << ".";
+            throw std::runtime_error(ss.str());
+        }
+    }
+    MultilevelTimer::end("Locate Stations", 3);
+    
+    // release stations owned by me, a unit force for each component
+    MultilevelTimer::begin("Compute Stations", 3);
+    AdjointSourceTerm *adjoint = new AdjointSourceTerm(mFileName, mNumStations, 
+        dims[0], tracedt(0), tracet0(0));
+    for (auto it = located.begin(); it != located.end(); it++) {
+        int ista = it->first;
+        if (ranks[ista] != XMPI::rank()) {
+            continue;
+        }
+        const Located &loc = it->second;
+        const Element *myElem = domain.getElement(mesh.getQuad(loc.mTag)->getElementTag());
+        for (int icomp = 0; icomp < 3; icomp++) {
+            RDCol3 ftpr = RDCol3::Zero();
+            ftpr(icomp) = 1.;
+            OffAxisPointForce *force = OffAxisPointForce::createGeographic(stations(ista, 2), 
+                stations(ista, 0), stations(ista, 1), ftpr, mLatitude, mLongitude, mDepth);
+            arPP_CMatX3 fouriers;
+            force->computeLocated(mesh, loc.mTag, loc.mInterpXii, loc.mInterpEta, fouriers);
+            adjoint->addForce(domain, myElem, fouriers, ista, icomp);
+            delete force;
+        }
+    }
+    domain.setAdjointSource(adjoint);
+    MultilevelTimer::end("Compute Stations", 3);
+    MultilevelTimer::end("Adjoint Source", 2);
+}
+
+void AdjointSource::readHypocentre(const std::string &fileName, 
+    double &depth, double &lat, double &lon, int &numStations) {
+    NetCDF_Reader reader;
+    reader.open(fileName);
+    RDColX hypo;
+    reader.read1D("hypocentre", hypo);
+    std::vector<size_t> dims;
+    reader.readDims("stations", dims);
+    reader.close();
+    if (hypo.size() != 3 || dims.size() != 2) {
+        throw std::runtime_error("AdjointSource::readHypocentre || "
+            "Bad hypocentre or stations. || NetCDF file: " + fileName);
+    }
+    lat = hypo(0);
+    lon = hypo(1);
+    depth = hypo(2) * 1e3;
+    numStations = dims[0];
+}
+
+AdjointSource *AdjointSource::buildKernel(const std::string &fileName, 
+    double srcDep, double srcLat, double srcLon) {
+    int nsta = 0;
+    if (XMPI::root()) {
+        if (!NetCDF_Reader::isNetCDF(fileName)) {
+            throw std::runtime_error("AdjointSource::buildKernel || "
+                "Adjoint source data file must be NetCDF: ||" + fileName);
+        }
+        NetCDF_Reader reader;
+        reader.open(fileName);
+        std::vector<size_t> dims;
+        reader.readDims("stations", dims);
+        reader.close();
+        if (dims.size() != 2) {
+            throw std::runtime_error("AdjointSource::buildKernel || "
+                "Bad stations. || NetCDF file: " + fileName);
+        }
+        nsta = dims[0];
+    }
+    XMPI::bcast(nsta);
+    return new AdjointSource(srcDep, srcLat, srcLon, fileName, nsta);
+}
+
+void AdjointSource::computeSourceFourier(const Quad &myQuad, const RDColP &interpFactZ,
+    arPP_CMatX3 &fouriers) const {
+    // stations are released by release()
+    for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+        fouriers[ipnt] = CMatX3::Zero(0, 3);
+    }
+}
+
+std::string AdjointSource::verbose() const {
+    std::stringstream ss;
+    ss << "\n========================== Source ==========================" << std::endl;
+    ss << "  Type                 =   " << "Adjoint" << std::endl;
+    ss << "  Reference Latitude   =   " << mLatitude << std::endl;
+    ss << "  Reference Longitude  =   " << mLongitude << std::endl;
+    ss << "  Reference Depth (km) =   " << mDepth / 1e3 << std::endl;
+    ss << "  Number of Stations   =   " << mNumStations << std::endl;
+    ss << "  NetCDF File          =   " << mFileName << std::endl;
+    ss << "========================== Source ==========================\n" << std::endl;
+    return ss.str();
+}
+
@@ -0,0 +1,37 @@
+// AdjointSource.h
+// created by Kuangdai on 14-Oct-2026 
+// adjoint source, time-reversed traces injected as forces at stations
+
+#pragma once
+#include "Source.h"
+
+class AdjointSource: public Source {
+public:
+    // stations and their traces in a NetCDF file, read in release;
+    // the axial reference source given by the hypocentre of the file
+    AdjointSource(double depth, double lat, double lon, 
+        const std::string &fileName, int numStations);
+    
+    // all stations released into one adjoint source term
+    void release(Domain &domain, const Mesh &mesh) const;
+    
+    std::string verbose() const;
+    
+    // hypocentre of a NetCDF file, with the number of stations
+    static void readHypocentre(const std::string &fileName, 
+        double &depth, double &lat, double &lon, int &numStations);
+    
+    // adjoint source of sensitivity kernels, around the source of the 
+    // forward wavefield, the hypocentre of the file being ignored; collective
+    static AdjointSource *buildKernel(const std::string &fileName, 
+        double srcDep, double srcLat, double srcLon);
+    
+protected:    
+    void computeSourceFourier(const Quad &myQuad, const RDColP &interpFactZ,
+        arPP_CMatX3 &fouriers) const;
+    
+private:
+    std::string mFileName;
+    int mNumStations;
+};
+
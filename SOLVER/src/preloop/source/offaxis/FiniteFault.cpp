@@ -0,0 +1,239 @@
+// FiniteFault.cpp
+// created by Kuangdai on 14-Oct-2026 
+// finite-fault source, point-force subfaults around an axial hypocentre
+
+#include "FiniteFault.h"
+#include "OffAxisPointForce.h"
+#include "FiniteFaultTerm.h"
+#include "STF.h"
+#include "SourceTimeFunction.h"
+#include "Domain.h"
+#include "Mesh.h"
+#include "Geodesy.h"
+#include "NetCDF_Reader.h"
+#include "XMPI.h"
+#include "MultilevelTimer.h"
+#include <map>
+#include <sstream>
+
+FiniteFault::FiniteFault(double depth, double lat, double lon, 
+    const RDMatXX &subfaults, const std::string &stfType, double hdur):
+Source(depth, lat, lon), mSubfaults(subfaults), mSTFType(stfType), 
+mHalfDuration(hdur), mNumSubfaults(subfaults.rows()) {
+    // nothing
+}
+
+FiniteFault::FiniteFault(double depth, double lat, double lon, 
+    const std::string &fileName, int numSubfaults):
+Source(depth, lat, lon), mSTFType("tabulated"), mHalfDuration(0.), 
+mFileName(fileName), mNumSubfaults(numSubfaults) {
+    // nothing
+}
+
+void FiniteFault::release(Domain &domain, const Mesh &mesh) const {
+    MultilevelTimer::begin("Finite Fault", 2);
+    double dt = domain.getSTF().getDeltaT();
+    
+    // subfaults, read by every rank from a NetCDF file
+    RDMatXX subfaults = mSubfaults;
+    if (mFileName != "") {
+        NetCDF_Reader reader;
+        reader.open(mFileName);
+        reader.read2D("subfaults", subfaults);
+        reader.close();
+        if (subfaults.rows() != mNumSubfaults || subfaults.cols() != 7) {
+            throw std::runtime_error("FiniteFault::release || "
+                "Variable subfaults must be of shape (nsub, 7). || NetCDF file: " + mFileName);
+        }
+        // unit
+        subfaults.col(2) *= 1e3;
+    }
+    
+    // angular range of the local mesh seen from the centre, 
+    // outside which a subfault is skipped before its radius is computed
+    double thetaMin = pi, thetaMax = 0.;
+    for (double s: {mesh.sMin(), mesh.sMax()}) {
+        for (double z: {mesh.zMin(), mesh.zMax()}) {
+            double theta = atan2(std::max(s, 0.), z);
+            thetaMin = std::min(thetaMin, theta);
+            thetaMax = std::max(thetaMax, theta);
+        }
+    }
+    thetaMin -= tinySingle;
+    thetaMax += tinySingle;
+    
+    // locate locally, one collective for all subfaults
+    MultilevelTimer::begin("Locate Subfaults", 3);
+    struct Located {
+        int mTag;
+        RDColP mInterpXii;
+        RDColP mInterpEta;
+    };
+    std::map<int, Located> located;
+    std::vector<int> myranks(mNumSubfaults, XMPI::nproc());
+    for (int isub = 0; isub < mNumSubfaults; isub++) {
+        OffAxisPointForce *force = createForce(subfaults, isub);
+        if (force->getThataSrc() >= thetaMin && force->getThataSrc() <= thetaMax) {
+            Located loc;
+            if (force->locate(mesh, loc.mTag, loc.mInterpXii, loc.mInterpEta)) {
+                located.insert(std::make_pair(isub, loc));
+                myranks[isub] = XMPI::rank();
+            }
+        }
+        delete force;
+    }
+    std::vector<int> ranks;
+    XMPI::min(myranks, ranks);
+    for (int isub = 0; isub < mNumSubfaults; isub++) {
+        if (ranks[isub] == XMPI::nproc()) {
+            std::stringstream ss;
+            ss << "FiniteFault::release || Error locating subfault " << isub << ".";
+            throw std::runtime_error(ss.str());
+        }
+    }
+    MultilevelTimer::end("Locate Subfaults", 3);
+    
+    // release subfaults owned by me
+    MultilevelTimer::begin("Compute Subfaults", 3);
+    FiniteFaultTerm *fault = new FiniteFaultTerm();
+    // one normalized analytic stf, groups by half duration and delay
+    int istfNorm = -1;
+    int scalingOrder = 0;
+    if (mFileName == "") {
+        STF *stf = STF::createNormalized(mSTFType);
+        istfNorm = fault->addSTF(stf->createSourceTimeFunction());
+        scalingOrder = stf->getScalingOrder();
+        delete stf;
+    }
+    std::map<std::pair<double, double>, int> groups;
+    // tabulated stfs read only for the subfaults owned by me
+    NetCDF_Reader reader;
+    if (mFileName != "" && located.size() > 0) {
+        reader.open(mFileName);
+    }
+    for (auto it = located.begin(); it != located.end(); it++) {
+        int isub = it->first;
+        if (ranks[isub] != XMPI::rank()) {
+            continue;
+        }
+        double delay = subfaults(isub, 6);
+        int igroup = -1;
+        if (mFileName != "") {
+            // tabulated, a group of its own
+            std::vector<Real> stf;
+            readSTF(reader, isub, dt, stf);
+            int istf = fault->addSTF(new SourceTimeFunction(stf, dt, 0.));
+            igroup = fault->addGroup(istf, delay);
+        } else {
+            double hdur = subfaults(isub, 7) > 0. ? subfaults(isub, 7) : mHalfDuration;
+            hdur = std::max(hdur, 5. * dt);
+            auto key = std::make_pair(hdur, delay);
+            auto itg = groups.find(key);
+            if (itg == groups.end()) {
+                itg = groups.insert(std::make_pair(key, fault->addGroup(istfNorm, delay, 
+                    hdur, (Real)pow(hdur, -scalingOrder)))).first;
+            }
+            igroup = itg->second;
+        }
+        OffAxisPointForce *force = createForce(subfaults, isub);
+        const Located &loc = it->second;
+        force->releaseLocated(domain, mesh, loc.mTag, loc.mInterpXii, loc.mInterpEta, 
+            *fault, igroup);
+        delete force;
+    }
+    if (reader.isOpen()) {
+        reader.close();
+    }
+    domain.setFiniteFault(fault);
+    MultilevelTimer::end("Compute Subfaults", 3);
+    MultilevelTimer::end("Finite Fault", 2);
+}
+
+OffAxisPointForce *FiniteFault::createForce(const RDMatXX &subfaults, int isub) const {
+    const RDCol3 &ftpr = subfaults.block(isub, 3, 1, 3).transpose();
+    return OffAxisPointForce::createGeographic(subfaults(isub, 2), 
+        subfaults(isub, 0), subfaults(isub, 1), ftpr, mLatitude, mLongitude, mDepth);
+}
+
+void FiniteFault::readSTF(const NetCDF_Reader &reader, int isub, double dt, 
+    std::vector<Real> &stf) const {
+    RDColX stfdt;
+    reader.read1D("stf_dt", stfdt);
+    std::vector<size_t> dims;
+    reader.readDims("stf", dims);
+    if (dims.size() != 2 || dims[0] != mNumSubfaults || dims[1] < 1) {
+        throw std::runtime_error("FiniteFault::readSTF || "
+            "Variable stf must be of shape (nsub, nt). || NetCDF file: " + mFileName);
+    }
+    std::vector<double> table;
+    reader.readHyperslab("stf", table, {(size_t)isub, 0}, {1, dims[1]});
+    
+    // linear interpolation on dt, from the rupture time of the subfault
+    double dtf = stfdt(0);
+    int nt = table.size();
+    int nstep = (int)floor((nt - 1) * dtf / dt) + 1;
+    stf.resize(nstep);
+    for (int istep = 0; istep < nstep; istep++) {
+        double pos = istep * dt / dtf;
+        int i0 = std::min((int)pos, nt - 1);
+        int i1 = std::min(i0 + 1, nt - 1);
+        double w1 = pos - i0;
+        stf[istep] = (Real)((1. - w1) * table[i0] + w1 * table[i1]);
+    }
+}
+
+void FiniteFault::readHypocentre(const std::string &fileName, 
+    double &depth, double &lat, double &lon, int &numSubfaults) {
+    NetCDF_Reader reader;
+    reader.open(fileName);
+    RDColX hypo;
+    reader.read1D("hypocentre", hypo);
+    std::vector<size_t> dims;
+    reader.readDims("subfaults", dims);
+    reader.close();
+    if (hypo.size() != 3 || dims.size() != 2) {
+        throw std::runtime_error("FiniteFault::readHypocentre || "
+            "Bad hypocentre or subfaults. || NetCDF file: " + fileName);
+    }
+    lat = hypo(0);
+    lon = hypo(1);
+    depth = hypo(2) * 1e3;
+    numSubfaults = dims[0];
+}
+
+void FiniteFault::computeSourceFourier(const Quad &myQuad, const RDColP &interpFactZ,
+    arPP_CMatX3 &fouriers) const {
+    // subfaults are released by release()
+    for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
+        fouriers[ipnt] = CMatX3::Zero(0, 3);
+    }
+}
+
+std::string FiniteFault::verbose() const {
+    std::stringstream ss;
+    ss << "\n========================== Source ==========================" << std::endl;
+    ss << "  Type                 =   " << "Finite Fault" << std::endl;
+    ss << "  Hypocentre Latitude  =   " << mLatitude << std::endl;
+    ss << "  Hypocentre Longitude =   " << mLongitude << std::endl;
+    ss << "  Hypocentre Depth (km)=   " << mDepth / 1e3 << std::endl;
+    ss << "  Number of Subfaults  =   " << mNumSubfaults << std::endl;
+    ss << "  Time Series Type     =   " << mSTFType << std::endl;
+    if (mFileName == "") {
+        std::map<double, int> hdurs;
+        std::map<double, int> delays;
+        for (int isub = 0; isub < mSubfaults.rows(); isub++) {
+            hdurs[mSubfaults(isub, 7) > 0. ? mSubfaults(isub, 7) : mHalfDuration]++;
+            delays[mSubfaults(isub, 6)]++;
+        }
+        ss << "  Half Durations       =   " << hdurs.size() << " distinct" << std::endl;
+        ss << "  Rupture Delays       =   " << delays.size() << " distinct";
+        if (delays.size() > 0) {
+            ss << ", " << delays.begin()->first << " to " << delays.rbegin()->first << " s";
+        }
+        ss << std::endl;
+    } else {
+        ss << "  NetCDF File          =   " << mFileName << std::endl;
+    }
+    ss << "========================== Source ==========================\n" << std::endl;
+    return ss.str();
+}
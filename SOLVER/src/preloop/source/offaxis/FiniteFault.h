@@ -0,0 +1,53 @@
+// FiniteFault.h
+// created by Kuangdai on 14-Oct-2026 
+// finite-fault source, point-force subfaults around an axial hypocentre
+
+#pragma once
+#include "Source.h"
+
+class OffAxisPointForce;
+class NetCDF_Reader;
+
+class FiniteFault: public Source {
+public:
+    // subfaults: one row per subfault,
+    // lat, lon, depth (m), Ft, Fp, Fr (N), delay (s), half duration (s, <= 0 for default)
+    FiniteFault(double depth, double lat, double lon, 
+        const RDMatXX &subfaults, const std::string &stfType, double hdur);
+    
+    // subfaults and their tabulated stfs in a NetCDF file, read in release
+    FiniteFault(double depth, double lat, double lon, 
+        const std::string &fileName, int numSubfaults);
+    
+    // all subfaults released into one finite-fault term, 
+    // with the time step of the stf released to domain
+    void release(Domain &domain, const Mesh &mesh) const;
+    
+    std::string verbose() const;
+    
+    // hypocentre of a NetCDF file, with the number of subfaults
+    static void readHypocentre(const std::string &fileName, 
+        double &depth, double &lat, double &lon, int &numSubfaults);
+    
+protected:    
+    void computeSourceFourier(const Quad &myQuad, const RDColP &interpFactZ,
+        arPP_CMatX3 &fouriers) const;
+    
+private:
+    // point force of a subfault, in source-centered cylindrical components
+    OffAxisPointForce *createForce(const RDMatXX &subfaults, int isub) const;
+    
+    // tabulated stf of a subfault resampled on dt
+    void readSTF(const NetCDF_Reader &reader, int isub, double dt, 
+        std::vector<Real> &stf) const;
+    
+    // subfaults given directly
+    RDMatXX mSubfaults;
+    std::string mSTFType;
+    double mHalfDuration;
+    
+    // subfaults in a NetCDF file
+    std::string mFileName = "";
+    int mNumSubfaults;
+};
+
@@ -1,4 +1,4 @@
-// OffAxisPointForce.h
+// OffAxisPointForce.cpp
 // created by Kuangdai on 11-Nov-2017
 // off-axis point-force source
 
@@ -6,32 +6,45 @@
 #include "Quad.h"
 #include "SpectralConstants.h"
 #include "XMath.h"
+#include "Geodesy.h"
 #include <sstream>
 
 #include "Relabelling.h"
 
 OffAxisPointForce::OffAxisPointForce(double depth, double lat, double lon,
     double srcLat, double srcLon, double srcDep,
-    RDMatX3 q_sphiz): OffAxisSource(depth, lat, lon, srcLat, srcLon, srcDep),
+    const RDCol3 &q_sphiz): OffAxisSource(depth, lat, lon, srcLat, srcLon, srcDep),
     mQ_sphiz(q_sphiz) {
     // nothing
 }
 
+OffAxisPointForce *OffAxisPointForce::createGeographic(double depth, double lat, double lon,
+    const RDCol3 &ftpr, double srcLat, double srcLon, double srcDep) {
+    // force in source-centered cylindrical components (s, phi, z)
+    RDCol3 rtpG;
+    rtpG(0) = 1.;
+    rtpG(1) = Geodesy::lat2Theta_d(lat, depth);
+    rtpG(2) = Geodesy::lon2Phi(lon);
+    const RDCol3 &rtpS = Geodesy::rotateGlob2Src(rtpG, srcLat, srcLon, srcDep);
+    const RDMat33 &QS = Geodesy::rotationMatrix(Geodesy::lat2Theta_d(srcLat, srcDep), 
+        Geodesy::lon2Phi(srcLon));
+    const RDCol3 &fxyzS = QS.transpose() * 
+        Geodesy::rotationMatrix(rtpG(1), rtpG(2)) * ftpr;
+    const RDCol3 &ftprS = Geodesy::rotationMatrix(rtpS(1), rtpS(2)).transpose() * fxyzS;
+    RDCol3 q_sphiz;
+    q_sphiz(0) = ftprS(0) * cos(rtpS(1)) + ftprS(2) * sin(rtpS(1));
+    q_sphiz(1) = ftprS(1);
+    q_sphiz(2) = -ftprS(0) * sin(rtpS(1)) + ftprS(2) * cos(rtpS(1));
+    return new OffAxisPointForce(depth, lat, lon, srcLat, srcLon, srcDep, q_sphiz);
+}
+
 void OffAxisPointForce::computeSourceFourier(const Quad &myQuad, 
     const RDColP &interpFactXii,
     const RDColP &interpFactEta,
     double phi, 
-    vec_arPP_CMatX3 &fouriers) const {
-    // number of steps
-    int nstep = mQ_sphiz.rows();
+    arPP_CMatX3 &fouriers) const {
     // Fourier order
     int nu = myQuad.getNu();
-    // set zero
-    for (int istep = 0; istep < nstep; istep++) {
-        for (int ipnt = 0; ipnt < nPntElem; ipnt++) {
-            fouriers[istep][ipnt] = CMatX3::Zero(nu + 1, 3);
-        }
-    }
     // particle relabelling
     RDRowN JPRT;
     if (myQuad.hasRelabelling()) {
@@ -40,18 +53,19 @@ void OffAxisPointForce::computeSourceFourier(const Quad &myQuad,
     } else {
         JPRT = RDRowN::Ones();
     }
+    // delta function at phi, exp(-i beta phi) / (2 pi)
+    CDColX delta(nu + 1);
+    for (int beta = 0; beta <= nu; beta++) {
+        delta(beta) = exp(-beta * phi * iid) / (2. * pi);
+    }
     // compute source pointwise
-    for (int istep = 0; istep < nstep; istep++) {  // stf
-        for (int ipol = 0; ipol <= nPol; ipol++) {
-            for (int jpol = 0; jpol <= nPol; jpol++) {
-                int ipnt = ipol * nPntEdge + jpol;
-                double fact = interpFactXii(ipol) * interpFactEta(jpol);
-                for (int beta = 0; beta <= nu; beta++) {
-                    for (int idim = 0; idim < 3; idim++) {
-                        fouriers[istep][ipnt](beta, idim) = Complex(
-                            fact * exp(beta * phi * iid) * mQ_sphiz(istep, idim) * JPRT(ipnt));
-                    }
-                }
+    for (int ipol = 0; ipol <= nPol; ipol++) {
+        for (int jpol = 0; jpol <= nPol; jpol++) {
+            int ipnt = ipol * nPntEdge + jpol;
+            double fact = interpFactXii(ipol) * interpFactEta(jpol) * JPRT(ipnt);
+            fouriers[ipnt] = CMatX3::Zero(nu + 1, 3);
+            for (int idim = 0; idim < 3; idim++) {
+                fouriers[ipnt].col(idim) = (delta * (fact * mQ_sphiz(idim))).cast<Complex>();
             }
         }
     }
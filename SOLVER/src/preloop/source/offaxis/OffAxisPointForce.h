@@ -10,8 +10,12 @@ public:
     
     OffAxisPointForce(double depth, double lat, double lon,
         double srcLat, double srcLon, double srcDep,
-        RDMatX3 q_sphiz);
-
+        const RDCol3 &q_sphiz);
+    
+    // from geographic components (Ft, Fp, Fr) at lat, lon and depth
+    static OffAxisPointForce *createGeographic(double depth, double lat, double lon,
+        const RDCol3 &ftpr, double srcLat, double srcLon, double srcDep);
+    
     std::string verbose() const;
 
 protected:
@@ -19,9 +23,9 @@ protected:
         const RDColP &interpFactXii,
         const RDColP &interpFactEta,
         double phi,
-        vec_arPP_CMatX3 &fouriers) const;
+        arPP_CMatX3 &fouriers) const;
 
 private:
     // store: cylindrical components (q_s, q_phi, q_z)
-    RDMatX3 mQ_sphiz;
+    RDCol3 mQ_sphiz;
 };
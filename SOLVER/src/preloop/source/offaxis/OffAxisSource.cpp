@@ -1,4 +1,4 @@
-// OffAxisSource.h
+// OffAxisSource.cpp
 // created by Kuangdai on 11-Nov-2017 
 // base class of off-axis source
 
@@ -7,8 +7,7 @@
 #include "Quad.h"
 #include "Domain.h"
 #include "Element.h"
-// TODO: implement this in core
-// #include "OffAxisSourceTerm.h"
+#include "FiniteFaultTerm.h"
 #include "Mesh.h"
 #include "XMath.h"
 #include "SpectralConstants.h"
@@ -37,7 +36,8 @@ mDepth(depth), mLatitude(lat), mLongitude(lon) {
     mPhiSrc = rtpS(2);
 }
 
-void OffAxisSource::release(Domain &domain, const Mesh &mesh) const {
+void OffAxisSource::release(const Domain &domain, const Mesh &mesh, 
+    FiniteFaultTerm &fault, int igroup) const {
     MultilevelTimer::begin("Locate Off-axis Source", 2);
     // locate local
     int myrank = XMPI::nproc();
@@ -46,40 +46,49 @@ void OffAxisSource::release(Domain &domain, const Mesh &mesh) const {
     if (locate(mesh, locTag, interpFactXii, interpFactEta)) {
         myrank = XMPI::rank();
     }
-
+    
     // min recRank
     int myrank_min = XMPI::min(myrank);
     if (myrank_min == XMPI::nproc()) {
         throw std::runtime_error("OffAxisSource::release || Error locating off-axis source.");
     }
     MultilevelTimer::end("Locate Off-axis Source", 2);
-
+    
     MultilevelTimer::begin("Compute Off-axis Source", 2);
     // release to me
     if (myrank_min == XMPI::rank()) {
-        // compute OffAxisSource term
-        vec_arPP_CMatX3 fouriers;
-        const Quad *myQuad = mesh.getQuad(locTag);
-        computeSourceFourier(*myQuad, interpFactXii, interpFactEta, mPhiSrc, fouriers);
-        // add to domain
-        Element *myElem = domain.getElement(myQuad->getElementTag());
-        // TODO: implement this in core
-        //       the existing class SourceTerm is not general enough
-        //       because the source time funciton varies for each source
-        // domain.addOffAxisSourceTerm(new OffAxisSourceTerm(myElem, fouriers));
+        releaseLocated(domain, mesh, locTag, interpFactXii, interpFactEta, fault, igroup);
     }
     MultilevelTimer::end("Compute Off-axis Source", 2);
 }
 
+void OffAxisSource::releaseLocated(const Domain &domain, const Mesh &mesh, int locTag, 
+    const RDColP &interpFactXii, const RDColP &interpFactEta,
+    FiniteFaultTerm &fault, int igroup) const {
+    // compute OffAxisSource term
+    arPP_CMatX3 fouriers;
+    computeLocated(mesh, locTag, interpFactXii, interpFactEta, fouriers);
+    const Quad *myQuad = mesh.getQuad(locTag);
+    // add to fault, whose groups carry the source time functions
+    const Element *myElem = domain.getElement(myQuad->getElementTag());
+    fault.addSubfault(domain, myElem, fouriers, igroup);
+}
+
+void OffAxisSource::computeLocated(const Mesh &mesh, int locTag, 
+    const RDColP &interpFactXii, const RDColP &interpFactEta,
+    arPP_CMatX3 &fouriers) const {
+    const Quad *myQuad = mesh.getQuad(locTag);
+    computeSourceFourier(*myQuad, interpFactXii, interpFactEta, mPhiSrc, fouriers);
+}
+
 bool OffAxisSource::locate(const Mesh &mesh, int &locTag, 
     RDColP &interpFactXii, RDColP &interpFactEta) const {
-    MultilevelTimer::begin("R OffAxisSource", 3);
+    // no timer here, whose end is a barrier
     RDCol2 srcCrds = RDCol2::Zero();
     double r = mesh.computeRadiusRef(mDepth, mLatitude, mLongitude);
     srcCrds(0) = r * sin(mThetaSrc);
     srcCrds(1) = r * cos(mThetaSrc);
-    MultilevelTimer::end("R OffAxisSource", 3);
-
+    
     // check range of subdomain
     if (srcCrds(0) > mesh.sMax() + tinySingle || srcCrds(0) < mesh.sMin() - tinySingle) {
         return false;
@@ -89,9 +98,11 @@ bool OffAxisSource::locate(const Mesh &mesh, int &locTag,
     }
     // find host element
     RDCol2 srcXiEta;
-    for (int iloc = 0; iloc < mesh.getNumQuads(); iloc++) {
+    std::vector<int> locs;
+    mesh.findQuads(srcCrds(0), srcCrds(1), locs);
+    for (int iloc: locs) {
         const Quad *quad = mesh.getQuad(iloc);
-        if (quad->isFluid() || !quad->nearMe(srcCrds(0), srcCrds(1))) {
+        if (quad->isFluid()) {
             continue;
         }
         if (quad->invMapping(srcCrds, srcXiEta)) {
@@ -109,16 +120,3 @@ bool OffAxisSource::locate(const Mesh &mesh, int &locTag,
     }
     return false;
 }
-
-#include "Parameters.h"
-// #include "OffAxisPointForce.h"
-#include <fstream>
-#include <boost/algorithm/string.hpp>
-
-void OffAxisSource::buildInparam(std::vector<OffAxisSource> *&offsrc, 
-    const Parameters &par, int verbose) {
-    // TODO: 
-    // read location of off-axis sources
-    // read source-time function
-    // build off-axis source objects
-}
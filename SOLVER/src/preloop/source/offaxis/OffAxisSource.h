@@ -10,7 +10,7 @@
 class Quad;
 class Mesh;
 class Domain;
-class Parameters;
+class FiniteFaultTerm;
 
 class OffAxisSource {
 public:
@@ -19,7 +19,23 @@ public:
     
     virtual ~OffAxisSource() {};
     
-    void release(Domain &domain, const Mesh &mesh) const;
+    // release to group igroup of a finite fault, collective
+    void release(const Domain &domain, const Mesh &mesh, 
+        FiniteFaultTerm &fault, int igroup) const;
+    
+    // locate in the local mesh, not collective
+    bool locate(const Mesh &mesh, int &locTag, 
+        RDColP &interpFactXii, RDColP &interpFactEta) const;
+    
+    // release a located source to group igroup of a finite fault, not collective
+    void releaseLocated(const Domain &domain, const Mesh &mesh, int locTag, 
+        const RDColP &interpFactXii, const RDColP &interpFactEta,
+        FiniteFaultTerm &fault, int igroup) const;
+    
+    // force of a located source on the points of its element, not collective
+    void computeLocated(const Mesh &mesh, int locTag, 
+        const RDColP &interpFactXii, const RDColP &interpFactEta,
+        arPP_CMatX3 &fouriers) const;
     
     virtual std::string verbose() const = 0;
         
@@ -29,15 +45,12 @@ public:
     double getThataSrc() const {return mThetaSrc;};
     double getPhiSrc() const {return mPhiSrc;};
     
-    static void buildInparam(std::vector<OffAxisSource> *&offsrc, 
-        const Parameters &par, int verbose);
-    
 protected:
     virtual void computeSourceFourier(const Quad &myQuad, 
         const RDColP &interpFactXii,
         const RDColP &interpFactEta,
         double phi,
-        vec_arPP_CMatX3 &fouriers) const = 0;
+        arPP_CMatX3 &fouriers) const = 0;
         
     double mDepth;
     double mLatitude;
@@ -45,9 +58,5 @@ protected:
     // theta and phi in source-centered coordinate system
     double mThetaSrc;
     double mPhiSrc;
-        
-private:
-    bool locate(const Mesh &mesh, int &locTag, 
-        RDColP &interpFactXii, RDColP &interpFactEta) const;
 };
 
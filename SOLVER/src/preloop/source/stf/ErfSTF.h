@@ -10,6 +10,7 @@ class ErfSTF: public STF {
 public: 
     ErfSTF(double dt, double length, double hdur, double decay);
     std::string verbose() const;
+    int getScalingOrder() const {return 0;};
 
 private:    
     double mHalfDuration;
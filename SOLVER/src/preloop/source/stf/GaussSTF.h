@@ -10,6 +10,7 @@ class GaussSTF: public STF {
 public:
     GaussSTF(double dt, double length, double hdur, double decay);
     std::string verbose() const;
+    int getScalingOrder() const {return 1;};
 
 private:
     double mHalfDuration;
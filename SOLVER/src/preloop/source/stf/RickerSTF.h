@@ -10,6 +10,7 @@ class RickerSTF: public STF {
 public:
     RickerSTF(double dt, double length, double hdur, double decay);
     std::string verbose() const;
+    int getScalingOrder() const {return 2;};
 
 private:
     double mHalfDuration;
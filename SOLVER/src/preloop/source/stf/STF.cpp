@@ -7,8 +7,12 @@
 #include "Domain.h"
 
 void STF::release(Domain &domain) const {
+    domain.setSTF(createSourceTimeFunction());
+}
+
+SourceTimeFunction *STF::createSourceTimeFunction() const {
     std::vector<Real> ts(mSTF.begin(), mSTF.end());
-    domain.setSTF(new SourceTimeFunction(ts, mDeltaT, mShift));
+    return new SourceTimeFunction(ts, mDeltaT, mShift);
 }
 
 #include "XMPI.h"
@@ -23,27 +27,15 @@ void STF::buildInparam(STF *&stf, const Parameters &par, double dt, int verbose)
         delete stf;
     }
     // read half duration
-    std::string cmtfile = Parameters::sInputDirectory + "/" + par.getValue<std::string>("SOURCE_FILE");
     double hdur = par.getValue<double>("SOURCE_STF_HALF_DURATION");
-    if (hdur < 5. * dt) {
-        hdur = 5. * dt;
-    }
-    double decay = 1.628;
     double duration = par.getValue<double>("TIME_RECORD_LENGTH");
-
     std::string mstf = par.getValue<std::string>("SOURCE_TIME_FUNCTION");
-    if (boost::iequals(mstf,"erf")) {
-        // Heaviside
-        stf = new ErfSTF(dt, duration, hdur, decay);
-    } else if (boost::iequals(mstf,"gauss")) {
-        // Gaussian
-        stf = new GaussSTF(dt, duration, hdur, decay);
-    } else if (boost::iequals(mstf,"ricker")){
-        // Ricker
-        stf = new RickerSTF(dt, duration, hdur, decay);
-    } else {
-        throw std::runtime_error("STF::buildInparam || Unknown stf type: " + mstf);
+    if (boost::iequals(mstf, "impulse")) {
+        // Green's function mode, the shortest Gaussian
+        mstf = "gauss";
+        hdur = 0.;
     }
+    stf = createSTF(mstf, dt, duration, hdur);
     
     // max total steps
     int maxTotalSteps = INT_MAX;
@@ -55,8 +47,48 @@ void STF::buildInparam(STF *&stf, const Parameters &par, double dt, int verbose)
         stf->mSTF.resize(maxTotalSteps);
     }
     
+    // the stf actually used, for reconvolution after the simulation
+    if (XMPI::root()) {
+        stf->writeAscii(Parameters::sOutputDirectory + "/stations/source_time_function.txt");
+    }
+    
     // verbose
     if (verbose) {
         XMPI::cout << stf->verbose();
     }
 }
+
+void STF::writeAscii(const std::string &fname) const {
+    std::fstream fs(fname, std::fstream::out);
+    if (!fs) {
+        throw std::runtime_error("STF::writeAscii || "
+            "Error opening output file: || " + fname);
+    }
+    fs << "# time_step " << mDeltaT << std::endl;
+    fs << "# shift_before_origin " << mShift << std::endl;
+    fs << "# scaling_order " << getScalingOrder() << std::endl;
+    fs.precision(10);
+    for (int i = 0; i < mSTF.size(); i++) {
+        fs << -mShift + i * mDeltaT << " " << mSTF[i] << std::endl;
+    }
+    fs.close();
+}
+
+STF *STF::createSTF(const std::string &type, double dt, double duration, double hdur) {
+    if (hdur < 5. * dt) {
+        hdur = 5. * dt;
+    }
+    double decay = 1.628;
+    if (boost::iequals(type, "erf")) {
+        // Heaviside
+        return new ErfSTF(dt, duration, hdur, decay);
+    } else if (boost::iequals(type, "gauss")) {
+        // Gaussian
+        return new GaussSTF(dt, duration, hdur, decay);
+    } else if (boost::iequals(type, "ricker")) {
+        // Ricker
+        return new RickerSTF(dt, duration, hdur, decay);
+    } else {
+        throw std::runtime_error("STF::createSTF || Unknown stf type: " + type);
+    }
+}
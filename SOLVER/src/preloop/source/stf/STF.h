@@ -10,6 +10,7 @@
 
 class Domain;
 class Parameters;
+class SourceTimeFunction;
 
 class STF {
 public:
@@ -18,13 +19,35 @@ public:
     void release(Domain &domain) const;
 
     virtual std::string verbose() const = 0;
+    
+    // stf(t; hdur) = stf(t / hdur; 1) / hdur ^ order
+    virtual int getScalingOrder() const = 0;
 
     static void buildInparam(STF *&stf, const Parameters &par, double dt, int verbose);
     
+    // stf of a type by name, half duration no shorter than 5 dt
+    static STF *createSTF(const std::string &type, double dt, double duration, double hdur);
+    
+    // stf of unit half duration, tabulated finely enough to be shared by 
+    // half durations down to 5 dt, scaled by getScalingOrder()
+    static STF *createNormalized(const std::string &type) {
+        return createSTF(type, 1. / sNormalizedSamples, 2.5, 1.);
+    };
+    
+    // solver-side copy
+    SourceTimeFunction *createSourceTimeFunction() const;
+    
+    // time and value in columns, time step and shift in the header
+    void writeAscii(const std::string &fname) const;
+    
     int getSize() const {return mSTF.size();};
+    double getShift() const {return mShift;};
 
 protected:
     double mDeltaT;
     double mShift;
     std::vector<double> mSTF;
+    
+    // samples per half duration of a normalized stf
+    static const int sNormalizedSamples = 1000;
 };
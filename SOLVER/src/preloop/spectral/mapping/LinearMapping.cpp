@@ -13,6 +13,12 @@ RDMat22 LinearMapping::jacobian(const RDMat24 &nodes, const RDCol2 &xieta, int c
     return nodes * shapeDerivatives(xieta).transpose();
 }
 
+bool LinearMapping::guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+    RDCol2 &xieta) const {
+    // exact
+    return invBilinear(nodes, sz, xieta);
+}
+
 RDRow4 LinearMapping::shapeFunction(const RDCol2 &xieta) const {
     RDRow4 shp;
     double xip = 1. + xieta(0);
@@ -16,6 +16,11 @@ public:
     
     MappingTypes getType() const {return MappingTypes::Linear;};
     
+protected:
+    
+    bool guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+        RDCol2 &xieta) const;
+    
 private:
     
     RDRow4 shapeFunction(const RDCol2 &xieta) const;
@@ -13,7 +13,10 @@ RDMat22 Mapping::invJacobian(const RDMat24 &nodes, const RDCol2 &xieta, int curv
 }
 
 bool Mapping::invMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, RDCol2 &xieta) const {
-    xieta = RDCol2::Zero();
+    // Newton iterations from the direct inverse, or from the centre
+    if (!guessInvMapping(nodes, sz, curvedOuter, xieta) || !xieta.allFinite()) {
+        xieta = RDCol2::Zero();
+    }
     int numiter = 10;
     for (int i = 1; i <= numiter; i++) {
         const RDCol2 &dsz = sz - mapping(nodes, xieta, curvedOuter);
@@ -25,6 +28,46 @@ bool Mapping::invMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter
     return false;
 }
 
+bool Mapping::invBilinear(const RDMat24 &nodes, const RDCol2 &sz, RDCol2 &xieta) {
+    // sz = a + b * xi + c * eta + d * xi * eta
+    const RDCol2 &a = (nodes.col(0) + nodes.col(1) + nodes.col(2) + nodes.col(3)) / 4.;
+    const RDCol2 &b = (- nodes.col(0) + nodes.col(1) + nodes.col(2) - nodes.col(3)) / 4.;
+    const RDCol2 &c = (- nodes.col(0) - nodes.col(1) + nodes.col(2) + nodes.col(3)) / 4.;
+    const RDCol2 &d = (nodes.col(0) - nodes.col(1) + nodes.col(2) - nodes.col(3)) / 4.;
+    const RDCol2 &q = sz - a;
+    auto cross = [](const RDCol2 &u, const RDCol2 &v) {return u(0) * v(1) - u(1) * v(0);};
+    // eliminating eta: A * xi^2 + B * xi + C = 0
+    double A = cross(b, d);
+    double B = cross(b, c) - cross(q, d);
+    double C = - cross(q, c);
+    double xi = 0.;
+    if (std::abs(A) <= 1e-12 * std::abs(B)) {
+        // parallelogram
+        if (B == 0.) {
+            return false;
+        }
+        xi = - C / B;
+    } else {
+        double disc = B * B - 4. * A * C;
+        if (disc < 0.) {
+            return false;
+        }
+        // the root closer to the element
+        double sq = sqrt(disc);
+        double xi0 = (- B + sq) / (2. * A);
+        double xi1 = (- B - sq) / (2. * A);
+        xi = std::abs(xi0) < std::abs(xi1) ? xi0 : xi1;
+    }
+    const RDCol2 &e = c + d * xi;
+    double e2 = e.squaredNorm();
+    if (e2 == 0.) {
+        return false;
+    }
+    xieta(0) = xi;
+    xieta(1) = (q - b * xi).dot(e) / e2;
+    return true;
+}
+
 double Mapping::interpolate(const RDRow4 &nodalValues, const RDCol2 &xieta) {
     return interpolateCol(nodalValues, xieta)(0);
 }
@@ -34,6 +34,15 @@ public:
     static int period0123(int p);
 
 protected:    
+    // direct inverse used as the first guess of invMapping, exact for 
+    // linear and spherical elements so that no iteration is needed;
+    // false if the mapping has none
+    virtual bool guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+        RDCol2 &xieta) const {return false;};
+    
+    // closed-form inverse of the bilinear mapping of the nodes
+    static bool invBilinear(const RDMat24 &nodes, const RDCol2 &sz, RDCol2 &xieta);
+    
     static std::array<RDMat22, 4> sOrthogQ2;
     
 };
@@ -75,4 +75,9 @@ RDMat22 SemiSphericalMapping::jacobian(const RDMat24 &nodes, const RDCol2 &xieta
     return Q2.transpose() * J2 * Q2;
 }
 
+bool SemiSphericalMapping::guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+    RDCol2 &xieta) const {
+    // the curved outer edge is close to the chord of the nodes
+    return invBilinear(nodes, sz, xieta);
+}
 
@@ -15,4 +15,9 @@ public:
     RDMat22 jacobian(const RDMat24 &nodes, const RDCol2 &xieta, int curvedOuter) const;
     
     MappingTypes getType() const {return MappingTypes::SemiSpherical;};
+    
+protected:
+    
+    bool guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+        RDCol2 &xieta) const;
 };
@@ -77,4 +77,35 @@ RDMat22 SphericalMapping::jacobian(const RDMat24 &nodes, const RDCol2 &xieta, in
     return Q2.transpose() * J2 * Q2;
 }
 
+bool SphericalMapping::guessInvMapping(const RDMat24 &nodes, const RDCol2 &sz, int curvedOuter, 
+    RDCol2 &xieta) const {
+    // rotate system such that curvedOuter = 2
+    const RDMat22 &Q2 = sOrthogQ2[curvedOuter];
+    const RDMat24 &nodes2 = Q2 * nodes;
+    const RDCol2 &sz2 = Q2 * sz;
+    // get r and theta
+    RDMat24 rtheta2;
+    rtheta2.row(0).array() = (nodes2.row(0).array().square() + nodes2.row(1).array().square()).sqrt();
+    for (int i = 0; i < 4; i++) {
+        rtheta2(1, i) = atan2(nodes2(0, i), nodes2(1, i));
+    }
+    // copy local variables
+    double r0 = rtheta2(0, Mapping::period0123(curvedOuter - 2));
+    double r3 = rtheta2(0, Mapping::period0123(curvedOuter + 1));
+    double t2 = rtheta2(1, Mapping::period0123(curvedOuter - 0));
+    double t3 = rtheta2(1, Mapping::period0123(curvedOuter + 1));   
+    XMath::makeClose(t2, t3);
+    if (std::abs(t2 - t3) < tinyDouble || std::abs(r3 - r0) < tinyDouble) {
+        return false;
+    }
+    // exact if the sides are radial, i.e., t0 = t3 and t1 = t2 
+    double r = sz2.norm();
+    double t = t3 + std::remainder(atan2(sz2(0), sz2(1)) - t3, 2. * pi);
+    RDCol2 xieta2;
+    xieta2(0) = 2. * (t - t3) / (t2 - t3) - 1.;
+    xieta2(1) = (2. * r - r3 - r0) / (r3 - r0);
+    // rotate back
+    xieta = Q2.transpose() * xieta2;
+    return true;
+}
 
@@ -0,0 +1,145 @@
+// Affinity.cpp
+// created by Kuangdai on 14-Oct-2026
+// thread pinning and transparent huge pages of hybrid runs
+
+#include "Affinity.h"
+#include "XOMP.h"
+#include <iomanip>
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <stdexcept>
+
+#ifdef __linux__
+    #include <sched.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+#endif
+
+std::string Affinity::sPolicy = "none";
+std::vector<std::vector<int>> Affinity::sThreadCpus;
+bool Affinity::sHugePages = false;
+
+namespace AffinityTopology {
+    // cpus allowed to this rank, which respects the binding by mpirun
+    std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+        #ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                    if (CPU_ISSET(cpu, &set)) {
+                        cpus.push_back(cpu);
+                    }
+                }
+            }
+        #endif
+        return cpus;
+    }
+    
+    // socket of a cpu, 0 if unknown
+    int socketOf(int cpu) {
+        std::ifstream fs("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + 
+            "/topology/physical_package_id");
+        int socket = 0;
+        if (!(fs >> socket)) {
+            socket = 0;
+        }
+        return socket;
+    }
+}
+
+void Affinity::bindThreads(const std::string &policy) {
+    sPolicy = policy;
+    sThreadCpus.clear();
+    if (boost::iequals(policy, "none")) {
+        return;
+    }
+    if (!boost::iequals(policy, "cores") && !boost::iequals(policy, "sockets")) {
+        throw std::runtime_error("Affinity::bindThreads || "
+            "Unknown thread affinity policy: " + policy + ".");
+    }
+    
+    // cpus of each thread
+    const std::vector<int> &cpus = AffinityTopology::allowedCpus();
+    int nthreads = XOMP::nThreads();
+    if (cpus.size() == 0) {
+        return;
+    }
+    sThreadCpus.resize(nthreads);
+    if (boost::iequals(policy, "cores")) {
+        for (int ithread = 0; ithread < nthreads; ithread++) {
+            sThreadCpus[ithread].push_back(cpus[ithread % cpus.size()]);
+        }
+    } else {
+        std::map<int, std::vector<int>> sockets;
+        for (int cpu: cpus) {
+            sockets[AffinityTopology::socketOf(cpu)].push_back(cpu);
+        }
+        int nsocket = sockets.size();
+        int isocket = 0;
+        for (const auto &it: sockets) {
+            // a contiguous block of threads on each socket
+            int start = (int)((long)nthreads * isocket / nsocket);
+            int end = (int)((long)nthreads * (isocket + 1) / nsocket);
+            for (int ithread = start; ithread < end; ithread++) {
+                sThreadCpus[ithread] = it.second;
+            }
+            isocket++;
+        }
+    }
+    
+    // pin
+    #if defined(__linux__) && defined(_USE_OPENMP)
+        int nfail = 0;
+        #pragma omp parallel num_threads(nthreads) reduction(+:nfail)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu: sThreadCpus[XOMP::threadID()]) {
+                CPU_SET(cpu, &set);
+            }
+            nfail += pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0;
+        }
+        if (nfail > 0) {
+            throw std::runtime_error("Affinity::bindThreads || "
+                "Error pinning threads to cpus, policy = " + policy + ".");
+        }
+    #endif
+}
+
+void Affinity::adviseHugePages(void *ptr, size_t bytes) {
+    if (!sHugePages) {
+        return;
+    }
+    #if defined(__linux__) && defined(MADV_HUGEPAGE)
+        // only the whole huge pages inside the range
+        size_t begin = (size_t)ptr;
+        size_t end = begin + bytes;
+        begin = (begin + sHugePageBytes - 1) / sHugePageBytes * sHugePageBytes;
+        end = end / sHugePageBytes * sHugePageBytes;
+        if (end > begin) {
+            // only a hint; the kernel may have THP disabled
+            madvise((void *)begin, end - begin, MADV_HUGEPAGE);
+        }
+    #endif
+}
+
+std::string Affinity::verbose() {
+    std::stringstream ss;
+    ss << "\n====================== Thread Affinity ======================" << std::endl;
+    ss << "  Policy                  =   " << sPolicy << std::endl;
+    ss << "  Huge Pages              =   " << (sHugePages ? "true" : "false") << std::endl;
+    for (int ithread = 0; ithread < sThreadCpus.size(); ithread++) {
+        ss << "  Thread " << std::setw(17) << std::left << ithread << "=   cpu";
+        for (int cpu: sThreadCpus[ithread]) {
+            ss << " " << cpu;
+        }
+        ss << std::endl;
+    }
+    ss << "====================== Thread Affinity ======================\n" << std::endl;
+    return ss.str();
+}
+
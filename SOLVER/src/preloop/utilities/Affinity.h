@@ -0,0 +1,38 @@
+// Affinity.h
+// created by Kuangdai on 14-Oct-2026
+// thread pinning and transparent huge pages of hybrid runs
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class Affinity {
+public:
+    // pin the openmp threads within the cpu set of this rank
+    // none    -- threads left to the operating system
+    // cores   -- thread t pinned to the t-th core of the set
+    // sockets -- threads distributed in blocks over the sockets of the
+    //            set, each free to move within its socket
+    static void bindThreads(const std::string &policy);
+    
+    // transparent huge pages for the large solver arrays
+    static void setHugePages(bool on) {sHugePages = on;};
+    static bool hugePages() {return sHugePages;};
+    
+    // advise the pages covering [ptr, ptr + bytes) to be huge
+    static void adviseHugePages(void *ptr, size_t bytes);
+    
+    // page size of the huge pages, used to align what is advised
+    static const size_t sHugePageBytes = 2 * 1024 * 1024;
+    
+    // binding of the threads of this rank
+    static std::string verbose();
+    
+private:
+    static std::string sPolicy;
+    static std::vector<std::vector<int>> sThreadCpus;
+    static bool sHugePages;
+};
+
@@ -3,11 +3,13 @@
 // geodetic tools
 
 #include "Geodesy.h"
+#include <algorithm>
 
 double Geodesy::sFlattening = 0.;
 double Geodesy::sROuter = 6371e3;
 RDColX Geodesy::sEllipKnots = RDColX::Zero(0);
 RDColX Geodesy::sEllipCoeffs = RDColX::Zero(0);
+std::vector<int> Geodesy::sEllipCells;
 
 
 void Geodesy::rtheta(const RDCol2 &sz, double &r, double &theta) {
@@ -125,41 +127,138 @@ double Geodesy::phi2Lon(double phi) {
 }
 
 RDCol3 Geodesy::rotateSrc2Glob(const RDCol3 &rtpS, double srclat, double srclon, double srcdep) {
-    const RDCol3 &xyzS = toCartesian(rtpS);
-    const RDCol3 &xyzG = rotationMatrix(lat2Theta_d(srclat, srcdep), lon2Phi(srclon)) * xyzS;
+    return SourceRotation(srclat, srclon, srcdep).src2Glob(rtpS);
+}
+
+RDCol3 Geodesy::rotateGlob2Src(const RDCol3 &rtpG, double srclat, double srclon, double srcdep) {
+    return SourceRotation(srclat, srclon, srcdep).glob2Src(rtpG);
+}
+
+double Geodesy::backAzimuth(double srclat, double srclon, double srcdep,
+    double reclat, double reclon, double recdep) {
+    return SourceRotation(srclat, srclon, srcdep).backAzimuth(
+        lat2Theta_d(reclat, recdep), lon2Phi(reclon));
+}
+
+void Geodesy::setup(double router, double flattening, 
+                     const RDColX &ellip_knots, 
+                     const RDColX &ellip_coeffs) {
+    sROuter = router;
+    sFlattening = flattening;
+    sEllipKnots = ellip_knots;
+    sEllipCoeffs = ellip_coeffs;
+    
+    // knot intervals of uniform cells
+    sEllipCells.clear();
+    int nknots = sEllipKnots.size();
+    if (nknots < 2) {
+        return;
+    }
+    double k0 = sEllipKnots(0);
+    double width = (sEllipKnots(nknots - 1) - k0) / sNumEllipCells;
+    int i = 1;
+    for (int icell = 0; icell < sNumEllipCells; icell++) {
+        double low = k0 + icell * width;
+        while (i < nknots - 1 && sEllipKnots(i) < low) {
+            i++;
+        }
+        sEllipCells.push_back(i);
+    }
+}
+
+double Geodesy::getFlattening(double r) {
+    // first knot interval that holds r, 1 above the last knot
+    double r_ref = r / sROuter;
+    int nknots = sEllipKnots.size();
+    if (nknots < 2 || r_ref > sEllipKnots(nknots - 1)) {
+        return sFlattening;
+    }
+    double k0 = sEllipKnots(0);
+    double span = sEllipKnots(nknots - 1) - k0;
+    int icell = span > 0. ? (int)((r_ref - k0) / span * sNumEllipCells) : 0;
+    icell = std::max(0, std::min(icell, sNumEllipCells - 1));
+    int i = sEllipCells[icell];
+    // rounding at a cell boundary
+    while (i > 1 && r_ref <= sEllipKnots(i - 1)) {
+        i--;
+    }
+    while (r_ref > sEllipKnots(i)) {
+        i++;
+    }
+    double f = (sEllipCoeffs(i) - sEllipCoeffs(i - 1)) 
+        / (sEllipKnots(i) - sEllipKnots(i - 1))
+        * (r_ref - sEllipKnots(i - 1)) 
+        + sEllipCoeffs(i - 1);
+    return f * sFlattening;
+}
+
+//////////////////////////// SourceRotation ////////////////////////////
+SourceRotation::SourceRotation(double srclat, double srclon, double srcdep) {
+    double srcTheta = Geodesy::lat2Theta_d(srclat, srcdep);
+    double srcPhi = Geodesy::lon2Phi(srclon);
+    mQ = Geodesy::rotationMatrix(srcTheta, srcPhi);
+    // event terms of the back azimuth
+    double d = sin(srcPhi);
+    double e = -cos(srcPhi);
+    double f = -sin(srcTheta);
+    mA = f * e;
+    mB = -f * d;
+    mC = cos(srcTheta);
+}
+
+RDCol3 SourceRotation::src2Glob(const RDCol3 &rtpS) const {
     bool defined = true;
-    RDCol3 rtpG = toSpherical(xyzG, defined);
+    RDCol3 rtpG = Geodesy::toSpherical(mQ * Geodesy::toCartesian(rtpS), defined);
     if (!defined) {
         rtpG(2) = rtpS(2);
     }
     return rtpG;
 }
 
-RDCol3 Geodesy::rotateGlob2Src(const RDCol3 &rtpG, double srclat, double srclon, double srcdep) {
-    const RDCol3 &xyzG = toCartesian(rtpG);
-    const RDCol3 &xyzS = rotationMatrix(lat2Theta_d(srclat, srcdep), lon2Phi(srclon)).transpose() * xyzG;
+RDCol3 SourceRotation::glob2Src(const RDCol3 &rtpG) const {
     bool defined = true;
-    RDCol3 rtpS = toSpherical(xyzS, defined);
+    RDCol3 rtpS = Geodesy::toSpherical(mQ.transpose() * Geodesy::toCartesian(rtpG), defined);
     if (!defined) {
         rtpS(2) = rtpG(2);
     }
     return rtpS;
 }
 
-double Geodesy::backAzimuth(double srclat, double srclon, double srcdep,
-    double reclat, double reclon, double recdep) {    
-    // event
-    double srcTheta = lat2Theta_d(srclat, srcdep);
-    double srcPhi = lon2Phi(srclon);
-    double d = sin(srcPhi);
-    double e = -cos(srcPhi);
-    double f = -sin(srcTheta);
-    double c = cos(srcTheta);
-    double a = f * e;
-    double b = -f * d;
-    // station
-    double recTheta = lat2Theta_d(reclat, recdep);
-    double recPhi = lon2Phi(reclon);
+void SourceRotation::toCartesian(const RDMatX3 &rtp, RDMatX3 &xyz) {
+    const RDColX &rsint = rtp.col(0).array() * rtp.col(1).array().sin();
+    xyz.resize(rtp.rows(), 3);
+    xyz.col(0) = rsint.array() * rtp.col(2).array().cos();
+    xyz.col(1) = rsint.array() * rtp.col(2).array().sin();
+    xyz.col(2) = rtp.col(0).array() * rtp.col(1).array().cos();
+}
+
+void SourceRotation::toSpherical(const RDMatX3 &xyz, RDMatX3 &rtp) {
+    // phi of rtp is kept where undefined
+    for (int i = 0; i < xyz.rows(); i++) {
+        bool defined = true;
+        const RDCol3 &rtpi = Geodesy::toSpherical(xyz.row(i).transpose(), defined);
+        rtp(i, 0) = rtpi(0);
+        rtp(i, 1) = rtpi(1);
+        if (defined) {
+            rtp(i, 2) = rtpi(2);
+        }
+    }
+}
+
+void SourceRotation::src2Glob(RDMatX3 &rtp) const {
+    RDMatX3 xyz;
+    toCartesian(rtp, xyz);
+    // rows are points: (Q * x)^T = x^T * Q^T
+    toSpherical(xyz * mQ.transpose(), rtp);
+}
+
+void SourceRotation::glob2Src(RDMatX3 &rtp) const {
+    RDMatX3 xyz;
+    toCartesian(rtp, xyz);
+    toSpherical(xyz * mQ, rtp);
+}
+
+double SourceRotation::backAzimuth(double recTheta, double recPhi) const {
     double d1 = sin(recPhi);
     double e1 = -cos(recPhi);
     double f1 = -sin(recTheta);
@@ -167,34 +266,16 @@ double Geodesy::backAzimuth(double srclat, double srclon, double srcdep,
     double g1 = -c1 * e1;
     double h1 = c1 * d1;
     // baz
-    double ss = (a - d1) * (a - d1) + (b - e1) * (b - e1) + c * c - 2.;
-    double sc = (a - g1) * (a - g1) + (b - h1) * (b - h1) + (c - f1) * (c - f1) - 2.;
+    double ss = (mA - d1) * (mA - d1) + (mB - e1) * (mB - e1) + mC * mC - 2.;
+    double sc = (mA - g1) * (mA - g1) + (mB - h1) * (mB - h1) + (mC - f1) * (mC - f1) - 2.;
     bool defined; // useless
-    return atan4(ss, sc, defined);
-}
-
-void Geodesy::setup(double router, double flattening, 
-                     const RDColX &ellip_knots, 
-                     const RDColX &ellip_coeffs) {
-    sROuter = router;
-    sFlattening = flattening;
-    sEllipKnots = ellip_knots;
-    sEllipCoeffs = ellip_coeffs;
+    return Geodesy::atan4(ss, sc, defined);
 }
 
-double Geodesy::getFlattening(double r) {
-    double f = 1.;
-    double r_ref = r / sROuter;
-    int nknots = sEllipKnots.size();
-    for (int i = 1; i < nknots; i++) {
-        if (r_ref <= sEllipKnots(i)) {
-            f = (sEllipCoeffs(i) - sEllipCoeffs(i - 1)) 
-                / (sEllipKnots(i) - sEllipKnots(i - 1))
-                * (r_ref - sEllipKnots(i - 1)) 
-                + sEllipCoeffs(i - 1);
-            break;
-        }
+RDColX SourceRotation::backAzimuth(const RDColX &recTheta, const RDColX &recPhi) const {
+    RDColX baz(recTheta.size());
+    for (int i = 0; i < recTheta.size(); i++) {
+        baz(i) = backAzimuth(recTheta(i), recPhi(i));
     }
-    return f * sFlattening;
+    return baz;
 }
-
@@ -2,6 +2,8 @@
 // created by Kuangdai on 15-May-2017 
 // geodetic tools
 
+#pragma once
+
 #include "eigenp.h"
 
 class Geodesy {
@@ -45,13 +47,15 @@ public:
     static double backAzimuth(double srclat, double srclon, double srcdep,
                               double reclat, double reclon, double recdep);
                               
+                              
     
     // setup
     static void setup(double router, double flattening, 
         const RDColX &ellip_knots, 
         const RDColX &ellip_coeffs);
         
-    // compute flattening at a radius
+    // compute flattening at a radius, O(1) through a uniform table
+    // of the knot intervals
     static double getFlattening(double r);
     
     // get
@@ -63,7 +67,36 @@ private:
     static double sFlattening;
     static RDColX sEllipKnots;
     static RDColX sEllipCoeffs;
+    // first knot at or above each uniform cell over the knots 
+    static std::vector<int> sEllipCells;
+    static const int sNumEllipCells = 4096;
 };
 
-
-
+// rotation between the globe and the frame centred at a source, formed 
+// once for all the points transformed with it
+class SourceRotation {
+public:
+    SourceRotation(double srclat, double srclon, double srcdep);
+    
+    // source-centered to globe and back
+    RDCol3 src2Glob(const RDCol3 &rtpS) const;
+    RDCol3 glob2Src(const RDCol3 &rtpG) const;
+    
+    // many points at once, one per row of rtp, rotated in place
+    void src2Glob(RDMatX3 &rtp) const;
+    void glob2Src(RDMatX3 &rtp) const;
+    
+    // back azimuth of a station by its geocentric theta and phi
+    double backAzimuth(double recTheta, double recPhi) const;
+    RDColX backAzimuth(const RDColX &recTheta, const RDColX &recPhi) const;
+    
+private:
+    // (r, theta, phi) of the rows of xyz, phi kept from fallback on the axis
+    static void toSpherical(const RDMatX3 &xyz, RDMatX3 &rtp);
+    static void toCartesian(const RDMatX3 &rtp, RDMatX3 &xyz);
+    
+    // source-centered Cartesian to global Cartesian
+    RDMat33 mQ;
+    // terms of the source in the back azimuth
+    double mA, mB, mC;
+};
@@ -0,0 +1,161 @@
+// HaloAggregator.cpp
+// created by Kuangdai on 14-Oct-2026
+// halo exchange between nodes, one message per node pair through the node leaders
+
+#include "HaloAggregator.h"
+#include "XMPI.h"
+#include <algorithm>
+#include <array>
+#include <map>
+
+HaloAggregator::HaloAggregator(const std::vector<int> &procs, const std::vector<int> &sizes):
+mAggregated(procs.size(), false), 
+mSendRegion(procs.size(), 0), mRecvRegion(procs.size(), 0) {
+    #ifndef _SERIAL_BUILD
+        // node of each rank, identified by its lowest world rank
+        MPI_Comm_split_type(XMPI::comm(), MPI_COMM_TYPE_SHARED, XMPI::rank(), 
+            MPI_INFO_NULL, &mNodeComm);
+        int nodeRank = 0;
+        MPI_Comm_rank(mNodeComm, &nodeRank);
+        mLeader = (nodeRank == 0);
+        int myNode = XMPI::rank();
+        MPI_Bcast(&myNode, 1, MPI_INT, 0, mNodeComm);
+        std::vector<int> nodeOf;
+        XMPI::gather(myNode, nodeOf, true);
+        
+        // exchanges of this rank with other nodes: src, dst, size
+        int nproc = procs.size();
+        std::vector<int> mine;
+        for (int i = 0; i < nproc; i++) {
+            if (nodeOf[procs[i]] != myNode) {
+                mAggregated[i] = true;
+                mine.push_back(XMPI::rank());
+                mine.push_back(procs[i]);
+                mine.push_back(sizes[i]);
+            }
+        }
+        
+        // exchanges of the whole node
+        int nodeSize = 0;
+        MPI_Comm_size(mNodeComm, &nodeSize);
+        int count = mine.size();
+        std::vector<int> counts(nodeSize), displs(nodeSize, 0);
+        MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, mNodeComm);
+        for (int i = 1; i < nodeSize; i++) {
+            displs[i] = displs[i - 1] + counts[i - 1];
+        }
+        std::vector<int> all(displs[nodeSize - 1] + counts[nodeSize - 1]);
+        MPI_Allgatherv(mine.data(), count, MPI_INT, 
+            all.data(), counts.data(), displs.data(), MPI_INT, mNodeComm);
+        
+        // outgoing buffer by (remote node, src, dst), incoming buffer by 
+        // (remote node, remote src, local dst); a node pair then sees 
+        // the same layout on both sides
+        std::vector<std::array<int, 4>> out, in;
+        for (int k = 0; k < all.size(); k += 3) {
+            int local = all[k];
+            int remote = all[k + 1];
+            int size = all[k + 2];
+            out.push_back({nodeOf[remote], local, remote, size});
+            in.push_back({nodeOf[remote], remote, local, size});
+        }
+        std::sort(out.begin(), out.end());
+        std::sort(in.begin(), in.end());
+        
+        // offsets, and segments of the remote nodes
+        std::map<std::array<int, 2>, MPI_Aint> offsetOut, offsetIn;
+        std::map<int, std::array<MPI_Aint, 2>> segmentOut, segmentIn;
+        MPI_Aint total = 0;
+        for (const auto &t: out) {
+            offsetOut[{t[1], t[2]}] = total;
+            if (segmentOut.find(t[0]) == segmentOut.end()) {
+                segmentOut[t[0]] = {total, 0};
+            }
+            total += t[3];
+            segmentOut[t[0]][1] = total;
+        }
+        for (const auto &t: in) {
+            offsetIn[{t[1], t[2]}] = total;
+            if (segmentIn.find(t[0]) == segmentIn.end()) {
+                segmentIn[t[0]] = {total, 0};
+            }
+            total += t[3];
+            segmentIn[t[0]][1] = total;
+        }
+        
+        // the buffers live on the leader
+        Complex *base = 0;
+        MPI_Win_allocate_shared((mLeader ? total : 0) * sizeof(Complex), sizeof(Complex), 
+            MPI_INFO_NULL, mNodeComm, &base, &mWindow);
+        mBytes = (mLeader ? total : 0) * sizeof(Complex);
+        MPI_Aint bytes;
+        int dispUnit;
+        MPI_Win_shared_query(mWindow, 0, &bytes, &dispUnit, &base);
+        for (int i = 0; i < nproc; i++) {
+            if (mAggregated[i]) {
+                mSendRegion[i] = base + offsetOut.at({XMPI::rank(), procs[i]});
+                mRecvRegion[i] = base + offsetIn.at({procs[i], XMPI::rank()});
+            }
+        }
+        
+        // persistent messages between leaders, tagged apart from the halo
+        if (mLeader) {
+            #ifdef _USE_DOUBLE
+                MPI_Datatype type = MPI_C_DOUBLE_COMPLEX;
+            #else
+                MPI_Datatype type = MPI_C_FLOAT_COMPLEX;
+            #endif
+            int tagBase = XMPI::nproc();
+            for (auto it = segmentOut.begin(); it != segmentOut.end(); it++) {
+                mRequests.push_back(MPI_Request());
+                MPI_Send_init(base + it->second[0], it->second[1] - it->second[0], type, 
+                    it->first, tagBase + it->first, XMPI::comm(), &mRequests.back());
+            }
+            for (auto it = segmentIn.begin(); it != segmentIn.end(); it++) {
+                mRequests.push_back(MPI_Request());
+                MPI_Recv_init(base + it->second[0], it->second[1] - it->second[0], type, 
+                    it->first, tagBase + XMPI::rank(), XMPI::comm(), &mRequests.back());
+            }
+        }
+        
+        // passive target epoch for the whole run
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, mWindow);
+    #endif
+}
+
+HaloAggregator::~HaloAggregator() {
+    #ifndef _SERIAL_BUILD
+        XMPI::free_all(mRequests.size(), mRequests.data());
+        MPI_Win_unlock_all(mWindow);
+        MPI_Win_free(&mWindow);
+        MPI_Comm_free(&mNodeComm);
+    #endif
+}
+
+void HaloAggregator::post() {
+    #ifndef _SERIAL_BUILD
+        // the leader sends once the whole node has packed; 
+        // the others return to computing
+        MPI_Win_sync(mWindow);
+        MPI_Ibarrier(mNodeComm, &mPacked);
+        if (mLeader) {
+            MPI_Wait(&mPacked, MPI_STATUS_IGNORE);
+            MPI_Win_sync(mWindow);
+            XMPI::start_all(mRequests.size(), mRequests.data());
+        }
+    #endif
+}
+
+void HaloAggregator::wait() {
+    #ifndef _SERIAL_BUILD
+        if (mLeader) {
+            XMPI::wait_all(mRequests.size(), mRequests.data());
+            MPI_Win_sync(mWindow);
+        } else {
+            MPI_Wait(&mPacked, MPI_STATUS_IGNORE);
+        }
+        // incoming buffer complete, and outgoing buffer free to be packed again
+        MPI_Barrier(mNodeComm);
+        MPI_Win_sync(mWindow);
+    #endif
+}
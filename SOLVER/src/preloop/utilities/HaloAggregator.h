@@ -0,0 +1,50 @@
+// HaloAggregator.h
+// created by Kuangdai on 14-Oct-2026
+// halo exchange between nodes, one message per node pair through the node leaders
+
+#pragma once
+
+#include "eigenc.h"
+#include <vector>
+#ifndef _SERIAL_BUILD
+    #include "mpi.h"
+#endif
+
+class HaloAggregator {
+public:
+    // procs: neighbours in the communicator of XMPI
+    // sizes: values exchanged with each neighbour, equal on both sides
+    // collective over the communicator of XMPI
+    HaloAggregator(const std::vector<int> &procs, const std::vector<int> &sizes);
+    ~HaloAggregator();
+    
+    // neighbour on another node
+    bool aggregated(int i) const {return mAggregated[i];};
+    
+    // regions of neighbour i in the outgoing and incoming node buffers
+    Complex *send(int i) const {return mSendRegion[i];};
+    const Complex *recv(int i) const {return mRecvRegion[i];};
+    
+    // an exchange: pack into send(), post(), wait(), read from recv();
+    // every rank on the node must take part, with or without such neighbours
+    void post();
+    void wait();
+    
+    // bytes of the window allocated by this rank, the node buffers on the leader
+    size_t memoryBytes() const {return mBytes;};
+    
+private:
+    std::vector<bool> mAggregated;
+    std::vector<Complex *> mSendRegion;
+    std::vector<const Complex *> mRecvRegion;
+    size_t mBytes = 0;
+    
+    #ifndef _SERIAL_BUILD
+        MPI_Comm mNodeComm;
+        MPI_Win mWindow;
+        MPI_Request mPacked;
+        bool mLeader = false;
+        // one send and one recv per remote node, on the leader only
+        std::vector<MPI_Request> mRequests;
+    #endif
+};
@@ -0,0 +1,124 @@
+// InputBundle.cpp
+// created by Kuangdai on 14-Oct-2026
+// small input files read by root and broadcast in one message at startup
+
+#include "InputBundle.h"
+#include "Parameters.h"
+#include "XMPI.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+std::map<std::string, std::string> InputBundle::sFiles;
+const size_t InputBundle::sMaxFileBytes = 1 << 20;
+const size_t InputBundle::sMaxBundleBytes = 16 << 20;
+
+void InputBundle::initialize() {
+    sFiles.clear();
+    // packed: for each file, lengths of name and content, name, content
+    std::vector<char> packed;
+    if (XMPI::root()) {
+        // regular files by name, so that the bundle is the same for all runs
+        std::vector<std::string> names;
+        DIR *dir = opendir(Parameters::sInputDirectory.c_str());
+        if (dir) {
+            struct dirent *entry;
+            while ((entry = readdir(dir)) != NULL) {
+                names.push_back(entry->d_name);
+            }
+            closedir(dir);
+        }
+        std::sort(names.begin(), names.end());
+        size_t total = 0;
+        for (const std::string &name: names) {
+            const std::string &fname = Parameters::sInputDirectory + "/" + name;
+            struct stat info;
+            if (stat(fname.c_str(), &info) != 0 || !S_ISREG(info.st_mode) ||
+                (size_t)info.st_size > sMaxFileBytes ||
+                total + info.st_size > sMaxBundleBytes) {
+                continue;
+            }
+            std::ifstream fs(fname, std::ios::binary);
+            if (!fs) {
+                continue;
+            }
+            std::stringstream buffer;
+            buffer << fs.rdbuf();
+            const std::string &content = buffer.str();
+            total += content.size();
+            size_t len[2] = {fname.size(), content.size()};
+            size_t pos = packed.size();
+            packed.resize(pos + sizeof(len) + len[0] + len[1]);
+            memcpy(packed.data() + pos, len, sizeof(len));
+            memcpy(packed.data() + pos + sizeof(len), fname.data(), len[0]);
+            memcpy(packed.data() + pos + sizeof(len) + len[0], content.data(), len[1]);
+        }
+    }
+    XMPI::bcast(packed);
+    
+    // unpack
+    size_t pos = 0;
+    while (pos < packed.size()) {
+        size_t len[2];
+        memcpy(len, packed.data() + pos, sizeof(len));
+        pos += sizeof(len);
+        std::string fname(packed.data() + pos, len[0]);
+        pos += len[0];
+        sFiles[fname] = std::string(packed.data() + pos, len[1]);
+        pos += len[1];
+    }
+}
+
+void InputBundle::finalize() {
+    sFiles.clear();
+}
+
+bool InputBundle::readLines(const std::string &fname, std::vector<std::string> &lines) {
+    lines.clear();
+    auto it = sFiles.find(fname);
+    if (it != sFiles.end()) {
+        splitLines(it->second, lines);
+        return true;
+    }
+    
+    // not in the bundle, e.g., too large or outside the input directory
+    int opened = 1;
+    if (XMPI::root()) {
+        std::ifstream fs(fname);
+        if (fs) {
+            std::string line;
+            while (getline(fs, line)) {
+                lines.push_back(line);
+            }
+        } else {
+            opened = 0;
+        }
+    }
+    XMPI::bcast(opened);
+    if (!opened) {
+        return false;
+    }
+    XMPI::bcast(lines);
+    return true;
+}
+
+size_t InputBundle::numBytes() {
+    size_t bytes = 0;
+    for (auto it = sFiles.begin(); it != sFiles.end(); it++) {
+        bytes += it->first.size() + it->second.size();
+    }
+    return bytes;
+}
+
+void InputBundle::splitLines(const std::string &content, std::vector<std::string> &lines) {
+    // the same lines as getline on the file
+    std::istringstream ss(content);
+    std::string line;
+    while (getline(ss, line)) {
+        lines.push_back(line);
+    }
+}
+
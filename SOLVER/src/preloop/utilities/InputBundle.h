@@ -0,0 +1,44 @@
+// InputBundle.h
+// created by Kuangdai on 14-Oct-2026
+// small input files read by root and broadcast in one message at startup
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+
+class InputBundle {
+public:
+    // read the regular files in the input directory on root, each up to
+    // sMaxFileBytes and all up to sMaxBundleBytes, and broadcast them
+    // in one packed message; collective
+    static void initialize();
+    
+    // free the bundle once the preloop has read its input
+    static void finalize();
+    
+    // lines of a file by its full path, from the bundle, or read by root
+    // and broadcast if it is not in the bundle; collective
+    // false on all processors if the file cannot be opened
+    static bool readLines(const std::string &fname, std::vector<std::string> &lines);
+    
+    // whether a file is in the bundle
+    static bool contains(const std::string &fname) {
+        return sFiles.find(fname) != sFiles.end();
+    };
+    
+    // numbers of files and bytes in the bundle
+    static int numFiles() {return sFiles.size();};
+    static size_t numBytes();
+
+private:
+    static void splitLines(const std::string &content, std::vector<std::string> &lines);
+    
+    // full path => content
+    static std::map<std::string, std::string> sFiles;
+    
+    static const size_t sMaxFileBytes;
+    static const size_t sMaxBundleBytes;
+};
+
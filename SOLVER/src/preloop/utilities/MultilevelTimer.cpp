@@ -4,6 +4,7 @@
 
 #include "MultilevelTimer.h"
 #include "XMPI.h"
+#include "Timeline.h"
 
 std::string MultilevelTimer::mFileName;
 std::fstream MultilevelTimer::mFile;
@@ -38,12 +39,13 @@ void MultilevelTimer::finalize() {
 }
 
 void MultilevelTimer::begin(const std::string &name, int level, bool barrier) {
+    if (mEnabled && barrier) {
+        XMPI::barrier();
+    }
+    Timeline::begin(name);
     if (!mEnabled) {
         return;
     }
-    if (barrier) {
-        XMPI::barrier();
-    }
     if (XMPI::root()) {
         for (int i = 0; i < level; i++) {
             mFile << "    ";
@@ -54,6 +56,8 @@ void MultilevelTimer::begin(const std::string &name, int level, bool barrier) {
 }
 
 void MultilevelTimer::end(const std::string &name, int level, bool barrier) {
+    // before the barrier, showing the ranks that wait
+    Timeline::end(name);
     if (!mEnabled) {
         return;
     }
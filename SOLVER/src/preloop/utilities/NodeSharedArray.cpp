@@ -0,0 +1,70 @@
+// NodeSharedArray.cpp
+// created by Kuangdai on 14-Oct-2026
+// read-only matrix held once per node in an MPI-3 shared window
+
+#include "NodeSharedArray.h"
+#include "XMPI.h"
+#include <algorithm>
+
+namespace NodeSharedArrayChunk {
+    // elements per broadcast, within the int count of MPI
+    const size_t sChunk = 1 << 28;
+}
+
+void NodeSharedArray::shareRaw(const double *data, int rows, int cols, bool fromRoot) {
+    free();
+    if (fromRoot) {
+        XMPI::bcast(rows);
+        XMPI::bcast(cols);
+    }
+    mRows = rows;
+    mCols = cols;
+    size_t size = (size_t)rows * cols;
+    
+    #ifndef _SERIAL_BUILD
+        // the leader of the node owns the whole segment
+        MPI_Comm nodeComm = XMPI::nodeComm();
+        int nodeRank = 0;
+        MPI_Comm_rank(nodeComm, &nodeRank);
+        bool leader = (nodeRank == 0);
+        double *base = 0;
+        MPI_Win_allocate_shared(leader ? size * sizeof(double) : 0, sizeof(double), 
+            MPI_INFO_NULL, nodeComm, &base, &mWindow);
+        MPI_Aint bytes = 0;
+        int dispUnit = 0;
+        double *leaderBase = 0;
+        MPI_Win_shared_query(mWindow, 0, &bytes, &dispUnit, &leaderBase);
+        
+        // filled by the leader only
+        MPI_Win_fence(0, mWindow);
+        if (leader) {
+            if (!fromRoot || XMPI::root()) {
+                std::copy(data, data + size, leaderBase);
+            }
+            if (fromRoot) {
+                for (size_t start = 0; start < size; start += NodeSharedArrayChunk::sChunk) {
+                    int count = std::min(NodeSharedArrayChunk::sChunk, size - start);
+                    MPI_Bcast(leaderBase + start, count, MPI_DOUBLE, 0, XMPI::leaderComm());
+                }
+            }
+        }
+        MPI_Win_fence(0, mWindow);
+        mData = leaderBase;
+    #else
+        mLocal.assign(data, data + size);
+        mData = mLocal.data();
+    #endif
+}
+
+void NodeSharedArray::free() {
+    #ifndef _SERIAL_BUILD
+        if (mWindow != MPI_WIN_NULL) {
+            MPI_Win_free(&mWindow);
+        }
+    #else
+        std::vector<double>().swap(mLocal);
+    #endif
+    mData = 0;
+    mRows = mCols = 0;
+}
+
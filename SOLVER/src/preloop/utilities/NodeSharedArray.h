@@ -0,0 +1,55 @@
+// NodeSharedArray.h
+// created by Kuangdai on 14-Oct-2026
+// read-only matrix held once per node in an MPI-3 shared window
+
+#pragma once
+
+#include "eigenp.h"
+#include <vector>
+#ifndef _SERIAL_BUILD
+    #include "mpi.h"
+#endif
+
+class NodeSharedArray {
+public:
+    NodeSharedArray() {};
+    ~NodeSharedArray() {free();};
+    
+    // the window must be freed collectively and only once
+    NodeSharedArray(const NodeSharedArray &) = delete;
+    NodeSharedArray &operator=(const NodeSharedArray &) = delete;
+    
+    // collective over the communicator of XMPI, replacing any shared data
+    // fromRoot: mat is only needed on root and is broadcast through the 
+    // node leaders; otherwise all ranks hold the same mat and each leader 
+    // copies its own
+    template<typename TEigen>
+    void share(const TEigen &mat, bool fromRoot) {
+        shareRaw(mat.data(), mat.rows(), mat.cols(), fromRoot);
+    };
+    
+    // release the window, collective over the communicator of XMPI
+    void free();
+    
+    // read-only access, column-major as the shared matrix
+    const double *data() const {return mData;};
+    int rows() const {return mRows;};
+    int cols() const {return mCols;};
+    Eigen::Map<const RDMatXX> matrix() const {
+        return Eigen::Map<const RDMatXX>(mData, mRows, mCols);
+    };
+    
+private:
+    void shareRaw(const double *data, int rows, int cols, bool fromRoot);
+    
+    const double *mData = 0;
+    int mRows = 0;
+    int mCols = 0;
+    
+    #ifndef _SERIAL_BUILD
+        MPI_Win mWindow = MPI_WIN_NULL;
+    #else
+        std::vector<double> mLocal;
+    #endif
+};
+
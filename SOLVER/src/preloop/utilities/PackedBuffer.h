@@ -0,0 +1,72 @@
+// PackedBuffer.h
+// created by Kuangdai on 14-Oct-2026
+// flat buffer of doubles to migrate preloop objects between ranks
+
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include <cstddef>
+
+class PackedBuffer {
+public:
+    // packing into an empty buffer
+    PackedBuffer(): mPacking(true) {};
+    // unpacking size doubles starting at data
+    PackedBuffer(const double *data, size_t size):
+    mPacking(false), mData(data), mSize(size) {};
+
+    bool packing() const {return mPacking;};
+    const std::vector<double> &getPacked() const {return mPacked;};
+
+    // integers and bools are exact as doubles
+    template<typename T>
+    void syncValue(T &value) {
+        if (mPacking) {
+            mPacked.push_back((double)value);
+        } else {
+            value = (T)next();
+        }
+    };
+
+    // Eigen::Matrix of doubles, resized when unpacking
+    template<typename TEigen>
+    void syncEigen(TEigen &mat) {
+        int rows = mat.rows();
+        int cols = mat.cols();
+        syncValue(rows);
+        syncValue(cols);
+        if (mPacking) {
+            mPacked.insert(mPacked.end(), mat.data(), mat.data() + mat.size());
+        } else {
+            mat.resize(rows, cols);
+            for (int i = 0; i < mat.size(); i++) {
+                mat.data()[i] = next();
+            }
+        }
+    };
+
+    // std::array of Eigen::Matrix
+    template<typename TArray>
+    void syncEigenArray(TArray &arr) {
+        for (auto &mat: arr) {
+            syncEigen(mat);
+        }
+    };
+
+private:
+    double next() {
+        if (mPosition >= mSize) {
+            throw std::runtime_error("PackedBuffer::next || "
+                "Unpacking beyond the end of buffer.");
+        }
+        return mData[mPosition++];
+    };
+
+    bool mPacking;
+    std::vector<double> mPacked;
+    const double *mData = 0;
+    size_t mSize = 0;
+    size_t mPosition = 0;
+};
+
@@ -4,6 +4,8 @@
 
 #include "Parameters.h"
 #include "XMPI.h"
+#include "XOMP.h"
+#include "InputBundle.h"
 #include "global.h"
 #include <fstream>
 #include <sstream>
@@ -58,13 +60,22 @@ void Parameters::registerAll() {
     registerPar("NU_WISDOM_LEARN_EPSILON");
     registerPar("NU_WISDOM_LEARN_INTERVAL");
     registerPar("NU_WISDOM_LEARN_OUTPUT");
+    registerPar("NU_WISDOM_LEARN_SWITCH");
+    registerPar("NU_WISDOM_LEARN_WINDOWS");
+    registerPar("NU_WISDOM_LEARN_SAMPLING");
     registerPar("NU_WISDOM_REUSE_INPUT");
     registerPar("NU_WISDOM_REUSE_FACTOR");
+    registerPar("NU_WISDOM_REUSE_RASTER");
+    registerPar("NU_WISDOM_REUSE_WINDOWS");
+    registerPar("NU_ADAPTIVE_TOLERANCE");
+    registerPar("NU_QUANTIZATION_RATIO");
+    registerPar("NU_FORCE_ODD_NR");
     registerPar("NU_USER_PARAMETER_LIST");
     
     // inparam.time_src_recv
     registerPar("TIME_DELTA_T");
     registerPar("TIME_DELTA_T_FACTOR");
+    registerPar("TIME_SCHEME");
     registerPar("TIME_RECORD_LENGTH");
     registerPar("SOURCE_TYPE");
     registerPar("SOURCE_FILE");
@@ -77,18 +88,73 @@ void Parameters::registerAll() {
     registerPar("OUT_STATIONS_COMPONENTS");
     registerPar("OUT_STATIONS_RECORD_INTERVAL");
     registerPar("OUT_STATIONS_DUMP_INTERVAL");
+    registerPar("OUT_STATIONS_FLUSH_INTERVAL");
+    registerPar("OUT_STATIONS_DECIMATION");
+    registerPar("OUT_STATIONS_QUANTITY");
     registerPar("OUT_STATIONS_WHOLE_SURFACE");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_STRAIN");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_DEFLATE");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_PRECISION");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_NU_CUTOFF");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_VTK");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_VTK_INTERVAL");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_GROUND_MOTION");
+    registerPar("OUT_STATIONS_WHOLE_SURFACE_TIME_SERIES");
     registerPar("OUT_STATIONS_DEPTH_REF");
+    registerPar("OUT_VOLUME");
+    registerPar("OUT_VOLUME_RECORD_INTERVAL");
+    registerPar("OUT_VOLUME_GLL_STRIDE");
+    registerPar("OUT_VOLUME_STRAIN");
+    registerPar("OUT_VOLUME_DEFLATE");
+    registerPar("OUT_VOLUME_PRECISION");
+    registerPar("OUT_VOLUME_MEMORY_MB");
+    registerPar("KERNEL_ADJOINT_SOURCE_FILE");
+    registerPar("KERNEL_SEGMENT_STEPS");
+    registerPar("KERNEL_SAMPLE_INTERVAL");
     
     // inparam.advanced
+    registerPar("MODEL_3D_DEMOTE_TOLERANCE");
+    registerPar("MODEL_3D_DEMOTE_TOLERANCE_UNDULATION");
+    registerPar("MODEL_3D_FOURIER_ORDER");
+    registerPar("MODEL_3D_FOURIER_TOLERANCE");
     registerPar("ATTENUATION_CG4");
     registerPar("ATTENUATION_SPECFEM_LEGACY");
     registerPar("ATTENUATION_QKAPPA");
+    registerPar("ATTENUATION_SKIP_TOLERANCE");
     registerPar("DD_PROC_INTERVAL");
     registerPar("DD_NCUTS_PER_PROC");
+    registerPar("DD_CACHE_WEIGHTS");
+    registerPar("DD_COST_MODEL");
+    registerPar("DD_ESTIMATE_COSTS");
+    registerPar("DD_SAMPLED_MEASURE");
+    registerPar("DD_REORDER_RANKS");
+    registerPar("DD_LOCAL_HILBERT_ORDER");
+    registerPar("DD_SHARED_MEMORY_HALO");
+    registerPar("DD_HIERARCHICAL");
+    registerPar("DD_AGGREGATE_HALO");
+    registerPar("DD_HALO_TRIM_MODES");
+    registerPar("DD_HALO_TRIM_TOLERANCE");
+    registerPar("DD_REBALANCE_INTERVAL");
+    registerPar("DD_REBALANCE_THRESHOLD");
+    registerPar("DD_IMBALANCE_INTERVAL");
     registerPar("OPTION_VERBOSE_LEVEL");
     registerPar("OPTION_STABILITY_INTERVAL");
     registerPar("OPTION_LOOP_INFO_INTERVAL");
+    registerPar("OPTION_TELEMETRY_INTERVAL");
+    registerPar("OPTION_LOOP_TIMERS");
+    registerPar("OPTION_PERF_COUNTERS");
+    registerPar("OPTION_TIMELINE_INTERVAL");
+    registerPar("OPTION_MEMORY_BUDGET_MB");
+    registerPar("OPTION_MEMORY_DRY_RUN");
+    registerPar("OPTION_LUMPED_STIFFNESS_MB");
+    registerPar("OPTION_PLAN_RUN");
+    registerPar("OPTION_CHECKPOINT_INTERVAL");
+    registerPar("OPTION_CHECKPOINT_RESTART");
+    registerPar("OPTION_CACHE_EXODUS");
+    registerPar("OPTION_NPOL");
+    registerPar("BOX_INJECTION_MODE");
+    registerPar("BOX_INJECTION_REGION");
+    registerPar("BOX_INJECTION_BUFFER_SIZE");
     registerPar("DEVELOP_MAX_TIME_STEPS");
     registerPar("DEVELOP_NON_SOURCE_MODE");
     registerPar("DEVELOP_DIAGNOSE_PRELOOP");
@@ -96,6 +162,14 @@ void Parameters::registerAll() {
     registerPar("DEVELOP_RANDOMIZE_DISP0");
     registerPar("FFTW_LUCKY_NUMBER");
     registerPar("FFTW_DISABLE_WISDOM");
+    registerPar("FFTW_SHARED_WISDOM");
+    registerPar("FFTW_NUM_THREADS");
+    registerPar("FFTW_THREADS_NR_THRESHOLD");
+    registerPar("OMP_THREAD_AFFINITY");
+    registerPar("OMP_FIRST_TOUCH");
+    registerPar("OMP_HUGE_PAGES");
+    registerPar("NETCDF_CHUNK_TIME_STEPS");
+    registerPar("NETCDF_IO_AGGREGATORS");
     
 }
 
@@ -118,19 +192,10 @@ void Parameters::registerPar(const std::string &key) {
 
 void Parameters::readParFile(const std::string &fname) {
     std::vector<std::string> all_lines;
-    if (XMPI::root()) {
-        std::string line;
-        std::fstream fs(fname, std::fstream::in);
-        if (!fs) {
-            throw std::runtime_error("Parameters::readParFile || "
-                "Error opening parameter file: ||" + fname);
-        }
-        while (getline(fs, line)) {
-            all_lines.push_back(line);
-        }
-        fs.close();
+    if (!InputBundle::readLines(fname, all_lines)) {
+        throw std::runtime_error("Parameters::readParFile || "
+            "Error opening parameter file: ||" + fname);
     }
-    XMPI::bcast(all_lines);
     for (int i = 0; i < all_lines.size(); i++) {
         parseLine(all_lines[i]);
     }
@@ -154,10 +219,30 @@ std::string Parameters::verbose() const {
     // append mpi nproc
     ss << "  " << std::setw(width) << std::left << "mpi nproc" << "   =   ";
     ss << XMPI::nproc() << std::endl;
+    // append omp nthreads
+    ss << "  " << std::setw(width) << std::left << "omp nthreads" << "   =   ";
+    ss << XOMP::nThreads() << std::endl;
     ss << "======================== Parameters ========================\n" << std::endl;
     return ss.str();
 }
 
+std::string Parameters::signature(const std::vector<std::string> &prefixes) const {
+    std::stringstream ss;
+    for (auto it = mKeyValues.begin(); it != mKeyValues.end(); it++) {
+        for (const std::string &prefix: prefixes) {
+            if (boost::starts_with(it->first, prefix)) {
+                ss << it->first << " =";
+                for (const auto &value: it->second) {
+                    ss << " " << value;
+                }
+                ss << std::endl;
+                break;
+            }
+        }
+    }
+    return ss.str();
+}
+
 #include <boost/algorithm/string.hpp>
 void Parameters::buildInparam(Parameters *&par, int &verbose) {
     if (par) delete par;
@@ -51,6 +51,9 @@ public:
     // verbose
     std::string verbose() const;
     
+    // keys and values of the parameters starting with any of the prefixes
+    std::string signature(const std::vector<std::string> &prefixes) const;
+    
     // build from input parameters
     static void buildInparam(Parameters *&par, int &verbose);
         
@@ -4,56 +4,85 @@
 
 #include "PreloopFFTW.h"
 
-int PreloopFFTW::sNmax = 0;
-std::vector<fftw_plan> PreloopFFTW::sR2CPlans;
-std::vector<fftw_plan> PreloopFFTW::sC2RPlans;
-std::vector<RDColX> PreloopFFTW::sR2C_RMats;
-std::vector<CDColX> PreloopFFTW::sR2C_CMats;
-std::vector<RDColX> PreloopFFTW::sC2R_RMats;
-std::vector<CDColX> PreloopFFTW::sC2R_CMats;
+std::vector<int> PreloopFFTW::sNmax(1, 0);
+std::vector<std::vector<fftw_plan>> PreloopFFTW::sR2CPlans(1);
+std::vector<std::vector<fftw_plan>> PreloopFFTW::sC2RPlans(1);
+std::vector<std::vector<RDColX>> PreloopFFTW::sR2C_RMats(1);
+std::vector<std::vector<CDColX>> PreloopFFTW::sR2C_CMats(1);
+std::vector<std::vector<RDColX>> PreloopFFTW::sC2R_RMats(1);
+std::vector<std::vector<CDColX>> PreloopFFTW::sC2R_CMats(1);
+
+void PreloopFFTW::initThreads(int nthreads) {
+    if (nthreads <= sNmax.size()) {
+        return;
+    }
+    sNmax.resize(nthreads, 0);
+    sR2CPlans.resize(nthreads);
+    sC2RPlans.resize(nthreads);
+    sR2C_RMats.resize(nthreads);
+    sR2C_CMats.resize(nthreads);
+    sC2R_RMats.resize(nthreads);
+    sC2R_CMats.resize(nthreads);
+}
 
 void PreloopFFTW::checkAndInit(int nr) {
-    if (nr <= sNmax) {
+    int tid = XOMP::threadID();
+    if (nr <= sNmax[tid]) {
         return;
     }
-    int xx = 1;
-    for (int NR = sNmax + 1; NR <= nr; NR++) {
-        int NC = NR / 2 + 1;
-        int n[] = {NR};
-        sR2C_RMats.push_back(RDColX(NR, 1));
-        sR2C_CMats.push_back(CDColX(NC, 1));
-        sC2R_RMats.push_back(RDColX(NR, 1));
-        sC2R_CMats.push_back(CDColX(NC, 1));
-        double *r2c_r = &(sR2C_RMats[NR - 1](0, 0));
-        ComplexD *r2c_c = &(sR2C_CMats[NR - 1](0, 0));
-        sR2CPlans.push_back(fftw_plan_many_dft_r2c(
-            1, n, xx, r2c_r, n, 1, NR, reinterpret_cast<fftw_complex*>(r2c_c), n, 1, NC, FFTW_ESTIMATE));   
-        double *c2r_r = &(sC2R_RMats[NR - 1](0, 0));
-        ComplexD *c2r_c = &(sC2R_CMats[NR - 1](0, 0));
-        sC2RPlans.push_back(fftw_plan_many_dft_c2r(
-            1, n, xx, reinterpret_cast<fftw_complex*>(c2r_c), n, 1, NC, c2r_r, n, 1, NR, FFTW_ESTIMATE)); 
+    // the fftw planner is not thread-safe
+    #ifdef _USE_OPENMP
+        #pragma omp critical(PreloopFFTW_planner)
+    #endif
+    {
+        int xx = 1;
+        for (int NR = sNmax[tid] + 1; NR <= nr; NR++) {
+            int NC = NR / 2 + 1;
+            int n[] = {NR};
+            sR2C_RMats[tid].push_back(RDColX(NR, 1));
+            sR2C_CMats[tid].push_back(CDColX(NC, 1));
+            sC2R_RMats[tid].push_back(RDColX(NR, 1));
+            sC2R_CMats[tid].push_back(CDColX(NC, 1));
+            double *r2c_r = &(sR2C_RMats[tid][NR - 1](0, 0));
+            ComplexD *r2c_c = &(sR2C_CMats[tid][NR - 1](0, 0));
+            sR2CPlans[tid].push_back(fftw_plan_many_dft_r2c(
+                1, n, xx, r2c_r, n, 1, NR, reinterpret_cast<fftw_complex*>(r2c_c), n, 1, NC, FFTW_ESTIMATE));   
+            double *c2r_r = &(sC2R_RMats[tid][NR - 1](0, 0));
+            ComplexD *c2r_c = &(sC2R_CMats[tid][NR - 1](0, 0));
+            sC2RPlans[tid].push_back(fftw_plan_many_dft_c2r(
+                1, n, xx, reinterpret_cast<fftw_complex*>(c2r_c), n, 1, NC, c2r_r, n, 1, NR, FFTW_ESTIMATE)); 
+        }
+        sNmax[tid] = nr;
     }
-    sNmax = nr;
 }
 
 void PreloopFFTW::finalize() {
-    for (int i = 0; i < sNmax; i++) {
-        fftw_destroy_plan(sR2CPlans[i]);
-        fftw_destroy_plan(sC2RPlans[i]);
+    for (int tid = 0; tid < sNmax.size(); tid++) {
+        for (int i = 0; i < sNmax[tid]; i++) {
+            fftw_destroy_plan(sR2CPlans[tid][i]);
+            fftw_destroy_plan(sC2RPlans[tid][i]);
+        }
+        sR2CPlans[tid].clear();
+        sC2RPlans[tid].clear();
+        sR2C_RMats[tid].clear();
+        sR2C_CMats[tid].clear();
+        sC2R_RMats[tid].clear();
+        sC2R_CMats[tid].clear();
+        sNmax[tid] = 0;
     }
-    sNmax = 0;
 }
 
 void PreloopFFTW::computeR2C(int nr) {
     checkAndInit(nr); 
-    fftw_execute(sR2CPlans[nr - 1]);
+    int tid = XOMP::threadID();
+    fftw_execute(sR2CPlans[tid][nr - 1]);
     double inv_nr = one / (double)nr;
-    sR2C_CMats[nr - 1] *= inv_nr;
+    sR2C_CMats[tid][nr - 1] *= inv_nr;
 }
 
 void PreloopFFTW::computeC2R(int nr) {
     checkAndInit(nr); 
-    fftw_execute(sC2RPlans[nr - 1]);
+    fftw_execute(sC2RPlans[XOMP::threadID()][nr - 1]);
 }
 
 bool PreloopFFTW::isLuckyNumber(int n, bool forceOdd)
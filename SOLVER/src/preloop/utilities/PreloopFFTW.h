@@ -7,19 +7,22 @@
 #include <fftw3.h>
 #include <vector>
 #include "eigenp.h"
+#include "XOMP.h"
 
 class PreloopFFTW {
 public:
-    // check size and initialize plans
+    // plans and buffers for each thread, called outside parallel regions
+    static void initThreads(int nthreads);
+    // check size and initialize plans of the calling thread
     static void checkAndInit(int nr);
     // finalize plans
     static void finalize();
     
-    // get input and output
-    static RDColX &getR2C_RMat(int nr) {checkAndInit(nr); return sR2C_RMats[nr - 1];};
-    static CDColX &getR2C_CMat(int nr) {checkAndInit(nr); return sR2C_CMats[nr - 1];};
-    static RDColX &getC2R_RMat(int nr) {checkAndInit(nr); return sC2R_RMats[nr - 1];};    
-    static CDColX &getC2R_CMat(int nr) {checkAndInit(nr); return sC2R_CMats[nr - 1];};
+    // get input and output of the calling thread
+    static RDColX &getR2C_RMat(int nr) {checkAndInit(nr); return sR2C_RMats[XOMP::threadID()][nr - 1];};
+    static CDColX &getR2C_CMat(int nr) {checkAndInit(nr); return sR2C_CMats[XOMP::threadID()][nr - 1];};
+    static RDColX &getC2R_RMat(int nr) {checkAndInit(nr); return sC2R_RMats[XOMP::threadID()][nr - 1];};    
+    static CDColX &getC2R_CMat(int nr) {checkAndInit(nr); return sC2R_CMats[XOMP::threadID()][nr - 1];};
      
     // forward, real => complex
     static void computeR2C(int nr);
@@ -35,11 +38,12 @@ public:
     static int nextLuckyNumber(int n, bool forceOdd = false);
     
 private:
-    static int sNmax;
-    static std::vector<fftw_plan> sR2CPlans;
-    static std::vector<fftw_plan> sC2RPlans;
-    static std::vector<RDColX> sR2C_RMats;
-    static std::vector<CDColX> sR2C_CMats;
-    static std::vector<RDColX> sC2R_RMats;
-    static std::vector<CDColX> sC2R_CMats;
+    // indexed by thread
+    static std::vector<int> sNmax;
+    static std::vector<std::vector<fftw_plan>> sR2CPlans;
+    static std::vector<std::vector<fftw_plan>> sC2RPlans;
+    static std::vector<std::vector<RDColX>> sR2C_RMats;
+    static std::vector<std::vector<CDColX>> sR2C_CMats;
+    static std::vector<std::vector<RDColX>> sC2R_RMats;
+    static std::vector<std::vector<CDColX>> sC2R_CMats;
 };
@@ -0,0 +1,91 @@
+// SharedHalo.cpp
+// created by Kuangdai on 14-Oct-2026
+// halo exchange with node-local neighbours through an MPI-3 shared window
+
+#include "SharedHalo.h"
+#include "XMPI.h"
+
+SharedHalo::SharedHalo(const std::vector<int> &procs, const std::vector<int> &sizes):
+mSizes(sizes), mShared(procs.size(), false), 
+mOwnRegion(procs.size(), 0), mPeerRegion(procs.size(), 0) {
+    #ifndef _SERIAL_BUILD
+        // ranks of the neighbours on this node
+        MPI_Comm_split_type(XMPI::comm(), MPI_COMM_TYPE_SHARED, XMPI::rank(), 
+            MPI_INFO_NULL, &mNodeComm);
+        int nproc = procs.size();
+        std::vector<int> nodeRanks(nproc);
+        MPI_Group worldGroup, nodeGroup;
+        MPI_Comm_group(XMPI::comm(), &worldGroup);
+        MPI_Comm_group(mNodeComm, &nodeGroup);
+        MPI_Group_translate_ranks(worldGroup, nproc, procs.data(), nodeGroup, nodeRanks.data());
+        MPI_Group_free(&worldGroup);
+        MPI_Group_free(&nodeGroup);
+        
+        // two regions for each shared neighbour
+        std::vector<MPI_Aint> offsets(nproc, 0);
+        MPI_Aint total = 0;
+        for (int i = 0; i < nproc; i++) {
+            if (nodeRanks[i] != MPI_UNDEFINED) {
+                offsets[i] = total;
+                total += 2 * mSizes[i];
+            }
+        }
+        Complex *base = 0;
+        MPI_Win_allocate_shared(total * sizeof(Complex), sizeof(Complex), 
+            MPI_INFO_NULL, mNodeComm, &base, &mWindow);
+        mBytes = total * sizeof(Complex);
+        
+        // offsets of the regions of the neighbours for this rank
+        std::vector<MPI_Aint> peerOffsets(nproc, 0);
+        std::vector<MPI_Request> reqs;
+        for (int i = 0; i < nproc; i++) {
+            if (nodeRanks[i] != MPI_UNDEFINED) {
+                reqs.push_back(MPI_Request());
+                MPI_Irecv(&peerOffsets[i], 1, MPI_AINT, procs[i], procs[i], 
+                    XMPI::comm(), &reqs.back());
+                reqs.push_back(MPI_Request());
+                MPI_Isend(&offsets[i], 1, MPI_AINT, procs[i], XMPI::rank(), 
+                    XMPI::comm(), &reqs.back());
+            }
+        }
+        MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+        for (int i = 0; i < nproc; i++) {
+            if (nodeRanks[i] != MPI_UNDEFINED) {
+                MPI_Aint bytes;
+                int dispUnit;
+                Complex *peerBase = 0;
+                MPI_Win_shared_query(mWindow, nodeRanks[i], &bytes, &dispUnit, &peerBase);
+                mShared[i] = true;
+                mOwnRegion[i] = base + offsets[i];
+                mPeerRegion[i] = peerBase + peerOffsets[i];
+            }
+        }
+        
+        // passive target epoch for the whole run
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, mWindow);
+    #endif
+}
+
+SharedHalo::~SharedHalo() {
+    #ifndef _SERIAL_BUILD
+        MPI_Win_unlock_all(mWindow);
+        MPI_Win_free(&mWindow);
+        MPI_Comm_free(&mNodeComm);
+    #endif
+}
+
+void SharedHalo::post() {
+    #ifndef _SERIAL_BUILD
+        // packed regions become visible after the node-local barrier
+        MPI_Win_sync(mWindow);
+        MPI_Ibarrier(mNodeComm, &mBarrier);
+    #endif
+}
+
+void SharedHalo::wait() {
+    #ifndef _SERIAL_BUILD
+        MPI_Wait(&mBarrier, MPI_STATUS_IGNORE);
+        MPI_Win_sync(mWindow);
+    #endif
+}
+
@@ -0,0 +1,54 @@
+// SharedHalo.h
+// created by Kuangdai on 14-Oct-2026
+// halo exchange with node-local neighbours through an MPI-3 shared window
+
+#pragma once
+
+#include "eigenc.h"
+#include <vector>
+#ifndef _SERIAL_BUILD
+    #include "mpi.h"
+#endif
+
+class SharedHalo {
+public:
+    // procs: neighbours in the communicator of XMPI
+    // sizes: values exchanged with each neighbour, equal on both sides
+    // collective over the communicator of XMPI
+    SharedHalo(const std::vector<int> &procs, const std::vector<int> &sizes);
+    ~SharedHalo();
+    
+    // neighbour on the same node
+    bool shared(int i) const {return mShared[i];};
+    
+    // region of this rank read by neighbour i, and that of neighbour i
+    // read by this rank, for the current exchange
+    Complex *send(int i) const {return mOwnRegion[i] + mParity * mSizes[i];};
+    const Complex *recv(int i) const {return mPeerRegion[i] + mParity * mSizes[i];};
+    
+    // an exchange: pack into send(), post(), wait(), read from recv(), finish();
+    // every rank on the node must take part, with or without shared neighbours
+    void post();
+    void wait();
+    // regions are double-buffered, so that the next exchange may be packed 
+    // before all neighbours have read this one
+    void finish() {mParity = 1 - mParity;};
+    
+    // bytes of the window allocated by this rank
+    size_t memoryBytes() const {return mBytes;};
+    
+private:
+    std::vector<int> mSizes;
+    std::vector<bool> mShared;
+    std::vector<Complex *> mOwnRegion;
+    std::vector<const Complex *> mPeerRegion;
+    int mParity = 0;
+    size_t mBytes = 0;
+    
+    #ifndef _SERIAL_BUILD
+        MPI_Comm mNodeComm;
+        MPI_Win mWindow;
+        MPI_Request mBarrier;
+    #endif
+};
+
@@ -0,0 +1,73 @@
+// Timeline.cpp
+// created by Kuangdai on 14-Oct-2026
+// timestamped begin/end events of every rank, written in Chrome trace format
+
+#include "Timeline.h"
+#include "XMPI.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+std::vector<Timeline::Event> Timeline::sEvents;
+std::string Timeline::sFileName;
+int Timeline::sInterval = 0;
+bool Timeline::sActive = false;
+std::chrono::steady_clock::time_point Timeline::sOrigin = std::chrono::steady_clock::now();
+
+void Timeline::initialize(const std::string &fileName, int interval) {
+    sFileName = fileName;
+    sInterval = std::max(interval, 0);
+    sActive = sInterval > 0;
+    sEvents.clear();
+    // a common origin of all ranks, to within the latency of a barrier
+    XMPI::barrier();
+    sOrigin = std::chrono::steady_clock::now();
+}
+
+void Timeline::record(const std::string &name, char phase) {
+    double time = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - sOrigin).count();
+    sEvents.push_back({name, phase, time});
+}
+
+void Timeline::finalize() {
+    if (sInterval <= 0) {
+        return;
+    }
+    sActive = false;
+    // events of this rank as JSON objects, pid being the rank
+    std::stringstream ss;
+    ss.precision(15);
+    int rank = XMPI::rank();
+    ss << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank 
+        << ", \"tid\": 0, \"args\": {\"name\": \"rank " << rank << "\"}}";
+    for (const Event &event: sEvents) {
+        std::string name;
+        for (char c: event.mName) {
+            if (c == '"' || c == '\\') {
+                name += '\\';
+            }
+            name += c;
+        }
+        ss << ",\n{\"name\": \"" << name << "\", \"ph\": \"" << event.mPhase 
+            << "\", \"ts\": " << event.mTime << ", \"pid\": " << rank << ", \"tid\": 0}";
+    }
+    sEvents.clear();
+    std::vector<std::string> all_events;
+    XMPI::gather(ss.str(), all_events, false);
+    if (XMPI::root()) {
+        std::ofstream fs(sFileName);
+        if (!fs) {
+            throw std::runtime_error("Timeline::finalize || "
+                "Error opening timeline file: || " + sFileName);
+        }
+        fs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        for (int iproc = 0; iproc < all_events.size(); iproc++) {
+            fs << (iproc > 0 ? ",\n" : "") << all_events[iproc];
+        }
+        fs << "\n]}\n";
+        fs.close();
+    }
+}
+
@@ -0,0 +1,52 @@
+// Timeline.h
+// created by Kuangdai on 14-Oct-2026
+// timestamped begin/end events of every rank, written in Chrome trace format
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <chrono>
+
+class Timeline {
+public:
+    // events of the preloop and of every interval-th time step, written on 
+    // finalize to fileName by root; zero interval to turn off; collective
+    static void initialize(const std::string &fileName, int interval);
+    static void finalize();
+    
+    // whether events are kept in time step tstep; always in the preloop
+    static void sampleStep(int tstep) {
+        sActive = sInterval > 0 && tstep % sInterval == 0;
+    };
+    static bool active() {return sActive;};
+    
+    // events nest as with MultilevelTimer, from the master thread
+    static void begin(const std::string &name) {
+        if (sActive) {
+            record(name, 'B');
+        }
+    };
+    static void end(const std::string &name) {
+        if (sActive) {
+            record(name, 'E');
+        }
+    };
+    
+private:
+    static void record(const std::string &name, char phase);
+    
+    struct Event {
+        std::string mName;
+        char mPhase;
+        // microseconds since the barrier in initialize
+        double mTime;
+    };
+    static std::vector<Event> sEvents;
+    
+    static std::string sFileName;
+    static int sInterval;
+    static bool sActive;
+    static std::chrono::steady_clock::time_point sOrigin;
+};
+
@@ -4,14 +4,38 @@
 
 #include "XMPI.h"
 #include <iomanip>
+#include <fstream>
 #include "Parameters.h"
 
 XMPI::root_cout XMPI::cout;
 std::string XMPI::endl = "\n";
 
+MPI_Comm XMPI::sComm = MPI_COMM_NULL;
+#ifndef _SERIAL_BUILD
+    MPI_Comm XMPI::sNodeSplitComm = MPI_COMM_NULL;
+    MPI_Comm XMPI::sNodeComm = MPI_COMM_NULL;
+    MPI_Comm XMPI::sLeaderComm = MPI_COMM_NULL;
+#endif
+std::vector<std::string> XMPI::sRunDirectories;
+int XMPI::sEnsembleGroup = 0;
+int XMPI::sNumEnsembleGroups = 1;
+
+namespace XMPI_Bcast {
+    // bytes above which a broadcast from root goes through the node leaders
+    const int sNodeBytes = 65536;
+}
+
 void XMPI::initialize(int argc, char *argv[]) {
     #ifndef _SERIAL_BUILD
-        MPI_Init(&argc, &argv);
+        #ifdef _USE_OPENMP
+            // only the master thread makes MPI calls
+            int provided;
+            MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        #else
+            MPI_Init(&argc, &argv);
+        #endif
+        sComm = MPI_COMM_WORLD;
+        splitNodes();
     #endif
     
     // find path of executable
@@ -28,23 +52,108 @@ void XMPI::initialize(int argc, char *argv[]) {
         execDirectory = ".";
     }
     
-    // input and output
-    Parameters::sInputDirectory = execDirectory + "/input";
-    Parameters::sOutputDirectory = execDirectory + "/output";
+    // ensemble
+    std::string taskList = "";
+    int ranksPerGroup = 0;
+    for (int iarg = 1; iarg < argc; iarg++) {
+        if (std::string(argv[iarg]) == "-ensemble") {
+            if (iarg + 2 >= argc) {
+                throw std::runtime_error("XMPI::initialize || "
+                    "Usage: -ensemble <task list> <ranks per group>.");
+            }
+            taskList = argv[iarg + 1];
+            ranksPerGroup = atoi(argv[iarg + 2]);
+        }
+    }
+    if (taskList == "") {
+        sRunDirectories = std::vector<std::string>(1, execDirectory);
+        sEnsembleGroup = 0;
+        sNumEnsembleGroups = 1;
+        return;
+    }
+    
+    // cases, read on root of the world
+    std::vector<std::string> cases;
+    if (root()) {
+        std::ifstream fs(taskList);
+        if (!fs) {
+            throw std::runtime_error("XMPI::initialize || "
+                "Error opening ensemble task list: || " + taskList);
+        }
+        std::string line;
+        while (getline(fs, line)) {
+            boost::trim(line);
+            if (line.length() > 0 && line[0] != '#') {
+                cases.push_back(line);
+            }
+        }
+    }
+    bcast(cases);
+    int worldSize = nproc();
+    if (ranksPerGroup <= 0 || worldSize % ranksPerGroup != 0) {
+        throw std::runtime_error("XMPI::initialize || "
+            "The number of processors must be a multiple of the ranks per group "
+            "of -ensemble.");
+    }
+    
+    // groups of consecutive ranks, so that a group stays on few nodes
+    sNumEnsembleGroups = worldSize / ranksPerGroup;
+    sEnsembleGroup = rank() / ranksPerGroup;
+    sRunDirectories.clear();
+    for (int icase = sEnsembleGroup; icase < cases.size(); icase += sNumEnsembleGroups) {
+        sRunDirectories.push_back(cases[icase]);
+    }
+    #ifndef _SERIAL_BUILD
+        if (sLeaderComm != MPI_COMM_NULL) {
+            MPI_Comm_free(&sLeaderComm);
+        }
+        MPI_Comm_free(&sNodeComm);
+        MPI_Comm_split(MPI_COMM_WORLD, sEnsembleGroup, rank(), &sComm);
+        splitNodes();
+    #endif
+}
+
+void XMPI::setRunDirectory(const std::string &runDirectory) {
+    Parameters::sInputDirectory = runDirectory + "/input";
+    Parameters::sOutputDirectory = runDirectory + "/output";
     if (XMPI::root()) {
         if (!dirExists(Parameters::sInputDirectory)) {
-            throw std::runtime_error("XMPI::initialize || Missing input directory: ||" 
+            throw std::runtime_error("XMPI::setRunDirectory || Missing input directory: ||" 
                 + Parameters::sInputDirectory);
         }
         mkdir(Parameters::sOutputDirectory);
         mkdir(Parameters::sOutputDirectory + "/stations");    
         mkdir(Parameters::sOutputDirectory + "/plots");
         mkdir(Parameters::sOutputDirectory + "/develop");
+        mkdir(Parameters::sOutputDirectory + "/checkpoint");
+        mkdir(Parameters::sOutputDirectory + "/cache");
     }
+    barrier();
 }
 
+#ifndef _SERIAL_BUILD
+    void XMPI::splitNodes() {
+        // the ranks on a node, and a communicator of the lowest rank on 
+        // each node; root is the leader of its node and of the leaders
+        MPI_Comm_split_type(sComm, MPI_COMM_TYPE_SHARED, rank(), 
+            MPI_INFO_NULL, &sNodeComm);
+        int nodeRank = 0;
+        MPI_Comm_rank(sNodeComm, &nodeRank);
+        MPI_Comm_split(sComm, nodeRank == 0 ? 0 : MPI_UNDEFINED, 
+            rank(), &sLeaderComm);
+        sNodeSplitComm = sComm;
+    }
+#endif
+
 void XMPI::finalize() {
     #ifndef _SERIAL_BUILD
+        if (sLeaderComm != MPI_COMM_NULL) {
+            MPI_Comm_free(&sLeaderComm);
+        }
+        MPI_Comm_free(&sNodeComm);
+        if (sComm != MPI_COMM_WORLD) {
+            MPI_Comm_free(&sComm);
+        }
         MPI_Finalize();
     #endif
 }
@@ -85,55 +194,72 @@ void XMPI::printException(const std::exception &e) {
 
 void XMPI::bcast(int *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_INT, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_INT, src);
     #endif
 }
 
 void XMPI::bcast(double *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_DOUBLE, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_DOUBLE, src);
     #endif
 }
 
 void XMPI::bcast(float *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_FLOAT, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_FLOAT, src);
     #endif
 }
 
 void XMPI::bcast(std::complex<double> *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_C_DOUBLE_COMPLEX, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_C_DOUBLE_COMPLEX, src);
     #endif
 }
 
 void XMPI::bcast(std::complex<float> *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_C_FLOAT_COMPLEX, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_C_FLOAT_COMPLEX, src);
     #endif
 }
 
 void XMPI::bcast(char *buffer, int size, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(buffer, size, MPI_CHAR, src, MPI_COMM_WORLD);
+        bcastRaw(buffer, size, MPI_CHAR, src);
     #endif
 }
 
+#ifndef _SERIAL_BUILD
+    void XMPI::bcastRaw(void *buffer, int size, MPI_Datatype type, int src) {
+        int bytes = 0;
+        MPI_Type_size(type, &bytes);
+        if (src != 0 || (double)bytes * size < XMPI_Bcast::sNodeBytes ||
+            sComm != sNodeSplitComm) {
+            MPI_Bcast(buffer, size, type, src, sComm);
+            return;
+        }
+        // one copy over the network per node, then within the node
+        if (sLeaderComm != MPI_COMM_NULL) {
+            MPI_Bcast(buffer, size, type, 0, sLeaderComm);
+        }
+        MPI_Bcast(buffer, size, type, 0, sNodeComm);
+    }
+#endif
+
 void XMPI::bcast(int &buffer, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(&buffer, 1, MPI_INT, src, MPI_COMM_WORLD);
+        MPI_Bcast(&buffer, 1, MPI_INT, src, sComm);
     #endif
 }
 
 void XMPI::bcast(double &buffer, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(&buffer, 1, MPI_DOUBLE, src, MPI_COMM_WORLD);
+        MPI_Bcast(&buffer, 1, MPI_DOUBLE, src, sComm);
     #endif
 }
 
 void XMPI::bcast(float &buffer, int src) {
     #ifndef _SERIAL_BUILD
-        MPI_Bcast(&buffer, 1, MPI_FLOAT, src, MPI_COMM_WORLD);
+        MPI_Bcast(&buffer, 1, MPI_FLOAT, src, sComm);
     #endif
 }
 
@@ -204,14 +330,14 @@ void XMPI::bcast(std::vector<std::string> &buffer, int src) {
 
 void XMPI::min(const std::vector<int> &value, std::vector<int> &minimum) {
     #ifndef _SERIAL_BUILD
-        MPI_Allreduce(value.data(), minimum.data(), value.size(), MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(value.data(), minimum.data(), value.size(), MPI_INT, MPI_MIN, sComm);
     #endif
 }
 
 int XMPI::min(const int &value) {
     #ifndef _SERIAL_BUILD
         int minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_MIN, sComm);
         return minimum;
     #else
         return value;
@@ -221,27 +347,52 @@ int XMPI::min(const int &value) {
 double XMPI::min(const double &value) {
     #ifndef _SERIAL_BUILD
         double minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_MIN, sComm);
         return minimum;
     #else
         return value;
     #endif
 }
 
+int XMPI::minLoc(double &value) {
+    #ifndef _SERIAL_BUILD
+        struct {
+            double mValue;
+            int mRank;
+        } local, global;
+        local.mValue = value;
+        local.mRank = rank();
+        MPI_Allreduce(&local, &global, 1, MPI_DOUBLE_INT, MPI_MINLOC, sComm);
+        value = global.mValue;
+        return global.mRank;
+    #else
+        return 0;
+    #endif
+}
+
 int XMPI::max(const int &value) {
     #ifndef _SERIAL_BUILD
         int minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_MAX, sComm);
         return minimum;
     #else
         return value;
     #endif
 }
 
+void XMPI::imax(const int &value, int &maximum, MPI_Request &request) {
+    #ifndef _SERIAL_BUILD
+        MPI_Iallreduce(&value, &maximum, 1, MPI_INT, MPI_MAX, sComm, &request);
+    #else
+        maximum = value;
+        request = MPI_REQUEST_NULL;
+    #endif
+}
+
 double XMPI::max(const double &value) {
     #ifndef _SERIAL_BUILD
         double minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_MAX, sComm);
         return minimum;
     #else
         return value;
@@ -251,7 +402,7 @@ double XMPI::max(const double &value) {
 int XMPI::sum(const int &value) {
     #ifndef _SERIAL_BUILD
         int minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_INT, MPI_SUM, sComm);
         return minimum;
     #else
         return value;
@@ -261,17 +412,71 @@ int XMPI::sum(const int &value) {
 double XMPI::sum(const double &value) {
     #ifndef _SERIAL_BUILD
         double minimum;
-        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(&value, &minimum, 1, MPI_DOUBLE, MPI_SUM, sComm);
         return minimum;
     #else
         return value;
     #endif
 }
 
+int XMPI::exscan(const int &value) {
+    #ifndef _SERIAL_BUILD
+        int lower = 0;
+        MPI_Exscan(&value, &lower, 1, MPI_INT, MPI_SUM, sComm);
+        // undefined on root
+        return root() ? 0 : lower;
+    #else
+        return 0;
+    #endif
+}
+
+int XMPI::graphReorder(const std::vector<int> &neighbours, 
+    const std::vector<int> &weights) {
+    #ifndef _SERIAL_BUILD
+        // an isolated rank has empty, not missing, weights
+        int degree = neighbours.size();
+        const int *wgt = degree > 0 ? weights.data() : MPI_WEIGHTS_EMPTY;
+        MPI_Comm graph;
+        MPI_Dist_graph_create_adjacent(sComm, 
+            degree, neighbours.data(), wgt, degree, neighbours.data(), wgt,
+            MPI_INFO_NULL, 1, &graph);
+        int newRank = 0;
+        MPI_Comm_rank(graph, &newRank);
+        MPI_Comm_free(&graph);
+        return newRank;
+    #else
+        return 0;
+    #endif
+}
+
+void XMPI::nodeRanks(std::vector<std::vector<int>> &ranksOfNode) {
+    ranksOfNode.clear();
+    #ifndef _SERIAL_BUILD
+        // a node is identified by its lowest world rank
+        MPI_Comm nodeComm;
+        MPI_Comm_split_type(sComm, MPI_COMM_TYPE_SHARED, rank(), 
+            MPI_INFO_NULL, &nodeComm);
+        int nodeRoot = rank();
+        MPI_Bcast(&nodeRoot, 1, MPI_INT, 0, nodeComm);
+        MPI_Comm_free(&nodeComm);
+        std::vector<int> roots;
+        gather(nodeRoot, roots, true);
+        std::map<int, std::vector<int>> nodes;
+        for (int iproc = 0; iproc < nproc(); iproc++) {
+            nodes[roots[iproc]].push_back(iproc);
+        }
+        for (auto it = nodes.begin(); it != nodes.end(); it++) {
+            ranksOfNode.push_back(it->second);
+        }
+    #else
+        ranksOfNode.push_back(std::vector<int>(1, 0));
+    #endif
+}
+
 void XMPI::sumVector(std::vector<double> &value) {
     #ifndef _SERIAL_BUILD
         std::vector<double> total(value.size());
-        MPI_Allreduce(value.data(), total.data(), value.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(value.data(), total.data(), value.size(), MPI_DOUBLE, MPI_SUM, sComm);
         value = total;
     #endif
 }
@@ -280,12 +485,12 @@ void XMPI::gather(int buf, std::vector<int> &all_buf, bool all) {
     #ifndef _SERIAL_BUILD
         if (all) {
             all_buf.resize(XMPI::nproc());
-            MPI_Allgather(&buf, 1, MPI_INT, all_buf.data(), 1, MPI_INT, MPI_COMM_WORLD);
+            MPI_Allgather(&buf, 1, MPI_INT, all_buf.data(), 1, MPI_INT, sComm);
         } else {
             if (root()) {
                 all_buf.resize(XMPI::nproc());
             }
-            MPI_Gather(&buf, 1, MPI_INT, all_buf.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+            MPI_Gather(&buf, 1, MPI_INT, all_buf.data(), 1, MPI_INT, 0, sComm);
         }
     #else
         all_buf.clear();
@@ -297,12 +502,12 @@ void XMPI::gather(double buf, std::vector<double> &all_buf, bool all) {
     #ifndef _SERIAL_BUILD
         if (all) {
             all_buf.resize(XMPI::nproc());
-            MPI_Allgather(&buf, 1, MPI_DOUBLE, all_buf.data(), 1, MPI_DOUBLE, MPI_COMM_WORLD);
+            MPI_Allgather(&buf, 1, MPI_DOUBLE, all_buf.data(), 1, MPI_DOUBLE, sComm);
         } else {
             if (root()) {
                 all_buf.resize(XMPI::nproc());
             }
-            MPI_Gather(&buf, 1, MPI_DOUBLE, all_buf.data(), 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            MPI_Gather(&buf, 1, MPI_DOUBLE, all_buf.data(), 1, MPI_DOUBLE, 0, sComm);
         }
     #else
         all_buf.clear();
@@ -310,6 +515,18 @@ void XMPI::gather(double buf, std::vector<double> &all_buf, bool all) {
     #endif
 }
 
+void XMPI::gatherEqual(const std::vector<double> &buf, std::vector<double> &all_buf) {
+    #ifndef _SERIAL_BUILD
+        if (root()) {
+            all_buf.resize(buf.size() * XMPI::nproc());
+        }
+        MPI_Gather(buf.data(), buf.size(), MPI_DOUBLE, 
+            all_buf.data(), buf.size(), MPI_DOUBLE, 0, sComm);
+    #else
+        all_buf = buf;
+    #endif
+}
+
 void XMPI::gather(const std::string &buf, std::vector<std::string> &all_buf, bool all) {
     #ifndef _SERIAL_BUILD
         // size
@@ -331,15 +548,15 @@ void XMPI::gather(const std::string &buf, std::vector<std::string> &all_buf, boo
                 }
             }
         }
-
+        
         char *all_cstr;
         if (all || root()) {
             all_cstr = new char[total_size];
         }
         if (all) {
-            MPI_Allgatherv(buf.c_str(), size, MPI_CHAR, all_cstr, all_size.data(), disp.data(), MPI_CHAR, MPI_COMM_WORLD);
+            MPI_Allgatherv(buf.c_str(), size, MPI_CHAR, all_cstr, all_size.data(), disp.data(), MPI_CHAR, sComm);
         } else {
-            MPI_Gatherv(buf.c_str(), size, MPI_CHAR, all_cstr, all_size.data(), disp.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+            MPI_Gatherv(buf.c_str(), size, MPI_CHAR, all_cstr, all_size.data(), disp.data(), MPI_CHAR, 0, sComm);
         }
         if (all || root()) {
             all_buf.clear();
@@ -6,43 +6,90 @@
 #include <iostream>
 #include "eigenc.h"
 #include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <stdexcept>
 
 #ifndef _SERIAL_BUILD
     #include "mpi.h"
 #else
     #define MPI_Request int
+    #define MPI_REQUEST_NULL 0
     #define MPI_Datatype int
+    #define MPI_Comm int
+    #define MPI_COMM_NULL 0
     #define MPI_CHAR 1
     #define MPI_INT 2
     #define MPI_FLOAT 3
     #define MPI_DOUBLE 4
 #endif
 
+// an error raised by all processors together, as after a reduction, so 
+// that they can stop without MPI_Abort; report: this processor prints it
+class CollectiveError: public std::runtime_error {
+public:
+    CollectiveError(const std::string &what, bool report): 
+        std::runtime_error(what), mReport(report) {};
+    bool report() const {return mReport;};
+private:
+    bool mReport;
+};
+
 class XMPI {
 public:
     // initialize and finalize
+    // ensemble mode, "-ensemble <task list> <ranks per group>" on the command 
+    // line: the processors are split into groups of consecutive ranks, group 
+    // i running the cases i, i + ngroups, ... of the task list in turn; a case 
+    // is a directory, one per line, holding its input and output directories
     static void initialize(int argc, char *argv[]);
     static void finalize();
     
+    // cases of the ensemble group, or the directory of the executable
+    static const std::vector<std::string> &runDirectories() {return sRunDirectories;};
+    // input and output of a run; collective
+    static void setRunDirectory(const std::string &runDirectory);
+    
+    // ensemble group of this processor and number of groups
+    static int ensembleGroup() {return sEnsembleGroup;};
+    static int numEnsembleGroups() {return sNumEnsembleGroups;};
+    
+    // current communicator, that of a simulation (MPI_COMM_WORLD or the 
+    // ensemble group) unless a CommScope is alive; rank, nproc, all 
+    // collectives below and messages without a communicator refer to it
+    static MPI_Comm comm() {return sComm;};
+    
+    // switch the current communicator, e.g., to an I/O or node-local group,
+    // for the lifetime of the scope; every processor of comm must create it
+    class CommScope {
+    public:
+        CommScope(MPI_Comm comm): mPrevious(sComm) {sComm = comm;};
+        ~CommScope() {sComm = mPrevious;};
+    private:
+        MPI_Comm mPrevious;
+    };
+    
     // print exception
     static void printException(const std::exception &e);
     
     // properties
     static int nproc() {
         #ifndef _SERIAL_BUILD
-            int world_size;
-            MPI_Comm_size(MPI_COMM_WORLD, &world_size);
-            return world_size;
+            int comm_size;
+            MPI_Comm_size(sComm, &comm_size);
+            return comm_size;
         #else
             return 1;
         #endif
     };
     
-    static int rank() {
+    static int rank() {return rank(sComm);};
+    static int rank(MPI_Comm comm) {
         #ifndef _SERIAL_BUILD
-            int world_rank;
-            MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
-            return world_rank;
+            int comm_rank;
+            MPI_Comm_rank(comm, &comm_rank);
+            return comm_rank;
         #else
             return 0;
         #endif
@@ -50,10 +97,17 @@ public:
     
     static bool root() {return rank() == 0;};
     
+    // ranks on this node, and the lowest rank of each node (MPI_COMM_NULL
+    // on the other ranks); root is rank 0 of both
+    #ifndef _SERIAL_BUILD
+        static MPI_Comm nodeComm() {return sNodeComm;};
+        static MPI_Comm leaderComm() {return sLeaderComm;};
+    #endif
+    
     // barrier
     static void barrier() {
         #ifndef _SERIAL_BUILD
-            MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Barrier(sComm);
         #endif
     };
     
@@ -118,52 +172,108 @@ public:
     static void bcast(std::vector<std::string> &buffer, int src = 0);
     
     ////////////////////////////// isend/irecv ////////////////////////////// 
+    // tag: negative for the rank of the receiver in comm;
+    // comm: MPI_COMM_NULL for the current communicator
     // isend, only for Eigen::Matrix
     template<typename EigenMat>
-    static void isendDouble(int dest, const EigenMat &buffer, MPI_Request &request) {
+    static void isendDouble(int dest, const EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
         #ifndef _SERIAL_BUILD
             MPI_Isend(buffer.data(), buffer.size(), 
-                MPI_DOUBLE, dest, dest, MPI_COMM_WORLD, &request);
+                MPI_DOUBLE, dest, sendTag(dest, tag), orCurrent(comm), &request);
         #endif
     };
     
     // irecv, only for Eigen::Matrix
     template<typename EigenMat>
-    static void irecvDouble(int source, EigenMat &buffer, MPI_Request &request) {
+    static void irecvDouble(int source, EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
         #ifndef _SERIAL_BUILD
             MPI_Irecv(buffer.data(), buffer.size(), 
-                MPI_DOUBLE, source, rank(), MPI_COMM_WORLD, &request);
+                MPI_DOUBLE, source, recvTag(tag, comm), orCurrent(comm), &request);
         #endif
     };
     
     // isend, only for Eigen::Matrix
     template<typename EigenMat>
-    static void isendComplex(int dest, const EigenMat &buffer, MPI_Request &request) {
+    static void isendComplex(int dest, const EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
         #ifndef _SERIAL_BUILD
             #ifdef _USE_DOUBLE
                 MPI_Isend(buffer.data(), buffer.size(), 
-                    MPI_C_DOUBLE_COMPLEX, dest, dest, MPI_COMM_WORLD, &request);
+                    MPI_C_DOUBLE_COMPLEX, dest, sendTag(dest, tag), orCurrent(comm), &request);
             #else
                 MPI_Isend(buffer.data(), buffer.size(), 
-                    MPI_C_FLOAT_COMPLEX, dest, dest, MPI_COMM_WORLD, &request);
+                    MPI_C_FLOAT_COMPLEX, dest, sendTag(dest, tag), orCurrent(comm), &request);
             #endif
         #endif
     };
     
     // irecv, only for Eigen::Matrix
     template<typename EigenMat>
-    static void irecvComplex(int source, EigenMat &buffer, MPI_Request &request) {
+    static void irecvComplex(int source, EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
         #ifndef _SERIAL_BUILD
             #ifdef _USE_DOUBLE
                 MPI_Irecv(buffer.data(), buffer.size(), 
-                    MPI_C_DOUBLE_COMPLEX, source, rank(), MPI_COMM_WORLD, &request);
+                    MPI_C_DOUBLE_COMPLEX, source, recvTag(tag, comm), orCurrent(comm), &request);
             #else
                 MPI_Irecv(buffer.data(), buffer.size(), 
-                    MPI_C_FLOAT_COMPLEX, source, rank(), MPI_COMM_WORLD, &request);
+                    MPI_C_FLOAT_COMPLEX, source, recvTag(tag, comm), orCurrent(comm), &request);
+            #endif
+        #endif
+    };
+    
+    // persistent send, only for Eigen::Matrix
+    // buffer must stay at the same address until the request is freed
+    template<typename EigenMat>
+    static void sendInitComplex(int dest, const EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
+        #ifndef _SERIAL_BUILD
+            #ifdef _USE_DOUBLE
+                MPI_Send_init(buffer.data(), buffer.size(), 
+                    MPI_C_DOUBLE_COMPLEX, dest, sendTag(dest, tag), orCurrent(comm), &request);
+            #else
+                MPI_Send_init(buffer.data(), buffer.size(), 
+                    MPI_C_FLOAT_COMPLEX, dest, sendTag(dest, tag), orCurrent(comm), &request);
             #endif
         #endif
     };
     
+    // persistent recv, only for Eigen::Matrix
+    // buffer must stay at the same address until the request is freed
+    template<typename EigenMat>
+    static void recvInitComplex(int source, EigenMat &buffer, MPI_Request &request,
+        int tag = -1, MPI_Comm comm = MPI_COMM_NULL) {
+        #ifndef _SERIAL_BUILD
+            #ifdef _USE_DOUBLE
+                MPI_Recv_init(buffer.data(), buffer.size(), 
+                    MPI_C_DOUBLE_COMPLEX, source, recvTag(tag, comm), orCurrent(comm), &request);
+            #else
+                MPI_Recv_init(buffer.data(), buffer.size(), 
+                    MPI_C_FLOAT_COMPLEX, source, recvTag(tag, comm), orCurrent(comm), &request);
+            #endif
+        #endif
+    };
+    
+    // start_all, for persistent requests
+    static void start_all(int count, MPI_Request array_of_requests[]) {
+        #ifndef _SERIAL_BUILD
+            MPI_Startall(count, array_of_requests);
+        #endif
+    };
+    
+    // free_all, for persistent requests
+    static void free_all(int count, MPI_Request array_of_requests[]) {
+        #ifndef _SERIAL_BUILD
+            for (int i = 0; i < count; i++) {
+                if (array_of_requests[i] != MPI_REQUEST_NULL) {
+                    MPI_Request_free(&array_of_requests[i]);
+                }
+            }
+        #endif
+    };
+    
     // wait_all
     static void wait_all(int count, MPI_Request array_of_requests[]) {
         #ifndef _SERIAL_BUILD
@@ -171,6 +281,15 @@ public:
         #endif
     };
     
+    // wait_any, returning the index of the request completed
+    static int wait_any(int count, MPI_Request array_of_requests[]) {
+        int index = -1;
+        #ifndef _SERIAL_BUILD
+            MPI_Waitany(count, array_of_requests, &index, MPI_STATUS_IGNORE);
+        #endif
+        return index;
+    };
+    
     ////////////////////////////// reduce //////////////////////////////
     // simple
     static int min(const int &value);
@@ -182,24 +301,55 @@ public:
     
     static void min(const std::vector<int> &value, std::vector<int> &minimum);
     
+    // nonblocking maximum, completed by wait_all; value and maximum 
+    // must stay in place until then
+    static void imax(const int &value, int &maximum, MPI_Request &request);
+    
+    // global minimum in place, returning the lowest rank that owns it
+    static int minLoc(double &value);
+    
+    // sum over the lower ranks, 0 on root
+    static int exscan(const int &value);
+    
     // sum std::vector
     static void sumVector(std::vector<double> &value);
     
+    ////////////////////////////// topology //////////////////////////////
+    // rank suggested by MPI for this process in a distributed graph 
+    // of weighted symmetric neighbours, created with reorder
+    static int graphReorder(const std::vector<int> &neighbours, 
+        const std::vector<int> &weights);
+    
+    // world ranks on each shared-memory node, nodes ordered by first rank
+    static void nodeRanks(std::vector<std::vector<int>> &ranksOfNode);
+    
     // sum Eigen::Matrix
     template<typename Type>
     static void sumEigenDouble(Type &value) {
         #ifndef _SERIAL_BUILD
             Type total(value);
-            MPI_Allreduce(value.data(), total.data(), value.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(value.data(), total.data(), value.size(), MPI_DOUBLE, MPI_SUM, sComm);
             value = total;
         #endif
     };
     
+    // sum Eigen::Matrix on one rank only
+    template<typename Type>
+    static void reduceSumEigenDouble(Type &value, int dest) {
+        #ifndef _SERIAL_BUILD
+            if (rank() == dest) {
+                MPI_Reduce(MPI_IN_PLACE, value.data(), value.size(), MPI_DOUBLE, MPI_SUM, dest, sComm);
+            } else {
+                MPI_Reduce(value.data(), 0, value.size(), MPI_DOUBLE, MPI_SUM, dest, sComm);
+            }
+        #endif
+    };
+    
     template<typename Type>
     static void sumEigenInt(Type &value) {
         #ifndef _SERIAL_BUILD
             Type total(value);
-            MPI_Allreduce(value.data(), total.data(), value.size(), MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+            MPI_Allreduce(value.data(), total.data(), value.size(), MPI_INT, MPI_SUM, sComm);
             value = total;
         #endif
     };
@@ -208,7 +358,9 @@ public:
     // string
     static void gather(int buf, std::vector<int> &all_buf, bool all);
     static void gather(double buf, std::vector<double> &all_buf, bool all);
-
+    // vectors of the same size on all ranks, concatenated on root
+    static void gatherEqual(const std::vector<double> &buf, std::vector<double> &all_buf);
+    
     static void gather(const std::string &buf, std::vector<std::string> &all_buf, bool all);
     static void gather(const std::vector<std::string> &buf, 
         std::vector<std::vector<std::string>> &all_buf, bool all);
@@ -236,15 +388,15 @@ public:
                     for (int j = 0; j < i; j++) 
                         disp[i] += all_size[j];
             }
-
+            
             std::vector<Type> allBuf_flat;
             if (all || root()) {
                 allBuf_flat.resize(total_size);
             }
             if (all) {
-                MPI_Allgatherv(buf.data(), size, mpitype, allBuf_flat.data(), all_size.data(), disp.data(), mpitype, MPI_COMM_WORLD);
+                MPI_Allgatherv(buf.data(), size, mpitype, allBuf_flat.data(), all_size.data(), disp.data(), mpitype, sComm);
             } else {
-                MPI_Gatherv(buf.data(), size, mpitype, allBuf_flat.data(), all_size.data(), disp.data(), mpitype, 0, MPI_COMM_WORLD);
+                MPI_Gatherv(buf.data(), size, mpitype, allBuf_flat.data(), all_size.data(), disp.data(), mpitype, 0, sComm);
             }
             if (all || root()) {
                 all_buf.clear();
@@ -293,6 +445,46 @@ public:
         }
     }
     
+    ////////////////////////////// all to all ////////////////////////////// 
+    // send_buf[i] goes to rank i; recv_buf[i] comes from rank i
+    template<typename Type>
+    static void alltoall(const std::vector<std::vector<Type>> &send_buf, 
+        std::vector<std::vector<Type>> &recv_buf, MPI_Datatype mpitype) {
+        
+        #ifndef _SERIAL_BUILD
+            // size
+            int nproc = XMPI::nproc();
+            std::vector<int> send_size(nproc), recv_size(nproc);
+            for (int i = 0; i < nproc; i++) {
+                send_size[i] = send_buf[i].size();
+            }
+            MPI_Alltoall(send_size.data(), 1, MPI_INT, recv_size.data(), 1, MPI_INT, sComm);
+            
+            // displacement
+            std::vector<int> send_disp(nproc, 0), recv_disp(nproc, 0);
+            for (int i = 1; i < nproc; i++) {
+                send_disp[i] = send_disp[i - 1] + send_size[i - 1];
+                recv_disp[i] = recv_disp[i - 1] + recv_size[i - 1];
+            }
+            
+            std::vector<Type> send_flat, recv_flat;
+            for (int i = 0; i < nproc; i++) {
+                send_flat.insert(send_flat.end(), send_buf[i].begin(), send_buf[i].end());
+            }
+            recv_flat.resize(recv_disp[nproc - 1] + recv_size[nproc - 1]);
+            MPI_Alltoallv(send_flat.data(), send_size.data(), send_disp.data(), mpitype,
+                recv_flat.data(), recv_size.data(), recv_disp.data(), mpitype, sComm);
+            
+            recv_buf.clear();
+            for (int i = 0; i < nproc; i++) {
+                recv_buf.push_back(std::vector<Type>(recv_flat.begin() + recv_disp[i], 
+                    recv_flat.begin() + recv_disp[i] + recv_size[i]));
+            }
+        #else
+            recv_buf = send_buf;
+        #endif
+    }
+    
     ////////////////////////////// stream on root //////////////////////////////
     struct root_cout {
         template<typename Type>
@@ -324,6 +516,34 @@ public:
     static bool dirExists(const std::string &path);
     static void mkdir(const std::string &path);
     
+private:
+    // communicator and tags of a message
+    static MPI_Comm orCurrent(MPI_Comm comm) {
+        return comm == MPI_COMM_NULL ? sComm : comm;
+    };
+    static int sendTag(int dest, int tag) {return tag < 0 ? dest : tag;};
+    static int recvTag(int tag, MPI_Comm comm) {
+        return tag < 0 ? rank(orCurrent(comm)) : tag;
+    };
+    
+    // current communicator
+    static MPI_Comm sComm;
+    
+    // broadcast from root, large arrays through the node leaders
+    #ifndef _SERIAL_BUILD
+        static void bcastRaw(void *buffer, int size, MPI_Datatype type, int src);
+        // node and leader communicators of sComm, kept with the communicator
+        // they are split from, as a CommScope may change sComm
+        static void splitNodes();
+        static MPI_Comm sNodeSplitComm;
+        static MPI_Comm sNodeComm;
+        static MPI_Comm sLeaderComm;
+    #endif
+    
+    // ensemble
+    static std::vector<std::string> sRunDirectories;
+    static int sEnsembleGroup;
+    static int sNumEnsembleGroups;
 };
 
 // message info
@@ -336,15 +556,34 @@ struct MessagingInfo {
     std::vector<int> mNLocalPoints;
     // indecies of local points to be communicated for each proc
     std::vector<std::vector<int>> mILocalPoints;
-    // mpi requests
+    // mpi requests, only for neighbours not in a shared window or aggregated
     std::vector<MPI_Request> mReqSend;
     std::vector<MPI_Request> mReqRecv;
+    // communicator of the procs above, MPI_COMM_NULL for that of XMPI,
+    // and tag of the messages, negative for the rank of the receiver
+    MPI_Comm mComm = MPI_COMM_NULL;
+    int mTag = -1;
 };
 
 // message buffer for solver
+class SharedHalo;
+class HaloAggregator;
 struct MessagingBuffer {
+    // empty for neighbours exchanging through mSharedHalo or mAggregator
     std::vector<CColX> mBufferSend;
     std::vector<CColX> mBufferRecv;
+    // stiffness arrays of the communicated points, in buffer order
+    std::vector<std::vector<std::pair<Complex *, int>>> mStiffBlocks;
+    // node-local neighbours, owned by the domain
+    SharedHalo *mSharedHalo = 0;
+    // off-node neighbours, through the node leaders, owned by the domain
+    HaloAggregator *mAggregator = 0;
+    // trailing-mode trimming of the messages: a point is sent as its number
+    // of active modes followed by those modes of each component;
+    // modes, components and blocks of each point, in buffer order
+    bool mTrimModes = false;
+    Real mTrimTolerance = 0.;
+    std::vector<std::vector<std::array<int, 3>>> mPointShapes;
 };
 
 
@@ -5,6 +5,8 @@
 #include "XMath.h"
 #include "PreloopFFTW.h"
 #include <cfloat>
+#include <fstream>
+#include <algorithm>
 
 void XMath::makeClose(double &a, double &b) {
     if (a - b > pi) {
@@ -53,13 +55,64 @@ void XMath::interpLinear(double target, const RDColX &bases, int &loc, double &w
         return;
     }
     
-    for (int i = 1; i < bases.size(); i++) {
-        if (target <= bases(i)) {
-            loc = i - 1;
-            weight = 1. - 1. / (bases(loc + 1) - bases(loc)) * (target - bases(loc));
+    // first base not below target
+    int i = std::lower_bound(bases.data() + 1, bases.data() + bases.size(), target) - bases.data();
+    loc = i - 1;
+    weight = 1. - 1. / (bases(loc + 1) - bases(loc)) * (target - bases(loc));
+}
+
+XMath::Grid1D::Grid1D(const RDColX &bases): mBases(bases) {
+    int n = mBases.size();
+    if (n < 2) {
+        return;
+    }
+    double delta = (mBases(n - 1) - mBases(0)) / (n - 1);
+    mUniform = delta > 0.;
+    for (int i = 0; i < n - 1 && mUniform; i++) {
+        mUniform = std::abs(mBases(i + 1) - mBases(i) - delta) <= 1e-6 * delta;
+    }
+    mInvDelta = mUniform ? 1. / delta : 0.;
+}
+
+void XMath::Grid1D::interpLinear(double target, int &loc, double &weight, int &hint) const {
+    int n = mBases.size();
+    if (n < 2 || target < mBases(0) || target > mBases(n - 1)) {
+        loc = -1;
+        weight = 0.;
+        return;
+    }
+    
+    // first guess
+    if (mUniform) {
+        loc = (int)((target - mBases(0)) * mInvDelta);
+    } else if (hint >= 0 && hint < n - 1) {
+        loc = hint;
+    } else {
+        XMath::interpLinear(target, mBases, loc, weight);
+        hint = loc;
+        return;
+    }
+    loc = std::max(std::min(loc, n - 2), 0);
+    
+    // the cell of interpLinear: the first with target <= upper base; 
+    // a wrong guess is at most one cell off on a uniform grid
+    if (loc > 0 && target <= mBases(loc)) {
+        if (loc > 1 && target <= mBases(loc - 1)) {
+            XMath::interpLinear(target, mBases, loc, weight);
+            hint = loc;
             return;
         }
+        loc--;
+    } else if (target > mBases(loc + 1)) {
+        if (loc < n - 3 && target > mBases(loc + 2)) {
+            XMath::interpLinear(target, mBases, loc, weight);
+            hint = loc;
+            return;
+        }
+        loc++;
     }
+    weight = 1. - 1. / (mBases(loc + 1) - mBases(loc)) * (target - mBases(loc));
+    hint = loc;
 }
 
 void XMath::checkLimits(double &value, double low, double up, double tol) {
@@ -201,3 +254,45 @@ RDRowN XMath::computeFourierAtPhi(const RDMatXN &data, double phi) {
     }
     return result;
 }
+
+uint64_t XMath::hash(const std::string &bytes, uint64_t seed) {
+    uint64_t h = seed;
+    for (unsigned char c: bytes) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t XMath::hashFile(const std::string &fname) {
+    std::ifstream fs(fname, std::ios::binary);
+    if (!fs) {
+        throw std::runtime_error("XMath::hashFile || "
+            "Error opening file: || " + fname);
+    }
+    uint64_t h = hash("");
+    std::string chunk(1 << 20, 0);
+    while (fs) {
+        fs.read(&chunk[0], chunk.size());
+        h = hash(chunk.substr(0, fs.gcount()), h);
+    }
+    return h;
+}
+
+uint64_t XMath::hilbertIndex(uint32_t x, uint32_t y, int order) {
+    uint64_t d = 0;
+    for (uint32_t side = 1u << (order - 1); side > 0; side >>= 1) {
+        uint32_t rx = (x & side) > 0 ? 1 : 0;
+        uint32_t ry = (y & side) > 0 ? 1 : 0;
+        d += (uint64_t)side * side * ((3 * rx) ^ ry);
+        // rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - (x & (side - 1));
+                y = side - 1 - (y & (side - 1));
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
@@ -2,8 +2,11 @@
 // created by Kuangdai on 9-May-2016 
 // miscellaneous math tools
 
+#pragma once
+
 #include "eigenp.h"
 #include "eigenc.h"
+#include <cstdint>
 
 class XMath {
 public:
@@ -22,6 +25,40 @@ public:
     // linear interpolation
     static void interpLinear(double target, const RDColX &bases, int &loc, double &weight); 
     
+    // sorted 1D grid for repeated linear interpolation, with the same outputs 
+    // as interpLinear; the cell is found in O(1) on a uniform grid, otherwise 
+    // by a binary search after trying hint, the cell of the previous query,
+    // which the caller keeps for a sequence of nearby queries
+    class Grid1D {
+    public:
+        Grid1D() {};
+        Grid1D(const RDColX &bases);
+        void interpLinear(double target, int &loc, double &weight, int &hint) const;
+        void interpLinear(double target, int &loc, double &weight) const {
+            int hint = -1;
+            interpLinear(target, loc, weight, hint);
+        };
+        const RDColX &bases() const {return mBases;};
+        bool uniform() const {return mUniform;};
+    private:
+        RDColX mBases;
+        bool mUniform = false;
+        double mInvDelta = 0.;
+    };
+    
+    // trilinear blending of the corner values c[4 * i + 2 * j + k], where 
+    // i, j, k = 0 / 1 for the lower / upper corner in each dimension and 
+    // w0, w1, w2 are the weights of the lower corners
+    static double blendTrilinear(const double *c, double w0, double w1, double w2) {
+        double c00 = c[0] * w2 + c[1] * (1. - w2);
+        double c01 = c[2] * w2 + c[3] * (1. - w2);
+        double c10 = c[4] * w2 + c[5] * (1. - w2);
+        double c11 = c[6] * w2 + c[7] * (1. - w2);
+        double c0 = c00 * w1 + c01 * (1. - w1);
+        double c1 = c10 * w1 + c11 * (1. - w1);
+        return c0 * w0 + c1 * (1. - w0);
+    };
+    
     // check sorted
     template<class TIN>
     static bool sortedAscending(const TIN &bases) {
@@ -81,6 +118,13 @@ public:
     static RDRowN computeFourierAtPhi(const RDMatXN &data, double phi);
     
     
+    // 64-bit FNV-1a hash, stable across runs and platforms
+    static uint64_t hash(const std::string &bytes, uint64_t seed = 14695981039346656037ULL);
+    static uint64_t hashFile(const std::string &fname);
+    
+    // index of the cell (x, y) along the Hilbert curve of a 2^order grid
+    static uint64_t hilbertIndex(uint32_t x, uint32_t y, int order);
+    
     // memory info for eigen
     template<class EigenMat>
     static std::string eigenMemoryInfo(const std::string &title, const EigenMat &mat) {
@@ -0,0 +1,31 @@
+// XOMP.h
+// created by Kuangdai on 14-Oct-2026
+// openmp interfaces
+
+#pragma once
+
+#ifdef _USE_OPENMP
+    #include <omp.h>
+#endif
+
+class XOMP {
+public:
+    // number of threads available to a parallel region
+    static int nThreads() {
+        #ifdef _USE_OPENMP
+            return omp_get_max_threads();
+        #else
+            return 1;
+        #endif
+    };
+
+    // index of the calling thread, 0 outside parallel regions
+    static int threadID() {
+        #ifdef _USE_OPENMP
+            return omp_get_thread_num();
+        #else
+            return 0;
+        #endif
+    };
+};
+
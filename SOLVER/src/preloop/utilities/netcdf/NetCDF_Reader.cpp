@@ -3,10 +3,12 @@
 // NetCDF Reader
 
 #include "NetCDF_Reader.h"
+#include <algorithm>
 #include <netcdf.h>
 
 #ifdef _USE_PARALLEL_NETCDF
     #include <netcdf_par.h>
+    #include "XMPI.h"
 #endif
 
 void NetCDF_Reader::open(const std::string &fname) {
@@ -23,7 +25,7 @@ void NetCDF_Reader::openParallel(const std::string &fname) {
         close();
         mFileName = fname;
         if (nc_open_par(fname.c_str(), NC_MPIIO | NC_NETCDF4, 
-            MPI_COMM_WORLD, MPI_INFO_NULL, &mFileID) != NC_NOERR) {
+            XMPI::comm(), MPI_INFO_NULL, &mFileID) != NC_NOERR) {
             throw std::runtime_error("NetCDF_Reader::openParallel || "
                 "Error opening NetCDF file: || " + fname);
         }
@@ -41,6 +43,66 @@ void NetCDF_Reader::close() {
     }
 }
 
+void NetCDF_Reader::readDims(const std::string &vname, std::vector<size_t> &dims) const {
+    int var_id = -1;
+    if (nc_inq_varid(mFileID, vname.c_str(), &var_id) != NC_NOERR) {
+        throw std::runtime_error("NetCDF_Reader::readDims || "
+            "Error finding variable: " + vname + " || NetCDF file: " + mFileName);
+    }
+    int var_ndims = -1;
+    netcdfError(nc_inq_varndims(mFileID, var_id, &var_ndims), "nc_inq_varndims");
+    std::vector<int> var_dimids(var_ndims, -1);
+    netcdfError(nc_inq_vardimid(mFileID, var_id, var_dimids.data()), "nc_inq_vardimid");
+    dims.resize(var_ndims);
+    for (int i = 0; i < var_ndims; i++) {
+        netcdfError(nc_inq_dimlen(mFileID, var_dimids[i], &dims[i]), "nc_inq_dimlen");
+    }
+}
+
+void NetCDF_Reader::setChunkCache(const std::string &vname, size_t bytes, size_t nslots) const {
+    int var_id = -1;
+    if (nc_inq_varid(mFileID, vname.c_str(), &var_id) != NC_NOERR) {
+        throw std::runtime_error("NetCDF_Reader::setChunkCache || "
+            "Error finding variable: " + vname + " || NetCDF file: " + mFileName);
+    }
+    // chunks read in full are evicted first
+    netcdfError(nc_set_var_chunk_cache(mFileID, var_id, bytes, nslots, .75), 
+        "nc_set_var_chunk_cache");
+}
+
+void NetCDF_Reader::setDefaultChunkCache(size_t bytes, size_t nslots) {
+    if (nc_set_chunk_cache(bytes, nslots, .75) != NC_NOERR) {
+        throw std::runtime_error("NetCDF_Reader::setDefaultChunkCache || "
+            "Error in NetCDF function: nc_set_chunk_cache");
+    }
+}
+
+bool NetCDF_Reader::hasVariable(const std::string &vname) const {
+    int var_id = -1;
+    return nc_inq_varid(mFileID, vname.c_str(), &var_id) == NC_NOERR;
+}
+
+void NetCDF_Reader::readVariableNames(std::vector<std::string> &names) const {
+    int nvars = -1;
+    netcdfError(nc_inq_nvars(mFileID, &nvars), "nc_inq_nvars");
+    names.clear();
+    char name[NC_MAX_NAME + 1];
+    for (int var_id = 0; var_id < nvars; var_id++) {
+        netcdfError(nc_inq_varname(mFileID, var_id, name), "nc_inq_varname");
+        names.push_back(std::string(name));
+    }
+}
+
+bool NetCDF_Reader::readAttribute(const std::string &vname, const std::string &attname, 
+    double &value) const {
+    int var_id = NC_GLOBAL;
+    if (vname != "" && nc_inq_varid(mFileID, vname.c_str(), &var_id) != NC_NOERR) {
+        throw std::runtime_error("NetCDF_Reader::readAttribute || "
+            "Error finding variable: " + vname + " || NetCDF file: " + mFileName);
+    }
+    return nc_get_att_double(mFileID, var_id, attname.c_str(), &value) == NC_NOERR;
+}
+
 void NetCDF_Reader::readString(const std::string &vname, std::vector<std::string> &data) const {
     // access variable
     int var_id = -1;
@@ -72,7 +134,9 @@ void NetCDF_Reader::readString(const std::string &vname, std::vector<std::string
     
     netcdfError(nc_get_var_text(mFileID, var_id, cstr), "nc_get_var_text");
     for (int i = 0; i < numString; i++) {
-        data.push_back(std::string(&cstr[i * lenString]));
+        // strings filling the length are not null-terminated
+        const char *str = &cstr[i * lenString];
+        data.push_back(std::string(str, std::find(str, str + lenString, '\0')));
     }
     
     delete [] cstr;
@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <cstddef>
 
 class NetCDF_Reader {
 public:    
@@ -41,9 +42,13 @@ public:
             total_len *= dims[i];
         }
         
-        // get data
+        // get data, converted to the type of the container
         data.resize(total_len);
-        netcdfError(nc_get_var(mFileID, var_id, data.data()), "nc_get_var");
+        if (total_len > 0) {
+            const std::vector<size_t> starts(var_ndims, 0);
+            netcdfError(getVars(mFileID, var_id, starts.data(), dims.data(), 0, data.data()), 
+                "nc_get_vars");
+        }
     };
     
     template<class Container>
@@ -60,6 +65,71 @@ public:
         }
     };
     
+    // a contiguous range of a 1D variable
+    template<class Container>
+    void read1D(const std::string &vname, Container &data, size_t start, size_t count) const {
+        int var_id = -1;
+        if (nc_inq_varid(mFileID, vname.c_str(), &var_id) != NC_NOERR) {
+            throw std::runtime_error("NetCDF_Reader::read1D || "
+                "Error finding variable: " + vname + " || NetCDF file: " + mFileName);
+        }
+        int var_ndims = -1;
+        netcdfError(nc_inq_varndims(mFileID, var_id, &var_ndims), "nc_inq_varndims");
+        if (!(var_ndims == 1 || var_ndims == 2)) {
+            throw std::runtime_error("NetCDF_Reader::read1D || "
+                "Variable is not 1D, Variable = " + vname + " || NetCDF file: " + mFileName);
+        }
+        // a 2D variable of 1 row, as written for elemental variables
+        size_t starts[2] = {0, start};
+        size_t counts[2] = {1, count};
+        data.resize(count);
+        if (count > 0) {
+            netcdfError(getVars(mFileID, var_id, starts + 2 - var_ndims, 
+                counts + 2 - var_ndims, 0, data.data()), "nc_get_vars");
+        }
+    };
+    
+    // a hyperslab of an N-D variable, flattened with the last dimension fastest
+    // strides: every so many along each dimension, all ones if empty
+    template<class Container>
+    void readHyperslab(const std::string &vname, Container &data, 
+        const std::vector<size_t> &starts, const std::vector<size_t> &counts,
+        const std::vector<ptrdiff_t> &strides = std::vector<ptrdiff_t>()) const {
+        size_t total_len = 1;
+        for (int i = 0; i < counts.size(); i++) {
+            total_len *= counts[i];
+        }
+        data.resize(total_len);
+        readHyperslab(vname, data.data(), starts, counts, strides);
+    };
+    
+    // the same into a preallocated buffer of the size of the hyperslab, 
+    // converted to the type of the buffer, without allocation
+    template<typename Type>
+    void readHyperslab(const std::string &vname, Type *data, 
+        const std::vector<size_t> &starts, const std::vector<size_t> &counts,
+        const std::vector<ptrdiff_t> &strides = std::vector<ptrdiff_t>()) const {
+        int var_id = -1;
+        if (nc_inq_varid(mFileID, vname.c_str(), &var_id) != NC_NOERR) {
+            throw std::runtime_error("NetCDF_Reader::readHyperslab || "
+                "Error finding variable: " + vname + " || NetCDF file: " + mFileName);
+        }
+        int var_ndims = -1;
+        netcdfError(nc_inq_varndims(mFileID, var_id, &var_ndims), "nc_inq_varndims");
+        if (var_ndims != starts.size() || var_ndims != counts.size() || 
+            (strides.size() > 0 && var_ndims != strides.size())) {
+            throw std::runtime_error("NetCDF_Reader::readHyperslab || "
+                "Inconsistent number of dimensions, Variable = " + vname + " || NetCDF file: " + mFileName);
+        }
+        for (int i = 0; i < var_ndims; i++) {
+            if (counts[i] == 0) {
+                return;
+            }
+        }
+        netcdfError(getVars(mFileID, var_id, starts.data(), counts.data(), 
+            strides.size() > 0 ? strides.data() : 0, data), "nc_get_vars");
+    };
+    
     template<class Container>
     void read2D(const std::string &vname, Container &data) const {
         // read meta data
@@ -84,6 +154,56 @@ public:
         }
     };
     
+    // a range of rows of a 2D variable, for instance the connectivity 
+    // of the elements of a rank; Container can be both RowMajor and ColMajor
+    template<class Container>
+    void read2D(const std::string &vname, Container &data, size_t rowStart, size_t rowCount) const {
+        std::vector<size_t> dims;
+        readDims(vname, dims);
+        if (dims.size() != 2) {
+            throw std::runtime_error("NetCDF_Reader::read2D || "
+                "Variable is not 2D, Variable = " + vname + " || NetCDF file: " + mFileName);
+        }
+        if (rowStart + rowCount > dims[0]) {
+            throw std::runtime_error("NetCDF_Reader::read2D || "
+                "Rows out of range, Variable = " + vname + " || NetCDF file: " + mFileName);
+        }
+        data = Container::Zero(rowCount, dims[1]);
+        if (Container::IsRowMajor) {
+            readHyperslab(vname, data.data(), {rowStart, 0}, {rowCount, dims[1]});
+        } else {
+            std::vector<typename Container::Scalar> mdata;
+            readHyperslab(vname, mdata, {rowStart, 0}, {rowCount, dims[1]});
+            int pos = 0;
+            for (int j = 0; j < rowCount; j++) {
+                for (int k = 0; k < dims[1]; k++) {
+                    data(j, k) = mdata[pos++];
+                }
+            }
+        }
+    };
+    
+    // chunk cache of a chunked variable, in bytes and number of chunk slots, 
+    // for repeated partial reads of a large variable; by default, the 
+    // cache set for the file when it was opened
+    void setChunkCache(const std::string &vname, size_t bytes, size_t nslots = 1009) const;
+    
+    // chunk cache of the variables of the files opened afterwards 
+    static void setDefaultChunkCache(size_t bytes, size_t nslots = 1009);
+    
+    // dimensions of a variable, without reading it
+    void readDims(const std::string &vname, std::vector<size_t> &dims) const;
+    
+    // whether a variable exists
+    bool hasVariable(const std::string &vname) const;
+    
+    // names of all variables in the file
+    void readVariableNames(std::vector<std::string> &names) const;
+    
+    // a numeric attribute of a variable, or global if vname is empty;
+    // false if not found
+    bool readAttribute(const std::string &vname, const std::string &attname, double &value) const;
+    
     // string
     void readString(const std::string &vname, std::vector<std::string> &data) const;
     
@@ -97,6 +217,28 @@ private:
     // error handler
     void netcdfError(const int retval, const std::string &func_name) const;
     
+    // typed reads with conversion; stride null for all ones
+    static int getVars(int fid, int vid, const size_t *starts, const size_t *counts, 
+        const ptrdiff_t *strides, double *data) {
+        return nc_get_vars_double(fid, vid, starts, counts, strides, data);
+    };
+    static int getVars(int fid, int vid, const size_t *starts, const size_t *counts, 
+        const ptrdiff_t *strides, float *data) {
+        return nc_get_vars_float(fid, vid, starts, counts, strides, data);
+    };
+    static int getVars(int fid, int vid, const size_t *starts, const size_t *counts, 
+        const ptrdiff_t *strides, int *data) {
+        return nc_get_vars_int(fid, vid, starts, counts, strides, data);
+    };
+    static int getVars(int fid, int vid, const size_t *starts, const size_t *counts, 
+        const ptrdiff_t *strides, long long *data) {
+        return nc_get_vars_longlong(fid, vid, starts, counts, strides, data);
+    };
+    static int getVars(int fid, int vid, const size_t *starts, const size_t *counts, 
+        const ptrdiff_t *strides, char *data) {
+        return nc_get_vars_text(fid, vid, starts, counts, strides, data);
+    };
+    
 private:
     int mFileID = -1;
     std::string mFileName = "";
@@ -6,6 +6,13 @@
 #include "NetCDF_Writer.h"
 #include <sstream>
 
+#ifdef _USE_PARALLEL_NETCDF
+    #include "XMPI.h"
+#endif
+
+int NetCDF_Writer::sChunkTimeSteps = 0;
+int NetCDF_Writer::sIOAggregators = 0;
+
 void NetCDF_Writer::open(const std::string &fname, bool overwrite) {
     close();
     mFileName = fname;
@@ -28,8 +35,19 @@ void NetCDF_Writer::openParallel(const std::string &fname) {
     #ifdef _USE_PARALLEL_NETCDF
         close();
         mFileName = fname;
-        if (nc_open_par(fname.c_str(),  NC_MPIIO | NC_WRITE | NC_NETCDF4, 
-            MPI_COMM_WORLD, MPI_INFO_NULL, &mFileID) != NC_NOERR) {
+        // MPI-IO hints
+        MPI_Info info = MPI_INFO_NULL;
+        if (sIOAggregators > 0) {
+            MPI_Info_create(&info);
+            MPI_Info_set(info, "cb_nodes", std::to_string(sIOAggregators).c_str());
+            MPI_Info_set(info, "romio_cb_write", "enable");
+        }
+        int retval = nc_open_par(fname.c_str(),  NC_MPIIO | NC_WRITE | NC_NETCDF4, 
+            XMPI::comm(), info, &mFileID);
+        if (info != MPI_INFO_NULL) {
+            MPI_Info_free(&info);
+        }
+        if (retval != NC_NOERR) {
             throw std::runtime_error("NetCDF_Writer::openParallel || "
                 "Error opening NetCDF file: || " + fname);    
         }
@@ -49,6 +67,19 @@ void NetCDF_Writer::close() {
     }
 }
 
+void NetCDF_Writer::deflateVariable(const std::string &vname, int level) const {
+    int varid = inquireVariable(vname);
+    // byte shuffle helps floating-point data
+    netcdfError(nc_def_var_deflate(mPWD, varid, 1, 1, level), "nc_def_var_deflate");
+}
+
+void NetCDF_Writer::chunkVariable(const std::string &vname, 
+    const std::vector<size_t> &chunks) const {
+    int varid = inquireVariable(vname);
+    netcdfError(nc_def_var_chunking(mPWD, varid, NC_CHUNKED, chunks.data()), 
+        "nc_def_var_chunking");
+}
+
 void NetCDF_Writer::writeString(const std::string &vname, const std::string &data) const {
     std::vector<size_t> dims;
     dims.push_back(data.length());
@@ -64,23 +95,21 @@ void NetCDF_Writer::writeString(const std::string &vname, const std::string &dat
     }
 }
 
-// void NetCDF_Writer::writeStringInByte(const std::string &vname, const std::string &data) const {
-//     std::vector<size_t> dims;
-//     dims.push_back(data.length());
-//     defModeOn();
-//     int varid = defineVariable<signed char>(vname, dims);
-//     defModeOff();
-//     if (data.length() > 0) {
-//         std::vector<signed char> buf;
-//         for (int i = 0; i < data.length(); i++) {
-//             buf.push_back((signed char)(data.c_str()[i]));
-//         }
-//         if (nc_put_var(mPWD, varid, buf.data()) != NC_NOERR) {
-//             throw std::runtime_error("NetCDF_Writer::writeStringInByte || "
-//                 "Error writing variable, variable: " + vname + " || NetCDF file: " + mFileName);
-//         }
-//     }
-// }
+void NetCDF_Writer::writeStringInByte(const std::string &vname, const std::string &data) const {
+    std::vector<size_t> dims;
+    dims.push_back(data.length());
+    defModeOn();
+    defineVariable<signed char>(vname, dims);
+    defModeOff();
+    if (data.length() > 0) {
+        std::vector<signed char> buf(data.begin(), data.end());
+        int varid = inquireVariable(vname);
+        if (nc_put_var(mPWD, varid, buf.data()) != NC_NOERR) {
+            throw std::runtime_error("NetCDF_Writer::writeStringInByte || "
+                "Error writing variable, variable: " + vname + " || NetCDF file: " + mFileName);
+        }
+    }
+}
 
 void NetCDF_Writer::createGroup(const std::string &gname) const {
     int grpid = -1;
@@ -11,6 +11,13 @@
 #include <sstream>
 #include <memory>
 #include <typeinfo>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
 
 #ifdef _USE_PARALLEL_NETCDF
     #include <netcdf_par.h>
@@ -101,7 +108,8 @@ public:
     
     // string
     void writeString(const std::string &vname, const std::string &data) const;
-    // void writeStringInByte(const std::string &vname, const std::string &data) const;
+    // string stored as a 1D array of bytes, as ASDF expects for XML documents
+    void writeStringInByte(const std::string &vname, const std::string &data) const;
     
     // create group
     void createGroup(const std::string &gname) const;
@@ -133,6 +141,57 @@ public:
         }
     };
     
+    // lossless compression of a defined variable, 1 to 9, in define mode
+    void deflateVariable(const std::string &vname, int level) const;
+    
+    // chunked storage of a defined variable, in define mode
+    void chunkVariable(const std::string &vname, const std::vector<size_t> &chunks) const;
+    
+    // define a time series [time, ...] stored in chunks of chunkSteps rows,
+    // so that each dump of a buffer touches whole chunks
+    template<class base_type>
+    void defineTimeSeries(const std::string &vname, const std::vector<size_t> &dims, 
+        size_t chunkSteps) const {
+        defineVariable<base_type>(vname, dims);
+        std::vector<size_t> chunks(dims);
+        chunks[0] = std::max((size_t)1, std::min(chunkSteps, dims[0]));
+        chunkVariable(vname, chunks);
+    };
+    
+    // lossy bit rounding: keep the leading nbits of the mantissa and zero
+    // the rest, which then compress well with deflate; the relative error 
+    // is bounded by 2^-(nbits+1)
+    template<class TEigen>
+    static void roundMantissa(TEigen &data, int nbits) {
+        typedef typename TEigen::Scalar T;
+        typedef typename std::conditional<sizeof(T) == 8, uint64_t, uint32_t>::type UInt;
+        const int nmant = std::numeric_limits<T>::digits - 1;
+        if (nbits <= 0 || nbits >= nmant) {
+            return;
+        }
+        const UInt half = (UInt)1 << (nmant - nbits - 1);
+        const UInt mask = ~(((UInt)1 << (nmant - nbits)) - 1);
+        T *ptr = data.data();
+        for (int i = 0; i < data.size(); i++) {
+            if (!std::isfinite(ptr[i])) {
+                continue;
+            }
+            UInt bits;
+            std::memcpy(&bits, ptr + i, sizeof(T));
+            bits = (bits + half) & mask;
+            std::memcpy(ptr + i, &bits, sizeof(T));
+        }
+    };
+    
+    // parallel IO options
+    // time steps per chunk, 0 for one chunk per dump
+    static int sChunkTimeSteps;
+    // number of MPI-IO aggregators, 0 for the MPI default
+    static int sIOAggregators;
+    static size_t chunkTimeSteps(int bufferSize) {
+        return sChunkTimeSteps > 0 ? sChunkTimeSteps : bufferSize;
+    };
+    
     void defModeOn() const {
         netcdfError(nc_redef(mFileID), "nc_redef");
     };
@@ -144,6 +203,12 @@ public:
     void flush() const {
         netcdfError(nc_sync(mFileID), "nc_sync");    
     }
+    
+    // NetCDF is not thread-safe; writers in other threads hold this lock
+    static std::mutex &ioMutex() {
+        static std::mutex sMutex;
+        return sMutex;
+    };
 
 private:
     // type interpreter
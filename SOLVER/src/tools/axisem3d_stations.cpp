@@ -0,0 +1,734 @@
+// axisem3d_stations.cpp
+// created by Kuangdai on 14-Oct-2026
+// extract, rotate and convert station output to ascii, SAC or miniSEED files
+// usage: axisem3d_stations -i FILE [FILE ...] -o DIR [options]; -h for help
+
+#include "NetCDF_Reader.h"
+#include "Geodesy.h"
+#include "global.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <fnmatch.h>
+#include <sys/stat.h>
+
+extern "C" void set_ftz();
+
+namespace {
+    
+    const std::string sUsage =
+    "Extract synthetics from the NetCDF station output of AxiSEM3D\n"
+    "(axisem3d_synthetics.nc or axisem3d_synthetics.nc.rank*), rotate them\n"
+    "and save them as ascii, SAC or miniSEED files, by multiple threads.\n"
+    "\n"
+    "usage: axisem3d_stations -i FILE [FILE ...] -o DIR [options]\n"
+    "  -i FILE [FILE ...]  NetCDF station files created by AxiSEM3D <required>\n"
+    "  -o DIR              directory to store the output files <required>\n"
+    "  -s KEY [KEY ...]    stations to be extracted, given as wildcards of\n"
+    "                      \"Network.Station\"; default = *.* (all stations)\n"
+    "  -r FRAME            frame of the output, RTZ, ENZ or SPZ;\n"
+    "                      default = OUT_STATIONS_COMPONENTS of the run\n"
+    "  -c CHANNELS         channels to be extracted from the frame;\n"
+    "                      default = all three\n"
+    "  -t FORMAT           ascii, sac or mseed; default = ascii\n"
+    "  -e NUMFMT           ascii number format; default = %.6e\n"
+    "  -n FNAMEFMT         output filename format;\n"
+    "                      default = @NW@.@ST@..BH@CH@.<FORMAT>\n"
+    "  -H HEADERFMT        header of each ascii file; default = \"\"\n"
+    "  -F FOOTERFMT        footer of each ascii file; default = \"\"\n"
+    "  -b BAND             band and instrument codes of SAC and miniSEED\n"
+    "                      channels; default = BH\n"
+    "  -q QUANTITY         displ, veloc or accel, as OUT_STATIONS_QUANTITY,\n"
+    "                      for the SAC header; default = unknown\n"
+    "  -T ORIGIN           origin time of the source, as reference of SAC and\n"
+    "                      miniSEED files, YYYY-MM-DDThh:mm:ss[.ffff];\n"
+    "                      default = 1970-01-01T00:00:00\n"
+    "  -f FLATTENING       surface flattening of the mesh, for the epicentral\n"
+    "                      distances and back azimuths used in rotation;\n"
+    "                      default = 0 (spherical)\n"
+    "  -R RADIUS           surface radius of the mesh; default = 6371000\n"
+    "  -p NTHREADS         number of threads; default = number of cores\n"
+    "  -v                  verbose mode\n"
+    "  -h                  print this message\n"
+    "\n"
+    "String replacement rules for filename, header and footer:\n"
+    "  @NW@ -> network name\n"
+    "  @ST@ -> station name\n"
+    "  @CH@ -> channel\n"
+    "  @NS@ -> number of steps\n"
+    "  @DT@ -> time step\n"
+    "  @SR@ -> sampling rate\n"
+    "  @T0@ -> start time w.r.t. source origin\n"
+    "  @T1@ -> end time w.r.t. source origin\n";
+    
+    struct Options {
+        std::vector<std::string> mInputs;
+        std::string mOutput = "";
+        std::vector<std::string> mStations = {"*.*"};
+        std::string mFrame = "";
+        std::string mChannels = "";
+        std::string mFormat = "ascii";
+        std::string mNumberFormat = "%.6e";
+        std::string mFileNameFormat = "";
+        std::string mHeaderFormat = "";
+        std::string mFooterFormat = "";
+        std::string mBand = "BH";
+        std::string mQuantity = "";
+        std::string mOrigin = "1970-01-01T00:00:00";
+        double mFlattening = 0.;
+        double mRadius = 6371e3;
+        int mNumThreads = 0;
+        bool mVerbose = false;
+    };
+    
+    // a station in one of the input files
+    struct StationEntry {
+        int mFile;
+        std::string mVarName;
+        std::string mNetwork, mName, mFrame;
+        double mLat, mLon, mDep;
+        // epicentral distance and back azimuth, in radians
+        double mTheta, mBAz;
+    };
+    
+    // time info shared by all stations
+    struct TimeInfo {
+        int mNumSteps;
+        double mDt, mT0, mT1;
+        // origin as seconds since 1970-01-01T00:00:00
+        double mOriginEpoch;
+    };
+    
+    bool isOption(const std::string &arg) {
+        return arg.length() == 2 && arg[0] == '-' && isalpha(arg[1]);
+    }
+    
+    Options parseOptions(int argc, char *argv[]) {
+        Options opt;
+        std::vector<std::string> args(argv + 1, argv + argc);
+        for (int iarg = 0; iarg < args.size(); iarg++) {
+            const std::string &key = args[iarg];
+            if (!isOption(key)) {
+                throw std::runtime_error("axisem3d_stations || Invalid argument: " + key + ".");
+            }
+            if (key == "-h") {
+                std::cout << sUsage;
+                exit(0);
+            }
+            if (key == "-v") {
+                opt.mVerbose = true;
+                continue;
+            }
+            // values until the next option
+            std::vector<std::string> values;
+            while (iarg + 1 < args.size() && !isOption(args[iarg + 1])) {
+                values.push_back(args[++iarg]);
+            }
+            bool multiple = (key == "-i" || key == "-s");
+            if (values.size() == 0 || (!multiple && values.size() > 1)) {
+                throw std::runtime_error("axisem3d_stations || Invalid values of option " + key + ".");
+            }
+            const std::string &value = values[0];
+            if (key == "-i") {
+                opt.mInputs = values;
+            } else if (key == "-s") {
+                opt.mStations = values;
+            } else if (key == "-o") {
+                opt.mOutput = value;
+            } else if (key == "-r") {
+                opt.mFrame = value;
+            } else if (key == "-c") {
+                opt.mChannels = value;
+            } else if (key == "-t") {
+                opt.mFormat = value;
+            } else if (key == "-e") {
+                opt.mNumberFormat = value;
+            } else if (key == "-n") {
+                opt.mFileNameFormat = value;
+            } else if (key == "-H") {
+                opt.mHeaderFormat = value;
+            } else if (key == "-F") {
+                opt.mFooterFormat = value;
+            } else if (key == "-b") {
+                opt.mBand = value;
+            } else if (key == "-q") {
+                opt.mQuantity = value;
+            } else if (key == "-T") {
+                opt.mOrigin = value;
+            } else if (key == "-f") {
+                opt.mFlattening = std::stod(value);
+            } else if (key == "-R") {
+                opt.mRadius = std::stod(value);
+            } else if (key == "-p") {
+                opt.mNumThreads = std::stoi(value);
+            } else {
+                throw std::runtime_error("axisem3d_stations || Unknown option: " + key + ".");
+            }
+        }
+        
+        // check
+        if (opt.mInputs.size() == 0 || opt.mOutput == "") {
+            throw std::runtime_error("axisem3d_stations || "
+                "Options -i and -o are required; use -h for help.");
+        }
+        if (opt.mFrame != "" && opt.mFrame != "RTZ" && opt.mFrame != "ENZ" && opt.mFrame != "SPZ") {
+            throw std::runtime_error("axisem3d_stations || Invalid frame: " + opt.mFrame + ".");
+        }
+        if (opt.mFormat != "ascii" && opt.mFormat != "sac" && opt.mFormat != "mseed") {
+            throw std::runtime_error("axisem3d_stations || Invalid format: " + opt.mFormat + ".");
+        }
+        if (opt.mQuantity != "" && opt.mQuantity != "displ" &&
+            opt.mQuantity != "veloc" && opt.mQuantity != "accel") {
+            throw std::runtime_error("axisem3d_stations || Invalid quantity: " + opt.mQuantity + ".");
+        }
+        if (opt.mFileNameFormat == "") {
+            opt.mFileNameFormat = "@NW@.@ST@..BH@CH@." + opt.mFormat;
+        }
+        if (opt.mNumThreads <= 0) {
+            opt.mNumThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+        }
+        return opt;
+    }
+    
+    // days since 1970-01-01 of a civil date (H. Hinnant, chrono-compatible
+    // low-level date algorithms)
+    long daysFromCivil(long y, long m, long d) {
+        y -= m <= 2;
+        long era = (y >= 0 ? y : y - 399) / 400;
+        long yoe = y - era * 400;
+        long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+    
+    double parseOrigin(const std::string &origin) {
+        int y, mo, d, h, mi;
+        double s;
+        if (sscanf(origin.c_str(), "%d-%d-%dT%d:%d:%lf", &y, &mo, &d, &h, &mi, &s) != 6) {
+            throw std::runtime_error("axisem3d_stations || Invalid origin time: " + origin + ".");
+        }
+        return daysFromCivil(y, mo, d) * 86400. + h * 3600. + mi * 60. + s;
+    }
+    
+    // broken-down time of epoch seconds, with the fraction in 0.1 ms
+    struct BrokenTime {
+        int mYear, mJDay, mHour, mMin, mSec, mFrac;
+    };
+    
+    BrokenTime breakTime(double epoch) {
+        long frac = std::lround(epoch * 1e4);
+        long secs = frac >= 0 ? frac / 10000 : (frac - 9999) / 10000;
+        BrokenTime bt;
+        bt.mFrac = frac - secs * 10000;
+        long days = secs >= 0 ? secs / 86400 : (secs - 86399) / 86400;
+        long sod = secs - days * 86400;
+        bt.mHour = sod / 3600;
+        bt.mMin = sod % 3600 / 60;
+        bt.mSec = sod % 60;
+        bt.mYear = 1970;
+        while (days < daysFromCivil(bt.mYear, 1, 1)) {
+            bt.mYear--;
+        }
+        while (days >= daysFromCivil(bt.mYear + 1, 1, 1)) {
+            bt.mYear++;
+        }
+        bt.mJDay = days - daysFromCivil(bt.mYear, 1, 1) + 1;
+        return bt;
+    }
+    
+    std::string replaceAll(std::string str, const std::string &from, const std::string &to) {
+        for (size_t pos = str.find(from); pos != std::string::npos;
+            pos = str.find(from, pos + to.length())) {
+            str.replace(pos, from.length(), to);
+        }
+        return str;
+    }
+    
+    std::string toString(double value) {
+        std::stringstream ss;
+        ss.precision(10);
+        ss << value;
+        return ss.str();
+    }
+    
+    // replace the time keys
+    std::string replaceTime(const std::string &fmt, const TimeInfo &ti) {
+        std::string str = replaceAll(fmt, "@NS@", std::to_string(ti.mNumSteps));
+        str = replaceAll(str, "@DT@", ti.mNumSteps > 1 ? toString(ti.mDt) : "n.a.");
+        str = replaceAll(str, "@SR@", ti.mNumSteps > 1 ? toString(1. / ti.mDt) : "n.a.");
+        str = replaceAll(str, "@T0@", toString(ti.mT0));
+        return replaceAll(str, "@T1@", toString(ti.mT1));
+    }
+    
+    // replace the station keys
+    std::string replaceStation(const std::string &fmt, const StationEntry &st, char channel) {
+        std::string str = replaceAll(fmt, "@NW@", st.mNetwork);
+        str = replaceAll(str, "@ST@", st.mName);
+        return replaceAll(str, "@CH@", std::string(1, channel));
+    }
+    
+    // rotate a row-major nt x 3 wave from the frame of the station to a frame,
+    // through RTZ; the same transforms as PointwiseRecorder
+    void rotate(std::vector<double> &wave, const StationEntry &st, const std::string &frame) {
+        if (frame == st.mFrame) {
+            return;
+        }
+        double cost = cos(st.mTheta), sint = sin(st.mTheta);
+        double cosbaz = cos(st.mBAz), sinbaz = sin(st.mBAz);
+        for (size_t pos = 0; pos < wave.size(); pos += 3) {
+            double a = wave[pos], b = wave[pos + 1], c = wave[pos + 2];
+            // to RTZ
+            double r, t, z;
+            if (st.mFrame == "SPZ") {
+                r = a * cost - c * sint;
+                t = b;
+                z = a * sint + c * cost;
+            } else if (st.mFrame == "ENZ") {
+                r = -a * sinbaz - b * cosbaz;
+                t = a * cosbaz - b * sinbaz;
+                z = c;
+            } else {
+                r = a; t = b; z = c;
+            }
+            // from RTZ
+            if (frame == "SPZ") {
+                wave[pos] = r * cost + z * sint;
+                wave[pos + 1] = t;
+                wave[pos + 2] = -r * sint + z * cost;
+            } else if (frame == "ENZ") {
+                wave[pos] = -r * sinbaz + t * cosbaz;
+                wave[pos + 1] = -r * cosbaz - t * sinbaz;
+                wave[pos + 2] = z;
+            } else {
+                wave[pos] = r; wave[pos + 1] = t; wave[pos + 2] = z;
+            }
+        }
+    }
+    
+    ////////////////////////////// ascii //////////////////////////////
+    void writeAscii(const std::string &fname, const std::vector<double> &wave, int dim,
+        const std::string &header, const std::string &footer, const std::string &numfmt) {
+        std::ofstream fs(fname);
+        if (!fs) {
+            throw std::runtime_error("axisem3d_stations || Error opening file: " + fname + ".");
+        }
+        if (header != "") {
+            fs << header << "\n";
+        }
+        char buffer[64];
+        for (size_t pos = dim; pos < wave.size(); pos += 3) {
+            snprintf(buffer, sizeof(buffer), numfmt.c_str(), wave[pos]);
+            fs << buffer << "\n";
+        }
+        if (footer != "") {
+            fs << footer << "\n";
+        }
+    }
+    
+    ////////////////////////////// SAC //////////////////////////////
+    // SAC header version 6, in the native byte order
+    void writeSAC(const std::string &fname, const std::vector<double> &wave, int dim,
+        const StationEntry &st, const std::string &frame, char channel,
+        const TimeInfo &ti, const Options &opt, double srcLat, double srcLon, double srcDep) {
+        float fh[70];
+        int32_t ih[40];
+        char ch[192];
+        std::fill(fh, fh + 70, -12345.f);
+        std::fill(ih, ih + 40, -12345);
+        for (int i = 0; i < 192; i += 8) {
+            memcpy(ch + i, "-12345  ", 8);
+        }
+        
+        // data
+        int npts = ti.mNumSteps;
+        std::vector<float> data(npts);
+        double sum = 0.;
+        for (int it = 0; it < npts; it++) {
+            data[it] = (float)wave[it * 3 + dim];
+            sum += data[it];
+        }
+        
+        // floats
+        fh[0] = ti.mDt;
+        fh[1] = npts > 0 ? *std::min_element(data.begin(), data.end()) : 0.f;
+        fh[2] = npts > 0 ? *std::max_element(data.begin(), data.end()) : 0.f;
+        fh[5] = ti.mT0;
+        fh[6] = ti.mT1;
+        fh[7] = 0.f;
+        fh[31] = st.mLat;
+        fh[32] = st.mLon;
+        fh[34] = st.mDep;
+        fh[35] = srcLat;
+        fh[36] = srcLon;
+        fh[38] = srcDep / 1e3;
+        fh[50] = st.mTheta * opt.mRadius / 1e3;
+        fh[52] = st.mBAz / degree;
+        fh[53] = st.mTheta / degree;
+        fh[56] = npts > 0 ? sum / npts : 0.f;
+        // orientation in the local frames
+        double baz = st.mBAz / degree;
+        if (channel == 'Z' && frame != "SPZ") {
+            fh[57] = 0.f; fh[58] = 0.f;
+        } else if (channel == 'N') {
+            fh[57] = 0.f; fh[58] = 90.f;
+        } else if (channel == 'E') {
+            fh[57] = 90.f; fh[58] = 90.f;
+        } else if (channel == 'R') {
+            fh[57] = fmod(baz + 180., 360.); fh[58] = 90.f;
+        } else if (channel == 'T' || (channel == 'P' && frame == "SPZ")) {
+            fh[57] = fmod(baz + 90., 360.); fh[58] = 90.f;
+        }
+        
+        // integers, referred to the origin
+        BrokenTime bt = breakTime(ti.mOriginEpoch);
+        ih[0] = bt.mYear;
+        ih[1] = bt.mJDay;
+        ih[2] = bt.mHour;
+        ih[3] = bt.mMin;
+        ih[4] = bt.mSec;
+        ih[5] = bt.mFrac / 10;
+        ih[6] = 6;
+        ih[9] = npts;
+        // time series, origin as reference
+        ih[15] = 1;
+        ih[17] = 11;
+        // dependent variable: unknown, displacement, velocity, acceleration
+        ih[16] = 5;
+        if (opt.mQuantity == "displ") {
+            ih[16] = 6;
+        } else if (opt.mQuantity == "veloc") {
+            ih[16] = 7;
+        } else if (opt.mQuantity == "accel") {
+            ih[16] = 8;
+        }
+        // evenly spaced, polarity and distances computed here
+        ih[35] = 1;
+        ih[36] = 0;
+        ih[37] = 1;
+        ih[38] = 0;
+        
+        // strings, blank-padded
+        auto setString = [&ch](int offset, int length, const std::string &str) {
+            std::fill(ch + offset, ch + offset + length, ' ');
+            memcpy(ch + offset, str.c_str(), std::min((int)str.length(), length));
+        };
+        setString(0, 8, st.mName);
+        setString(160, 8, opt.mBand + channel);
+        setString(168, 8, st.mNetwork);
+        
+        std::ofstream fs(fname, std::ios::binary);
+        if (!fs) {
+            throw std::runtime_error("axisem3d_stations || Error opening file: " + fname + ".");
+        }
+        fs.write((char *)fh, sizeof(fh));
+        fs.write((char *)ih, sizeof(ih));
+        fs.write(ch, sizeof(ch));
+        fs.write((char *)data.data(), npts * sizeof(float));
+    }
+    
+    ////////////////////////////// miniSEED //////////////////////////////
+    // big-endian writes into a record
+    void putBE(std::vector<unsigned char> &rec, int offset, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            rec[offset + i] = (value >> (8 * (bytes - 1 - i))) & 0xff;
+        }
+    }
+    
+    void putString(std::vector<unsigned char> &rec, int offset, int length, const std::string &str) {
+        for (int i = 0; i < length; i++) {
+            rec[offset + i] = i < str.length() ? str[i] : ' ';
+        }
+    }
+    
+    // SEED sample rate factor and multiplier nearest to a rate,
+    // the exact rate being given in blockette 100
+    void rateFactor(double rate, int16_t &factor, int16_t &multiplier) {
+        double value = rate >= 1. ? rate : 1. / rate;
+        int scale = 1;
+        while (scale < 10000 && std::round(value * scale * 10) <= 32767) {
+            scale *= 10;
+        }
+        int nearest = std::max((int)std::round(value * scale), 1);
+        if (rate >= 1.) {
+            // rate = factor / -multiplier
+            factor = nearest;
+            multiplier = -scale;
+        } else {
+            // rate = multiplier / -factor
+            factor = -nearest;
+            multiplier = scale;
+        }
+    }
+    
+    // records of 4096 bytes, float32 big-endian (data encoding 4),
+    // with blockettes 1000 and 100
+    void writeMiniSEED(const std::string &fname, const std::vector<double> &wave, int dim,
+        const StationEntry &st, char channel, const TimeInfo &ti, const Options &opt) {
+        const int recordLength = 4096;
+        const int dataOffset = 128;
+        const int samplesPerRecord = (recordLength - dataOffset) / 4;
+        std::ofstream fs(fname, std::ios::binary);
+        if (!fs) {
+            throw std::runtime_error("axisem3d_stations || Error opening file: " + fname + ".");
+        }
+        int16_t factor, multiplier;
+        double rate = 1. / ti.mDt;
+        rateFactor(rate, factor, multiplier);
+        float rate32 = rate;
+        uint32_t rateBits;
+        memcpy(&rateBits, &rate32, 4);
+        std::vector<unsigned char> rec(recordLength);
+        int nrec = (ti.mNumSteps + samplesPerRecord - 1) / samplesPerRecord;
+        for (int irec = 0; irec < nrec; irec++) {
+            int first = irec * samplesPerRecord;
+            int nsamp = std::min(samplesPerRecord, ti.mNumSteps - first);
+            std::fill(rec.begin(), rec.end(), 0);
+            // fixed header
+            char seq[8];
+            snprintf(seq, sizeof(seq), "%06d", (irec + 1) % 1000000);
+            putString(rec, 0, 6, seq);
+            rec[6] = 'D';
+            rec[7] = ' ';
+            putString(rec, 8, 5, st.mName);
+            putString(rec, 13, 2, "");
+            putString(rec, 15, 3, opt.mBand + channel);
+            putString(rec, 18, 2, st.mNetwork);
+            BrokenTime bt = breakTime(ti.mOriginEpoch + ti.mT0 + first * ti.mDt);
+            putBE(rec, 20, bt.mYear, 2);
+            putBE(rec, 22, bt.mJDay, 2);
+            rec[24] = bt.mHour;
+            rec[25] = bt.mMin;
+            rec[26] = bt.mSec;
+            putBE(rec, 28, bt.mFrac, 2);
+            putBE(rec, 30, nsamp, 2);
+            putBE(rec, 32, (uint16_t)factor, 2);
+            putBE(rec, 34, (uint16_t)multiplier, 2);
+            rec[39] = 2;
+            putBE(rec, 44, dataOffset, 2);
+            putBE(rec, 46, 48, 2);
+            // blockette 1000
+            putBE(rec, 48, 1000, 2);
+            putBE(rec, 50, 56, 2);
+            rec[52] = 4;
+            rec[53] = 1;
+            rec[54] = 12;
+            // blockette 100
+            putBE(rec, 56, 100, 2);
+            putBE(rec, 58, 0, 2);
+            putBE(rec, 60, rateBits, 4);
+            // data
+            for (int i = 0; i < nsamp; i++) {
+                float value = wave[(first + i) * 3 + dim];
+                uint32_t bits;
+                memcpy(&bits, &value, 4);
+                putBE(rec, dataOffset + i * 4, bits, 4);
+            }
+            fs.write((char *)rec.data(), recordLength);
+        }
+    }
+    
+    ////////////////////////////// stations //////////////////////////////
+    // stations in the input files matching the keys
+    std::vector<StationEntry> findStations(const std::vector<NetCDF_Reader> &readers,
+        const Options &opt, double srcLat, double srcLon, double srcDep) {
+        std::vector<StationEntry> stations;
+        for (int ifile = 0; ifile < readers.size(); ifile++) {
+            std::vector<std::string> names;
+            readers[ifile].readVariableNames(names);
+            for (const std::string &var: names) {
+                // NW.ST.<frame>; strain and curl have one more field
+                size_t dot1 = var.find('.');
+                size_t dot2 = dot1 == std::string::npos ? dot1 : var.find('.', dot1 + 1);
+                if (dot2 == std::string::npos || var.find('.', dot2 + 1) != std::string::npos) {
+                    continue;
+                }
+                StationEntry st;
+                st.mFile = ifile;
+                st.mVarName = var;
+                st.mNetwork = var.substr(0, dot1);
+                st.mName = var.substr(dot1 + 1, dot2 - dot1 - 1);
+                st.mFrame = var.substr(dot2 + 1);
+                if (st.mFrame != "RTZ" && st.mFrame != "ENZ" && st.mFrame != "SPZ") {
+                    continue;
+                }
+                std::string key = st.mNetwork + "." + st.mName;
+                bool match = false;
+                for (const std::string &pattern: opt.mStations) {
+                    if (fnmatch(pattern.c_str(), key.c_str(), 0) == 0) {
+                        match = true;
+                        break;
+                    }
+                }
+                if (!match) {
+                    continue;
+                }
+                
+                // location, as in Receiver
+                if (!readers[ifile].readAttribute(var, "latitude", st.mLat) ||
+                    !readers[ifile].readAttribute(var, "longitude", st.mLon) ||
+                    !readers[ifile].readAttribute(var, "depth", st.mDep)) {
+                    throw std::runtime_error("axisem3d_stations || "
+                        "Station location not found, Variable = " + var + ".");
+                }
+                RDCol3 rtpG;
+                rtpG(0) = 1.;
+                rtpG(1) = Geodesy::lat2Theta_d(st.mLat, st.mDep);
+                rtpG(2) = Geodesy::lon2Phi(st.mLon);
+                st.mTheta = Geodesy::rotateGlob2Src(rtpG, srcLat, srcLon, srcDep)(1);
+                st.mBAz = Geodesy::backAzimuth(srcLat, srcLon, srcDep, st.mLat, st.mLon, st.mDep);
+                stations.push_back(st);
+            }
+        }
+        return stations;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    
+    // denormal float handling
+    set_ftz();
+    
+    try {
+        Options opt = parseOptions(argc, argv);
+        
+        // geometry for rotation, with a constant flattening
+        RDColX knots(2), coeffs(2);
+        knots << 0., 2.;
+        coeffs << 1., 1.;
+        Geodesy::setup(opt.mRadius, opt.mFlattening, knots, coeffs);
+        
+        // open files
+        std::vector<NetCDF_Reader> readers(opt.mInputs.size());
+        for (int ifile = 0; ifile < opt.mInputs.size(); ifile++) {
+            readers[ifile].open(opt.mInputs[ifile]);
+        }
+        
+        // source
+        double srcLat = 0., srcLon = 0., srcDep = 0.;
+        readers[0].readAttribute("", "source_latitude", srcLat);
+        readers[0].readAttribute("", "source_longitude", srcLon);
+        readers[0].readAttribute("", "source_depth", srcDep);
+        
+        // time
+        TimeInfo ti;
+        std::vector<double> times;
+        readers[0].read1D("time_points", times);
+        ti.mNumSteps = times.size();
+        if (ti.mNumSteps == 0) {
+            throw std::runtime_error("axisem3d_stations || Zero time steps.");
+        }
+        ti.mDt = ti.mNumSteps > 1 ? times[1] - times[0] : 0.;
+        ti.mT0 = times.front();
+        ti.mT1 = times.back();
+        ti.mOriginEpoch = parseOrigin(opt.mOrigin);
+        if (opt.mFormat != "ascii" && ti.mNumSteps < 2) {
+            throw std::runtime_error("axisem3d_stations || "
+                "SAC and miniSEED need at least two time steps.");
+        }
+        
+        // stations
+        const std::vector<StationEntry> &stations = findStations(readers, opt, srcLat, srcLon, srcDep);
+        if (opt.mVerbose) {
+            std::cout << "--- Time info ---" << std::endl;
+            std::cout << "Number of steps: " << ti.mNumSteps << std::endl;
+            std::cout << "Time step: " << ti.mDt << std::endl;
+            std::cout << "Start time: " << ti.mT0 << std::endl;
+            std::cout << "End time: " << ti.mT1 << std::endl << std::endl;
+            std::cout << "--- Extracting Waveforms at " << stations.size() << " Stations by "
+                << std::min(opt.mNumThreads, (int)stations.size()) << " Threads ---" << std::endl;
+        }
+        mkdir(opt.mOutput.c_str(), 0777);
+        const std::string &fnameFmt = replaceTime(opt.mFileNameFormat, ti);
+        const std::string &headerFmt = replaceTime(opt.mHeaderFormat, ti);
+        const std::string &footerFmt = replaceTime(opt.mFooterFormat, ti);
+        
+        // workers take the next station; NetCDF is not thread-safe,
+        // so only the reads are serialized
+        std::mutex ncMutex, coutMutex;
+        std::atomic<int> nextStation(0);
+        std::string error = "";
+        auto work = [&]() {
+            std::vector<double> wave;
+            std::vector<size_t> dims;
+            while (true) {
+                int ist = nextStation++;
+                if (ist >= stations.size()) {
+                    return;
+                }
+                const StationEntry &st = stations[ist];
+                try {
+                    {
+                        std::lock_guard<std::mutex> lock(ncMutex);
+                        if (error != "") {
+                            return;
+                        }
+                        readers[st.mFile].readMetaData(st.mVarName, wave, dims);
+                    }
+                    if (dims.size() != 2 || dims[0] != ti.mNumSteps || dims[1] != 3) {
+                        throw std::runtime_error("axisem3d_stations || "
+                            "Inconsistent dimensions, Variable = " + st.mVarName + ".");
+                    }
+                    std::string frame = opt.mFrame == "" ? st.mFrame : opt.mFrame;
+                    rotate(wave, st, frame);
+                    std::string channels = opt.mChannels == "" ? frame : opt.mChannels;
+                    for (char channel: channels) {
+                        size_t dim = frame.find(channel);
+                        if (dim == std::string::npos) {
+                            continue;
+                        }
+                        std::string fname = opt.mOutput + "/" + replaceStation(fnameFmt, st, channel);
+                        if (opt.mFormat == "ascii") {
+                            writeAscii(fname, wave, dim, replaceStation(headerFmt, st, channel),
+                                replaceStation(footerFmt, st, channel), opt.mNumberFormat);
+                        } else if (opt.mFormat == "sac") {
+                            writeSAC(fname, wave, dim, st, frame, channel, ti, opt,
+                                srcLat, srcLon, srcDep);
+                        } else {
+                            writeMiniSEED(fname, wave, dim, st, channel, ti, opt);
+                        }
+                        if (opt.mVerbose) {
+                            std::lock_guard<std::mutex> lock(coutMutex);
+                            std::cout << "Done with " << opt.mFormat << " file = " << fname
+                                << "; no. station = " << ist + 1 << " / " << stations.size() << std::endl;
+                        }
+                    }
+                } catch (const std::exception &e) {
+                    std::lock_guard<std::mutex> lock(ncMutex);
+                    if (error == "") {
+                        error = e.what();
+                    }
+                    return;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int ithread = 0; ithread < std::min(opt.mNumThreads, (int)stations.size()); ithread++) {
+            threads.push_back(std::thread(work));
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        for (auto &reader: readers) {
+            reader.close();
+        }
+        if (error != "") {
+            throw std::runtime_error(error);
+        }
+    
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
+
@@ -0,0 +1,549 @@
+// axisem3d_surface2stations.cpp
+// created by Kuangdai on 14-Oct-2026
+// synthesize stations from the surface wavefield, by edges in parallel
+// usage: axisem3d_surface2stations -i FILE [FILE ...] -o FILE -s FILE [options]; -h for help
+
+#include "NetCDF_Reader.h"
+#include "NetCDF_Writer.h"
+#include "Geodesy.h"
+#include "XMath.h"
+#include "global.h"
+#include "eigenc.h"
+#include "eigenp.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+extern "C" void set_ftz();
+
+namespace {
+    
+    const std::string sUsage =
+    "Extract synthetics at given stations from the surface wavefield created by\n"
+    "AxiSEM3D (axisem3d_surface.nc or axisem3d_surface.nc.rank*) and save them\n"
+    "into a NetCDF waveform database, the same as axisem3d_synthetics.nc.\n"
+    "Stations on the same surface edge are synthesized in one pass; edges are\n"
+    "processed by multiple threads, reading the time steps in chunks.\n"
+    "\n"
+    "usage: axisem3d_surface2stations -i FILE [FILE ...] -o FILE -s FILE [options]\n"
+    "  -i FILE [FILE ...]  NetCDF surface wavefield created by AxiSEM3D <required>\n"
+    "  -o FILE             NetCDF waveform database to store the synthetics <required>\n"
+    "  -s FILE             list of stations, see OUT_STATIONS_FILE in\n"
+    "                      inparam.time_src_recv <required>\n"
+    "  -r CRDSYS           geographic or source-centered, see OUT_STATIONS_SYSTEM;\n"
+    "                      default = geographic\n"
+    "  -d DUPLICATED       ignore, rename or error, see OUT_STATIONS_DUPLICATED;\n"
+    "                      default = rename\n"
+    "  -c COMPONENTS       RTZ, ENZ or SPZ, see OUT_STATIONS_COMPONENTS;\n"
+    "                      default = RTZ\n"
+    "  -F ORDER            only compute the specified Fourier order;\n"
+    "                      default = -1 (sum up all the orders)\n"
+    "  -f RE [IM]          factor to scale the Fourier coefficients;\n"
+    "                      default = 1 0\n"
+    "  -l LAT LON          source latitude and longitude;\n"
+    "                      default = those in the solver\n"
+    "  -n NSTEPS           time steps read at once; default = 1000\n"
+    "  -p NTHREADS         number of threads; default = number of cores\n"
+    "  -v                  verbose mode\n"
+    "  -h                  print this message\n"
+    "\n"
+    "One may further use axisem3d_stations to convert the output into\n"
+    "ascii, SAC or miniSEED files.\n";
+    
+    struct Options {
+        std::vector<std::string> mInputs;
+        std::string mOutput = "";
+        std::string mStationFile = "";
+        bool mGeographic = true;
+        std::string mDuplicated = "rename";
+        std::string mComponents = "RTZ";
+        int mOrder = -1;
+        ComplexD mFactor = 1.;
+        bool mUserSource = false;
+        double mSrcLat = 0., mSrcLon = 0.;
+        int mChunkSteps = 1000;
+        int mNumThreads = 0;
+        bool mVerbose = false;
+    };
+    
+    // a station on the surface
+    struct SurfaceStation {
+        std::string mNetwork, mName;
+        double mLat, mLon;
+        // source-centered, in radians
+        double mDist, mAzimuth, mBAz;
+    };
+    
+    // a surface edge with stations
+    struct EdgeStations {
+        int mTag;
+        int mFile;
+        std::vector<int> mStations;
+    };
+    
+    bool isOption(const std::string &arg) {
+        return arg.length() == 2 && arg[0] == '-' && isalpha(arg[1]);
+    }
+    
+    Options parseOptions(int argc, char *argv[]) {
+        Options opt;
+        std::vector<std::string> args(argv + 1, argv + argc);
+        for (int iarg = 0; iarg < args.size(); iarg++) {
+            const std::string &key = args[iarg];
+            if (!isOption(key)) {
+                throw std::runtime_error("axisem3d_surface2stations || Invalid argument: " + key + ".");
+            }
+            if (key == "-h") {
+                std::cout << sUsage;
+                exit(0);
+            }
+            if (key == "-v") {
+                opt.mVerbose = true;
+                continue;
+            }
+            // values until the next option; negative numbers are values
+            std::vector<std::string> values;
+            while (iarg + 1 < args.size() && !isOption(args[iarg + 1])) {
+                values.push_back(args[++iarg]);
+            }
+            int nvalues = (key == "-i") ? -1 : ((key == "-l") ? 2 : ((key == "-f") ? 0 : 1));
+            if (values.size() == 0 || (nvalues > 0 && values.size() != nvalues) ||
+                (key == "-f" && values.size() > 2)) {
+                throw std::runtime_error("axisem3d_surface2stations || "
+                    "Invalid values of option " + key + ".");
+            }
+            const std::string &value = values[0];
+            if (key == "-i") {
+                opt.mInputs = values;
+            } else if (key == "-o") {
+                opt.mOutput = value;
+            } else if (key == "-s") {
+                opt.mStationFile = value;
+            } else if (key == "-r") {
+                if (value != "geographic" && value != "source-centered") {
+                    throw std::runtime_error("axisem3d_surface2stations || "
+                        "Invalid coordinate system: " + value + ".");
+                }
+                opt.mGeographic = (value == "geographic");
+            } else if (key == "-d") {
+                if (value != "ignore" && value != "rename" && value != "error") {
+                    throw std::runtime_error("axisem3d_surface2stations || "
+                        "Invalid duplicated option: " + value + ".");
+                }
+                opt.mDuplicated = value;
+            } else if (key == "-c") {
+                if (value != "RTZ" && value != "ENZ" && value != "SPZ") {
+                    throw std::runtime_error("axisem3d_surface2stations || "
+                        "Invalid components: " + value + ".");
+                }
+                opt.mComponents = value;
+            } else if (key == "-F") {
+                opt.mOrder = std::stoi(value);
+            } else if (key == "-f") {
+                opt.mFactor = ComplexD(std::stod(value), values.size() > 1 ? std::stod(values[1]) : 0.);
+            } else if (key == "-l") {
+                opt.mUserSource = true;
+                opt.mSrcLat = std::stod(values[0]);
+                opt.mSrcLon = std::stod(values[1]);
+            } else if (key == "-n") {
+                opt.mChunkSteps = std::max(std::stoi(value), 1);
+            } else if (key == "-p") {
+                opt.mNumThreads = std::stoi(value);
+            } else {
+                throw std::runtime_error("axisem3d_surface2stations || Unknown option: " + key + ".");
+            }
+        }
+        if (opt.mInputs.size() == 0 || opt.mOutput == "" || opt.mStationFile == "") {
+            throw std::runtime_error("axisem3d_surface2stations || "
+                "Options -i, -o and -s are required; use -h for help.");
+        }
+        if (opt.mNumThreads <= 0) {
+            opt.mNumThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+        }
+        return opt;
+    }
+    
+    // stations as in ReceiverCollection, at the surface
+    std::vector<SurfaceStation> readStations(const Options &opt,
+        double srcLat, double srcLon, double srcDep) {
+        std::ifstream fs(opt.mStationFile);
+        if (!fs) {
+            throw std::runtime_error("axisem3d_surface2stations || "
+                "Error opening station data file " + opt.mStationFile + ".");
+        }
+        std::vector<SurfaceStation> stations;
+        std::vector<double> theta, phi;
+        std::set<std::string> keys;
+        int buried = 0;
+        std::string line;
+        while (getline(fs, line)) {
+            std::istringstream ss(line);
+            std::string name, network, elevation;
+            double crd0, crd1, depth;
+            if (!(ss >> name >> network >> crd0 >> crd1 >> elevation >> depth)) {
+                // simply ignore invalid lines
+                continue;
+            }
+            if (depth > 0.) {
+                buried++;
+            }
+            std::string key = network + "." + name;
+            if (keys.find(key) != keys.end()) {
+                if (opt.mDuplicated == "ignore") {
+                    continue;
+                } else if (opt.mDuplicated == "error") {
+                    throw std::runtime_error("axisem3d_surface2stations || "
+                        "Duplicated station keys found in station data file " + opt.mStationFile +
+                        " || Name = " + name + "; Network = " + network);
+                }
+                int append = 0;
+                std::string nameOriginal = name;
+                while (keys.find(key) != keys.end()) {
+                    name = nameOriginal + "__DUPLICATED" + std::to_string(++append);
+                    key = network + "." + name;
+                }
+            }
+            keys.insert(key);
+            SurfaceStation st;
+            st.mNetwork = network;
+            st.mName = name;
+            stations.push_back(st);
+            theta.push_back(crd0);
+            phi.push_back(crd1);
+        }
+        if (buried > 0) {
+            std::cout << "Warning: Ignoring buried depth of " << buried << " stations." << std::endl;
+        }
+        
+        // coordinates in both frames, rotated in bulk
+        int nst = stations.size();
+        RDMatX3 rtpG(nst, 3), rtpS(nst, 3);
+        for (int ist = 0; ist < nst; ist++) {
+            if (opt.mGeographic) {
+                rtpG(ist, 0) = 1.;
+                rtpG(ist, 1) = Geodesy::lat2Theta_d(theta[ist], 0.);
+                rtpG(ist, 2) = Geodesy::lon2Phi(phi[ist]);
+            } else {
+                rtpS(ist, 0) = 1.;
+                rtpS(ist, 1) = theta[ist] * degree;
+                rtpS(ist, 2) = phi[ist] * degree;
+            }
+        }
+        const SourceRotation rotation(srcLat, srcLon, srcDep);
+        if (opt.mGeographic) {
+            rtpS = rtpG;
+            rotation.glob2Src(rtpS);
+        } else {
+            rtpG = rtpS;
+            rotation.src2Glob(rtpG);
+        }
+        const RDColX &baz = rotation.backAzimuth(rtpG.col(1), rtpG.col(2));
+        for (int ist = 0; ist < nst; ist++) {
+            stations[ist].mLat = Geodesy::theta2Lat_d(rtpG(ist, 1), 0.);
+            stations[ist].mLon = Geodesy::phi2Lon(rtpG(ist, 2));
+            stations[ist].mDist = rtpS(ist, 1);
+            stations[ist].mAzimuth = rtpS(ist, 2);
+            stations[ist].mBAz = baz(ist);
+        }
+        return stations;
+    }
+    
+    // flattening of the surface and at the source, linear in between
+    void setupGeodesy(double radius, double surfFlattening, double srcFlattening, double srcDep) {
+        double rs = (radius - srcDep) / radius;
+        RDColX knots, coeffs;
+        if (surfFlattening > 0. && rs > 0. && rs < 1.) {
+            double cs = srcFlattening / surfFlattening;
+            knots = RDColX(4);
+            coeffs = RDColX(4);
+            knots << 0., rs, 1., 2.;
+            coeffs << cs, cs, 1., 1.;
+        } else {
+            knots = RDColX(2);
+            coeffs = RDColX(2);
+            knots << 0., 2.;
+            coeffs << 1., 1.;
+        }
+        Geodesy::setup(radius, surfFlattening, knots, coeffs);
+    }
+    
+    // interpolation along an edge and the Fourier sum, as real and imaginary
+    // parts of a (npnt * nu1) x nst matrix; f = c0 + 2 Re sum c_k exp(i k phi)
+    void formWeights(const std::vector<SurfaceStation> &stations, const std::vector<int> &ists,
+        const RDMatXX_RM &theta, const std::vector<double> &GLL, const std::vector<double> &GLJ,
+        int tag, int nu1, const Options &opt, RDMatXX &weightsR, RDMatXX &weightsI) {
+        int npnt = GLL.size();
+        int nst = ists.size();
+        double theta0 = theta(tag, 0);
+        double theta1 = theta(tag, 1);
+        double tmin = std::min(theta0, theta1);
+        double tmax = std::max(theta0, theta1);
+        bool axial = tmin < tinyDouble || tmax > pi - tinyDouble;
+        const std::vector<double> &bases = axial ? GLJ : GLL;
+        weightsR = weightsI = RDMatXX::Zero(npnt * nu1, nst);
+        std::vector<double> lag(npnt);
+        for (int jst = 0; jst < nst; jst++) {
+            const SurfaceStation &st = stations[ists[jst]];
+            double eta = (st.mDist - theta0) / (theta1 - theta0) * 2. - 1.;
+            XMath::interpLagrange(eta, npnt, bases.data(), lag.data());
+            for (int inu = 0; inu < nu1; inu++) {
+                if (opt.mOrder >= 0 && inu != opt.mOrder) {
+                    continue;
+                }
+                ComplexD phase = (inu == 0 ? 1. : 2.) * exp(ComplexD(0., inu * st.mAzimuth)) * opt.mFactor;
+                for (int ipnt = 0; ipnt < npnt; ipnt++) {
+                    weightsR(ipnt * nu1 + inu, jst) = lag[ipnt] * phase.real();
+                    weightsI(ipnt * nu1 + inu, jst) = lag[ipnt] * phase.imag();
+                }
+            }
+        }
+    }
+    
+    // SPZ to the components, as in PointwiseRecorder
+    RMatXX_RM rotate(const RDMatX3 &spz, const SurfaceStation &st, const std::string &components) {
+        RMatXX_RM disp(spz.rows(), 3);
+        if (components == "SPZ") {
+            disp = spz.cast<Real>();
+            return disp;
+        }
+        double cost = cos(st.mDist), sint = sin(st.mDist);
+        double cosbaz = cos(st.mBAz), sinbaz = sin(st.mBAz);
+        for (int it = 0; it < spz.rows(); it++) {
+            double ur = spz(it, 0) * sint + spz(it, 2) * cost;
+            double ut = spz(it, 0) * cost - spz(it, 2) * sint;
+            if (components == "ENZ") {
+                disp(it, 0) = -ut * sinbaz + spz(it, 1) * cosbaz;
+                disp(it, 1) = -ut * cosbaz - spz(it, 1) * sinbaz;
+                disp(it, 2) = ur;
+            } else {
+                disp(it, 0) = ut;
+                disp(it, 1) = spz(it, 1);
+                disp(it, 2) = ur;
+            }
+        }
+        return disp;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    
+    // denormal float handling
+    set_ftz();
+    
+    try {
+        Options opt = parseOptions(argc, argv);
+        
+        // open files and find the edges
+        std::vector<NetCDF_Reader> readers(opt.mInputs.size());
+        std::map<int, int> edgeFile;
+        for (int ifile = 0; ifile < opt.mInputs.size(); ifile++) {
+            readers[ifile].open(opt.mInputs[ifile]);
+            std::vector<std::string> names;
+            readers[ifile].readVariableNames(names);
+            for (const std::string &var: names) {
+                // edge_<tag>r
+                int tag = -1;
+                char last = 0;
+                if (sscanf(var.c_str(), "edge_%d%c", &tag, &last) == 2 && last == 'r' &&
+                    var == "edge_" + std::to_string(tag) + "r") {
+                    edgeFile[tag] = ifile;
+                }
+            }
+        }
+        const NetCDF_Reader &nr = readers[0];
+        
+        // global info
+        double srcLat = 0., srcLon = 0., srcDep = 0.;
+        double srcFlattening = 0., surfFlattening = 0., radius = 6371e3;
+        nr.readAttribute("", "source_latitude", srcLat);
+        nr.readAttribute("", "source_longitude", srcLon);
+        nr.readAttribute("", "source_depth", srcDep);
+        nr.readAttribute("", "source_flattening", srcFlattening);
+        nr.readAttribute("", "surface_flattening", surfFlattening);
+        nr.readAttribute("", "radius", radius);
+        if (opt.mUserSource) {
+            srcLat = opt.mSrcLat;
+            srcLon = opt.mSrcLon;
+        }
+        setupGeodesy(radius, surfFlattening, srcFlattening, srcDep);
+        
+        // time, theta and points
+        std::vector<double> times, GLL, GLJ;
+        RDMatXX_RM theta;
+        nr.read1D("time_points", times);
+        nr.read2D("theta", theta);
+        nr.read1D("GLL", GLL);
+        nr.read1D("GLJ", GLJ);
+        int nstep = times.size();
+        int nele = theta.rows();
+        int npnt = GLL.size();
+        
+        // stations, located on the edges sorted by theta
+        const std::vector<SurfaceStation> &stations = readStations(opt, srcLat, srcLon, srcDep);
+        std::vector<std::pair<double, int>> edgeMax;
+        for (int tag = 0; tag < nele; tag++) {
+            edgeMax.push_back(std::make_pair(std::max(theta(tag, 0), theta(tag, 1)), tag));
+        }
+        std::sort(edgeMax.begin(), edgeMax.end());
+        std::map<int, std::vector<int>> edgeStations;
+        for (int ist = 0; ist < stations.size(); ist++) {
+            auto it = std::lower_bound(edgeMax.begin(), edgeMax.end(),
+                std::make_pair(stations[ist].mDist, -1));
+            if (it == edgeMax.end()) {
+                it--;
+            }
+            edgeStations[it->second].push_back(ist);
+        }
+        std::vector<EdgeStations> edges;
+        for (auto &es: edgeStations) {
+            if (edgeFile.find(es.first) == edgeFile.end()) {
+                const SurfaceStation &st = stations[es.second[0]];
+                throw std::runtime_error("axisem3d_surface2stations || "
+                    "Surface edge " + std::to_string(es.first) + " not found in the input files || "
+                    "Station = " + st.mNetwork + "." + st.mName);
+            }
+            EdgeStations edge;
+            edge.mTag = es.first;
+            edge.mFile = edgeFile.at(es.first);
+            edge.mStations = es.second;
+            edges.push_back(edge);
+        }
+        if (opt.mVerbose) {
+            std::cout << "--- Synthesizing " << stations.size() << " Stations on "
+                << edges.size() << " Edges by " << std::min(opt.mNumThreads, (int)edges.size())
+                << " Threads ---" << std::endl;
+        }
+        
+        // output, defined in one pass
+        NetCDF_Writer nw;
+        nw.open(opt.mOutput, true);
+        std::vector<size_t> dimsTime = {(size_t)nstep};
+        std::vector<size_t> dimsSeis = {(size_t)nstep, 3};
+        nw.defModeOn();
+        nw.defineVariable<double>("time_points", dimsTime);
+        for (const SurfaceStation &st: stations) {
+            std::string var = st.mNetwork + "." + st.mName + "." + opt.mComponents;
+            nw.defineVariable<Real>(var, dimsSeis);
+            nw.addAttribute(var, "latitude", st.mLat);
+            nw.addAttribute(var, "longitude", st.mLon);
+            nw.addAttribute(var, "depth", 0.);
+        }
+        nw.defModeOff();
+        nw.writeVariableWhole("time_points", times);
+        nw.addAttribute("", "source_latitude", srcLat);
+        nw.addAttribute("", "source_longitude", srcLon);
+        nw.addAttribute("", "source_depth", srcDep);
+        
+        // workers take the next edge; NetCDF is not thread-safe, so the
+        // reads and writes hold the lock of NetCDF_Writer
+        std::atomic<int> nextEdge(0);
+        std::atomic<int> numDone(0);
+        std::string error = "";
+        auto work = [&]() {
+            while (true) {
+                int iedge = nextEdge++;
+                if (iedge >= edges.size()) {
+                    return;
+                }
+                const EdgeStations &edge = edges[iedge];
+                try {
+                    std::string var = "edge_" + std::to_string(edge.mTag);
+                    std::vector<size_t> dims;
+                    {
+                        std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+                        if (error != "") {
+                            return;
+                        }
+                        readers[edge.mFile].readDims(var + "r", dims);
+                    }
+                    int ncol = dims[1];
+                    int nu1 = ncol / (3 * npnt);
+                    if (opt.mOrder >= nu1) {
+                        throw std::runtime_error("axisem3d_surface2stations || "
+                            "Specified Fourier order greater than the maximum " +
+                            std::to_string(nu1 - 1) + " on " + var + ".");
+                    }
+                    RDMatXX weightsR, weightsI;
+                    formWeights(stations, edge.mStations, theta, GLL, GLJ, edge.mTag, nu1, opt,
+                        weightsR, weightsI);
+                    
+                    // all stations of the edge by a product per chunk and dimension
+                    int nst = edge.mStations.size();
+                    std::vector<RDMatX3> spz(nst, RDMatX3::Zero(nstep, 3));
+                    RDMatXX_RM fourierR, fourierI;
+                    for (int it0 = 0; it0 < nstep; it0 += opt.mChunkSteps) {
+                        int nt = std::min(opt.mChunkSteps, nstep - it0);
+                        fourierR.resize(nt, ncol);
+                        fourierI.resize(nt, ncol);
+                        {
+                            std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+                            readers[edge.mFile].readHyperslab(var + "r", fourierR.data(),
+                                {(size_t)it0, 0}, {(size_t)nt, (size_t)ncol});
+                            readers[edge.mFile].readHyperslab(var + "i", fourierI.data(),
+                                {(size_t)it0, 0}, {(size_t)nt, (size_t)ncol});
+                        }
+                        int nblock = npnt * nu1;
+                        for (int idim = 0; idim < 3; idim++) {
+                            const RDMatXX &disp =
+                                fourierR.middleCols(idim * nblock, nblock) * weightsR -
+                                fourierI.middleCols(idim * nblock, nblock) * weightsI;
+                            for (int jst = 0; jst < nst; jst++) {
+                                spz[jst].block(it0, idim, nt, 1) = disp.col(jst);
+                            }
+                        }
+                    }
+                    
+                    // write
+                    for (int jst = 0; jst < nst; jst++) {
+                        const SurfaceStation &st = stations[edge.mStations[jst]];
+                        const RMatXX_RM &disp = rotate(spz[jst], st, opt.mComponents);
+                        std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+                        nw.writeVariableWhole(st.mNetwork + "." + st.mName + "." + opt.mComponents, disp);
+                    }
+                    int done = (numDone += nst);
+                    if (opt.mVerbose) {
+                        std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+                        std::cout << "Done with " << var << ", " << nst << " stations; "
+                            << done << " / " << stations.size() << std::endl;
+                    }
+                } catch (const std::exception &e) {
+                    std::lock_guard<std::mutex> lock(NetCDF_Writer::ioMutex());
+                    if (error == "") {
+                        error = e.what();
+                    }
+                    return;
+                }
+            }
+        };
+        std::vector<std::thread> threads;
+        for (int ithread = 0; ithread < std::min(opt.mNumThreads, (int)edges.size()); ithread++) {
+            threads.push_back(std::thread(work));
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        nw.close();
+        for (auto &reader: readers) {
+            reader.close();
+        }
+        if (error != "") {
+            throw std::runtime_error(error);
+        }
+    
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
+
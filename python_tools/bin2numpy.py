@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+'''
+bin2numpy.py
+
+Map a binary waveform database created by AxiSEM3D (named
+axisem3d_synthetics.*.bin by the solver, with OUT_STATIONS_FORMAT = binary)
+into numpy arrays, and optionally save selected stations as .npy files.
+
+The functions read_header and memmap can be imported by other scripts.
+
+To see usage, type
+python bin2numpy.py -h
+'''
+
+import numpy as np
+
+################### TOOLS ###################
+header_dtype = np.dtype([('magic', 'S8'), ('version', '<i4'), ('bytes', '<i4'),
+                         ('nstep', '<i8'), ('nstation', '<i8'), ('ncomp', '<i8'),
+                         ('time_offset', '<i8'), ('data_offset', '<i8'),
+                         ('source_latitude', '<f8'), ('source_longitude', '<f8'),
+                         ('source_depth', '<f8')])
+
+def read_header(fname):
+    header = np.fromfile(fname, dtype=header_dtype, count=1)[0]
+    assert header['magic'] == b'AX3DSYN', 'Not a binary file of AxiSEM3D: ' + fname
+    return header
+
+def memmap(fname):
+    # time, data[time, station, component] and station keys, without reading
+    header = read_header(fname)
+    real = '<f4' if header['bytes'] == 4 else '<f8'
+    time = np.memmap(fname, dtype='<f8', mode='r', offset=int(header['time_offset']),
+                     shape=(int(header['nstep']),))
+    data = np.memmap(fname, dtype=real, mode='r', offset=int(header['data_offset']),
+                     shape=(int(header['nstep']), int(header['nstation']),
+                            int(header['ncomp'])))
+    keys = np.loadtxt(fname + '.index', dtype=str, ndmin=2)[:, 1]
+    return header, time, data, keys
+################### TOOLS ###################
+
+if __name__ == '__main__':
+    ################### PARSER ###################
+    aim = '''Map a binary waveform database created by AxiSEM3D (named
+axisem3d_synthetics.*.bin by the solver, with OUT_STATIONS_FORMAT = binary)
+into numpy arrays, and optionally save selected stations as .npy files.'''
+
+    import argparse
+    from argparse import RawTextHelpFormatter
+    parser = argparse.ArgumentParser(description=aim,
+                                     formatter_class=RawTextHelpFormatter)
+    parser.add_argument('-i', '--input', dest='in_bin_file', action='store',
+                        type=str, required=True,
+                        help='binary waveform database created by AxiSEM3D\n' +
+                             '<required>')
+    parser.add_argument('-o', '--output', dest='out_npy_dir', action='store',
+                        type=str, default=None,
+                        help='directory to store the .npy files of the\n' +
+                             'selected stations; default = None (no output)')
+    parser.add_argument('-s', '--stations', dest='stations', action='store',
+                        nargs='+', type=str, default=['*.*'],
+                        help='stations to be extracted, given as a\n' +
+                             'list of regexes of "Network.Station";\n' +
+                             'default = *.* (all stations)')
+    parser.add_argument('-v', '--verbose', dest='verbose', action='store_true',
+                        help='verbose mode')
+    args = parser.parse_args()
+    ################### PARSER ###################
+
+    import fnmatch, os
+
+    header, time, data, keys = memmap(args.in_bin_file)
+    if args.verbose:
+        print('--- Binary database ---')
+        print('Number of steps: %d' % header['nstep'])
+        print('Number of stations: %d' % header['nstation'])
+        print('Number of components: %d' % header['ncomp'])
+        print('Bytes per value: %d' % header['bytes'])
+        print('Source latitude, longitude, depth: %f, %f, %f' %
+              (header['source_latitude'], header['source_longitude'],
+               header['source_depth']))
+        print()
+
+    if args.out_npy_dir is not None:
+        try:
+            os.makedirs(args.out_npy_dir)
+        except OSError:
+            pass
+        np.save(args.out_npy_dir + '/time.npy', time)
+        for ist, key in enumerate(keys):
+            if not any(fnmatch.fnmatch(key, regex) for regex in args.stations):
+                continue
+            # one strided read per station
+            np.save(args.out_npy_dir + '/' + key + '.npy', np.array(data[:, ist, :]))
+            if args.verbose:
+                print('Done with station ' + key)
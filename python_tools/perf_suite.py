@@ -0,0 +1,250 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+'''
+perf_suite.py
+
+Run a fixed set of short AxiSEM3D simulations on the template mesh and
+collect their performance into a JSON file, optionally compared with the
+JSON file of an earlier commit to detect performance regressions.
+
+To see usage, type
+python perf_suite.py -h
+'''
+
+################### PARSER ###################
+
+aim = '''Run a fixed set of short AxiSEM3D simulations on the template mesh and
+collect their performance into a JSON file.'''
+
+notes = '''Configurations, all on template/input (AxiSEM_prem_ani_one_crust_50.e):
+  prem_1d_att       1D PREM with attenuation
+  prem_1d_noatt     1D PREM without attenuation
+  s40rts_att        s40rts mantle, empirical Nu
+  crust1_topo_att   crust1 crust and crust1 topography, empirical Nu
+The solver must be built with the default NPOL = 4 for the results to be
+comparable. Each configuration runs --steps time steps in its own directory
+under --work; its telemetry (OPTION_TELEMETRY_INTERVAL) gives steps/s and
+the memory high-water mark, and its preloop timer (DEVELOP_DIAGNOSE_PRELOOP)
+gives the seconds of each preloop phase.
+
+With --baseline, steps/s and total preloop seconds are compared with those
+of the baseline file, and the exit code is 1 if any configuration is slower
+by more than --tolerance.
+
+'''
+
+import argparse
+from argparse import RawTextHelpFormatter
+parser = argparse.ArgumentParser(description=aim, epilog=notes,
+                                 formatter_class=RawTextHelpFormatter)
+parser.add_argument('-e', '--executable', dest='executable', action='store',
+                    type=str, required=True,
+                    help='axisem3d executable built with NPOL = 4\n' +
+                         '<required>')
+parser.add_argument('-i', '--input', dest='input_dir', action='store',
+                    type=str, default='',
+                    help='template input directory;\n' +
+                         'default = template/input of this repository')
+parser.add_argument('-w', '--work', dest='work_dir', action='store',
+                    type=str, default='perf_suite_runs',
+                    help='directory for the simulations;\n' +
+                         'default = perf_suite_runs')
+parser.add_argument('-o', '--output', dest='out_json', action='store',
+                    type=str, default='perf_suite.json',
+                    help='JSON file of the results;\n' +
+                         'default = perf_suite.json')
+parser.add_argument('-b', '--baseline', dest='baseline_json', action='store',
+                    type=str, default='',
+                    help='JSON file of earlier results to compare with;\n' +
+                         'default = "" (no comparison)')
+parser.add_argument('-t', '--tolerance', dest='tolerance', action='store',
+                    type=float, default=0.05,
+                    help='allowed relative slowdown against the baseline;\n' +
+                         'default = 0.05')
+parser.add_argument('-n', '--steps', dest='steps', action='store',
+                    type=int, default=500,
+                    help='number of time steps of each run;\n' +
+                         'default = 500')
+parser.add_argument('-p', '--nproc', dest='nproc', action='store',
+                    type=int, default=4,
+                    help='number of mpi processes;\n' +
+                         'default = 4')
+parser.add_argument('-m', '--mpirun', dest='mpirun', action='store',
+                    type=str, default='mpirun -np',
+                    help='mpi launcher followed by the number of processes;\n' +
+                         'default = "mpirun -np"')
+parser.add_argument('-c', '--configs', dest='configs', action='store',
+                    type=str, nargs='+', default=[],
+                    help='configurations to run;\n' +
+                         'default = all')
+parser.add_argument('-v', '--verbose', dest='verbose', action='store_true',
+                    help='verbose mode')
+args = parser.parse_args()
+
+################### PARSER ###################
+
+import os
+import re
+import sys
+import json
+import shutil
+import subprocess
+import platform
+import time
+
+repo_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+if args.input_dir == '':
+    args.input_dir = os.path.join(repo_dir, 'template', 'input')
+
+# parameters shared by all configurations
+common = {
+    'inparam.time_src_recv': {'OUT_STATIONS_WHOLE_SURFACE': 'false',
+                              'OUT_VOLUME': 'false'},
+    'inparam.advanced': {'DEVELOP_MAX_TIME_STEPS': str(args.steps),
+                         'DEVELOP_DIAGNOSE_PRELOOP': 'true',
+                         'OPTION_TELEMETRY_INTERVAL': str(max(args.steps // 10, 1)),
+                         'OPTION_CHECKPOINT_INTERVAL': '0',
+                         'OPTION_VERBOSE_LEVEL': 'essential'}}
+
+# canonical configurations
+empirical_nu = {'NU_TYPE': 'empirical'}
+configs = [
+    ('prem_1d_att', {
+        'inparam.model': {'ATTENUATION': 'true'}}),
+    ('prem_1d_noatt', {
+        'inparam.model': {'ATTENUATION': 'false'}}),
+    ('s40rts_att', {
+        'inparam.model': {'ATTENUATION': 'true',
+                          'MODEL_3D_VOLUMETRIC_NUM': '1',
+                          'MODEL_3D_VOLUMETRIC_LIST': 's40rts'},
+        'inparam.nu': empirical_nu}),
+    ('crust1_topo_att', {
+        'inparam.model': {'ATTENUATION': 'true',
+                          'MODEL_3D_VOLUMETRIC_NUM': '1',
+                          'MODEL_3D_VOLUMETRIC_LIST': 'crust1',
+                          'MODEL_3D_GEOMETRIC_NUM': '1',
+                          'MODEL_3D_GEOMETRIC_LIST': 'crust1'},
+        'inparam.nu': empirical_nu})]
+if len(args.configs) > 0:
+    unknown = set(args.configs) - set([name for name, _ in configs])
+    assert len(unknown) == 0, 'Unknown configurations: %s' % ' '.join(unknown)
+    configs = [(name, edits) for name, edits in configs if name in args.configs]
+
+# replace the values of keys in an inparam file
+def edit_inparam(fname, values):
+    with open(fname, 'r') as fs:
+        lines = fs.readlines()
+    found = set()
+    for i, line in enumerate(lines):
+        strs = line.split()
+        if len(strs) > 0 and strs[0] in values:
+            key = strs[0]
+            lines[i] = key.ljust(44) + values[key] + '\n'
+            found.add(key)
+    missing = set(values) - found
+    assert len(missing) == 0, 'Missing keys in %s: %s' % (fname, ' '.join(missing))
+    with open(fname, 'w') as fs:
+        fs.writelines(lines)
+
+# phases of develop/preloop_timer.txt, as "level/name": seconds
+def read_preloop_timer(fname):
+    phases = {}
+    if not os.path.exists(fname):
+        return phases
+    begins = re.compile(r'^( *)(.+) begins\.\.\.$')
+    finishes = re.compile(r'^( *)(.+) finishes\. Elapsed seconds = (\S+)$')
+    stack = []
+    for line in open(fname, 'r'):
+        line = line.rstrip('\n')
+        match = begins.match(line)
+        if match is not None:
+            stack = stack[0:len(match.group(1)) // 4] + [match.group(2)]
+            continue
+        match = finishes.match(line)
+        if match is not None:
+            stack = stack[0:len(match.group(1)) // 4] + [match.group(2)]
+            phases['/'.join(stack)] = float(match.group(3))
+    return phases
+
+# steps/s and memory from output/telemetry.jsonl, skipping the first record
+def read_telemetry(fname):
+    records = [json.loads(line) for line in open(fname, 'r') if line.strip() != '']
+    assert len(records) > 0, 'No telemetry records in %s' % fname
+    steady = records[1:] if len(records) > 1 else records
+    rates = [rec['steps_per_sec']['min'] for rec in steady]
+    return {'steps_per_sec': sum(rates) / len(rates),
+            'memory_mb_max': max([rec['memory_mb']['max'] for rec in records]),
+            'memory_mb_mean': records[-1]['memory_mb']['mean']}
+
+def git_commit():
+    try:
+        return subprocess.check_output(['git', '-C', repo_dir, 'rev-parse', 'HEAD'],
+                                       stderr=subprocess.STDOUT).decode().strip()
+    except Exception:
+        return 'unknown'
+
+# run
+results = {'commit': git_commit(),
+           'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+           'host': platform.node(),
+           'nproc': args.nproc,
+           'steps': args.steps,
+           'configs': {}}
+executable = os.path.abspath(args.executable)
+for name, edits in configs:
+    run_dir = os.path.join(args.work_dir, name)
+    if os.path.exists(run_dir):
+        shutil.rmtree(run_dir)
+    shutil.copytree(args.input_dir, os.path.join(run_dir, 'input'))
+    os.symlink(executable, os.path.join(run_dir, 'axisem3d'))
+    for fname, values in list(common.items()) + list(edits.items()):
+        edit_inparam(os.path.join(run_dir, 'input', fname), values)
+
+    if args.verbose:
+        print('Running %s ...' % name)
+    cmd = args.mpirun.split() + [str(args.nproc), './axisem3d']
+    start = time.time()
+    with open(os.path.join(run_dir, 'axisem3d.log'), 'w') as log:
+        code = subprocess.call(cmd, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT)
+    walltime = time.time() - start
+    assert code == 0, 'Simulation %s failed; see %s' % (name,
+        os.path.join(run_dir, 'axisem3d.log'))
+
+    res = read_telemetry(os.path.join(run_dir, 'output', 'telemetry.jsonl'))
+    res['preloop'] = read_preloop_timer(os.path.join(run_dir, 'output',
+                                                     'develop', 'preloop_timer.txt'))
+    res['preloop_seconds'] = sum([sec for key, sec in res['preloop'].items()
+                                  if '/' not in key])
+    res['walltime'] = walltime
+    results['configs'][name] = res
+    if args.verbose:
+        print('  steps/s = %f, preloop = %f s, memory = %f MB' % (res['steps_per_sec'],
+              res['preloop_seconds'], res['memory_mb_max']))
+
+with open(args.out_json, 'w') as fs:
+    json.dump(results, fs, indent=2, sort_keys=True)
+
+# compare
+if args.baseline_json == '':
+    sys.exit(0)
+with open(args.baseline_json, 'r') as fs:
+    baseline = json.load(fs)
+if baseline['nproc'] != args.nproc or baseline['steps'] != args.steps:
+    print('Warning: baseline run with nproc = %d and steps = %d' %
+          (baseline['nproc'], baseline['steps']))
+regressed = False
+print('%-20s %14s %14s %14s' % ('config', 'steps/s', 'preloop', 'memory'))
+for name, res in results['configs'].items():
+    if name not in baseline['configs']:
+        continue
+    base = baseline['configs'][name]
+    rate = res['steps_per_sec'] / base['steps_per_sec'] - 1.
+    pre = res['preloop_seconds'] / max(base['preloop_seconds'], 1e-12) - 1.
+    mem = res['memory_mb_max'] / max(base['memory_mb_max'], 1e-12) - 1.
+    slow = rate < -args.tolerance or pre > args.tolerance
+    regressed = regressed or slow
+    print('%-20s %+13.1f%% %+13.1f%% %+13.1f%%%s' % (name, rate * 100., pre * 100.,
+          mem * 100., '  REGRESSION' if slow else ''))
+sys.exit(1 if regressed else 0)
+
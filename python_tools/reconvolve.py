@@ -0,0 +1,165 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+'''
+reconvolve.py
+
+Replace the source time function of a NetCDF waveform database created by
+AxiSEM3D (named axisem3d_synthetics.nc by the solver) with another one, so that
+a simulation with a short source time function (SOURCE_TIME_FUNCTION = impulse)
+serves any half duration without rerunning the solver.
+
+To see usage, type
+python reconvolve.py -h
+'''
+
+################### PARSER ###################
+
+aim = '''Replace the source time function of a NetCDF waveform database created by
+AxiSEM3D (named axisem3d_synthetics.nc by the solver) with another one.'''
+
+notes = '''The source time function used by the solver is read from
+output/stations/source_time_function.txt, written by the solver.
+The traces are deconvolved by it and convolved with the new one in the
+frequency domain, with a water level relative to the peak of its spectrum.
+The new source time function can be
+  1) analytic, by --type and --hdur, with the same definition as the solver;
+  2) tabulated, by --file, an ascii file with columns of time and value.
+Both step-like ones (like erf) and pulse-like ones (like gauss) are allowed.
+The records start at the shift of the solver stf, so the part of a longer
+new source time function before that is cut off.
+
+'''
+
+import argparse
+from argparse import RawTextHelpFormatter
+parser = argparse.ArgumentParser(description=aim, epilog=notes,
+                                 formatter_class=RawTextHelpFormatter)
+parser.add_argument('-i', '--input', dest='in_nc_file', action='store',
+                    type=str, required=True,
+                    help='NetCDF waveform database created by AxiSEM3D\n' +
+                         '<required>')
+parser.add_argument('-o', '--output', dest='out_nc_file', action='store',
+                    type=str, required=True,
+                    help='NetCDF waveform database to be created\n' +
+                         '<required>')
+parser.add_argument('-s', '--solver_stf', dest='solver_stf_file', action='store',
+                    type=str, required=True,
+                    help='source time function used by the solver,\n' +
+                         'output/stations/source_time_function.txt\n' +
+                         '<required>')
+parser.add_argument('-t', '--type', dest='stf_type', action='store',
+                    type=str, default='gauss', choices=['erf', 'gauss', 'ricker'],
+                    help='type of the new analytic source time function;\n' +
+                         'default = gauss')
+parser.add_argument('-d', '--hdur', dest='hdur', action='store',
+                    type=float, default=10.,
+                    help='half duration of the new analytic source time function;\n' +
+                         'default = 10.0')
+parser.add_argument('-f', '--file', dest='stf_file', action='store',
+                    type=str, default='',
+                    help='ascii file of the new tabulated source time function,\n' +
+                         'overriding --type and --hdur;\n' +
+                         'default = "" (analytic)')
+parser.add_argument('-w', '--water_level', dest='water_level', action='store',
+                    type=float, default=1e-3,
+                    help='water level of deconvolution;\n' +
+                         'default = 1e-3')
+parser.add_argument('-v', '--verbose', dest='verbose', action='store_true',
+                    help='verbose mode')
+args = parser.parse_args()
+
+################### PARSER ###################
+
+import numpy as np
+from netCDF4 import Dataset
+import math
+
+# analytic source time functions, as in SOLVER/src/preloop/source/stf
+def analytic(stf_type, hdur, t):
+    decay = 1.628
+    a = decay / hdur
+    if stf_type == 'erf':
+        return np.vectorize(math.erf)(a * t) * 0.5 + 0.5
+    if stf_type == 'gauss':
+        return np.exp(-(a * t) ** 2) * a / np.sqrt(np.pi)
+    return 2. * a ** 2 * np.exp(-(a * t) ** 2) * (2. * t ** 2 * a ** 2 - 1.)
+
+# step-like source time functions are differentiated to decay
+def step_like(stf):
+    return abs(stf[-1]) > 1e-3 * np.max(np.abs(stf))
+
+# solver stf
+stf0 = np.loadtxt(args.solver_stf_file)
+t0, s0 = stf0[:, 0], stf0[:, 1]
+
+# time info
+ncin = Dataset(args.in_nc_file, 'r')
+vartime = ncin.variables['time_points'][:]
+nt = len(vartime)
+assert nt > 1, 'Too few time steps'
+dt = vartime[1] - vartime[0]
+
+# new stf
+if args.stf_file != '':
+    stf1 = np.loadtxt(args.stf_file)
+    t1, s1 = stf1[:, 0], stf1[:, 1]
+else:
+    hdur = max(args.hdur, 5. * t0[1] - 5. * t0[0])
+    t1 = np.arange(-2.5 * hdur, vartime[-1] + dt, dt)
+    s1 = analytic(args.stf_type, hdur, t1)
+
+# both on the time step of the records, from a common start
+tstart = min(t0[0], t1[0])
+tend = max(t0[-1], t1[-1])
+grid = np.arange(tstart, tend + dt, dt)
+g0 = np.interp(grid, t0, s0, left=0., right=s0[-1])
+g1 = np.interp(grid, t1, s1, left=0., right=s1[-1])
+order0 = int(step_like(g0))
+order1 = int(step_like(g1))
+if order0:
+    g0 = np.diff(g0, prepend=0.) / dt
+if order1:
+    g1 = np.diff(g1, prepend=0.) / dt
+
+# transfer function with water level
+nfft = 1
+while nfft < 2 * (len(grid) + nt):
+    nfft *= 2
+G0 = np.fft.rfft(g0, nfft)
+G1 = np.fft.rfft(g1, nfft)
+level = args.water_level * np.max(np.abs(G0))
+small = np.abs(G0) < level
+G0[small] = level * np.exp(1j * np.angle(G0[small]))
+H = G1 / G0
+
+if args.verbose:
+    print('--- Reconvolution ---')
+    print('Number of steps: %d' % nt)
+    print('Time step: %f' % dt)
+    print('FFT size: %d' % nfft)
+    print('Water-levelled frequencies: %d / %d' % (np.sum(small), len(G0)))
+    print()
+
+# output, same structure as input
+ncout = Dataset(args.out_nc_file, 'w')
+for name, dim in ncin.dimensions.items():
+    ncout.createDimension(name, len(dim))
+for name, var in ncin.variables.items():
+    ncout.createVariable(name, var.dtype, var.dimensions)
+    if name == 'time_points':
+        ncout.variables[name][:] = var[:]
+        continue
+    wave = var[:, :].astype('float64')
+    wave = np.fft.irfft(np.fft.rfft(wave, nfft, axis=0) * H[:, None], nfft, axis=0)[0:nt, :]
+    # back to the order of the new stf
+    if order1 > order0:
+        wave = np.cumsum(wave, axis=0) * dt
+    elif order0 > order1:
+        wave = np.diff(wave, axis=0, prepend=0.) / dt
+    ncout.variables[name][:, :] = wave
+    if args.verbose:
+        print('Done with station %s' % name)
+ncin.close()
+ncout.close()
+
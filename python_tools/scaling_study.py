@@ -0,0 +1,232 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+'''
+scaling_study.py
+
+Run AxiSEM3D over a list of processor counts, in strong or weak scaling,
+collect the preloop and time-loop timers of every run and write tables of
+seconds, speedup and parallel efficiency per phase.
+
+To see usage, type
+python scaling_study.py -h
+'''
+
+################### PARSER ###################
+
+aim = '''Run AxiSEM3D over a list of processor counts and write tables of
+speedup and parallel efficiency per phase.'''
+
+notes = '''Modes:
+  strong    the same problem on every processor count
+  weak      NU_CONST grows with the processor count from --nu on the fewest
+            processors, so that the load per processor stays the same
+Each run performs --steps time steps (DEVELOP_MAX_TIME_STEPS) in its own
+directory under --work. The phases are those of the preloop timer
+(DEVELOP_DIAGNOSE_PRELOOP), to --depth levels, and those of the MPI cost
+measurements of the time loop (OPTION_LOOP_TIMERS), as the maximum over the
+processors. With p0 the fewest processors and T the seconds of a phase,
+  strong:  speedup = T(p0) / T(p),  efficiency = speedup * p0 / p
+  weak:    speedup = T(p0) / T(p) * p / p0,  efficiency = T(p0) / T(p)
+The tables are printed and, with all seconds, written to --output as JSON.
+
+'''
+
+import argparse
+from argparse import RawTextHelpFormatter
+parser = argparse.ArgumentParser(description=aim, epilog=notes,
+                                 formatter_class=RawTextHelpFormatter)
+parser.add_argument('-e', '--executable', dest='executable', action='store',
+                    type=str, required=True,
+                    help='axisem3d executable\n' +
+                         '<required>')
+parser.add_argument('-i', '--input', dest='input_dir', action='store',
+                    type=str, default='',
+                    help='input directory;\n' +
+                         'default = template/input of this repository')
+parser.add_argument('-w', '--work', dest='work_dir', action='store',
+                    type=str, default='scaling_runs',
+                    help='directory for the simulations;\n' +
+                         'default = scaling_runs')
+parser.add_argument('-o', '--output', dest='out_json', action='store',
+                    type=str, default='scaling_study.json',
+                    help='JSON file of the results;\n' +
+                         'default = scaling_study.json')
+parser.add_argument('-p', '--nprocs', dest='nprocs', action='store',
+                    type=int, nargs='+', default=[1, 2, 4, 8],
+                    help='numbers of mpi processes;\n' +
+                         'default = 1 2 4 8')
+parser.add_argument('-s', '--scaling', dest='scaling', action='store',
+                    type=str, default='strong', choices=['strong', 'weak'],
+                    help='strong or weak scaling;\n' +
+                         'default = strong')
+parser.add_argument('-u', '--nu', dest='nu', action='store',
+                    type=int, default=0,
+                    help='NU_CONST on the fewest processors in weak scaling;\n' +
+                         'default = that of the input')
+parser.add_argument('-n', '--steps', dest='steps', action='store',
+                    type=int, default=200,
+                    help='number of time steps of each run;\n' +
+                         'default = 200')
+parser.add_argument('-d', '--depth', dest='depth', action='store',
+                    type=int, default=1,
+                    help='levels of the preloop timer in the tables;\n' +
+                         'default = 1')
+parser.add_argument('-m', '--mpirun', dest='mpirun', action='store',
+                    type=str, default='mpirun -np',
+                    help='mpi launcher followed by the number of processes;\n' +
+                         'default = "mpirun -np"')
+parser.add_argument('-v', '--verbose', dest='verbose', action='store_true',
+                    help='verbose mode')
+args = parser.parse_args()
+
+################### PARSER ###################
+
+import os
+import re
+import json
+import shutil
+import subprocess
+import time
+
+repo_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+if args.input_dir == '':
+    args.input_dir = os.path.join(repo_dir, 'template', 'input')
+nprocs = sorted(set(args.nprocs))
+assert nprocs[0] > 0, 'Numbers of processes must be positive.'
+
+# value of a key in an inparam file
+def read_inparam(fname, key):
+    for line in open(fname, 'r'):
+        strs = line.split()
+        if len(strs) > 1 and strs[0] == key:
+            return strs[1]
+    assert False, 'Missing key in %s: %s' % (fname, key)
+
+# replace the values of keys in an inparam file
+def edit_inparam(fname, values):
+    with open(fname, 'r') as fs:
+        lines = fs.readlines()
+    found = set()
+    for i, line in enumerate(lines):
+        strs = line.split()
+        if len(strs) > 0 and strs[0] in values:
+            key = strs[0]
+            lines[i] = key.ljust(44) + values[key] + '\n'
+            found.add(key)
+    missing = set(values) - found
+    assert len(missing) == 0, 'Missing keys in %s: %s' % (fname, ' '.join(missing))
+    with open(fname, 'w') as fs:
+        fs.writelines(lines)
+
+# phases of develop/preloop_timer.txt, as "level/name": seconds
+def read_preloop_timer(fname):
+    phases = {}
+    if not os.path.exists(fname):
+        return phases
+    begins = re.compile(r'^( *)(.+) begins\.\.\.$')
+    finishes = re.compile(r'^( *)(.+) finishes\. Elapsed seconds = (\S+)$')
+    stack = []
+    for line in open(fname, 'r'):
+        line = line.rstrip('\n')
+        match = begins.match(line)
+        if match is not None:
+            stack = stack[0:len(match.group(1)) // 4] + [match.group(2)]
+            continue
+        match = finishes.match(line)
+        if match is not None:
+            stack = stack[0:len(match.group(1)) // 4] + [match.group(2)]
+            phases['/'.join(stack)] = float(match.group(3))
+    return phases
+
+# columns of the MPI cost measurements in the log, maximum over processors
+loop_phases = ['walltime', 'element-wise', 'point-wise', 'mpi_assemble',
+               'mpi_wait', 'miscellaneous']
+def read_loop_cost(fname):
+    phases = {}
+    inside = False
+    for line in open(fname, 'r'):
+        if 'MPI COST MEASUREMENTS' in line:
+            inside = True
+            continue
+        if not inside or line.startswith('PROCESSOR'):
+            continue
+        strs = line.split()
+        if len(strs) != len(loop_phases) + 1:
+            break
+        for name, value in zip(loop_phases, strs[1:]):
+            phases['loop/' + name] = max(phases.get('loop/' + name, 0.), float(value))
+    return phases
+
+# run
+inparam_nu = os.path.join(args.input_dir, 'inparam.nu')
+nu0 = args.nu if args.nu > 0 else int(read_inparam(inparam_nu, 'NU_CONST'))
+if args.scaling == 'weak':
+    assert read_inparam(inparam_nu, 'NU_TYPE') == 'constant' or args.nu > 0, \
+        'Weak scaling requires NU_TYPE = constant.'
+results = {'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+           'scaling': args.scaling,
+           'steps': args.steps,
+           'runs': {}}
+executable = os.path.abspath(args.executable)
+for nproc in nprocs:
+    run_dir = os.path.join(args.work_dir, '%s_np%d' % (args.scaling, nproc))
+    if os.path.exists(run_dir):
+        shutil.rmtree(run_dir)
+    shutil.copytree(args.input_dir, os.path.join(run_dir, 'input'))
+    os.symlink(executable, os.path.join(run_dir, 'axisem3d'))
+    edit_inparam(os.path.join(run_dir, 'input', 'inparam.advanced'),
+                 {'DEVELOP_MAX_TIME_STEPS': str(args.steps),
+                  'DEVELOP_DIAGNOSE_PRELOOP': 'true',
+                  'OPTION_LOOP_TIMERS': 'true',
+                  'OPTION_CHECKPOINT_INTERVAL': '0'})
+    nu = nu0
+    if args.scaling == 'weak':
+        nu = max(int(round(nu0 * float(nproc) / nprocs[0])), 1)
+        edit_inparam(os.path.join(run_dir, 'input', 'inparam.nu'),
+                     {'NU_TYPE': 'constant', 'NU_CONST': str(nu)})
+
+    if args.verbose:
+        print('Running %s scaling on %d processors, NU_CONST = %d ...' %
+              (args.scaling, nproc, nu))
+    cmd = args.mpirun.split() + [str(nproc), './axisem3d']
+    log_file = os.path.join(run_dir, 'axisem3d.log')
+    start = time.time()
+    with open(log_file, 'w') as log:
+        code = subprocess.call(cmd, cwd=run_dir, stdout=log, stderr=subprocess.STDOUT)
+    walltime = time.time() - start
+    assert code == 0, 'Simulation on %d processors failed; see %s' % (nproc, log_file)
+
+    phases = read_preloop_timer(os.path.join(run_dir, 'output',
+                                             'develop', 'preloop_timer.txt'))
+    phases = dict([(key, sec) for key, sec in phases.items()
+                   if key.count('/') < args.depth])
+    phases['preloop'] = sum([sec for key, sec in phases.items() if '/' not in key])
+    phases.update(read_loop_cost(log_file))
+    phases['total'] = walltime
+    results['runs'][str(nproc)] = {'nu': nu, 'phases': phases}
+
+# tables
+p0 = nprocs[0]
+base = results['runs'][str(p0)]['phases']
+names = [name for name in sorted(base) if name not in ['preloop', 'total']]
+names += ['preloop', 'total']
+results['speedup'] = {}
+results['efficiency'] = {}
+for name in names:
+    print('\n%s' % name)
+    print('%-10s %14s %14s %14s' % ('nproc', 'seconds', 'speedup', 'efficiency'))
+    for nproc in nprocs:
+        sec = results['runs'][str(nproc)]['phases'].get(name, 0.)
+        if sec > 0. and base[name] > 0.:
+            ratio = base[name] / sec
+            speedup = ratio if args.scaling == 'strong' else ratio * nproc / p0
+            efficiency = speedup * p0 / nproc
+        else:
+            speedup, efficiency = 0., 0.
+        results['speedup'].setdefault(name, {})[str(nproc)] = speedup
+        results['efficiency'].setdefault(name, {})[str(nproc)] = efficiency
+        print('%-10d %14.4f %14.3f %14.3f' % (nproc, sec, speedup, efficiency))
+
+with open(args.out_json, 'w') as fs:
+    json.dump(results, fs, indent=2, sort_keys=True)
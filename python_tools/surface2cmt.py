@@ -0,0 +1,246 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+'''
+surface2cmt.py
+
+Compute synthetics of arbitrary moment tensors from a reciprocal NetCDF
+database of surface strain created by AxiSEM3D (named axisem3d_surface.nc
+by the solver, with OUT_STATIONS_WHOLE_SURFACE_STRAIN = true).
+
+To see usage, type
+python surface2cmt.py -h
+'''
+
+################### PARSER ###################
+aim = '''Compute synthetics of arbitrary moment tensors from a reciprocal NetCDF
+database of surface strain created by AxiSEM3D (named axisem3d_surface.nc
+by the solver, with OUT_STATIONS_WHOLE_SURFACE_STRAIN = true).'''
+
+notes = '''Reciprocity: the database is created by a point force located at a
+station, with the surface wavefield (OUT_STATIONS_WHOLE_SURFACE) saved at the
+radius of the sources. The displacement at the station in the direction of
+the force, due to a moment tensor M at x, is then M : strain(x) / force.
+All moment tensors are assumed to lie on the recorded surface. Run one
+database for each component of the station.
+
+Format of the moment tensor list, one source per line:
+NAME  LATITUDE  LONGITUDE  Mrr  Mtt  Mpp  Mrt  Mrp  Mtp
+'''
+
+import argparse
+from argparse import RawTextHelpFormatter
+parser = argparse.ArgumentParser(description=aim, epilog=notes,
+                                 formatter_class=RawTextHelpFormatter)
+parser.add_argument('-i', '--input', dest='in_surface_nc',
+                    action='store', type=str, required=True,
+                    help='NetCDF database of surface strain\n' +
+                         'created by AxiSEM3D <required>')
+parser.add_argument('-m', '--multi_file', dest='multi_file', action='store_true',
+                    help='Does the NetCDF database consist of\n' +
+                         'multiple files; default = False')
+parser.add_argument('-o', '--output', dest='out_waveform_nc',
+                    action='store', type=str, required=True,
+                    help='NetCDF waveform database to store the\n' +
+                         'computed synthetics <required>')
+parser.add_argument('-c', '--cmts', dest='cmts',
+                    action='store', type=str, required=True,
+                    help='list of moment tensors, see notes below <required>')
+parser.add_argument('-f', '--force', dest='force',
+                    action='store', type=float, default=1.0,
+                    help='magnitude of the point force used to\n' +
+                         'create the database; default = 1.0')
+parser.add_argument('-l', '--station_lat_lon', dest='station_lat_lon',
+                    action='store', nargs=2, type=float, default=None,
+                    help='specify latitude and longitude of the point force;\n' +
+                         'default = None (use those in the solver)')
+parser.add_argument('-v', '--verbose', dest='verbose', action='store_true',
+                    help='verbose mode')
+args = parser.parse_args()
+
+################### PARSER ###################
+
+import numpy as np
+from netCDF4 import Dataset
+from obspy.geodetics import gps2dist_azimuth
+import os
+
+################### TOOLS ###################
+def rotation_matrix(theta, phi):
+    return np.array([[np.cos(theta) * np.cos(phi), -np.sin(phi), np.sin(theta) * np.cos(phi)],
+                     [np.cos(theta) * np.sin(phi), np.cos(phi), np.sin(theta) * np.sin(phi)],
+                     [-np.sin(theta), 0., np.cos(theta)]])
+
+def latlon2thetaphi(lat, lon, flattening):
+    temp = (1. - flattening) * (1. - flattening)
+    return np.pi / 2. - np.arctan(temp * np.tan(np.radians(lat))), np.radians(lon)
+
+def thetaphi2xyz(theta, phi):
+    return np.array([np.sin(theta) * np.cos(phi),
+                     np.sin(theta) * np.sin(phi),
+                     np.cos(theta)])
+
+def xyz2thetaphi(xyz):
+    theta = np.arccos(xyz[2])
+    phi = np.arctan2(xyz[1], xyz[0])
+    return theta, phi
+
+def interpLagrange(target, bases):
+    nbases = len(bases)
+    results = np.zeros(nbases)
+    for dgr in np.arange(0, nbases):
+        prod1 = 1.
+        prod2 = 1.
+        for i in np.arange(0, nbases):
+            if i != dgr:
+                prod1 *= target - bases[i]
+                prod2 *= bases[dgr] - bases[i]
+        results[dgr] = prod1 / prod2
+    return results
+
+def moment_RTZ(mt, azimuth_R):
+    # moment tensor in the frame of the database at the source, where
+    # R points away from the point force, T = Z x R and Z is up
+    Mrr, Mtt, Mpp, Mrt, Mrp, Mtp = mt
+    # east, north, up
+    M_ENU = np.array([[ Mpp, -Mtp,  Mrp],
+                      [-Mtp,  Mtt, -Mrt],
+                      [ Mrp, -Mrt,  Mrr]])
+    R = np.array([np.sin(azimuth_R), np.cos(azimuth_R), 0.])
+    T = np.array([-np.cos(azimuth_R), np.sin(azimuth_R), 0.])
+    Z = np.array([0., 0., 1.])
+    B = np.array([R, T, Z]).T
+    return B.T.dot(M_ENU).dot(B)
+################### TOOLS ###################
+
+
+###### read surface database
+if args.multi_file:
+    nc_surfs = []
+    for irank in np.arange(0, 99999):
+        fname = args.in_surface_nc + str(irank)
+        if os.path.isfile(fname):
+            nc = Dataset(fname, 'r')
+            if nc.variables['time_points'][-1] < -1. or '--' in str(nc.variables['time_points'][0]):
+                print('Skip opening nc file %s' % (fname))
+                continue
+            nc_surfs.append(nc)
+            if args.verbose:
+                print('Done opening nc file %s' % (fname))
+    nc_surf = nc_surfs[0]
+else:
+    nc_surf = Dataset(args.in_surface_nc, 'r')
+    if args.verbose:
+        print('Done opening nc file %s' % (args.in_surface_nc))
+    nc_surfs = [nc_surf]
+
+# global attribute
+if args.station_lat_lon is not None:
+    stlat = args.station_lat_lon[0]
+    stlon = args.station_lat_lon[1]
+else:
+    stlat = nc_surf.source_latitude
+    stlon = nc_surf.source_longitude
+stflat = nc_surf.source_flattening
+surfflat = nc_surf.surface_flattening
+# time
+var_time = nc_surf.variables['time_points'][:]
+nstep = len(var_time)
+solver_dtype = nc_surf.variables['time_points'].datatype
+# theta
+var_theta = nc_surf.variables['theta'][:]
+nele = len(var_theta)
+# GLL and GLJ
+var_GLL = nc_surf.variables['GLL'][:]
+var_GLJ = nc_surf.variables['GLJ'][:]
+nPntEdge = len(var_GLL)
+
+# element on rank
+irank_ele = np.zeros(nele, dtype='int')
+irank_ele.fill(-1)
+for inc, nc in enumerate(nc_surfs):
+    keys = nc.variables.keys()
+    for eleTag in np.arange(nele):
+        key = 'edge_' + str(eleTag) + '_strain_r'
+        if key in keys:
+            irank_ele[eleTag] = inc
+assert np.all(irank_ele >= 0), 'No strain found in the database, ' + \
+    'set OUT_STATIONS_WHOLE_SURFACE_STRAIN = true in the solver'
+
+# frame of the database
+strmat = rotation_matrix(*latlon2thetaphi(stlat, stlon, stflat))
+
+###### read moment tensors
+cmt_info = np.loadtxt(args.cmts, dtype=str, ndmin=2)
+
+###### prepare output
+nc_wave = Dataset(args.out_waveform_nc, 'w')
+# global attribute
+nc_wave.station_latitude = stlat
+nc_wave.station_longitude = stlon
+# time
+ncdim_nstep = 'ncdim_' + str(nstep)
+nc_wave.createDimension(ncdim_nstep, size=nstep)
+var_time_out = nc_wave.createVariable('time_points',
+    solver_dtype, (ncdim_nstep,))
+var_time_out[:] = var_time[:]
+
+# waveforms
+max_theta = np.amax(var_theta, axis=1)
+fourier_cache = {}
+for icmt in np.arange(0, len(cmt_info)):
+    name = cmt_info[icmt, 0]
+    lat = float(cmt_info[icmt, 1])
+    lon = float(cmt_info[icmt, 2])
+    mt = cmt_info[icmt, 3:9].astype(float)
+
+    # location in the frame of the database
+    xsrc = strmat.T.dot(thetaphi2xyz(*latlon2thetaphi(lat, lon, surfflat)))
+    dist, azimuth = xyz2thetaphi(xsrc)
+    d, az, baz = gps2dist_azimuth(stlat, stlon, lat, lon, a=1., f=surfflat)
+    # R points away from the point force
+    M = moment_RTZ(mt, np.radians(baz) + np.pi)
+
+    # locate source
+    eleTag = np.searchsorted(max_theta, dist)
+    assert eleTag >= 0 and eleTag < nele, 'Fail to locate source %s, dist = %f' \
+        % (name, dist)
+    theta0 = var_theta[eleTag, 0]
+    theta1 = var_theta[eleTag, 1]
+    eta = (dist - theta0) / (theta1 - theta0) * 2. - 1.
+    # weights considering axial condition
+    if eleTag == 0 or eleTag == nele - 1:
+        weights = interpLagrange(eta, var_GLJ)
+    else:
+        weights = interpLagrange(eta, var_GLL)
+
+    # Fourier, cached by element
+    if eleTag not in fourier_cache:
+        nce = nc_surfs[irank_ele[eleTag]]
+        fourier_r = nce.variables['edge_' + str(eleTag) + '_strain_r'][:, :]
+        fourier_i = nce.variables['edge_' + str(eleTag) + '_strain_i'][:, :]
+        fourier_cache[eleTag] = fourier_r + fourier_i * 1j
+    fourier = fourier_cache[eleTag]
+    nu_p_1 = int(fourier.shape[1] / nPntEdge / 6)
+    exparray = 2. * np.exp(np.arange(0, nu_p_1) * 1j * azimuth)
+    exparray[0] = 1.
+
+    # strain in RTZ, Voigt notation with engineering shear
+    fmat = fourier.reshape(nstep, 6, nPntEdge, nu_p_1)
+    strain = fmat.dot(exparray).real.dot(weights)
+
+    # M : strain
+    seis = (M[0, 0] * strain[:, 0] + M[1, 1] * strain[:, 1] + M[2, 2] * strain[:, 2]
+          + M[1, 2] * strain[:, 3] + M[0, 2] * strain[:, 4] + M[0, 1] * strain[:, 5])
+    seis /= args.force
+
+    var_wave = nc_wave.createVariable(name, solver_dtype, (ncdim_nstep,))
+    var_wave.latitude = lat
+    var_wave.longitude = lon
+    var_wave[:] = seis[:]
+    if args.verbose:
+        print('Done with source %s, %d / %d' % (name, icmt + 1, len(cmt_info)))
+
+for nc_s in nc_surfs:
+    nc_s.close()
+nc_wave.close()